@@ -7,26 +7,41 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <sys/types.h>
 #include <sys/wait.h>
 #include <pthread.h>
 #include <dirent.h>
 #include <stdbool.h>
 #include <signal.h>
 #include <ctype.h>
+#include "line_index.h"
+#include "newline_scan.h"
+#include "file_view.h"
+#include "lang_registry.h"
+#include "frame_arena.h"
+#include "highlight.h"
+#include "fold_tree.h"
+#include "symbol_index.h"
+#include "word_complete.h"
+#include "file_finder.h"
+#include "palette.h"
+#include "anchors.h"
 
 #define WOFL_MAX_PATH     1024
 #define WOFL_CMD_MAX      2048
 #define WOFL_INITIAL_GAP  4096
+#define SYMBOL_HITS       16
+#define COMPLETE_ITEMS    10
+#define FINDER_HITS       50
+#define FINDER_ROWS       12          // hits listed under the prompt at once
+#define PALETTE_ROWS      12
+#define PALETTE_SYMBOLS   32          // symbols offered per query
 
 typedef enum {
     EOL_LF = 0,
     EOL_CRLF = 1
 } EolMode;
 
-typedef enum {
-    LANG_NONE = 0, LANG_C, LANG_CPP, LANG_PY, LANG_JS, LANG_SH, LANG_MAX
-} Language;
-
 typedef struct {
     char *data;
     size_t capacity;
@@ -35,10 +50,136 @@ typedef struct {
     bool dirty;
 } GapBuffer;
 
+// Lines are 64-bit: a mapped view can have more than INT_MAX of them
 typedef struct {
-    int line, col;
+    int64_t line;
+    int col;
 } Caret;
 
+// Owners of anchors in g_app.anchors
+enum {
+    ANCHOR_CARET = 1,           // carets besides the main one (carets.h)
+    ANCHOR_FIND,                // the last match found
+    ANCHOR_SPLIT,               // caret and first line of the split view without focus
+    ANCHOR_MACRO                // where a macro played at the carets or lines is still to run
+};
+
+typedef enum {
+    SPLIT_NONE = 0,
+    SPLIT_SIDE,                 // two panes side by side
+    SPLIT_STACKED               // one above the other
+} SplitMode;
+
+// Split view: two panes on the one buffer, line index, folds and tokens.
+// g_app.caret and scroll belong to the pane with focus; the other's are
+// kept here, as anchors so that edits in the focused pane move them.
+typedef struct {
+    SplitMode mode;
+    int focus;                  // 0: the top or left pane, 1: the other
+    AnchorId caret;             // of the pane without focus
+    AnchorId top;               // start of its first line shown
+    int scroll_x;
+    SDL_Rect panes[2];          // as last drawn, for clicks; panes[0] alone unsplit
+} SplitView;
+
+// Follow mode: the open file is kept open and new bytes are appended as
+// inotify reports them
+typedef struct {
+    bool active;
+    int inotify_fd;
+    int file_wd;
+    int dir_wd;
+    int fd;
+    off_t offset;               // bytes of fd already in the buffer
+    bool pending;               // more to read than one frame's budget
+    bool rotated;               // the path now names a different file
+    char dir[WOFL_MAX_PATH];
+    char base[WOFL_MAX_PATH];
+} Follower;
+
+// A matching line of the filter view: its number and where it starts in
+// the buffer. The text itself is never copied.
+typedef struct {
+    size_t line;
+    size_t start;
+} FilterHit;
+
+// Filter view: a virtual document made of the buffer lines containing
+// query. While active, caret.line is a row of this document.
+typedef struct {
+    bool active;
+    bool prompt;                // the query is being typed
+    char query[256];
+    char applied[256];          // query the hits were computed for
+    FilterHit *hits;
+    size_t count;
+    size_t cap;
+    Caret saved;                // caret in the buffer before filtering
+} FilterView;
+
+// A step of a keystroke macro: a key with its modifiers, or text typed.
+// Text typed in a row is one step; it is kept in Macro.text, ended by a 0.
+typedef struct {
+    SDL_Keycode key;            // 0 for text
+    Uint16 mod;
+    size_t text;                // offset of the text in Macro.text
+} MacroStep;
+
+// Keystroke macro: the keys and text that reached the editor while
+// recording, played back as they came
+typedef struct {
+    bool recording;
+    bool playing;
+    bool prompt;                // the play count is being typed
+    bool per_line;              // ... as lines to play once on each, not times
+    char count_text[16];
+    MacroStep *steps;
+    size_t count, cap;
+    char *text;
+    size_t text_len, text_cap;
+} Macro;
+
+// Go to symbol prompt: the best definitions for query across the workspace
+typedef struct {
+    bool active;
+    char query[SI_QUERY_MAX];
+    SymbolHit hits[SYMBOL_HITS];
+    int count;
+    int selected;
+    uint64_t version;           // index version the hits came from
+    int64_t pending;            // line + 1 to go to once it is indexed, or 0
+} SymbolPrompt;
+
+// Quick open prompt: the best workspace files for query, as a list
+typedef struct {
+    bool active;
+    char query[FF_QUERY_MAX];
+    FileHit hits[FINDER_HITS];
+    int count;
+    int selected;
+    int top;                    // first hit listed
+    uint64_t version;           // list version the hits came from
+} FinderPrompt;
+
+// Command palette: commands, the open file, recent files and symbols,
+// ranked together (palette.h)
+typedef struct {
+    bool active;
+    Palette pal;                // sources and the hits for query
+    int selected;
+    int top;                    // first hit listed
+    uint64_t version;           // symbol index version the hits came from
+} PalettePrompt;
+
+// Word completion popup: the best completions of the word before the caret
+typedef struct {
+    bool visible;
+    WcCandidate items[COMPLETE_ITEMS];
+    int count;
+    int selected;
+    int prefix_len;             // characters of the word already typed
+} CompletePopup;
+
 typedef struct {
     SDL_Window *window;
     SDL_Renderer *renderer;
@@ -48,20 +189,52 @@ typedef struct {
     char file_path[WOFL_MAX_PATH];
     char file_name[WOFL_MAX_PATH];
     Language lang;
+    const Syntax *syntax;       // scanner for lang, picked once per file
     GapBuffer buf;
     Caret caret;
-    int scroll_y;
+    int carets;                 // carets besides the main one, none where it is
+    AnchorSet anchors;          // positions that follow every edit
+    int64_t scroll_y;           // first visible row
+    int scroll_x;               // first visible column
+    LineIndexer lines;          // line starts, built in the background
+    Highlighter hl;             // tokens per line, lexed in the background
+    FoldTree folds;             // collapsed lines; screen rows skip them
+    SymbolIndexer symbols;      // definitions across the workspace
+    FileIndexer files;          // paths across the workspace, for quick open
+    WordComplete words;         // words of this and recent files, kept up by every edit
+    PaletteRecent recent;       // files opened, most recent first
+    bool wrap;                  // soft wrap at the window width
+    SplitView split;
+    
+    // Read-only view of a large file; replaces buf while view_mode is set
+    bool view_mode;
+    FileView view;
+    Follower follow;
+    FilterView filter;
     
     // Find state
     bool find_active;
     char find_text[256];
     int find_cursor;
-    size_t last_find_pos;
+    AnchorId find_mark;         // the last match, where find next goes on from
     bool find_case_sensitive;
     
+    // Go to line prompt
+    bool goto_active;
+    char goto_text[32];
+    SymbolPrompt symbol;
+    FinderPrompt finder;
+    PalettePrompt palette;
+    CompletePopup complete;
+    Macro macro;
+    
     // UI state
     bool show_overlay;
     char overlay_text[512];
+    bool center_caret;          // scroll the caret to mid-pane on the next frame
+    
+    int visible_lines;
+    FrameArena frame;           // row text and tokens of the frame being drawn
     
     int font_size;
     int line_height;
@@ -0,0 +1,179 @@
+#include "carets.h"
+#include "cursor.h"
+#include "editing.h"
+#include "gap_buffer.h"
+
+// Carets are anchors of ANCHOR_CARET (anchors.h): edits anywhere move them
+// along, and a batch at all of them moves them past their own edits.
+// Gathered here for a batch, with the batch's edits
+static AnchorId *ids;
+static size_t *at;
+static EditOp *ops;
+static size_t scratch_cap;
+
+static bool active(void) {
+    return g_app.carets > 0 && !g_app.view_mode && !g_app.filter.active;
+}
+
+void carets_clear(void) {
+    an_remove_owner(&g_app.anchors, ANCHOR_CARET);
+    g_app.carets = 0;
+    free(ids);
+    free(at);
+    free(ops);
+    ids = NULL;
+    at = NULL;
+    ops = NULL;
+    scratch_cap = 0;
+}
+
+static bool reserve(size_t n) {
+    if (n <= scratch_cap) return true;
+    size_t cap = scratch_cap ? scratch_cap : 64;
+    while (cap < n) cap *= 2;
+    AnchorId *new_ids = (AnchorId *)realloc(ids, cap * sizeof(AnchorId));
+    if (new_ids) ids = new_ids;
+    size_t *new_at = (size_t *)realloc(at, cap * sizeof(size_t));
+    if (new_at) at = new_at;
+    EditOp *new_ops = (EditOp *)realloc(ops, cap * sizeof(EditOp));
+    if (new_ops) ops = new_ops;
+    if (!new_ids || !new_at || !new_ops) return false;
+    scratch_cap = cap;
+    return true;
+}
+
+// Every caret but the main one, in order, into ids and at
+static size_t gather(void) {
+    if (!reserve((size_t)g_app.carets + 1)) return 0;
+    return an_collect(&g_app.anchors, 0, SIZE_MAX, ANCHOR_CARET, ids, at, (size_t)g_app.carets);
+}
+
+// Index of a line and column, clamped to the line as the main caret's is
+static size_t index_of(Caret c) {
+    Caret saved = g_app.caret;
+    g_app.caret = c;
+    size_t index = get_cursor_index();
+    g_app.caret = saved;
+    return index;
+}
+
+static Caret caret_at(size_t index) {
+    Caret saved = g_app.caret;
+    move_cursor_to_index(index);
+    Caret c = g_app.caret;
+    g_app.caret = saved;
+    return c;
+}
+
+// A caret at pos, unless one is there already
+static bool add(size_t pos) {
+    if (pos == get_cursor_index() ||
+        an_collect(&g_app.anchors, pos, pos, ANCHOR_CARET, NULL, NULL, 1)) return false;
+    if (an_add(&g_app.anchors, pos, AN_RIGHT, ANCHOR_CARET) == AN_NONE) return false;
+    g_app.carets++;
+    return true;
+}
+
+static size_t on_line(int64_t line) {
+    Caret c = { line, g_app.caret.col };
+    int len = get_line_length(line);
+    if (c.col > len) c.col = len;
+    return index_of(c);
+}
+
+// Carets that met are one caret
+static void merge(void) {
+    const size_t main_at = get_cursor_index();
+    const size_t n = gather();
+    int kept = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (at[i] == main_at || (i > 0 && at[i] == at[i - 1])) an_remove(&g_app.anchors, ids[i]);
+        else kept++;
+    }
+    g_app.carets = kept;
+}
+
+// A caret on the line past the outermost one that way, at the main caret's column
+void carets_add_line(int direction) {
+    if (g_app.view_mode || g_app.filter.active) return;
+    int64_t line = g_app.caret.line;
+    size_t first, last;
+    if (an_bounds(&g_app.anchors, ANCHOR_CARET, &first, &last)) {
+        int64_t outer = caret_at(direction < 0 ? first : last).line;
+        if (direction < 0 ? outer < line : outer > line) line = outer;
+    }
+    line += direction;
+    if (line < 0 || line >= get_line_count()) return;
+    add(on_line(line));
+}
+
+// A caret on every line below the main one, for editing a column
+void carets_add_to_end(void) {
+    if (g_app.view_mode || g_app.filter.active) return;
+    int64_t count = get_line_count();
+    for (int64_t line = g_app.caret.line + 1; line < count; line++) add(on_line(line));
+    snprintf(g_app.overlay_text, sizeof(g_app.overlay_text), "%d carets", g_app.carets + 1);
+    g_app.show_overlay = true;
+}
+
+/**
+ * One edit at every caret, as one batch: del bytes from before (back) or
+ * after the caret are replaced with text. The carets' anchors follow the
+ * batch; the main caret lands after its edit.
+ */
+static void edit_all(const char *text, size_t len, size_t del, bool back) {
+    const size_t n = gather() + 1;
+    if (n == 1) return;
+    const size_t total = gb_length(&g_app.buf);
+    for (size_t i = 0; i < n; i++) {
+        size_t pos = i == 0 ? get_cursor_index() : at[i - 1];
+        size_t d = del;
+        if (back) {
+            if (d > pos) d = pos;
+            pos -= d;
+        } else if (d > total - pos) {
+            d = total - pos;
+        }
+        ops[i] = (EditOp){ pos, d, text, len, (uint32_t)i, 0 };
+    }
+    buffer_apply(ops, n);
+    
+    for (size_t i = 0; i < n; i++) {
+        if (ops[i].tag == 0) move_cursor_to_index(ops[i].at);
+    }
+    merge();
+}
+
+bool carets_insert(const char *text, size_t len) {
+    if (g_app.carets == 0) return false;
+    if (active()) edit_all(text, len, 0, false);
+    return true;
+}
+
+bool carets_delete(bool forward) {
+    if (g_app.carets == 0) return false;
+    if (active()) edit_all(NULL, 0, 1, !forward);
+    return true;
+}
+
+// The arrow keys move every caret alike
+bool carets_move(SDL_Keycode key) {
+    if (!active()) return false;
+    if (key != SDLK_LEFT && key != SDLK_RIGHT && key != SDLK_UP && key != SDLK_DOWN) return false;
+    const size_t n = gather();
+    Caret saved = g_app.caret;
+    for (size_t i = 0; i <= n; i++) {
+        g_app.caret = i == 0 ? saved : caret_at(at[i - 1]);
+        switch (key) {
+            case SDLK_LEFT:  move_cursor_left();  break;
+            case SDLK_RIGHT: move_cursor_right(); break;
+            case SDLK_UP:    move_cursor_up();    break;
+            case SDLK_DOWN:  move_cursor_down();  break;
+        }
+        if (i == 0) saved = g_app.caret;
+        else an_set(&g_app.anchors, ids[i - 1], get_cursor_index());
+    }
+    g_app.caret = saved;
+    merge();
+    return true;
+}
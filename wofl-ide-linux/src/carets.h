@@ -0,0 +1,16 @@
+#ifndef CARETS_H
+#define CARETS_H
+
+#include "app.h"
+
+// Carets besides g_app.caret, for editing many lines at once. Every edit
+// at them goes to the buffer as one batch (edit_batch.h), and they move
+// with it. They stand aside in the mapped view and the filter view.
+void carets_clear(void);
+void carets_add_line(int direction);
+void carets_add_to_end(void);
+bool carets_insert(const char *text, size_t len);
+bool carets_delete(bool forward);
+bool carets_move(SDL_Keycode key);
+
+#endif
@@ -0,0 +1,263 @@
+#include "command_palette.h"
+#include "input.h"
+#include "finder.h"
+#include "symbols.h"
+#include "cursor.h"
+#include "editing.h"
+
+static const char *const kind_tags[PAL_KINDS] = { "command", "open", "recent", "symbol" };
+static const char *const symbol_kinds[] = { "function", "class", "struct", "namespace" };
+
+// ===== Sources =====
+
+// Editor commands, run as the key they are bound to
+typedef struct {
+    const char *label;
+    const char *keys;
+    SDL_Keycode key;
+    Uint16 mod;
+} PaletteCommand;
+
+static const PaletteCommand commands[] = {
+    { "Quick Open",             "Ctrl+O",       SDLK_o,            KMOD_CTRL },
+    { "Save",                   "Ctrl+S",       SDLK_s,            KMOD_CTRL },
+    { "Save As",                "Ctrl+Shift+S", SDLK_s,            KMOD_CTRL | KMOD_SHIFT },
+    { "Find",                   "Ctrl+F",       SDLK_f,            KMOD_CTRL },
+    { "Find Next",              "F3",           SDLK_F3,           KMOD_NONE },
+    { "Go to Line",             "Ctrl+G",       SDLK_g,            KMOD_CTRL },
+    { "Go to Symbol",           "Ctrl+R",       SDLK_r,            KMOD_CTRL },
+    { "Go to Start of File",    "Ctrl+Home",    SDLK_HOME,         KMOD_CTRL },
+    { "Go to End of File",      "Ctrl+End",     SDLK_END,          KMOD_CTRL },
+    { "Go to Matching Bracket", "Ctrl+]",       SDLK_RIGHTBRACKET, KMOD_CTRL },
+    { "Complete Word",          "Ctrl+Space",   SDLK_SPACE,        KMOD_CTRL },
+    { "Add Caret Above",        "Ctrl+Alt+Up",  SDLK_UP,           KMOD_CTRL | KMOD_ALT },
+    { "Add Caret Below",        "Ctrl+Alt+Down", SDLK_DOWN,        KMOD_CTRL | KMOD_ALT },
+    { "Add Carets to End",      "Ctrl+Alt+End", SDLK_END,          KMOD_CTRL | KMOD_ALT },
+    { "Filter Lines",           "Ctrl+L",       SDLK_l,            KMOD_CTRL },
+    { "Follow File",            "Ctrl+T",       SDLK_t,            KMOD_CTRL },
+    { "Fold Block",             "Ctrl+Shift+[", SDLK_LEFTBRACKET,  KMOD_CTRL | KMOD_SHIFT },
+    { "Unfold All",             "Ctrl+Shift+]", SDLK_RIGHTBRACKET, KMOD_CTRL | KMOD_SHIFT },
+    { "Toggle Soft Wrap",       "Alt+Z",        SDLK_z,            KMOD_ALT },
+    { "Split Side by Side",     "Ctrl+\\",      SDLK_BACKSLASH,    KMOD_CTRL },
+    { "Split Top and Bottom",   "Ctrl+Shift+\\", SDLK_BACKSLASH,   KMOD_CTRL | KMOD_SHIFT },
+    { "Focus Other Split",      "F6",           SDLK_F6,           KMOD_NONE },
+    { "Record Macro",           "F7",           SDLK_F7,           KMOD_NONE },
+    { "Play Macro",             "F8",           SDLK_F8,           KMOD_NONE },
+    { "Play Macro Many Times",  "Shift+F8",     SDLK_F8,           KMOD_SHIFT },
+    { "Play Macro on Lines",    "Ctrl+F8",      SDLK_F8,           KMOD_CTRL },
+    { "Quit",                   "Ctrl+Q",       SDLK_q,            KMOD_CTRL },
+};
+#define COMMAND_COUNT ((int)(sizeof(commands) / sizeof(commands[0])))
+
+static void collect_commands(PaletteSource *self, Palette *p, const char *query) {
+    (void)self;
+    (void)query;
+    for (int i = 0; i < COMMAND_COUNT; i++) pal_add(p, commands[i].label, commands[i].keys, i);
+}
+
+static void run_command(PaletteSource *self, const PaletteEntry *e, const char *label, const char *detail) {
+    (void)self;
+    (void)label;
+    (void)detail;
+    handle_key(commands[e->id].key, commands[e->id].mod);
+}
+
+// Line operations over the whole buffer (line_ops.h)
+static void collect_line_ops(PaletteSource *self, Palette *p, const char *query) {
+    (void)self;
+    (void)query;
+    for (int i = 0; i < LO_COUNT; i++) pal_add(p, lo_name((LineOp)i), "every line of the file", i);
+}
+
+static void run_line_op(PaletteSource *self, const PaletteEntry *e, const char *label, const char *detail) {
+    (void)self;
+    (void)label;
+    (void)detail;
+    buffer_line_op((LineOp)e->id);
+}
+
+// Paths under the workspace are listed relative to it
+static const char *workspace_path(const char *path) {
+    const size_t n = strlen(g_app.files.root);
+    if (n && strncmp(path, g_app.files.root, n) == 0 && path[n] == '/') return path + n + 1;
+    return path;
+}
+
+// The file loaded; there is one buffer, so picking it only closes the palette
+static void collect_buffer(PaletteSource *self, Palette *p, const char *query) {
+    (void)self;
+    (void)query;
+    if (!g_app.file_path[0]) return;
+    pal_add_path(p, workspace_path(g_app.file_path), g_app.view_mode ? "read-only view" :
+                 g_app.buf.dirty ? "modified" : "", 0);
+}
+
+static void collect_recent(PaletteSource *self, Palette *p, const char *query) {
+    (void)self;
+    (void)query;
+    // The first is the file loaded, listed already
+    for (int i = g_app.file_path[0] ? 1 : 0; i < g_app.recent.count; i++) {
+        pal_add_path(p, workspace_path(g_app.recent.paths[i]), "", i);
+    }
+}
+
+static void run_recent(PaletteSource *self, const PaletteEntry *e, const char *label, const char *detail) {
+    (void)self;
+    (void)detail;
+    char path[PAL_PATH_MAX];
+    snprintf(path, sizeof(path), "%s", g_app.recent.paths[e->id]);
+    if (finder_open(path, label)) g_app.show_overlay = true;
+}
+
+// The index holds far too many to list: each query takes its best few
+static SymbolHit symbol_hits[PALETTE_SYMBOLS];
+
+static void collect_symbols(PaletteSource *self, Palette *p, const char *query) {
+    (void)self;
+    if (!query || !query[0]) return;
+    const int n = six_query(&g_app.symbols, query, symbol_hits, PALETTE_SYMBOLS);
+    for (int i = 0; i < n; i++) {
+        const SymbolHit *h = &symbol_hits[i];
+        char label[PAL_LABEL_MAX], detail[PAL_PATH_MAX];
+        if (h->parent[0]) snprintf(label, sizeof(label), "%.100s.%.100s", h->parent, h->name);
+        else snprintf(label, sizeof(label), "%s", h->name);
+        snprintf(detail, sizeof(detail), "%s  %.900s:%zu", symbol_kinds[h->kind], h->path, h->line + 1);
+        pal_add(p, label, detail, i);
+    }
+}
+
+static void run_symbol(PaletteSource *self, const PaletteEntry *e, const char *label, const char *detail) {
+    (void)self;
+    (void)label;
+    (void)detail;
+    const SymbolHit *h = &symbol_hits[e->id];
+    if (!symbols_open(h->path, h->line)) g_app.show_overlay = true;
+}
+
+static PaletteSource command_source = { "commands", PAL_COMMAND, false, collect_commands, run_command, NULL };
+static PaletteSource line_op_source = { "line operations", PAL_COMMAND, false, collect_line_ops, run_line_op, NULL };
+static PaletteSource buffer_source = { "buffer", PAL_BUFFER, false, collect_buffer, NULL, NULL };
+static PaletteSource recent_source = { "recent", PAL_RECENT, false, collect_recent, run_recent, NULL };
+static PaletteSource symbol_source = { "symbols", PAL_SYMBOL, true, collect_symbols, run_symbol, NULL };
+
+void palette_init(void) {
+    pal_init(&g_app.palette.pal);
+    pal_register(&g_app.palette.pal, &command_source);
+    pal_register(&g_app.palette.pal, &line_op_source);
+    pal_register(&g_app.palette.pal, &buffer_source);
+    pal_register(&g_app.palette.pal, &recent_source);
+    pal_register(&g_app.palette.pal, &symbol_source);
+}
+
+void palette_free(void) {
+    pal_free(&g_app.palette.pal);
+}
+
+// ===== Prompt =====
+
+static void show(void) {
+    PalettePrompt *p = &g_app.palette;
+    char note[64] = "";
+    if (p->pal.nhits) snprintf(note, sizeof(note), "   [%d/%d]", p->selected + 1, p->pal.nhits);
+    else snprintf(note, sizeof(note), "   (no match)");
+    snprintf(g_app.overlay_text, sizeof(g_app.overlay_text), "> %.400s%s", p->pal.query, note);
+}
+
+static void scroll(void) {
+    PalettePrompt *p = &g_app.palette;
+    if (p->selected < p->top) p->top = p->selected;
+    if (p->selected >= p->top + PALETTE_ROWS) p->top = p->selected - PALETTE_ROWS + 1;
+}
+
+static void filter(void) {
+    PalettePrompt *p = &g_app.palette;
+    p->version = six_status(&g_app.symbols, NULL, NULL, NULL);
+    pal_filter(&p->pal, p->pal.query);
+    p->selected = 0;
+    p->top = 0;
+    show();
+}
+
+void palette_start(void) {
+    PalettePrompt *p = &g_app.palette;
+    p->active = true;
+    p->version = six_status(&g_app.symbols, NULL, NULL, NULL);
+    pal_open(&p->pal);
+    p->selected = 0;
+    p->top = 0;
+    show();
+    g_app.show_overlay = true;
+}
+
+void palette_input(const char *text) {
+    PalettePrompt *p = &g_app.palette;
+    size_t len = strlen(p->pal.query);
+    for (; text && *text && len < sizeof(p->pal.query) - 1; text++) p->pal.query[len++] = *text;
+    p->pal.query[len] = '\0';
+    filter();
+}
+
+static void accept(void) {
+    PalettePrompt *p = &g_app.palette;
+    if (!p->pal.nhits) return;
+    // Closed first: a command may open a prompt of its own
+    p->active = false;
+    g_app.show_overlay = false;
+    pal_run(&p->pal, p->selected);
+}
+
+void palette_key(SDL_Keycode key) {
+    PalettePrompt *p = &g_app.palette;
+    const int count = p->pal.nhits;
+    size_t len = strlen(p->pal.query);
+    switch (key) {
+        case SDLK_ESCAPE:
+            p->active = false;
+            g_app.show_overlay = false;
+            break;
+        case SDLK_RETURN:
+            accept();
+            break;
+        case SDLK_BACKSPACE:
+            if (len > 0) p->pal.query[len - 1] = '\0';
+            filter();
+            break;
+        case SDLK_UP:
+            if (count) p->selected = (p->selected + count - 1) % count;
+            scroll();
+            show();
+            break;
+        case SDLK_DOWN:
+        case SDLK_TAB:
+            if (count) p->selected = (p->selected + 1) % count;
+            scroll();
+            show();
+            break;
+        case SDLK_PAGEUP:
+            p->selected = p->selected > PALETTE_ROWS ? p->selected - PALETTE_ROWS : 0;
+            scroll();
+            show();
+            break;
+        case SDLK_PAGEDOWN:
+            if (count) p->selected = p->selected + PALETTE_ROWS < count ? p->selected + PALETTE_ROWS : count - 1;
+            scroll();
+            show();
+            break;
+    }
+}
+
+// Once per frame while open: symbols indexed since are ranked in
+void palette_poll(void) {
+    PalettePrompt *p = &g_app.palette;
+    if (!p->active || !p->pal.query[0]) return;
+    if (six_status(&g_app.symbols, NULL, NULL, NULL) != p->version) {
+        const int selected = p->selected;
+        filter();
+        if (selected < p->pal.nhits) p->selected = selected;
+        scroll();
+    }
+}
+
+const char *palette_kind_tag(int kind) {
+    return kind >= 0 && kind < PAL_KINDS ? kind_tags[kind] : "";
+}
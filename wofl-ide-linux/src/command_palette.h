@@ -0,0 +1,18 @@
+#ifndef COMMAND_PALETTE_H
+#define COMMAND_PALETTE_H
+
+#include "app.h"
+
+// Command palette: a prompt ranking editor commands, the open file, recent
+// files and workspace symbols together (palette.h)
+void palette_init(void);
+void palette_free(void);
+void palette_start(void);
+void palette_input(const char *text);
+void palette_key(SDL_Keycode key);
+void palette_poll(void);
+
+// What the list shows for an entry of kind
+const char *palette_kind_tag(int kind);
+
+#endif
@@ -0,0 +1,66 @@
+#include "complete.h"
+#include "editing.h"
+#include "cursor.h"
+
+// Completions of the word before the caret. Unless requested, the popup
+// waits until WC_PREFIX_MIN characters of it are typed.
+void complete_update(bool requested) {
+    CompletePopup *cp = &g_app.complete;
+    cp->visible = false;
+    if (g_app.view_mode || g_app.filter.active) return;
+    
+    WcSource src = buffer_words();
+    size_t pos = get_cursor_index();
+    char prefix[WC_WORD_MAX];
+    cp->prefix_len = wc_prefix_at(src, pos, prefix);
+    if (cp->prefix_len < (requested ? 1 : WC_PREFIX_MIN)) return;
+    cp->count = wc_complete(&g_app.words, src, pos, cp->items, COMPLETE_ITEMS);
+    cp->selected = 0;
+    cp->visible = cp->count > 0;
+}
+
+void complete_close(void) {
+    g_app.complete.visible = false;
+}
+
+static void accept(void) {
+    CompletePopup *cp = &g_app.complete;
+    const WcCandidate *c = &cp->items[cp->selected];
+    cp->visible = false;
+    if (cp->prefix_len < c->len) {
+        insert_text_at_cursor(c->word + cp->prefix_len, (size_t)(c->len - cp->prefix_len));
+    }
+}
+
+// Keys the open popup takes: Up and Down pick, Tab and Enter accept,
+// Escape closes. Moving the caret away closes it too, but the move
+// still happens.
+bool complete_key(SDL_Keycode key) {
+    CompletePopup *cp = &g_app.complete;
+    if (!cp->visible) return false;
+    switch (key) {
+        case SDLK_UP:
+            cp->selected = (cp->selected + cp->count - 1) % cp->count;
+            return true;
+        case SDLK_DOWN:
+            cp->selected = (cp->selected + 1) % cp->count;
+            return true;
+        case SDLK_TAB:
+        case SDLK_RETURN:
+            accept();
+            return true;
+        case SDLK_ESCAPE:
+            complete_close();
+            return true;
+        case SDLK_LEFT:
+        case SDLK_RIGHT:
+        case SDLK_PAGEUP:
+        case SDLK_PAGEDOWN:
+        case SDLK_HOME:
+        case SDLK_END:
+        case SDLK_DELETE:
+            complete_close();
+            return false;
+    }
+    return false;
+}
@@ -0,0 +1,12 @@
+#ifndef COMPLETE_H
+#define COMPLETE_H
+
+#include "app.h"
+
+// Word completion popup over the words of the open and recent files
+// (word_complete.h)
+void complete_update(bool requested);
+void complete_close(void);
+bool complete_key(SDL_Keycode key);
+
+#endif
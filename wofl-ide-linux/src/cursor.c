@@ -1,97 +1,304 @@
 #include "cursor.h"
 #include "gap_buffer.h"
+#include "filter.h"
+#include <limits.h>
+
+// End of the line starting at `start` (its '\n' or the end of the buffer)
+static size_t line_end_from(size_t start) {
+    NlText text = gb_nl_text(&g_app.buf);
+    size_t nl = nl_text_find_nth(&text, start, 1);
+    return nl == NL_NONE ? gb_length(&g_app.buf) : nl;
+}
 
 size_t get_cursor_index(void) {
-    size_t len = gb_length(&g_app.buf);
-    size_t index = 0;
-    int current_line = 0;
-    int current_col = 0;
+    if (g_app.view_mode) {
+        uint64_t start;
+        if (!fv_line_offset(&g_app.view, (uint64_t)g_app.caret.line, &start)) return 0;
+        return (size_t)start + (size_t)g_app.caret.col;
+    }
     
-    for (size_t i = 0; i < len; i++) {
-        if (current_line == g_app.caret.line && current_col == g_app.caret.col) {
-            return i;
-        }
-        
-        if (gb_char_at(&g_app.buf, i) == '\n') {
-            current_line++;
-            current_col = 0;
-        } else {
-            current_col++;
-        }
+    size_t start;
+    if (g_app.filter.active) {
+        // Filter rows map straight to their source line
+        if ((size_t)g_app.caret.line >= g_app.filter.count) return 0;
+        start = g_app.filter.hits[g_app.caret.line].start;
+    } else {
+        lix_lock(&g_app.lines);
+        start = li_line_start(&g_app.lines.index, (size_t)g_app.caret.line);
+        lix_unlock(&g_app.lines);
     }
     
-    return len;  // End of buffer
+    // Clamp to the caret's own line, like the old scan did
+    size_t end = line_end_from(start);
+    size_t index = start + (size_t)g_app.caret.col;
+    return index < end ? index : end;
 }
 
 void move_cursor_to_index(size_t target_index) {
+    if (g_app.view_mode) {
+        uint64_t line = fv_line_of_offset(&g_app.view, target_index);
+        uint64_t start = 0;
+        fv_line_offset(&g_app.view, line, &start);
+        g_app.caret.line = (int64_t)line;
+        g_app.caret.col = target_index > start ? (int)(target_index - start) : 0;
+        return;
+    }
+    
     size_t len = gb_length(&g_app.buf);
     if (target_index > len) target_index = len;
     
-    int line = 0, col = 0;
-    for (size_t i = 0; i < target_index; i++) {
-        if (gb_char_at(&g_app.buf, i) == '\n') {
-            line++;
-            col = 0;
-        } else {
-            col++;
+    lix_lock(&g_app.lines);
+    size_t line = li_line_of(&g_app.lines.index, target_index);
+    size_t start = li_line_start(&g_app.lines.index, line);
+    lix_unlock(&g_app.lines);
+    
+    // Targets past the indexed prefix are counted from the last known line
+    if (target_index > start) {
+        NlText text = gb_nl_text(&g_app.buf);
+        size_t prev = nl_text_find_prev(&text, target_index);
+        if (prev != NL_NONE && prev >= start) {
+            line += nl_text_count(&text, start, target_index);
+            start = prev + 1;
         }
     }
     
-    g_app.caret.line = line;
-    g_app.caret.col = col;
+    g_app.caret.line = (int64_t)line;
+    g_app.caret.col = (int)(target_index - start);
+    
+    if (g_app.filter.active) {
+        // Land on the row for that line, or the next one shown
+        size_t row = filter_row_of_line(line);
+        if (row >= g_app.filter.count) {
+            row = g_app.filter.count ? g_app.filter.count - 1 : 0;
+        }
+        if (row >= g_app.filter.count || g_app.filter.hits[row].line != line) {
+            g_app.caret.col = 0;
+        }
+        g_app.caret.line = (int64_t)row;
+    }
 }
 
-int get_line_length(int line_num) {
-    size_t len = gb_length(&g_app.buf);
-    int current_line = 0;
-    int line_length = 0;
+int64_t get_line_count(void) {
+    if (g_app.view_mode) return (int64_t)fv_line_count(&g_app.view);
+    if (g_app.filter.active) return (int64_t)g_app.filter.count;
+    lix_lock(&g_app.lines);
+    int64_t count = (int64_t)li_line_count(&g_app.lines.index);
+    lix_unlock(&g_app.lines);
+    return count;
+}
+
+int get_line_length(int64_t line_num) {
+    if (g_app.view_mode) {
+        uint64_t len = fv_line_length(&g_app.view, (uint64_t)line_num);
+        return len > INT_MAX ? INT_MAX : (int)len;
+    }
     
-    for (size_t i = 0; i < len; i++) {
-        char ch = gb_char_at(&g_app.buf, i);
-        if (current_line == line_num) {
-            if (ch == '\n') break;
-            line_length++;
-        } else if (ch == '\n') {
-            current_line++;
-        }
+    if (g_app.filter.active) {
+        if (line_num < 0 || (size_t)line_num >= g_app.filter.count) return 0;
+        size_t start = g_app.filter.hits[line_num].start;
+        return (int)(line_end_from(start) - start);
     }
     
-    return line_length;
+    lix_lock(&g_app.lines);
+    bool exists = (size_t)line_num < li_line_count(&g_app.lines.index);
+    size_t start = li_line_start(&g_app.lines.index, (size_t)line_num);
+    lix_unlock(&g_app.lines);
+    if (!exists) return 0;
+    
+    return (int)(line_end_from(start) - start);
 }
 
-void move_cursor_up(void) {
-    if (g_app.caret.line > 0) {
-        g_app.caret.line--;
-        int line_len = get_line_length(g_app.caret.line);
-        if (g_app.caret.col > line_len) {
-            g_app.caret.col = line_len;
-        }
+// ===== Rows =====
+
+// Screen rows are the buffer's wrapped rows less those folded away; the
+// mapped file and the filter view never wrap, and filter rows are never
+// folded either. Row <-> line lookups go through the fold tree and then
+// the line index, both O(log n).
+
+// Rows before `line` with nothing folded; the fold tree weighs folds by it
+size_t wrapped_rows_before(void *ctx, size_t line) {
+    (void)ctx;
+    if (g_app.view_mode) return line;
+    lix_lock(&g_app.lines);
+    size_t row = li_row_of_line(&g_app.lines.index, line);
+    lix_unlock(&g_app.lines);
+    return row;
+}
+
+// Once the worker has counted rows at a new width, switch to them and
+// keep the top line on screen
+void sync_rows(void) {
+    int64_t top = line_of_row(g_app.scroll_y, NULL);
+    if (!lix_apply_wrap(&g_app.lines)) return;
+    ft_reweigh(&g_app.folds);
+    g_app.scroll_y = row_of_line(top);
+}
+
+int wrap_columns(void) {
+    if (g_app.view_mode || g_app.filter.active) return 0;
+    lix_lock(&g_app.lines);
+    int wrap = (int)g_app.lines.index.wrap;
+    lix_unlock(&g_app.lines);
+    return wrap;
+}
+
+int64_t get_row_count(void) {
+    if (g_app.filter.active) return (int64_t)g_app.filter.count;
+    size_t rows = (size_t)get_line_count();
+    if (!g_app.view_mode) {
+        lix_lock(&g_app.lines);
+        rows = li_row_count(&g_app.lines.index);
+        lix_unlock(&g_app.lines);
     }
+    size_t hidden = ft_hidden_rows(&g_app.folds);
+    return rows > hidden ? (int64_t)(rows - hidden) : 0;
 }
 
-void move_cursor_down(void) {
-    g_app.caret.line++;
-    int line_len = get_line_length(g_app.caret.line);
-    if (g_app.caret.col > line_len) {
-        g_app.caret.col = line_len;
+int line_rows(int64_t line) {
+    if (wrap_columns() == 0) return 1;
+    lix_lock(&g_app.lines);
+    int rows = (int)li_line_rows(&g_app.lines.index, (size_t)line);
+    lix_unlock(&g_app.lines);
+    return rows;
+}
+
+// First row of a line
+int64_t row_of_line(int64_t line) {
+    if (g_app.filter.active) return line;
+    return (int64_t)ft_row_of(&g_app.folds, (size_t)line);
+}
+
+// Line shown on a row, and which of its wrapped rows that is
+int64_t line_of_row(int64_t row, int *sub) {
+    if (sub) *sub = 0;
+    if (g_app.filter.active) return row;
+    size_t unfolded = ft_unfolded_row(&g_app.folds, (size_t)row);
+    if (g_app.view_mode) return (int64_t)unfolded;
+    size_t at;
+    lix_lock(&g_app.lines);
+    size_t line = li_line_of_row(&g_app.lines.index, unfolded, &at);
+    lix_unlock(&g_app.lines);
+    if (sub) *sub = (int)at;
+    return (int64_t)line;
+}
+
+// The caret's row; at the end of a full wrapped row it stays on that row
+int64_t caret_row(void) {
+    int64_t row = row_of_line(g_app.caret.line);
+    int wrap = wrap_columns();
+    if (wrap > 0 && g_app.caret.col > 0) {
+        int sub = g_app.caret.col / wrap;
+        int rows = line_rows(g_app.caret.line);
+        row += sub < rows ? sub : rows - 1;
     }
+    return row;
+}
+
+// Column of the caret within its row
+static int caret_x(void) {
+    int wrap = wrap_columns();
+    if (wrap == 0) return g_app.caret.col;
+    return g_app.caret.col - (int)(caret_row() - row_of_line(g_app.caret.line)) * wrap;
+}
+
+// Put the caret on a row, as near column x of it as the line allows
+static void caret_to_row(int64_t row, int x) {
+    int sub;
+    int64_t line = line_of_row(row, &sub);
+    int wrap = wrap_columns();
+    int col = wrap > 0 ? sub * wrap + x : x;
+    int line_len = get_line_length(line);
+    if (col > line_len) col = line_len;
+    // The end of a full row is the start of the next one
+    if (wrap > 0 && col == (sub + 1) * wrap && sub + 1 < line_rows(line)) col--;
+    g_app.caret.line = line;
+    g_app.caret.col = col;
+}
+
+void move_cursor_up(void) {
+    int64_t row = caret_row();
+    if (row > 0) caret_to_row(row - 1, caret_x());
+}
+
+void move_cursor_down(void) {
+    int64_t row = caret_row();
+    if (row + 1 < get_row_count()) caret_to_row(row + 1, caret_x());
 }
 
 void move_cursor_left(void) {
+    int64_t row = row_of_line(g_app.caret.line);
     if (g_app.caret.col > 0) {
         g_app.caret.col--;
-    } else if (g_app.caret.line > 0) {
-        g_app.caret.line--;
+    } else if (row > 0) {
+        g_app.caret.line = line_of_row(row - 1, NULL);
         g_app.caret.col = get_line_length(g_app.caret.line);
     }
 }
 
 void move_cursor_right(void) {
     int line_len = get_line_length(g_app.caret.line);
+    int64_t next = row_of_line(g_app.caret.line) + line_rows(g_app.caret.line);
     if (g_app.caret.col < line_len) {
         g_app.caret.col++;
-    } else {
-        g_app.caret.line++;
+    } else if (next < get_row_count()) {
+        g_app.caret.line = line_of_row(next, NULL);
         g_app.caret.col = 0;
     }
-}
\ No newline at end of file
+}
+
+void move_cursor_page(int direction) {
+    int page = g_app.visible_lines > 1 ? g_app.visible_lines - 1 : 1;
+    int64_t row = caret_row() + direction * page;
+    int64_t rows = get_row_count();
+    if (row >= rows) row = rows - 1;
+    if (row < 0) row = 0;
+    caret_to_row(row, caret_x());
+}
+
+void goto_line(int64_t line_num) {
+    int64_t count = get_line_count();
+    if (line_num >= count) line_num = count - 1;
+    if (line_num < 0) line_num = 0;
+    g_app.caret.line = line_num;
+    int line_len = get_line_length(line_num);
+    if (g_app.caret.col > line_len) {
+        g_app.caret.col = line_len;
+    }
+}
+
+// Lines and percentages count the rows of the filter view while it is up,
+// as goto_line() does; an offset is always into the text
+void goto_jump(const GotoTarget *target) {
+    switch (target->kind) {
+        case GOTO_OFFSET:
+            move_cursor_to_index(target->offset);
+            break;
+        case GOTO_PERCENT:
+            goto_line((int64_t)goto_percent_line(target->percent, (size_t)get_line_count()));
+            break;
+        case GOTO_LINE:
+            goto_line(target->line < INT64_MAX ? (int64_t)target->line : INT64_MAX);
+            if (target->col != GOTO_KEEP_COL) {
+                int len = get_line_length(g_app.caret.line);
+                g_app.caret.col = target->col < (size_t)len ? (int)target->col : len;
+            }
+            break;
+    }
+    g_app.center_caret = true;
+}
+
+// To the bracket matching the one at the caret (or just before it)
+void move_cursor_to_bracket(void) {
+    if (g_app.filter.active) return;
+    size_t at, line, col;
+    BxFind found = hl_match_bracket(&g_app.hl, (size_t)g_app.caret.line, (size_t)g_app.caret.col,
+                                    &at, &line, &col);
+    if (found == BX_FOUND) {
+        g_app.caret.line = (int64_t)line;
+        g_app.caret.col = (int)col;
+    } else {
+        strcpy(g_app.overlay_text, found == BX_PENDING ? "Matching bracket: still indexing"
+                                                       : "No matching bracket");
+        g_app.show_overlay = true;
+    }
+}
@@ -2,13 +2,28 @@
 #define CURSOR_H
 
 #include "app.h"
+#include "goto_target.h"
 
 size_t get_cursor_index(void);
 void move_cursor_to_index(size_t target_index);
-int get_line_length(int line_num);
+int64_t get_line_count(void);
+int get_line_length(int64_t line_num);
+int64_t get_row_count(void);
+int64_t row_of_line(int64_t line);
+int64_t line_of_row(int64_t row, int *sub);
+int line_rows(int64_t line);
+int64_t caret_row(void);
+int wrap_columns(void);
+void sync_rows(void);
+size_t wrapped_rows_before(void *ctx, size_t line);
 void move_cursor_up(void);
 void move_cursor_down(void);
 void move_cursor_left(void);
 void move_cursor_right(void);
+void move_cursor_page(int direction);
+void goto_line(int64_t line_num);
+// To a go-to prompt target, scrolled to the middle of the pane
+void goto_jump(const GotoTarget *target);
+void move_cursor_to_bracket(void);
 
 #endif
\ No newline at end of file
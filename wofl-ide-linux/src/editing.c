@@ -1,64 +1,362 @@
+#define _DEFAULT_SOURCE
 #include "editing.h"
 #include "gap_buffer.h"
 #include "cursor.h"
+#include "carets.h"
 
-void insert_text_at_cursor(const char *text, size_t len) {
-    size_t cursor_index = get_cursor_index();
-    size_t buf_len = gb_length(&g_app.buf);
-    size_t new_len = buf_len + len;
+#define BATCH_RELEX_EDITS   64      // edits changing the line count before a batch is lexed over
+
+// Between buffer_batch_begin() and _end() the highlighter is stopped and
+// hears of no edit; the text is lexed over once at the outermost end
+static int batching;
+
+// Edits so far, and texts the buffer was given whole
+static size_t edits;
+
+// The line index is built on a worker thread that reads g_app.buf, so all
+// buffer changes go through buffer_insert/buffer_delete under its lock.
+// The highlight worker reads it too; its lock is taken first and held
+// until the edit is reported, so it never publishes tokens for old text.
+
+static const void *buf_segment(void *ctx, size_t pos, size_t *avail) {
+    return gb_segment((const GapBuffer *)ctx, pos, avail);
+}
+
+static size_t buf_length(void *ctx) {
+    return gb_length((const GapBuffer *)ctx);
+}
+
+static size_t buf_read_line(void *ctx, size_t line, char *out, size_t max) {
+    const GapBuffer *gb = ctx;
+    lix_lock(&g_app.lines);
+    size_t pos = li_line_start(&g_app.lines.index, line);
+    size_t len = li_line_length(&g_app.lines.index, line);
+    size_t n = 0;
+    while (n < len && n < max) {
+        size_t avail;
+        const char *p = gb_segment(gb, pos + n, &avail);
+        if (!p) break;
+        if (avail > len - n) avail = len - n;
+        if (avail > max - n) avail = max - n;
+        memcpy(out + n, p, avail);
+        n += avail;
+    }
+    lix_unlock(&g_app.lines);
+    return len;
+}
+
+// The last line is only complete once indexing is done
+static size_t buf_line_count(void *ctx) {
+    (void)ctx;
+    lix_lock(&g_app.lines);
+    size_t n = li_line_count(&g_app.lines.index);
+    if (!lix_done(&g_app.lines)) n--;
+    lix_unlock(&g_app.lines);
+    return n;
+}
+
+// Word completion reads the buffer on this thread, where it is edited
+static unsigned buf_char(void *ctx, size_t pos) {
+    return (unsigned char)gb_char_at((const GapBuffer *)ctx, pos);
+}
+
+// The view is read with pread through the worker's own cursor
+static FvCursor view_cursor;
+
+static size_t view_read_line(void *ctx, size_t line, char *out, size_t max) {
+    return (size_t)fv_pread_line(ctx, &view_cursor, line, out, max);
+}
+
+static size_t view_line_count(void *ctx) {
+    return (size_t)fv_line_count(ctx);
+}
+
+// Newlines in buf[pos, pos + len)
+static size_t buffer_newlines(size_t pos, size_t len) {
+    size_t n = 0;
+    while (len > 0) {
+        size_t avail;
+        const char *p = gb_segment(&g_app.buf, pos, &avail);
+        if (!p) break;
+        if (avail > len) avail = len;
+        n += nl_count(p, avail, 1);
+        pos += avail;
+        len -= avail;
+    }
+    return n;
+}
+
+void buffer_index_start(void) {
+    LineSource src = { buf_segment, buf_length, &g_app.buf, 1 };
+    hl_stop(&g_app.hl);
+    lix_start(&g_app.lines, src);
+    an_reset(&g_app.anchors, gb_length(&g_app.buf));
+    edits++;
+    buffer_highlight_start();
+}
+
+void buffer_highlight_start(void) {
+    if (batching) return;           // buffer_batch_end() starts it
+    HlSource src = { buf_read_line, buf_line_count, &g_app.buf };
+    if (g_app.view_mode) {
+        memset(&view_cursor, 0, sizeof(view_cursor));
+        src = (HlSource){ view_read_line, view_line_count, &g_app.view };
+    }
+    hl_start(&g_app.hl, g_app.syntax, g_app.lang, src);
+}
+
+size_t buffer_edits(void) {
+    return edits;
+}
+
+WcSource buffer_words(void) {
+    WcSource src = { buf_char, buf_length, &g_app.buf };
+    return src;
+}
+
+// Count the words of a new document for completion; path may be empty
+void buffer_words_open(const char *path) {
+    size_t len = path ? strlen(path) : 0;
+    wc_open(&g_app.words, buffer_words(), len ? wc_name_id(path, len) : 0);
+}
+
+/**
+ * Many edits in a row, as a macro plays them: shifting the tokens, lexer
+ * states and brackets costs a pass over them for each edit that adds or
+ * removes a line, so the highlighter is stopped until buffer_batch_end()
+ * and then lexes the text once. The line index, anchors, folds and words
+ * still follow every edit, at about the cost of the edit itself. Matching
+ * brackets are not known meanwhile. Batches nest.
+ */
+void buffer_batch_begin(void) {
+    if (batching++ > 0) return;
+    hl_stop(&g_app.hl);
+}
+
+void buffer_batch_end(void) {
+    if (batching == 0 || --batching > 0) return;
+    buffer_highlight_start();
+}
+
+void buffer_insert(size_t pos, const char *text, size_t len) {
+    if (len == 0) return;
+    hl_lock(&g_app.hl);
+    lix_lock(&g_app.lines);
+    size_t line = li_line_of(&g_app.lines.index, pos);
+    gb_move_gap(&g_app.buf, pos);
+    gb_insert(&g_app.buf, text, len);
+    lix_note_insert(&g_app.lines, pos, text, len);
+    lix_unlock(&g_app.lines);
+    edits++;
+    an_note_insert(&g_app.anchors, pos, len);
+    long added = (long)nl_count(text, len, 1);
+    if (!batching) hl_note_edit(&g_app.hl, line, added);
+    hl_unlock(&g_app.hl);
+    ft_note_edit(&g_app.folds, line, added);
+    wc_note_insert(&g_app.words, buffer_words(), pos, len);
+}
+
+void buffer_delete(size_t pos, size_t len) {
+    wc_note_delete(&g_app.words, buffer_words(), pos, len);
+    hl_lock(&g_app.hl);
+    lix_lock(&g_app.lines);
+    size_t total = gb_length(&g_app.buf);
+    size_t line = li_line_of(&g_app.lines.index, pos);
+    size_t removed = 0;
+    bool changed = pos < total && len > 0;
+    if (changed) {
+        if (pos + len > total) len = total - pos;
+        removed = buffer_newlines(pos, len);
+        gb_delete_range(&g_app.buf, pos, len);
+        lix_note_delete(&g_app.lines, pos, len);
+        an_note_delete(&g_app.anchors, pos, len);
+        edits++;
+    }
+    lix_unlock(&g_app.lines);
+    if (changed && !batching) hl_note_edit(&g_app.hl, line, -(long)removed);
+    hl_unlock(&g_app.hl);
+    ft_note_edit(&g_app.folds, line, -(long)removed);
+}
+
+/**
+ * Many edits as one batch (edit_batch.h): the buffer is rebuilt in one pass
+ * from the first to the last, and the line index, tokens, folds and words
+ * hear of each edit in turn, as though made one at a time from the left.
+ * Sets each op's end in the new text. When many change the line count,
+ * the tokens are lexed over instead, as shifting them per edit would cost
+ * more.
+ */
+void buffer_apply(EditOp *ops, size_t n) {
+    if (n == 0) return;
+    const size_t total = gb_length(&g_app.buf);
+    for (size_t i = 0; i < n; i++) {
+        if (ops[i].pos > total) ops[i].pos = total;
+        if (ops[i].del > total - ops[i].pos) ops[i].del = total - ops[i].pos;
+    }
+    const size_t inserted = eb_prepare(ops, n);
+    long *delta = malloc(n * sizeof(long));
+    size_t *lines = malloc(n * sizeof(size_t));
+    if (!delta || !lines) {
+        free(delta);
+        free(lines);
+        return;
+    }
+    size_t moved = 0;
+    bool changed = false;
+    for (size_t i = 0; i < n; i++) {
+        delta[i] = (long)nl_count(ops[i].text, ops[i].len, 1) - (long)buffer_newlines(ops[i].pos, ops[i].del);
+        moved += delta[i] != 0;
+        changed |= ops[i].del > 0 || ops[i].len > 0;
+    }
+    wc_note_batch(&g_app.words, buffer_words(), ops, n, false);
     
-    if (g_app.buf.gap_end - g_app.buf.gap_start < len) {
-        size_t new_cap = g_app.buf.capacity;
-        while (new_cap - buf_len < len + 100) {
-            new_cap *= 2;
-        }
-        
-        char *new_data = malloc(new_cap);
-        
-        for (size_t i = 0; i < cursor_index; i++) {
-            new_data[i] = gb_char_at(&g_app.buf, i);
-        }
-        
-        memcpy(new_data + cursor_index, text, len);
-        
-        for (size_t i = cursor_index; i < buf_len; i++) {
-            new_data[i + len] = gb_char_at(&g_app.buf, i);
-        }
-        
-        free(g_app.buf.data);
-        g_app.buf.data = new_data;
-        g_app.buf.capacity = new_cap;
-        g_app.buf.gap_start = cursor_index + len;
-        g_app.buf.gap_end = new_cap - (buf_len - cursor_index);
+    hl_lock(&g_app.hl);
+    lix_lock(&g_app.lines);
+    gb_ensure(&g_app.buf, inserted);
+    if (g_app.buf.gap_end - g_app.buf.gap_start < inserted) {
+        // Out of memory: nothing changed
+        lix_unlock(&g_app.lines);
+        hl_unlock(&g_app.hl);
+        free(delta);
+        free(lines);
+        return;
+    }
+    gb_move_gap(&g_app.buf, ops[0].pos);
+    EditGap gap = { g_app.buf.data, g_app.buf.capacity, g_app.buf.gap_start, g_app.buf.gap_end, 1 };
+    eb_apply(&gap, ops, n);
+    g_app.buf.gap_start = gap.gap_start;
+    g_app.buf.gap_end = gap.gap_end;
+    g_app.buf.dirty = true;
+    edits += changed;
+    
+    // The index takes the edits from the left, each where the ones before
+    // it left its text
+    for (size_t i = 0; i < n; i++) {
+        const size_t pos = ops[i].at - ops[i].len;
+        lines[i] = li_line_of(&g_app.lines.index, pos);
+        lix_note_delete(&g_app.lines, pos, ops[i].del);
+        lix_note_insert(&g_app.lines, pos, ops[i].text, ops[i].len);
+    }
+    lix_unlock(&g_app.lines);
+    an_note_batch(&g_app.anchors, ops, n);
+    const bool relex = batching || moved > BATCH_RELEX_EDITS;
+    for (size_t i = 0; i < n && !relex; i++) {
+        if (i > 0 && delta[i] == 0 && delta[i - 1] == 0 && lines[i] == lines[i - 1]) continue;
+        hl_note_edit(&g_app.hl, lines[i], delta[i]);
+    }
+    hl_unlock(&g_app.hl);
+    if (relex) buffer_highlight_start();
+    for (size_t i = 0; i < n; i++) {
+        if (delta[i] != 0 || i == 0 || lines[i] != lines[i - 1]) ft_note_edit(&g_app.folds, lines[i], delta[i]);
+    }
+    wc_note_batch(&g_app.words, buffer_words(), ops, n, true);
+    free(delta);
+    free(lines);
+}
+
+/**
+ * A line operation over the whole buffer (line_ops.h): the new text is
+ * written in one pass and goes in as a single edit over the part that
+ * changed. Lines move wholesale, so the tokens are lexed over once rather
+ * than shifted first; the caret keeps its line number. Not in the
+ * read-only views.
+ */
+void buffer_line_op(LineOp op) {
+    if (g_app.view_mode || g_app.filter.active) {
+        snprintf(g_app.overlay_text, sizeof(g_app.overlay_text), "%s: not available in this view", lo_name(op));
+        g_app.show_overlay = true;
+        return;
+    }
+    // Contiguous, as the filter reads it
+    lix_lock(&g_app.lines);
+    const size_t len = gb_length(&g_app.buf);
+    gb_move_gap(&g_app.buf, len);
+    const char *text = g_app.buf.data;
+    lix_unlock(&g_app.lines);
+    
+    // Tab types four spaces
+    LineOpArgs args = { op, 0, 4, 0 };
+    if (op == LO_SORT_COLUMN) args.column = lo_column_at(text, len, 1, get_cursor_index());
+    LineOpResult r;
+    if (!lo_run(&args, text, len, 1, &r)) {
+        snprintf(g_app.overlay_text, sizeof(g_app.overlay_text), "%s: out of memory", lo_name(op));
+        g_app.show_overlay = true;
+        return;
+    }
+    
+    EditOp edit = { r.keep_head, len - r.keep_head - r.keep_tail, (const char *)r.text + r.keep_head,
+                    r.len - r.keep_head - r.keep_tail, 0, 0 };
+    const bool changed = edit.del > 0 || edit.len > 0;
+    if (changed) {
+        carets_clear();
+        buffer_batch_begin();
+        buffer_apply(&edit, 1);
+        buffer_batch_end();
+        goto_line(g_app.caret.line);
+    }
+    if (op == LO_SORT_COLUMN) {
+        snprintf(g_app.overlay_text, sizeof(g_app.overlay_text), "%s %zu: %zu lines%s", lo_name(op),
+                 args.column + 1, r.lines_in, changed ? "" : ", already in order");
     } else {
-        gb_ensure(&g_app.buf, len);
-        memmove(g_app.buf.data + cursor_index + len, 
-                g_app.buf.data + cursor_index, 
-                buf_len - cursor_index);
-        memcpy(g_app.buf.data + cursor_index, text, len);
-        g_app.buf.gap_start += len;
+        snprintf(g_app.overlay_text, sizeof(g_app.overlay_text), "%s: %zu lines, now %zu%s", lo_name(op),
+                 r.lines_in, r.lines_out, changed ? "" : ", nothing to change");
     }
+    g_app.show_overlay = true;
+    lo_result_free(&r);
+}
+
+// Append up to max bytes of fd, read from offset, at the end of the buffer.
+// The bytes land straight in the gap, which the indexer never reads, so the
+// read itself runs unlocked. Returns the bytes appended.
+size_t buffer_append_fd(int fd, off_t offset, size_t max) {
+    lix_lock(&g_app.lines);
+    gb_move_gap(&g_app.buf, gb_length(&g_app.buf));
+    gb_ensure(&g_app.buf, max);
+    bool room = g_app.buf.gap_end - g_app.buf.gap_start >= max;
+    lix_unlock(&g_app.lines);
+    if (!room) return 0;
+    
+    char *dst = g_app.buf.data + g_app.buf.gap_start;
+    ssize_t got = pread(fd, dst, max, offset);
+    if (got <= 0) return 0;
     
+    hl_lock(&g_app.hl);
+    lix_lock(&g_app.lines);
+    size_t pos = g_app.buf.gap_start;
+    size_t line = li_line_of(&g_app.lines.index, pos);
+    g_app.buf.gap_start += (size_t)got;
+    lix_note_insert(&g_app.lines, pos, dst, (size_t)got);
+    lix_unlock(&g_app.lines);
+    edits++;
+    an_note_insert(&g_app.anchors, pos, (size_t)got);
+    long added = (long)nl_count(dst, (size_t)got, 1);
+    hl_note_edit(&g_app.hl, line, added);
+    hl_unlock(&g_app.hl);
+    ft_note_edit(&g_app.folds, line, added);
+    wc_note_insert(&g_app.words, buffer_words(), pos, (size_t)got);
+    return (size_t)got;
+}
+
+void insert_text_at_cursor(const char *text, size_t len) {
+    if (g_app.view_mode || g_app.filter.active) return;   // views are read-only
+    size_t cursor_index = get_cursor_index();
+    buffer_insert(cursor_index, text, len);
     move_cursor_to_index(cursor_index + len);
-    g_app.buf.dirty = true;
 }
 
 void delete_at_cursor(bool forward) {
+    if (g_app.view_mode || g_app.filter.active) return;
     size_t cursor_index = get_cursor_index();
     size_t buf_len = gb_length(&g_app.buf);
     
     if (forward) {
         if (cursor_index < buf_len) {
-            g_app.buf.gap_start = cursor_index;
-            g_app.buf.gap_end = g_app.buf.gap_start + 1;
-            if (g_app.buf.gap_end > g_app.buf.capacity) g_app.buf.gap_end = g_app.buf.capacity;
+            buffer_delete(cursor_index, 1);
         }
     } else {
         if (cursor_index > 0) {
+            buffer_delete(cursor_index - 1, 1);
             move_cursor_to_index(cursor_index - 1);
-            delete_at_cursor(true);
         }
     }
-    
-    g_app.buf.dirty = true;
 }
\ No newline at end of file
@@ -2,7 +2,20 @@
 #define EDITING_H
 
 #include "app.h"
+#include "line_ops.h"
 
+void buffer_index_start(void);
+void buffer_highlight_start(void);
+size_t buffer_edits(void);
+void buffer_words_open(const char *path);
+WcSource buffer_words(void);
+void buffer_batch_begin(void);
+void buffer_batch_end(void);
+void buffer_insert(size_t pos, const char *text, size_t len);
+void buffer_delete(size_t pos, size_t len);
+void buffer_apply(EditOp *ops, size_t n);
+void buffer_line_op(LineOp op);
+size_t buffer_append_fd(int fd, off_t offset, size_t max);
 void insert_text_at_cursor(const char *text, size_t len);
 void delete_at_cursor(bool forward);
 
@@ -1,7 +1,66 @@
 #include "file_ops.h"
 #include "gap_buffer.h"
+#include "editing.h"
+#include "follow.h"
+#include "filter.h"
+#include "language.h"
+#include "complete.h"
+#include "carets.h"
+#include <sys/stat.h>
+
+static void set_file_name(const char *filename) {
+    snprintf(g_app.file_path, sizeof(g_app.file_path), "%s", filename);
+    const char *name = strrchr(filename, '/');
+    snprintf(g_app.file_name, sizeof(g_app.file_name), "%s", name ? name + 1 : filename);
+    select_language(filename);
+    pal_recent_push(&g_app.recent, filename);
+}
+
+// Drop whatever is loaded: a filter, a followed file, folds, an open view and the buffer
+static void reset_document(void) {
+    complete_close();
+    carets_clear();
+    filter_close(false);
+    follow_stop();
+    hl_stop(&g_app.hl);
+    lix_stop(&g_app.lines);
+    ft_clear(&g_app.folds);
+    fv_close(&g_app.view);
+    g_app.view_mode = false;
+    gb_free(&g_app.buf);
+    gb_init(&g_app.buf);
+}
+
+bool open_view(const char *filename) {
+    // The indexer keeps a pointer to the view, so it is opened in place;
+    // what would stop it is checked first, to keep the document open until then
+    struct stat st;
+    if (stat(filename, &st) != 0 || !S_ISREG(st.st_mode) || access(filename, R_OK) != 0) return false;
+    
+    reset_document();
+    if (!fv_open(&g_app.view, filename)) {
+        buffer_index_start();
+        return false;
+    }
+    buffer_index_start();
+    g_app.view_mode = true;
+    an_reset(&g_app.anchors, (size_t)g_app.view.size);
+    g_app.scroll_y = 0;
+    g_app.scroll_x = 0;
+    g_app.caret.line = 0;
+    g_app.caret.col = 0;
+    set_file_name(filename);
+    buffer_words_open(filename);
+    return true;
+}
 
 bool load_file(const char *filename) {
+    // Files this large are paged in from disk instead of loaded
+    struct stat st;
+    if (stat(filename, &st) == 0 && (unsigned long long)st.st_size >= FV_AUTO_VIEW_BYTES) {
+        return open_view(filename);
+    }
+    
     FILE *f = fopen(filename, "r");
     if (!f) return false;
     
@@ -9,20 +68,20 @@ bool load_file(const char *filename) {
     long size = ftell(f);
     fseek(f, 0, SEEK_SET);
     
-    gb_free(&g_app.buf);
-    gb_init(&g_app.buf);
+    reset_document();
     
-    char buffer[4096];
-    size_t read_size;
-    while ((read_size = fread(buffer, 1, sizeof(buffer), f)) > 0) {
-        gb_insert(&g_app.buf, buffer, read_size);
+    // Read straight into the buffer; lines are indexed in the background
+    if (size > 0) {
+        gb_ensure(&g_app.buf, (size_t)size);
+        g_app.buf.gap_start = fread(g_app.buf.data, 1, (size_t)size, f);
     }
     
     fclose(f);
-    strcpy(g_app.file_path, filename);
-    
-    const char *name = strrchr(filename, '/');
-    strcpy(g_app.file_name, name ? name + 1 : filename);
+    buffer_index_start();
+    g_app.scroll_y = 0;
+    g_app.scroll_x = 0;
+    set_file_name(filename);
+    buffer_words_open(filename);
     
     g_app.buf.dirty = false;
     return true;
@@ -48,46 +107,6 @@ bool gb_save_to_file(GapBuffer *gb, const char *path, EolMode eol) {
 
 #include <sys/wait.h>
 
-bool open_file_dialog(char *selected_path, size_t max_len) {
-    // Use zenity for file dialog if available
-    FILE *fp = popen("which zenity", "r");
-    if (!fp) return false;
-    
-    char path[256];
-    bool has_zenity = (fgets(path, sizeof(path), fp) != NULL);
-    pclose(fp);
-    
-    if (has_zenity) {
-        // Use zenity file dialog
-        fp = popen("zenity --file-selection --title=\"Open File\"", "r");
-        if (fp) {
-            if (fgets(selected_path, max_len, fp)) {
-                // Remove newline
-                size_t len = strlen(selected_path);
-                if (len > 0 && selected_path[len-1] == '\n') {
-                    selected_path[len-1] = '\0';
-                }
-                pclose(fp);
-                return true;
-            }
-            pclose(fp);
-        }
-    }
-    
-    // Fallback: simple console input
-    printf("Enter file path to open: ");
-    fflush(stdout);
-    if (fgets(selected_path, max_len, stdin)) {
-        size_t len = strlen(selected_path);
-        if (len > 0 && selected_path[len-1] == '\n') {
-            selected_path[len-1] = '\0';
-        }
-        return selected_path[0] != '\0';
-    }
-    
-    return false;
-}
-
 bool save_file_dialog(char *selected_path, size_t max_len) {
     FILE *fp = popen("which zenity", "r");
     if (!fp) return false;
@@ -126,6 +145,12 @@ bool save_file_dialog(char *selected_path, size_t max_len) {
 }
 
 void save_file() {
+    if (g_app.view_mode) {
+        strcpy(g_app.overlay_text, "Read-only view: nothing to save");
+        g_app.show_overlay = true;
+        return;
+    }
+    
     if (!g_app.file_path[0]) {
         strcpy(g_app.file_path, "untitled.txt");
         strcpy(g_app.file_name, "untitled.txt");
@@ -134,6 +159,7 @@ void save_file() {
     if (gb_save_to_file(&g_app.buf, g_app.file_path, EOL_LF)) {
         printf("Saved: %s\n", g_app.file_path);
         g_app.buf.dirty = false;
+        six_refresh(&g_app.symbols);
     } else {
         printf("Save failed: %s\n", g_app.file_path);
     }
@@ -4,9 +4,9 @@
 #include "app.h"
 
 bool load_file(const char *filename);
+bool open_view(const char *filename);
 bool gb_save_to_file(GapBuffer *gb, const char *path, EolMode eol);
 void save_file();
-bool open_file_dialog(char *selected_path, size_t max_len);
 bool save_file_dialog(char *selected_path, size_t max_len);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,360 @@
+#define _DEFAULT_SOURCE
+#include "file_view.h"
+#include "newline_scan.h"
+#include "find.h"
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define FV_NONE UINT64_MAX
+#define FV_PREAD_BYTES (64u << 10)
+
+static uint64_t page_size(void) {
+    long page = sysconf(_SC_PAGESIZE);
+    return page > 0 ? (uint64_t)page : 4096;
+}
+
+static const char *map_range(int fd, uint64_t off, size_t len) {
+    void *p = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, (off_t)off);
+    if (p == MAP_FAILED) return NULL;
+    madvise(p, len, MADV_SEQUENTIAL);
+    return p;
+}
+
+// ===== Sparse index worker =====
+
+static bool push_checkpoint(FileView *fv, uint64_t offset) {
+    if (fv->checkpoint_count == fv->checkpoint_cap) {
+        size_t cap = fv->checkpoint_cap * 2;
+        uint64_t *grown = realloc(fv->checkpoints, cap * sizeof(*grown));
+        if (!grown) return false;
+        fv->checkpoints = grown;
+        fv->checkpoint_cap = cap;
+    }
+    fv->checkpoints[fv->checkpoint_count++] = offset;
+    return true;
+}
+
+static WOFL_THREAD_FN(fv_indexer) {
+    FileView *fv = arg;
+    uint64_t off = 0;
+    uint64_t line = 0;      // newlines seen before off
+    bool ok = true;
+
+    while (ok && off < fv->size) {
+        wofl_mutex_lock(&fv->lock);
+        bool cancel = fv->cancel;
+        wofl_mutex_unlock(&fv->lock);
+        if (cancel) break;
+
+        size_t len = FV_SCAN_BYTES;
+        if (len > fv->size - off) len = (size_t)(fv->size - off);
+        const char *p = map_range(fv->fd, off, len);
+        if (!p) break;
+
+        // Hop from checkpoint to checkpoint with the newline kernel
+        size_t pos = 0;
+        for (;;) {
+            size_t need = FV_CHECKPOINT_LINES - (size_t)(line % FV_CHECKPOINT_LINES);
+            size_t k = need;
+            size_t hit = nl_find_nth(p + pos, len - pos, 1, &k);
+            line += need - k;
+            if (k != 0) break;
+            pos += hit + 1;
+
+            wofl_mutex_lock(&fv->lock);
+            ok = push_checkpoint(fv, off + pos);
+            fv->lines = line + 1;
+            wofl_mutex_unlock(&fv->lock);
+            if (!ok) break;
+        }
+        munmap((void *)p, len);
+        off += len;
+
+        wofl_mutex_lock(&fv->lock);
+        if (ok) {
+            fv->lines = line + 1;
+            fv->scanned = off;
+        }
+        wofl_mutex_unlock(&fv->lock);
+    }
+
+    wofl_mutex_lock(&fv->lock);
+    fv->done = true;
+    wofl_mutex_unlock(&fv->lock);
+    WOFL_THREAD_RETURN;
+}
+
+// ===== Open / close =====
+
+bool fv_open(FileView *fv, const char *path) {
+    memset(fv, 0, sizeof(*fv));
+    fv->fd = open(path, O_RDONLY);
+    if (fv->fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fv->fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fv->fd);
+        return false;
+    }
+    fv->size = (uint64_t)st.st_size;
+
+    fv->checkpoint_cap = 1024;
+    fv->checkpoints = malloc(fv->checkpoint_cap * sizeof(*fv->checkpoints));
+    if (!fv->checkpoints) {
+        close(fv->fd);
+        return false;
+    }
+    fv->checkpoints[0] = 0;
+    fv->checkpoint_count = 1;
+    fv->lines = 1;
+
+    wofl_mutex_init(&fv->lock);
+    fv->running = wofl_thread_start(&fv->thread, fv_indexer, fv);
+    if (!fv->running) fv_indexer(fv);
+    return true;
+}
+
+bool fv_is_open(const FileView *fv) {
+    return fv->checkpoints != NULL;
+}
+
+void fv_close(FileView *fv) {
+    if (!fv_is_open(fv)) return;
+
+    if (fv->running) {
+        wofl_mutex_lock(&fv->lock);
+        fv->cancel = true;
+        wofl_mutex_unlock(&fv->lock);
+        wofl_thread_join(fv->thread);
+    }
+    if (fv->win) munmap((void *)fv->win, fv->win_len);
+    close(fv->fd);
+    free(fv->checkpoints);
+    wofl_mutex_destroy(&fv->lock);
+    memset(fv, 0, sizeof(*fv));
+}
+
+uint64_t fv_line_count(FileView *fv) {
+    wofl_mutex_lock(&fv->lock);
+    uint64_t lines = fv->lines;
+    wofl_mutex_unlock(&fv->lock);
+    return lines;
+}
+
+int fv_progress_permille(FileView *fv) {
+    wofl_mutex_lock(&fv->lock);
+    int permille = fv->done || fv->size == 0 ? 1000 : (int)(fv->scanned * 1000 / fv->size);
+    wofl_mutex_unlock(&fv->lock);
+    return permille;
+}
+
+// ===== Viewport window =====
+
+// Map the window holding `off`; returns a pointer to it and the bytes
+// available from there to the end of the window
+static const char *fv_window(FileView *fv, uint64_t off, size_t *avail) {
+    *avail = 0;
+    if (off >= fv->size) return NULL;
+
+    if (!fv->win || off < fv->win_off || off >= fv->win_off + fv->win_len) {
+        // Leave some room behind the target for scrolling back up
+        uint64_t base = off > FV_WINDOW_BYTES / 4 ? off - FV_WINDOW_BYTES / 4 : 0;
+        base -= base % page_size();
+        size_t len = FV_WINDOW_BYTES;
+        if (len > fv->size - base) len = (size_t)(fv->size - base);
+
+        if (fv->win) munmap((void *)fv->win, fv->win_len);
+        fv->win = map_range(fv->fd, base, len);
+        if (!fv->win) return NULL;
+        fv->win_off = base;
+        fv->win_len = len;
+    }
+
+    *avail = (size_t)(fv->win_off + fv->win_len - off);
+    return fv->win + (off - fv->win_off);
+}
+
+// Offset just past the k-th newline at or after off, or FV_NONE
+static uint64_t skip_lines(FileView *fv, uint64_t off, size_t k) {
+    while (k > 0) {
+        size_t avail;
+        const char *p = fv_window(fv, off, &avail);
+        if (!p) return FV_NONE;
+        size_t hit = nl_find_nth(p, avail, 1, &k);
+        if (k == 0) return off + hit + 1;
+        off += avail;
+    }
+    return off;
+}
+
+static uint64_t count_lines(FileView *fv, uint64_t from, uint64_t to) {
+    const uint64_t page = page_size();
+    uint64_t count = 0;
+    while (from < to) {
+        uint64_t base = from - from % page;
+        size_t len = FV_SCAN_BYTES;
+        if (len > to - base) len = (size_t)(to - base);
+        const char *p = map_range(fv->fd, base, len);
+        if (!p) break;
+        count += nl_count(p + (from - base), len - (size_t)(from - base), 1);
+        munmap((void *)p, len);
+        from = base + len;
+    }
+    return count;
+}
+
+// ===== Queries =====
+
+bool fv_line_offset(FileView *fv, uint64_t line, uint64_t *offset) {
+    wofl_mutex_lock(&fv->lock);
+    bool known = line < fv->lines;
+    uint64_t base = known ? fv->checkpoints[line / FV_CHECKPOINT_LINES] : 0;
+    wofl_mutex_unlock(&fv->lock);
+    if (!known) return false;
+
+    uint64_t from = line - line % FV_CHECKPOINT_LINES;
+    if (fv->hint_valid && fv->hint_line <= line && fv->hint_line >= from) {
+        from = fv->hint_line;
+        base = fv->hint_off;
+    }
+    uint64_t off = skip_lines(fv, base, (size_t)(line - from));
+    if (off == FV_NONE) return false;
+    fv->hint_valid = true;
+    fv->hint_line = line;
+    fv->hint_off = off;
+    *offset = off;
+    return true;
+}
+
+uint64_t fv_line_of_offset(FileView *fv, uint64_t offset) {
+    if (offset > fv->size) offset = fv->size;
+
+    // Last checkpoint at or before offset
+    wofl_mutex_lock(&fv->lock);
+    size_t lo = 0, hi = fv->checkpoint_count;
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (fv->checkpoints[mid] <= offset) lo = mid;
+        else hi = mid;
+    }
+    uint64_t base = fv->checkpoints[lo];
+    wofl_mutex_unlock(&fv->lock);
+
+    return (uint64_t)lo * FV_CHECKPOINT_LINES + count_lines(fv, base, offset);
+}
+
+size_t fv_read_line(FileView *fv, uint64_t line, char *out, size_t max) {
+    size_t n = 0;
+    uint64_t off;
+    if (max == 0) return 0;
+    if (!fv_line_offset(fv, line, &off)) {
+        out[0] = '\0';
+        return 0;
+    }
+
+    while (n < max - 1) {
+        size_t avail;
+        const char *p = fv_window(fv, off, &avail);
+        if (!p) break;
+        size_t take = avail < max - 1 - n ? avail : max - 1 - n;
+        const char *nl = memchr(p, '\n', take);
+        if (nl) take = (size_t)(nl - p);
+        memcpy(out + n, p, take);
+        n += take;
+        off += take;
+        if (nl) {
+            fv->hint_line = line + 1;
+            fv->hint_off = off + 1;
+            break;
+        }
+    }
+    out[n] = '\0';
+    return n;
+}
+
+// Length of a line without its newline, however long
+uint64_t fv_line_length(FileView *fv, uint64_t line) {
+    uint64_t off;
+    if (!fv_line_offset(fv, line, &off)) return 0;
+    uint64_t end = skip_lines(fv, off, 1);
+    return end == FV_NONE ? fv->size - off : end - 1 - off;
+}
+
+// ===== Other threads =====
+
+/**
+ * Copy up to max bytes of a line into out and return its full length,
+ * without the window or hints, so any thread may call it. A line right
+ * after the cursor's is read without going back to a checkpoint.
+ */
+uint64_t fv_pread_line(FileView *fv, FvCursor *cur, uint64_t line, char *out, size_t max) {
+    wofl_mutex_lock(&fv->lock);
+    bool known = line < fv->lines;
+    uint64_t off = known ? fv->checkpoints[line / FV_CHECKPOINT_LINES] : 0;
+    wofl_mutex_unlock(&fv->lock);
+    if (!known) return 0;
+
+    uint64_t from = line - line % FV_CHECKPOINT_LINES;
+    if (cur->valid && cur->line <= line && cur->line >= from) {
+        from = cur->line;
+        off = cur->off;
+    }
+
+    char chunk[FV_PREAD_BYTES];
+    size_t k = (size_t)(line - from);
+    while (k > 0) {
+        ssize_t got = pread(fv->fd, chunk, sizeof(chunk), (off_t)off);
+        if (got <= 0) return 0;
+        size_t hit = nl_find_nth(chunk, (size_t)got, 1, &k);
+        off += k == 0 ? hit + 1 : (size_t)got;
+    }
+
+    uint64_t len = 0;
+    for (;;) {
+        ssize_t got = pread(fv->fd, chunk, sizeof(chunk), (off_t)(off + len));
+        if (got <= 0) break;
+        const char *nl = memchr(chunk, '\n', (size_t)got);
+        size_t take = nl ? (size_t)(nl - chunk) : (size_t)got;
+        if (len < max) memcpy(out + len, chunk, take < max - len ? take : (size_t)(max - len));
+        len += take;
+        if (nl) break;
+    }
+    cur->valid = true;
+    cur->line = line + 1;
+    cur->off = off + len + 1;
+    return len;
+}
+
+// ===== Search =====
+
+bool fv_search(FileView *fv, const char *needle, uint64_t from, bool case_sensitive, uint64_t *found) {
+    size_t nlen = needle ? strlen(needle) : 0;
+    if (nlen == 0 || nlen > FV_SCAN_BYTES / 2) return false;
+
+    // Scan in mappings of FV_SCAN_BYTES that overlap by nlen - 1 bytes
+    const uint64_t page = page_size();
+    uint64_t pos = from;
+    while (pos + nlen <= fv->size) {
+        uint64_t base = pos - pos % page;
+        size_t len = FV_SCAN_BYTES;
+        if (len > fv->size - base) len = (size_t)(fv->size - base);
+        const char *p = map_range(fv->fd, base, len);
+        if (!p) return false;
+
+        size_t skip = (size_t)(pos - base);
+        size_t hit = find_in_text(p + skip, len - skip, needle, nlen, case_sensitive);
+        munmap((void *)p, len);
+        if (hit != FIND_NONE) {
+            *found = pos + hit;
+            return true;
+        }
+        if (base + len >= fv->size) break;
+        pos = base + len - (nlen - 1);
+    }
+    return false;
+}
@@ -0,0 +1,64 @@
+#ifndef FILE_VIEW_H
+#define FILE_VIEW_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "wofl_thread.h"
+
+// Read-only view of a file too large to load: the file is mmap'd a window
+// at a time and only every FV_CHECKPOINT_LINES-th line start is remembered,
+// so resident memory stays bounded whatever the file size.
+
+#define FV_CHECKPOINT_LINES 1024
+#define FV_WINDOW_BYTES     (16u << 20)       // mapping around the viewport
+#define FV_SCAN_BYTES       (64u << 20)       // mapping used by the indexer and search
+#define FV_AUTO_VIEW_BYTES  (512ull << 20)    // load_file opens larger files as views
+
+typedef struct {
+    int fd;
+    uint64_t size;
+
+    // Sparse line index, filled by a worker; guarded by lock
+    wofl_mutex lock;
+    wofl_thread thread;
+    bool running;
+    bool cancel;
+    bool done;
+    uint64_t *checkpoints;      // checkpoints[i] = offset of line i * FV_CHECKPOINT_LINES
+    size_t checkpoint_count;
+    size_t checkpoint_cap;
+    uint64_t lines;             // lines seen so far
+    uint64_t scanned;           // bytes indexed so far
+
+    // Window around the viewport; UI thread only
+    const char *win;
+    uint64_t win_off;
+    size_t win_len;
+    bool hint_valid;            // last line start found, so a frame's
+    uint64_t hint_line;         // consecutive lines scan forward from it
+    uint64_t hint_off;
+} FileView;
+
+// Position of a thread reading lines in order with fv_pread_line()
+typedef struct {
+    bool valid;
+    uint64_t line;              // the line starting at off
+    uint64_t off;
+} FvCursor;
+
+bool fv_open(FileView *fv, const char *path);
+void fv_close(FileView *fv);
+bool fv_is_open(const FileView *fv);
+
+uint64_t fv_line_count(FileView *fv);
+int fv_progress_permille(FileView *fv);
+
+bool fv_line_offset(FileView *fv, uint64_t line, uint64_t *offset);
+uint64_t fv_line_of_offset(FileView *fv, uint64_t offset);
+size_t fv_read_line(FileView *fv, uint64_t line, char *out, size_t max);
+uint64_t fv_line_length(FileView *fv, uint64_t line);
+uint64_t fv_pread_line(FileView *fv, FvCursor *cur, uint64_t line, char *out, size_t max);
+bool fv_search(FileView *fv, const char *needle, uint64_t from, bool case_sensitive, uint64_t *found);
+
+#endif
@@ -0,0 +1,308 @@
+#define _DEFAULT_SOURCE
+#include "filter.h"
+#include "find.h"
+#include "gap_buffer.h"
+#include "cursor.h"
+#include "carets.h"
+#include "split.h"
+
+// Buffers are split into at most this many chunks, one thread each, and
+// smaller buffers into fewer so every thread gets real work
+#define FILTER_MAX_JOBS     16
+#define FILTER_MIN_CHUNK    (1u << 20)
+
+typedef struct {
+    const char *text;           // the whole buffer, gap moved out of the way
+    size_t len;
+    const char *needle;
+    size_t nlen;
+    bool case_sensitive;
+
+    // Full scan: lines [from, to) of the buffer
+    size_t from, to;
+    size_t lines;               // newlines in [from, to)
+
+    // Refinement: an existing run of hits
+    const FilterHit *in;
+    size_t in_count;
+
+    FilterHit *hits;            // line numbers relative to the chunk for full scans
+    size_t count;
+    size_t cap;
+    bool failed;
+} FilterJob;
+
+static void job_push(FilterJob *job, size_t line, size_t start) {
+    if (job->count == job->cap) {
+        size_t cap = job->cap ? job->cap * 2 : 256;
+        FilterHit *grown = realloc(job->hits, cap * sizeof(*grown));
+        if (!grown) {
+            job->failed = true;
+            return;
+        }
+        job->hits = grown;
+        job->cap = cap;
+    }
+    job->hits[job->count].line = line;
+    job->hits[job->count].start = start;
+    job->count++;
+}
+
+// grep over one chunk: find the next match, count the lines skipped to get
+// there with the newline kernel, then resume after the matching line
+static WOFL_THREAD_FN(filter_scan) {
+    FilterJob *job = arg;
+    const char *p = job->text;
+    size_t pos = job->from;
+    size_t line = 0;
+    size_t line_start = job->from;
+
+    while (pos < job->to && !job->failed) {
+        size_t hit = find_in_text(p + pos, job->to - pos, job->needle, job->nlen, job->case_sensitive);
+        if (hit == FIND_NONE) break;
+        hit += pos;
+
+        size_t last = nl_find_last(p + pos, hit - pos, 1);
+        if (last != NL_NONE) {
+            line += nl_count(p + pos, hit - pos, 1);
+            line_start = pos + last + 1;
+        }
+        job_push(job, line, line_start);
+
+        const char *nl = memchr(p + hit, '\n', job->to - hit);
+        if (!nl) {
+            pos = job->to;
+            break;
+        }
+        pos = (size_t)(nl - p) + 1;
+        line++;
+        line_start = pos;
+    }
+    job->lines = line + (pos < job->to ? nl_count(p + pos, job->to - pos, 1) : 0);
+    WOFL_THREAD_RETURN;
+}
+
+// Live refinement: keep the hits whose line still matches the longer query
+static WOFL_THREAD_FN(filter_refine) {
+    FilterJob *job = arg;
+    for (size_t i = 0; i < job->in_count && !job->failed; i++) {
+        size_t start = job->in[i].start;
+        const char *nl = memchr(job->text + start, '\n', job->len - start);
+        size_t end = nl ? (size_t)(nl - job->text) : job->len;
+        if (find_in_text(job->text + start, end - start, job->needle, job->nlen,
+                         job->case_sensitive) != FIND_NONE) {
+            job_push(job, job->in[i].line, start);
+        }
+    }
+    WOFL_THREAD_RETURN;
+}
+
+static int job_count_for(size_t work, size_t min_per_job) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t jobs = cpus > 0 ? (size_t)cpus : 1;
+    if (jobs > FILTER_MAX_JOBS) jobs = FILTER_MAX_JOBS;
+    if (jobs > work / min_per_job) jobs = work / min_per_job;
+    return jobs > 0 ? (int)jobs : 1;
+}
+
+// Run jobs[0..n) on worker threads (the last on this one) and wait
+static void run_jobs(FilterJob *jobs, int n, wofl_thread_fn fn) {
+    wofl_thread threads[FILTER_MAX_JOBS];
+    bool started[FILTER_MAX_JOBS] = {false};
+    for (int i = 0; i < n - 1; i++) {
+        started[i] = wofl_thread_start(&threads[i], fn, &jobs[i]);
+        if (!started[i]) fn(&jobs[i]);
+    }
+    fn(&jobs[n - 1]);
+    for (int i = 0; i < n - 1; i++) {
+        if (started[i]) wofl_thread_join(threads[i]);
+    }
+}
+
+/**
+ * Recompute the hits for query. A query that extends the one already
+ * applied only re-tests the current hits; anything else rescans the buffer.
+ * Returns false (leaving the old hits) if memory runs out.
+ */
+static bool filter_apply(const char *query) {
+    FilterView *fv = &g_app.filter;
+    size_t nlen = strlen(query);
+    bool refine = fv->applied[0] && strstr(query, fv->applied) != NULL;
+
+    // Make the text contiguous so chunks can be scanned without the gap
+    lix_lock(&g_app.lines);
+    size_t len = gb_length(&g_app.buf);
+    gb_move_gap(&g_app.buf, len);
+    const char *text = g_app.buf.data;
+    lix_unlock(&g_app.lines);
+
+    FilterJob jobs[FILTER_MAX_JOBS];
+    int n;
+    memset(jobs, 0, sizeof(jobs));
+
+    if (refine) {
+        n = job_count_for(fv->count, 4096);
+        size_t per = fv->count / (size_t)n;
+        for (int i = 0; i < n; i++) {
+            size_t a = per * (size_t)i;
+            size_t b = i == n - 1 ? fv->count : a + per;
+            jobs[i].in = fv->hits + a;
+            jobs[i].in_count = b - a;
+        }
+    } else {
+        // Chunk edges are moved forward to line starts
+        n = job_count_for(len, FILTER_MIN_CHUNK);
+        size_t from = 0;
+        for (int i = 0; i < n; i++) {
+            size_t to = len;
+            if (i < n - 1) {
+                to = len / (size_t)n * (size_t)(i + 1);
+                if (to < from) to = from;
+                const char *nl = memchr(text + to, '\n', len - to);
+                to = nl ? (size_t)(nl - text) + 1 : len;
+            }
+            jobs[i].from = from;
+            jobs[i].to = to;
+            from = to;
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        jobs[i].text = text;
+        jobs[i].len = len;
+        jobs[i].needle = query;
+        jobs[i].nlen = nlen;
+        jobs[i].case_sensitive = g_app.find_case_sensitive;
+    }
+
+    run_jobs(jobs, n, refine ? filter_refine : filter_scan);
+
+    // Stitch the chunks together; full scans rebase their line numbers
+    size_t total = 0;
+    bool failed = false;
+    for (int i = 0; i < n; i++) {
+        total += jobs[i].count;
+        failed |= jobs[i].failed;
+    }
+    FilterHit *hits = failed ? NULL : malloc((total ? total : 1) * sizeof(*hits));
+    if (hits) {
+        size_t at = 0, base = 0;
+        for (int i = 0; i < n; i++) {
+            for (size_t k = 0; k < jobs[i].count; k++) {
+                hits[at] = jobs[i].hits[k];
+                if (!refine) hits[at].line += base;
+                at++;
+            }
+            base += jobs[i].lines;
+        }
+        free(fv->hits);
+        fv->hits = hits;
+        fv->count = total;
+        fv->cap = total;
+        snprintf(fv->applied, sizeof(fv->applied), "%s", query);
+    }
+    for (int i = 0; i < n; i++) free(jobs[i].hits);
+    return hits != NULL;
+}
+
+static void filter_update_prompt(void) {
+    FilterView *fv = &g_app.filter;
+    if (fv->query[0]) {
+        snprintf(g_app.overlay_text, sizeof(g_app.overlay_text), "Filter: %s  (%zu lines)",
+                 fv->query, fv->count);
+    } else {
+        strcpy(g_app.overlay_text, "Filter: ");
+    }
+    g_app.show_overlay = true;
+}
+
+// Re-run the filter after the query changed. The caret stays on (or just
+// below) the source line it was on.
+static void filter_refresh(void) {
+    FilterView *fv = &g_app.filter;
+    if (!fv->query[0]) {
+        // Nothing to filter by: show the buffer itself until there is
+        if (fv->active) {
+            fv->active = false;
+            fv->applied[0] = '\0';
+            fv->count = 0;
+            g_app.caret = fv->saved;
+        }
+    } else {
+        size_t source = (size_t)g_app.caret.line;
+        if (!fv->active) {
+            fv->saved = g_app.caret;
+            fv->active = true;
+        } else if (source < fv->count) {
+            source = fv->hits[source].line;
+        }
+        filter_apply(fv->query);
+        size_t row = filter_row_of_line(source);
+        if (row >= fv->count && row > 0) row--;
+        g_app.caret.line = (int64_t)row;
+        g_app.caret.col = 0;
+    }
+    filter_update_prompt();
+}
+
+void filter_start(void) {
+    FilterView *fv = &g_app.filter;
+    if (g_app.view_mode) {
+        strcpy(g_app.overlay_text, "Filter: not available in view mode");
+        g_app.show_overlay = true;
+        return;
+    }
+    carets_clear();
+    split_close();
+    fv->prompt = true;
+    filter_update_prompt();
+}
+
+void filter_input(const char *text) {
+    FilterView *fv = &g_app.filter;
+    size_t len = strlen(fv->query);
+    if (len + strlen(text) >= sizeof(fv->query)) return;
+    strcat(fv->query, text);
+    filter_refresh();
+}
+
+void filter_backspace(void) {
+    FilterView *fv = &g_app.filter;
+    size_t len = strlen(fv->query);
+    if (len == 0) return;
+    fv->query[len - 1] = '\0';
+    fv->applied[0] = '\0';     // a shorter query can match more: rescan
+    filter_refresh();
+}
+
+void filter_accept(void) {
+    g_app.filter.prompt = false;
+    g_app.show_overlay = false;
+}
+
+void filter_close(bool jump) {
+    FilterView *fv = &g_app.filter;
+    if (!fv->active && !fv->prompt) return;
+    if (fv->active) {
+        size_t row = (size_t)g_app.caret.line;
+        if (jump && row < fv->count) {
+            g_app.caret.line = (int64_t)fv->hits[row].line;
+        } else {
+            g_app.caret = fv->saved;
+        }
+    }
+    free(fv->hits);
+    memset(fv, 0, sizeof(*fv));
+    g_app.show_overlay = false;
+}
+
+// Row showing the first source line at or after line
+size_t filter_row_of_line(size_t line) {
+    const FilterView *fv = &g_app.filter;
+    size_t lo = 0, hi = fv->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (fv->hits[mid].line < line) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
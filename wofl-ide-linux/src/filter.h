@@ -0,0 +1,13 @@
+#ifndef FILTER_H
+#define FILTER_H
+
+#include "app.h"
+
+void filter_start(void);
+void filter_input(const char *text);
+void filter_backspace(void);
+void filter_accept(void);
+void filter_close(bool jump);
+size_t filter_row_of_line(size_t line);
+
+#endif
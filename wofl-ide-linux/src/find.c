@@ -2,9 +2,44 @@
 #include "gap_buffer.h"
 #include "cursor.h"
 
+// First occurrence of needle in p[0, n), or FIND_NONE
+size_t find_in_text(const char *p, size_t n, const char *needle, size_t nlen, bool case_sensitive) {
+    if (n < nlen) return FIND_NONE;
+    const size_t last = n - nlen;
+
+    if (case_sensitive) {
+        size_t i = 0;
+        while (i <= last) {
+            const char *hit = memchr(p + i, needle[0], last - i + 1);
+            if (!hit) break;
+            i = (size_t)(hit - p);
+            if (memcmp(hit, needle, nlen) == 0) return i;
+            i++;
+        }
+        return FIND_NONE;
+    }
+
+    const int first = tolower((unsigned char)needle[0]);
+    for (size_t i = 0; i <= last; i++) {
+        if (tolower((unsigned char)p[i]) != first) continue;
+        size_t j = 1;
+        while (j < nlen && tolower((unsigned char)p[i + j]) == tolower((unsigned char)needle[j])) j++;
+        if (j == nlen) return i;
+    }
+    return FIND_NONE;
+}
+
 bool find_text_in_buffer(const char* needle, size_t start_pos, bool case_sensitive, size_t* found_pos) {
     if (!needle || !needle[0]) return false;
     
+    // Views scan the mapped file rather than the gap buffer
+    if (g_app.view_mode) {
+        uint64_t found;
+        if (!fv_search(&g_app.view, needle, start_pos, case_sensitive, &found)) return false;
+        *found_pos = (size_t)found;
+        return true;
+    }
+    
     size_t buf_len = gb_length(&g_app.buf);
     size_t needle_len = strlen(needle);
     
@@ -37,12 +72,12 @@ bool find_text_in_buffer(const char* needle, size_t start_pos, bool case_sensiti
 void find_next(void) {
     if (!g_app.find_text[0]) return;
     
-    size_t start_pos = g_app.last_find_pos + 1;
+    size_t start_pos = an_pos(&g_app.anchors, g_app.find_mark) + 1;
     size_t found_pos;
     
     if (find_text_in_buffer(g_app.find_text, start_pos, g_app.find_case_sensitive, &found_pos)) {
         move_cursor_to_index(found_pos);
-        g_app.last_find_pos = found_pos;
+        an_set(&g_app.anchors, g_app.find_mark, found_pos);
         
         snprintf(g_app.overlay_text, sizeof(g_app.overlay_text), 
                 "Found: %s at position %zu", g_app.find_text, found_pos);
@@ -50,7 +85,7 @@ void find_next(void) {
     } else {
         if (find_text_in_buffer(g_app.find_text, 0, g_app.find_case_sensitive, &found_pos)) {
             move_cursor_to_index(found_pos);
-            g_app.last_find_pos = found_pos;
+            an_set(&g_app.anchors, g_app.find_mark, found_pos);
             snprintf(g_app.overlay_text, sizeof(g_app.overlay_text), 
                     "Found: %s (wrapped)", g_app.find_text);
             g_app.show_overlay = true;
@@ -66,7 +101,7 @@ void start_find(void) {
     g_app.find_active = true;
     g_app.find_text[0] = '\0';
     g_app.find_cursor = 0;
-    g_app.last_find_pos = 0;
+    an_set(&g_app.anchors, g_app.find_mark, 0);
     strcpy(g_app.overlay_text, "Find: ");
     g_app.show_overlay = true;
 }
@@ -98,7 +133,7 @@ void finish_find(void) {
         size_t found_pos;
         if (find_text_in_buffer(g_app.find_text, cursor_pos, g_app.find_case_sensitive, &found_pos)) {
             move_cursor_to_index(found_pos);
-            g_app.last_find_pos = found_pos;
+            an_set(&g_app.anchors, g_app.find_mark, found_pos);
         }
     }
 }
\ No newline at end of file
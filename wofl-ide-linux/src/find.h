@@ -3,6 +3,9 @@
 
 #include "app.h"
 
+#define FIND_NONE ((size_t)-1)
+
+size_t find_in_text(const char *p, size_t n, const char *needle, size_t nlen, bool case_sensitive);
 bool find_text_in_buffer(const char* needle, size_t start_pos, bool case_sensitive, size_t* found_pos);
 void find_next(void);
 void start_find(void);
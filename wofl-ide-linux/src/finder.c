@@ -0,0 +1,140 @@
+#define _DEFAULT_SOURCE
+#include "finder.h"
+#include "file_ops.h"
+#include <stdlib.h>
+
+// The workspace is the directory the editor was started in
+void finder_index_start(void) {
+    char root[FF_PATH_MAX];
+    if (getcwd(root, sizeof(root))) ffx_start(&g_app.files, root);
+}
+
+static void show(void) {
+    FinderPrompt *p = &g_app.finder;
+    bool running;
+    uint32_t files;
+    ffx_status(&g_app.files, &running, &files);
+    char note[64] = "";
+    if (running) snprintf(note, sizeof(note), "   (listing: %u files)", files);
+    else if (p->query[0] && p->count == 0) snprintf(note, sizeof(note), "   (no match: Enter opens it as a path)");
+    else if (p->count) snprintf(note, sizeof(note), "   [%d/%d of %u files]", p->selected + 1, p->count, files);
+    snprintf(g_app.overlay_text, sizeof(g_app.overlay_text), "Open file: %.400s%s", p->query, note);
+}
+
+// Keep the selection in the rows listed
+static void scroll(void) {
+    FinderPrompt *p = &g_app.finder;
+    if (p->selected < p->top) p->top = p->selected;
+    if (p->selected >= p->top + FINDER_ROWS) p->top = p->selected - FINDER_ROWS + 1;
+}
+
+static void query(void) {
+    FinderPrompt *p = &g_app.finder;
+    p->version = ffx_status(&g_app.files, NULL, NULL);
+    p->count = p->query[0] ? ffx_query(&g_app.files, p->query, p->hits, FINDER_HITS) : 0;
+    p->selected = 0;
+    p->top = 0;
+    show();
+}
+
+void finder_start(void) {
+    // Without watches the list is only as new as the last walk
+    if (g_app.files.watch_fd < 0) ffx_refresh(&g_app.files);
+    g_app.finder.active = true;
+    g_app.finder.query[0] = '\0';
+    query();
+    g_app.show_overlay = true;
+}
+
+void finder_input(const char *text) {
+    FinderPrompt *p = &g_app.finder;
+    size_t len = strlen(p->query);
+    for (; text && *text && len < sizeof(p->query) - 1; text++) p->query[len++] = *text;
+    p->query[len] = '\0';
+    query();
+}
+
+bool finder_open(const char *path, const char *shown) {
+    if (g_app.buf.dirty && !g_app.view_mode) {
+        snprintf(g_app.overlay_text, sizeof(g_app.overlay_text), "Open file: save %.400s first", g_app.file_name);
+        return false;
+    }
+    if (!load_file(path)) {
+        snprintf(g_app.overlay_text, sizeof(g_app.overlay_text), "Open file: cannot open %.400s", shown);
+        return false;
+    }
+    g_app.finder.active = false;
+    g_app.caret.line = 0;
+    g_app.caret.col = 0;
+    snprintf(g_app.overlay_text, sizeof(g_app.overlay_text), "Opened: %.400s", g_app.file_name);
+    return true;
+}
+
+// The selected file, or with nothing listed the query itself as a path
+static void accept(void) {
+    FinderPrompt *p = &g_app.finder;
+    if (p->count) {
+        const FileHit *h = &p->hits[p->selected];
+        char path[FF_PATH_MAX * 2];
+        snprintf(path, sizeof(path), "%s/%s", g_app.files.root, h->path);
+        finder_open(path, h->path);
+    } else if (p->query[0]) {
+        finder_open(p->query, p->query);
+    }
+}
+
+void finder_key(SDL_Keycode key) {
+    FinderPrompt *p = &g_app.finder;
+    size_t len = strlen(p->query);
+    switch (key) {
+        case SDLK_ESCAPE:
+            p->active = false;
+            g_app.show_overlay = false;
+            break;
+        case SDLK_RETURN:
+            accept();
+            break;
+        case SDLK_BACKSPACE:
+            if (len > 0) p->query[len - 1] = '\0';
+            query();
+            break;
+        case SDLK_UP:
+            if (p->count) p->selected = (p->selected + p->count - 1) % p->count;
+            scroll();
+            show();
+            break;
+        case SDLK_DOWN:
+        case SDLK_TAB:
+            if (p->count) p->selected = (p->selected + 1) % p->count;
+            scroll();
+            show();
+            break;
+        case SDLK_PAGEUP:
+            p->selected = p->selected > FINDER_ROWS ? p->selected - FINDER_ROWS : 0;
+            scroll();
+            show();
+            break;
+        case SDLK_PAGEDOWN:
+            if (p->count) p->selected = p->selected + FINDER_ROWS < p->count ? p->selected + FINDER_ROWS : p->count - 1;
+            scroll();
+            show();
+            break;
+    }
+}
+
+/**
+ * Once per frame: hand what the watches saw to the walker, and while the
+ * prompt is open pick up a new list.
+ */
+void finder_poll(void) {
+    ffx_poll(&g_app.files);
+    FinderPrompt *p = &g_app.finder;
+    if (!p->active) return;
+    if (ffx_status(&g_app.files, NULL, NULL) != p->version) {
+        const int selected = p->selected;
+        query();
+        if (selected < p->count) p->selected = selected;
+        scroll();
+    }
+    show();
+}
@@ -0,0 +1,16 @@
+#ifndef FINDER_H
+#define FINDER_H
+
+#include "app.h"
+
+// Quick open: a prompt over the workspace file list (file_finder.h)
+void finder_index_start(void);
+void finder_start(void);
+void finder_input(const char *text);
+void finder_key(SDL_Keycode key);
+void finder_poll(void);
+
+// Open path, named shown in messages, if the buffer can be left
+bool finder_open(const char *path, const char *shown);
+
+#endif
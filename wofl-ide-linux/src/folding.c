@@ -0,0 +1,99 @@
+#include "folding.h"
+#include "cursor.h"
+#include "gap_buffer.h"
+
+// Leading characters read to measure indentation or look for a '{'
+#define FOLD_READ_MAX   4096
+#define FOLD_TAB        4
+
+// Up to max characters of a line, from the buffer or the mapped file
+static int read_line(int64_t line, char *out, int max) {
+    if (g_app.view_mode) {
+        size_t len = fv_read_line(&g_app.view, (uint64_t)line, out, (size_t)max + 1);
+        return len < (size_t)max ? (int)len : max;
+    }
+    
+    int len = get_line_length(line);
+    if (len > max) len = max;
+    lix_lock(&g_app.lines);
+    size_t pos = li_line_start(&g_app.lines.index, (size_t)line);
+    lix_unlock(&g_app.lines);
+    int n = 0;
+    while (n < len) {
+        size_t avail;
+        const char *p = gb_segment(&g_app.buf, pos + (size_t)n, &avail);
+        if (!p || avail == 0) break;
+        if (avail > (size_t)(len - n)) avail = (size_t)(len - n);
+        memcpy(out + n, p, avail);
+        n += (int)avail;
+    }
+    return n;
+}
+
+// Indentation in columns, or -1 for a blank line
+static int line_indent(int64_t line) {
+    char text[FOLD_READ_MAX + 1];
+    int n = read_line(line, text, FOLD_READ_MAX);
+    int indent = 0;
+    for (int i = 0; i < n; i++) {
+        if (text[i] == ' ') indent++;
+        else if (text[i] == '\t') indent = (indent / FOLD_TAB + 1) * FOLD_TAB;
+        else if (text[i] != '\r') return indent;
+    }
+    return n < FOLD_READ_MAX ? -1 : indent;
+}
+
+// Lines after `line` indented deeper than it, blank lines between them included
+static int64_t indent_region(int64_t line) {
+    int base = line_indent(line);
+    int64_t last = line;
+    if (base < 0) return last;
+    int64_t count = get_line_count();
+    for (int64_t l = line + 1; l < count; l++) {
+        int indent = line_indent(l);
+        if (indent < 0) continue;
+        if (indent <= base) break;
+        last = l;
+    }
+    return last;
+}
+
+// The last '{' on the line that has its '}' further down: the fold ends
+// just before the line of the '}'
+static BxFind brace_region(int64_t line, int64_t *last) {
+    char text[FOLD_READ_MAX + 1];
+    int n = read_line(line, text, FOLD_READ_MAX);
+    BxFind found = BX_NONE;
+    for (int x = n - 1; x >= 0; x--) {
+        if (text[x] != '{') continue;
+        size_t at, match_line, match_col;
+        found = hl_match_bracket(&g_app.hl, (size_t)line, (size_t)x, &at, &match_line, &match_col);
+        if (found == BX_PENDING) return found;
+        if (found == BX_FOUND && at == (size_t)x && match_line > (size_t)line) {
+            *last = (int64_t)match_line - 1;
+            return found;
+        }
+    }
+    return BX_NONE;
+}
+
+// Open the fold on the caret's line, or fold the region it starts
+void toggle_fold(void) {
+    if (g_app.filter.active) return;
+    int64_t line = g_app.caret.line;
+    if (ft_unfold(&g_app.folds, (size_t)line)) return;
+    
+    int64_t last = line;
+    BxFind found = brace_region(line, &last);
+    if (found != BX_FOUND) last = indent_region(line);
+    if (last > line && ft_fold(&g_app.folds, (size_t)line, (size_t)last)) return;
+    
+    if (last > line) strcpy(g_app.overlay_text, "Fold: would cross another fold");
+    else if (found == BX_PENDING) strcpy(g_app.overlay_text, "Fold: still indexing");
+    else strcpy(g_app.overlay_text, "Nothing to fold here");
+    g_app.show_overlay = true;
+}
+
+void unfold_all(void) {
+    ft_clear(&g_app.folds);
+}
@@ -0,0 +1,9 @@
+#ifndef FOLDING_H
+#define FOLDING_H
+
+#include "app.h"
+
+void toggle_fold(void);
+void unfold_all(void);
+
+#endif
@@ -0,0 +1,165 @@
+#define _DEFAULT_SOURCE
+#include "follow.h"
+#include "file_ops.h"
+#include "editing.h"
+#include "cursor.h"
+#include "gap_buffer.h"
+#include "filter.h"
+#include "carets.h"
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+// Bytes appended per frame. At 60 fps this still keeps up with several
+// hundred MB/s, and a frame never stalls on one huge read.
+#define FOLLOW_FRAME_BYTES (8u << 20)
+
+#define FOLLOW_FILE_EVENTS (IN_MODIFY | IN_MOVE_SELF | IN_DELETE_SELF)
+
+static void split_path(const char *path) {
+    Follower *fw = &g_app.follow;
+    const char *slash = strrchr(path, '/');
+    if (!slash) {
+        strcpy(fw->dir, ".");
+        snprintf(fw->base, sizeof(fw->base), "%s", path);
+    } else {
+        size_t n = (size_t)(slash - path);
+        if (n == 0) n = 1;  // "/name"
+        if (n >= sizeof(fw->dir)) n = sizeof(fw->dir) - 1;
+        memcpy(fw->dir, path, n);
+        fw->dir[n] = '\0';
+        snprintf(fw->base, sizeof(fw->base), "%s", slash + 1);
+    }
+}
+
+bool follow_start(const char *path) {
+    follow_stop();
+    if (!load_file(path)) return false;
+    if (g_app.view_mode) return false;  // views are not followed
+    
+    Follower *fw = &g_app.follow;
+    fw->fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fw->fd < 0) return false;
+    fw->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fw->inotify_fd < 0) {
+        close(fw->fd);
+        return false;
+    }
+    
+    // Watch the directory too, so a rotated log is picked up when a new
+    // file takes over the name
+    split_path(path);
+    fw->file_wd = inotify_add_watch(fw->inotify_fd, path, FOLLOW_FILE_EVENTS);
+    fw->dir_wd = inotify_add_watch(fw->inotify_fd, fw->dir, IN_CREATE | IN_MOVED_TO);
+    
+    fw->offset = (off_t)gb_length(&g_app.buf);
+    fw->pending = true;     // catch up on anything written since the load
+    fw->rotated = false;
+    fw->active = true;
+    move_cursor_to_index(gb_length(&g_app.buf));
+    return true;
+}
+
+void follow_stop(void) {
+    Follower *fw = &g_app.follow;
+    if (!fw->active) return;
+    close(fw->inotify_fd);
+    close(fw->fd);
+    fw->active = false;
+}
+
+// The file shrank: whatever was loaded is gone, start over empty
+static void follow_truncated(void) {
+    filter_close(false);
+    hl_stop(&g_app.hl);
+    lix_stop(&g_app.lines);
+    ft_clear(&g_app.folds);
+    gb_free(&g_app.buf);
+    gb_init(&g_app.buf);
+    buffer_index_start();
+    buffer_words_open(g_app.file_path);
+    carets_clear();
+    g_app.caret.line = 0;
+    g_app.caret.col = 0;
+    g_app.scroll_y = 0;
+    g_app.scroll_x = 0;
+    g_app.follow.offset = 0;
+}
+
+// Once the old file is drained, switch to whatever now has its name
+static void follow_reopen(const struct stat *old) {
+    Follower *fw = &g_app.follow;
+    int fd = open(g_app.file_path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return;     // not recreated yet; IN_CREATE will bring us back
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (st.st_ino == old->st_ino && st.st_dev == old->st_dev)) {
+        close(fd);
+        return;
+    }
+    close(fw->fd);
+    fw->fd = fd;
+    fw->offset = 0;
+    fw->pending = true;
+    inotify_rm_watch(fw->inotify_fd, fw->file_wd);
+    fw->file_wd = inotify_add_watch(fw->inotify_fd, g_app.file_path, FOLLOW_FILE_EVENTS);
+}
+
+/**
+ * Called once per frame: drain inotify, then append at most
+ * FOLLOW_FRAME_BYTES of new data. Returns true when the buffer changed.
+ */
+bool follow_poll(void) {
+    Follower *fw = &g_app.follow;
+    if (!fw->active) return false;
+    
+    bool changed = fw->pending;
+    char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t n;
+    while ((n = read(fw->inotify_fd, events, sizeof(events))) > 0) {
+        for (char *p = events; p < events + n; ) {
+            const struct inotify_event *ev = (const struct inotify_event *)p;
+            if (ev->wd == fw->file_wd) {
+                if (ev->mask & (IN_MOVE_SELF | IN_DELETE_SELF)) fw->rotated = true;
+                changed = true;
+            } else if (ev->wd == fw->dir_wd && ev->len > 0 && strcmp(ev->name, fw->base) == 0) {
+                fw->rotated = true;
+                changed = true;
+            }
+            p += sizeof(struct inotify_event) + ev->len;
+        }
+    }
+    if (!changed && !fw->rotated) return false;
+    
+    struct stat st;
+    if (fstat(fw->fd, &st) != 0) return false;
+    
+    bool truncated = st.st_size < fw->offset;
+    if (truncated) follow_truncated();
+    
+    bool at_end = g_app.caret.line >= get_line_count() - 1;
+    size_t budget = FOLLOW_FRAME_BYTES;
+    size_t appended = 0;
+    while (budget > 0 && fw->offset < st.st_size) {
+        size_t want = (size_t)(st.st_size - fw->offset);
+        if (want > budget) want = budget;
+        size_t got = buffer_append_fd(fw->fd, fw->offset, want);
+        if (got == 0) break;
+        fw->offset += (off_t)got;
+        budget -= got;
+        appended += got;
+    }
+    fw->pending = fw->offset < st.st_size;
+    
+    if (fw->rotated && !fw->pending) {
+        fw->rotated = false;
+        follow_reopen(&st);
+    }
+    
+    // Stay pinned to the bottom, like tail -f, unless the caret moved away.
+    // The end is found by index; the line count may still be catching up.
+    if (appended > 0 && at_end) {
+        move_cursor_to_index(gb_length(&g_app.buf));
+    }
+    return appended > 0 || truncated;
+}
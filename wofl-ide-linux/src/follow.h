@@ -0,0 +1,10 @@
+#ifndef FOLLOW_H
+#define FOLLOW_H
+
+#include "app.h"
+
+bool follow_start(const char *path);
+void follow_stop(void);
+bool follow_poll(void);
+
+#endif
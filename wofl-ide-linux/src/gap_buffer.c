@@ -37,16 +37,13 @@ void gb_ensure(GapBuffer *gb, size_t need) {
         new_cap *= 2;
     }
     
-    char *new_data = malloc(new_cap);
+    // realloc can usually grow in place (or remap) instead of copying;
+    // only the text after the gap has to move up
+    char *new_data = realloc(gb->data, new_cap);
+    if (!new_data) return;
+    size_t post = gb->capacity - gb->gap_end;
+    memmove(new_data + new_cap - post, new_data + gb->gap_end, post);
     
-    // Copy pre-gap data
-    memcpy(new_data, gb->data, gb->gap_start);
-    // Copy post-gap data to end of new buffer
-    memcpy(new_data + (new_cap - (gb->capacity - gb->gap_end)),
-           gb->data + gb->gap_end,
-           gb->capacity - gb->gap_end);
-    
-    free(gb->data);
     gb->data = new_data;
     gb->gap_end = new_cap - (gb->capacity - gb->gap_end);
     gb->capacity = new_cap;
@@ -60,4 +57,54 @@ void gb_insert(GapBuffer *gb, const char *text, size_t len) {
     memcpy(gb->data + gb->gap_start, text, len);
     gb->gap_start += len;
     gb->dirty = true;
+}
+
+void gb_move_gap(GapBuffer *gb, size_t pos) {
+    size_t len = gb_length(gb);
+    if (pos > len) pos = len;
+    
+    if (pos < gb->gap_start) {
+        size_t n = gb->gap_start - pos;
+        memmove(gb->data + gb->gap_end - n, gb->data + pos, n);
+        gb->gap_start -= n;
+        gb->gap_end -= n;
+    } else if (pos > gb->gap_start) {
+        size_t n = pos - gb->gap_start;
+        memmove(gb->data + gb->gap_start, gb->data + gb->gap_end, n);
+        gb->gap_start += n;
+        gb->gap_end += n;
+    }
+}
+
+void gb_delete_range(GapBuffer *gb, size_t pos, size_t len) {
+    size_t total = gb_length(gb);
+    if (pos >= total || len == 0) return;
+    if (pos + len > total) len = total - pos;
+    
+    gb_move_gap(gb, pos);
+    gb->gap_end += len;
+    gb->dirty = true;
+}
+
+// Contiguous run of text starting at pos, up to the gap or the end
+const char *gb_segment(const GapBuffer *gb, size_t pos, size_t *avail) {
+    size_t len = gb_length(gb);
+    if (pos >= len) {
+        *avail = 0;
+        return NULL;
+    }
+    if (pos < gb->gap_start) {
+        *avail = gb->gap_start - pos;
+        return gb->data + pos;
+    }
+    size_t off = pos + (gb->gap_end - gb->gap_start);
+    *avail = gb->capacity - off;
+    return gb->data + off;
+}
+
+// Both sides of the gap, for the newline kernels
+NlText gb_nl_text(const GapBuffer *gb) {
+    NlText t = { gb->data, gb->gap_start,
+                 gb->data + gb->gap_end, gb->capacity - gb->gap_end, 1 };
+    return t;
 }
\ No newline at end of file
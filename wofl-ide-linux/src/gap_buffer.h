@@ -9,5 +9,9 @@ size_t gb_length(const GapBuffer *gb);
 char gb_char_at(const GapBuffer *gb, size_t pos);
 void gb_ensure(GapBuffer *gb, size_t need);
 void gb_insert(GapBuffer *gb, const char *text, size_t len);
+void gb_move_gap(GapBuffer *gb, size_t pos);
+void gb_delete_range(GapBuffer *gb, size_t pos, size_t len);
+const char *gb_segment(const GapBuffer *gb, size_t pos, size_t *avail);
+NlText gb_nl_text(const GapBuffer *gb);
 
 #endif
\ No newline at end of file
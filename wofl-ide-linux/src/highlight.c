@@ -0,0 +1,708 @@
+#define _DEFAULT_SOURCE
+#include "highlight.h"
+#include "lexer.h"
+#include "frame_arena.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <limits.h>
+
+#define HL_MASK (HL_SLOTS - 1)
+#define HL_TEXT_MIN (64u << 10)
+
+// Lines of the source that get tokens: the screen [first, last] of each of
+// n views and the lines around it, [lo, hi). The views split HL_SLOTS
+// between them, so no two lines around one view share a slot.
+typedef struct {
+    int n;
+    size_t first[HL_VIEWS], last[HL_VIEWS];
+    size_t lo[HL_VIEWS], hi[HL_VIEWS];
+} HlView;
+
+// Buffers for one batch. Screen batches are up to HL_BATCH lines, sweep
+// batches a whole bracket block, which never grows past BX_BLOCK_MAX.
+typedef struct {
+    char *text;
+    size_t text_cap;
+    size_t off[BX_BLOCK_MAX];
+    size_t len[BX_BLOCK_MAX];
+    uint16_t known[BX_BLOCK_MAX];   // end state of the line before, at read time
+    bool want[BX_BLOCK_MAX];
+    FrameArena fa;                  // widened text and spans
+    OutlineScan outline;            // definitions in a sweep block
+} HlScratch;
+
+// One line lexed into the scratch arena
+typedef struct {
+    const wchar_t *wide;        // NULL for lines left plain
+    int len;
+    TokenSpan *spans;
+    int n;
+} HlLexed;
+
+// ===== Handoff =====
+
+static void free_chain(HlLine *p) {
+    while (p) {
+        HlLine *next = p->retired;
+        free(p);
+        p = next;
+    }
+}
+
+// The renderer may still be drawing a replaced line, so it is only freed
+// by the UI thread at the start of the next frame
+static void retire(Highlighter *hl, HlLine *p) {
+    HlLine *head = __atomic_load_n(&hl->retired, __ATOMIC_RELAXED);
+    do {
+        p->retired = head;
+    } while (!__atomic_compare_exchange_n(&hl->retired, &head, p, true,
+                                          __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+static void publish(Highlighter *hl, HlLine *p) {
+    HlLine *old = __atomic_exchange_n(&hl->slots[p->line & HL_MASK], p, __ATOMIC_ACQ_REL);
+    if (old) retire(hl, old);
+}
+
+const HlLine *hl_get(Highlighter *hl, size_t line) {
+    const HlLine *p = __atomic_load_n(&hl->slots[line & HL_MASK], __ATOMIC_ACQUIRE);
+    return p && p->line == line ? p : NULL;
+}
+
+void hl_frame(Highlighter *hl, int view, size_t first, size_t last) {
+    free_chain(__atomic_exchange_n(&hl->retired, NULL, __ATOMIC_ACQUIRE));
+
+    if (view < 0 || view >= HL_VIEWS) return;
+    if (first == __atomic_load_n(&hl->view_first[view], __ATOMIC_RELAXED) &&
+        last == __atomic_load_n(&hl->view_last[view], __ATOMIC_RELAXED)) {
+        return;
+    }
+    __atomic_store_n(&hl->view_first[view], first, __ATOMIC_RELAXED);
+    __atomic_store_n(&hl->view_last[view], last, __ATOMIC_RELAXED);
+
+    // Signalled without the lock, so the wakeup can be missed; the
+    // worker's idle timeout bounds how long that delays it
+    pthread_cond_signal(&hl->wake);
+}
+
+void hl_set_hidden(Highlighter *hl, const FoldRange *ranges, int n) {
+    if (n > HL_HIDDEN_MAX) n = HL_HIDDEN_MAX;
+    pthread_mutex_lock(&hl->lock);
+    if (n > 0) memcpy(hl->hidden, ranges, (size_t)n * sizeof(FoldRange));
+    hl->nhidden = n;
+    pthread_cond_signal(&hl->wake);
+    pthread_mutex_unlock(&hl->lock);
+}
+
+// ===== Worker =====
+
+// Everything from here to the edits section runs with hl->lock held,
+// except lex_line()
+
+static uint16_t state_before(const Highlighter *hl, size_t line) {
+    if (line == 0) return 0;
+    return line - 1 < hl->nstates ? hl->states[line - 1] : HL_STATE_NONE;
+}
+
+// Index of the first hidden range ending at or after line
+static int hidden_from(const Highlighter *hl, size_t line) {
+    int lo = 0, hi = hl->nhidden;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (hl->hidden[mid].last < line) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static const FoldRange *hidden_at(const Highlighter *hl, size_t line) {
+    int i = hidden_from(hl, line);
+    return i < hl->nhidden && hl->hidden[i].first <= line ? &hl->hidden[i] : NULL;
+}
+
+// Hidden lines in [first, last]
+static size_t hidden_between(const Highlighter *hl, size_t first, size_t last) {
+    size_t n = 0;
+    for (int i = hidden_from(hl, first); i < hl->nhidden && hl->hidden[i].first <= last; i++) {
+        size_t a = hl->hidden[i].first > first ? hl->hidden[i].first : first;
+        size_t b = hl->hidden[i].last < last ? hl->hidden[i].last : last;
+        n += b - a + 1;
+    }
+    return n;
+}
+
+static void view_of(Highlighter *hl, size_t count, HlView *v) {
+    size_t first[HL_VIEWS], last[HL_VIEWS];
+    size_t shown = 0;
+    for (int k = 0; k < HL_VIEWS; k++) {
+        first[k] = __atomic_load_n(&hl->view_first[k], __ATOMIC_RELAXED);
+        last[k] = __atomic_load_n(&hl->view_last[k], __ATOMIC_RELAXED);
+        if (first[k] < count) shown++;
+    }
+    v->n = 0;           // nothing wanted
+    if (shown == 0) return;
+
+    const size_t near = HL_NEAR / shown;
+    const size_t room = HL_SLOTS / shown - 2 * near;
+    for (int k = 0; k < HL_VIEWS; k++) {
+        if (first[k] >= count) continue;
+        if (last[k] < first[k]) last[k] = first[k];
+        size_t folded = hidden_between(hl, first[k], last[k]);
+        if (last[k] - first[k] - folded >= room) last[k] = first[k] + folded + room - 1;
+        if (last[k] >= count) last[k] = count - 1;
+
+        v->first[v->n] = first[k];
+        v->last[v->n] = last[k];
+        v->lo[v->n] = first[k] > near ? first[k] - near : 0;
+        v->hi[v->n] = last[k] + 1 + near < count ? last[k] + 1 + near : count;
+        v->n++;
+    }
+}
+
+static bool in_view(const Highlighter *hl, const HlView *v, size_t line) {
+    for (int k = 0; k < v->n; k++) {
+        if (line >= v->lo[k] && line < v->hi[k]) return !hidden_at(hl, line);
+    }
+    return false;
+}
+
+static bool on_screen(const HlView *v, size_t line) {
+    for (int k = 0; k < v->n; k++) {
+        if (line >= v->first[k] && line <= v->last[k]) return true;
+    }
+    return false;
+}
+
+// Folds, or two views far apart, can put two lines that share a slot in
+// view. A line on screen takes the slot from one that is only near it;
+// otherwise the second stays plain rather than take turns with the first.
+static bool needs_tokens(const Highlighter *hl, const HlView *v, size_t line) {
+    const HlLine *p = hl->slots[line & HL_MASK];
+    if (p && p->line != line) {
+        return !in_view(hl, v, p->line) || (on_screen(v, line) && !on_screen(v, p->line));
+    }
+    if (!p || p->stale) return true;
+    uint16_t before = state_before(hl, line);
+    return before != HL_STATE_NONE && before != p->in_state;
+}
+
+// The first line without up-to-date tokens: on screen, then outwards, the
+// views in turn. *end gets the end of the lines around its view.
+static bool next_wanted(const Highlighter *hl, const HlView *v, size_t *line, size_t *end) {
+    for (int k = 0; k < v->n; k++) {
+        for (size_t l = v->first[k]; l <= v->last[k]; l++) {
+            const FoldRange *h = hidden_at(hl, l);
+            if (h) {
+                l = h->last;
+                continue;
+            }
+            if (needs_tokens(hl, v, l)) {
+                *line = l;
+                *end = v->hi[k];
+                return true;
+            }
+        }
+    }
+    for (size_t d = 1; d <= HL_NEAR; d++) {
+        for (int k = 0; k < v->n; k++) {
+            const size_t below = v->last[k] + d, above = v->first[k] - d;
+            if (below < v->hi[k] && in_view(hl, v, below) && needs_tokens(hl, v, below)) {
+                *line = below;
+                *end = v->hi[k];
+                return true;
+            }
+            if (d <= v->first[k] && above >= v->lo[k] && in_view(hl, v, above) &&
+                needs_tokens(hl, v, above)) {
+                *line = above;
+                *end = v->hi[k];
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static bool reserve_states(Highlighter *hl, size_t count) {
+    if (count <= hl->state_cap) return true;
+    size_t cap = hl->state_cap ? hl->state_cap : 4096;
+    while (cap < count) cap *= 2;
+    uint16_t *grown = realloc(hl->states, cap * sizeof(*grown));
+    if (!grown) return false;
+    hl->states = grown;
+    hl->state_cap = cap;
+    return true;
+}
+
+// Lines added at (or dropped from) the end of the source
+static bool fit_states(Highlighter *hl, size_t count) {
+    if (!reserve_states(hl, count) || !bx_resize(&hl->brackets, count)) return false;
+    ol_truncate(&hl->outline, count);
+    for (size_t l = hl->nstates; l < count; l++) hl->states[l] = HL_STATE_NONE;
+    hl->nstates = count;
+    if (hl->sweep > count) hl->sweep = count;
+    return true;
+}
+
+static void read_batch(Highlighter *hl, HlScratch *s, size_t start, int n) {
+    size_t used = 0;
+    for (int i = 0; i < n; i++) {
+        for (;;) {
+            size_t room = s->text_cap - used;
+            size_t len = hl->src.read_line(hl->src.ctx, start + (size_t)i, s->text + used, room);
+            if (len > room && len <= HL_LINE_MAX) {
+                size_t cap = s->text_cap * 2;
+                while (cap < used + len) cap *= 2;
+                char *grown = realloc(s->text, cap);
+                if (grown) {
+                    s->text = grown;
+                    s->text_cap = cap;
+                    continue;
+                }
+            }
+            s->off[i] = used;
+            s->len[i] = len;
+            if (len <= room) used += len;
+            else s->len[i] = HL_LINE_MAX + 1;      // too long to keep: left plain
+            break;
+        }
+    }
+}
+
+/**
+ * Lex line i of the batch from `state`, into the scratch arena, and return
+ * the state it ends in. With full, every token is kept in *out; without,
+ * generated lexers only work out the end state (the whole line is "before
+ * the window") and nothing is stored.
+ */
+static uint16_t lex_line(const Syntax *sx, HlScratch *s, int i, uint16_t state,
+                         bool full, HlLexed *out) {
+    const size_t len = s->len[i];
+    memset(out, 0, sizeof(*out));
+    if (len > HL_LINE_MAX || (!full && !sx->lexer)) return state;
+
+    wchar_t *wide = fa_new(&s->fa, wchar_t, len);
+    if (!wide) return state;
+    const char *text = s->text + s->off[i];
+    for (size_t k = 0; k < len; k++) wide[k] = (wchar_t)(unsigned char)text[k];
+
+    uint16_t end = state;
+    if (sx->lexer) {
+        int cap = full ? (int)len + 2 : 2;
+        TokenSpan *spans = fa_new(&s->fa, TokenSpan, cap);
+        if (!spans) return state;
+        end = (uint16_t)lex_scan_range(sx->lexer, wide, (int)len, state,
+                                       full ? 0 : (int)len, (int)len, spans, cap, &out->n);
+        if (full) out->spans = spans;
+    } else {
+        out->n = syntax_scan_window(sx, wide, (int)len, 0, 0, (int)len, &s->fa, &out->spans);
+    }
+    if (full) {
+        out->wide = wide;
+        out->len = (int)len;
+    } else {
+        out->n = 0;
+    }
+    return end;
+}
+
+static HlLine *make_line(size_t line, uint16_t in_state, const HlLexed *lx) {
+    HlLine *p = malloc(sizeof(HlLine) + (size_t)lx->n * sizeof(TokenSpan));
+    if (p) {
+        p->line = line;
+        p->retired = NULL;
+        p->in_state = in_state;
+        p->stale = false;
+        p->count = lx->n;
+        if (lx->n) memcpy(p->spans, lx->spans, (size_t)lx->n * sizeof(TokenSpan));
+    }
+    return p;
+}
+
+static bool scratch_init(HlScratch *s) {
+    memset(s, 0, sizeof(*s));
+    fa_init(&s->fa);
+    s->text_cap = HL_TEXT_MIN;
+    s->text = malloc(s->text_cap);
+    return s->text != NULL;
+}
+
+static void scratch_free(HlScratch *s) {
+    free(s->text);
+    fa_free(&s->fa);
+}
+
+static void idle(Highlighter *hl) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_nsec += HL_IDLE_MS * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait(&hl->wake, &hl->lock, &ts);
+}
+
+/**
+ * Each step takes a batch of lines: starting at the first line near the
+ * screen that needs tokens, otherwise the bracket block holding the sweep.
+ * Text is read under the lock, lexed without it, and published only if no
+ * edit came in between. Screen batches start from the best state known and
+ * leave the end states alone. The sweep computes those, and the block's
+ * bracket depth, in order; once a block ends in the state it ended in
+ * before, it skips ahead to the next block an edit touched.
+ */
+static void *hl_worker(void *arg) {
+    Highlighter *hl = arg;
+    const Syntax *sx = hl->syntax;
+    HlScratch s;
+    HlLine *built[BX_BLOCK_MAX];
+    uint16_t ends[BX_BLOCK_MAX];
+
+    bool ready = scratch_init(&s);
+    pthread_mutex_lock(&hl->lock);
+    while (ready && !hl->cancel) {
+        size_t count = hl->src.line_count(hl->src.ctx);
+        if (!fit_states(hl, count)) {
+            idle(hl);
+            continue;
+        }
+        HlView v;
+        view_of(hl, count, &v);
+
+        size_t start, hi, block = 0;
+        int n;
+        bool sweeping = false;
+        if (next_wanted(hl, &v, &start, &hi)) {
+            // Up to the next fold: hidden lines are not even read
+            size_t end = hi - start < HL_BATCH ? hi : start + HL_BATCH;
+            int h = hidden_from(hl, start);
+            if (h < hl->nhidden && hl->hidden[h].first < end) end = hl->hidden[h].first;
+            n = (int)(end - start);
+        } else {
+            if (hl->sweep >= count) {
+                idle(hl);
+                continue;
+            }
+            block = bx_block_of(&hl->brackets, hl->sweep, &start);
+            n = (int)bx_block_lines(&hl->brackets, block);
+            sweeping = true;
+        }
+        uint16_t state = state_before(hl, start);
+        if (state == HL_STATE_NONE) state = 0;
+        for (int i = 0; i < n; i++) {
+            size_t line = start + (size_t)i;
+            s.known[i] = sweeping ? HL_STATE_NONE : state_before(hl, line);
+            s.want[i] = in_view(hl, &v, line) && (sweeping || needs_tokens(hl, &v, line));
+            built[i] = NULL;
+        }
+        read_batch(hl, &s, start, n);
+        uint64_t edits = hl->edits;
+        const bool outline = sweeping && hl->outline_lang != OL_LANG_NONE;
+        const int32_t carry = outline ? ol_carry_before(&hl->outline, start) : 0;
+        pthread_mutex_unlock(&hl->lock);
+
+        BracketDepth depth;
+        memset(&depth, 0, sizeof(depth));
+        if (outline) ol_scan_begin(&s.outline, hl->outline_lang, start, carry);
+        for (int i = 0; i < n; i++) {
+            if (s.known[i] != HL_STATE_NONE) state = s.known[i];
+            uint16_t in_state = state;
+            HlLexed lx;
+            fa_reset(&s.fa);
+            state = ends[i] = lex_line(sx, &s, i, state, s.want[i] || sweeping, &lx);
+            if (sweeping && lx.wide) bx_depth_add(&depth, lx.wide, lx.len, lx.spans, lx.n);
+            if (outline) ol_scan_line(&s.outline, lx.wide, lx.len, lx.spans, lx.n, in_state != 0);
+            if (s.want[i]) built[i] = make_line(start + (size_t)i, in_state, &lx);
+        }
+
+        pthread_mutex_lock(&hl->lock);
+        if (hl->cancel || hl->edits != edits) {
+            for (int i = 0; i < n; i++) free(built[i]);
+            continue;
+        }
+        if (sweeping) {
+            // The outline scanner's carry has to settle as well as the state
+            uint16_t old = hl->states[start + (size_t)n - 1];
+            bool settled = true;
+            memcpy(hl->states + start, ends, (size_t)n * sizeof(uint16_t));
+            bx_set_depth(&hl->brackets, block, &depth);
+            if (outline) {
+                int32_t was = ol_carry_before(&hl->outline, start + (size_t)n);
+                settled = ol_set_block(&hl->outline, &s.outline) &&
+                          ol_carry_before(&hl->outline, start + (size_t)n) == was;
+            }
+            hl->sweep = ends[n - 1] == old && settled
+                ? bx_block_start(&hl->brackets, bx_next_unknown(&hl->brackets, block + 1))
+                : start + (size_t)n;
+        }
+        view_of(hl, hl->nstates, &v);
+        for (int i = 0; i < n; i++) {
+            HlLine *p = built[i];
+            if (!p) continue;
+            if (in_view(hl, &v, p->line) && needs_tokens(hl, &v, p->line)) publish(hl, p);
+            else free(p);
+        }
+    }
+    pthread_mutex_unlock(&hl->lock);
+
+    scratch_free(&s);
+    return NULL;
+}
+
+// ===== Brackets =====
+
+// Lex n lines read into the batch, from `state`, keeping all of them
+static void lex_block(const Syntax *sx, HlScratch *s, int n, uint16_t state, HlLexed *out) {
+    fa_reset(&s->fa);
+    for (int i = 0; i < n; i++) state = lex_line(sx, s, i, state, true, &out[i]);
+}
+
+// Walk lexed lines for the match: forward from column `col` of `row`, or
+// backward from just before it, moving on to the next (or previous) row
+static bool walk_lines(const HlLexed *lx, int n, int row, int col, bool forward,
+                       int kind, int32_t *need, int *match_row, int *match_col) {
+    for (int r = row; r >= 0 && r < n; r += forward ? 1 : -1) {
+        const HlLexed *l = &lx[r];
+        if (l->wide) {
+            int c = forward
+                ? bx_scan_forward(l->wide, l->len, l->spans, l->n, kind, r == row ? col : 0, need)
+                : bx_scan_backward(l->wide, l->len, l->spans, l->n, kind, r == row ? col : l->len, need);
+            if (c >= 0) {
+                *match_row = r;
+                *match_col = c;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static uint16_t known_before(const Highlighter *hl, size_t line) {
+    uint16_t state = state_before(hl, line);
+    return state == HL_STATE_NONE ? 0 : state;
+}
+
+static BxFind match_locked(Highlighter *hl, HlScratch *s, HlLexed *lx, size_t line, size_t col,
+                           size_t *at, size_t *match_line, size_t *match_col) {
+    const Syntax *sx = hl->syntax;
+    BracketIndex *bx = &hl->brackets;
+
+    // Lines up to the sweep start in a known state
+    if (line >= hl->nstates || line > hl->sweep) return BX_PENDING;
+    size_t first;
+    size_t block = bx_block_of(bx, line, &first);
+    int n = (int)bx_block_lines(bx, block);
+    read_batch(hl, s, first, n);
+    lex_block(sx, s, n, known_before(hl, first), lx);
+
+    // The bracket at the caret, or else just before it
+    const int row = (int)(line - first);
+    const HlLexed *l = &lx[row];
+    int x = (int)col;
+    bool open = false;
+    int kind = l->wide ? bx_bracket_at(l->wide, l->len, l->spans, l->n, x, &open) : -1;
+    if (kind < 0 && l->wide && x > 0) kind = bx_bracket_at(l->wide, l->len, l->spans, l->n, --x, &open);
+    if (kind < 0) return BX_NONE;
+    *at = (size_t)x;
+
+    // Its own block, then the index for the block the match is in
+    int32_t need = 1;
+    int mrow, mcol;
+    BxFind found = BX_FOUND;
+    if (walk_lines(lx, n, row, open ? x + 1 : x, open, kind, &need, &mrow, &mcol)) {
+        *match_line = first + (size_t)mrow;
+        *match_col = (size_t)mcol;
+        return BX_FOUND;
+    }
+    if (open) {
+        size_t limit = bx_block_of(bx, hl->sweep, &first);
+        found = bx_find_forward(bx, block + 1, limit, kind, &need, &block);
+    } else {
+        found = block > 0 ? bx_find_backward(bx, block - 1, kind, &need, &block) : BX_NONE;
+    }
+    if (found != BX_FOUND) return found;
+
+    first = bx_block_start(bx, block);
+    n = (int)bx_block_lines(bx, block);
+    read_batch(hl, s, first, n);
+    lex_block(sx, s, n, known_before(hl, first), lx);
+    if (!walk_lines(lx, n, open ? 0 : n - 1, open ? 0 : INT_MAX, open, kind, &need, &mrow, &mcol)) {
+        return BX_NONE;
+    }
+    *match_line = first + (size_t)mrow;
+    *match_col = (size_t)mcol;
+    return BX_FOUND;
+}
+
+/**
+ * The bracket at col of line, or just before it, and its match. Only the
+ * two blocks holding them are read and lexed; the blocks in between are
+ * skipped through the index. Text is read through the source under the
+ * lock, as the worker does.
+ */
+BxFind hl_match_bracket(Highlighter *hl, size_t line, size_t col,
+                        size_t *at, size_t *match_line, size_t *match_col) {
+    HlScratch *s = malloc(sizeof(HlScratch));
+    HlLexed *lx = malloc(BX_BLOCK_MAX * sizeof(HlLexed));
+    BxFind found = BX_NONE;
+
+    if (s && lx && scratch_init(s)) {
+        pthread_mutex_lock(&hl->lock);
+        if (hl->started) found = match_locked(hl, s, lx, line, col, at, match_line, match_col);
+        pthread_mutex_unlock(&hl->lock);
+        scratch_free(s);
+    }
+    free(s);
+    free(lx);
+    return found;
+}
+
+// ===== Outline =====
+
+bool hl_outline(Highlighter *hl, OutlineList *list) {
+    pthread_mutex_lock(&hl->lock);
+    bool changed = ol_build(&hl->outline, list);
+    pthread_mutex_unlock(&hl->lock);
+    return changed;
+}
+
+// ===== Lifetime =====
+
+void hl_init(Highlighter *hl) {
+    memset(hl, 0, sizeof(*hl));
+    for (int k = 1; k < HL_VIEWS; k++) hl->view_first[k] = hl->view_last[k] = HL_NO_VIEW;
+    bx_init(&hl->brackets);
+    ol_init(&hl->outline);
+    pthread_mutex_init(&hl->lock, NULL);
+    pthread_cond_init(&hl->wake, NULL);
+}
+
+void hl_free(Highlighter *hl) {
+    hl_stop(hl);
+    ol_free(&hl->outline);
+    pthread_mutex_destroy(&hl->lock);
+    pthread_cond_destroy(&hl->wake);
+}
+
+/**
+ * Highlight src with syntax from scratch. Without a thread nothing is
+ * highlighted: lexing a whole file inline is what this avoids.
+ */
+void hl_start(Highlighter *hl, const Syntax *syntax, Language lang, HlSource src) {
+    hl_stop(hl);
+    if (!syntax) return;
+
+    hl->syntax = syntax;
+    hl->outline_lang = ol_lang_of(lang);
+    hl->src = src;
+    hl->cancel = false;
+    hl->edits++;
+    hl->started = pthread_create(&hl->thread, NULL, hl_worker, hl) == 0;
+}
+
+// Join the worker and drop every result; call before the source goes away
+void hl_stop(Highlighter *hl) {
+    if (hl->started) {
+        pthread_mutex_lock(&hl->lock);
+        hl->cancel = true;
+        pthread_cond_signal(&hl->wake);
+        pthread_mutex_unlock(&hl->lock);
+        pthread_join(hl->thread, NULL);
+        hl->started = false;
+    }
+
+    for (size_t i = 0; i < HL_SLOTS; i++) {
+        free(hl->slots[i]);
+        hl->slots[i] = NULL;
+    }
+    free_chain(hl->retired);
+    hl->retired = NULL;
+    free(hl->states);
+    hl->states = NULL;
+    hl->nstates = hl->state_cap = 0;
+    hl->sweep = 0;
+    bx_free(&hl->brackets);
+    ol_clear(&hl->outline);
+}
+
+// ===== Edits =====
+
+void hl_lock(Highlighter *hl)   { pthread_mutex_lock(&hl->lock); }
+void hl_unlock(Highlighter *hl) { pthread_mutex_unlock(&hl->lock); }
+
+// Forget everything from line on, for the worker to count again
+static void forget_from(Highlighter *hl, size_t line) {
+    hl->nstates = line;
+    bx_resize(&hl->brackets, line);
+    ol_truncate(&hl->outline, line);
+}
+
+static void shift_states(Highlighter *hl, size_t line, long delta) {
+    if (line >= hl->nstates) return;
+    size_t after = hl->nstates - line - 1;
+    if (!bx_note_edit(&hl->brackets, line, delta)) {
+        forget_from(hl, line);
+        return;
+    }
+
+    if (delta > 0) {
+        size_t add = (size_t)delta;
+        if (!reserve_states(hl, hl->nstates + add)) {
+            forget_from(hl, line);
+            return;
+        }
+        hl->nstates += add;
+        memmove(hl->states + line + 1 + add, hl->states + line + 1, after * sizeof(uint16_t));
+        for (size_t k = 0; k < add; k++) hl->states[line + 1 + k] = HL_STATE_NONE;
+    } else if (delta < 0) {
+        size_t gone = (size_t)-delta < after ? (size_t)-delta : after;
+        memmove(hl->states + line + 1, hl->states + line + 1 + gone,
+                (after - gone) * sizeof(uint16_t));
+        hl->nstates -= gone;
+    }
+    hl->states[line] = HL_STATE_NONE;
+}
+
+/**
+ * The edited line keeps its old tokens, marked stale, until the worker
+ * replaces them, so typing does not flicker. Lines after it move with the
+ * edit; those removed are dropped. Runs on the UI thread, which is the only
+ * reader, so nothing needs retiring here.
+ */
+void hl_note_edit(Highlighter *hl, size_t line, long delta) {
+    hl->edits++;
+    shift_states(hl, line, delta);
+    ol_note_edit(&hl->outline, line, delta);
+    if (hl->sweep > line) hl->sweep = line;
+
+    if (delta == 0) {
+        HlLine *p = hl->slots[line & HL_MASK];
+        if (p && p->line == line) p->stale = true;
+        return;
+    }
+
+    HlLine **moved = malloc(HL_SLOTS * sizeof(*moved));
+    size_t n = 0;
+    for (size_t i = 0; i < HL_SLOTS; i++) {
+        HlLine *p = hl->slots[i];
+        if (!p) continue;
+        __atomic_store_n(&hl->slots[i], NULL, __ATOMIC_RELAXED);
+        if (p->line == line) p->stale = true;
+        if (p->line > line) {
+            if (!moved || (delta < 0 && p->line <= line + (size_t)-delta)) {
+                free(p);
+                continue;
+            }
+            p->line = (size_t)((long)p->line + delta);
+        }
+        if (moved) moved[n++] = p;
+        else publish(hl, p);
+    }
+    for (size_t k = 0; k < n; k++) {
+        HlLine **slot = &hl->slots[moved[k]->line & HL_MASK];
+        free(*slot);
+        __atomic_store_n(slot, moved[k], __ATOMIC_RELEASE);
+    }
+    free(moved);
+}
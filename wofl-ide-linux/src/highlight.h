@@ -0,0 +1,109 @@
+#ifndef HIGHLIGHT_H
+#define HIGHLIGHT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "lang_registry.h"
+#include "bracket_index.h"
+#include "fold_tree.h"
+#include "outline.h"
+
+// Syntax highlighting on a worker thread. The worker lexes the lines on
+// screen first, then the lines around them, then sweeps the whole file for
+// the lexer state each line starts in, the bracket depth of each block of
+// lines and the definitions in it (outline.h). Finished lines are
+// published with an atomic pointer swap: the renderer never locks or
+// waits, and draws plain text for lines that have no tokens yet.
+
+#define HL_SLOTS        8192        // lines with cached tokens, power of two
+#define HL_NEAR         2048        // lines either side of the screen that get tokens
+#define HL_BATCH        64          // lines lexed per worker step
+#define HL_LINE_MAX     (1u << 20)  // longer lines are left plain
+#define HL_IDLE_MS      20          // worker poll interval with nothing to do
+#define HL_HIDDEN_MAX   64          // folded ranges near the screen the worker skips
+#define HL_VIEWS        2           // split views of the source served at once
+#define HL_NO_VIEW      SIZE_MAX    // for hl_frame(): the view is not shown
+#define HL_STATE_NONE   0xFFFF
+
+// Tokens of one line. Immutable once published, except for stale.
+typedef struct HlLine HlLine;
+struct HlLine {
+    size_t line;
+    HlLine *retired;            // next in the list waiting for hl_frame()
+    uint16_t in_state;          // lexer state the line was lexed from
+    bool stale;                 // text edited since; drawn until replaced
+    int count;
+    TokenSpan spans[];
+};
+
+// Where the worker gets text; both are called with the lock held, from the
+// worker thread and from hl_match_bracket().
+// read_line() copies at most max bytes of the line, without its newline,
+// and returns its full length. line_count() counts complete lines only.
+typedef struct {
+    size_t (*read_line)(void *ctx, size_t line, char *out, size_t max);
+    size_t (*line_count)(void *ctx);
+    void *ctx;
+} HlSource;
+
+typedef struct {
+    const Syntax *syntax;
+    OutlineLang outline_lang;
+    HlSource src;
+    HlLine *slots[HL_SLOTS];    // published tokens, at line & (HL_SLOTS - 1)
+    HlLine *retired;            // replaced tokens, freed by the UI thread
+    size_t view_first[HL_VIEWS];    // source lines on screen per view, set by hl_frame()
+    size_t view_last[HL_VIEWS];
+
+    // Everything below is guarded by lock
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_t thread;
+    bool started;
+    bool cancel;
+    uint16_t *states;           // state at the end of each line, or HL_STATE_NONE
+    size_t nstates;
+    size_t state_cap;
+    size_t sweep;               // lines before it have their end state and depth
+    BracketIndex brackets;      // one line per state
+    OutlineIndex outline;       // blocks as the sweep scanned them
+    uint64_t edits;             // bumped per edit and start; older batches are dropped
+    FoldRange hidden[HL_HIDDEN_MAX];    // set by hl_set_hidden(), in order
+    int nhidden;
+} Highlighter;
+
+void hl_init(Highlighter *hl);
+void hl_free(Highlighter *hl);
+void hl_start(Highlighter *hl, const Syntax *syntax, Language lang, HlSource src);
+void hl_stop(Highlighter *hl);
+
+// UI thread, once per view and frame before hl_get(): frees replaced
+// tokens and moves the worker's attention to source lines [first, last] of
+// view. Views share the tokens; first is HL_NO_VIEW for one not shown.
+void hl_frame(Highlighter *hl, int view, size_t first, size_t last);
+const HlLine *hl_get(Highlighter *hl, size_t line);
+
+// UI thread, when they change: source lines folded away near the screen,
+// in order. No tokens are built for them; the sweep still lexes them for
+// lexer states and bracket depth.
+void hl_set_hidden(Highlighter *hl, const FoldRange *ranges, int n);
+
+// Buffer edits hold hl_lock() around the change and report it with
+// hl_note_edit(): the edited line and how many lines were added (or
+// removed, if negative) after it
+void hl_lock(Highlighter *hl);
+void hl_unlock(Highlighter *hl);
+void hl_note_edit(Highlighter *hl, size_t line, long delta);
+
+// UI thread, without the lock: the bracket at col of line, or else the one
+// just before it, and where its match is. *at gets the bracket's column.
+BxFind hl_match_bracket(Highlighter *hl, size_t line, size_t col,
+                        size_t *at, size_t *match_line, size_t *match_col);
+
+// UI thread: bring list up to date with the sweep's outline. Returns
+// whether it changed. Definitions past list->lines are not known yet.
+bool hl_outline(Highlighter *hl, OutlineList *list);
+
+#endif
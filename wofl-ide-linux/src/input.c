@@ -5,8 +5,102 @@
 #include "cursor.h"
 #include "editing.h"
 #include "gap_buffer.h"
+#include "follow.h"
+#include "filter.h"
+#include "folding.h"
+#include "symbols.h"
+#include "finder.h"
+#include "command_palette.h"
+#include "complete.h"
+#include "carets.h"
+#include "split.h"
+#include "macro.h"
+#include <limits.h>
+
+#define GOTO_PROMPT "Go to line[:col], n% or @offset: "
+
+static void start_goto(void) {
+    g_app.goto_active = true;
+    g_app.goto_text[0] = '\0';
+    strcpy(g_app.overlay_text, GOTO_PROMPT);
+    g_app.show_overlay = true;
+}
+
+static void finish_goto(void) {
+    GotoTarget target;
+    g_app.goto_active = false;
+    g_app.show_overlay = false;
+    if (goto_parse(g_app.goto_text, &target)) {
+        carets_clear();
+        goto_jump(&target);
+    }
+}
 
 void handle_key(SDL_Keycode key, Uint16 mod) {
+    if (macro_key(key, mod)) {
+        return;
+    }
+    
+    if (g_app.goto_active) {
+        size_t len = strlen(g_app.goto_text);
+        switch (key) {
+            case SDLK_ESCAPE:
+                g_app.goto_active = false;
+                g_app.show_overlay = false;
+                break;
+            case SDLK_RETURN:
+                finish_goto();
+                break;
+            case SDLK_BACKSPACE:
+                if (len > 0) g_app.goto_text[len - 1] = '\0';
+                snprintf(g_app.overlay_text, sizeof(g_app.overlay_text), "%s%s", GOTO_PROMPT, g_app.goto_text);
+                break;
+        }
+        return;
+    }
+    
+    if (g_app.symbol.active) {
+        symbols_key(key);
+        return;
+    }
+    
+    if (g_app.finder.active) {
+        finder_key(key);
+        return;
+    }
+    
+    if (g_app.palette.active) {
+        palette_key(key);
+        return;
+    }
+    
+    if (g_app.filter.prompt) {
+        switch (key) {
+            case SDLK_ESCAPE:
+                filter_close(false);
+                break;
+            case SDLK_RETURN:
+                filter_accept();
+                break;
+            case SDLK_BACKSPACE:
+                filter_backspace();
+                break;
+        }
+        return;
+    }
+    
+    // Filtered rows are read-only: Enter jumps to the source line
+    if (g_app.filter.active && !(mod & KMOD_CTRL)) {
+        if (key == SDLK_RETURN) {
+            filter_close(true);
+            return;
+        }
+        if (key == SDLK_ESCAPE) {
+            filter_close(false);
+            return;
+        }
+    }
+    
     if (g_app.find_active) {
         switch (key) {
             case SDLK_ESCAPE:
@@ -28,33 +122,38 @@ void handle_key(SDL_Keycode key, Uint16 mod) {
         return;
     }
     
+    if (!(mod & KMOD_CTRL) && complete_key(key)) {
+        return;
+    }
+    
+    if (key == SDLK_z && (mod & KMOD_ALT) && !(mod & KMOD_CTRL)) {
+        g_app.wrap = !g_app.wrap;
+        strcpy(g_app.overlay_text, g_app.wrap ? "Soft wrap: on" : "Soft wrap: off");
+        g_app.show_overlay = true;
+        return;
+    }
+    
     if (mod & KMOD_CTRL) {
+        if (key != SDLK_LCTRL && key != SDLK_RCTRL && key != SDLK_SPACE) complete_close();
         switch (key) {
+            case SDLK_SPACE:
+                complete_update(true);
+                break;
             case SDLK_q:
                 g_app.running = false;
                 break;
-            case SDLK_o: {
-                char file_path[WOFL_MAX_PATH];
-                if (open_file_dialog(file_path, sizeof(file_path))) {
-                    if (load_file(file_path)) {
-                        g_app.lang = detect_language(file_path);
-                        g_app.caret.line = 0;
-                        g_app.caret.col = 0;
-                        snprintf(g_app.overlay_text, sizeof(g_app.overlay_text), 
-                                "Opened: %s", g_app.file_name);
-                        g_app.show_overlay = true;
-                    }
-                }
+            case SDLK_o:
+                finder_start();
                 break;
-            }
             case SDLK_s:
-                if (mod & KMOD_SHIFT) {
+                if ((mod & KMOD_SHIFT) && !g_app.view_mode) {
                     // Save As
                     char file_path[WOFL_MAX_PATH];
                     if (save_file_dialog(file_path, sizeof(file_path))) {
                         strcpy(g_app.file_path, file_path);
                         const char *name = strrchr(file_path, '/');
                         strcpy(g_app.file_name, name ? name + 1 : file_path);
+                        select_language(file_path);
                         save_file();
                     }
                 } else {
@@ -65,11 +164,59 @@ void handle_key(SDL_Keycode key, Uint16 mod) {
             case SDLK_f:
                 start_find();
                 break;
-            case SDLK_p:
-                strcpy(g_app.overlay_text, "Command palette: Ctrl+O (open), Ctrl+S (save), Ctrl+F (find)");
+            case SDLK_g:
+                start_goto();
+                break;
+            case SDLK_r:
+                symbols_start();
+                break;
+            case SDLK_l:
+                filter_start();
+                break;
+            case SDLK_t:
+                if (g_app.follow.active) {
+                    follow_stop();
+                    strcpy(g_app.overlay_text, "Follow: off");
+                } else if (g_app.file_path[0] && !g_app.view_mode && !g_app.buf.dirty) {
+                    char path[WOFL_MAX_PATH];
+                    strcpy(path, g_app.file_path);
+                    if (follow_start(path)) {
+                        strcpy(g_app.overlay_text, "Follow: on");
+                    } else {
+                        strcpy(g_app.overlay_text, "Follow: cannot watch this file");
+                    }
+                } else {
+                    strcpy(g_app.overlay_text, "Follow: needs a saved, unmodified file");
+                }
                 g_app.show_overlay = true;
                 break;
+            case SDLK_HOME:
+                goto_line(0);
+                break;
+            case SDLK_END:
+                if (mod & KMOD_ALT) carets_add_to_end();
+                else goto_line(get_line_count() - 1);
+                break;
+            case SDLK_UP:
+            case SDLK_DOWN:
+                if (mod & KMOD_ALT) carets_add_line(key == SDLK_UP ? -1 : 1);
+                break;
+            case SDLK_LEFTBRACKET:
+                if (mod & KMOD_SHIFT) toggle_fold();
+                break;
+            case SDLK_RIGHTBRACKET:
+                if (mod & KMOD_SHIFT) unfold_all();
+                else move_cursor_to_bracket();
+                break;
+            case SDLK_p:
+                palette_start();
+                break;
+            case SDLK_BACKSLASH:
+                split_toggle(mod & KMOD_SHIFT ? SPLIT_STACKED : SPLIT_SIDE);
+                break;
         }
+    } else if (carets_move(key)) {
+        g_app.show_overlay = false;
     } else {
         switch (key) {
             case SDLK_UP:
@@ -88,20 +235,29 @@ void handle_key(SDL_Keycode key, Uint16 mod) {
                 move_cursor_right();
                 g_app.show_overlay = false;
                 break;
+            case SDLK_PAGEUP:
+                move_cursor_page(-1);
+                g_app.show_overlay = false;
+                break;
+            case SDLK_PAGEDOWN:
+                move_cursor_page(1);
+                g_app.show_overlay = false;
+                break;
             case SDLK_RETURN:
-                insert_text_at_cursor("\n", 1);
+                if (!carets_insert("\n", 1)) insert_text_at_cursor("\n", 1);
                 g_app.show_overlay = false;
                 break;
             case SDLK_BACKSPACE:
-                delete_at_cursor(false);
+                if (!carets_delete(false)) delete_at_cursor(false);
+                if (g_app.complete.visible) complete_update(false);
                 g_app.show_overlay = false;
                 break;
             case SDLK_DELETE:
-                delete_at_cursor(true);
+                if (!carets_delete(true)) delete_at_cursor(true);
                 g_app.show_overlay = false;
                 break;
             case SDLK_TAB:
-                insert_text_at_cursor("    ", 4);
+                if (!carets_insert("    ", 4)) insert_text_at_cursor("    ", 4);
                 g_app.show_overlay = false;
                 break;
             case SDLK_F3:
@@ -109,7 +265,11 @@ void handle_key(SDL_Keycode key, Uint16 mod) {
                     find_next();
                 }
                 break;
+            case SDLK_F6:
+                split_focus(1 - g_app.split.focus);
+                break;
             case SDLK_ESCAPE:
+                carets_clear();
                 g_app.show_overlay = false;
                 break;
         }
@@ -122,62 +282,92 @@ void handle_mouse_click(int x, int y) {
         return;
     }
     
+    // A click in the other split pane gives it the focus; positions are
+    // then taken within the pane
+    split_focus(split_pane_at(x, y));
+    const SDL_Rect *pane = &g_app.split.panes[g_app.split.focus];
+    x -= pane->x;
+    y -= pane->y;
+    
     // Convert screen coordinates to text position
-    int clicked_line = (y - 10) / g_app.line_height;
-    int clicked_col = (x - 10) / g_app.char_width;
+    int64_t total_lines = get_line_count();
+    
+    int digits = 1;
+    for (int64_t n = total_lines; n >= 10; n /= 10) digits++;
+    int text_x = 10 + (digits + 1) * g_app.char_width;
     
-    if (clicked_line < 0) clicked_line = 0;
+    int64_t clicked_row = g_app.scroll_y + (y - 10) / g_app.line_height;
+    int clicked_col = g_app.scroll_x + (x - text_x) / g_app.char_width;
+    
+    if (clicked_row < 0) clicked_row = 0;
     if (clicked_col < 0) clicked_col = 0;
     
-    // Find the actual line in the buffer
-    size_t buf_len = gb_length(&g_app.buf);
-    int current_line = 0;
-    int line_start_pos = 0;
-    int line_length = 0;
-    
-    // Scan through buffer to find the clicked line
-    for (size_t i = 0; i < buf_len; i++) {
-        char ch = gb_char_at(&g_app.buf, i);
-        
-        if (current_line == clicked_line) {
-            if (ch == '\n') {
-                line_length = i - line_start_pos;
-                break;
-            }
-        } else if (ch == '\n') {
-            current_line++;
-            if (current_line == clicked_line) {
-                line_start_pos = i + 1;
-            }
-        }
+    // Clicks below the last row land on it
+    int64_t total_rows = get_row_count();
+    if (clicked_row >= total_rows) clicked_row = total_rows - 1;
+    if (clicked_row < 0) clicked_row = 0;
+    int sub;
+    int64_t clicked_line = line_of_row(clicked_row, &sub);
+    
+    // A wrapped row starts sub rows into its line, and ends before the next
+    int wrap = wrap_columns();
+    int row_end = INT_MAX;
+    if (wrap > 0) {
+        if (clicked_col > wrap) clicked_col = wrap;
+        clicked_col += sub * wrap;
+        if (sub + 1 < line_rows(clicked_line)) row_end = (sub + 1) * wrap - 1;
     }
     
-    // Handle click past end of buffer
-    if (current_line < clicked_line) {
-        // Clicked below last line - move to end of buffer
-        g_app.caret.line = current_line;
-        g_app.caret.col = line_length;
-    } else {
-        // Clicked on valid line
-        g_app.caret.line = clicked_line;
-        g_app.caret.col = clicked_col;
-        
-        // Clamp column to line length
-        int actual_line_len = get_line_length(clicked_line);
-        if (g_app.caret.col > actual_line_len) {
-            g_app.caret.col = actual_line_len;
-        }
+    carets_clear();
+    g_app.caret.line = clicked_line;
+    g_app.caret.col = clicked_col < row_end ? clicked_col : row_end;
+    
+    // Clamp column to line length
+    int actual_line_len = get_line_length(clicked_line);
+    if (g_app.caret.col > actual_line_len) {
+        g_app.caret.col = actual_line_len;
     }
     
     // Clear overlay when clicking in editor
     g_app.show_overlay = false;
+    g_app.finder.active = false;
+    g_app.palette.active = false;
+    complete_close();
 }
 
 void handle_text_input(const char* text) {
-    if (g_app.find_active) {
+    if (macro_text(text)) {
+        return;
+    }
+    if (g_app.goto_active) {
+        size_t len = strlen(g_app.goto_text);
+        for (; text && *text && len < sizeof(g_app.goto_text) - 1; text++) {
+            if (goto_char_ok((unsigned char)*text)) g_app.goto_text[len++] = *text;
+        }
+        g_app.goto_text[len] = '\0';
+        snprintf(g_app.overlay_text, sizeof(g_app.overlay_text), "%s%s", GOTO_PROMPT, g_app.goto_text);
+    } else if (g_app.symbol.active) {
+        symbols_input(text);
+    } else if (g_app.finder.active) {
+        finder_input(text);
+    } else if (g_app.palette.active) {
+        palette_input(text);
+    } else if (g_app.filter.prompt) {
+        filter_input(text);
+    } else if (g_app.find_active) {
         handle_find_input(text);
+    } else if (SDL_GetModState() & KMOD_LALT) {
+        // Alt shortcuts may still send their letter
+        return;
     } else if (text && text[0] && text[0] != '\b' && text[0] != '\n' && text[0] != '\t') {
-        insert_text_at_cursor(text, strlen(text));
+        size_t len = strlen(text);
+        bool many = carets_insert(text, len);
+        if (!many) insert_text_at_cursor(text, len);
         g_app.show_overlay = false;
+        // Words typed open the popup or narrow it; anything else closes it.
+        // There is no completing at many carets.
+        unsigned char last = (unsigned char)text[len - 1];
+        if (!many && (isalnum(last) || last == '_')) complete_update(false);
+        else complete_close();
     }
 }
\ No newline at end of file
@@ -1,13 +1,26 @@
 #include "language.h"
+#include "gap_buffer.h"
+#include "editing.h"
 
-Language detect_language(const char *path) {
-    const char *ext = strrchr(path, '.');
-    if (!ext) return LANG_NONE;
+// Enough of the first line for any sensible shebang
+#define SHEBANG_MAX 128
+
+void select_language(const char *path) {
+    char first[SHEBANG_MAX];
+    size_t len = 0;
     
-    if (strcmp(ext, ".c") == 0 || strcmp(ext, ".h") == 0) return LANG_C;
-    if (strcmp(ext, ".py") == 0) return LANG_PY;
-    if (strcmp(ext, ".js") == 0) return LANG_JS;
-    if (strcmp(ext, ".sh") == 0) return LANG_SH;
+    if (g_app.view_mode) {
+        len = fv_read_line(&g_app.view, 0, first, sizeof(first));
+    } else {
+        size_t total = gb_length(&g_app.buf);
+        while (len < total && len < sizeof(first) - 1) {
+            char ch = gb_char_at(&g_app.buf, len);
+            if (ch == '\n') break;
+            first[len++] = ch;
+        }
+    }
     
-    return LANG_NONE;
-}
\ No newline at end of file
+    g_app.lang = lang_detect(path, first, len);
+    g_app.syntax = syntax_get(g_app.lang);
+    buffer_highlight_start();
+}
@@ -3,6 +3,9 @@
 
 #include "app.h"
 
-Language detect_language(const char *path);
+// Pick g_app.lang and g_app.syntax for path, falling back to a shebang on
+// the first line of what is loaded, and restart highlighting with it. Call
+// once per file, not per frame.
+void select_language(const char *path);
 
-#endif
\ No newline at end of file
+#endif
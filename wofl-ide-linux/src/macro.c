@@ -0,0 +1,284 @@
+#include "macro.h"
+#include "input.h"
+#include "cursor.h"
+#include "editing.h"
+#include "carets.h"
+
+#define MACRO_PROMPT    "Play macro how many times: "
+#define MACRO_LINES     "Play macro on how many lines from here: "
+#define MACRO_TIMES_MAX 10000000        // runs, or lines played on
+
+// ===== Recording =====
+
+static bool reserve_steps(Macro *m) {
+    if (m->count < m->cap) return true;
+    size_t cap = m->cap ? m->cap * 2 : 64;
+    MacroStep *steps = (MacroStep *)realloc(m->steps, cap * sizeof(MacroStep));
+    if (!steps) return false;
+    m->steps = steps;
+    m->cap = cap;
+    return true;
+}
+
+static bool reserve_text(Macro *m, size_t n) {
+    if (m->text_len + n <= m->text_cap) return true;
+    size_t cap = m->text_cap ? m->text_cap : 256;
+    while (cap < m->text_len + n) cap *= 2;
+    char *text = (char *)realloc(m->text, cap);
+    if (!text) return false;
+    m->text = text;
+    m->text_cap = cap;
+    return true;
+}
+
+static void record_key(SDL_Keycode key, Uint16 mod) {
+    Macro *m = &g_app.macro;
+    if (!reserve_steps(m)) return;
+    m->steps[m->count++] = (MacroStep){ key, mod, 0 };
+}
+
+// Text right after text goes into the same step: it is inserted in one
+// edit when played
+static void record_text(const char *text) {
+    Macro *m = &g_app.macro;
+    size_t len = strlen(text);
+    if (len == 0) return;
+    bool join = m->count > 0 && m->steps[m->count - 1].key == 0;
+    if (!reserve_text(m, len + 1)) return;
+    if (join) {
+        m->text_len--;                  // over the 0
+    } else {
+        if (!reserve_steps(m)) return;
+        m->steps[m->count++] = (MacroStep){ 0, 0, m->text_len };
+    }
+    memcpy(m->text + m->text_len, text, len + 1);
+    m->text_len += len + 1;
+}
+
+void macro_toggle_record(void) {
+    Macro *m = &g_app.macro;
+    if (m->recording) {
+        m->recording = false;
+        snprintf(g_app.overlay_text, sizeof(g_app.overlay_text),
+                 "Macro: %zu steps recorded (F8 plays it)", m->count);
+    } else {
+        m->recording = true;
+        m->count = 0;
+        m->text_len = 0;
+        strcpy(g_app.overlay_text, "Macro: recording (F7 stops)");
+    }
+    g_app.show_overlay = true;
+}
+
+void macro_free(void) {
+    Macro *m = &g_app.macro;
+    free(m->steps);
+    free(m->text);
+    memset(m, 0, sizeof(*m));
+}
+
+// ===== Playing =====
+
+static bool ready(void) {
+    const Macro *m = &g_app.macro;
+    if (m->recording) {
+        strcpy(g_app.overlay_text, "Macro: stop recording first (F7)");
+    } else if (m->count == 0) {
+        strcpy(g_app.overlay_text, "Macro: nothing recorded (F7 starts)");
+    } else {
+        return true;
+    }
+    g_app.show_overlay = true;
+    return false;
+}
+
+// The steps once, through the same handlers as when they were typed
+static void play_once(void) {
+    const Macro *m = &g_app.macro;
+    for (size_t i = 0; i < m->count && g_app.running; i++) {
+        const MacroStep *s = &m->steps[i];
+        if (s->key) handle_key(s->key, s->mod);
+        else handle_text_input(m->text + s->text);
+    }
+}
+
+static void play_begin(void) {
+    g_app.macro.playing = true;
+    buffer_batch_begin();
+}
+
+static void play_end(size_t runs, Uint32 started, const char *where) {
+    buffer_batch_end();
+    g_app.macro.playing = false;
+    snprintf(g_app.overlay_text, sizeof(g_app.overlay_text), "Macro: played %zu time%s%s in %u ms",
+             runs, runs == 1 ? "" : "s", where, (unsigned)(SDL_GetTicks() - started));
+    g_app.show_overlay = true;
+}
+
+/**
+ * Play the steps times over, from where the caret is. Stops early once a
+ * run edits nothing and leaves the caret where it was: every run after
+ * would do the same.
+ */
+void macro_play(long times) {
+    if (!ready() || times <= 0) return;
+    if (times > MACRO_TIMES_MAX) times = MACRO_TIMES_MAX;
+    const Uint32 started = SDL_GetTicks();
+    size_t runs = 0;
+    play_begin();
+    while (runs < (size_t)times && g_app.running) {
+        const size_t caret = get_cursor_index();
+        const size_t edits = buffer_edits();
+        play_once();
+        runs++;
+        if (get_cursor_index() == caret && buffer_edits() == edits) break;
+    }
+    play_end(runs, started, "");
+}
+
+/**
+ * Play the steps once from each of the n positions at, first in the text
+ * to last, with the caret there and no others. Where the runs still to
+ * come start is kept in anchors, which the runs before move along with
+ * their edits.
+ */
+static void play_at(const size_t *at, size_t n, const char *where) {
+    AnchorId *ids = (AnchorId *)malloc(n * sizeof(AnchorId));
+    if (!ids) return;
+    if (g_app.carets > 0) carets_clear();
+    for (size_t i = 0; i < n; i++) an_add(&g_app.anchors, at[i], AN_RIGHT, ANCHOR_MACRO);
+    n = an_collect(&g_app.anchors, 0, SIZE_MAX, ANCHOR_MACRO, ids, NULL, n);
+
+    const Uint32 started = SDL_GetTicks();
+    play_begin();
+    for (size_t i = 0; i < n && g_app.running; i++) {
+        move_cursor_to_index(an_pos(&g_app.anchors, ids[i]));
+        an_remove(&g_app.anchors, ids[i]);
+        if (g_app.carets > 0) carets_clear();      // the last run's own
+        play_once();
+    }
+    an_remove_owner(&g_app.anchors, ANCHOR_MACRO);
+    play_end(n, started, where);
+    free(ids);
+}
+
+// Once at each caret, the main one among them
+void macro_play_at_carets(void) {
+    if (!ready()) return;
+    size_t n = (size_t)g_app.carets + 1;
+    size_t *at = (size_t *)malloc(n * sizeof(size_t));
+    if (!at) return;
+    at[0] = get_cursor_index();
+    n = an_collect(&g_app.anchors, 0, SIZE_MAX, ANCHOR_CARET, NULL, at + 1, n - 1) + 1;
+    play_at(at, n, " at the carets");
+    free(at);
+}
+
+// Once from the start of each of lines lines, the caret's and those below
+void macro_play_lines(long lines) {
+    if (!ready() || lines <= 0) return;
+    if (lines > MACRO_TIMES_MAX) lines = MACRO_TIMES_MAX;
+    const int64_t first = g_app.caret.line;
+    const int64_t left = get_line_count() - first;
+    size_t n = (size_t)(lines < left ? lines : left);
+    size_t *at = (size_t *)malloc(n * sizeof(size_t));
+    if (!at) return;
+    const Caret saved = g_app.caret;
+    for (size_t i = 0; i < n; i++) {
+        g_app.caret = (Caret){ first + (int64_t)i, 0 };
+        at[i] = get_cursor_index();
+    }
+    g_app.caret = saved;
+    play_at(at, n, " line by line");
+    free(at);
+}
+
+// ===== Count prompt =====
+
+void macro_prompt_start(bool per_line) {
+    if (!ready()) return;
+    Macro *m = &g_app.macro;
+    m->prompt = true;
+    m->per_line = per_line;
+    m->count_text[0] = '\0';
+    strcpy(g_app.overlay_text, per_line ? MACRO_LINES : MACRO_PROMPT);
+    g_app.show_overlay = true;
+}
+
+static void prompt_show(void) {
+    const Macro *m = &g_app.macro;
+    snprintf(g_app.overlay_text, sizeof(g_app.overlay_text), "%s%s", m->per_line ? MACRO_LINES : MACRO_PROMPT,
+             m->count_text);
+}
+
+static void prompt_key(SDL_Keycode key) {
+    Macro *m = &g_app.macro;
+    size_t len = strlen(m->count_text);
+    switch (key) {
+        case SDLK_ESCAPE:
+            m->prompt = false;
+            g_app.show_overlay = false;
+            break;
+        case SDLK_RETURN:
+            m->prompt = false;
+            g_app.show_overlay = false;
+            if (m->per_line) macro_play_lines(atol(m->count_text));
+            else macro_play(atol(m->count_text));
+            break;
+        case SDLK_BACKSPACE:
+            if (len > 0) m->count_text[len - 1] = '\0';
+            prompt_show();
+            break;
+    }
+}
+
+// ===== Events =====
+
+/**
+ * F7 and F8 are the macro's own, and are never recorded; neither are the
+ * modifier keys alone. While playing, the steps go by untouched.
+ */
+bool macro_key(SDL_Keycode key, Uint16 mod) {
+    Macro *m = &g_app.macro;
+    if (m->playing) return false;
+    if (m->prompt) {
+        prompt_key(key);
+        return true;
+    }
+    switch (key) {
+        case SDLK_F7:
+            macro_toggle_record();
+            return true;
+        case SDLK_F8:
+            if (mod & KMOD_SHIFT) macro_prompt_start(false);
+            else if (mod & KMOD_CTRL) macro_prompt_start(true);
+            else if (g_app.carets > 0) macro_play_at_carets();
+            else macro_play(1);
+            return true;
+        case SDLK_LCTRL: case SDLK_RCTRL:
+        case SDLK_LSHIFT: case SDLK_RSHIFT:
+        case SDLK_LALT: case SDLK_RALT:
+        case SDLK_LGUI: case SDLK_RGUI:
+            return false;
+    }
+    if (m->recording) record_key(key, mod);
+    return false;
+}
+
+// Text sent along with an Alt shortcut is dropped by the editor, and so
+// not recorded either
+bool macro_text(const char *text) {
+    Macro *m = &g_app.macro;
+    if (m->playing || !text) return false;
+    if (m->prompt) {
+        size_t len = strlen(m->count_text);
+        for (; *text && len < sizeof(m->count_text) - 1; text++) {
+            if (isdigit((unsigned char)*text)) m->count_text[len++] = *text;
+        }
+        m->count_text[len] = '\0';
+        prompt_show();
+        return true;
+    }
+    if (m->recording && !(SDL_GetModState() & KMOD_LALT)) record_text(text);
+    return false;
+}
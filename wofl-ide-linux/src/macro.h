@@ -0,0 +1,24 @@
+#ifndef MACRO_H
+#define MACRO_H
+
+#include "app.h"
+
+// Keystroke macros. F7 starts recording the keys and text that reach the
+// editor and stops it; F8 plays them back once, or once at each caret when
+// there are many, Shift+F8 asks how many times and Ctrl+F8 on how many
+// lines, once from the start of each. Clicks are not recorded. A play is one batch of edits (editing.h): nothing is drawn
+// until it ends and the text is lexed once.
+void macro_toggle_record(void);
+void macro_play(long times);
+void macro_play_at_carets(void);
+void macro_play_lines(long lines);
+void macro_free(void);
+
+void macro_prompt_start(bool per_line);
+
+// Every key and text event on its way in: true if it was the macro's own
+// or its prompt's, and goes no further
+bool macro_key(SDL_Keycode key, Uint16 mod);
+bool macro_text(const char *text);
+
+#endif
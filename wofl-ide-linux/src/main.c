@@ -5,34 +5,74 @@
 #include "rendering.h"
 #include "input.h"
 #include "sdl_utils.h"
+#include "editing.h"
+#include "follow.h"
+#include "cursor.h"
+#include "symbols.h"
+#include "finder.h"
+#include "command_palette.h"
+#include "carets.h"
+#include "split.h"
+#include "macro.h"
 
 AppState g_app = {0};
 
 int main(int argc, char *argv[]) {
     gb_init(&g_app.buf);
+    lix_init(&g_app.lines);
+    hl_init(&g_app.hl);
+    ft_init(&g_app.folds);
+    ft_set_rows(&g_app.folds, wrapped_rows_before, NULL);
+    fa_init(&g_app.frame);
+    six_init(&g_app.symbols);
+    ffx_init(&g_app.files);
+    wc_init(&g_app.words);
+    an_init(&g_app.anchors);
+    g_app.find_mark = an_add(&g_app.anchors, 0, AN_RIGHT, ANCHOR_FIND);
+    palette_init();
+    buffer_index_start();
     g_app.running = true;
     
-    if (argc > 1) {
-        if (load_file(argv[1])) {
-            g_app.lang = detect_language(argv[1]);
-        }
+    if (argc > 2 && strcmp(argv[1], "--view") == 0) {
+        // Page the file in read-only, whatever its size
+        open_view(argv[2]);
+    } else if (argc > 2 && strcmp(argv[1], "--follow") == 0) {
+        follow_start(argv[2]);
+    } else if (argc > 1) {
+        load_file(argv[1]);
     } else {
         const char *test_content = "# WOFL IDE - SDL2 Version\nprint('Hello from SDL2!')\n\ndef test_function():\n    return 42\n";
         gb_insert(&g_app.buf, test_content, strlen(test_content));
         strcpy(g_app.file_name, "test.py");
+        select_language(g_app.file_name);
+        buffer_index_start();
+        buffer_words_open(NULL);
     }
     
     if (!init_sdl()) {
         return 1;
     }
+    symbols_index_start();
+    finder_index_start();
     
     SDL_StartTextInput();
     
     printf("WOFL IDE SDL2 - Controls:\n");
     printf("Ctrl+Q - Quit\n");
-    printf("Ctrl+O - Open file\n"); 
+    printf("Ctrl+P - Command palette: commands, recent files and symbols\n");
+    printf("Ctrl+O - Open a file of the workspace by name\n");
     printf("Ctrl+F - Find text\n");
     printf("F3 - Find next\n");
+    printf("Ctrl+G - Go to line\n");
+    printf("Ctrl+R - Go to symbol in the workspace\n");
+    printf("Ctrl+Space - Complete the word (Tab or Enter takes it)\n");
+    printf("Ctrl+T - Follow file (tail -f)\n");
+    printf("Ctrl+L - Filter lines (Enter jumps to the line)\n");
+    printf("Alt+Z - Toggle soft wrap\n");
+    printf("Ctrl+\\ / Ctrl+Shift+\\ - Split side by side / top and bottom (again to close)\n");
+    printf("F6 - Focus the other split\n");
+    printf("F7 - Record a macro / stop recording\n");
+    printf("F8 / Shift+F8 - Play the macro once, or at each caret / a number of times\n");
     printf("Arrow keys - Move cursor\n");
     
     SDL_Event e;
@@ -56,12 +96,30 @@ int main(int argc, char *argv[]) {
             }
         }
         
+        follow_poll();
+        symbols_poll();
+        finder_poll();
+        palette_poll();
         render_editor();
         SDL_RenderPresent(g_app.renderer);
         SDL_Delay(16); // ~60 FPS
     }
     
     SDL_StopTextInput();
+    follow_stop();
+    six_free(&g_app.symbols);
+    ffx_free(&g_app.files);
+    wc_free(&g_app.words);
+    palette_free();
+    carets_clear();
+    split_close();
+    macro_free();
+    an_free(&g_app.anchors);
+    hl_free(&g_app.hl);
+    ft_free(&g_app.folds);
+    fv_close(&g_app.view);
+    lix_free(&g_app.lines);
+    fa_free(&g_app.frame);
     cleanup();
     return 0;
 }
\ No newline at end of file
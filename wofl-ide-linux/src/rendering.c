@@ -2,6 +2,8 @@
 #include "gap_buffer.h"
 #include "cursor.h"
 #include "syntax.h"
+#include "command_palette.h"
+#include "split.h"
 
 void render_text(const char *text, int x, int y, SDL_Color color) {
     if (!text || !text[0]) return;
@@ -19,90 +21,562 @@ void render_text(const char *text, int x, int y, SDL_Color color) {
     SDL_FreeSurface(surface);
 }
 
-void render_editor() {
-    SDL_SetRenderDrawColor(g_app.renderer, 20, 20, 20, 255);
-    SDL_RenderClear(g_app.renderer);
+// Read columns `from` up to `max` of a line (without its newline) into the
+// frame arena, from the buffer, the filter's matching lines or the mapped
+// file; the result starts at column `from`. `line` is in caret terms: a
+// filter row while filtering. Sets *len to the column reached (0 if the
+// line ends before `from`), and *line_num to the source line.
+static char *fetch_row(int64_t line, int64_t *line_num, int from, int max, int *len) {
+    *line_num = line;
+    *len = 0;
+    if (g_app.view_mode) {
+        // Mapped lines are read from their start
+        char *out = fa_new(&g_app.frame, char, max + 1);
+        if (!out) return NULL;
+        int n = (int)fv_read_line(&g_app.view, (uint64_t)line, out, (size_t)max + 1);
+        if (n > from) *len = n;
+        return out + (n > from ? from : n);
+    }
+    
+    char *out = fa_new(&g_app.frame, char, max - from + 1);
+    if (!out) return NULL;
+    out[0] = '\0';
+    size_t pos, known = 0;
+    if (g_app.filter.active) {
+        *line_num = (int64_t)g_app.filter.hits[line].line;
+        pos = g_app.filter.hits[line].start;
+    } else {
+        lix_lock(&g_app.lines);
+        pos = li_line_start(&g_app.lines.index, (size_t)line);
+        if ((size_t)line < li_line_count(&g_app.lines.index)) {
+            known = li_line_length(&g_app.lines.index, (size_t)line);
+        }
+        lix_unlock(&g_app.lines);
+    }
+    
+    // Skip to `from`: straight over what the index knows of the line,
+    // then looking for its end, so wrapped rows far along stay cheap
+    size_t skip = known < (size_t)from ? known : (size_t)from;
+    pos += skip;
+    while (skip < (size_t)from) {
+        size_t avail;
+        const char *p = gb_segment(&g_app.buf, pos, &avail);
+        if (!p || avail == 0) return out;
+        size_t take = avail < (size_t)from - skip ? avail : (size_t)from - skip;
+        if (memchr(p, '\n', take)) return out;
+        skip += take;
+        pos += take;
+    }
+    
+    int n = 0;
+    max -= from;
+    while (n < max) {
+        size_t avail;
+        const char *p = gb_segment(&g_app.buf, pos, &avail);
+        if (!p || avail == 0) break;
+        size_t take = avail < (size_t)(max - n) ? avail : (size_t)(max - n);
+        const char *nl = memchr(p, '\n', take);
+        if (nl) take = (size_t)(nl - p);
+        memcpy(out + n, p, take);
+        n += (int)take;
+        pos += take;
+        if (nl) break;
+    }
+    out[n] = '\0';
+    *len = n > 0 ? from + n : 0;
+    return out;
+}
+
+// The bracket at the caret and its match. Looked up again when the caret
+// moves or the text changes, and every frame while the sweep catches up.
+static struct {
+    bool valid;
+    size_t line, col;
+    uint64_t edits;
+    BxFind found;
+    size_t at, match_line, match_col;
+} bracket;
+
+static void update_bracket(size_t line, size_t col) {
+    if (bracket.valid && bracket.found != BX_PENDING && bracket.line == line &&
+        bracket.col == col && bracket.edits == g_app.hl.edits) {
+        return;
+    }
+    bracket.valid = true;
+    bracket.line = line;
+    bracket.col = col;
+    bracket.edits = g_app.hl.edits;
+    bracket.found = hl_match_bracket(&g_app.hl, line, col, &bracket.at,
+                                     &bracket.match_line, &bracket.match_col);
+}
+
+// Definitions around the caret, outermost first, for the status bar. The
+// outline is rebuilt when the text changes, and every frame until the
+// sweep has passed the caret.
+static struct {
+    bool valid;
+    size_t line;
+    uint64_t edits;
+    OutlineList list;
+    char path[3 * OL_NAME_MAX + 8];
+} scope;
+
+static void update_scope(size_t line) {
+    if (!scope.valid) ol_list_init(&scope.list);
+    if (scope.valid && scope.line == line && scope.edits == g_app.hl.edits &&
+        scope.list.lines > line) {
+        return;
+    }
+    scope.valid = true;
+    scope.line = line;
+    scope.edits = g_app.hl.edits;
+    if (g_app.hl.outline_lang != OL_LANG_NONE) hl_outline(&g_app.hl, &scope.list);
+
+    int chain[3], n = 0;
+    for (int i = ol_enclosing(&scope.list, line); i >= 0 && n < 3; i = scope.list.symbols[i].parent) {
+        chain[n++] = i;
+    }
+    scope.path[0] = '\0';
+    for (int k = n - 1; k >= 0; k--) {
+        size_t used = strlen(scope.path);
+        snprintf(scope.path + used, sizeof(scope.path) - used, "%s%s",
+                 k < n - 1 ? " > " : "", scope.list.symbols[chain[k]].name);
+    }
+}
+
+// Source line shown on a screen row
+static size_t source_line(int64_t row) {
+    int64_t line = line_of_row(row, NULL);
+    return g_app.filter.active ? g_app.filter.hits[line].line : (size_t)line;
+}
+
+// Folded ranges near each view, passed on to the highlight worker, all
+// together, when they change
+static struct {
+    FoldRange ranges[HL_VIEWS][HL_HIDDEN_MAX];
+    int n[HL_VIEWS];
+} hidden;
+
+static void update_hidden(int view, size_t first, size_t last) {
+    FoldRange ranges[HL_HIDDEN_MAX];
+    int n = 0;
+    if (!g_app.filter.active && first != HL_NO_VIEW) {
+        size_t lo = first > HL_NEAR ? first - HL_NEAR : 0;
+        n = ft_hidden_in(&g_app.folds, lo, last + 1 + HL_NEAR, ranges, HL_HIDDEN_MAX);
+    }
+    if (n == hidden.n[view] && memcmp(ranges, hidden.ranges[view], (size_t)n * sizeof(FoldRange)) == 0) return;
+    memcpy(hidden.ranges[view], ranges, (size_t)n * sizeof(FoldRange));
+    hidden.n[view] = n;
     
-    // Render text with cursor tracking
-    size_t len = gb_length(&g_app.buf);
-    char line_buf[1024];
-    int line_pos = 0;
-    int y = 10;
-    int line_num = 0;
-    int cursor_x = 10, cursor_y = 10;
-    bool cursor_found = false;
-    
-    for (size_t i = 0; i <= len; i++) {
-        char ch = (i < len) ? gb_char_at(&g_app.buf, i) : '\n'; // Force final line render
+    // Merged in order; views near each other share ranges
+    int at[HL_VIEWS] = {0}, count = 0;
+    for (;;) {
+        int pick = -1;
+        for (int k = 0; k < HL_VIEWS; k++) {
+            if (at[k] < hidden.n[k] &&
+                (pick < 0 || hidden.ranges[k][at[k]].first < hidden.ranges[pick][at[pick]].first)) {
+                pick = k;
+            }
+        }
+        if (pick < 0 || count == HL_HIDDEN_MAX) break;
+        const FoldRange *next = &hidden.ranges[pick][at[pick]++];
+        if (count > 0 && next->first <= ranges[count - 1].last) continue;
+        ranges[count++] = *next;
+    }
+    hl_set_hidden(&g_app.hl, ranges, count);
+}
+
+static void outline_cell(int x, int y) {
+    SDL_SetRenderDrawColor(g_app.renderer, 130, 130, 130, 255);
+    SDL_Rect cell = {x, y, g_app.char_width, g_app.line_height};
+    SDL_RenderDrawRect(g_app.renderer, &cell);
+}
+
+// Carets besides the main one on lines first..last; there may be thousands,
+// so only the anchors in those lines' text are read
+static void render_carets(int text_x, int text_y, int visible_lines, int wrap, size_t first, size_t last) {
+    if (g_app.carets == 0 || g_app.view_mode || g_app.filter.active) return;
+    size_t pos[256];
+    lix_lock(&g_app.lines);
+    size_t from = li_line_start(&g_app.lines.index, first);
+    const size_t to = last + 1 < li_line_count(&g_app.lines.index) ? li_line_start(&g_app.lines.index, last + 1)
+                                                                    : gb_length(&g_app.buf);
+    lix_unlock(&g_app.lines);
+    SDL_SetRenderDrawColor(g_app.renderer, 170, 170, 170, 255);
+    size_t n;
+    while ((n = an_collect(&g_app.anchors, from, to, ANCHOR_CARET, NULL, pos, 256)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            lix_lock(&g_app.lines);
+            const size_t line = li_line_of(&g_app.lines.index, pos[i]);
+            int col = (int)(pos[i] - li_line_start(&g_app.lines.index, line));
+            lix_unlock(&g_app.lines);
+            if (ft_is_hidden(&g_app.folds, line)) continue;
+            int64_t row = row_of_line((int64_t)line);
+            if (wrap > 0 && col > 0) {
+                int sub = col / wrap, rows = line_rows((int64_t)line);
+                if (sub >= rows) sub = rows - 1;
+                row += sub;
+                col -= sub * wrap;
+            }
+            row -= g_app.scroll_y;
+            col -= g_app.scroll_x;
+            if (row < 0 || row >= visible_lines || col < 0) continue;
+            SDL_Rect rect = {text_x + col * g_app.char_width, text_y + (int)row * g_app.line_height, 2, g_app.line_height};
+            SDL_RenderFillRect(g_app.renderer, &rect);
+        }
+        from = pos[n - 1] + 1;
+    }
+}
+
+// Completion popup under the caret at x, y, or above it when there is no
+// room below
+static void render_completion(int x, int y, int text_bottom, int win_w) {
+    const CompletePopup *cp = &g_app.complete;
+    int longest = 0;
+    for (int i = 0; i < cp->count; i++) {
+        if (cp->items[i].len > longest) longest = cp->items[i].len;
+    }
+    int w = (longest + 2) * g_app.char_width;
+    int h = cp->count * g_app.line_height + 4;
+    x -= (cp->prefix_len + 1) * g_app.char_width;
+    y += g_app.line_height;
+    if (y + h > text_bottom && y - g_app.line_height - h >= 0) y -= g_app.line_height + h;
+    if (x + w > win_w) x = win_w - w;
+    if (x < 0) x = 0;
+    
+    SDL_SetRenderDrawColor(g_app.renderer, 35, 35, 50, 255);
+    SDL_Rect bg = {x, y, w, h};
+    SDL_RenderFillRect(g_app.renderer, &bg);
+    for (int i = 0; i < cp->count; i++) {
+        int item_y = y + 2 + i * g_app.line_height;
+        if (i == cp->selected) {
+            SDL_SetRenderDrawColor(g_app.renderer, 60, 60, 110, 255);
+            SDL_Rect sel = {x, item_y, w, g_app.line_height};
+            SDL_RenderFillRect(g_app.renderer, &sel);
+        }
+        render_text(cp->items[i].word, x + g_app.char_width, item_y, (SDL_Color){230, 230, 230, 255});
+    }
+}
+
+// Quick open hits under the prompt: directories dimmed, names bright
+static void render_finder(int win_w) {
+    const FinderPrompt *fp = &g_app.finder;
+    int rows = fp->count - fp->top;
+    if (rows > FINDER_ROWS) rows = FINDER_ROWS;
+    if (rows <= 0) return;
+    
+    SDL_SetRenderDrawColor(g_app.renderer, 25, 25, 45, 240);
+    SDL_Rect bg = {0, 30, win_w, rows * g_app.line_height + 4};
+    SDL_RenderFillRect(g_app.renderer, &bg);
+    for (int r = 0; r < rows; r++) {
+        const int i = fp->top + r;
+        const int y = 32 + r * g_app.line_height;
+        if (i == fp->selected) {
+            SDL_SetRenderDrawColor(g_app.renderer, 60, 60, 110, 255);
+            SDL_Rect sel = {0, y, win_w, g_app.line_height};
+            SDL_RenderFillRect(g_app.renderer, &sel);
+        }
+        const char *path = fp->hits[i].path;
+        const char *name = strrchr(path, '/');
+        name = name ? name + 1 : path;
+        render_text(name, 10, y, (SDL_Color){240, 240, 240, 255});
+        if (name > path) {
+            char dir[FF_PATH_MAX];
+            snprintf(dir, sizeof(dir), "%.*s", (int)(name - path - 1), path);
+            render_text(dir, 10 + ((int)strlen(name) + 2) * g_app.char_width, y, (SDL_Color){140, 140, 160, 255});
+        }
+    }
+}
+
+// Palette hits: the label, then what it is and where, dimmed
+static void render_palette(int win_w) {
+    const PalettePrompt *pp = &g_app.palette;
+    const Palette *pal = &pp->pal;
+    int rows = pal->nhits - pp->top;
+    if (rows > PALETTE_ROWS) rows = PALETTE_ROWS;
+    if (rows <= 0) return;
+    
+    SDL_SetRenderDrawColor(g_app.renderer, 25, 25, 45, 240);
+    SDL_Rect bg = {0, 30, win_w, rows * g_app.line_height + 4};
+    SDL_RenderFillRect(g_app.renderer, &bg);
+    for (int r = 0; r < rows; r++) {
+        const int i = pp->top + r;
+        const int y = 32 + r * g_app.line_height;
+        if (i == pp->selected) {
+            SDL_SetRenderDrawColor(g_app.renderer, 60, 60, 110, 255);
+            SDL_Rect sel = {0, y, win_w, g_app.line_height};
+            SDL_RenderFillRect(g_app.renderer, &sel);
+        }
+        const PaletteEntry *e = &pal->entries[pal->hits[i].entry];
+        const char *label = pal_label(pal, e);
+        char note[PAL_PATH_MAX + 16];
+        const char *detail = pal_detail(pal, e);
+        snprintf(note, sizeof(note), "%s%s%.1000s", palette_kind_tag(e->kind), detail[0] ? "  " : "", detail);
+        render_text(label, 10, y, (SDL_Color){240, 240, 240, 255});
+        render_text(note, 10 + ((int)strlen(label) + 2) * g_app.char_width, y, (SDL_Color){140, 140, 160, 255});
+    }
+}
+
+/**
+ * One view of the buffer in area, with the caret and scroll of whichever
+ * pane is swapped in: its rows, carets and scrollbar. view is the pane's
+ * view in the highlighter. Only the focused pane looks up the bracket at
+ * its caret, and it places the completion popup (*popup_x stays -1 when
+ * the caret is off screen).
+ */
+static void render_pane(const SDL_Rect *area, int view, bool focused, int64_t total_lines,
+                        int *popup_x, int *popup_y) {
+    SDL_RenderSetClipRect(g_app.renderer, area);
+    const int text_top = area->y + 10;
+    const int text_bottom = area->y + area->h;
+    int visible_lines = (area->h - 10) / g_app.line_height;
+    if (visible_lines < 1) visible_lines = 1;
+    if (focused) g_app.visible_lines = visible_lines;
+    
+    // Line number gutter
+    int digits = 1;
+    for (int64_t n = total_lines; n >= 10; n /= 10) digits++;
+    int text_x = area->x + 10 + (digits + 1) * g_app.char_width;
+    
+    // Only the visible columns are read and lexed. With soft wrap they are
+    // the row width: a change is counted in the background, and rows keep
+    // the old width until then. Split panes are the same width.
+    int visible_cols = (area->x + area->w - text_x - 10) / g_app.char_width;
+    if (visible_cols < 1) visible_cols = 1;
+    lix_set_wrap(&g_app.lines, g_app.wrap && !g_app.view_mode ? (uint32_t)visible_cols : 0);
+    int wrap = wrap_columns();
+    
+    // Rows skip folded lines; a caret that lands in a fold opens it
+    if (!g_app.filter.active) ft_reveal(&g_app.folds, (size_t)g_app.caret.line);
+    int64_t total_rows = get_row_count();
+    int64_t cur_row = caret_row();
+    
+    // Keep the caret on screen, in the middle after a jump
+    if (focused && g_app.center_caret) {
+        g_app.scroll_y = cur_row > visible_lines / 2 ? cur_row - visible_lines / 2 : 0;
+        g_app.center_caret = false;
+    }
+    if (cur_row < g_app.scroll_y) g_app.scroll_y = cur_row;
+    if (cur_row >= g_app.scroll_y + visible_lines) {
+        g_app.scroll_y = cur_row - visible_lines + 1;
+    }
+    
+    // Point the highlight worker at the source lines on screen
+    size_t first = 0, last = 0;
+    if (total_rows > 0) {
+        int64_t last_row = g_app.scroll_y + visible_lines - 1;
+        if (last_row >= total_rows) last_row = total_rows - 1;
+        int64_t first_row = g_app.scroll_y < last_row ? g_app.scroll_y : last_row;
+        first = source_line(first_row);
+        last = source_line(last_row);
+    }
+    update_hidden(view, first, last);
+    hl_frame(&g_app.hl, view, first, last);
+    
+    bool show_bracket = false;
+    if (focused && cur_row < total_rows) {
+        size_t caret_line = g_app.filter.active ? g_app.filter.hits[g_app.caret.line].line
+                                                : (size_t)g_app.caret.line;
+        update_bracket(caret_line, (size_t)g_app.caret.col);
+        update_scope(caret_line);
+        show_bracket = bracket.found == BX_FOUND;
+    }
+    
+    if (wrap > 0) {
+        g_app.scroll_x = 0;
+    } else {
+        if (g_app.caret.col < g_app.scroll_x) g_app.scroll_x = g_app.caret.col;
+        if (g_app.caret.col >= g_app.scroll_x + visible_cols) {
+            g_app.scroll_x = g_app.caret.col - visible_cols + 1;
+        }
+    }
+    
+    int y = text_top;
+    
+    for (int64_t row = g_app.scroll_y; row < total_rows && y + g_app.line_height <= text_bottom; row++) {
+        // A wrapped row shows its own stretch of the line
+        int sub;
+        int64_t line = line_of_row(row, &sub);
+        int col_from = wrap > 0 ? sub * wrap : g_app.scroll_x;
+        int col_to = wrap > 0 ? col_from + wrap : col_from + visible_cols + 1;
+        int64_t line_num;
+        int line_pos;
+        char *line_buf = fetch_row(line, &line_num, col_from, col_to, &line_pos);
+        if (!line_buf) break;
         
-        // Check if this is cursor position
-        if (line_num == g_app.caret.line && line_pos == g_app.caret.col && !cursor_found) {
-            cursor_x = 10 + (line_pos * g_app.char_width);
-            cursor_y = y;
-            cursor_found = true;
+        if (sub == 0) {
+            char num[24];
+            int num_len = snprintf(num, sizeof(num), "%zu", (size_t)line_num + 1);
+            render_text(num, area->x + 10 + (digits - num_len) * g_app.char_width, y,
+                        (SDL_Color){100, 100, 100, 255});
         }
         
-        if (ch == '\n' || line_pos >= 1023 || i == len) {
-            line_buf[line_pos] = '\0';
+        if (show_bracket) {
+            size_t at_cols[2] = { bracket.at, bracket.match_col };
+            size_t at_lines[2] = { bracket.line, bracket.match_line };
+            for (int k = 0; k < 2; k++) {
+                if (at_lines[k] == (size_t)line_num && at_cols[k] >= (size_t)col_from &&
+                    at_cols[k] < (size_t)col_to) {
+                    outline_cell(text_x + ((int)at_cols[k] - col_from) * g_app.char_width, y);
+                }
+            }
+        }
+        
+        if (line_pos > col_from) {
+            // Tokens from the highlight worker; plain text until it gets here
+            SyntaxToken *tokens = NULL;
+            int token_count = 0;
+            const HlLine *hl = hl_get(&g_app.hl, (size_t)line_num);
+            if (hl) {
+                token_count = highlight_spans(hl->spans, hl->count, col_from,
+                                              line_pos < col_to ? line_pos : col_to,
+                                              &g_app.frame, &tokens);
+            }
             
-            if (line_buf[0] != '\0' || i == len) { // Render line if not empty or if it's the end
-                // Advanced syntax highlighting
-                SyntaxToken tokens[64];
-                int token_count = 0;
-                highlight_line(line_buf, line_pos, g_app.lang, tokens, &token_count);
+            // Render each token with its specific color, at its own column
+            for (int t = 0; t < token_count; t++) {
+                SyntaxToken *token = &tokens[t];
+                const char *text = line_buf + (token->start - col_from);
+                int blank = 0;
+                while (blank < token->length && (text[blank] == ' ' || text[blank] == '\t')) blank++;
+                if (blank == token->length) continue;
                 
-                // Render each token with its specific color
-                int render_x = 10;
-                for (int t = 0; t < token_count; t++) {
-                    SyntaxToken *token = &tokens[t];
-                    char token_text[256];
-                    int copy_len = (token->length < 255) ? token->length : 255;
-                    strncpy(token_text, line_buf + token->start, copy_len);
-                    token_text[copy_len] = '\0';
-                    
-                    render_text(token_text, render_x, y, token->color);
-                    render_x += copy_len * g_app.char_width;
-                }
+                char *token_text = fa_new(&g_app.frame, char, token->length + 1);
+                if (!token_text) continue;
+                memcpy(token_text, text, token->length);
+                token_text[token->length] = '\0';
                 
-                // Fallback for unhighlighted content
-                if (token_count == 0) {
-                    SDL_Color default_color = {220, 220, 220, 255};
-                    render_text(line_buf, 10, y, default_color);
-                }
+                render_text(token_text, text_x + (token->start - col_from) * g_app.char_width, y,
+                            token->color);
             }
             
-            y += g_app.line_height;
-            line_pos = 0;
-            line_num++;
-            
-            if (y > 700) break; // Don't render off screen
-        } else {
-            line_buf[line_pos++] = ch;
+            // Fallback for unhighlighted content
+            if (token_count == 0) {
+                SDL_Color default_color = {220, 220, 220, 255};
+                render_text(line_buf, text_x, y, default_color);
+            }
         }
-    }
-    
-    // Draw cursor
-    if (cursor_found || (g_app.caret.line == line_num - 1)) {
-        if (!cursor_found) {
-            // Cursor is at end of last line
-            cursor_x = 10 + (g_app.caret.col * g_app.char_width);
-            cursor_y = y - g_app.line_height;
+        
+        // Folded lines are never read; their header ends in a marker
+        if (!g_app.filter.active && (wrap == 0 || sub + 1 == line_rows(line)) &&
+            ft_is_header(&g_app.folds, (size_t)line_num, NULL)) {
+            int at = line_pos > col_from ? line_pos - col_from + 1 : 0;
+            render_text("...", text_x + at * g_app.char_width, y, (SDL_Color){120, 120, 160, 255});
         }
         
-        SDL_SetRenderDrawColor(g_app.renderer, 255, 255, 255, 255); // White cursor
+        y += g_app.line_height;
+    }
+    
+    if (focused) render_carets(text_x, text_top, visible_lines, wrap, first, last);
+    
+    // Draw cursor, dimmed in the pane without focus
+    int64_t cursor_row = cur_row - g_app.scroll_y;
+    if (cursor_row >= 0 && cursor_row < visible_lines) {
+        int cursor_col = g_app.caret.col - g_app.scroll_x;
+        if (wrap > 0) cursor_col -= (int)(cur_row - row_of_line(g_app.caret.line)) * wrap;
+        int cursor_x = text_x + cursor_col * g_app.char_width;
+        int cursor_y = text_top + (int)cursor_row * g_app.line_height;
+        Uint8 shade = focused ? 255 : 120;
+        SDL_SetRenderDrawColor(g_app.renderer, shade, shade, shade, 255);
         SDL_Rect cursor_rect = {cursor_x, cursor_y, 2, g_app.line_height};
         SDL_RenderFillRect(g_app.renderer, &cursor_rect);
+        if (focused) {
+            *popup_x = cursor_x;
+            *popup_y = cursor_y;
+        }
+    }
+    
+    // Scrollbar; the thumb settles as indexing discovers more lines
+    if (total_rows > visible_lines) {
+        int track_h = area->h - 10;
+        int thumb_h = (int)((long long)track_h * visible_lines / total_rows);
+        if (thumb_h < 8) thumb_h = 8;
+        int thumb_y = text_top + (int)((long long)(track_h - thumb_h) * g_app.scroll_y /
+                                       (total_rows - visible_lines));
+        int track_x = area->x + area->w - 8;
+        SDL_SetRenderDrawColor(g_app.renderer, 40, 40, 40, 255);
+        SDL_Rect track = {track_x, text_top, 6, track_h};
+        SDL_RenderFillRect(g_app.renderer, &track);
+        SDL_SetRenderDrawColor(g_app.renderer, 110, 110, 110, 255);
+        SDL_Rect thumb = {track_x, thumb_y, 6, thumb_h};
+        SDL_RenderFillRect(g_app.renderer, &thumb);
     }
+    SDL_RenderSetClipRect(g_app.renderer, NULL);
+}
+
+void render_editor() {
+    SDL_SetRenderDrawColor(g_app.renderer, 20, 20, 20, 255);
+    SDL_RenderClear(g_app.renderer);
+    
+    int win_w = 1024, win_h = 768;
+    SDL_GetWindowSize(g_app.window, &win_w, &win_h);
+    fa_reset(&g_app.frame);
+    int text_bottom = win_h - 40;
+    sync_rows();
+    
+    // The line index may still be growing in the background
+    int64_t total_lines;
+    int permille;
+    if (g_app.view_mode) {
+        total_lines = (int64_t)fv_line_count(&g_app.view);
+        permille = fv_progress_permille(&g_app.view);
+    } else {
+        lix_lock(&g_app.lines);
+        total_lines = (int64_t)li_line_count(&g_app.lines.index);
+        permille = lix_progress_permille(&g_app.lines);
+        lix_unlock(&g_app.lines);
+    }
+    
+    // The pane without focus is drawn with its own caret and scroll swapped
+    // in, before the focused one: the bracket and scope lookups are left
+    // for the focused pane's caret
+    int popup_x = -1, popup_y = 0;
+    const SplitView *sv = &g_app.split;
+    if (split_layout(win_w, text_bottom) == 2) {
+        const SDL_Rect *other = &sv->panes[1 - sv->focus];
+        split_swap();
+        render_pane(other, 1, false, total_lines, &popup_x, &popup_y);
+        split_swap();
+        SDL_SetRenderDrawColor(g_app.renderer, 60, 60, 60, 255);
+        if (sv->mode == SPLIT_SIDE) {
+            SDL_RenderDrawLine(g_app.renderer, sv->panes[1].x, 0, sv->panes[1].x, text_bottom);
+        } else {
+            SDL_RenderDrawLine(g_app.renderer, 0, sv->panes[1].y, win_w, sv->panes[1].y);
+        }
+    } else {
+        update_hidden(1, HL_NO_VIEW, HL_NO_VIEW);
+        hl_frame(&g_app.hl, 1, HL_NO_VIEW, HL_NO_VIEW);
+    }
+    render_pane(&sv->panes[sv->focus], 0, true, total_lines, &popup_x, &popup_y);
+    int64_t total_rows = get_row_count();
+    int wrap = wrap_columns();
     
     // Status bar
     char status[512];
+    char lines_info[64];
     const char *display_name = g_app.file_name[0] ? g_app.file_name : "untitled";
-    snprintf(status, sizeof(status), "%.200s%s | Ln %d, Col %d | SDL2", 
+    if (g_app.filter.active) {
+        snprintf(lines_info, sizeof(lines_info), "filter: %zu of %zu lines",
+                 (size_t)total_rows, (size_t)total_lines);
+    } else if (permille < 1000) {
+        snprintf(lines_info, sizeof(lines_info), "%zu lines (indexing %d%%)",
+                 (size_t)total_lines, permille / 10);
+    } else {
+        snprintf(lines_info, sizeof(lines_info), "%zu lines", (size_t)total_lines);
+    }
+    snprintf(status, sizeof(status), "%.200s%s | Ln %zu, Col %d%s%s | %s%s%s | SDL2", 
              display_name,
+             g_app.view_mode ? " [view]" : g_app.follow.active ? " [follow]" :
              g_app.buf.dirty ? "*" : "",
-             g_app.caret.line + 1, 
-             g_app.caret.col + 1);
-    render_text(status, 10, 740, (SDL_Color){180, 180, 180, 255});
+             (size_t)g_app.caret.line + 1, 
+             g_app.caret.col + 1,
+             scope.path[0] ? " | " : "", scope.path,
+             lines_info,
+             wrap > 0 ? " | wrap" : "",
+             g_app.macro.recording ? " | recording" : "");
+    render_text(status, 10, win_h - 28, (SDL_Color){180, 180, 180, 255});
+    
+    if (g_app.complete.visible && popup_x >= 0) render_completion(popup_x, popup_y, text_bottom, win_w);
     
     // Overlay for find/command palette
     if (g_app.show_overlay) {
@@ -113,9 +587,21 @@ void render_editor() {
         
         // Draw overlay text
         render_text(g_app.overlay_text, 10, 5, (SDL_Color){255, 255, 255, 255});
+        if (g_app.finder.active) render_finder(win_w);
+        if (g_app.palette.active) render_palette(win_w);
         
-        // Draw cursor if in find mode
-        if (g_app.find_active) {
+        // Draw cursor if in find or go-to mode
+        if (g_app.filter.prompt) {
+            int cursor_x = 10 + (8 + (int)strlen(g_app.filter.query)) * g_app.char_width;
+            SDL_SetRenderDrawColor(g_app.renderer, 255, 255, 255, 255);
+            SDL_Rect cursor_rect = {cursor_x, 5, 2, g_app.line_height};
+            SDL_RenderFillRect(g_app.renderer, &cursor_rect);
+        } else if (g_app.goto_active) {
+            int cursor_x = 10 + (int)strlen(g_app.overlay_text) * g_app.char_width;
+            SDL_SetRenderDrawColor(g_app.renderer, 255, 255, 255, 255);
+            SDL_Rect cursor_rect = {cursor_x, 5, 2, g_app.line_height};
+            SDL_RenderFillRect(g_app.renderer, &cursor_rect);
+        } else if (g_app.find_active) {
             int cursor_x = 10 + (6 * g_app.char_width) + (g_app.find_cursor * g_app.char_width);
             SDL_SetRenderDrawColor(g_app.renderer, 255, 255, 255, 255);
             SDL_Rect cursor_rect = {cursor_x, 5, 2, g_app.line_height};
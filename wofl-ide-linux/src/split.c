@@ -0,0 +1,110 @@
+#include "split.h"
+#include "cursor.h"
+#include "carets.h"
+#include "complete.h"
+
+// Start of a line, in the buffer or the mapped file
+static size_t line_start(int64_t line) {
+    Caret saved = g_app.caret;
+    g_app.caret.line = line;
+    g_app.caret.col = 0;
+    size_t index = get_cursor_index();
+    g_app.caret = saved;
+    return index;
+}
+
+static int64_t line_at(size_t index) {
+    Caret saved = g_app.caret;
+    move_cursor_to_index(index);
+    int64_t line = g_app.caret.line;
+    g_app.caret = saved;
+    return line;
+}
+
+// The first line shown is kept rather than the row: wrapping and folds
+// count rows afresh by the time the pane is drawn again
+void split_swap(void) {
+    SplitView *sv = &g_app.split;
+    if (sv->mode == SPLIT_NONE) return;
+    const size_t caret = get_cursor_index();
+    const size_t top = line_start(line_of_row(g_app.scroll_y, NULL));
+    const int scroll_x = g_app.scroll_x;
+
+    move_cursor_to_index(an_pos(&g_app.anchors, sv->caret));
+    g_app.scroll_y = row_of_line(line_at(an_pos(&g_app.anchors, sv->top)));
+    g_app.scroll_x = sv->scroll_x;
+
+    an_set(&g_app.anchors, sv->caret, caret);
+    an_set(&g_app.anchors, sv->top, top);
+    sv->scroll_x = scroll_x;
+}
+
+void split_close(void) {
+    SplitView *sv = &g_app.split;
+    an_remove_owner(&g_app.anchors, ANCHOR_SPLIT);
+    sv->mode = SPLIT_NONE;
+    sv->focus = 0;
+    sv->caret = sv->top = AN_NONE;
+}
+
+// Split the pane, the new one showing the same place, or change how the
+// two lie; the same mode again closes the split
+void split_toggle(SplitMode mode) {
+    SplitView *sv = &g_app.split;
+    if (sv->mode == mode) {
+        split_close();
+        return;
+    }
+    if (g_app.filter.active || g_app.filter.prompt) {
+        strcpy(g_app.overlay_text, "Split: not available in the filter view");
+        g_app.show_overlay = true;
+        return;
+    }
+    if (sv->mode == SPLIT_NONE) {
+        sv->caret = an_add(&g_app.anchors, get_cursor_index(), AN_RIGHT, ANCHOR_SPLIT);
+        sv->top = an_add(&g_app.anchors, line_start(line_of_row(g_app.scroll_y, NULL)), AN_RIGHT, ANCHOR_SPLIT);
+        sv->scroll_x = g_app.scroll_x;
+        sv->focus = 0;
+        if (sv->caret == AN_NONE || sv->top == AN_NONE) {
+            split_close();
+            return;
+        }
+    }
+    sv->mode = mode;
+}
+
+// Extra carets and the popup belong to the pane they were made in
+void split_focus(int pane) {
+    SplitView *sv = &g_app.split;
+    if (sv->mode == SPLIT_NONE || pane == sv->focus || pane < 0 || pane > 1) return;
+    carets_clear();
+    complete_close();
+    split_swap();
+    sv->focus = pane;
+}
+
+int split_layout(int win_w, int text_bottom) {
+    SDL_Rect *p = g_app.split.panes;
+    p[0] = (SDL_Rect){0, 0, win_w, text_bottom};
+    switch (g_app.split.mode) {
+        case SPLIT_NONE:
+            return 1;
+        case SPLIT_SIDE:
+            // Equal widths, so both wrap at the same column
+            p[0].w = win_w / 2;
+            p[1] = (SDL_Rect){p[0].w, 0, p[0].w, text_bottom};
+            break;
+        case SPLIT_STACKED:
+            p[0].h = text_bottom / 2;
+            p[1] = (SDL_Rect){0, p[0].h, win_w, text_bottom - p[0].h};
+            break;
+    }
+    return 2;
+}
+
+int split_pane_at(int x, int y) {
+    const SplitView *sv = &g_app.split;
+    if (sv->mode == SPLIT_NONE) return 0;
+    const SDL_Rect *p = &sv->panes[1];
+    return x >= p->x && y >= p->y ? 1 : 0;
+}
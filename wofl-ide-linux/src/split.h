@@ -0,0 +1,20 @@
+#ifndef SPLIT_H
+#define SPLIT_H
+
+#include "app.h"
+
+// Two views of the buffer, side by side or one above the other. Each has
+// its own caret and scroll; the text, its line index, folds and tokens are
+// shared, so an edit in one is made once and both show it. Not while the
+// filter view is up.
+void split_toggle(SplitMode mode);
+void split_close(void);
+void split_focus(int pane);
+// Lay the panes out over the text area; returns how many there are
+int split_layout(int win_w, int text_bottom);
+// Pane under window point x, y
+int split_pane_at(int x, int y);
+// Trade the focused pane's caret and scroll for the other's
+void split_swap(void);
+
+#endif
@@ -0,0 +1,149 @@
+#define _DEFAULT_SOURCE
+#include "symbols.h"
+#include "file_ops.h"
+#include "cursor.h"
+#include <limits.h>
+#include <stdlib.h>
+
+static const char *const kind_names[] = { "function", "class", "struct", "namespace" };
+
+// The workspace is the directory the editor was started in
+void symbols_index_start(void) {
+    char root[SI_PATH_MAX];
+    if (getcwd(root, sizeof(root))) six_start(&g_app.symbols, root);
+}
+
+static void show(void) {
+    SymbolPrompt *p = &g_app.symbol;
+    if (p->count == 0) {
+        bool running;
+        uint32_t files;
+        six_status(&g_app.symbols, &running, &files, NULL);
+        char note[64] = "";
+        if (running) snprintf(note, sizeof(note), "   (indexing: %u files)", files);
+        else if (p->query[0]) snprintf(note, sizeof(note), "   (no match)");
+        snprintf(g_app.overlay_text, sizeof(g_app.overlay_text), "Go to symbol: %s%s", p->query, note);
+        return;
+    }
+    const SymbolHit *h = &p->hits[p->selected];
+    snprintf(g_app.overlay_text, sizeof(g_app.overlay_text), "Go to symbol: %s   [%d/%d] %s%s%s (%s)  %.240s:%zu",
+             p->query, p->selected + 1, p->count, h->parent, h->parent[0] ? " > " : "", h->name,
+             kind_names[h->kind], h->path, h->line + 1);
+}
+
+static void query(void) {
+    SymbolPrompt *p = &g_app.symbol;
+    p->version = six_status(&g_app.symbols, NULL, NULL, NULL);
+    p->count = p->query[0] ? six_query(&g_app.symbols, p->query, p->hits, SYMBOL_HITS) : 0;
+    p->selected = 0;
+    show();
+}
+
+void symbols_start(void) {
+    g_app.symbol.active = true;
+    g_app.symbol.query[0] = '\0';
+    g_app.symbol.pending = 0;
+    query();
+    g_app.show_overlay = true;
+}
+
+void symbols_input(const char *text) {
+    SymbolPrompt *p = &g_app.symbol;
+    size_t len = strlen(p->query);
+    for (; text && *text && len < sizeof(p->query) - 1; text++) {
+        if (*text != ' ') p->query[len++] = *text;
+    }
+    p->query[len] = '\0';
+    query();
+}
+
+static bool same_file(const char *a, const char *b) {
+    char ra[PATH_MAX], rb[PATH_MAX];
+    if (realpath(a, ra) && realpath(b, rb)) return strcmp(ra, rb) == 0;
+    return strcmp(a, b) == 0;
+}
+
+// Lines past what the line index has counted so far wait for it
+static void go_to(int64_t line) {
+    lix_lock(&g_app.lines);
+    const bool counted = lix_done(&g_app.lines) || (size_t)line < li_line_count(&g_app.lines.index);
+    lix_unlock(&g_app.lines);
+    if (!counted) {
+        g_app.symbol.pending = line + 1;
+        return;
+    }
+    g_app.symbol.pending = 0;
+    goto_line(line);
+}
+
+/**
+ * Open the file at path, relative to the workspace, unless it is the one
+ * loaded already, and go to line. False, with the reason shown, if the file
+ * could not be opened.
+ */
+bool symbols_open(const char *path, size_t line) {
+    char full[SI_PATH_MAX * 2];
+    snprintf(full, sizeof(full), "%s/%s", g_app.symbols.root, path);
+
+    if (!g_app.file_path[0] || !same_file(full, g_app.file_path)) {
+        if (g_app.buf.dirty && !g_app.view_mode) {
+            snprintf(g_app.overlay_text, sizeof(g_app.overlay_text), "Go to symbol: save %.400s first", g_app.file_name);
+            return false;
+        }
+        if (!load_file(full)) {
+            snprintf(g_app.overlay_text, sizeof(g_app.overlay_text), "Go to symbol: cannot open %.400s", path);
+            return false;
+        }
+        g_app.caret.line = 0;
+        g_app.caret.col = 0;
+    }
+    g_app.show_overlay = false;
+    go_to((int64_t)line);
+    return true;
+}
+
+static void jump(void) {
+    SymbolPrompt *p = &g_app.symbol;
+    const SymbolHit *h = &p->hits[p->selected];
+    if (symbols_open(h->path, h->line)) p->active = false;
+}
+
+void symbols_key(SDL_Keycode key) {
+    SymbolPrompt *p = &g_app.symbol;
+    size_t len = strlen(p->query);
+    switch (key) {
+        case SDLK_ESCAPE:
+            p->active = false;
+            g_app.show_overlay = false;
+            break;
+        case SDLK_RETURN:
+            if (p->count) jump();
+            break;
+        case SDLK_BACKSPACE:
+            if (len > 0) p->query[len - 1] = '\0';
+            query();
+            break;
+        case SDLK_UP:
+            if (p->count) p->selected = (p->selected + p->count - 1) % p->count;
+            show();
+            break;
+        case SDLK_DOWN:
+        case SDLK_TAB:
+            if (p->count) p->selected = (p->selected + 1) % p->count;
+            show();
+            break;
+    }
+}
+
+// Once per frame: finish a jump waiting for lines, and pick up a new index
+void symbols_poll(void) {
+    SymbolPrompt *p = &g_app.symbol;
+    if (p->pending) go_to(p->pending - 1);
+    if (!p->active) return;
+    if (six_status(&g_app.symbols, NULL, NULL, NULL) != p->version) {
+        const int selected = p->selected;
+        query();
+        if (selected < p->count) p->selected = selected;
+    }
+    show();
+}
@@ -0,0 +1,16 @@
+#ifndef SYMBOLS_H
+#define SYMBOLS_H
+
+#include "app.h"
+
+// Go to symbol: a prompt over the workspace symbol index (symbol_index.h)
+void symbols_index_start(void);
+void symbols_start(void);
+void symbols_input(const char *text);
+void symbols_key(SDL_Keycode key);
+void symbols_poll(void);
+
+// Open a file of the workspace at a line, as picking a symbol does
+bool symbols_open(const char *path, size_t line);
+
+#endif
@@ -1,27 +1,19 @@
-// Create new file: syntax.h
 #ifndef SYNTAX_H
 #define SYNTAX_H
 
 #include "app.h"
 
-typedef enum {
-    TOKEN_NONE = 0,
-    TOKEN_KEYWORD,
-    TOKEN_STRING,
-    TOKEN_COMMENT,  
-    TOKEN_NUMBER,
-    TOKEN_OPERATOR,
-    TOKEN_IDENTIFIER,
-    TOKEN_PUNCTUATION
-} TokenType;
-
 typedef struct {
-    TokenType type;
+    TokenClass cls;
     int start;
     int length;
     SDL_Color color;
 } SyntaxToken;
 
-void highlight_line(const char *line, int line_len, Language lang, SyntaxToken *tokens, int *token_count);
+// Color the cached spans of one line (from the highlight worker) that
+// overlap columns [from, to). Tokens are clipped to the window and live in
+// the frame arena; returns their count.
+int highlight_spans(const TokenSpan *spans, int n, int from, int to,
+                    FrameArena *fa, SyntaxToken **tokens);
 
-#endif
\ No newline at end of file
+#endif
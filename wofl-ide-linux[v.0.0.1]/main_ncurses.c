@@ -12,6 +12,9 @@
 #include <signal.h>
 #include <pthread.h>
 #include <locale.h>
+#include "line_index.h"
+#include "anchors.h"
+#include "goto_target.h"
 
 // ===== Constants =====
 #define WOFL_MAX_PATH     1024
@@ -55,6 +58,21 @@ typedef struct {
     TokenClass cls;
 } TokenSpan;
 
+typedef enum {
+    SPLIT_NONE = 0, SPLIT_STACKED, SPLIT_SIDE
+} SplitMode;
+
+// Split view: two panes on the one buffer and line index. caret, top_line
+// and left_col in AppState belong to the pane with focus; the other's are
+// kept here, as anchors so edits in the focused pane move them.
+typedef struct {
+    SplitMode mode;
+    int focus;          // 0: the top or left pane, 1: the other
+    AnchorId caret;
+    AnchorId top;       // start of its first line shown
+    int left_col;
+} SplitView;
+
 typedef struct {
     bool visible;
     GapBuffer buf;
@@ -92,8 +110,14 @@ typedef struct {
     int screen_cols;
     int total_lines_cache;
     bool need_recount;
+    LineIndexer lines;
+    AnchorSet anchors;  // positions that follow every edit
+    SplitView split;
 } AppState;
 
+// Owners of anchors in g_app.anchors
+enum { ANCHOR_SPLIT = 1 };
+
 // Global state
 static AppState g_app;
 static volatile bool g_running = true;
@@ -111,10 +135,13 @@ static size_t gb_length(const GapBuffer *gb);
 static void gb_insert(GapBuffer *gb, const char *text, size_t len);
 static void gb_delete_range(GapBuffer *gb, size_t pos, size_t len);
 static char gb_char_at(const GapBuffer *gb, size_t pos);
+static void index_start(void);
+static size_t caret_index(void);
 static bool load_file(const char *path);
 static bool save_file(void);
 static void render_screen(void);
 static void render_editor(void);
+static void render_view(int y0, int x0, int rows, int cols, bool focused);
 static void render_status(void);
 static void render_overlay(void);
 static void render_output_pane(void);
@@ -125,7 +152,13 @@ static void delete_char(void);
 static void run_current_file(void);
 static void open_find_dialog(void);
 static void open_palette(void);
+static void open_goto_dialog(void);
+static void goto_confirm(void);
 static void* output_reader_thread(void* arg);
+static void pane_rect(int pane, int *y, int *x, int *rows, int *cols);
+static void split_swap(void);
+static void split_toggle(SplitMode mode);
+static void split_focus_other(void);
 
 // ===== Gap Buffer Implementation =====
 static void gb_init(GapBuffer *gb) {
@@ -152,6 +185,7 @@ static void gb_ensure(GapBuffer *gb, size_t need) {
     if (gap >= need) return;
     
     size_t new_cap = gb->capacity * 2;
+    while (new_cap - gb_length(gb) < need) new_cap *= 2;
     char *new_data = malloc(new_cap);
     
     // Copy pre-gap data
@@ -183,6 +217,93 @@ static char gb_char_at(const GapBuffer *gb, size_t pos) {
     }
 }
 
+static void gb_move_gap(GapBuffer *gb, size_t pos) {
+    size_t len = gb_length(gb);
+    if (pos > len) pos = len;
+    if (pos < gb->gap_start) {
+        size_t n = gb->gap_start - pos;
+        memmove(gb->data + gb->gap_end - n, gb->data + pos, n);
+        gb->gap_start -= n;
+        gb->gap_end -= n;
+    } else if (pos > gb->gap_start) {
+        size_t n = pos - gb->gap_start;
+        memmove(gb->data + gb->gap_start, gb->data + gb->gap_end, n);
+        gb->gap_start += n;
+        gb->gap_end += n;
+    }
+}
+
+static void gb_delete_range(GapBuffer *gb, size_t pos, size_t len) {
+    size_t total = gb_length(gb);
+    if (pos >= total || len == 0) return;
+    if (pos + len > total) len = total - pos;
+    gb_move_gap(gb, pos);
+    gb->gap_end += len;
+    gb->dirty = true;
+}
+
+// Contiguous run starting at pos, up to the gap or the end
+static const char *gb_segment(const GapBuffer *gb, size_t pos, size_t *avail) {
+    size_t len = gb_length(gb);
+    if (pos >= len) { *avail = 0; return NULL; }
+    if (pos < gb->gap_start) {
+        *avail = gb->gap_start - pos;
+        return gb->data + pos;
+    }
+    size_t off = pos + (gb->gap_end - gb->gap_start);
+    *avail = gb->capacity - off;
+    return gb->data + off;
+}
+
+// ===== Line Index =====
+// Built by a worker thread; edits to g_app.buf happen under its lock.
+static const void *buf_segment(void *ctx, size_t pos, size_t *avail) {
+    return gb_segment((const GapBuffer *)ctx, pos, avail);
+}
+
+static size_t buf_length(void *ctx) {
+    return gb_length((const GapBuffer *)ctx);
+}
+
+static void index_start(void) {
+    LineSource src = { buf_segment, buf_length, &g_app.buf, 1 };
+    lix_start(&g_app.lines, src);
+    an_reset(&g_app.anchors, gb_length(&g_app.buf));
+    g_app.need_recount = true;
+}
+
+static void index_refresh(void) {
+    lix_lock(&g_app.lines);
+    g_app.total_lines_cache = (int)li_line_count(&g_app.lines.index);
+    g_app.need_recount = !lix_done(&g_app.lines);
+    lix_unlock(&g_app.lines);
+}
+
+static void buf_insert_at(size_t pos, const char *text, size_t n) {
+    lix_lock(&g_app.lines);
+    gb_move_gap(&g_app.buf, pos);
+    gb_insert(&g_app.buf, text, n);
+    lix_note_insert(&g_app.lines, pos, text, n);
+    lix_unlock(&g_app.lines);
+    an_note_insert(&g_app.anchors, pos, n);
+}
+
+static void buf_delete_at(size_t pos, size_t n) {
+    lix_lock(&g_app.lines);
+    gb_delete_range(&g_app.buf, pos, n);
+    lix_note_delete(&g_app.lines, pos, n);
+    lix_unlock(&g_app.lines);
+    an_note_delete(&g_app.anchors, pos, n);
+}
+
+static size_t caret_index(void) {
+    lix_lock(&g_app.lines);
+    size_t start = li_line_start(&g_app.lines.index, (size_t)g_app.caret.line);
+    size_t len = li_line_length(&g_app.lines.index, (size_t)g_app.caret.line);
+    lix_unlock(&g_app.lines);
+    return start + ((size_t)g_app.caret.col < len ? (size_t)g_app.caret.col : len);
+}
+
 // ===== Language Detection =====
 static Language detect_language(const char *path) {
     const char *ext = strrchr(path, '.');
@@ -299,16 +420,19 @@ static bool load_file(const char *path) {
     long size = ftell(f);
     fseek(f, 0, SEEK_SET);
     
+    lix_stop(&g_app.lines);
     gb_free(&g_app.buf);
     gb_init(&g_app.buf);
     
-    char buffer[4096];
-    size_t read;
-    while ((read = fread(buffer, 1, sizeof(buffer), f)) > 0) {
-        gb_insert(&g_app.buf, buffer, read);
+    // Read straight into the buffer; lines are indexed in the background
+    if (size > 0) {
+        gb_ensure(&g_app.buf, (size_t)size);
+        size_t got = fread(g_app.buf.data, 1, (size_t)size, f);
+        g_app.buf.gap_start = got;
     }
     
     fclose(f);
+    index_start();
     
     strncpy(g_app.file_path, path, WOFL_MAX_PATH - 1);
     const char *filename = strrchr(path, '/');
@@ -387,79 +511,120 @@ static void render_screen(void) {
 }
 
 static void render_editor(void) {
-    size_t len = gb_length(&g_app.buf);
-    int editor_height = g_app.screen_rows - 1 - g_app.out.height;
+    // Line count comes from the index, which may still be growing
+    index_refresh();
     
-    // Count lines for proper scrolling
-    int total_lines = 1;
-    for (size_t i = 0; i < len; i++) {
-        if (gb_char_at(&g_app.buf, i) == '\n') total_lines++;
+    int y, x, rows, cols;
+    if (g_app.split.mode != SPLIT_NONE) {
+        // The pane without focus is drawn with its caret and scroll swapped in
+        pane_rect(1 - g_app.split.focus, &y, &x, &rows, &cols);
+        split_swap();
+        render_view(y, x, rows, cols, false);
+        split_swap();
+        pane_rect(1, &y, &x, &rows, &cols);
+        if (g_app.split.mode == SPLIT_STACKED) mvhline(y - 1, 0, ACS_HLINE, g_app.screen_cols);
+        else mvvline(0, x - 1, ACS_VLINE, rows);
     }
+    pane_rect(g_app.split.focus, &y, &x, &rows, &cols);
+    render_view(y, x, rows, cols, true);
+}
+
+// One view of the buffer at row y0, column x0, with the caret and scroll
+// in g_app; the caret is dimmed in a pane without focus
+static void render_view(int y0, int x0, int rows, int cols, bool focused) {
+    size_t len = gb_length(&g_app.buf);
+    int total_lines = g_app.total_lines_cache;
     
-    // Build lines for display
-    char line_buf[WOFL_LINE_BUF_MAX];
-    int line_num = 0;
-    int line_pos = 0;
-    int y = 0;
+    // Gutter wide enough for the largest line number seen so far
+    int gutter = 2;
+    for (int n = total_lines; n >= 10; n /= 10) gutter++;
+    int text_cols = cols - gutter - 2;  // last column is the scrollbar
     
-    for (size_t i = 0; i < len && y < editor_height; i++) {
-        char ch = gb_char_at(&g_app.buf, i);
+    char line_buf[WOFL_LINE_BUF_MAX];
+    for (int y = 0; y < rows; y++) {
+        int line_num = g_app.top_line + y;
+        if (line_num >= total_lines) break;
         
-        if (ch == '\n' || line_pos >= WOFL_LINE_BUF_MAX - 1) {
-            line_buf[line_pos] = '\0';
+        lix_lock(&g_app.lines);
+        size_t pos = li_line_start(&g_app.lines.index, (size_t)line_num);
+        lix_unlock(&g_app.lines);
+        
+        int line_pos = 0;
+        while (pos < len && line_pos < WOFL_LINE_BUF_MAX - 1) {
+            char ch = gb_char_at(&g_app.buf, pos++);
+            if (ch == '\n') break;
+            line_buf[line_pos++] = ch;
+        }
+        line_buf[line_pos] = '\0';
+        
+        mvprintw(y0 + y, x0, "%*d ", gutter - 1, line_num + 1);
+        
+        // Syntax highlight the line
+        TokenSpan tokens[64];
+        int token_count;
+        syntax_highlight_line(line_buf, line_pos, g_app.lang, tokens, &token_count);
+        
+        int x = 0;
+        for (int t = 0; t < token_count; t++) {
+            int color = 0;
+            switch (tokens[t].cls) {
+                case TK_KW: color = COLOR_PAIR(1); break;
+                case TK_STR: color = COLOR_PAIR(2); break;
+                case TK_NUM: color = COLOR_PAIR(3); break;
+                case TK_COMMENT: color = COLOR_PAIR(4); break;
+                default: color = 0; break;
+            }
             
-            if (line_num >= g_app.top_line && y < editor_height) {
-                // Syntax highlight the line
-                TokenSpan tokens[64];
-                int token_count;
-                syntax_highlight_line(line_buf, line_pos, g_app.lang, tokens, &token_count);
-                
-                int x = 0;
-                for (int t = 0; t < token_count; t++) {
-                    int color = 0;
-                    switch (tokens[t].cls) {
-                        case TK_KW: color = COLOR_PAIR(1); break;
-                        case TK_STR: color = COLOR_PAIR(2); break;
-                        case TK_NUM: color = COLOR_PAIR(3); break;
-                        case TK_COMMENT: color = COLOR_PAIR(4); break;
-                        default: color = 0; break;
-                    }
-                    
-                    attron(color);
-                    for (size_t j = 0; j < tokens[t].len; j++) {
-                        if (x >= g_app.left_col && x - g_app.left_col < g_app.screen_cols) {
-                            mvaddch(y, x - g_app.left_col, line_buf[tokens[t].start + j]);
-                        }
-                        x++;
-                    }
-                    attroff(color);
+            attron(color);
+            for (size_t j = 0; j < tokens[t].len; j++) {
+                if (x >= g_app.left_col && x - g_app.left_col < text_cols) {
+                    mvaddch(y0 + y, x0 + gutter + x - g_app.left_col, line_buf[tokens[t].start + j]);
                 }
-                y++;
+                x++;
             }
-            
-            line_num++;
-            line_pos = 0;
-        } else {
-            line_buf[line_pos++] = ch;
+            attroff(color);
+        }
+    }
+    
+    // Scrollbar: thumb position refines as more of the file is indexed
+    if (total_lines > rows && rows > 0) {
+        int thumb_h = rows * rows / total_lines;
+        if (thumb_h < 1) thumb_h = 1;
+        int thumb_y = (int)((long long)(rows - thumb_h) * g_app.top_line /
+                            (total_lines - rows));
+        for (int y = 0; y < rows; y++) {
+            bool on = y >= thumb_y && y < thumb_y + thumb_h;
+            mvaddch(y0 + y, x0 + cols - 1, on ? (' ' | A_REVERSE) : ACS_VLINE);
         }
     }
     
     // Draw cursor
     int cursor_y = g_app.caret.line - g_app.top_line;
     int cursor_x = g_app.caret.col - g_app.left_col;
-    if (cursor_y >= 0 && cursor_y < editor_height && 
-        cursor_x >= 0 && cursor_x < g_app.screen_cols) {
-        mvaddch(cursor_y, cursor_x, ' ' | A_REVERSE);
+    if (cursor_y >= 0 && cursor_y < rows && 
+        cursor_x >= 0 && cursor_x < text_cols) {
+        mvaddch(y0 + cursor_y, x0 + gutter + cursor_x, ' ' | A_REVERSE | (focused ? 0 : A_DIM));
     }
 }
 
 static void render_status(void) {
     int status_y = g_app.screen_rows - 1 - g_app.out.height;
     char status[1024];
-    snprintf(status, sizeof(status), "%s%s | Ln %d, Col %d | %s",
+    char lines_info[64];
+    lix_lock(&g_app.lines);
+    int permille = lix_progress_permille(&g_app.lines);
+    lix_unlock(&g_app.lines);
+    if (permille < 1000) {
+        snprintf(lines_info, sizeof(lines_info), "%d lines (indexing %d%%)",
+                 g_app.total_lines_cache, permille / 10);
+    } else {
+        snprintf(lines_info, sizeof(lines_info), "%d lines", g_app.total_lines_cache);
+    }
+    snprintf(status, sizeof(status), "%s%s | Ln %d, Col %d | %s | %s",
              g_app.file_name[0] ? g_app.file_name : "(untitled)",
              g_app.buf.dirty ? "*" : "",
              g_app.caret.line + 1, g_app.caret.col + 1,
+             lines_info,
              g_app.out.visible ? "OUT:ON" : "OUT:OFF");
     
     attron(COLOR_PAIR(5) | A_REVERSE);
@@ -594,6 +759,7 @@ static void handle_key(int ch) {
             case '\r':
             case KEY_ENTER:
                 // Process overlay command
+                if (g_app.mode == MODE_GOTO) goto_confirm();
                 g_app.overlay_active = false;
                 g_app.mode = MODE_EDIT;
                 break;
@@ -612,6 +778,7 @@ static void handle_key(int ch) {
                 }
                 break;
             default:
+                if (g_app.mode == MODE_GOTO && !goto_char_ok(ch)) break;
                 if (ch >= 32 && ch < 127 && g_app.overlay_len < WOFL_CMD_MAX - 1) {
                     memmove(g_app.overlay_text + g_app.overlay_cursor + 1,
                            g_app.overlay_text + g_app.overlay_cursor,
@@ -638,6 +805,16 @@ static void handle_key(int ch) {
             g_app.out.visible = !g_app.out.visible; 
             update_screen_size();
             break;
+        case KEY_F(7):  split_toggle(SPLIT_STACKED); break;
+        case KEY_F(8):  split_toggle(SPLIT_SIDE); break;
+        
+        case 23: // Ctrl+W
+            split_focus_other();
+            break;
+        
+        case 7: // Ctrl+G
+            open_goto_dialog();
+            break;
         
         case 16: // Ctrl+P
             open_palette();
@@ -678,33 +855,45 @@ static void move_cursor(int dy, int dx) {
     g_app.caret.col += dx;
     
     if (g_app.caret.line < 0) g_app.caret.line = 0;
+    if (g_app.caret.line >= g_app.total_lines_cache) g_app.caret.line = g_app.total_lines_cache - 1;
     if (g_app.caret.col < 0) g_app.caret.col = 0;
     
-    // Adjust scrolling
+    // Adjust scrolling within the focused pane
+    int y, x, rows, cols;
+    pane_rect(g_app.split.focus, &y, &x, &rows, &cols);
     if (g_app.caret.line < g_app.top_line) {
         g_app.top_line = g_app.caret.line;
     }
-    if (g_app.caret.line >= g_app.top_line + g_app.screen_rows - 2 - g_app.out.height) {
-        g_app.top_line = g_app.caret.line - g_app.screen_rows + 3 + g_app.out.height;
+    if (g_app.caret.line >= g_app.top_line + rows - 1) {
+        g_app.top_line = g_app.caret.line - rows + 2;
     }
 }
 
+static void caret_at(size_t pos) {
+    lix_lock(&g_app.lines);
+    size_t line = li_line_of(&g_app.lines.index, pos);
+    g_app.caret.line = (int)line;
+    g_app.caret.col = (int)(pos - li_line_start(&g_app.lines.index, line));
+    g_app.total_lines_cache = (int)li_line_count(&g_app.lines.index);
+    lix_unlock(&g_app.lines);
+}
+
+static void set_caret_index(size_t pos) {
+    caret_at(pos);
+    move_cursor(0, 0);
+}
+
 static void insert_char(char ch) {
-    // Simple insertion at cursor (simplified)
-    gb_insert(&g_app.buf, &ch, 1);
-    if (ch == '\n') {
-        g_app.caret.line++;
-        g_app.caret.col = 0;
-    } else {
-        g_app.caret.col++;
-    }
+    size_t pos = caret_index();
+    buf_insert_at(pos, &ch, 1);
+    set_caret_index(pos + 1);
 }
 
 static void delete_char(void) {
-    // Simple deletion (simplified)
-    if (g_app.caret.col > 0) {
-        g_app.caret.col--;
-        // Would need proper gap buffer deletion here
+    size_t pos = caret_index();
+    if (pos > 0) {
+        buf_delete_at(pos - 1, 1);
+        set_caret_index(pos - 1);
     }
 }
 
@@ -726,6 +915,110 @@ static void open_palette(void) {
     g_app.overlay_cursor = 0;
 }
 
+static void open_goto_dialog(void) {
+    g_app.mode = MODE_GOTO;
+    g_app.overlay_active = true;
+    strcpy(g_app.overlay_prompt, "Go to line[:col], n% or @offset:");
+    g_app.overlay_text[0] = '\0';
+    g_app.overlay_len = 0;
+    g_app.overlay_cursor = 0;
+}
+
+// To the prompt's target, looked up in the line index (goto_target.h),
+// with the line in the middle of the pane
+static void goto_confirm(void) {
+    GotoTarget target;
+    if (!goto_parse(g_app.overlay_text, &target)) return;
+    size_t line, col = (size_t)g_app.caret.col;
+    lix_lock(&g_app.lines);
+    goto_resolve(&target, &g_app.lines.index, &line, &col);
+    g_app.total_lines_cache = (int)li_line_count(&g_app.lines.index);
+    lix_unlock(&g_app.lines);
+    g_app.caret.line = (int)line;
+    g_app.caret.col = (int)col;
+    
+    int y, x, rows, cols;
+    pane_rect(g_app.split.focus, &y, &x, &rows, &cols);
+    g_app.top_line = g_app.caret.line > rows / 2 ? g_app.caret.line - rows / 2 : 0;
+    move_cursor(0, 0);
+}
+
+// ===== Split View =====
+
+// Where pane 0 (top or left) or 1 is on screen; unsplit, pane 0 is the
+// whole editor. A row or column between split panes separates them.
+static void pane_rect(int pane, int *y, int *x, int *rows, int *cols) {
+    const int h = g_app.screen_rows - 1 - g_app.out.height;
+    const int w = g_app.screen_cols;
+    *y = 0;
+    *x = 0;
+    *rows = h;
+    *cols = w;
+    if (g_app.split.mode == SPLIT_STACKED) {
+        *rows = (h - 1) / 2;
+        if (pane == 1) {
+            *y = *rows + 1;
+            *rows = h - *rows - 1;
+        }
+    } else if (g_app.split.mode == SPLIT_SIDE) {
+        *cols = (w - 1) / 2;
+        if (pane == 1) {
+            *x = *cols + 1;
+            *cols = w - *cols - 1;
+        }
+    }
+}
+
+// Trade the focused pane's caret and scroll for the other's
+static void split_swap(void) {
+    SplitView *sv = &g_app.split;
+    const size_t caret = caret_index();
+    lix_lock(&g_app.lines);
+    const size_t top = li_line_start(&g_app.lines.index, (size_t)g_app.top_line);
+    g_app.top_line = (int)li_line_of(&g_app.lines.index, an_pos(&g_app.anchors, sv->top));
+    lix_unlock(&g_app.lines);
+    caret_at(an_pos(&g_app.anchors, sv->caret));
+    const int left_col = g_app.left_col;
+    g_app.left_col = sv->left_col;
+    sv->left_col = left_col;
+    an_set(&g_app.anchors, sv->caret, caret);
+    an_set(&g_app.anchors, sv->top, top);
+}
+
+// Split the editor, the new pane showing the same place, or change how the
+// two lie; the same mode again closes the split
+static void split_toggle(SplitMode mode) {
+    SplitView *sv = &g_app.split;
+    if (sv->mode == mode) {
+        an_remove_owner(&g_app.anchors, ANCHOR_SPLIT);
+        sv->mode = SPLIT_NONE;
+        sv->focus = 0;
+    } else {
+        if (sv->mode == SPLIT_NONE) {
+            lix_lock(&g_app.lines);
+            const size_t top = li_line_start(&g_app.lines.index, (size_t)g_app.top_line);
+            lix_unlock(&g_app.lines);
+            sv->caret = an_add(&g_app.anchors, caret_index(), AN_RIGHT, ANCHOR_SPLIT);
+            sv->top = an_add(&g_app.anchors, top, AN_RIGHT, ANCHOR_SPLIT);
+            sv->left_col = g_app.left_col;
+            sv->focus = 0;
+            if (sv->caret == AN_NONE || sv->top == AN_NONE) {
+                an_remove_owner(&g_app.anchors, ANCHOR_SPLIT);
+                return;
+            }
+        }
+        sv->mode = mode;
+    }
+    move_cursor(0, 0);
+}
+
+static void split_focus_other(void) {
+    if (g_app.split.mode == SPLIT_NONE) return;
+    split_swap();
+    g_app.split.focus = 1 - g_app.split.focus;
+    move_cursor(0, 0);
+}
+
 // ===== Main =====
 int main(int argc, char *argv[]) {
     // Initialize application state
@@ -733,7 +1026,11 @@ int main(int argc, char *argv[]) {
     gb_init(&g_app.buf);
     gb_init(&g_app.out.buf);
     pthread_mutex_init(&g_app.out.lock, NULL);
+    lix_init(&g_app.lines);
+    an_init(&g_app.anchors);
     g_app.tab_width = WOFL_DEFAULT_TAB;
+    g_app.total_lines_cache = 1;
+    index_start();
     
     // Load file if provided
     if (argc > 1) {
@@ -742,14 +1039,17 @@ int main(int argc, char *argv[]) {
     
     init_ncurses();
     
-    // Main loop
+    // Main loop; poll while the line index is still being built
     while (g_running) {
         render_screen();
+        timeout(g_app.need_recount ? 100 : -1);
         int ch = getch();
-        handle_key(ch);
+        if (ch != ERR) handle_key(ch);
     }
     
     cleanup_ncurses();
+    lix_free(&g_app.lines);
+    an_free(&g_app.anchors);
     gb_free(&g_app.buf);
     gb_free(&g_app.out.buf);
     pthread_mutex_destroy(&g_app.out.lock);
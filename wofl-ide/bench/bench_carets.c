@@ -0,0 +1,196 @@
+// ==================== bench_carets.c ====================
+// Many carets: one keystroke at every line, batched and one at a time
+//
+//   bench_carets            1k, 10k and 100k carets
+//   bench_carets N          N carets
+//
+// A generated file has a caret on every line at the same column, as a
+// column edit leaves them. Each keystroke types a character at all of them
+// and every fourth is a backspace. It is applied as one batch (edit_batch.h),
+// and again one caret at a time, moving the gap to each: in caret order,
+// and in the order the carets were placed, half up and half down from the
+// middle. All three must leave the same text.
+
+#define _POSIX_C_SOURCE 199309L
+#include "edit_batch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+static double now_sec(void) {
+    LARGE_INTEGER f, t;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&t);
+    return (double)t.QuadPart / (double)f.QuadPart;
+}
+#else
+#include <time.h>
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+#endif
+
+#define BENCH_KEYS      40
+#define BENCH_COLUMN    8
+#define BENCH_LINE      "    int value_%06d = compute(%d, flags);\n"
+
+// The gap buffer of the Linux ports, cut down
+typedef struct {
+    char  *data;
+    size_t capacity, gap_start, gap_end;
+} Gap;
+
+static size_t gap_length(const Gap *g) {
+    return g->capacity - (g->gap_end - g->gap_start);
+}
+
+static void gap_ensure(Gap *g, size_t need) {
+    if (g->gap_end - g->gap_start >= need) return;
+    size_t cap = g->capacity * 2;
+    while (cap - gap_length(g) < need + 100) cap *= 2;
+    char *data = (char *)realloc(g->data, cap);
+    if (!data) exit(1);
+    const size_t post = g->capacity - g->gap_end;
+    memmove(data + cap - post, data + g->gap_end, post);
+    g->data = data;
+    g->gap_end = cap - post;
+    g->capacity = cap;
+}
+
+static void gap_move(Gap *g, size_t pos) {
+    if (pos < g->gap_start) {
+        const size_t n = g->gap_start - pos;
+        memmove(g->data + g->gap_end - n, g->data + pos, n);
+        g->gap_start -= n;
+        g->gap_end -= n;
+    } else if (pos > g->gap_start) {
+        const size_t n = pos - g->gap_start;
+        memmove(g->data + g->gap_start, g->data + g->gap_end, n);
+        g->gap_start += n;
+        g->gap_end += n;
+    }
+}
+
+static void gap_edit(Gap *g, size_t pos, size_t del, const char *text, size_t len) {
+    gap_ensure(g, len);
+    gap_move(g, pos);
+    g->gap_end += del;
+    memcpy(g->data + g->gap_start, text, len);
+    g->gap_start += len;
+}
+
+static char *gap_text(Gap *g) {
+    gap_move(g, gap_length(g));
+    return g->data;
+}
+
+typedef enum { BY_BATCH, BY_CARET, BY_PLACING } Mode;
+
+static double run_mode(Mode mode, const char *text, size_t text_len, int carets, char **out) {
+    Gap g = { (char *)malloc(text_len + 4096), text_len + 4096, text_len, text_len + 4096 };
+    size_t *pos = (size_t *)malloc((size_t)carets * sizeof(size_t));
+    int *order = (int *)malloc((size_t)carets * sizeof(int));
+    EditOp *ops = (EditOp *)malloc((size_t)carets * sizeof(EditOp));
+    int *done = (int *)malloc(((size_t)carets + 1) * sizeof(int));
+    if (!g.data || !pos || !order || !ops || !done) exit(1);
+    memcpy(g.data, text, text_len);
+
+    // A caret on every line; placed from the middle, alternately up and down
+    size_t line = 0;
+    for (int i = 0; i < carets; i++) {
+        pos[i] = line + BENCH_COLUMN;
+        line = (size_t)(strchr(text + line, '\n') - text) + 1;
+    }
+    for (int i = 0, up = carets / 2 - 1, down = carets / 2; i < carets; i++) {
+        order[i] = (i % 2 == 0 && down < carets) || up < 0 ? down++ : up--;
+    }
+    // The main caret, and so the gap, starts at the last line
+    gap_move(&g, pos[carets - 1]);
+
+    double t = now_sec();
+    for (int k = 0; k < BENCH_KEYS; k++) {
+        const bool back = k % 4 == 3;
+        const char ch = (char)('a' + k % 26);
+        if (mode == BY_BATCH) {
+            for (int i = 0; i < carets; i++) {
+                ops[i] = (EditOp){ back ? pos[i] - 1 : pos[i], back, &ch, !back, (uint32_t)i, 0 };
+            }
+            gap_ensure(&g, eb_prepare(ops, (size_t)carets));
+            gap_move(&g, ops[0].pos);
+            EditGap eg = { g.data, g.capacity, g.gap_start, g.gap_end, 1 };
+            eb_apply(&eg, ops, (size_t)carets);
+            g.gap_start = eg.gap_start;
+            g.gap_end = eg.gap_end;
+            for (int i = 0; i < carets; i++) pos[ops[i].tag] = ops[i].at;
+        } else {
+            // One at a time, each caret shifted by those before it already
+            // edited, which the tree counts
+            const long delta = back ? -1 : 1;
+            memset(done, 0, ((size_t)carets + 1) * sizeof(int));
+            for (int j = 0; j < carets; j++) {
+                const int i = mode == BY_CARET ? j : order[j];
+                int before = 0;
+                for (int x = i; x > 0; x -= x & -x) before += done[x];
+                for (int x = i + 1; x <= carets; x += x & -x) done[x]++;
+                gap_edit(&g, pos[i] + (size_t)(delta * before) - back, back, &ch, !back);
+            }
+            for (int i = 0; i < carets; i++) pos[i] += (size_t)(delta * (i + 1));
+        }
+    }
+    t = now_sec() - t;
+
+    const size_t len = gap_length(&g);
+    *out = (char *)malloc(len + 1);
+    if (!*out) exit(1);
+    memcpy(*out, gap_text(&g), len);
+    (*out)[len] = '\0';
+    free(g.data);
+    free(pos);
+    free(order);
+    free(ops);
+    free(done);
+    return t * 1e3 / BENCH_KEYS;
+}
+
+static void run(int carets) {
+    size_t cap = (size_t)carets * 64 + 1, len = 0;
+    char *text = (char *)malloc(cap);
+    if (!text) exit(1);
+    for (int i = 0; i < carets; i++) len += (size_t)snprintf(text + len, cap - len, BENCH_LINE, i, i * 7);
+
+    char *batch, *caret, *placing;
+    const double t_batch = run_mode(BY_BATCH, text, len, carets, &batch);
+    // Placed out of order, the gap crosses the file for every caret: the
+    // one-at-a-time runs stop at 10k
+    const bool slow = carets <= 10000;
+    const double t_caret = slow ? run_mode(BY_CARET, text, len, carets, &caret) : 0;
+    const double t_placing = slow ? run_mode(BY_PLACING, text, len, carets, &placing) : 0;
+
+    printf("  %d carets, %.1f MB: %8.3f ms batched", carets, (double)len / (1 << 20), t_batch);
+    if (slow) {
+        printf(", %8.3f ms per caret in order, %8.3f ms as placed; %s\n", t_caret, t_placing,
+               strcmp(batch, caret) == 0 && strcmp(batch, placing) == 0 ? "same text" : "TEXT DIFFERS");
+        free(caret);
+        free(placing);
+    } else {
+        printf(" per keystroke\n");
+    }
+    free(batch);
+    free(text);
+}
+
+int main(int argc, char **argv) {
+    printf("bench_carets: per keystroke\n");
+    if (argc > 1) {
+        run(atoi(argv[1]));
+    } else {
+        run(1000);
+        run(10000);
+        run(100000);
+    }
+    return 0;
+}
@@ -0,0 +1,213 @@
+// ==================== bench_complete.c ====================
+// Word completion: counting a file, and the cost of one keystroke
+//
+//   bench_complete             a generated C file and recent files beside it
+//   bench_complete FILE...     the first file is edited, the rest are recent
+//
+// Words are typed into the text a character at a time at random places,
+// with a backspace now and then. Each keystroke is reported to the tries
+// and completions for the word at the caret are looked up, as the popup
+// does; that pair is what is timed.
+
+#define _POSIX_C_SOURCE 199309L
+#include "word_complete.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+static double now_sec(void) {
+    LARGE_INTEGER f, t;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&t);
+    return (double)t.QuadPart / (double)f.QuadPart;
+}
+#else
+#include <time.h>
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+#endif
+
+#define BENCH_BYTES     (4u << 20)      // generated file being edited
+#define BENCH_RECENT    WC_BUFFERS
+#define BENCH_RECENT_BYTES (512u << 10)
+#define BENCH_WORDS     2000            // words typed
+#define BENCH_SEED      0x2545F491u
+#define BENCH_MAX_HITS  10
+
+static const char *const g_verbs[] = {
+    "get", "set", "read", "write", "parse", "emit", "find", "load", "save", "init",
+    "free", "push", "pop", "scan", "match", "draw", "build", "merge", "split", "apply"
+};
+static const char *const g_nouns[] = {
+    "buffer", "line", "token", "cursor", "state", "block", "index", "frame", "glyph", "node",
+    "entry", "range", "span", "table", "cache", "path", "event", "theme", "view", "caret"
+};
+#define NWORDS(a) ((int)(sizeof(a) / sizeof((a)[0])))
+
+static uint32_t xorshift(uint32_t *s) {
+    uint32_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *s = x;
+}
+
+// Text being edited: one array, moved around on every keystroke outside
+// the timed part
+typedef struct {
+    char *data;
+    size_t len, cap;
+} Text;
+
+static unsigned text_char(void *ctx, size_t pos) {
+    return (unsigned char)((const Text *)ctx)->data[pos];
+}
+
+static size_t text_length(void *ctx) {
+    return ((const Text *)ctx)->len;
+}
+
+static void make_name(char *out, size_t cap, uint32_t *seed) {
+    const char *verb = g_verbs[xorshift(seed) % NWORDS(g_verbs)];
+    const char *noun = g_nouns[xorshift(seed) % NWORDS(g_nouns)];
+    snprintf(out, cap, "%s_%s_%u", verb, noun, xorshift(seed) % 500);
+}
+
+static void generate(Text *t, size_t bytes, uint32_t *seed) {
+    t->cap = bytes + (1u << 20);
+    t->data = (char *)malloc(t->cap);
+    t->len = 0;
+    while (t->data && t->len + 256 < bytes) {
+        char a[64], b[64];
+        make_name(a, sizeof(a), seed);
+        make_name(b, sizeof(b), seed);
+        t->len += (size_t)snprintf(t->data + t->len, t->cap - t->len,
+                                   "static int %s(struct state *s, int count) {\n"
+                                   "    return %s(s->buffer, count + %u);\n}\n\n",
+                                   a, b, xorshift(seed) % 100);
+    }
+}
+
+static bool read_file(Text *t, const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+    fseek(f, 0, SEEK_END);
+    const long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    t->cap = (size > 0 ? (size_t)size : 0) + (1u << 20);
+    t->data = (char *)malloc(t->cap);
+    t->len = t->data ? fread(t->data, 1, t->cap, f) : 0;
+    fclose(f);
+    return t->data != NULL;
+}
+
+// As the popup does: nothing until WC_PREFIX_MIN characters are typed
+static int complete(WordComplete *wc, WcSource src, size_t pos, WcCandidate *hits) {
+    char prefix[WC_WORD_MAX];
+    if (wc_prefix_at(src, pos, prefix) < WC_PREFIX_MIN) return 0;
+    return wc_complete(wc, src, pos, hits, BENCH_MAX_HITS);
+}
+
+static int cmp_double(const void *a, const void *b) {
+    const double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char **argv) {
+    WordComplete wc;
+    Text text = { NULL, 0, 0 };
+    uint32_t seed = BENCH_SEED;
+    size_t recent_bytes = 0;
+    int recent = 0;
+    double open_ms = 0;
+
+    wc_init(&wc);
+
+    // Recent files first, each opened in turn; the edited file last
+    const int files = argc > 1 ? argc - 1 : BENCH_RECENT + 1;
+    for (int i = 0; i < files; i++) {
+        Text t;
+        const bool last = i == files - 1;
+        const int arg = last ? 1 : i + 2;
+        if (argc > 1 ? !read_file(&t, argv[arg]) : (generate(&t, last ? BENCH_BYTES : BENCH_RECENT_BYTES, &seed), !t.data)) {
+            fprintf(stderr, "bench_complete: cannot read %s\n", argc > 1 ? argv[arg] : "(generated)");
+            return 1;
+        }
+        WcSource src = { text_char, text_length, &t };
+        const double t0 = now_sec();
+        wc_open(&wc, src, (uint64_t)i + 1);
+        const double t1 = now_sec();
+        if (last) {
+            text = t;
+            open_ms = (t1 - t0) * 1e3;
+        } else {
+            recent_bytes += t.len;
+            recent++;
+            free(t.data);
+        }
+    }
+
+    WcSource src = { text_char, text_length, &text };
+    const int max_keys = BENCH_WORDS * 64;
+    double *times = (double *)malloc((size_t)max_keys * sizeof(double));
+    int keys = 0, shown = 0;
+    WcCandidate hits[BENCH_MAX_HITS];
+    if (!times) return 1;
+
+    for (int w = 0; w < BENCH_WORDS; w++) {
+        // Type on a new line after a random one, like a new statement
+        size_t pos = xorshift(&seed) % text.len;
+        while (pos < text.len && text.data[pos] != '\n') pos++;
+        char word[64] = "\n";
+        make_name(word + 1, sizeof(word) - 1, &seed);
+        const size_t n = strlen(word);
+        for (size_t k = 0; k <= n && keys < max_keys && text.len + 1 < text.cap; k++) {
+            const bool back = k > 3 && k < n && xorshift(&seed) % 8 == 0;
+            const char c = k < n ? word[k] : ' ';
+            double t0, spent;
+            int found;
+            if (back) {
+                // Backspace over the character just typed, which is typed again next
+                pos--;
+                t0 = now_sec();
+                wc_note_delete(&wc, src, pos, 1);
+                spent = now_sec() - t0;
+                memmove(text.data + pos, text.data + pos + 1, text.len - pos - 1);
+                text.len--;
+                t0 = now_sec();
+                found = complete(&wc, src, pos, hits);
+                times[keys++] = (spent + now_sec() - t0) * 1e3;
+                shown += found > 0;
+                k -= 2;
+                continue;
+            }
+            memmove(text.data + pos + 1, text.data + pos, text.len - pos);
+            text.data[pos] = c;
+            text.len++;
+            pos++;
+            t0 = now_sec();
+            wc_note_insert(&wc, src, pos - 1, 1);
+            found = complete(&wc, src, pos, hits);
+            times[keys++] = (now_sec() - t0) * 1e3;
+            shown += found > 0;
+        }
+    }
+
+    qsort(times, (size_t)keys, sizeof(double), cmp_double);
+    printf("bench_complete: %.1f MB edited, %d recent files (%.1f MB)\n",
+           (double)text.len / 1e6, recent, (double)recent_bytes / 1e6);
+    printf("  open       %8.1f ms, %u distinct words, %u trie nodes, %.1f KB of labels\n",
+           open_ms, wc.current.words, wc.current.nnodes, (double)wc.current.used / 1e3);
+    printf("  keystroke  %8.3f ms p50 %8.3f ms p99 %8.3f ms max   (%d keys, %d with completions)\n",
+           times[keys / 2], times[keys * 99 / 100], times[keys - 1], keys, shown);
+
+    free(times);
+    free(text.data);
+    wc_free(&wc);
+    return 0;
+}
@@ -0,0 +1,205 @@
+// ==================== bench_finder.c ====================
+// Quick open: a workspace's worth of paths, and the cost of one keystroke
+//
+//   bench_finder             500k generated paths
+//   bench_finder DIR         the files under DIR, walked as the editor does
+//
+// Queries are abbreviations of paths in the list, typed a character at a
+// time with a backspace now and then; each keystroke asks for the best 50
+// matches, as the quick open prompt does. Every keystroke is timed as
+// typed, narrowing the last matches, and again as a fresh query over the
+// whole list, with each prefilter the CPU has.
+
+#define _POSIX_C_SOURCE 199309L
+#include "file_finder.h"
+#include "newline_scan.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+static double now_sec(void) {
+    LARGE_INTEGER f, t;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&t);
+    return (double)t.QuadPart / (double)f.QuadPart;
+}
+static void pause_ms(int ms) { Sleep((DWORD)ms); }
+#else
+#include <time.h>
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+static void pause_ms(int ms) {
+    struct timespec ts = { ms / 1000, (long)(ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+#endif
+
+#define BENCH_PATHS     500000
+#define BENCH_QUERIES   200
+#define BENCH_SEED      0x2545F491u
+#define BENCH_HITS      50
+
+static const char *const g_dirs[] = {
+    "src", "lib", "include", "test", "tests", "docs", "tools", "build", "core", "net",
+    "ui", "render", "editor", "platform", "linux", "win32", "common", "util", "io", "parser",
+    "vendor", "third_party", "scripts", "assets", "shaders", "fonts", "config", "plugins", "api", "internal"
+};
+static const char *const g_words[] = {
+    "buffer", "line", "token", "cursor", "state", "block", "index", "frame", "glyph", "node",
+    "entry", "range", "span", "table", "cache", "path", "event", "theme", "view", "caret",
+    "file", "finder", "window", "input", "render", "layout", "font", "syntax", "lexer", "scan"
+};
+static const char *const g_exts[] = { ".c", ".h", ".cpp", ".py", ".md", ".txt", ".json", ".o" };
+#define NWORDS(a) ((int)(sizeof(a) / sizeof((a)[0])))
+
+static uint32_t xorshift(uint32_t *s) {
+    uint32_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *s = x;
+}
+
+static void generate(FileList *l, uint32_t *seed) {
+    char path[FF_PATH_MAX];
+    while (l->count < BENCH_PATHS) {
+        int len = 0;
+        const int depth = 1 + (int)(xorshift(seed) % 6);
+        for (int d = 0; d < depth; d++) {
+            len += snprintf(path + len, sizeof(path) - (size_t)len, "%s/", g_dirs[xorshift(seed) % NWORDS(g_dirs)]);
+        }
+        len += snprintf(path + len, sizeof(path) - (size_t)len, "%s_%s_%u%s",
+                        g_words[xorshift(seed) % NWORDS(g_words)], g_words[xorshift(seed) % NWORDS(g_words)],
+                        xorshift(seed) % 1000, g_exts[xorshift(seed) % NWORDS(g_exts)]);
+        if (!ff_add(l, path, (size_t)len)) break;
+    }
+}
+
+// An abbreviation of a listed path: the start of each word of its name
+static int make_query(const FileList *l, uint32_t *seed, char *out, int cap) {
+    const uint32_t i = xorshift(seed) % l->count;
+    const char *path = ff_path(l, i);
+    const char *name = path + l->base[i];
+    int n = 0;
+    for (int k = 0; name[k] && n < cap - 1; k++) {
+        const bool start = k == 0 || name[k - 1] == '_' || name[k - 1] == '.';
+        const bool more = k > 0 && name[k] != '_' && name[k] != '.' && name[k - 1] != '_' && n > 0 &&
+                          out[n - 1] == name[k - 1] && xorshift(seed) % 2 == 0;
+        if (start || more) out[n++] = name[k];
+    }
+    out[n] = '\0';
+    return n;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    const double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void report(const char *what, double *times, int n) {
+    qsort(times, (size_t)n, sizeof(double), cmp_double);
+    printf("  %-20s %8.3f ms p50 %8.3f ms p99 %8.3f ms max\n", what, times[n / 2], times[n * 99 / 100], times[n - 1]);
+}
+
+int main(int argc, char **argv) {
+    FileList list, *l = &list;
+    FileIndexer ix;
+    uint32_t seed = BENCH_SEED;
+    double load_ms;
+
+    ff_init(&list);
+    ffx_init(&ix);
+    const double t0 = now_sec();
+    if (argc > 1) {
+        bool running = true;
+        ffx_start(&ix, argv[1]);
+        while (running) {
+            pause_ms(5);
+            ffx_status(&ix, &running, NULL);
+        }
+        if (!ix.list || ix.list->count == 0) {
+            fprintf(stderr, "bench_finder: no files under %s\n", argv[1]);
+            return 1;
+        }
+        l = ix.list;
+    } else {
+        generate(&list, &seed);
+        list.generation = 1;
+    }
+    load_ms = (now_sec() - t0) * 1e3;
+    printf("bench_finder: %u paths, %.1f MB, %s in %.1f ms\n", l->count, (double)l->used / 1e6,
+           argc > 1 ? "walked" : "generated", load_ms);
+
+    const int max_keys = BENCH_QUERIES * 64;
+    double *typed = (double *)malloc((size_t)max_keys * sizeof(double));
+    double *fresh = (double *)malloc((size_t)max_keys * sizeof(double));
+    char (*queries)[FF_QUERY_MAX] = (char (*)[FF_QUERY_MAX])malloc((size_t)max_keys * FF_QUERY_MAX);
+    if (!typed || !fresh || !queries) return 1;
+
+    // The keystrokes: each query typed out, now and then a character wrong
+    // and taken back
+    int keys = 0;
+    for (int q = 0; q < BENCH_QUERIES; q++) {
+        char full[64];
+        const int n = make_query(l, &seed, full, (int)sizeof(full));
+        for (int k = 1; k <= n && keys + 2 < max_keys; k++) {
+            if (k > 2 && xorshift(&seed) % 8 == 0) {
+                snprintf(queries[keys], FF_QUERY_MAX, "%.*s%c", k - 1, full, 'a' + (int)(xorshift(&seed) % 26));
+                keys++;
+            }
+            snprintf(queries[keys++], FF_QUERY_MAX, "%.*s", k, full);
+        }
+    }
+
+    FileMatch a[BENCH_HITS], b[BENCH_HITS];
+    FileQuery state;
+    ff_query_init(&state);
+    int found = 0, differ = 0;
+    for (int k = 0; k < keys; k++) {
+        double t = now_sec();
+        const int na = ff_query(l, &state, queries[k], a, BENCH_HITS);
+        typed[k] = (now_sec() - t) * 1e3;
+        t = now_sec();
+        const int nb = ff_query(l, NULL, queries[k], b, BENCH_HITS);
+        fresh[k] = (now_sec() - t) * 1e3;
+        found += na > 0;
+        differ += na != nb || memcmp(a, b, (size_t)na * sizeof(FileMatch)) != 0;
+    }
+    printf("  %d keystrokes, %d with matches, %d where narrowing gave other matches\n", keys, found, differ);
+    report("typed", typed, keys);
+    report("fresh query", fresh, keys);
+
+    // Each prefilter on the fresh queries
+    const NlIsa best = nl_isa_max();
+    for (int isa = NL_ISA_SCALAR; isa <= (int)best; isa++) {
+        char what[32];
+        nl_set_isa((NlIsa)isa);
+        for (int k = 0; k < keys; k++) {
+            const double t = now_sec();
+            ff_query(l, NULL, queries[k], b, BENCH_HITS);
+            fresh[k] = (now_sec() - t) * 1e3;
+        }
+        snprintf(what, sizeof(what), "fresh, %s", nl_isa_name((NlIsa)isa));
+        report(what, fresh, keys);
+    }
+    nl_set_isa(best);
+
+    const int shown = ff_query(l, NULL, queries[keys - 1], a, 5);
+    if (shown > 0) {
+        printf("  best for \"%s\":\n", queries[keys - 1]);
+        for (int i = 0; i < shown; i++) printf("    %6d  %s\n", a[i].score, ff_path(l, a[i].path));
+    }
+
+    ff_query_free(&state);
+    free(queries);
+    free(typed);
+    free(fresh);
+    ffx_free(&ix);
+    ff_free(&list);
+    return 0;
+}
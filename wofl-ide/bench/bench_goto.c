@@ -0,0 +1,147 @@
+// ==================== bench_goto.c ====================
+// Go-to jumps through the line index against scanning from the top
+//
+//   bench_goto              1M and 10M lines
+//   bench_goto N            N lines
+//
+// Each jump parses a prompt (goto_target.h), resolves it in the line index
+// and looks up the line starts of a 60-line screen around it, as drawing
+// the destination does. Line, line:col, percent and offset jumps are
+// timed over random targets; the old way, counting newlines from offset 0
+// to the line, is timed on a few and must find the same line starts.
+
+#define _POSIX_C_SOURCE 199309L
+#include "goto_target.h"
+#include "newline_scan.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+static double now_sec(void) {
+    LARGE_INTEGER f, t;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&t);
+    return (double)t.QuadPart / (double)f.QuadPart;
+}
+#else
+#include <time.h>
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+#endif
+
+#define BENCH_JUMPS     10000
+#define BENCH_SCANS     8
+#define BENCH_SCREEN    60
+
+static volatile size_t g_sink;
+static unsigned g_seed = 12345;
+
+static unsigned next_rand(void) {
+    g_seed = g_seed * 1103515245u + 12345u;
+    return g_seed >> 8;
+}
+
+static size_t rand_below(size_t n) {
+    const size_t r = ((size_t)next_rand() << 24) ^ next_rand();
+    return n ? r % n : 0;
+}
+
+// Lines of 0 to 30 characters, some blank
+static char *make_text(size_t lines, size_t *len) {
+    size_t cap = lines * 32 + 1, n = 0;
+    char *text = (char *)malloc(cap);
+    if (!text) exit(1);
+    for (size_t i = 0; i < lines; i++) {
+        const size_t w = next_rand() % 31;
+        for (size_t c = 0; c < w; c++) text[n++] = (char)('a' + (i + c) % 26);
+        text[n++] = '\n';
+    }
+    *len = n;
+    return text;
+}
+
+// Line start the old way: the line-th newline counted from offset 0
+static size_t scan_line_start(const char *text, size_t len, size_t line) {
+    if (line == 0) return 0;
+    size_t k = line;
+    const size_t nl = nl_find_nth(text, len, 1, &k);
+    return nl < len ? nl + 1 : len;
+}
+
+// One jump and the screen it lands on; returns the caret's offset
+static size_t jump(const LineIndex *li, const char *prompt) {
+    GotoTarget t;
+    size_t line = 0, col = 4;
+    if (!goto_parse(prompt, &t)) return 0;
+    goto_resolve(&t, li, &line, &col);
+    const size_t top = line > BENCH_SCREEN / 2 ? line - BENCH_SCREEN / 2 : 0;
+    size_t sum = 0;
+    for (size_t l = top; l < top + BENCH_SCREEN; l++) sum += li_line_start(li, l);
+    g_sink += sum;
+    return li_line_start(li, line) + col;
+}
+
+static double time_jumps(const LineIndex *li, char (*prompts)[32], int n) {
+    double t = now_sec();
+    for (int i = 0; i < n; i++) g_sink += jump(li, prompts[i]);
+    return (now_sec() - t) * 1e6 / n;
+}
+
+static void run(size_t lines) {
+    size_t len;
+    char *text = make_text(lines, &len);
+    static char prompts[BENCH_JUMPS][32];
+
+    LineIndex li;
+    li_init(&li);
+    double t = now_sec();
+    li_append_text(&li, text, len, 1);
+    const double t_build = now_sec() - t;
+    printf("  %zu lines, %.1f MB, indexed in %.0f ms\n", lines, (double)len / (1 << 20), t_build * 1e3);
+
+    for (int i = 0; i < BENCH_JUMPS; i++) snprintf(prompts[i], 32, "%zu", rand_below(lines) + 1);
+    printf("    %-12s %8.3f us per jump\n", "line", time_jumps(&li, prompts, BENCH_JUMPS));
+    for (int i = 0; i < BENCH_JUMPS; i++) snprintf(prompts[i], 32, "%zu:%u", rand_below(lines) + 1, next_rand() % 40 + 1);
+    printf("    %-12s %8.3f us per jump\n", "line:col", time_jumps(&li, prompts, BENCH_JUMPS));
+    for (int i = 0; i < BENCH_JUMPS; i++) snprintf(prompts[i], 32, "%u.%02u%%", next_rand() % 100, next_rand() % 100);
+    printf("    %-12s %8.3f us per jump\n", "percent", time_jumps(&li, prompts, BENCH_JUMPS));
+    for (int i = 0; i < BENCH_JUMPS; i++) snprintf(prompts[i], 32, "@%zu", rand_below(len));
+    printf("    %-12s %8.3f us per jump\n", "offset", time_jumps(&li, prompts, BENCH_JUMPS));
+
+    // The old way, on lines in the last tenth of the file
+    bool same = true;
+    double t_scan = 0, t_index = 0;
+    for (int i = 0; i < BENCH_SCANS; i++) {
+        const size_t line = lines - 1 - rand_below(lines / 10 + 1);
+        char prompt[32];
+        snprintf(prompt, sizeof(prompt), "%zu:1", line + 1);
+        t = now_sec();
+        const size_t by_scan = scan_line_start(text, len, line);
+        t_scan += now_sec() - t;
+        t = now_sec();
+        const size_t by_index = jump(&li, prompt);
+        t_index += now_sec() - t;
+        same = same && by_scan == by_index;
+    }
+    printf("    %-12s %8.3f ms per jump from the top, %.3f us indexed; %s\n", "scan",
+           t_scan * 1e3 / BENCH_SCANS, t_index * 1e6 / BENCH_SCANS, same ? "same lines" : "LINES DIFFER");
+
+    li_free(&li);
+    free(text);
+}
+
+int main(int argc, char **argv) {
+    printf("bench_goto: parse, resolve and a screen of line starts\n");
+    if (argc > 1) {
+        run((size_t)atoll(argv[1]));
+    } else {
+        run(1000000);
+        run(10000000);
+    }
+    return 0;
+}
@@ -0,0 +1,346 @@
+// ==================== bench_lexer.c ====================
+// Scanning throughput of every registered language, generated or not
+//
+// First every language must scan a few pinned lines into exactly the
+// tokens recorded below. Then, before a language is timed, one pass checks
+// every token it makes lies within its line, after the one before, with a
+// known class. A changed or bad token ends the bench with exit status 1. So does a pre-pass kernel that
+// classifies a block, or lets the lexer make a token, other than the
+// scalar one does.
+
+#define _POSIX_C_SOURCE 199309L
+#include "lang_registry.h"
+#include "lexer.h"
+#include "charclass.h"
+#include "bench_samples.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+static double now_sec(void) {
+    LARGE_INTEGER f, t;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&t);
+    return (double)t.QuadPart / (double)f.QuadPart;
+}
+#else
+#include <time.h>
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+#endif
+
+#define BENCH_CHARS   (8u << 20)
+#define BENCH_REPEAT  5
+
+static volatile size_t g_sink;
+
+typedef struct {
+    wchar_t *text;
+    int *starts;            // line i is text[starts[i] .. starts[i + 1] - 1)
+    size_t lines;
+} Corpus;
+
+static bool make_corpus(const char *sample, Corpus *c) {
+    size_t len = strlen(sample);
+    size_t sample_lines = 0;
+    for (size_t i = 0; i < len; i++) sample_lines += sample[i] == '\n';
+    size_t copies = BENCH_CHARS / len + 1;
+
+    c->text = malloc(copies * len * sizeof(wchar_t));
+    c->starts = malloc((copies * sample_lines + 1) * sizeof(int));
+    if (!c->text || !c->starts) return false;
+
+    size_t at = 0;
+    c->lines = 0;
+    for (size_t k = 0; k < copies; k++) {
+        for (size_t i = 0; i < len; i++) {
+            if (i == 0 || sample[i - 1] == '\n') c->starts[c->lines++] = (int)at;
+            c->text[at++] = (unsigned char)sample[i];
+        }
+    }
+    c->starts[c->lines] = (int)at;
+    return true;
+}
+
+// Scan one line as the editor does; returns the state for the next line
+static int scan_line(const Syntax *sx, const wchar_t *line, int len, int state, TokenSpan *out, int *n) {
+    if (sx->lexer) return lex_scan(sx->lexer, line, len, state, out, n);
+    sx->scan_line(line, len, out, n);
+    return state;
+}
+
+static bool spans_ok(const TokenSpan *out, int n, int len) {
+    size_t end = 0;
+    if (n < 0 || n > WOFL_MAX_TOKENS) return false;
+    for (int i = 0; i < n; i++) {
+        if (out[i].start < end || out[i].len == 0 || out[i].start + out[i].len > (size_t)len) return false;
+        if ((unsigned)out[i].cls >= TK_MAX) return false;
+        end = out[i].start + out[i].len;
+    }
+    return true;
+}
+
+// Lines each language must scan exactly so, each in the state the line
+// before left. Under each line, one letter per column for the class of the
+// token over it (Text Kw Ident Num Str Char coMment Punct), upper case
+// where a token starts, blank where none does.
+#define PIN_LINES 8
+
+static const struct {
+    Language lang;
+    const char *lines[PIN_LINES + 1];   // line, classes, line, classes ... NULL
+} pinned[] = {
+    { LANG_NONE, {
+        "plain text 12",
+        "Ttttttttttttt",
+    } },
+    { LANG_C, {
+        "#include <stdio.h>",
+        "KkkkkkkkTPIiiiiPIP",
+        "int main(void) { return 0x1F; } // done",
+        "KkkTIiiiPKkkkPTPTKkkkkkTNnnnPTPTMmmmmmm",
+        "char c = 'a'; /* open",
+        "KkkkTITPTCccPTMmmmmmm",
+        "still */ s = \"q\\\"x\";",
+        "MmmmmmmmTITPTSsssssP",
+    } },
+    { LANG_CPP, {
+        "namespace n { auto x = 1.5f; } // c",
+        "KkkkkkkkkTITPTKkkkTITPTNnnnPTPTMmmm",
+        "template<class T> bool f();",
+        "KkkkkkkkPKkkkkTIPTKkkkTIPPP",
+    } },
+    { LANG_ASM, {
+        "loop: mov eax, 10h ; load",
+        "IiiiiTKkkTKkkPTNnnTMmmmmm",
+    } },
+    { LANG_CSV, {
+        "a,\"b,c\",3",
+        "IPCccccPN",
+    } },
+    { LANG_PY, {
+        "def f(x): return '''doc",
+        "KkkTIPIPPTKkkkkkTSsssss",
+        "more''' + \"y\"  # c",
+        "SssssssTPTSssTtMmm",
+    } },
+    { LANG_JS, {
+        "const s = `t`; // c",
+        "KkkkkTITPTSssPTMmmm",
+        "let r = 1.5e3 / 2;",
+        "KkkTITPTNnnnnTPTNP",
+    } },
+    { LANG_HTML, {
+        "<a href=\"x\">t</a> <!-- c -->",
+        "PpppppppppppTPpppTPppppppppp",
+    } },
+    { LANG_CSS, {
+        ".a > b { color: #fff; } /* c */",
+        "TTTTTTTTTTttttTTNnnnTTTTMmmmmmm",
+    } },
+    { LANG_JSON, {
+        "{\"k\": [true, null, -1.5e2]}",
+        "PSssPTPKkkkPTKkkkPTNnnnnnPP",
+    } },
+    { LANG_MD, {
+        "# Title",
+        "Kkkkkkk",
+        "- item `code`",
+        "Kkkkkkkkkkkkk",
+    } },
+    { LANG_GO, {
+        "package main",
+        "KkkkkkkTIiii",
+        "func f() bool { return false } // c",
+        "KkkkTIPPTKkkkTPTKkkkkkTKkkkkTPTMmmm",
+    } },
+    { LANG_RS, {
+        "#[derive(Debug)]",
+        "Mmmmmmmmmmmmmmmm",
+        "fn f() -> u8 { 0 } // c",
+        "KkTIPPTPpTKkTPTNTPTMmmm",
+    } },
+    { LANG_SH, {
+        "echo \"$HOME\" $1 # c",
+        "KkkkTSssssssTIiTMmm",
+    } },
+    { LANG_LUA, {
+        "local t = { x = 1 } -- c",
+        "KkkkkTITPTPTITPTNTPTMmmm",
+    } },
+};
+
+static void check_pinned(void) {
+    for (size_t k = 0; k < sizeof pinned / sizeof pinned[0]; k++) {
+        const Syntax *sx = syntax_get(pinned[k].lang);
+        int state = 0;
+        for (int i = 0; pinned[k].lines[i]; i += 2) {
+            const char *text = pinned[k].lines[i];
+            const int len = (int)strlen(text);
+            wchar_t line[128];
+            char got[128];
+            TokenSpan out[WOFL_MAX_TOKENS];
+            int n;
+            for (int j = 0; j < len; j++) line[j] = (unsigned char)text[j];
+            state = scan_line(sx, line, len, state, out, &n);
+            if (!spans_ok(out, n, len)) n = 0;
+            memset(got, ' ', (size_t)len);
+            got[len] = 0;
+            for (int t = 0; t < n; t++) {
+                for (size_t j = 0; j < out[t].len; j++) {
+                    got[out[t].start + j] = (j ? "tkinscmp" : "TKINSCMP")[out[t].cls];
+                }
+            }
+            if (strcmp(got, pinned[k].lines[i + 1]) != 0) {
+                printf("  %s: TOKENS DIFFER from the pinned ones on line %d\n    %s\n    want %s\n    got  %s\n",
+                       lang_info(pinned[k].lang)->name, i / 2 + 1, text, pinned[k].lines[i + 1], got);
+                exit(1);
+            }
+        }
+    }
+}
+
+/**
+ * One pass over the corpus with every span checked. Returns a hash of the
+ * spans and the states between lines, for comparing two passes.
+ */
+static uint64_t check_scan(const char *name, const Syntax *sx, const Corpus *c) {
+    uint64_t h = 1469598103934665603ull;
+    TokenSpan out[WOFL_MAX_TOKENS];
+    int state = 0;
+    for (size_t i = 0; i < c->lines; i++) {
+        const wchar_t *line = c->text + c->starts[i];
+        int len = c->starts[i + 1] - c->starts[i] - 1;
+        int n;
+        state = scan_line(sx, line, len, state, out, &n);
+        if (!spans_ok(out, n, len)) {
+            printf("  %s: BAD TOKENS on line %zu\n", name, i + 1);
+            exit(1);
+        }
+        for (int k = 0; k < n; k++) {
+            h = (h ^ (out[k].start | (uint64_t)out[k].len << 24 | (uint64_t)out[k].cls << 48)) * 1099511628211ull;
+        }
+        h = (h ^ (uint64_t)(unsigned)state ^ 0xFFFF000000000000ull) * 1099511628211ull;
+    }
+    return h;
+}
+
+// Best time of BENCH_REPEAT passes over the corpus; *tokens gets the count
+static double time_scan(const Syntax *sx, const Corpus *c, size_t *tokens) {
+    double best = 1e9;
+    for (int r = 0; r < BENCH_REPEAT; r++) {
+        TokenSpan out[WOFL_MAX_TOKENS];
+        int state = 0;
+        size_t count = 0;
+        double t0 = now_sec();
+        for (size_t i = 0; i < c->lines; i++) {
+            const wchar_t *line = c->text + c->starts[i];
+            int len = c->starts[i + 1] - c->starts[i] - 1;
+            int n;
+            state = scan_line(sx, line, len, state, out, &n);
+            count += (size_t)n;
+        }
+        double dt = now_sec() - t0;
+        if (dt < best) best = dt;
+        *tokens = count;
+    }
+    g_sink = *tokens;
+    return best;
+}
+
+// The character-class pre-pass on its own, whole corpus in 64-char blocks
+static double time_classify(const Corpus *c) {
+    size_t chars = (size_t)c->starts[c->lines];
+    double best = 1e9;
+    for (int r = 0; r < BENCH_REPEAT; r++) {
+        CcBlock b;
+        uint64_t acc = 0;
+        double t0 = now_sec();
+        for (size_t i = 0; i + 64 <= chars; i += 64) {
+            cc_classify(c->text + i, 64, &b);
+            acc += b.ident;
+        }
+        double dt = now_sec() - t0;
+        if (dt < best) best = dt;
+        g_sink = (size_t)acc;
+    }
+    return best;
+}
+
+static bool same_block(const CcBlock *a, const CcBlock *b) {
+    return a->space == b->space && a->ident == b->ident && a->quote == b->quote &&
+           a->op == b->op && a->digit == b->digit;
+}
+
+/**
+ * The selected pre-pass against want, the scalar one's blocks: whole blocks
+ * at every offset into the first few lines, and ragged tails. Then the C
+ * lexer over the whole corpus must make the scalar pass's tokens.
+ */
+static void check_prepass(const Corpus *c, const CcBlock *want, uint64_t want_tokens) {
+    const char *isa = cc_isa_name(cc_isa());
+    for (int off = 0; off < 4096; off++) {
+        CcBlock b;
+        cc_classify(c->text + off, 64 - off % 64, &b);
+        if (!same_block(&b, &want[off])) {
+            printf("  %s: BLOCK DIFFERS at %d, %d chars\n", isa, off, 64 - off % 64);
+            exit(1);
+        }
+    }
+    if (check_scan(isa, syntax_get(LANG_C), c) != want_tokens) {
+        printf("  %s: C TOKENS DIFFER from the scalar pre-pass\n", isa);
+        exit(1);
+    }
+}
+
+int main(void) {
+    printf("bench_lexer: ~%u M chars per language, best of %d, pre-pass %s\n",
+           BENCH_CHARS >> 20, BENCH_REPEAT, cc_isa_name(cc_isa()));
+    check_pinned();
+    printf("  %-12s %-6s %9s %12s %12s\n", "language", "kind", "MB/s", "lines/s", "tokens/s");
+
+    for (int lang = 0; lang < LANG_MAX; lang++) {
+        const LangInfo *info = lang_info((Language)lang);
+        Corpus c;
+        if (!bench_samples[lang] || !make_corpus(bench_samples[lang], &c)) continue;
+
+        size_t tokens;
+        check_scan(info->name, &info->syntax, &c);
+        double best = time_scan(&info->syntax, &c, &tokens);
+
+        // MB of source text, one byte per character as on disk
+        size_t chars = (size_t)c.starts[c.lines];
+        printf("  %-12s %-6s %9.1f %12.0f %12.0f\n", info->name,
+               info->syntax.lexer ? "dfa" : "hand",
+               (double)chars / best / 1e6, (double)c.lines / best, (double)tokens / best);
+        free(c.text);
+        free(c.starts);
+    }
+
+    // C again under each pre-pass kernel
+    Corpus c;
+    if (!make_corpus(bench_samples[LANG_C], &c)) return 1;
+    size_t chars = (size_t)c.starts[c.lines];
+    static CcBlock want[4096];
+    cc_set_isa(CC_ISA_SCALAR);
+    for (int off = 0; off < 4096; off++) cc_classify(c.text + off, 64 - off % 64, &want[off]);
+    const uint64_t want_tokens = check_scan("scalar", syntax_get(LANG_C), &c);
+    printf("\n  %-8s %14s %12s\n", "pre-pass", "classify MB/s", "C MB/s");
+    for (int isa = CC_ISA_SCALAR; isa <= (int)cc_isa_max(); isa++) {
+        cc_set_isa((CcIsa)isa);
+        check_prepass(&c, want, want_tokens);
+        size_t tokens;
+        double scan = time_scan(syntax_get(LANG_C), &c, &tokens);
+        double classify = time_classify(&c);
+        printf("  %-8s %14.1f %12.1f\n", cc_isa_name((CcIsa)isa),
+               (double)chars / classify / 1e6, (double)chars / scan / 1e6);
+    }
+    free(c.text);
+    free(c.starts);
+    return 0;
+}
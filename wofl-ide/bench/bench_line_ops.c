@@ -0,0 +1,164 @@
+// ==================== bench_line_ops.c ====================
+// Whole-buffer line operations on a generated CSV file
+//
+//   bench_line_ops          1M lines
+//   bench_line_ops N        N lines
+//
+// Every operation (line_ops.h) runs on one thread and on as many as there
+// are processors, at least four, and both must write the same text. Sorted
+// lines are checked against qsort() of the same lines, and unique lines
+// against a count of the distinct ones. Times include splitting the text,
+// the operation and writing the new text.
+
+#define _POSIX_C_SOURCE 199309L
+#include "line_ops.h"
+#include "wofl_thread.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+static double now_sec(void) {
+    LARGE_INTEGER f, t;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&t);
+    return (double)t.QuadPart / (double)f.QuadPart;
+}
+#else
+#include <time.h>
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+#endif
+
+static unsigned g_seed = 777;
+
+static unsigned next_rand(void) {
+    g_seed = g_seed * 1103515245u + 12345u;
+    return g_seed >> 8;
+}
+
+// id,name,amount with some indentation, tabs and trailing blanks; one
+// line in eight repeats an earlier one
+static char *make_text(size_t lines, size_t *len) {
+    static const char *const names[] = { "alpha", "bravo", "charlie", "delta", "echo", "foxtrot" };
+    size_t cap = lines * 64 + 64, n = 0;
+    char *text = (char *)malloc(cap);
+    if (!text) exit(1);
+    n += (size_t)snprintf(text, cap, "id,name,amount\n");
+    for (size_t i = 1; i < lines; i++) {
+        const unsigned r = next_rand();
+        const size_t id = r % 8 == 0 ? (size_t)(next_rand() % i) : i;
+        const char *indent = r % 5 == 0 ? "\t" : r % 5 == 1 ? "        " : "";
+        const char *trail = r % 7 == 0 ? "  \t" : "";
+        n += (size_t)snprintf(text + n, cap - n, "%s%zu,%s,%u.%02u%s\n", indent, id, names[id % 6],
+                              (unsigned)(id * 7919 % 100000), (unsigned)(id % 100), trail);
+    }
+    *len = n;
+    return text;
+}
+
+static int cmp_str(const void *a, const void *b) {
+    const char *x = *(const char *const *)a, *y = *(const char *const *)b;
+    return strcmp(x, y);
+}
+
+// The lines of text, split in place (text is changed), sorted by qsort
+static size_t sorted_lines(char *text, size_t len, char ***out) {
+    size_t count = 0;
+    for (size_t i = 0; i < len; i++) count += text[i] == '\n';
+    char **lines = (char **)malloc(count * sizeof(char *));
+    if (!lines) exit(1);
+    char *p = text;
+    for (size_t i = 0; i < count; i++) {
+        char *nl = strchr(p, '\n');
+        *nl = '\0';
+        lines[i] = p;
+        p = nl + 1;
+    }
+    qsort(lines, count, sizeof(char *), cmp_str);
+    *out = lines;
+    return count;
+}
+
+static bool matches_qsort(const char *text, size_t len, const LineOpResult *r) {
+    char *a = (char *)malloc(len + 1), *b = (char *)malloc(r->len + 1);
+    if (!a || !b) exit(1);
+    memcpy(a, text, len);
+    memcpy(b, r->text, r->len);
+    a[len] = b[r->len] = '\0';
+    char **x, **y;
+    const size_t nx = sorted_lines(a, len, &x);
+    const size_t ny = sorted_lines(b, r->len, &y);
+    bool same = nx == ny;
+    // The op's own order must already be sorted: compare it unsorted too
+    const char *p = (const char *)r->text;
+    for (size_t i = 0; same && i < nx; i++) {
+        const size_t n = strlen(x[i]);
+        same = strcmp(x[i], y[i]) == 0 && strncmp(p, x[i], n) == 0 && p[n] == '\n';
+        p += n + 1;
+    }
+    free(x);
+    free(y);
+    free(a);
+    free(b);
+    return same;
+}
+
+static size_t distinct_lines(const char *text, size_t len) {
+    char *a = (char *)malloc(len + 1);
+    if (!a) exit(1);
+    memcpy(a, text, len);
+    a[len] = '\0';
+    char **x;
+    const size_t n = sorted_lines(a, len, &x);
+    size_t d = n > 0;
+    for (size_t i = 1; i < n; i++) d += strcmp(x[i - 1], x[i]) != 0;
+    free(x);
+    free(a);
+    return d;
+}
+
+static double run_op(LineOp op, int jobs, const char *text, size_t len, LineOpResult *r) {
+    LineOpArgs args = { op, 2, 4, jobs };
+    const double t = now_sec();
+    if (!lo_run(&args, text, len, 1, r)) {
+        printf("out of memory\n");
+        exit(1);
+    }
+    return (now_sec() - t) * 1e3;
+}
+
+static void run(size_t lines) {
+    size_t len;
+    char *text = make_text(lines, &len);
+    int jobs = wofl_cpu_count();
+    if (jobs < 4) jobs = 4;
+    printf("  %zu lines, %.1f MB; 1 thread and %d\n", lines, (double)len / (1 << 20), jobs);
+
+    for (int op = 0; op < LO_COUNT; op++) {
+        LineOpResult one, many;
+        const double t_one = run_op((LineOp)op, 1, text, len, &one);
+        const double t_many = run_op((LineOp)op, jobs, text, len, &many);
+        const bool same = one.len == many.len && memcmp(one.text, many.text, one.len) == 0;
+        const char *check = "";
+        if (op == LO_SORT) check = matches_qsort(text, len, &one) ? ", sorted as qsort" : ", NOT SORTED";
+        if (op == LO_UNIQUE) check = one.lines_out == distinct_lines(text, len) ? ", all distinct" : ", REPEATS LEFT";
+        printf("    %-30s %8.1f ms %8.1f ms  %zu -> %zu lines, edit of %.1f MB; %s%s\n", lo_name((LineOp)op),
+               t_one, t_many, one.lines_in, one.lines_out,
+               (double)(one.len - one.keep_head - one.keep_tail) / (1 << 20),
+               same ? "same text" : "TEXT DIFFERS", check);
+        lo_result_free(&one);
+        lo_result_free(&many);
+    }
+    free(text);
+}
+
+int main(int argc, char **argv) {
+    printf("bench_line_ops: split, operate and write\n");
+    run(argc > 1 ? (size_t)atoll(argv[1]) : 1000000);
+    return 0;
+}
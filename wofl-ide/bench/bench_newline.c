@@ -0,0 +1,186 @@
+// ==================== bench_newline.c ====================
+// Throughput of the newline kernels (count / find-nth / find-last) per ISA
+//
+// Each ISA's kernels are first checked against a plain loop, on windows of
+// every alignment and ragged length and on the whole text; any mismatch
+// ends the bench with exit status 1.
+
+#define _POSIX_C_SOURCE 199309L
+#include "newline_scan.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+static double now_sec(void) {
+    LARGE_INTEGER f, t;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&t);
+    return (double)t.QuadPart / (double)f.QuadPart;
+}
+#else
+#include <time.h>
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+#endif
+
+#define BENCH_BYTES   (256u << 20)
+#define BENCH_REPEAT  5
+
+static volatile size_t g_sink;
+
+/**
+ * Source-like text: lines of 0..79 characters
+ */
+static void fill_text(void *buf, size_t n, int unit) {
+    uint32_t seed = 12345;
+    size_t col = 0, width = 40;
+    for (size_t i = 0; i < n; i++) {
+        seed = seed * 1103515245u + 12345u;
+        unsigned ch = 'a' + (seed >> 16) % 26;
+        if (++col >= width) {
+            ch = '\n';
+            col = 0;
+            width = (seed >> 8) % 80 + 1;
+        }
+        if (unit == 1) ((uint8_t *)buf)[i] = (uint8_t)ch;
+        else           ((uint16_t *)buf)[i] = (uint16_t)ch;
+    }
+}
+
+// ===== Checks =====
+
+#define CHECK_WINDOWS   4096
+
+static bool is_nl(const void *p, size_t i, int unit) {
+    return unit == 1 ? ((const uint8_t *)p)[i] == '\n' : ((const uint16_t *)p)[i] == '\n';
+}
+
+static size_t ref_count(const void *p, size_t n, int unit) {
+    size_t total = 0;
+    for (size_t i = 0; i < n; i++) total += is_nl(p, i, unit);
+    return total;
+}
+
+static size_t ref_find_nth(const void *p, size_t n, int unit, size_t *k) {
+    if (n == 0 || *k == 0) return n;
+    for (size_t i = 0; i < n; i++) {
+        if (is_nl(p, i, unit) && --*k == 0) return i;
+    }
+    return n;
+}
+
+static size_t ref_find_last(const void *p, size_t n, int unit) {
+    while (n > 0) {
+        if (is_nl(p, --n, unit)) return n;
+    }
+    return NL_NONE;
+}
+
+static void fail(const char *op, int unit, size_t off, size_t n) {
+    printf("  MISMATCH: %s u%d at offset %zu, %zu units, %s\n", op, unit * 8, off, n, nl_isa_name(nl_isa()));
+    exit(1);
+}
+
+// The selected kernels against the plain loops; lines is the text's count
+static void check_isa(const void *text, size_t n, int unit, size_t lines) {
+    uint32_t seed = 777;
+    if (nl_count(text, n, unit) != lines) fail("count", unit, 0, n);
+    for (int w = 0; w < CHECK_WINDOWS; w++) {
+        seed = seed * 1103515245u + 12345u;
+        const size_t off = (seed >> 8) % 67;
+        const size_t len = w < 300 ? (size_t)w : (seed >> 4) % 3000;
+        const void *p = (const char *)text + off * (size_t)unit;
+        const size_t c = ref_count(p, len, unit);
+        if (nl_count(p, len, unit) != c) fail("count", unit, off, len);
+        if (nl_find_last(p, len, unit) != ref_find_last(p, len, unit)) fail("find_last", unit, off, len);
+        for (size_t k0 = 1; k0 <= c + 1; k0 += c / 4 + 1) {
+            size_t k = k0, rk = k0;
+            if (nl_find_nth(p, len, unit, &k) != ref_find_nth(p, len, unit, &rk) || k != rk) {
+                fail("find_nth", unit, off, len);
+            }
+        }
+    }
+}
+
+static void report(const char *op, int unit, double secs, size_t bytes) {
+    printf("  %-10s u%-2d %8.2f GB/s\n", op, unit * 8, (double)bytes / secs / 1e9);
+}
+
+static void bench_isa(NlIsa isa, const void *text8, const void *text16, size_t units8) {
+    nl_set_isa(isa);
+    printf("%s\n", nl_isa_name(nl_isa()));
+
+    for (int unit = 1; unit <= 2; unit++) {
+        const void *text = unit == 1 ? text8 : text16;
+        const size_t n = units8 / (size_t)unit;
+        const size_t bytes = n * (size_t)unit;
+        const size_t lines = ref_count(text, n, unit);
+        double best;
+        check_isa(text, n, unit, lines);
+
+        best = 1e9;
+        for (int r = 0; r < BENCH_REPEAT; r++) {
+            double t0 = now_sec();
+            g_sink = nl_count(text, n, unit);
+            double dt = now_sec() - t0;
+            if (dt < best) best = dt;
+        }
+        report("count", unit, best, bytes);
+
+        best = 1e9;
+        for (int r = 0; r < BENCH_REPEAT; r++) {
+            size_t k = lines;  // the last newline: a full pass
+            double t0 = now_sec();
+            g_sink = nl_find_nth(text, n, unit, &k);
+            double dt = now_sec() - t0;
+            if (dt < best) best = dt;
+        }
+        report("find_nth", unit, best, bytes);
+
+        // find_last stops at the first hit; make it walk the whole buffer
+        // by searching a copy with its newlines stripped
+        best = 1e9;
+        void *flat = malloc(bytes);
+        if (flat) {
+            memcpy(flat, text, bytes);
+            for (size_t i = 0; i < n; i++) {
+                if (unit == 1 && ((uint8_t *)flat)[i] == '\n')  ((uint8_t *)flat)[i] = ' ';
+                if (unit == 2 && ((uint16_t *)flat)[i] == '\n') ((uint16_t *)flat)[i] = ' ';
+            }
+            for (int r = 0; r < BENCH_REPEAT; r++) {
+                double t0 = now_sec();
+                g_sink = nl_find_last(flat, n, unit);
+                double dt = now_sec() - t0;
+                if (dt < best) best = dt;
+            }
+            free(flat);
+            report("find_last", unit, best, bytes);
+        }
+    }
+}
+
+int main(void) {
+    void *text8 = malloc(BENCH_BYTES);
+    void *text16 = malloc(BENCH_BYTES);
+    if (!text8 || !text16) {
+        fprintf(stderr, "bench_newline: out of memory\n");
+        return 1;
+    }
+    fill_text(text8, BENCH_BYTES, 1);
+    fill_text(text16, BENCH_BYTES / 2, 2);
+
+    printf("bench_newline: %u MB per pass, best of %d\n", BENCH_BYTES >> 20, BENCH_REPEAT);
+    const NlIsa best = nl_isa_max();
+    for (int isa = NL_ISA_SCALAR; isa <= (int)best; isa++) {
+        bench_isa((NlIsa)isa, text8, text16, BENCH_BYTES);
+    }
+
+    free(text8);
+    free(text16);
+    return 0;
+}
@@ -0,0 +1,208 @@
+// ==================== bench_palette.c ====================
+// Command palette: thousands of entries, and the cost of one keystroke
+//
+//   bench_palette            2k, 5k and 20k entries
+//   bench_palette N          N entries
+//
+// The entries come as the editor's do: a few dozen commands, the open file,
+// recent files, plugin commands and many workspace paths, all collected on
+// opening; and 32 symbols added again for every query, as the symbol index
+// source does. Queries abbreviate entries and are typed a character at a
+// time; every keystroke is timed as typed, narrowing the last matches, and
+// again ranking the whole palette afresh.
+
+#define _POSIX_C_SOURCE 199309L
+#include "palette.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+static double now_sec(void) {
+    LARGE_INTEGER f, t;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&t);
+    return (double)t.QuadPart / (double)f.QuadPart;
+}
+#else
+#include <time.h>
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+#endif
+
+#define BENCH_QUERIES   300
+#define BENCH_SEED      0x9E3779B9u
+#define BENCH_SYMBOLS   32
+
+static const char *const g_verbs[] = {
+    "Open", "Save", "Find", "Go to", "Toggle", "Run", "Fold", "Unfold", "Close", "Show",
+    "Hide", "Select", "Copy", "Sort", "Join", "Split", "Format", "Rename", "Reload", "Set"
+};
+static const char *const g_words[] = {
+    "buffer", "line", "token", "cursor", "state", "block", "index", "frame", "glyph", "node",
+    "entry", "range", "span", "table", "cache", "path", "event", "theme", "view", "caret",
+    "file", "finder", "window", "input", "render", "layout", "font", "syntax", "lexer", "scan"
+};
+static const char *const g_dirs[] = {
+    "src", "lib", "include", "test", "docs", "tools", "core", "ui", "render", "editor",
+    "platform", "linux", "win32", "common", "util", "io", "parser", "plugins", "api", "internal"
+};
+static const char *const g_exts[] = { ".c", ".h", ".cpp", ".py", ".md", ".json" };
+#define COUNT(a) ((uint32_t)(sizeof(a) / sizeof((a)[0])))
+
+static uint32_t xorshift(uint32_t *s) {
+    uint32_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *s = x;
+}
+
+typedef struct {
+    int      entries;
+    uint32_t seed;
+} BenchCtx;
+
+static const char *pick(const char *const *list, uint32_t n, uint32_t *seed) {
+    return list[xorshift(seed) % n];
+}
+
+// Commands and plugin commands: "Verb Word Word"
+static void collect_commands(PaletteSource *self, Palette *p, const char *query) {
+    BenchCtx *ctx = (BenchCtx *)self->ctx;
+    uint32_t seed = ctx->seed;
+    char label[PAL_LABEL_MAX];
+    (void)query;
+    for (int i = 0; i < ctx->entries / 10; i++) {
+        snprintf(label, sizeof(label), "%s %s %s", pick(g_verbs, COUNT(g_verbs), &seed),
+                 pick(g_words, COUNT(g_words), &seed), pick(g_words, COUNT(g_words), &seed));
+        pal_add(p, label, "Ctrl+Shift+K", i);
+    }
+}
+
+// The rest are files: "dir/dir/word_word_N.ext"
+static void collect_files(PaletteSource *self, Palette *p, const char *query) {
+    BenchCtx *ctx = (BenchCtx *)self->ctx;
+    uint32_t seed = ctx->seed ^ 0x5bd1e995u;
+    char path[PAL_PATH_MAX];
+    (void)query;
+    for (int i = 0; i < ctx->entries - ctx->entries / 10; i++) {
+        int len = 0;
+        const int depth = 1 + (int)(xorshift(&seed) % 4);
+        for (int d = 0; d < depth; d++) {
+            len += snprintf(path + len, sizeof(path) - (size_t)len, "%s/", pick(g_dirs, COUNT(g_dirs), &seed));
+        }
+        snprintf(path + len, sizeof(path) - (size_t)len, "%s_%s_%u%s", pick(g_words, COUNT(g_words), &seed),
+                 pick(g_words, COUNT(g_words), &seed), xorshift(&seed) % 100, pick(g_exts, COUNT(g_exts), &seed));
+        pal_add_path(p, path, "", i);
+    }
+}
+
+// Symbols: the best few for each query, as six_query() would give them
+static void collect_symbols(PaletteSource *self, Palette *p, const char *query) {
+    char label[PAL_LABEL_MAX];
+    (void)self;
+    if (!query || !query[0]) return;
+    for (int i = 0; i < BENCH_SYMBOLS; i++) {
+        snprintf(label, sizeof(label), "%s_%s_%d", query, g_words[i % COUNT(g_words)], i);
+        pal_add(p, label, "function  src/editor/buffer_line_12.c:120", i);
+    }
+}
+
+static int cmp_double(const void *a, const void *b) {
+    const double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void report(const char *what, double *times, int n) {
+    qsort(times, (size_t)n, sizeof(double), cmp_double);
+    printf("    %-8s %8.3f ms p50 %8.3f ms p99 %8.3f ms max\n", what, times[n / 2], times[n * 99 / 100], times[n - 1]);
+}
+
+// One keystroke as typed, then again with nothing kept from the last
+static int keystroke(Palette *pal, const char *query, double *typed, double *fresh, int *differ) {
+    PaletteHit hits[PAL_HITS];
+    double t = now_sec();
+    const int n = pal_filter(pal, query);
+    *typed = (now_sec() - t) * 1e3;
+    memcpy(hits, pal->hits, sizeof(hits));
+
+    pal->matched_valid = false;
+    t = now_sec();
+    const int m = pal_filter(pal, query);
+    *fresh = (now_sec() - t) * 1e3;
+    *differ += n != m || memcmp(hits, pal->hits, (size_t)n * sizeof(PaletteHit)) != 0;
+    return n;
+}
+
+static void run(int entries) {
+    Palette pal;
+    BenchCtx ctx = { entries, BENCH_SEED };
+    PaletteSource commands = { "commands", PAL_COMMAND, false, collect_commands, NULL, &ctx };
+    PaletteSource files = { "files", PAL_RECENT, false, collect_files, NULL, &ctx };
+    PaletteSource symbols = { "symbols", PAL_SYMBOL, true, collect_symbols, NULL, &ctx };
+    pal_init(&pal);
+    pal_register(&pal, &commands);
+    pal_register(&pal, &files);
+    pal_register(&pal, &symbols);
+
+    double t = now_sec();
+    pal_open(&pal);
+    const double open_ms = (now_sec() - t) * 1e3;
+
+    // Queries: the word starts of an entry and a character or two after
+    // some, typed out with a backspace now and then
+    const int max_keys = BENCH_QUERIES * 24;
+    double *times = (double *)malloc((size_t)max_keys * sizeof(double));
+    double *fresh = (double *)malloc((size_t)max_keys * sizeof(double));
+    if (!times || !fresh) return;
+    uint32_t seed = BENCH_SEED ^ (uint32_t)entries;
+    int keys = 0, found = 0, differ = 0;
+    for (int q = 0; q < BENCH_QUERIES; q++) {
+        const PaletteEntry *e = &pal.entries[xorshift(&seed) % pal.fixed];
+        const char *label = pal_label(&pal, e) + e->base;
+        char full[32];
+        int n = 0;
+        for (int k = 0; label[k] && n < (int)sizeof(full) - 1; k++) {
+            const bool start = k == 0 || label[k - 1] == ' ' || label[k - 1] == '_' || label[k - 1] == '.';
+            if (start || (n > 0 && xorshift(&seed) % 4 == 0 && label[k] != ' ' && label[k] != '_')) full[n++] = label[k];
+        }
+        full[n] = '\0';
+
+        char typed[PAL_QUERY_MAX];
+        for (int k = 1; k <= n && keys + 2 < max_keys; k++) {
+            if (k > 2 && xorshift(&seed) % 8 == 0) {
+                snprintf(typed, sizeof(typed), "%.*s%c", k - 1, full, 'a' + (int)(xorshift(&seed) % 26));
+                keystroke(&pal, typed, &times[keys], &fresh[keys], &differ);
+                keys++;
+            }
+            snprintf(typed, sizeof(typed), "%.*s", k, full);
+            found += keystroke(&pal, typed, &times[keys], &fresh[keys], &differ) > 0;
+            keys++;
+        }
+    }
+
+    printf("  %u entries, opened in %.3f ms; %d keystrokes, %d with hits, %d where narrowing ranked otherwise\n",
+           pal.fixed, open_ms, keys, found, differ);
+    report("typed", times, keys);
+    report("fresh", fresh, keys);
+    free(times);
+    free(fresh);
+    pal_free(&pal);
+}
+
+int main(int argc, char **argv) {
+    printf("bench_palette:\n");
+    if (argc > 1) {
+        run(atoi(argv[1]));
+    } else {
+        run(2000);
+        run(5000);
+        run(20000);
+    }
+    return 0;
+}
@@ -0,0 +1,115 @@
+// ==================== bench_samples.h ====================
+// Representative source per language, shared by the scanner benchmarks
+
+#ifndef WOFL_BENCH_SAMPLES_H
+#define WOFL_BENCH_SAMPLES_H
+
+#include "syntax_defs.h"
+
+// A few representative lines per language; benchmarks repeat them to size
+static const char *bench_samples[LANG_MAX] = {
+    [LANG_NONE] =
+        "The quick brown fox jumps over the lazy dog, again and again.\n"
+        "Plain text is one span per line whatever it holds.\n",
+    [LANG_C] =
+        "#include <stdio.h>\n"
+        "/* Count the lines of a buffer,\n"
+        "   one byte at a time */\n"
+        "static size_t count_lines(const char *p, size_t n) {\n"
+        "    size_t lines = 0;\n"
+        "    for (size_t i = 0; i < n; i++) {\n"
+        "        if (p[i] == '\\n') lines++;   // newline\n"
+        "    }\n"
+        "    printf(\"%zu lines\\n\", lines);\n"
+        "    return lines + 0x10;\n"
+        "}\n",
+    [LANG_CPP] =
+        "template <typename T>\n"
+        "class Buffer : public Base {\n"
+        "public:\n"
+        "    explicit Buffer(std::size_t n) : data_(std::make_unique<T[]>(n)) {}\n"
+        "    auto size() const noexcept -> std::size_t { return size_; }\n"
+        "    static constexpr auto kName = R\"(raw \"string\")\";\n"
+        "private:\n"
+        "    std::unique_ptr<T[]> data_;  // owned\n"
+        "};\n",
+    [LANG_ASM] =
+        "section .text\n"
+        "global _start\n"
+        "_start:\n"
+        "    mov rax, 60        ; exit\n"
+        "    xor edi, edi\n"
+        "    lea rsi, [rbx+0x10]\n"
+        "    syscall\n",
+    [LANG_CSV] =
+        "id,name,score,comment\n"
+        "1,\"Smith, J\",87.5,\"ok\"\n"
+        "2,Jones,91,\n",
+    [LANG_PY] =
+        "import os\n"
+        "def walk(root, depth=0):\n"
+        "    \"\"\"Yield files under root,\n"
+        "    depth first.\"\"\"\n"
+        "    for name in sorted(os.listdir(root)):  # stable order\n"
+        "        if name.startswith('.'):\n"
+        "            continue\n"
+        "        yield os.path.join(root, name), depth + 1\n",
+    [LANG_JS] =
+        "export async function load(url, opts = {}) {\n"
+        "    const res = await fetch(url, { ...opts, cache: 'no-store' });\n"
+        "    /* retry once */\n"
+        "    if (!res.ok) return null;\n"
+        "    return `${res.status}: ${await res.text()}`; // done\n"
+        "}\n",
+    [LANG_HTML] =
+        "<!DOCTYPE html>\n"
+        "<html><head><title>Page</title></head>\n"
+        "<body class=\"main\"><p>Hello <b>world</b></p></body></html>\n",
+    [LANG_CSS] =
+        "/* layout */\n"
+        "@media (max-width: 600px) {\n"
+        "    .nav > a:hover { color: #ff0; margin: 0 .5em !important; }\n"
+        "}\n"
+        "body { font: 14px/1.4 \"Fira Code\", monospace; }\n",
+    [LANG_JSON] =
+        "{\n"
+        "    \"name\": \"wofl\", \"version\": 3, \"ratio\": -1.5e3,\n"
+        "    \"tags\": [\"editor\", \"fast\"], \"debug\": false, \"parent\": null\n"
+        "}\n",
+    [LANG_MD] =
+        "# Heading\n"
+        "Some *emphasis* and `code` in a paragraph.\n"
+        "- a list item\n",
+    [LANG_GO] =
+        "package main\n"
+        "func sum(xs []int64) (total int64) {\n"
+        "    for _, x := range xs { // accumulate\n"
+        "        total += x\n"
+        "    }\n"
+        "    fmt.Println(`raw`, \"total\", total)\n"
+        "    return\n"
+        "}\n",
+    [LANG_RS] =
+        "#[derive(Debug)]\n"
+        "pub fn longest<'a>(a: &'a str, b: &'a str) -> &'a str {\n"
+        "    let c = 'x';  // char\n"
+        "    if a.len() >= b.len() { a } else { b }\n"
+        "}\n"
+        "println!(\"{:?}\", Some(42u32));\n",
+    [LANG_SH] =
+        "#!/bin/sh\n"
+        "for f in \"$@\"; do\n"
+        "    if [ -f \"${f%.txt}.bak\" ]; then\n"
+        "        echo \"skip $f\"   # already done\n"
+        "    fi\n"
+        "done\n",
+    [LANG_LUA] =
+        "local function fib(n)\n"
+        "    --[[ naive\n"
+        "         recursion ]]\n"
+        "    if n < 2 then return n end\n"
+        "    return fib(n - 1) + fib(n - 2) -- tail\n"
+        "end\n",
+};
+
+#endif // WOFL_BENCH_SAMPLES_H
@@ -0,0 +1,187 @@
+// ==================== bench_symbols.c ====================
+// Workspace symbol index: indexing, the saved index and query latency
+//
+//   bench_symbols              about a million definitions of generated C
+//   bench_symbols FILE...      the given files, language picked by name
+//
+// Generated files go through the scanners and the outline like workspace
+// files do. The table is saved and loaded back, then prefix and fuzzy
+// queries are timed against it.
+
+#define _POSIX_C_SOURCE 199309L
+#include "symbol_index.h"
+#include "lang_registry.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+static double now_sec(void) {
+    LARGE_INTEGER f, t;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&t);
+    return (double)t.QuadPart / (double)f.QuadPart;
+}
+#else
+#include <time.h>
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+#endif
+
+#define BENCH_FILES     2000
+#define BENCH_DEFS      500         // definitions per generated file
+#define BENCH_REPEAT    20
+#define BENCH_SEED      0x2545F491u
+#define BENCH_MAX_HITS  50
+#define BENCH_SAVED     "bench_symbols.idx"
+
+static const char *const g_verbs[] = {
+    "get", "set", "read", "write", "parse", "emit", "find", "load", "save", "init",
+    "free", "push", "pop", "scan", "match", "draw", "build", "merge", "split", "apply"
+};
+static const char *const g_nouns[] = {
+    "buffer", "line", "token", "cursor", "state", "block", "index", "frame", "glyph", "node",
+    "entry", "range", "span", "table", "cache", "path", "event", "theme", "view", "caret"
+};
+#define NWORDS(a) ((int)(sizeof(a) / sizeof((a)[0])))
+
+static uint32_t xorshift(uint32_t *s) {
+    uint32_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *s = x;
+}
+
+// One generated source file: structs with a few members, then functions,
+// a few of them static helpers with a body several lines long
+static size_t generate_file(char *out, size_t cap, int file, uint32_t *seed) {
+    size_t n = 0;
+    for (int d = 0; d < BENCH_DEFS && n + 256 < cap; d++) {
+        const char *verb = g_verbs[xorshift(seed) % NWORDS(g_verbs)];
+        const char *noun = g_nouns[xorshift(seed) % NWORDS(g_nouns)];
+        const unsigned tag = xorshift(seed) % 100000;
+        if (d % 25 == 0) {
+            n += (size_t)snprintf(out + n, cap - n, "typedef struct %c%s%u {\n    int %s;\n    char *%s_text;\n} %s_t%d;\n\n",
+                                  noun[0] - 32, noun + 1, tag, verb, noun, noun, file);
+        } else if (d % 7 == 0) {
+            n += (size_t)snprintf(out + n, cap - n, "static int %s_%s_%u(const char *s, int n) {\n"
+                                  "    int k = 0;\n    for (int i = 0; i < n; i++) {\n        k += s[i] == '{';\n    }\n"
+                                  "    return k; /* } */\n}\n\n", verb, noun, tag);
+        } else {
+            n += (size_t)snprintf(out + n, cap - n, "int %s%c%s%u(void) { return \"%s\"[0]; }\n",
+                                  verb, noun[0] - 32, noun + 1, tag, noun);
+        }
+    }
+    return n;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    const double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void time_query(const SymbolTable *t, const char *query) {
+    SymbolMatch hits[BENCH_MAX_HITS];
+    double times[BENCH_REPEAT];
+    int count = 0;
+    for (int r = 0; r < BENCH_REPEAT; r++) {
+        const double t0 = now_sec();
+        count = si_query(t, query, hits, BENCH_MAX_HITS);
+        times[r] = (now_sec() - t0) * 1e3;
+    }
+    qsort(times, BENCH_REPEAT, sizeof(double), cmp_double);
+    const char *best = count ? si_string(&t->names, t->defs[hits[0].def].name) : "-";
+    printf("  %-14s %6d %9.3f %9.3f   %s\n", query, count, times[BENCH_REPEAT / 2], times[BENCH_REPEAT - 1], best);
+}
+
+static bool add_text(SymbolTable *t, const char *path, const char *text, size_t len) {
+    const uint32_t file = si_add_file(t, path, 0, len);
+    return file != UINT32_MAX && si_scan_text(t, file, lang_detect(path, text, len), text, len);
+}
+
+int main(int argc, char **argv) {
+    SymbolTable t;
+    si_init(&t);
+    size_t bytes = 0;
+    const double t0 = now_sec();
+
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            FILE *f = fopen(argv[i], "rb");
+            if (!f) {
+                fprintf(stderr, "bench_symbols: cannot read %s\n", argv[i]);
+                continue;
+            }
+            fseek(f, 0, SEEK_END);
+            const long size = ftell(f);
+            fseek(f, 0, SEEK_SET);
+            char *text = (char *)malloc(size > 0 ? (size_t)size : 1);
+            const size_t len = text ? fread(text, 1, (size_t)(size > 0 ? size : 0), f) : 0;
+            fclose(f);
+            if (text && !add_text(&t, argv[i], text, len)) fprintf(stderr, "bench_symbols: out of memory\n");
+            bytes += len;
+            free(text);
+        }
+    } else {
+        const size_t cap = (size_t)BENCH_DEFS * 256;
+        char *text = (char *)malloc(cap);
+        uint32_t seed = BENCH_SEED;
+        if (!text) return 1;
+        for (int i = 0; i < BENCH_FILES; i++) {
+            char path[64];
+            snprintf(path, sizeof(path), "src/mod%02d/file%04d.c", i % 40, i);
+            const size_t len = generate_file(text, cap, i, &seed);
+            if (!add_text(&t, path, text, len)) {
+                fprintf(stderr, "bench_symbols: out of memory\n");
+                return 1;
+            }
+            bytes += len;
+        }
+        free(text);
+    }
+    const double t1 = now_sec();
+    if (!si_finish(&t)) return 1;
+    const double t2 = now_sec();
+
+    printf("bench_symbols: %u files, %.1f MB, %u definitions, %u distinct names\n",
+           t.nfiles, (double)bytes / 1e6, t.ndefs, t.names.count);
+    printf("  scan %8.1f ms (%.1f MB/s)\n", (t1 - t0) * 1e3, (double)bytes / 1e6 / (t1 - t0));
+    printf("  sort %8.1f ms\n", (t2 - t1) * 1e3);
+
+    // The saved index, and loading it back as the next start would
+    SymbolTable loaded;
+    si_init(&loaded);
+    const double s0 = now_sec();
+    const bool saved = si_save(&t, BENCH_SAVED);
+    const double s1 = now_sec();
+    const bool ok = saved && si_load(&loaded, BENCH_SAVED) && si_finish(&loaded) &&
+                    loaded.ndefs == t.ndefs && loaded.names.count == t.names.count;
+    const double s2 = now_sec();
+    FILE *f = fopen(BENCH_SAVED, "rb");
+    long size = 0;
+    if (f) {
+        fseek(f, 0, SEEK_END);
+        size = ftell(f);
+        fclose(f);
+    }
+    remove(BENCH_SAVED);
+    printf("  save %8.1f ms, %.1f MB (%.1f bytes per definition)\n", (s1 - s0) * 1e3, (double)size / 1e6,
+           t.ndefs ? (double)size / t.ndefs : 0.0);
+    printf("  load %8.1f ms%s\n", (s2 - s1) * 1e3, ok ? "" : "  FAILED");
+
+    printf("\n  %-14s %6s %9s %9s   %s\n", "query", "hits", "p50 ms", "max ms", "best");
+    static const char *const queries[] = {
+        "g", "get", "parseNode", "parse_line_", "Buffer", "prsnd", "gtcrs", "drwglph12", "wrtchc",
+        "stbfr9", "qqq", "zzzzzzzz"
+    };
+    for (int i = 0; i < NWORDS(queries); i++) time_query(&loaded, queries[i]);
+
+    si_free(&t);
+    si_free(&loaded);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,622 @@
+// ==================== bench_syntax.c ====================
+// Per-language scanner benchmark: throughput, allocations, line latency
+//
+//   bench_syntax              corpora generated from the built-in samples
+//   bench_syntax FILE...      the given files, language picked by name
+//
+// Every registered scan_line entry point is timed over its corpus. Built
+// with BENCH_WORKER (the SDL port's Makefile does), the background
+// highlighter is timed too: how long until the first screen has tokens
+// and how long the sweep over the whole file takes. Allocations are
+// counted when the link wraps malloc (BENCH_WRAP_ALLOC).
+//
+// Before the highlighter is timed on a corpus, its results are checked
+// against lexing the corpus straight through: the end state of every line,
+// the tokens of the first screen and the brackets matched through the
+// depth index, which must be those a walk line by line finds. The same
+// again on a copy of the corpus after rounds of edits, which the index,
+// states and outline follow rather than starting over; the outline must
+// then be the one a fresh highlighter finds. A difference ends the bench
+// with exit status 1.
+
+#define _POSIX_C_SOURCE 199309L
+#include "lang_registry.h"
+#include "lexer.h"
+#include "bench_samples.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef BENCH_WORKER
+#include "highlight.h"
+#endif
+
+#ifdef _WIN32
+#include <windows.h>
+static double now_sec(void) {
+    LARGE_INTEGER f, t;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&t);
+    return (double)t.QuadPart / (double)f.QuadPart;
+}
+static void nap(void) { Sleep(0); }
+#else
+#include <time.h>
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+static void nap(void) {
+    struct timespec ts = { 0, 100000 };
+    nanosleep(&ts, NULL);
+}
+#endif
+
+#define BENCH_CHARS   (8u << 20)
+#define BENCH_REPEAT  5
+#define BENCH_SEED    0x2545F491u
+#define BENCH_SCREEN  50            // lines the worker must finish first
+#define BENCH_BUCKETS 8             // latency buckets: < 0.25 us, doubling
+#define CHECK_MATCHES 64            // brackets matched per check
+#define CHECK_WALK    4096          // lines a match is looked for line by line
+#define CHECK_ROUNDS  4             // rounds of edits
+#define CHECK_EDITS   8             // edits per round
+
+static volatile size_t g_sink;
+
+// ===== Allocation counting =====
+
+#ifdef BENCH_WRAP_ALLOC
+void *__real_malloc(size_t n);
+void *__real_calloc(size_t k, size_t n);
+void *__real_realloc(void *p, size_t n);
+
+static size_t g_allocs;
+
+void *__wrap_malloc(size_t n) {
+    __atomic_fetch_add(&g_allocs, 1, __ATOMIC_RELAXED);
+    return __real_malloc(n);
+}
+
+void *__wrap_calloc(size_t k, size_t n) {
+    __atomic_fetch_add(&g_allocs, 1, __ATOMIC_RELAXED);
+    return __real_calloc(k, n);
+}
+
+void *__wrap_realloc(void *p, size_t n) {
+    __atomic_fetch_add(&g_allocs, 1, __ATOMIC_RELAXED);
+    return __real_realloc(p, n);
+}
+
+static long allocs(void) { return (long)__atomic_load_n(&g_allocs, __ATOMIC_RELAXED); }
+#else
+static long allocs(void) { return -1; }
+#endif
+
+// ===== Corpora =====
+
+typedef struct {
+    const char *name;
+    Language lang;
+    char *bytes;                // lines as on disk, each ending in '\n'
+    wchar_t *text;              // the same, widened
+    size_t *starts;             // line i is [starts[i], starts[i + 1] - 1)
+    size_t lines;
+    size_t chars;
+} Corpus;
+
+static uint32_t xorshift(uint32_t *s) {
+    *s ^= *s << 13;
+    *s ^= *s >> 17;
+    *s ^= *s << 5;
+    return *s;
+}
+
+static bool index_corpus(Corpus *c) {
+    c->lines = 0;
+    for (size_t i = 0; i < c->chars; i++) c->lines += c->bytes[i] == '\n';
+    c->text = malloc((c->chars + 1) * sizeof(wchar_t));
+    c->starts = malloc((c->lines + 1) * sizeof(size_t));
+    if (!c->text || !c->starts) return false;
+
+    size_t line = 0;
+    for (size_t i = 0; i < c->chars; i++) {
+        if (i == 0 || c->bytes[i - 1] == '\n') c->starts[line++] = i;
+        c->text[i] = (unsigned char)c->bytes[i];
+    }
+    c->starts[c->lines] = c->chars;
+    return true;
+}
+
+/**
+ * The sample repeated to BENCH_CHARS. Each copy gets its own indentation
+ * and digits from a fixed seed, so lines and numbers vary the way real
+ * files do but every run scans the same bytes.
+ */
+static bool generate_corpus(Language lang, Corpus *c) {
+    const char *sample = bench_samples[lang];
+    const size_t len = strlen(sample);
+    uint32_t seed = BENCH_SEED ^ (uint32_t)lang;
+
+    c->name = lang_info(lang)->name;
+    c->lang = lang;
+    // A copy grows by at most 8 spaces per line
+    c->bytes = malloc(BENCH_CHARS + len * 9);
+    if (!c->bytes) return false;
+
+    size_t at = 0;
+    while (at < BENCH_CHARS) {
+        int indent = (int)(xorshift(&seed) % 3) * 4;
+        for (size_t i = 0; i < len; i++) {
+            if ((i == 0 || sample[i - 1] == '\n') && lang != LANG_CSV) {
+                for (int k = 0; k < indent; k++) c->bytes[at++] = ' ';
+            }
+            char ch = sample[i];
+            if (ch >= '1' && ch <= '9') ch = (char)('1' + xorshift(&seed) % 9);
+            c->bytes[at++] = ch;
+        }
+    }
+    c->chars = at;
+    return index_corpus(c);
+}
+
+static bool load_corpus(const char *path, Corpus *c) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (size < 0) {
+        fclose(f);
+        return false;
+    }
+
+    c->bytes = malloc((size_t)size + 1);
+    if (!c->bytes) {
+        fclose(f);
+        return false;
+    }
+    c->chars = fread(c->bytes, 1, (size_t)size, f);
+    fclose(f);
+    if (c->chars == 0 || c->bytes[c->chars - 1] != '\n') c->bytes[c->chars++] = '\n';
+
+    const char *name = strrchr(path, '/');
+    c->name = name ? name + 1 : path;
+    c->lang = lang_detect(path, c->bytes, c->chars);
+    return index_corpus(c);
+}
+
+// A copy to edit, with room for lines added by the edits
+static bool copy_corpus(const Corpus *c, Corpus *copy) {
+    *copy = *c;
+    copy->bytes = malloc(c->chars);
+    if (!copy->bytes) return false;
+    memcpy(copy->bytes, c->bytes, c->chars);
+    if (!index_corpus(copy)) return false;
+    size_t *starts = realloc(copy->starts, (copy->lines + 1 + CHECK_ROUNDS * CHECK_EDITS) * sizeof(size_t));
+    if (!starts) return false;
+    copy->starts = starts;
+    return true;
+}
+
+static void free_corpus(Corpus *c) {
+    free(c->bytes);
+    free(c->text);
+    free(c->starts);
+}
+
+static const wchar_t *corpus_line(const Corpus *c, size_t i, int *len) {
+    *len = (int)(c->starts[i + 1] - c->starts[i] - 1);
+    return c->text + c->starts[i];
+}
+
+// ===== Scanners =====
+
+typedef struct {
+    double best;                // seconds for one pass
+    size_t tokens;
+    long allocs;                // per pass, -1 if not counted
+    size_t buckets[BENCH_BUCKETS];
+    double p50, p99, worst;     // per-line latency, microseconds
+} ScanResult;
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return x < y ? -1 : x > y;
+}
+
+// Best of BENCH_REPEAT whole passes, then one pass timing every line
+static void time_scan(const Syntax *sx, const Corpus *c, ScanResult *r) {
+    TokenSpan out[WOFL_MAX_TOKENS];
+    memset(r, 0, sizeof(*r));
+    r->best = 1e9;
+
+    for (int rep = 0; rep < BENCH_REPEAT; rep++) {
+        size_t count = 0;
+        long a0 = allocs();
+        double t0 = now_sec();
+        for (size_t i = 0; i < c->lines; i++) {
+            int len, n;
+            const wchar_t *line = corpus_line(c, i, &len);
+            sx->scan_line(line, len, out, &n);
+            count += (size_t)n;
+        }
+        double dt = now_sec() - t0;
+        r->allocs = a0 < 0 ? -1 : allocs() - a0;
+        if (dt < r->best) r->best = dt;
+        r->tokens = count;
+    }
+    g_sink = r->tokens;
+
+    // The timer's own cost comes off every sample
+    double overhead = 1e9;
+    for (int k = 0; k < 1000; k++) {
+        double t0 = now_sec();
+        double dt = now_sec() - t0;
+        if (dt < overhead) overhead = dt;
+    }
+
+    double *lat = malloc(c->lines * sizeof(double));
+    if (!lat) return;
+    for (size_t i = 0; i < c->lines; i++) {
+        int len, n;
+        const wchar_t *line = corpus_line(c, i, &len);
+        double t0 = now_sec();
+        sx->scan_line(line, len, out, &n);
+        double us = (now_sec() - t0 - overhead) * 1e6;
+        lat[i] = us > 0 ? us : 0;
+
+        int b = 0;
+        for (double edge = 0.25; b < BENCH_BUCKETS - 1 && lat[i] >= edge; edge *= 2) b++;
+        r->buckets[b]++;
+    }
+    qsort(lat, c->lines, sizeof(double), cmp_double);
+    r->p50 = lat[c->lines / 2];
+    r->p99 = lat[c->lines - 1 - c->lines / 100];
+    r->worst = lat[c->lines - 1];
+    free(lat);
+}
+
+// ===== Background highlighter =====
+
+#ifdef BENCH_WORKER
+static size_t worker_read(void *ctx, size_t line, char *out, size_t max) {
+    const Corpus *c = ctx;
+    size_t at = c->starts[line];
+    size_t len = c->starts[line + 1] - at - 1;
+    memcpy(out, c->bytes + at, len < max ? len : max);
+    return len;
+}
+
+static size_t worker_count(void *ctx) {
+    return ((const Corpus *)ctx)->lines;
+}
+
+static size_t screen_last(const Corpus *c) {
+    return c->lines < BENCH_SCREEN ? c->lines - 1 : BENCH_SCREEN - 1;
+}
+
+// Wait until the first BENCH_SCREEN lines have tokens and the sweep has
+// every line's end state and bracket depth; returns the seconds from t0
+// until the screen was ready
+static double wait_worker(Highlighter *hl, const Corpus *c, double t0) {
+    const size_t last = screen_last(c);
+    double screen = -1;
+    for (;;) {
+        if (screen < 0) {
+            size_t ready = 0;
+            while (ready <= last && hl_get(hl, ready)) ready++;
+            if (ready > last) screen = now_sec() - t0;
+        }
+        hl_lock(hl);
+        bool swept = hl->sweep >= c->lines;
+        hl_unlock(hl);
+        if (swept && screen >= 0) return screen;
+        hl_frame(hl, 0, 0, last);
+        nap();
+    }
+}
+
+// Seconds until the first BENCH_SCREEN lines have tokens, and until the
+// sweep is done; allocations over the whole run
+static void time_worker(const Syntax *sx, Corpus *c, double *screen, double *sweep, long *n_allocs) {
+    Highlighter hl;
+    hl_init(&hl);
+    hl_frame(&hl, 0, 0, screen_last(c));
+
+    long a0 = allocs();
+    double t0 = now_sec();
+    hl_start(&hl, sx, c->lang, (HlSource){ worker_read, worker_count, c });
+    *screen = wait_worker(&hl, c, t0);
+    *sweep = now_sec() - t0;
+    *n_allocs = a0 < 0 ? -1 : allocs() - a0;
+    hl_free(&hl);
+}
+
+// ===== Checks =====
+
+static void check_fail(const Corpus *c, const char *what, size_t line) {
+    printf("  %s: %s at line %zu\n", c->name, what, line + 1);
+    exit(1);
+}
+
+// Line i lexed in full from state, as the worker lexes the lines it keeps
+// tokens for; returns the state the next line starts in
+static uint16_t lex_direct(const Syntax *sx, const Corpus *c, size_t i, uint16_t state,
+                           FrameArena *fa, TokenSpan **spans, int *n) {
+    int len;
+    const wchar_t *line = corpus_line(c, i, &len);
+    if (!sx->lexer) {
+        *n = syntax_scan_window(sx, line, len, 0, 0, len, fa, spans);
+        return state;
+    }
+    *spans = fa_new(fa, TokenSpan, len + 2);
+    if (!*spans) check_fail(c, "out of memory", i);
+    return (uint16_t)lex_scan_range(sx->lexer, line, len, state, 0, len, *spans, len + 2, n);
+}
+
+static bool same_spans(const TokenSpan *a, const TokenSpan *b, int n) {
+    for (int k = 0; k < n; k++) {
+        if (a[k].start != b[k].start || a[k].len != b[k].len || a[k].cls != b[k].cls) return false;
+    }
+    return true;
+}
+
+// Every line's end state and the first screen's tokens, with the worker
+// swept; takes hl_lock
+static void check_tokens(Highlighter *hl, const Syntax *sx, const Corpus *c, FrameArena *fa) {
+    const size_t last = screen_last(c);
+    uint16_t state = 0;
+    hl_lock(hl);
+    if (hl->nstates < c->lines) check_fail(c, "NOT SWEPT", hl->nstates);
+    for (size_t i = 0; i < c->lines; i++) {
+        TokenSpan *spans;
+        int n;
+        const uint16_t in = state;
+        fa_reset(fa);
+        state = lex_direct(sx, c, i, state, fa, &spans, &n);
+        if (hl->states[i] != state) check_fail(c, "END STATE DIFFERS", i);
+        if (i > last) continue;
+        const HlLine *p = hl_get(hl, i);
+        if (!p || p->stale || p->in_state != in || p->count != n || !same_spans(p->spans, spans, n)) {
+            check_fail(c, "TOKENS DIFFER", i);
+        }
+    }
+    hl_unlock(hl);
+}
+
+/**
+ * The match of the bracket at column x of line i, walking the lines one by
+ * one for at most CHECK_WALK of them; ends holds every line's end state.
+ * False if it is not found in that many.
+ */
+static bool walk_match(const Syntax *sx, const Corpus *c, const uint16_t *ends, FrameArena *fa,
+                       size_t i, int x, int kind, bool open, size_t *ml, size_t *mc) {
+    int32_t need = 1;
+    for (size_t k = 0; k < CHECK_WALK; k++) {
+        if (open ? i + k >= c->lines : k > i) return false;
+        const size_t l = open ? i + k : i - k;
+        TokenSpan *spans;
+        int n, len;
+        const wchar_t *line = corpus_line(c, l, &len);
+        fa_reset(fa);
+        lex_direct(sx, c, l, l > 0 ? ends[l - 1] : 0, fa, &spans, &n);
+        int col = open ? bx_scan_forward(line, len, spans, n, kind, k == 0 ? x + 1 : 0, &need)
+                       : bx_scan_backward(line, len, spans, n, kind, k == 0 ? x : len, &need);
+        if (col >= 0) {
+            *ml = l;
+            *mc = (size_t)col;
+            return true;
+        }
+    }
+    return false;
+}
+
+// The first bracket of CHECK_MATCHES lines spread over the corpus, matched
+// by hl_match_bracket() and by walking the lines
+static void check_brackets(Highlighter *hl, const Syntax *sx, const Corpus *c, FrameArena *fa) {
+    uint16_t *ends = malloc(c->lines * sizeof(uint16_t));
+    if (!ends) check_fail(c, "out of memory", 0);
+    uint16_t state = 0;
+    for (size_t i = 0; i < c->lines; i++) {
+        TokenSpan *spans;
+        int n;
+        fa_reset(fa);
+        state = ends[i] = lex_direct(sx, c, i, state, fa, &spans, &n);
+    }
+    for (size_t i = 0; i < c->lines; i += c->lines / CHECK_MATCHES + 1) {
+        TokenSpan *spans;
+        int n, len, x, kind = -1;
+        bool open = false;
+        const wchar_t *line = corpus_line(c, i, &len);
+        fa_reset(fa);
+        lex_direct(sx, c, i, i > 0 ? ends[i - 1] : 0, fa, &spans, &n);
+        for (x = 0; x < len && kind < 0; x++) kind = bx_bracket_at(line, len, spans, n, x, &open);
+        if (kind < 0) continue;
+        x--;
+
+        size_t at, ml = 0, mc = 0, wl, wc;
+        const BxFind found = hl_match_bracket(hl, i, (size_t)x, &at, &ml, &mc);
+        if (walk_match(sx, c, ends, fa, i, x, kind, open, &wl, &wc)) {
+            if (found != BX_FOUND || at != (size_t)x || ml != wl || mc != wc) check_fail(c, "MATCH DIFFERS", i);
+        } else if (found == BX_FOUND && (open ? ml - i : i - ml) < CHECK_WALK) {
+            check_fail(c, "MATCH DIFFERS", i);
+        }
+    }
+    free(ends);
+}
+
+/**
+ * CHECK_EDITS edits to the corpus and the worker told of each: a line
+ * joined to the next, a line split at a space, or a bracket blanked out.
+ * starts has room for the lines added.
+ */
+static void edit_corpus(Highlighter *hl, Corpus *c, uint32_t *seed) {
+    hl_lock(hl);
+    for (int e = 0; e < CHECK_EDITS && c->lines > 2; e++) {
+        const size_t i = xorshift(seed) % (c->lines - 1);
+        const size_t from = c->starts[i], end = c->starts[i + 1] - 1;
+        size_t at = end;
+        long delta = 0;
+        switch (e % 3) {
+            case 0:
+                delta = -1;
+                memmove(c->starts + i + 1, c->starts + i + 2, (c->lines - i - 1) * sizeof(size_t));
+                c->lines--;
+                break;
+            case 1:
+                for (at = from + 1; at < end && c->bytes[at] != ' '; at++) {}
+                if (at == end) break;
+                delta = 1;
+                memmove(c->starts + i + 2, c->starts + i + 1, (c->lines - i) * sizeof(size_t));
+                c->starts[i + 1] = at + 1;
+                c->lines++;
+                break;
+            default:
+                for (at = from; at < end && !strchr("()[]{}", c->bytes[at]); at++) {}
+                break;
+        }
+        if (at == end && delta >= 0) continue;
+        const char ch = delta < 0 ? ' ' : delta > 0 ? '\n' : ' ';
+        c->bytes[at] = ch;
+        c->text[at] = (unsigned char)ch;
+        hl_note_edit(hl, i, delta);
+    }
+    hl_unlock(hl);
+}
+
+// The outline kept up through the edits against one built from scratch
+static void check_outline(Highlighter *hl, const Syntax *sx, Corpus *c) {
+    Highlighter fresh;
+    OutlineList kept, want;
+    ol_list_init(&kept);
+    ol_list_init(&want);
+    hl_init(&fresh);
+    hl_frame(&fresh, 0, 0, screen_last(c));
+    hl_start(&fresh, sx, c->lang, (HlSource){ worker_read, worker_count, c });
+    wait_worker(&fresh, c, now_sec());
+    hl_outline(hl, &kept);
+    hl_outline(&fresh, &want);
+    hl_free(&fresh);
+
+    if (kept.count != want.count) check_fail(c, "OUTLINE DIFFERS", 0);
+    for (int i = 0; i < want.count; i++) {
+        const OutlineSymbol *a = &kept.symbols[i], *b = &want.symbols[i];
+        if (a->line != b->line || a->end != b->end || a->parent != b->parent || a->depth != b->depth ||
+            a->kind != b->kind || strcmp(a->name, b->name) != 0) {
+            check_fail(c, "OUTLINE DIFFERS", b->line);
+        }
+    }
+    ol_list_free(&kept);
+    ol_list_free(&want);
+}
+
+static void check_worker(const Syntax *sx, Corpus *c) {
+    Highlighter hl;
+    FrameArena fa;
+    Corpus copy;
+    uint32_t seed = BENCH_SEED;
+    hl_init(&hl);
+    fa_init(&fa);
+    hl_frame(&hl, 0, 0, screen_last(c));
+    hl_start(&hl, sx, c->lang, (HlSource){ worker_read, worker_count, c });
+    wait_worker(&hl, c, now_sec());
+    check_tokens(&hl, sx, c, &fa);
+    check_brackets(&hl, sx, c, &fa);
+    hl_free(&hl);
+
+    if (!copy_corpus(c, &copy)) check_fail(c, "out of memory", 0);
+    hl_init(&hl);
+    hl_frame(&hl, 0, 0, screen_last(&copy));
+    hl_start(&hl, sx, copy.lang, (HlSource){ worker_read, worker_count, &copy });
+    wait_worker(&hl, &copy, now_sec());
+    for (int r = 0; r < CHECK_ROUNDS; r++) {
+        edit_corpus(&hl, &copy, &seed);
+        wait_worker(&hl, &copy, now_sec());
+        check_tokens(&hl, sx, &copy, &fa);
+        check_brackets(&hl, sx, &copy, &fa);
+        check_outline(&hl, sx, &copy);
+    }
+    hl_free(&hl);
+    free_corpus(&copy);
+    fa_free(&fa);
+}
+#endif
+
+// ===== Report =====
+
+static void print_count(long n) {
+    if (n < 0) printf(" %8s", "-");
+    else printf(" %8ld", n);
+}
+
+int main(int argc, char **argv) {
+    Corpus corpora[LANG_MAX + 64];
+    int n = 0;
+
+    if (argc > 1) {
+        for (int i = 1; i < argc && n < (int)(sizeof(corpora) / sizeof(corpora[0])); i++) {
+            if (load_corpus(argv[i], &corpora[n])) n++;
+            else fprintf(stderr, "bench_syntax: cannot read %s\n", argv[i]);
+        }
+    } else {
+        for (int lang = 0; lang < LANG_MAX; lang++) {
+            if (bench_samples[lang] && generate_corpus((Language)lang, &corpora[n])) n++;
+        }
+    }
+    if (n == 0) return 1;
+
+    printf("bench_syntax: best of %d, %s\n", BENCH_REPEAT,
+           argc > 1 ? "files from the command line" : "~8 M chars generated per language");
+    printf("\n  %-12s %-5s %8s %11s %11s %8s %8s %8s %8s\n", "corpus", "kind",
+           "MB/s", "lines/s", "tokens/s", "allocs", "p50 us", "p99 us", "max us");
+
+    ScanResult results[LANG_MAX + 64];
+    for (int i = 0; i < n; i++) {
+        const Corpus *c = &corpora[i];
+        const Syntax *sx = syntax_get(c->lang);
+        ScanResult *r = &results[i];
+        time_scan(sx, c, r);
+        printf("  %-12.12s %-5s %8.1f %11.0f %11.0f", c->name, sx->lexer ? "dfa" : "hand",
+               (double)c->chars / r->best / 1e6, (double)c->lines / r->best,
+               (double)r->tokens / r->best);
+        print_count(r->allocs);
+        printf(" %8.2f %8.2f %8.1f\n", r->p50, r->p99, r->worst);
+    }
+
+    printf("\n  per-line latency, %% of lines\n  %-12s", "corpus");
+    for (int b = 0; b < BENCH_BUCKETS; b++) {
+        char edge[16];
+        if (b < BENCH_BUCKETS - 1) snprintf(edge, sizeof(edge), "<%gus", 0.25 * (double)(1 << b));
+        else snprintf(edge, sizeof(edge), ">=%gus", 0.25 * (double)(1 << (b - 1)));
+        printf(" %7s", edge);
+    }
+    printf("\n");
+    for (int i = 0; i < n; i++) {
+        printf("  %-12.12s", corpora[i].name);
+        for (int b = 0; b < BENCH_BUCKETS; b++) {
+            printf(" %7.2f", 100.0 * (double)results[i].buckets[b] / (double)corpora[i].lines);
+        }
+        printf("\n");
+    }
+
+#ifdef BENCH_WORKER
+    printf("\n  background highlighter (first %d lines on screen)\n", BENCH_SCREEN);
+    printf("  %-12s %10s %10s %8s %10s\n", "corpus", "screen ms", "sweep ms", "MB/s", "allocs");
+    for (int i = 0; i < n; i++) {
+        Corpus *c = &corpora[i];
+        double screen, sweep;
+        long a;
+        check_worker(syntax_get(c->lang), c);
+        time_worker(syntax_get(c->lang), c, &screen, &sweep, &a);
+        printf("  %-12.12s %10.2f %10.1f %8.1f", c->name, screen * 1e3, sweep * 1e3,
+               (double)c->chars / sweep / 1e6);
+        print_count(a);
+        printf("\n");
+    }
+#endif
+
+    for (int i = 0; i < n; i++) free_corpus(&corpora[i]);
+    return 0;
+}
@@ -0,0 +1,240 @@
+// ==================== anchors.c ====================
+// Positions in the text that follow its edits: a sorted gap array
+
+#include "anchors.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define AN_FREE_SLOT    UINT32_MAX
+#define AN_INITIAL      64
+
+void an_init(AnchorSet *as) {
+    memset(as, 0, sizeof(*as));
+}
+
+void an_free(AnchorSet *as) {
+    free(as->slots);
+    free(as->where);
+    free(as->free_ids);
+    memset(as, 0, sizeof(*as));
+}
+
+size_t an_count(const AnchorSet *as) {
+    return as->cap - (as->gap_end - as->gap_start);
+}
+
+// ===== Slots =====
+
+// Physical slot of the k-th anchor
+static size_t slot_of(const AnchorSet *as, size_t k) {
+    return k < as->gap_start ? k : k + (as->gap_end - as->gap_start);
+}
+
+static size_t index_of_slot(const AnchorSet *as, size_t slot) {
+    return slot < as->gap_start ? slot : slot - (as->gap_end - as->gap_start);
+}
+
+static size_t offset_at(const AnchorSet *as, size_t k) {
+    return k < as->gap_start ? as->slots[k].off : as->total - as->slots[slot_of(as, k)].off;
+}
+
+static void place(AnchorSet *as, size_t slot, AnSlot s) {
+    as->slots[slot] = s;
+    as->where[s.id] = (uint32_t)slot;
+}
+
+// The gap to before the k-th anchor. Anchors crossing it switch from one
+// way of counting to the other.
+static void move_gap(AnchorSet *as, size_t k) {
+    while (as->gap_start > k) {
+        AnSlot s = as->slots[--as->gap_start];
+        s.off = as->total - s.off;
+        place(as, --as->gap_end, s);
+    }
+    while (as->gap_start < k) {
+        AnSlot s = as->slots[as->gap_end++];
+        s.off = as->total - s.off;
+        place(as, as->gap_start++, s);
+    }
+}
+
+static bool grow(AnchorSet *as) {
+    const size_t cap = as->cap ? as->cap * 2 : AN_INITIAL;
+    AnSlot *slots = (AnSlot *)realloc(as->slots, cap * sizeof(AnSlot));
+    if (!slots) return false;
+    as->slots = slots;
+    const size_t post = as->cap - as->gap_end;
+    memmove(as->slots + cap - post, as->slots + as->gap_end, post * sizeof(AnSlot));
+    as->gap_end = cap - post;
+    as->cap = cap;
+    for (size_t i = as->gap_end; i < cap; i++) as->where[as->slots[i].id] = (uint32_t)i;
+    return true;
+}
+
+// First anchor after every one at pos of gravity, or before it when none
+static size_t lower_bound(const AnchorSet *as, size_t pos, int gravity) {
+    size_t lo = 0, hi = an_count(as);
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        const size_t off = offset_at(as, mid);
+        const bool before = off < pos || (off == pos && as->slots[slot_of(as, mid)].gravity < gravity);
+        if (before) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// Every anchor from first to the gap to pos, left ones first
+static void collapse(AnchorSet *as, size_t first, size_t pos) {
+    size_t lo = first, hi = as->gap_start;
+    for (size_t k = first; k < hi; k++) as->slots[k].off = pos;
+    while (lo < hi) {
+        if (as->slots[lo].gravity == AN_LEFT) {
+            lo++;
+        } else if (as->slots[hi - 1].gravity == AN_RIGHT) {
+            hi--;
+        } else {
+            AnSlot s = as->slots[lo];
+            place(as, lo++, as->slots[hi - 1]);
+            place(as, --hi, s);
+        }
+    }
+}
+
+void an_reset(AnchorSet *as, size_t total) {
+    move_gap(as, an_count(as));
+    collapse(as, 0, 0);
+    as->total = total;
+}
+
+// ===== Anchors =====
+
+static AnchorId new_id(AnchorSet *as) {
+    if (as->free_count) return as->free_ids[--as->free_count];
+    if (as->ids_used + 1 >= as->ids_cap) {
+        const uint32_t cap = as->ids_cap ? as->ids_cap * 2 : AN_INITIAL;
+        uint32_t *where = (uint32_t *)realloc(as->where, cap * sizeof(uint32_t));
+        if (!where) return AN_NONE;
+        as->where = where;
+        uint32_t *free_ids = (uint32_t *)realloc(as->free_ids, cap * sizeof(uint32_t));
+        if (!free_ids) return AN_NONE;
+        as->free_ids = free_ids;
+        as->ids_cap = cap;
+    }
+    return ++as->ids_used;
+}
+
+// Put s where its position and gravity sort, s.off holding the position
+static void insert_slot(AnchorSet *as, AnSlot s) {
+    move_gap(as, lower_bound(as, s.off, s.gravity + 1));
+    place(as, as->gap_start++, s);
+}
+
+AnchorId an_add(AnchorSet *as, size_t pos, AnGravity gravity, uint16_t owner) {
+    if (as->gap_start == as->gap_end && !grow(as)) return AN_NONE;
+    const AnchorId id = new_id(as);
+    if (id == AN_NONE) return AN_NONE;
+    AnSlot s = { pos < as->total ? pos : as->total, id, owner, (uint8_t)gravity };
+    insert_slot(as, s);
+    return id;
+}
+
+static bool live(const AnchorSet *as, AnchorId id) {
+    return id != AN_NONE && id <= as->ids_used && as->where[id] != AN_FREE_SLOT;
+}
+
+// Take the anchor out of the array, its id still held
+static AnSlot take(AnchorSet *as, AnchorId id) {
+    move_gap(as, index_of_slot(as, as->where[id]) + 1);
+    return as->slots[--as->gap_start];
+}
+
+void an_remove(AnchorSet *as, AnchorId id) {
+    if (!live(as, id)) return;
+    take(as, id);
+    as->where[id] = AN_FREE_SLOT;
+    as->free_ids[as->free_count++] = id;
+}
+
+void an_remove_owner(AnchorSet *as, uint16_t owner) {
+    // One sweep: the gap ends up at the end, holding the rest before it
+    move_gap(as, 0);
+    while (as->gap_end < as->cap) {
+        AnSlot s = as->slots[as->gap_end++];
+        s.off = as->total - s.off;
+        if (s.owner == owner || owner == AN_ANY) {
+            as->where[s.id] = AN_FREE_SLOT;
+            as->free_ids[as->free_count++] = s.id;
+        } else {
+            place(as, as->gap_start++, s);
+        }
+    }
+}
+
+size_t an_pos(const AnchorSet *as, AnchorId id) {
+    if (!live(as, id)) return 0;
+    const uint32_t slot = as->where[id];
+    return slot < as->gap_start ? as->slots[slot].off : as->total - as->slots[slot].off;
+}
+
+bool an_bounds(const AnchorSet *as, uint16_t owner, size_t *first, size_t *last) {
+    const size_t count = an_count(as);
+    size_t a = 0, b = count;
+    while (a < count && as->slots[slot_of(as, a)].owner != owner) a++;
+    if (a == count) return false;
+    while (as->slots[slot_of(as, b - 1)].owner != owner) b--;
+    *first = offset_at(as, a);
+    *last = offset_at(as, b - 1);
+    return true;
+}
+
+void an_set(AnchorSet *as, AnchorId id, size_t pos) {
+    if (!live(as, id)) return;
+    AnSlot s = take(as, id);
+    s.off = pos < as->total ? pos : as->total;
+    insert_slot(as, s);
+}
+
+size_t an_collect(const AnchorSet *as, size_t from, size_t to, uint16_t owner,
+                  AnchorId *ids, size_t *pos, size_t max) {
+    const size_t count = an_count(as);
+    size_t n = 0;
+    for (size_t k = lower_bound(as, from, AN_LEFT); k < count && n < max; k++) {
+        const size_t off = offset_at(as, k);
+        if (off > to) break;
+        const AnSlot *s = &as->slots[slot_of(as, k)];
+        if (owner != AN_ANY && s->owner != owner) continue;
+        if (ids) ids[n] = s->id;
+        if (pos) pos[n] = off;
+        n++;
+    }
+    return n;
+}
+
+// ===== Edits =====
+
+void an_note_insert(AnchorSet *as, size_t pos, size_t n) {
+    if (n == 0) return;
+    // Those past the gap move with the end of the text
+    move_gap(as, lower_bound(as, pos, AN_RIGHT));
+    as->total += n;
+}
+
+void an_note_delete(AnchorSet *as, size_t pos, size_t n) {
+    if (pos >= as->total || n == 0) return;
+    if (n > as->total - pos) n = as->total - pos;
+    // Those from pos to pos + n land on pos; right ones there now sort
+    // after left ones, so the few that met are put in order again
+    const size_t a = lower_bound(as, pos, AN_LEFT);
+    move_gap(as, lower_bound(as, pos + n + 1, AN_LEFT));
+    collapse(as, a, pos);
+    as->total -= n;
+}
+
+void an_note_batch(AnchorSet *as, const EditOp *ops, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        const size_t pos = ops[i].at - ops[i].len;
+        an_note_delete(as, pos, ops[i].del);
+        an_note_insert(as, pos, ops[i].len);
+    }
+}
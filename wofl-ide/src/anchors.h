@@ -0,0 +1,82 @@
+// ==================== anchors.h ====================
+// Positions in the text that follow its edits
+//
+// Carets, the selection anchor, search positions and the like each name a
+// place in the text, and every edit before it moves it. Rather than each
+// recomputing theirs, they hold an anchor here and read its position back.
+//
+// The anchors are kept sorted in an array with a gap, as the text is: those
+// before the gap store their offset, those after it their distance from the
+// end of the text. An edit moves the gap to where it happens, so those past
+// it follow without being touched; only the anchors the gap crosses and those
+// in a deleted range are. Edits near the last cost O(log n + k).
+//
+// Positions are counted in buffer units: bytes for the Linux ports,
+// wchar_t for the Win32 port, as in line_index.h.
+
+#ifndef WOFL_ANCHORS_H
+#define WOFL_ANCHORS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "edit_batch.h"
+
+typedef uint32_t AnchorId;
+#define AN_NONE     0           // no anchor; ids start at 1
+#define AN_ANY      0xFFFF      // any owner, for an_collect()
+
+// Where an anchor goes when text is inserted right at it
+typedef enum {
+    AN_LEFT = 0,                // stays before the text, as a selection start
+    AN_RIGHT = 1                // ends up after it, as a caret typing
+} AnGravity;
+
+typedef struct {
+    size_t   off;               // before the gap: offset; after it: units to the end
+    AnchorId id;
+    uint16_t owner;             // the caller's, to find its own anchors
+    uint8_t  gravity;
+} AnSlot;
+
+typedef struct {
+    AnSlot   *slots;            // by position, then left before right
+    size_t    cap;
+    size_t    gap_start, gap_end;
+    size_t    total;            // length of the text
+    uint32_t *where;            // slot of each id, AN_FREE_SLOT if unused
+    uint32_t *free_ids;
+    uint32_t  ids_cap, ids_used, free_count;
+} AnchorSet;
+
+void     an_init(AnchorSet *as);
+void     an_free(AnchorSet *as);
+// A new text of total units: every anchor goes back to its start
+void     an_reset(AnchorSet *as, size_t total);
+size_t   an_count(const AnchorSet *as);
+
+AnchorId an_add(AnchorSet *as, size_t pos, AnGravity gravity, uint16_t owner);
+void     an_remove(AnchorSet *as, AnchorId id);
+// Drop every anchor of owner
+void     an_remove_owner(AnchorSet *as, uint16_t owner);
+size_t   an_pos(const AnchorSet *as, AnchorId id);
+// Positions of the first and last anchors of owner; false if it has none
+bool     an_bounds(const AnchorSet *as, uint16_t owner, size_t *first, size_t *last);
+void     an_set(AnchorSet *as, AnchorId id, size_t pos);
+
+/**
+ * Anchors of owner (or AN_ANY) from `from` to `to`, both included, in
+ * order: up to max ids and positions, either array may be NULL. Returns
+ * how many were stored.
+ */
+size_t   an_collect(const AnchorSet *as, size_t from, size_t to, uint16_t owner,
+                    AnchorId *ids, size_t *pos, size_t max);
+
+// Every edit to the text, once made. Anchors in a deleted range end up at
+// its start.
+void     an_note_insert(AnchorSet *as, size_t pos, size_t n);
+void     an_note_delete(AnchorSet *as, size_t pos, size_t n);
+// A batch applied by eb_apply(), each op in turn from the left
+void     an_note_batch(AnchorSet *as, const EditOp *ops, size_t n);
+
+#endif // WOFL_ANCHORS_H
@@ -0,0 +1,358 @@
+// ==================== bracket_index.c ====================
+// Per-block bracket depths in a segment tree, and the line walks around them
+
+#include "bracket_index.h"
+#include <stdlib.h>
+#include <string.h>
+
+// ===== Lines =====
+
+static inline bool bx_quoted(TokenClass cls) {
+    return cls == TK_STR || cls == TK_CHAR || cls == TK_COMMENT;
+}
+
+// Whether column x is code: not inside a string, character or comment
+// span. *t is a cursor into spans, which are sorted; x only moves one way.
+static bool bx_code_at(const TokenSpan *spans, int n, int *t, size_t x, bool forward) {
+    if (forward) {
+        while (*t < n && spans[*t].start + spans[*t].len <= x) (*t)++;
+    } else {
+        while (*t >= 0 && spans[*t].start > x) (*t)--;
+    }
+    if (*t < 0 || *t >= n) return true;
+    const TokenSpan *s = &spans[*t];
+    return !(s->start <= x && x < s->start + s->len && bx_quoted(s->cls));
+}
+
+int bx_bracket_at(const wchar_t *line, int len, const TokenSpan *spans, int n,
+                  int x, bool *open) {
+    int t = 0;
+    if (x < 0 || x >= len) return -1;
+    int k = bx_kind(line[x], open);
+    return k >= 0 && bx_code_at(spans, n, &t, (size_t)x, true) ? k : -1;
+}
+
+void bx_depth_add(BracketDepth *d, const wchar_t *line, int len,
+                  const TokenSpan *spans, int n) {
+    int t = 0;
+    for (int x = 0; x < len; x++) {
+        bool open;
+        int k = bx_kind(line[x], &open);
+        if (k < 0 || !bx_code_at(spans, n, &t, (size_t)x, true)) continue;
+        d->delta[k] += open ? 1 : -1;
+        if (d->delta[k] < d->low[k]) d->low[k] = d->delta[k];
+    }
+}
+
+int bx_scan_forward(const wchar_t *line, int len, const TokenSpan *spans, int n,
+                    int kind, int from, int32_t *need) {
+    int t = 0;
+    for (int x = from < 0 ? 0 : from; x < len; x++) {
+        bool open = false;
+        if (bx_kind(line[x], &open) != kind || !bx_code_at(spans, n, &t, (size_t)x, true)) continue;
+        *need += open ? 1 : -1;
+        if (*need == 0) return x;
+    }
+    return -1;
+}
+
+int bx_scan_backward(const wchar_t *line, int len, const TokenSpan *spans, int n,
+                     int kind, int to, int32_t *need) {
+    int t = n - 1;
+    for (int x = (to > len ? len : to) - 1; x >= 0; x--) {
+        bool open = false;
+        if (bx_kind(line[x], &open) != kind || !bx_code_at(spans, n, &t, (size_t)x, false)) continue;
+        *need += open ? -1 : 1;
+        if (*need == 0) return x;
+    }
+    return -1;
+}
+
+// ===== Tree =====
+
+// a followed by b
+static void bx_combine(BracketNode *out, const BracketNode *a, const BracketNode *b) {
+    out->lines = a->lines + b->lines;
+    out->unknown = a->unknown + b->unknown;
+    for (int k = 0; k < BX_KINDS; k++) {
+        int32_t low = a->depth.delta[k] + b->depth.low[k];
+        out->depth.delta[k] = a->depth.delta[k] + b->depth.delta[k];
+        out->depth.low[k] = a->depth.low[k] < low ? a->depth.low[k] : low;
+    }
+}
+
+static void bx_update(BracketIndex *bx, size_t block) {
+    for (size_t i = (bx->leaves + block) / 2; i >= 1; i /= 2) {
+        bx_combine(&bx->tree[i], &bx->tree[2 * i], &bx->tree[2 * i + 1]);
+    }
+}
+
+static void bx_rebuild(BracketIndex *bx) {
+    memset(bx->tree + bx->leaves + bx->nblocks, 0,
+           (bx->leaves - bx->nblocks) * sizeof(BracketNode));
+    for (size_t i = bx->leaves - 1; i >= 1; i--) {
+        bx_combine(&bx->tree[i], &bx->tree[2 * i], &bx->tree[2 * i + 1]);
+    }
+}
+
+static BracketNode *bx_leaf(const BracketIndex *bx, size_t block) {
+    return &bx->tree[bx->leaves + block];
+}
+
+// Room for `need` blocks; growing moves the leaves and rebuilds the tree
+static bool bx_reserve(BracketIndex *bx, size_t need) {
+    if (need <= bx->leaves) return true;
+    size_t leaves = bx->leaves ? bx->leaves : 64;
+    while (leaves < need) leaves *= 2;
+
+    BracketNode *tree = (BracketNode *)malloc(2 * leaves * sizeof(BracketNode));
+    if (!tree) return false;
+    if (bx->nblocks) {
+        memcpy(tree + leaves, bx->tree + bx->leaves, bx->nblocks * sizeof(BracketNode));
+    }
+    free(bx->tree);
+    bx->tree = tree;
+    bx->leaves = leaves;
+    bx_rebuild(bx);
+    return true;
+}
+
+static void bx_set_leaf(BracketIndex *bx, size_t block, size_t lines) {
+    BracketNode *leaf = bx_leaf(bx, block);
+    memset(leaf, 0, sizeof(*leaf));
+    leaf->lines = lines;
+    leaf->unknown = lines > 0;
+}
+
+/**
+ * Cut an oversized block into blocks of BX_BLOCK_LINES, all unknown
+ */
+static bool bx_split(BracketIndex *bx, size_t block) {
+    const size_t lines = bx_leaf(bx, block)->lines;
+    const size_t pieces = (lines + BX_BLOCK_LINES - 1) / BX_BLOCK_LINES;
+    if (!bx_reserve(bx, bx->nblocks + pieces - 1)) return false;
+
+    BracketNode *leaves = bx->tree + bx->leaves;
+    memmove(leaves + block + pieces, leaves + block + 1,
+            (bx->nblocks - block - 1) * sizeof(BracketNode));
+    bx->nblocks += pieces - 1;
+    for (size_t p = 0; p < pieces; p++) {
+        size_t left = lines - p * BX_BLOCK_LINES;
+        bx_set_leaf(bx, block + p, left < BX_BLOCK_LINES ? left : BX_BLOCK_LINES);
+    }
+    bx_rebuild(bx);
+    return true;
+}
+
+// Drop blocks left without lines
+static void bx_compact(BracketIndex *bx) {
+    BracketNode *leaves = bx->tree + bx->leaves;
+    size_t kept = 0;
+    for (size_t b = 0; b < bx->nblocks; b++) {
+        if (leaves[b].lines) leaves[kept++] = leaves[b];
+    }
+    bx->nblocks = kept;
+    bx_rebuild(bx);
+}
+
+// ===== Index =====
+
+void bx_init(BracketIndex *bx) {
+    memset(bx, 0, sizeof(*bx));
+}
+
+void bx_free(BracketIndex *bx) {
+    free(bx->tree);
+    bx_init(bx);
+}
+
+size_t bx_line_count(const BracketIndex *bx) {
+    return bx->leaves ? bx->tree[1].lines : 0;
+}
+
+bool bx_resize(BracketIndex *bx, size_t lines) {
+    size_t total = bx_line_count(bx);
+
+    while (total > lines) {
+        size_t last = bx->nblocks - 1;
+        BracketNode *leaf = bx_leaf(bx, last);
+        size_t cut = total - lines < leaf->lines ? total - lines : leaf->lines;
+        bx_set_leaf(bx, last, leaf->lines - cut);
+        if (bx_leaf(bx, last)->lines == 0) bx->nblocks--;
+        bx_update(bx, last);
+        total -= cut;
+    }
+    if (total == lines) return true;
+
+    // Top up the last block, then append whole ones
+    size_t add = lines - total;
+    if (bx->nblocks) {
+        size_t last = bx->nblocks - 1;
+        size_t have = bx_leaf(bx, last)->lines;
+        if (have < BX_BLOCK_LINES) {
+            size_t take = BX_BLOCK_LINES - have < add ? BX_BLOCK_LINES - have : add;
+            bx_set_leaf(bx, last, have + take);
+            bx_update(bx, last);
+            add -= take;
+        }
+    }
+    if (add == 0) return true;
+    if (!bx_reserve(bx, bx->nblocks + (add + BX_BLOCK_LINES - 1) / BX_BLOCK_LINES)) return false;
+    while (add > 0) {
+        size_t take = add < BX_BLOCK_LINES ? add : BX_BLOCK_LINES;
+        bx_set_leaf(bx, bx->nblocks, take);
+        bx_update(bx, bx->nblocks);
+        bx->nblocks++;
+        add -= take;
+    }
+    return true;
+}
+
+bool bx_note_edit(BracketIndex *bx, size_t line, long delta) {
+    size_t first;
+    size_t block = bx_block_of(bx, line, &first);
+    if (block >= bx->nblocks) return true;
+
+    BracketNode *leaf = bx_leaf(bx, block);
+    if (delta >= 0) {
+        bx_set_leaf(bx, block, leaf->lines + (size_t)delta);
+        if (leaf->lines > BX_BLOCK_MAX) return bx_split(bx, block);
+        bx_update(bx, block);
+        return true;
+    }
+
+    // Removed lines run from line + 1, possibly through later blocks
+    size_t gone = (size_t)-delta;
+    size_t after = bx_line_count(bx) - line - 1;
+    if (gone > after) gone = after;
+    bool emptied = false;
+    for (size_t b = block; b < bx->nblocks; b++) {
+        leaf = bx_leaf(bx, b);
+        size_t here = b == block ? first + leaf->lines - line - 1 : leaf->lines;
+        size_t take = gone < here ? gone : here;
+        bx_set_leaf(bx, b, leaf->lines - take);
+        emptied |= leaf->lines == 0;
+        if (!emptied) bx_update(bx, b);
+        gone -= take;
+        if (gone == 0) break;
+    }
+    if (emptied) bx_compact(bx);
+    return true;
+}
+
+size_t bx_block_of(const BracketIndex *bx, size_t line, size_t *first) {
+    if (line >= bx_line_count(bx)) {
+        *first = bx_line_count(bx);
+        return bx->nblocks;
+    }
+    size_t node = 1, below = 0;
+    while (node < bx->leaves) {
+        const BracketNode *left = &bx->tree[2 * node];
+        if (line - below < left->lines) {
+            node = 2 * node;
+        } else {
+            below += left->lines;
+            node = 2 * node + 1;
+        }
+    }
+    *first = below;
+    return node - bx->leaves;
+}
+
+size_t bx_block_start(const BracketIndex *bx, size_t block) {
+    if (block >= bx->nblocks) return bx_line_count(bx);
+    size_t below = 0;
+    for (size_t i = bx->leaves + block; i > 1; i /= 2) {
+        if (i & 1) below += bx->tree[i - 1].lines;
+    }
+    return below;
+}
+
+size_t bx_block_lines(const BracketIndex *bx, size_t block) {
+    return block < bx->nblocks ? bx_leaf(bx, block)->lines : 0;
+}
+
+void bx_set_depth(BracketIndex *bx, size_t block, const BracketDepth *d) {
+    if (block >= bx->nblocks) return;
+    BracketNode *leaf = bx_leaf(bx, block);
+    leaf->depth = *d;
+    leaf->unknown = 0;
+    bx_update(bx, block);
+}
+
+// ===== Searches =====
+
+// Each walks the tree left to right (or right to left), skipping whole
+// subtrees that cannot hold what is looked for; it stops at the first leaf
+// it enters, so one path plus the two edges of the range are visited
+
+static size_t bx_next_unknown_in(const BracketIndex *bx, size_t node, size_t lo, size_t hi,
+                                 size_t from) {
+    if (hi <= from || bx->tree[node].unknown == 0) return bx->nblocks;
+    if (hi - lo == 1) return lo;
+    size_t mid = lo + (hi - lo) / 2;
+    size_t found = bx_next_unknown_in(bx, 2 * node, lo, mid, from);
+    return found < bx->nblocks ? found : bx_next_unknown_in(bx, 2 * node + 1, mid, hi, from);
+}
+
+size_t bx_next_unknown(const BracketIndex *bx, size_t block) {
+    if (block >= bx->nblocks) return bx->nblocks;
+    return bx_next_unknown_in(bx, 1, 0, bx->leaves, block);
+}
+
+static BxFind bx_forward_in(const BracketIndex *bx, size_t node, size_t lo, size_t hi,
+                            size_t from, size_t limit, int kind, int32_t *need, size_t *block) {
+    if (hi <= from) return BX_NONE;
+    if (lo >= limit) return limit < bx->nblocks ? BX_PENDING : BX_NONE;
+
+    const BracketNode *nd = &bx->tree[node];
+    if (lo >= from && hi <= limit && nd->unknown == 0 && *need + nd->depth.low[kind] > 0) {
+        *need += nd->depth.delta[kind];
+        return BX_NONE;
+    }
+    if (hi - lo == 1) {
+        if (nd->unknown) return BX_PENDING;
+        *block = lo;
+        return BX_FOUND;
+    }
+    size_t mid = lo + (hi - lo) / 2;
+    BxFind r = bx_forward_in(bx, 2 * node, lo, mid, from, limit, kind, need, block);
+    if (r != BX_NONE) return r;
+    return bx_forward_in(bx, 2 * node + 1, mid, hi, from, limit, kind, need, block);
+}
+
+BxFind bx_find_forward(const BracketIndex *bx, size_t from, size_t limit,
+                       int kind, int32_t *need, size_t *block) {
+    if (limit > bx->nblocks) limit = bx->nblocks;
+    if (from >= bx->nblocks) return BX_NONE;
+    return bx_forward_in(bx, 1, 0, bx->leaves, from, limit, kind, need, block);
+}
+
+// Right to left, a block closes `need` closers if its lowest running depth
+// seen from the end, low - delta, reaches -need
+static BxFind bx_backward_in(const BracketIndex *bx, size_t node, size_t lo, size_t hi,
+                             size_t to, int kind, int32_t *need, size_t *block) {
+    if (lo >= to) return BX_NONE;
+
+    const BracketNode *nd = &bx->tree[node];
+    if (hi <= to && nd->unknown == 0 &&
+        *need - nd->depth.delta[kind] + nd->depth.low[kind] > 0) {
+        *need -= nd->depth.delta[kind];
+        return BX_NONE;
+    }
+    if (hi - lo == 1) {
+        if (nd->unknown) return BX_PENDING;
+        *block = lo;
+        return BX_FOUND;
+    }
+    size_t mid = lo + (hi - lo) / 2;
+    BxFind r = bx_backward_in(bx, 2 * node + 1, mid, hi, to, kind, need, block);
+    if (r != BX_NONE) return r;
+    return bx_backward_in(bx, 2 * node, lo, mid, to, kind, need, block);
+}
+
+BxFind bx_find_backward(const BracketIndex *bx, size_t from,
+                        int kind, int32_t *need, size_t *block) {
+    if (from >= bx->nblocks) return BX_NONE;
+    return bx_backward_in(bx, 1, 0, bx->leaves, from + 1, kind, need, block);
+}
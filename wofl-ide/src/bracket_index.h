@@ -0,0 +1,121 @@
+// ==================== bracket_index.h ====================
+// Bracket nesting depth over a whole file, for matching () [] {}
+//
+// Lines are grouped into blocks of up to a few hundred. Each block keeps,
+// per bracket kind, the depth change across it and the lowest depth it
+// dips to; a segment tree over the blocks combines those, so the block
+// holding the match of a bracket is found in O(log n) steps however far
+// away it is, and only that block and the bracket's own are lexed again.
+// Brackets are read from scanner output: those inside string, character
+// and comment spans do not count.
+
+#ifndef WOFL_BRACKET_INDEX_H
+#define WOFL_BRACKET_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "syntax_defs.h"
+
+#define BX_KINDS        3       // (), [], {}
+#define BX_BLOCK_LINES  128     // lines per new block
+#define BX_BLOCK_MAX    512     // blocks grown past this are split
+
+typedef enum {
+    BX_NONE,                    // not a bracket, or it has no match
+    BX_FOUND,
+    BX_PENDING                  // the match lies past what is indexed yet
+} BxFind;
+
+// Depth change across a run of text, per kind: openers count +1, closers -1
+typedef struct {
+    int32_t delta[BX_KINDS];
+    int32_t low[BX_KINDS];      // lowest running depth from the start, <= 0
+} BracketDepth;
+
+typedef struct {
+    size_t lines;
+    size_t unknown;             // blocks below whose depth is out of date
+    BracketDepth depth;
+} BracketNode;
+
+// Blocks are the leaves [leaves, leaves + nblocks) of a 1-based tree
+typedef struct {
+    BracketNode *tree;
+    size_t leaves;              // power of two
+    size_t nblocks;
+} BracketIndex;
+
+// ===== Lines =====
+
+// 0, 1 or 2 for ( [ {, with *open set; -1 for anything else
+static inline int bx_kind(wchar_t c, bool *open) {
+    switch (c) {
+        case L'(': *open = true;  return 0;
+        case L')': *open = false; return 0;
+        case L'[': *open = true;  return 1;
+        case L']': *open = false; return 1;
+        case L'{': *open = true;  return 2;
+        case L'}': *open = false; return 2;
+        default:   return -1;
+    }
+}
+
+// Kind of the bracket at column x if it is code, else -1
+int bx_bracket_at(const wchar_t *line, int len, const TokenSpan *spans, int n,
+                  int x, bool *open);
+
+// Fold the brackets of one lexed line into d
+void bx_depth_add(BracketDepth *d, const wchar_t *line, int len,
+                  const TokenSpan *spans, int n);
+
+/**
+ * Walk a lexed line for the match of a bracket of `kind`, with `*need`
+ * of them unmatched. Forward starts at column `from`, backward ends just
+ * before column `to`. Returns the column that brings *need to 0, or -1
+ * with *need updated for the next line.
+ */
+int bx_scan_forward(const wchar_t *line, int len, const TokenSpan *spans, int n,
+                    int kind, int from, int32_t *need);
+int bx_scan_backward(const wchar_t *line, int len, const TokenSpan *spans, int n,
+                     int kind, int to, int32_t *need);
+
+// ===== Index =====
+
+void   bx_init(BracketIndex *bx);
+void   bx_free(BracketIndex *bx);
+size_t bx_line_count(const BracketIndex *bx);
+
+// Lines added or dropped at the end; new lines go in unknown blocks
+bool   bx_resize(BracketIndex *bx, size_t lines);
+
+/**
+ * `line` was edited and `delta` lines added after it (removed, if
+ * negative). The blocks touched become unknown. Returns false if a block
+ * could not be split; the index still counts lines right, but the block
+ * is oversized.
+ */
+bool   bx_note_edit(BracketIndex *bx, size_t line, long delta);
+
+// Block holding `line` and its first line; nblocks for lines past the end
+size_t bx_block_of(const BracketIndex *bx, size_t line, size_t *first);
+size_t bx_block_start(const BracketIndex *bx, size_t block);
+size_t bx_block_lines(const BracketIndex *bx, size_t block);
+void   bx_set_depth(BracketIndex *bx, size_t block, const BracketDepth *d);
+
+// First unknown block at or after `block`, or nblocks
+size_t bx_next_unknown(const BracketIndex *bx, size_t block);
+
+/**
+ * The first block at or after `from` where `*need` unmatched openers of
+ * `kind` are all closed, with *need set to how many are still open at its
+ * start. Blocks from `limit` on count as not indexed yet.
+ */
+BxFind bx_find_forward(const BracketIndex *bx, size_t from, size_t limit,
+                       int kind, int32_t *need, size_t *block);
+
+// Likewise for `*need` unmatched closers, the last block at or before `from`
+BxFind bx_find_backward(const BracketIndex *bx, size_t from,
+                        int kind, int32_t *need, size_t *block);
+
+#endif // WOFL_BRACKET_INDEX_H
@@ -0,0 +1,269 @@
+// ==================== charclass.c ====================
+// SSSE3 / AVX2 / scalar character-class kernels with CPUID dispatch
+
+#include "charclass.h"
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define CC_X86 1
+#include <immintrin.h>
+#ifndef _MSC_VER
+#include <cpuid.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CC_TARGET(isa) __attribute__((target(isa)))
+#else
+#define CC_TARGET(isa)
+#endif
+
+#if WCHAR_MAX > 0xFFFF
+#define CC_WIDE4 1
+#endif
+
+// ===== Nibble Tables =====
+// Each ASCII class is a union of rectangles (high nibbles x low nibbles);
+// one bit per rectangle, so lo[c & 15] & hi[c >> 4] has a bit set exactly
+// when c lies in one of them:
+//
+//   0x01  \t..\r   0x02  space    0x04  0-9    0x08  A-O a-o
+//   0x10  P-Z p-z  0x20  _        0x40  " '    0x80  `
+//
+// Punctuation is everything printable that is in none of them.
+
+#define CC_NIB_SPACE  0x03
+#define CC_NIB_DIGIT  0x04
+#define CC_NIB_IDENT  0x3C
+#define CC_NIB_QUOTE  0xC0
+
+static const unsigned char cc_nib_lo[16] = {
+    0x96, 0x1C, 0x5C, 0x1C, 0x1C, 0x1C, 0x1C, 0x5C,
+    0x1C, 0x1D, 0x19, 0x09, 0x09, 0x09, 0x08, 0x28,
+};
+
+static const unsigned char cc_nib_hi[16] = {
+    0x01, 0x00, 0x42, 0x04, 0x08, 0x30, 0x88, 0x10,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+// ===== Scalar =====
+
+static void scalar_block(const wchar_t *p, CcBlock *out) {
+    CcBlock b = {0, 0, 0, 0, 0};
+    for (int j = 0; j < 64; j++) {
+        unsigned c = cc_class_of((unsigned)p[j]);
+        uint64_t bit = (uint64_t)1 << j;
+        if (c & CC_SPACE) b.space |= bit;
+        if (c & CC_IDENT) b.ident |= bit;
+        if (c & CC_QUOTE) b.quote |= bit;
+        if (c & CC_OP)    b.op |= bit;
+        if (c & CC_DIGIT) b.digit |= bit;
+    }
+    *out = b;
+}
+
+// ===== SSSE3 / AVX2 =====
+
+#ifdef CC_X86
+
+// 16 characters as bytes; anything past 0xFF saturates to 0xFF (or to 0
+// for values that read as negative), which is in no class
+CC_TARGET("ssse3") static inline __m128i ssse3_load(const wchar_t *p) {
+#ifdef CC_WIDE4
+    __m128i a = _mm_packs_epi32(_mm_loadu_si128((const __m128i *)p),
+                                _mm_loadu_si128((const __m128i *)(p + 4)));
+    __m128i b = _mm_packs_epi32(_mm_loadu_si128((const __m128i *)(p + 8)),
+                                _mm_loadu_si128((const __m128i *)(p + 12)));
+    return _mm_packus_epi16(a, b);
+#else
+    return _mm_packus_epi16(_mm_loadu_si128((const __m128i *)p),
+                            _mm_loadu_si128((const __m128i *)(p + 8)));
+#endif
+}
+
+// Bits of the bytes whose lookup shares a bit with `sel`
+#define SSSE3_ANY(v, sel) \
+    ((uint64_t)(~_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(v, _mm_set1_epi8((char)(sel))), zero)) & 0xFFFF))
+
+CC_TARGET("ssse3") static void ssse3_block(const wchar_t *p, CcBlock *out) {
+    const __m128i lo_tbl = _mm_loadu_si128((const __m128i *)cc_nib_lo);
+    const __m128i hi_tbl = _mm_loadu_si128((const __m128i *)cc_nib_hi);
+    const __m128i nib = _mm_set1_epi8(0x0F);
+    const __m128i zero = _mm_setzero_si128();
+    CcBlock b = {0, 0, 0, 0, 0};
+
+    for (int q = 0; q < 4; q++) {
+        __m128i c = ssse3_load(p + q * 16);
+        __m128i lo = _mm_shuffle_epi8(lo_tbl, _mm_and_si128(c, nib));
+        __m128i hi = _mm_shuffle_epi8(hi_tbl, _mm_and_si128(_mm_srli_epi16(c, 4), nib));
+        __m128i v = _mm_and_si128(lo, hi);
+        __m128i print = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8(' ')),
+                                      _mm_cmplt_epi8(c, _mm_set1_epi8(0x7F)));
+        const int at = q * 16;
+        uint64_t ident = SSSE3_ANY(v, CC_NIB_IDENT);
+        uint64_t quote = SSSE3_ANY(v, CC_NIB_QUOTE);
+        b.space |= SSSE3_ANY(v, CC_NIB_SPACE) << at;
+        b.digit |= SSSE3_ANY(v, CC_NIB_DIGIT) << at;
+        b.ident |= ident << at;
+        b.quote |= quote << at;
+        b.op |= ((uint64_t)_mm_movemask_epi8(print) & ~(ident | quote)) << at;
+    }
+    *out = b;
+}
+
+// 32 characters as bytes, in order (packs work per 128-bit lane)
+CC_TARGET("avx2") static inline __m256i avx2_load(const wchar_t *p) {
+#ifdef CC_WIDE4
+    __m256i a = _mm256_packs_epi32(_mm256_loadu_si256((const __m256i *)p),
+                                   _mm256_loadu_si256((const __m256i *)(p + 8)));
+    __m256i b = _mm256_packs_epi32(_mm256_loadu_si256((const __m256i *)(p + 16)),
+                                   _mm256_loadu_si256((const __m256i *)(p + 24)));
+    return _mm256_permutevar8x32_epi32(_mm256_packus_epi16(a, b),
+                                       _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+#else
+    return _mm256_permute4x64_epi64(
+        _mm256_packus_epi16(_mm256_loadu_si256((const __m256i *)p),
+                            _mm256_loadu_si256((const __m256i *)(p + 16))), 0xD8);
+#endif
+}
+
+#define AVX2_ANY(v, sel) \
+    ((uint64_t)(uint32_t)~_mm256_movemask_epi8( \
+        _mm256_cmpeq_epi8(_mm256_and_si256(v, _mm256_set1_epi8((char)(sel))), zero)))
+
+CC_TARGET("avx2") static void avx2_block(const wchar_t *p, CcBlock *out) {
+    const __m256i lo_tbl = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)cc_nib_lo));
+    const __m256i hi_tbl = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)cc_nib_hi));
+    const __m256i nib = _mm256_set1_epi8(0x0F);
+    const __m256i zero = _mm256_setzero_si256();
+    CcBlock b = {0, 0, 0, 0, 0};
+
+    for (int q = 0; q < 2; q++) {
+        __m256i c = avx2_load(p + q * 32);
+        __m256i lo = _mm256_shuffle_epi8(lo_tbl, _mm256_and_si256(c, nib));
+        __m256i hi = _mm256_shuffle_epi8(hi_tbl, _mm256_and_si256(_mm256_srli_epi16(c, 4), nib));
+        __m256i v = _mm256_and_si256(lo, hi);
+        __m256i print = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8(' ')),
+                                         _mm256_cmpgt_epi8(_mm256_set1_epi8(0x7F), c));
+        const int at = q * 32;
+        uint64_t ident = AVX2_ANY(v, CC_NIB_IDENT);
+        uint64_t quote = AVX2_ANY(v, CC_NIB_QUOTE);
+        b.space |= AVX2_ANY(v, CC_NIB_SPACE) << at;
+        b.digit |= AVX2_ANY(v, CC_NIB_DIGIT) << at;
+        b.ident |= ident << at;
+        b.quote |= quote << at;
+        b.op |= ((uint64_t)(uint32_t)_mm256_movemask_epi8(print) & ~(ident | quote)) << at;
+    }
+    *out = b;
+}
+
+static void cc_cpuid(unsigned leaf, unsigned sub, unsigned r[4]) {
+#ifdef _MSC_VER
+    int v[4];
+    __cpuidex(v, (int)leaf, (int)sub);
+    for (int i = 0; i < 4; i++) r[i] = (unsigned)v[i];
+#else
+    if (!__get_cpuid_count(leaf, sub, &r[0], &r[1], &r[2], &r[3])) {
+        r[0] = r[1] = r[2] = r[3] = 0;
+    }
+#endif
+}
+
+static uint64_t cc_xgetbv(void) {
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    unsigned lo, hi;
+    __asm__ volatile ("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((uint64_t)hi << 32) | lo;
+#endif
+}
+
+static CcIsa cc_detect(void) {
+    unsigned r[4];
+    cc_cpuid(0, 0, r);
+    const unsigned max_leaf = r[0];
+    if (max_leaf < 1) return CC_ISA_SCALAR;
+
+    cc_cpuid(1, 0, r);
+    if (!(r[2] & (1u << 9))) return CC_ISA_SCALAR;           // SSSE3
+
+    // AVX2 needs the OS to save YMM state (OSXSAVE + XCR0 bits 1 and 2)
+    const bool osxsave = (r[2] & (1u << 27)) != 0;
+    const bool avx     = (r[2] & (1u << 28)) != 0;
+    if (osxsave && avx && (cc_xgetbv() & 6) == 6 && max_leaf >= 7) {
+        cc_cpuid(7, 0, r);
+        if (r[1] & (1u << 5)) return CC_ISA_AVX2;
+    }
+    return CC_ISA_SSSE3;
+}
+
+#else
+
+static CcIsa cc_detect(void) { return CC_ISA_SCALAR; }
+
+#endif // CC_X86
+
+// ===== Dispatch =====
+
+static void (*cc_block)(const wchar_t *p, CcBlock *out) = scalar_block;
+static CcIsa cc_current = CC_ISA_SCALAR;
+static CcIsa cc_best = CC_ISA_SCALAR;
+static volatile bool cc_ready = false;
+
+static void cc_apply(CcIsa isa) {
+#ifdef CC_X86
+    if (isa == CC_ISA_AVX2) {
+        cc_block = avx2_block;
+    } else if (isa == CC_ISA_SSSE3) {
+        cc_block = ssse3_block;
+    } else
+#endif
+    {
+        cc_block = scalar_block;
+        isa = CC_ISA_SCALAR;
+    }
+    cc_current = isa;
+}
+
+/**
+ * Detection is idempotent, so a race between two first callers is harmless
+ */
+static inline void cc_init(void) {
+    if (cc_ready) return;
+    cc_best = cc_detect();
+    cc_apply(cc_best);
+    cc_ready = true;
+}
+
+CcIsa cc_isa(void)     { cc_init(); return cc_current; }
+CcIsa cc_isa_max(void) { cc_init(); return cc_best; }
+
+void cc_set_isa(CcIsa isa) {
+    cc_init();
+    cc_apply(isa > cc_best ? cc_best : isa);
+}
+
+const char *cc_isa_name(CcIsa isa) {
+    switch (isa) {
+        case CC_ISA_AVX2:  return "avx2";
+        case CC_ISA_SSSE3: return "ssse3";
+        default:           return "scalar";
+    }
+}
+
+// ===== Lines =====
+
+void cc_classify(const wchar_t *p, int n, CcBlock *out) {
+    cc_init();
+    int i = 0;
+    for (; i + 64 <= n; i += 64) cc_block(p + i, out++);
+    if (i < n) {
+        // NUL is in no class, so padding leaves the tail bits clear
+        wchar_t tail[64];
+        memcpy(tail, p + i, (size_t)(n - i) * sizeof(wchar_t));
+        memset(tail + (n - i), 0, (size_t)(64 - (n - i)) * sizeof(wchar_t));
+        cc_block(tail, out);
+    }
+}
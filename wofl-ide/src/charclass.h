@@ -0,0 +1,87 @@
+// ==================== charclass.h ====================
+// Vectorized character-class pre-pass for the lexers
+//
+// A line is classified 64 characters at a time into one bitmask per class
+// (bit j of a block describes character j of that block). The SSSE3 and
+// AVX2 paths pack characters to bytes and look both nibbles up with
+// pshufb; anything outside ASCII belongs to no class.
+
+#ifndef WOFL_CHARCLASS_H
+#define WOFL_CHARCLASS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <wchar.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Class bits, as used by cc_class_of() and LexTable.loops
+#define CC_SPACE  0x01      // \t \n \v \f \r and space
+#define CC_IDENT  0x02      // [0-9A-Za-z_]
+#define CC_QUOTE  0x04      // " ' `
+#define CC_OP     0x08      // other printable ASCII punctuation
+#define CC_DIGIT  0x10      // [0-9], also CC_IDENT
+#define CC_ANY    0x80      // every character, ASCII or not (LexTable.loops only)
+
+typedef struct {
+    uint64_t space, ident, quote, op, digit;
+} CcBlock;
+
+#define CC_BLOCKS(n) (((size_t)(n) + 63) / 64)
+
+typedef enum {
+    CC_ISA_SCALAR = 0,
+    CC_ISA_SSSE3,
+    CC_ISA_AVX2
+} CcIsa;
+
+// Kernel selection; picked by CPUID on first use
+CcIsa       cc_isa(void);
+CcIsa       cc_isa_max(void);
+void        cc_set_isa(CcIsa isa);              // clamped to cc_isa_max()
+const char *cc_isa_name(CcIsa isa);
+
+/**
+ * Classify p[0, n) into CC_BLOCKS(n) blocks. Bits past n are clear.
+ */
+void cc_classify(const wchar_t *p, int n, CcBlock *out);
+
+// Scalar reference: the CC_* bits of one character
+static inline unsigned cc_class_of(unsigned c) {
+    if (c == ' ' || (c >= '\t' && c <= '\r')) return CC_SPACE;
+    if (c >= '0' && c <= '9') return CC_IDENT | CC_DIGIT;
+    if ((c | 0x20) - 'a' < 26u || c == '_') return CC_IDENT;
+    if (c == '"' || c == '\'' || c == '`') return CC_QUOTE;
+    if (c > ' ' && c < 0x7F) return CC_OP;
+    return 0;
+}
+
+// Block bits of the classes in `classes` (CC_SPACE | CC_IDENT ...)
+static inline uint64_t cc_mask(const CcBlock *b, unsigned classes) {
+    uint64_t m = 0;
+    if (classes & CC_SPACE) m |= b->space;
+    if (classes & CC_IDENT) m |= b->ident;
+    if (classes & CC_QUOTE) m |= b->quote;
+    if (classes & CC_OP)    m |= b->op;
+    if (classes & CC_DIGIT) m |= b->digit;
+    return m;
+}
+
+static inline unsigned cc_ctz64(uint64_t m) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long i;
+    _BitScanForward64(&i, m);
+    return (unsigned)i;
+#elif defined(_MSC_VER)
+    unsigned long i;
+    if (_BitScanForward(&i, (unsigned long)m)) return (unsigned)i;
+    _BitScanForward(&i, (unsigned long)(m >> 32));
+    return (unsigned)i + 32;
+#else
+    return (unsigned)__builtin_ctzll(m);
+#endif
+}
+
+#endif // WOFL_CHARCLASS_H
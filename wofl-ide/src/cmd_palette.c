@@ -1,7 +1,13 @@
 // ==================== cmd_palette.c ====================
 // Command palette for quick actions
+//
+// The palette ranks whatever its sources offer (palette.h): the commands
+// below, the line operations (line_ops.h), the commands of every plugin
+// (plugin_manager_commands()), the open file and recent files. Typing
+// filters and ranks them fuzzily; Up and Down pick one, Enter runs it.
 
 #include "editor.h"
+#include "line_ops.h"
 #include <wchar.h>
 
 // Command definitions
@@ -20,24 +26,168 @@ typedef enum {
 } CommandId;
 
 typedef struct {
-    const wchar_t *name;
-    const wchar_t *description;
+    const char *name;
+    const char *description;
     CommandId id;
 } CommandItem;
 
 static const CommandItem commands[] = {
-    {L"Open", L"Open a file", CMD_OPEN},
-    {L"Save", L"Save current file", CMD_SAVE},
-    {L"Save As", L"Save with new name", CMD_SAVE_AS},
-    {L"Run", L"Execute current file", CMD_RUN},
-    {L"Toggle Output", L"Show/hide output pane", CMD_TOGGLE_OUTPUT},
-    {L"Find", L"Search in file", CMD_FIND},
-    {L"Goto Line", L"Jump to line number", CMD_GOTO_LINE},
-    {L"Set Language: C", L"C/C++ syntax", CMD_SET_LANG_C},
-    {L"Set Language: Python", L"Python syntax", CMD_SET_LANG_PYTHON},
-    {L"Set Language: JavaScript", L"JavaScript syntax", CMD_SET_LANG_JS}
+    {"Open", "Open a file  Ctrl+O", CMD_OPEN},
+    {"Save", "Save current file  Ctrl+S", CMD_SAVE},
+    {"Save As", "Save with new name", CMD_SAVE_AS},
+    {"Run", "Execute current file", CMD_RUN},
+    {"Toggle Output", "Show/hide output pane", CMD_TOGGLE_OUTPUT},
+    {"Find", "Search in file  Ctrl+F", CMD_FIND},
+    {"Goto Line", "Jump to line number  Ctrl+G", CMD_GOTO_LINE},
+    {"Set Language: C", "C/C++ syntax", CMD_SET_LANG_C},
+    {"Set Language: Python", "Python syntax", CMD_SET_LANG_PYTHON},
+    {"Set Language: JavaScript", "JavaScript syntax", CMD_SET_LANG_JS}
 };
 
+// ===== Sources =====
+
+static void collect_commands(PaletteSource *self, Palette *p, const char *query) {
+    (void)self;
+    (void)query;
+    for (int i = 0; i < CMD_MAX; i++) {
+        pal_add(p, commands[i].name, commands[i].description, commands[i].id);
+    }
+}
+
+static void set_language(AppState *app, Language lang) {
+    app->lang = lang;
+    app->syntax = syntax_get(app->lang);
+}
+
+static void run_command(PaletteSource *self, const PaletteEntry *e, const char *label, const char *detail) {
+    AppState *app = (AppState*)self->ctx;
+    (void)label;
+    (void)detail;
+
+    // Dialogs are opened from the message loop, once the palette is gone
+    switch ((CommandId)e->id) {
+        case CMD_OPEN:
+            PostMessageW(app->hwnd, WM_COMMAND, 1, 0);
+            break;
+        case CMD_SAVE:
+            PostMessageW(app->hwnd, WM_COMMAND, 2, 0);
+            break;
+        case CMD_SAVE_AS:
+            PostMessageW(app->hwnd, WM_COMMAND, 3, 0);
+            break;
+        case CMD_RUN:
+            PostMessageW(app->hwnd, WM_COMMAND, 4, 0);
+            break;
+        case CMD_TOGGLE_OUTPUT:
+            PostMessageW(app->hwnd, WM_COMMAND, 5, 0);
+            break;
+        case CMD_FIND:
+            PostMessageW(app->hwnd, WM_COMMAND, 6, 0);
+            break;
+        case CMD_GOTO_LINE:
+            PostMessageW(app->hwnd, WM_COMMAND, 7, 0);
+            break;
+        case CMD_SET_LANG_C:
+            set_language(app, LANG_C);
+            break;
+        case CMD_SET_LANG_PYTHON:
+            set_language(app, LANG_PY);
+            break;
+        case CMD_SET_LANG_JS:
+            set_language(app, LANG_JS);
+            break;
+        case CMD_MAX:
+            break;
+    }
+}
+
+// Line operations (line_ops.h), run by the window once the palette is gone
+static void collect_line_ops(PaletteSource *self, Palette *p, const char *query) {
+    (void)self;
+    (void)query;
+    for (int i = 0; i < LO_COUNT; i++) pal_add(p, lo_name((LineOp)i), "Every line of the file", i);
+}
+
+static void run_line_op(PaletteSource *self, const PaletteEntry *e, const char *label, const char *detail) {
+    AppState *app = (AppState*)self->ctx;
+    (void)label;
+    (void)detail;
+    PostMessageW(app->hwnd, WM_COMMAND, 9, (LPARAM)e->id);
+}
+
+static void to_utf8(const wchar_t *s, char *out, int cap) {
+    if (WideCharToMultiByte(CP_UTF8, 0, s, -1, out, cap, NULL, NULL) <= 0) out[0] = '\0';
+}
+
+// The file open; there is one buffer, so picking it only closes the palette
+static void collect_buffer(PaletteSource *self, Palette *p, const char *query) {
+    AppState *app = (AppState*)self->ctx;
+    char path[PAL_PATH_MAX];
+    (void)query;
+    if (!app->file_path[0]) return;
+    to_utf8(app->file_path, path, (int)sizeof(path));
+    pal_add_path(p, path, app->buf.dirty ? "modified" : "", 0);
+}
+
+static void collect_recent(PaletteSource *self, Palette *p, const char *query) {
+    AppState *app = (AppState*)self->ctx;
+    (void)query;
+    // The first is the file open, listed already
+    for (int i = app->file_path[0] ? 1 : 0; i < app->recent.count; i++) {
+        pal_add_path(p, app->recent.paths[i], "", i);
+    }
+}
+
+static void run_recent(PaletteSource *self, const PaletteEntry *e, const char *label, const char *detail) {
+    AppState *app = (AppState*)self->ctx;
+    (void)label;
+    (void)detail;
+    PostMessageW(app->hwnd, WM_COMMAND, 8, (LPARAM)e->id);
+}
+
+static PaletteSource command_source = { "commands", PAL_COMMAND, false, collect_commands, run_command, NULL };
+static PaletteSource line_op_source = { "line operations", PAL_COMMAND, false, collect_line_ops, run_line_op, NULL };
+static PaletteSource buffer_source = { "buffer", PAL_BUFFER, false, collect_buffer, NULL, NULL };
+static PaletteSource recent_source = { "recent", PAL_RECENT, false, collect_recent, run_recent, NULL };
+
+/**
+ * Register the editor's own sources; plugins register theirs after
+ */
+void palette_init(AppState *app) {
+    pal_init(&app->palette);
+    command_source.ctx = app;
+    line_op_source.ctx = app;
+    buffer_source.ctx = app;
+    recent_source.ctx = app;
+    pal_register(&app->palette, &command_source);
+    pal_register(&app->palette, &line_op_source);
+    pal_register(&app->palette, &buffer_source);
+    pal_register(&app->palette, &recent_source);
+}
+
+void palette_free(AppState *app) {
+    pal_free(&app->palette);
+}
+
+/**
+ * Remember a file opened, for the recent files source
+ */
+void palette_file_opened(AppState *app, const wchar_t *path) {
+    char utf8[PAL_PATH_MAX];
+    to_utf8(path, utf8, (int)sizeof(utf8));
+    pal_recent_push(&app->recent, utf8);
+}
+
+// ===== Prompt =====
+
+static void filter(AppState *app) {
+    char query[PAL_QUERY_MAX];
+    to_utf8(app->overlay_text, query, (int)sizeof(query));
+    pal_filter(&app->palette, query);
+    app->palette_selected = 0;
+    app->palette_top = 0;
+}
+
 /**
  * Open command palette
  */
@@ -48,23 +198,27 @@ void palette_open(AppState *app) {
     app->overlay_len = 0;
     app->overlay_cursor = 0;
     app->mode = MODE_PALETTE;
+    pal_open(&app->palette);
+    app->palette_selected = 0;
+    app->palette_top = 0;
 }
 
 /**
  * Handle character input in palette
  */
 void palette_handle_char(AppState *app, wchar_t ch) {
-    if (app->overlay_len >= WOFL_CMD_MAX - 1) return;
-    
+    if (app->overlay_len >= PAL_QUERY_MAX - 1) return;
+
     // Insert at cursor position
     memmove(app->overlay_text + app->overlay_cursor + 1,
             app->overlay_text + app->overlay_cursor,
             (app->overlay_len - app->overlay_cursor) * sizeof(wchar_t));
-    
+
     app->overlay_text[app->overlay_cursor] = ch;
     app->overlay_len++;
     app->overlay_cursor++;
     app->overlay_text[app->overlay_len] = L'\0';
+    filter(app);
 }
 
 /**
@@ -72,88 +226,44 @@ void palette_handle_char(AppState *app, wchar_t ch) {
  */
 void palette_backspace(AppState *app) {
     if (app->overlay_cursor <= 0) return;
-    
+
     memmove(app->overlay_text + app->overlay_cursor - 1,
             app->overlay_text + app->overlay_cursor,
             (app->overlay_len - app->overlay_cursor) * sizeof(wchar_t));
-    
+
     app->overlay_len--;
     app->overlay_cursor--;
     app->overlay_text[app->overlay_len] = L'\0';
+    filter(app);
 }
 
 /**
- * Find matching command
+ * Move the selection by delta hits, keeping it in the rows listed
  */
-static int find_command(const wchar_t *text) {
-    if (!text[0]) return -1;
-    
-    // Convert search text to uppercase for case-insensitive matching
-    wchar_t search[WOFL_CMD_MAX];
-    wcscpy_s(search, WOFL_CMD_MAX, text);
-    _wcsupr_s(search, WOFL_CMD_MAX);
-    
-    // Find first matching command
-    for (int i = 0; i < CMD_MAX; i++) {
-        wchar_t cmd_upper[256];
-        wcscpy_s(cmd_upper, 256, commands[i].name);
-        _wcsupr_s(cmd_upper, 256);
-        
-        if (wcsstr(cmd_upper, search)) {
-            return i;
-        }
+void palette_move(AppState *app, int delta) {
+    const int count = app->palette.nhits;
+    if (count == 0) return;
+    int sel = app->palette_selected + delta;
+    if (delta == 1 || delta == -1) {
+        sel = (sel + count) % count;
+    } else {
+        sel = sel < 0 ? 0 : sel >= count ? count - 1 : sel;
     }
-    
-    return -1;
+    app->palette_selected = sel;
+    if (sel < app->palette_top) app->palette_top = sel;
+    if (sel >= app->palette_top + WOFL_PALETTE_ROWS) app->palette_top = sel - WOFL_PALETTE_ROWS + 1;
 }
 
 /**
  * Execute selected command
  */
-void palette_confirm(AppState *
-app) {
-    int cmd_idx = find_command(app->overlay_text);
-    
+void palette_confirm(AppState *app) {
     // Close palette
     app->overlay_active = false;
     app->mode = MODE_EDIT;
-    
-    if (cmd_idx < 0) return;
-    
-    // Execute command
-    switch (commands[cmd_idx].id) {
-        case CMD_OPEN:
-            PostMessageW(app->hwnd, WM_COMMAND, 1, 0);
-            break;
-        case CMD_SAVE:
-            PostMessageW(app->hwnd, WM_COMMAND, 2, 0);
-            break;
-        case CMD_SAVE_AS:
-            PostMessageW(app->hwnd, WM_COMMAND, 3, 0);
-            break;
-        case CMD_RUN:
-            PostMessageW(app->hwnd, WM_COMMAND, 4, 0);
-            break;
-        case CMD_TOGGLE_OUTPUT:
-            PostMessageW(app->hwnd, WM_COMMAND, 5, 0);
-            break;
-        case CMD_FIND:
-            PostMessageW(app->hwnd, WM_COMMAND, 6, 0);
-            break;
-        case CMD_GOTO_LINE:
-            PostMessageW(app->hwnd, WM_COMMAND, 7, 0);
-            break;
-        case CMD_SET_LANG_C:
-            app->lang = LANG_C;
-            break;
-        case CMD_SET_LANG_PYTHON:
-            app->lang = LANG_PY;
-            break;
-        case CMD_SET_LANG_JS:
-            app->lang = LANG_JS;
-            break;
-    }
-    
+
+    pal_run(&app->palette, app->palette_selected);
+
     InvalidateRect(app->hwnd, NULL, FALSE);
 }
 
@@ -165,10 +275,3 @@ void palette_cancel(AppState *app) {
     app->mode = MODE_EDIT;
     InvalidateRect(app->hwnd, NULL, FALSE);
 }
-
-// Command palette (cmd_palette.c)
-void     palette_open(AppState *app);
-void     palette_handle_char(AppState *app, wchar_t ch);
-void     palette_backspace(AppState *app);
-void     palette_confirm(AppState *app);
-void     palette_cancel(AppState *app);
@@ -0,0 +1,68 @@
+// ==================== edit_batch.c ====================
+// Batched gap buffer edits: one sorted sweep
+
+#include "edit_batch.h"
+#include <stdlib.h>
+#include <string.h>
+
+static int cmp_op(const void *a, const void *b) {
+    const EditOp *x = (const EditOp *)a, *y = (const EditOp *)b;
+    if (x->pos != y->pos) return x->pos < y->pos ? -1 : 1;
+    return (x->tag > y->tag) - (x->tag < y->tag);
+}
+
+size_t eb_prepare(EditOp *ops, size_t n) {
+    // Carets move in step, so ops usually come sorted already
+    bool sorted = true;
+    for (size_t i = 1; i < n && sorted; i++) sorted = cmp_op(&ops[i - 1], &ops[i]) <= 0;
+    if (!sorted) qsort(ops, n, sizeof(EditOp), cmp_op);
+
+    size_t inserted = 0, end = 0;
+    for (size_t i = 0; i < n; i++) {
+        EditOp *op = &ops[i];
+        if (op->pos < end) {
+            const size_t skip = end - op->pos;
+            op->del = op->del > skip ? op->del - skip : 0;
+            op->pos = end;
+        }
+        end = op->pos + op->del;
+        inserted += op->len;
+    }
+    return inserted;
+}
+
+/**
+ * The sweep: w is where the new text is written, r where the old is read,
+ * both physical; the gap is what lies between them. Every op shrinks it by
+ * what it inserts and grows it by what it deletes, so with room for all the
+ * insertions up front w never catches up with r, and the stretches between
+ * ops move down with one memmove each.
+ */
+void eb_apply(EditGap *g, EditOp *ops, size_t n) {
+    if (n == 0) return;
+    char *data = (char *)g->data;
+    const size_t u = (size_t)g->unit;
+    size_t w = g->gap_start, r = g->gap_end;
+    size_t pos = ops[0].pos;                    // logical position of r in the old text
+    const size_t old_len = g->capacity - (g->gap_end - g->gap_start);
+
+    for (size_t i = 0; i < n; i++) {
+        EditOp *op = &ops[i];
+        const size_t keep = op->pos > old_len ? old_len - pos : op->pos - pos;
+        if (keep) memmove(data + w * u, data + r * u, keep * u);
+        w += keep;
+        r += keep;
+        pos += keep;
+
+        size_t del = op->del;
+        if (del > old_len - pos) del = old_len - pos;
+        r += del;
+        pos += del;
+
+        if (op->len) memcpy(data + w * u, op->text, op->len * u);
+        w += op->len;
+        op->at = w;
+    }
+    g->gap_start = w;
+    g->gap_end = r;
+}
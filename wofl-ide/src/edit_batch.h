@@ -0,0 +1,51 @@
+// ==================== edit_batch.h ====================
+// Many edits applied to a gap buffer in one left-to-right pass
+//
+// Editing at many carets one at a time drags the gap back and forth over
+// the text between them, once per caret. A batch sorts the edits instead,
+// parks the gap at the first and sweeps it to the last: each stretch of
+// text between two edits moves down once, and the inserted text is written
+// as the sweep reaches it. Where each edit ends in the new text comes out
+// of the same pass, for the carets.
+//
+// Positions are counted in buffer units: bytes for the Linux ports,
+// wchar_t for the Win32 port, as in line_index.h.
+
+#ifndef WOFL_EDIT_BATCH_H
+#define WOFL_EDIT_BATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+    size_t      pos;            // in the text before the batch
+    size_t      del;            // units removed from pos
+    const void *text;           // inserted at pos, len units
+    size_t      len;
+    uint32_t    tag;            // the caller's, e.g. the caret it came from
+    size_t      at;             // set by eb_apply(): where it ends in the new text
+} EditOp;
+
+// A gap buffer of either port, seen as units
+typedef struct {
+    void   *data;
+    size_t  capacity;
+    size_t  gap_start, gap_end;
+    int     unit;               // 1 for char buffers, sizeof(wchar_t) for wide ones
+} EditGap;
+
+/**
+ * Sort ops by position, ties by tag, and clip any that start inside the
+ * deletion before them. Returns the units they insert, all told, which the
+ * gap must hold before eb_apply().
+ */
+size_t eb_prepare(EditOp *ops, size_t n);
+
+/**
+ * Apply sorted ops, the gap sitting at ops[0].pos and holding every unit
+ * they insert. The gap ends up after the last op.
+ */
+void   eb_apply(EditGap *g, EditOp *ops, size_t n);
+
+#endif // WOFL_EDIT_BATCH_H
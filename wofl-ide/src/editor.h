@@ -13,22 +13,25 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <wchar.h>
+#include "line_index.h"
+#include "newline_scan.h"
+#include "syntax_defs.h"
+#include "lang_registry.h"
+#include "frame_arena.h"
+#include "palette.h"
+#include "anchors.h"
 
 // ===== Constants =====
 #define WOFL_MAX_PATH     1024
 #define WOFL_CMD_MAX      2048
 #define WOFL_FIND_MAX     512
-#define WOFL_MAX_TOKENS   256
-#define WOFL_LINE_BUF_MAX 8192
 #define WOFL_DEFAULT_TAB  4
 #define WOFL_INITIAL_GAP  4096
+#define WOFL_COMPLETE_MAX 10        // completions the popup lists
+#define WOFL_COMPLETE_MIN 2         // characters typed before it opens by itself
+#define WOFL_PALETTE_ROWS 12        // palette hits listed under the prompt at once
 
 // ===== Utility Functions (INLINE) =====
-static inline bool is_word(wchar_t c) {
-    return (c == L'_' || (c >= L'0' && c <= L'9') || 
-            (c >= L'a' && c <= L'z') || (c >= L'A' && c <= L'Z'));
-}
-
 static inline size_t min_size(size_t a, size_t b) { return a < b ? a : b; }
 static inline size_t max_size(size_t a, size_t b) { return a > b ? a : b; }
 static inline int min_int(int a, int b) { return a < b ? a : b; }
@@ -40,37 +43,6 @@ typedef enum {
     EOL_CRLF = 1
 } EolMode;
 
-typedef enum {
-    LANG_NONE = 0,
-    LANG_C,
-    LANG_CPP,
-    LANG_ASM,
-    LANG_CSV,
-    LANG_PY,
-    LANG_JS,
-    LANG_HTML,
-    LANG_CSS,
-    LANG_JSON,
-    LANG_MD,
-    LANG_GO,
-    LANG_RS,
-    LANG_SH,
-    LANG_LUA,
-    LANG_MAX
-} Language;
-
-typedef enum {
-    TK_TEXT = 0,
-    TK_KW,
-    TK_IDENT,
-    TK_NUM,
-    TK_STR,
-    TK_CHAR,
-    TK_COMMENT,
-    TK_PUNCT,
-    TK_MAX
-} TokenClass;
-
 typedef enum {
     MODE_EDIT = 0,
     MODE_FIND,
@@ -95,17 +67,11 @@ typedef struct {
     size_t index;
 } Caret;
 
-typedef struct {
-    size_t     start;
-    size_t     len;
-    TokenClass cls;
-} TokenSpan;
-
-typedef void (*SyntaxScanFn)(const wchar_t *line, int len, TokenSpan *out, int *out_n);
-
-typedef struct {
-    SyntaxScanFn scan_line;
-} Syntax;
+// Owners of anchors in AppState.anchors
+enum {
+    ANCHOR_CARET = 1,           // carets besides the main one
+    ANCHOR_SELECTION            // where the selection started
+};
 
 typedef struct {
     HFONT    hFont;
@@ -138,16 +104,30 @@ typedef struct {
     CRITICAL_SECTION lock;
 } OutputPane;
 
+// Completions of the word before the caret, from an autocomplete plugin
+typedef struct {
+    bool     visible;
+    int      count;
+    int      selected;
+    int      prefix_len;        // characters of the word already typed
+    wchar_t  items[WOFL_COMPLETE_MAX][64];
+} CompletionPopup;
+
+struct PluginManager;
+
 typedef struct {
     wchar_t  file_path[WOFL_MAX_PATH];
     wchar_t  file_dir[WOFL_MAX_PATH];
     wchar_t  file_name[WOFL_MAX_PATH];
     Language lang;
+    const Syntax *syntax;       // scanner for lang, picked once per file
     
     GapBuffer buf;
     Caret    caret;
-    Caret    sel_anchor;
+    AnchorId sel_anchor;        // in anchors, so edits carry it along
     bool     selecting;
+    int      carets;            // carets besides the main one, anchors of ANCHOR_CARET
+    AnchorSet anchors;          // positions that follow every edit
     int      top_line;
     int      left_col;
     int      tab_width;
@@ -160,6 +140,11 @@ typedef struct {
     wchar_t  overlay_text[WOFL_CMD_MAX];
     int      overlay_len;
     int      overlay_cursor;
+    CompletionPopup complete;
+    Palette  palette;           // command palette sources and hits
+    int      palette_selected;
+    int      palette_top;       // first hit listed
+    PaletteRecent recent;       // files opened, most recent first
     
     wchar_t  run_cmd[WOFL_CMD_MAX];
     OutputPane out;
@@ -167,9 +152,13 @@ typedef struct {
     HWND     hwnd;
     RECT     client_rc;
     Theme    theme;
+    FrameArena frame;           // line text and spans of the frame being painted
     
     int      total_lines_cache;
     bool     need_recount;
+    LineIndexer lines;          // line starts, built in the background
+    int      index_permille;    // indexing progress seen at last recount
+    struct PluginManager *plugins;  // told about every edit, if set
 } AppState;
 
 // ===== Function Declarations =====
@@ -184,9 +173,17 @@ void     gb_insert(GapBuffer *gb, const wchar_t *s, size_t n);
 void     gb_insert_ch(GapBuffer *gb, wchar_t ch);
 void     gb_delete_range(GapBuffer *gb, size_t pos, size_t n);
 wchar_t  gb_char_at(const GapBuffer *gb, size_t pos);
+const wchar_t *gb_segment(const GapBuffer *gb, size_t pos, size_t *avail);
+NlText   gb_nl_text(const GapBuffer *gb);
 bool     gb_load_from_file(GapBuffer *gb, const wchar_t *path, EolMode *eol);
 bool     gb_save_to_file(GapBuffer *gb, const wchar_t *path, EolMode eol);
 
+// Indexed editing (keeps app->lines in step with app->buf)
+void     editor_index_start(AppState *app);
+void     editor_buf_insert(AppState *app, size_t pos, const wchar_t *s, size_t n);
+void     editor_buf_delete(AppState *app, size_t pos, size_t n);
+void     editor_buf_apply(AppState *app, EditOp *ops, size_t n);
+
 // Rendering
 void     theme_default(Theme *th);
 void     editor_layout_metrics(AppState *app, HDC hdc);
@@ -197,22 +194,20 @@ void     editor_index_to_linecol(const GapBuffer *gb, size_t idx, int *line, int
 size_t   editor_linecol_to_index(const GapBuffer *gb, int line, int col);
 void     editor_paint(AppState *app, HDC hdc);
 
-// Syntax highlighting
-Language syntax_detect_language(const wchar_t *path);
-const Syntax* syntax_get(Language lang);
-
-// Syntax scanners
-void syntax_scan_c(const wchar_t *line, int len, TokenSpan *out, int *out_n);
-void syntax_scan_py(const wchar_t *line, int len, TokenSpan *out, int *out_n);
-void syntax_scan_js(const wchar_t *line, int len, TokenSpan *out, int *out_n);
+// Syntax highlighting (scanners and syntax_get() live in lang_registry.h)
+Language syntax_detect_language(const wchar_t *path, const GapBuffer *gb);
 
 // Find operations
 bool     find_next(AppState *app, const wchar_t *needle, bool case_ins, bool wrap, bool down);
 
 // Command palette
+void     palette_init(AppState *app);
+void     palette_free(AppState *app);
+void     palette_file_opened(AppState *app, const wchar_t *path);
 void     palette_open(AppState *app);
 void     palette_handle_char(AppState *app, wchar_t ch);
 void     palette_backspace(AppState *app);
+void     palette_move(AppState *app, int delta);
 void     palette_confirm(AppState *app);
 void     palette_cancel(AppState *app);
 
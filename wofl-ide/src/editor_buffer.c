@@ -2,6 +2,7 @@
 // Gap buffer implementation aligned to editor.h
 
 #include "editor.h"
+#include "plugin_system.h"
 #include <windows.h>
 #include <string.h>
 
@@ -141,6 +142,34 @@ wchar_t gb_char_at(const GapBuffer *gb, size_t pos) {
     }
 }
 
+/**
+ * Contiguous run of text starting at pos (up to the gap or the end)
+ */
+const wchar_t *gb_segment(const GapBuffer *gb, size_t pos, size_t *avail) {
+    const size_t len = gb_length(gb);
+    if (pos >= len) { *avail = 0; return NULL; }
+    if (pos < gb->gap_start) {
+        *avail = gb->gap_start - pos;
+        return gb->data + pos;
+    }
+    const size_t off = pos + (gb->gap_end - gb->gap_start);
+    *avail = gb->capacity - off;
+    return gb->data + off;
+}
+
+/**
+ * Both sides of the gap, for the newline kernels
+ */
+NlText gb_nl_text(const GapBuffer *gb) {
+    NlText t;
+    t.pre      = gb->data;
+    t.pre_len  = gb->gap_start;
+    t.post     = gb->data + gb->gap_end;
+    t.post_len = gb->capacity - gb->gap_end;
+    t.unit     = (int)sizeof(wchar_t);
+    return t;
+}
+
 bool gb_load_from_file(GapBuffer *gb, const wchar_t *path, EolMode *eol) {
     HANDLE f = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, NULL,
                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
@@ -231,3 +260,102 @@ bool gb_save_to_file(GapBuffer *gb, const wchar_t *path, EolMode eol) {
     gb->dirty = false;
     return true;
 }
+
+// ===== Indexed Editing =====
+// The line indexer reads the buffer from its own thread, so every change to
+// app->buf goes through here with the indexer lock held.
+
+static const void *app_buf_segment(void *ctx, size_t pos, size_t *avail) {
+    return gb_segment(&((AppState*)ctx)->buf, pos, avail);
+}
+
+static size_t app_buf_length(void *ctx) {
+    return gb_length(&((AppState*)ctx)->buf);
+}
+
+static void app_index_notify(void *user) {
+    AppState *app = (AppState*)user;
+    if (app->hwnd) InvalidateRect(app->hwnd, NULL, FALSE);
+}
+
+/**
+ * (Re)build the line index for the current buffer in the background
+ */
+void editor_index_start(AppState *app) {
+    LineSource src = { app_buf_segment, app_buf_length, app, (int)sizeof(wchar_t) };
+    app->lines.notify = app_index_notify;
+    app->lines.notify_user = app;
+    lix_start(&app->lines, src);
+    an_reset(&app->anchors, gb_length(&app->buf));
+    app->need_recount = true;
+}
+
+void editor_buf_insert(AppState *app, size_t pos, const wchar_t *s, size_t n) {
+    if (!s || n == 0) return;
+    lix_lock(&app->lines);
+    gb_move_gap(&app->buf, pos);
+    gb_insert(&app->buf, s, n);
+    lix_note_insert(&app->lines, pos, s, n);
+    app->total_lines_cache = (int)li_line_count(&app->lines.index);
+    lix_unlock(&app->lines);
+    an_note_insert(&app->anchors, pos, n);
+    if (app->plugins) plugin_manager_text_change(app->plugins, pos, s, n);
+}
+
+void editor_buf_delete(AppState *app, size_t pos, size_t n) {
+    if (n == 0) return;
+    // Plugins see the text before it goes; only this thread changes buf
+    const size_t total = gb_length(&app->buf);
+    if (app->plugins && pos < total) plugin_manager_text_change(app->plugins, pos, NULL, min_size(n, total - pos));
+    lix_lock(&app->lines);
+    const size_t len = gb_length(&app->buf);
+    if (pos < len) {
+        if (pos + n > len) n = len - pos;
+        gb_delete_range(&app->buf, pos, n);
+        lix_note_delete(&app->lines, pos, n);
+        app->total_lines_cache = (int)li_line_count(&app->lines.index);
+    }
+    lix_unlock(&app->lines);
+    if (pos < len) an_note_delete(&app->anchors, pos, n);
+}
+
+/**
+ * Many edits as one batch (edit_batch.h), the buffer rebuilt in one pass
+ * from the first to the last. Plugins hear of the whole batch before it
+ * is applied and again after (on_text_batch), not of each edit in turn.
+ * Sets each op's end in the new text.
+ */
+void editor_buf_apply(AppState *app, EditOp *ops, size_t n) {
+    if (n == 0) return;
+    const size_t total = gb_length(&app->buf);
+    for (size_t i = 0; i < n; i++) {
+        ops[i].pos = min_size(ops[i].pos, total);
+        ops[i].del = min_size(ops[i].del, total - ops[i].pos);
+    }
+    const size_t inserted = eb_prepare(ops, n);
+    if (app->plugins) plugin_manager_text_batch(app->plugins, ops, n, false);
+
+    lix_lock(&app->lines);
+    gb_ensure(&app->buf, inserted);
+    if (app->buf.gap_end - app->buf.gap_start < inserted) {
+        lix_unlock(&app->lines);
+        return;     // out of memory: nothing changed
+    }
+    gb_move_gap(&app->buf, ops[0].pos);
+    EditGap gap = { app->buf.data, app->buf.capacity, app->buf.gap_start, app->buf.gap_end, (int)sizeof(wchar_t) };
+    eb_apply(&gap, ops, n);
+    app->buf.gap_start = gap.gap_start;
+    app->buf.gap_end = gap.gap_end;
+    app->buf.dirty = true;
+    // The index takes the edits from the left, each where the ones before left it
+    for (size_t i = 0; i < n; i++) {
+        const size_t pos = ops[i].at - ops[i].len;
+        lix_note_delete(&app->lines, pos, ops[i].del);
+        lix_note_insert(&app->lines, pos, ops[i].text, ops[i].len);
+    }
+    app->total_lines_cache = (int)li_line_count(&app->lines.index);
+    lix_unlock(&app->lines);
+    an_note_batch(&app->anchors, ops, n);
+
+    if (app->plugins) plugin_manager_text_batch(app->plugins, ops, n, true);
+}
@@ -81,20 +81,17 @@ void editor_layout_metrics(AppState *app, HDC hdc) {
 }
 
 /**
- * Count total lines in buffer
+ * Pick up the line count from the background index
  */
 void editor_recount_lines(AppState *app) {
-    size_t len = gb_length(&app->buf);
-    int lines = 1;
-    
-    for (size_t i = 0; i < len; i++) {
-        if (gb_char_at(&app->buf, i) == L'\n') {
-            lines++;
-        }
-    }
-    
-    app->total_lines_cache = lines;
-    app->need_recount = false;
+    lix_lock(&app->lines);
+    const size_t lines = li_line_count(&app->lines.index);
+    const bool done = lix_done(&app->lines);
+    app->index_permille = lix_progress_permille(&app->lines);
+    lix_unlock(&app->lines);
+
+    app->total_lines_cache = (int)lines;
+    app->need_recount = !done;  // keep refreshing until indexing finishes
 }
 
 /**
@@ -110,40 +107,21 @@ int editor_total_lines(const AppState *app) {
 size_t editor_line_start_index(const GapBuffer *gb, int line) {
     if (line <= 0) return 0;
     
-    int current_line = 0;
-    size_t len = gb_length(gb);
-    
-    for (size_t i = 0; i < len; i++) {
-        if (gb_char_at(gb, i) == L'\n') {
-            current_line++;
-            if (current_line == line) {
-                return i + 1;
-            }
-        }
-    }
-    
-    return len;
+    const NlText text = gb_nl_text(gb);
+    const size_t nl = nl_text_find_nth(&text, 0, (size_t)line);
+    return (nl == NL_NONE) ? gb_length(gb) : nl + 1;
 }
 
 /**
  * Convert buffer index to line/column
  */
 void editor_index_to_linecol(const GapBuffer *gb, size_t idx, int *line, int *col) {
-    int current_line = 0;
-    int current_col = 0;
-    size_t len = min_size(idx, gb_length(gb));
-    
-    for (size_t i = 0; i < len; i++) {
-        if (gb_char_at(gb, i) == L'\n') {
-            current_line++;
-            current_col = 0;
-        } else {
-            current_col++;
-        }
-    }
+    const NlText text = gb_nl_text(gb);
+    idx = min_size(idx, gb_length(gb));
     
-    *line = current_line;
-    *col = current_col;
+    const size_t prev = nl_text_find_prev(&text, idx);
+    *line = (int)nl_text_count(&text, 0, idx);
+    *col = (int)(prev == NL_NONE ? idx : idx - prev - 1);
 }
 
 /**
@@ -182,6 +160,42 @@ static void draw_text_ex(HDC hdc, int x, int y, const wchar_t *text,
     ExtTextOutW(hdc, x, y, 0, NULL, text, len, NULL);
 }
 
+/**
+ * Text of the line starting at pos, cut at column `to`. Read in place when
+ * it lies on one side of the gap, else copied into the frame arena.
+ */
+static const wchar_t *line_window(const GapBuffer *gb, FrameArena *fa, size_t pos,
+                                  size_t to, int *len) {
+    size_t avail, k = 1;
+    const wchar_t *seg = gb_segment(gb, pos, &avail);
+    *len = 0;
+    if (!seg || to == 0) return L"";
+    
+    size_t look = min_size(avail, to);
+    size_t n = nl_find_nth(seg, look, (int)sizeof(wchar_t), &k);
+    if (k == 0 || look == to || pos + avail >= gb_length(gb)) {
+        *len = (int)n;
+        return seg;
+    }
+    
+    // Straddles the gap: join both segments
+    size_t cap = min_size(to, gb_length(gb) - pos);
+    wchar_t *copy = fa_new(fa, wchar_t, cap);
+    if (!copy) {
+        *len = (int)n;
+        return seg;
+    }
+    memcpy(copy, seg, avail * sizeof(wchar_t));
+    size_t rest;
+    const wchar_t *tail = gb_segment(gb, pos + avail, &rest);
+    look = min_size(rest, cap - avail);
+    k = 1;
+    size_t m = nl_find_nth(tail, look, (int)sizeof(wchar_t), &k);
+    memcpy(copy + avail, tail, m * sizeof(wchar_t));
+    *len = (int)(avail + m);
+    return copy;
+}
+
 /**
  * Paint output pane
  */
@@ -209,21 +223,21 @@ static int paint_output_pane(AppState *app, HDC hdc, int client_height) {
         }
     }
     
-    // Draw lines
+    // Draw lines, each cut at the pane's right edge
     int y = client_height - height + 2;
     int x = 4;
-    wchar_t line_buf[WOFL_LINE_BUF_MAX];
+    size_t cols = (size_t)(app->client_rc.right / max_int(1, app->theme.ch_w) + 1);
+    NlText text = gb_nl_text(&app->out.buf);
     size_t pos = start_pos;
     
     while (pos < len && y < client_height - 2) {
-        int k = 0;
-        while (pos < len && k < WOFL_LINE_BUF_MAX - 1) {
-            wchar_t ch = gb_char_at(&app->out.buf, pos++);
-            if (ch == L'\n') break;
-            line_buf[k++] = ch;
-        }
+        int k;
+        const wchar_t *line = line_window(&app->out.buf, &app->frame, pos, cols, &k);
+        draw_text_ex(hdc, x, y, line, k, app->theme.col_output_fg);
         
-        draw_text_ex(hdc, x, y, line_buf, k, app->theme.col_output_fg);
+        size_t nl = nl_text_find_nth(&text, pos, 1);
+        if (nl == NL_NONE) break;
+        pos = nl + 1;
         y += app->theme.line_h;
     }
     
@@ -239,6 +253,9 @@ void editor_paint(AppState *app, HDC hdc) {
     int width = rc.right;
     int height = rc.bottom;
     
+    // Line text and spans of the previous frame are dropped in one go
+    fa_reset(&app->frame);
+    
     // Paint output pane first
     int output_height = paint_output_pane(app, hdc, height);
     height -= output_height;
@@ -264,10 +281,13 @@ void editor_paint(AppState *app, HDC hdc) {
     bool has_selection = false;
     
     if (app->selecting) {
-        size_t caret_idx = editor_linecol_to_index(&app->buf, 
-                                                    app->caret.line, app->caret.col);
-        size_t anchor_idx = editor_linecol_to_index(&app->buf,
-                                                    app->sel_anchor.line, app->sel_anchor.col);
+        // From the caret's line start, not a scan from the top: the caret
+        // may be millions of lines down after a jump
+        lix_lock(&app->lines);
+        size_t caret_idx = li_line_start(&app->lines.index, (size_t)app->caret.line);
+        lix_unlock(&app->lines);
+        caret_idx = min_size(caret_idx + (size_t)app->caret.col, gb_length(&app->buf));
+        size_t anchor_idx = an_pos(&app->anchors, app->sel_anchor);
         if (caret_idx != anchor_idx) {
             has_selection = true;
             sel_start = min_size(caret_idx, anchor_idx);
@@ -275,49 +295,47 @@ void editor_paint(AppState *app, HDC hdc) {
         }
     }
     
-    // Get syntax highlighter
-    const Syntax *syntax = syntax_get(app->lang);
+    // Syntax highlighter, picked when the file was opened
+    const Syntax *syntax = app->syntax ? app->syntax : syntax_get(app->lang);
     
-    // Draw visible lines
+    // Draw visible lines. Only the visible columns are lexed and drawn, so
+    // a single huge line costs no more than what fits on screen.
     int y = 0;
+    int col_from = app->left_col;
+    int col_to = app->left_col + width / max_int(1, app->theme.ch_w) + 1;
     for (int line = first_line; line < last_line; line++) {
-        size_t line_start = editor_line_start_index(&app->buf, line);
-        size_t line_end = editor_line_start_index(&app->buf, line + 1);
+        lix_lock(&app->lines);
+        size_t line_start = li_line_start(&app->lines.index, (size_t)line);
+        lix_unlock(&app->lines);
         
-        // Build line text
-        wchar_t line_text[WOFL_LINE_BUF_MAX];
-        int line_len = 0;
-        
-        for (size_t i = line_start; i < line_end && line_len < WOFL_LINE_BUF_MAX - 1; i++) {
-            wchar_t ch = gb_char_at(&app->buf, i);
-            if (ch == L'\n') break;
-            line_text[line_len++] = ch;
-        }
-        line_text[line_len] = L'\0';
+        int line_len;
+        const wchar_t *line_text = line_window(&app->buf, &app->frame, line_start,
+                                               (size_t)col_to, &line_len);
         
         // Syntax highlight
-        TokenSpan tokens[WOFL_MAX_TOKENS];
-        int token_count = 0;
-        if (syntax && syntax->scan_line) {  // Safety check
-            syntax->scan_line(line_text, line_len, tokens, &token_count);
-        }
+        TokenSpan *tokens;
+        int token_count = syntax_scan_window(syntax, line_text, line_len, 0,
+                                             col_from, col_to, &app->frame, &tokens);
         
         int x = 4 - app->left_col * app->theme.ch_w;
         
-        // Draw tokens with selection
+        // Draw tokens with selection, clipped to the visible columns
         for (int t = 0; t < token_count; t++) {
             TokenSpan *token = &tokens[t];
+            size_t from = max_size(token->start, (size_t)col_from);
+            size_t to = min_size(token->start + token->len, (size_t)col_to);
+            if (from >= to) continue;
             
             // Draw selection background if needed
             if (has_selection) {
-                size_t token_start = line_start + token->start;
-                size_t token_end = token_start + token->len;
+                size_t token_start = line_start + from;
+                size_t token_end = line_start + to;
                 size_t sel_token_start = max_size(token_start, sel_start);
                 size_t sel_token_end = min_size(token_end, sel_end);
                 
                 if (sel_token_start < sel_token_end) {
-                    int sel_x_start = x + (int)(sel_token_start - token_start) * app->theme.ch_w;
-                    int sel_x_end = x + (int)(sel_token_end - token_start) * app->theme.ch_w;
+                    int sel_x_start = x + (int)(sel_token_start - line_start) * app->theme.ch_w;
+                    int sel_x_end = x + (int)(sel_token_end - line_start) * app->theme.ch_w;
                     RECT sel_rect = {sel_x_start, y, sel_x_end, y + app->theme.line_h};
                     fill_rect(hdc, &sel_rect, app->theme.col_sel_bg);
                 }
@@ -325,13 +343,52 @@ void editor_paint(AppState *app, HDC hdc) {
             
             // Draw token text
             COLORREF color = app->theme.syn_colors[token->cls];
-            draw_text_ex(hdc, x + (int)token->start * app->theme.ch_w, y,
-                        line_text + token->start, (int)token->len, color);
+            draw_text_ex(hdc, x + (int)from * app->theme.ch_w, y,
+                        line_text + from, (int)(to - from), color);
         }
         
         y += app->theme.line_h;
     }
     
+    // Scrollbar strip: thumb follows top_line over the lines indexed so far
+    int total_lines = editor_total_lines(app);
+    if (total_lines > lines_fit && text_rect.bottom > 0) {
+        RECT track = {width - 6, 0, width, text_rect.bottom};
+        fill_rect(hdc, &track, app->theme.col_status_bg);
+        int thumb_h = max_int(8, (int)((long long)text_rect.bottom * lines_fit / total_lines));
+        int thumb_y = (int)((long long)(text_rect.bottom - thumb_h) * first_line /
+                            max_int(1, total_lines - lines_fit));
+        RECT thumb = {width - 6, thumb_y, width, thumb_y + thumb_h};
+        fill_rect(hdc, &thumb, RGB(90, 96, 104));
+    }
+    
+    // Carets besides the main one on the lines shown; there may be
+    // thousands, so only the anchors in their range are looked at
+    if (app->carets) {
+        size_t pos[256];
+        lix_lock(&app->lines);
+        size_t from = li_line_start(&app->lines.index, (size_t)first_line);
+        const size_t to = (size_t)last_line < li_line_count(&app->lines.index)
+                        ? li_line_start(&app->lines.index, (size_t)last_line)
+                        : gb_length(&app->buf);
+        lix_unlock(&app->lines);
+        size_t n;
+        while ((n = an_collect(&app->anchors, from, to, ANCHOR_CARET, NULL, pos, 256)) > 0) {
+            for (size_t i = 0; i < n; i++) {
+                lix_lock(&app->lines);
+                const size_t line = li_line_of(&app->lines.index, pos[i]);
+                const int col = (int)(pos[i] - li_line_start(&app->lines.index, line));
+                lix_unlock(&app->lines);
+                if ((int)line >= last_line) continue;
+                int x = 4 + (col - app->left_col) * app->theme.ch_w;
+                int cy = ((int)line - first_line) * app->theme.line_h;
+                RECT rc = { x, cy, x + 2, cy + app->theme.line_h };
+                InvertRect(hdc, &rc);
+            }
+            from = pos[n - 1] + 1;
+        }
+    }
+    
     // Draw caret
     int caret_x = 4 + (app->caret.col - app->left_col) * app->theme.ch_w;
     int caret_y = (app->caret.line - app->top_line) * app->theme.line_h;
@@ -342,12 +399,49 @@ void editor_paint(AppState *app, HDC hdc) {
     };
     InvertRect(hdc, &caret_rect);
     
+    // Completion popup under the caret, or above it if it would not fit
+    if (app->complete.visible) {
+        const CompletionPopup *cp = &app->complete;
+        int popup_w = 0;
+        for (int i = 0; i < cp->count; i++) {
+            popup_w = max_int(popup_w, (int)wcslen(cp->items[i]));
+        }
+        popup_w = (popup_w + 2) * app->theme.ch_w;
+        int popup_h = cp->count * app->theme.line_h + 4;
+        int popup_x = caret_x - cp->prefix_len * app->theme.ch_w - app->theme.ch_w;
+        int popup_y = caret_y + app->theme.line_h;
+        if (popup_y + popup_h > text_rect.bottom && caret_y - popup_h >= 0) {
+            popup_y = caret_y - popup_h;
+        }
+        popup_x = max_int(0, min_int(popup_x, width - popup_w));
+        
+        RECT popup_rect = {popup_x, popup_y, popup_x + popup_w, popup_y + popup_h};
+        fill_rect(hdc, &popup_rect, RGB(25, 30, 40));
+        for (int i = 0; i < cp->count; i++) {
+            int item_y = popup_y + 2 + i * app->theme.line_h;
+            if (i == cp->selected) {
+                RECT sel_rect = {popup_x, item_y, popup_x + popup_w, item_y + app->theme.line_h};
+                fill_rect(hdc, &sel_rect, app->theme.col_sel_bg);
+            }
+            draw_text_ex(hdc, popup_x + app->theme.ch_w, item_y, cp->items[i],
+                         (int)wcslen(cp->items[i]), RGB(235, 235, 235));
+        }
+    }
+    
     // Draw status bar text
     wchar_t status[256];
-    swprintf(status, 256, L"%ls%s  |  Ln %d, Col %d  |  %ls",
+    wchar_t lines_info[64];
+    if (app->need_recount && app->index_permille < 1000) {
+        swprintf(lines_info, 64, L"%d lines (indexing %d%%)",
+                 total_lines, app->index_permille / 10);
+    } else {
+        swprintf(lines_info, 64, L"%d lines", total_lines);
+    }
+    swprintf(status, 256, L"%ls%s  |  Ln %d, Col %d  |  %ls  |  %ls",
              app->file_name[0] ? app->file_name : L"(untitled)",
              app->buf.dirty ? L"*" : L"",
              app->caret.line + 1, app->caret.col + 1,
+             lines_info,
              app->out.visible ? L"OUT:ON" : L"OUT:OFF");
     draw_text_ex(hdc, 6, status_rect.top + 2, status, (int)wcslen(status), 
                  RGB(180, 180, 180));
@@ -367,5 +461,32 @@ void editor_paint(AppState *app, HDC hdc) {
         int cursor_x = 8 + (int)(wcslen(app->overlay_prompt) + 1 + app->overlay_cursor) * app->theme.ch_w;
         RECT cursor_rect = {cursor_x, 3, cursor_x + 2, 3 + app->theme.line_h};
         InvertRect(hdc, &cursor_rect);
+        
+        // Palette hits under the prompt: the label, then what it is, dimmed
+        if (app->mode == MODE_PALETTE) {
+            const Palette *pal = &app->palette;
+            int rows = min_int(pal->nhits - app->palette_top, WOFL_PALETTE_ROWS);
+            int list_y = overlay_rect.bottom;
+            if (rows > 0) {
+                RECT list_rect = {0, list_y, width, list_y + rows * app->theme.line_h + 4};
+                fill_rect(hdc, &list_rect, RGB(25, 30, 40));
+            }
+            for (int r = 0; r < rows; r++) {
+                int i = app->palette_top + r;
+                int item_y = list_y + 2 + r * app->theme.line_h;
+                const PaletteEntry *e = &pal->entries[pal->hits[i].entry];
+                wchar_t label[PAL_LABEL_MAX], detail[PAL_PATH_MAX];
+                if (MultiByteToWideChar(CP_UTF8, 0, pal_label(pal, e), -1, label, PAL_LABEL_MAX) <= 0) label[0] = L'\0';
+                if (MultiByteToWideChar(CP_UTF8, 0, pal_detail(pal, e), -1, detail, PAL_PATH_MAX) <= 0) detail[0] = L'\0';
+                if (i == app->palette_selected) {
+                    RECT sel_rect = {0, item_y, width, item_y + app->theme.line_h};
+                    fill_rect(hdc, &sel_rect, app->theme.col_sel_bg);
+                }
+                int label_len = (int)wcslen(label);
+                draw_text_ex(hdc, 8, item_y, label, label_len, RGB(235, 235, 235));
+                draw_text_ex(hdc, 8 + (label_len + 2) * app->theme.ch_w, item_y, detail,
+                             (int)wcslen(detail), RGB(140, 140, 160));
+            }
+        }
     }
 }
\ No newline at end of file
@@ -0,0 +1,733 @@
+// ==================== file_finder.c ====================
+// Quick open: the path list, the mask prefilter, scoring, and the background
+// walk with its watches (see file_finder.h)
+
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+#include "file_finder.h"
+#include "newline_scan.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#if defined(__linux__) && !defined(_WIN32)
+#define FF_INOTIFY 1
+#include <sys/inotify.h>
+#define FF_WATCH_EVENTS (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR | IN_DONT_FOLLOW)
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define FF_X86 1
+#include <emmintrin.h>
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define FF_TARGET(isa) __attribute__((target(isa)))
+#else
+#define FF_TARGET(isa)
+#endif
+
+#define FF_BLOCK        4096            // paths prefiltered at a time
+#define FF_SLACK        16              // pool bytes kept past the last path, for match_sse2()
+
+// ===== List =====
+
+void ff_init(FileList *l) {
+    memset(l, 0, sizeof(*l));
+}
+
+void ff_free(FileList *l) {
+    free(l->pool);
+    free(l->masks);
+    free(l->offs);
+    free(l->lens);
+    free(l->base);
+    memset(l, 0, sizeof(*l));
+}
+
+static bool grow(void **p, size_t n, size_t size) {
+    void *q = realloc(*p, n * size);
+    if (!q) return false;
+    *p = q;
+    return true;
+}
+
+// Branch-free: it runs for every character of every path tried
+static inline int fold(int c) {
+    return c + ((int)((unsigned)(c - 'A') < 26u) << 5);
+}
+
+static int char_bit(unsigned char c) {
+    if (c >= 'a' && c <= 'z') return c - 'a';
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= '0' && c <= '9') return 26 + (c - '0');
+    switch (c) {
+        case '_': return 36;
+        case '.': return 37;
+        case '-': return 38;
+        case '/': return 39;
+        default:  return 63;
+    }
+}
+
+uint64_t ff_char_mask(const char *s, size_t len) {
+    uint64_t mask = 0;
+    for (size_t i = 0; i < len; i++) mask |= (uint64_t)1 << char_bit((unsigned char)s[i]);
+    return mask;
+}
+
+bool ff_add(FileList *l, const char *path, size_t len) {
+    if (len == 0 || len >= FF_PATH_MAX) return true;   // nothing to list
+    if (l->count == l->cap) {
+        const uint32_t cap = l->cap ? l->cap * 2 : 4096;
+        if (!grow((void **)&l->masks, cap, sizeof(uint64_t)) || !grow((void **)&l->offs, cap, sizeof(uint32_t)) ||
+            !grow((void **)&l->lens, cap, sizeof(uint16_t)) || !grow((void **)&l->base, cap, sizeof(uint16_t))) {
+            return false;
+        }
+        l->cap = cap;
+    }
+    if (l->used + len + 1 + FF_SLACK > l->pool_cap) {
+        uint32_t cap = l->pool_cap ? l->pool_cap : 65536;
+        while (l->used + len + 1 + FF_SLACK > cap) cap *= 2;
+        if (!grow((void **)&l->pool, cap, 1)) return false;
+        l->pool_cap = cap;
+    }
+
+    size_t base = len;
+    while (base > 0 && path[base - 1] != '/') base--;
+    memcpy(l->pool + l->used, path, len);
+    l->pool[l->used + len] = '\0';
+    l->masks[l->count] = ff_char_mask(path, len);
+    l->offs[l->count] = l->used;
+    l->lens[l->count] = (uint16_t)len;
+    l->base[l->count] = (uint16_t)base;
+    l->count++;
+    l->used += (uint32_t)len + 1;
+    return true;
+}
+
+const char *ff_path(const FileList *l, uint32_t i) {
+    return i < l->count ? l->pool + l->offs[i] : "";
+}
+
+// ===== Scoring =====
+
+static inline bool word_start(const char *path, int i) {
+    if (i == 0) return true;
+    const unsigned char p = (unsigned char)path[i - 1], c = (unsigned char)path[i];
+    return p == '/' || p == '_' || p == '-' || p == '.' || p == ' ' ||
+           (p >= 'a' && p <= 'z' && c >= 'A' && c <= 'Z');
+}
+
+// Where the query ends when matched as early as possible from from, or -1
+static int match_end(const char *path, int from, int len, const char *query, int qlen) {
+    int q = 0;
+    for (int i = from; i < len; i++) {
+        if (fold((unsigned char)path[i]) == (unsigned char)query[q] && ++q == qlen) return i;
+    }
+    return -1;
+}
+
+// Score weights: per character matched, and per path
+#define FF_CHAR         16
+#define FF_WORD         20              // at a word start
+#define FF_RUN          12              // right after the one before
+#define FF_GAP_MAX      16              // cost of a gap, a point a character
+#define FF_NAME         32              // all in the file name
+#define FF_NAME_START   16              // ... from its start
+#define FF_STEM         32              // ... and all of it before the extension
+
+static inline int32_t length_cost(int len, int base) {
+    const int name_len = len - base;
+    return (name_len > 64 ? 64 : name_len) / 4 + (len > 256 ? 256 : len) / 16;
+}
+
+/**
+ * Score a path the query was matched in, up to end at the earliest, or
+ * in_name_end inside the file name if it can be. From there the query is
+ * matched back, which gives the shortest stretch ending there. Characters
+ * at word starts and in runs score more, gaps cost, and a match in the
+ * file name, and more so one at its start, beats one spread over the
+ * directories. Short names win ties.
+ */
+static int32_t score_match(const char *path, int len, int base, const char *query, int qlen, int end, int in_name_end) {
+    const bool in_name = in_name_end >= 0;
+    if (in_name) end = in_name_end;
+
+    int32_t score = 0;
+    int q = qlen - 1, next = -1;
+    for (int i = end; q >= 0; i--) {
+        if (fold((unsigned char)path[i]) != (unsigned char)query[q]) continue;
+        score += FF_CHAR;
+        if (word_start(path, i)) score += FF_WORD;
+        if (next == i + 1) {
+            score += FF_RUN;
+        } else if (next >= 0) {
+            const int gap = next - i - 1;
+            score -= gap < FF_GAP_MAX ? gap : FF_GAP_MAX;
+        }
+        next = i;
+        q--;
+    }
+    const int start = next;
+
+    if (in_name) {
+        score += FF_NAME;
+        if (start == base) {
+            score += FF_NAME_START;
+            if (end - start + 1 == qlen && (end + 1 == len || path[end + 1] == '.')) score += FF_STEM;
+        }
+    }
+    return score - length_cost(len, base);
+}
+
+// What score_match() could give at most, from two characters of the path:
+// most paths of a short query fall below the best found by this alone
+static inline int32_t best_possible(const char *path, int len, int base, const char *query, int qlen) {
+    int32_t score = qlen * (FF_CHAR + FF_WORD + FF_RUN) - FF_RUN + FF_NAME - length_cost(len, base);
+    if (fold((unsigned char)path[base]) == (unsigned char)query[0]) {
+        score += FF_NAME_START;
+        if (len - base >= qlen && (len - base == qlen || path[base + qlen] == '.')) score += FF_STEM;
+    }
+    return score;
+}
+
+int32_t ff_score(const char *path, int len, int base, const char *query, int qlen) {
+    if (qlen <= 0 || qlen > len) return FF_NO_MATCH;
+    const int end = match_end(path, 0, len, query, qlen);
+    if (end < 0) return FF_NO_MATCH;
+    const int in_name_end = len - base >= qlen ? match_end(path, base, len, query, qlen) : -1;
+    return score_match(path, len, base, query, qlen, end, in_name_end);
+}
+
+// ===== Kernels =====
+// prefilter(masks, first, n, want, out)   indices from first on of the n
+//                                         masks holding every bit of want
+// match(path, len, query, qlen)           where the query ends when matched
+//                                         as early as possible, or -1; may
+//                                         read up to FF_SLACK bytes past len
+
+typedef uint32_t (*PrefilterFn)(const uint64_t *masks, uint32_t first, uint32_t n, uint64_t want, uint32_t *out);
+typedef int (*MatchFn)(const char *path, int len, const char *query, int qlen);
+
+static int match_scalar(const char *path, int len, const char *query, int qlen) {
+    return match_end(path, 0, len, query, qlen);
+}
+
+static uint32_t prefilter_scalar(const uint64_t *masks, uint32_t first, uint32_t n, uint64_t want, uint32_t *out) {
+    uint32_t k = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        out[k] = first + i;
+        k += (masks[first + i] & want) == want;
+    }
+    return k;
+}
+
+#ifdef FF_X86
+
+// Two masks at a time: a mask passes when both its halves lack no bit
+FF_TARGET("sse2")
+static uint32_t prefilter_sse2(const uint64_t *masks, uint32_t first, uint32_t n, uint64_t want, uint32_t *out) {
+    const __m128i w = _mm_set1_epi64x((long long)want);
+    const __m128i zero = _mm_setzero_si128();
+    uint32_t i = 0, k = 0;
+    for (; i + 2 <= n; i += 2) {
+        const __m128i m = _mm_loadu_si128((const __m128i *)(masks + first + i));
+        const int lanes = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_andnot_si128(m, w), zero)));
+        if (lanes == 0) continue;
+        out[k] = first + i;
+        k += (lanes & 3) == 3;
+        out[k] = first + i + 1;
+        k += (lanes & 12) == 12;
+    }
+    return k + prefilter_scalar(masks, first + i, n - i, want, out + k);
+}
+
+FF_TARGET("avx2")
+static uint32_t prefilter_avx2(const uint64_t *masks, uint32_t first, uint32_t n, uint64_t want, uint32_t *out) {
+    const __m256i w = _mm256_set1_epi64x((long long)want);
+    const __m256i zero = _mm256_setzero_si256();
+    uint32_t i = 0, k = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m256i m = _mm256_loadu_si256((const __m256i *)(masks + first + i));
+        const int lanes = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_andnot_si256(m, w), zero)));
+        if (lanes == 0) continue;
+        for (int b = 0; b < 4; b++) {
+            out[k] = first + i + (uint32_t)b;
+            k += (lanes >> b) & 1;
+        }
+    }
+    return k + prefilter_scalar(masks, first + i, n - i, want, out + k);
+}
+
+static inline unsigned ctz32(uint32_t m) {
+#ifdef _MSC_VER
+    unsigned long i;
+    _BitScanForward(&i, m);
+    return (unsigned)i;
+#else
+    return (unsigned)__builtin_ctz(m);
+#endif
+}
+
+/**
+ * 16 characters at a time, folded to lower case in the register: each
+ * query character is looked for among those after the last one found, and
+ * a block without it moves on to the next. Paths are short, so most take
+ * one to three blocks whatever the query.
+ */
+FF_TARGET("sse2")
+static int match_sse2(const char *path, int len, const char *query, int qlen) {
+    const __m128i after_z = _mm_set1_epi8('Z' + 1), before_a = _mm_set1_epi8('A' - 1);
+    const __m128i case_bit = _mm_set1_epi8(0x20);
+    __m128i want = _mm_set1_epi8(query[0]);
+    int q = 0;
+    for (int at = 0; at < len; at += 16) {
+        const __m128i c = _mm_loadu_si128((const __m128i *)(path + at));
+        const __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(c, before_a), _mm_cmplt_epi8(c, after_z));
+        const __m128i folded = _mm_or_si128(c, _mm_and_si128(upper, case_bit));
+        uint32_t live = len - at >= 16 ? 0xFFFFu : (1u << (len - at)) - 1;
+        for (;;) {
+            const uint32_t hits = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(folded, want)) & live;
+            if (!hits) break;
+            const unsigned i = ctz32(hits);
+            if (++q == qlen) return at + (int)i;
+            want = _mm_set1_epi8(query[q]);
+            live &= ~((2u << i) - 1);
+        }
+    }
+    return -1;
+}
+
+#endif // FF_X86
+
+typedef struct {
+    PrefilterFn prefilter;
+    MatchFn     match;
+} FfKernels;
+
+// The widest the CPU has, as picked for the newline kernels. Matching
+// stays at 16 bytes with AVX2: a wider block mostly holds the next path.
+static FfKernels pick_kernels(void) {
+    FfKernels k = { prefilter_scalar, match_scalar };
+#ifdef FF_X86
+    const NlIsa isa = nl_isa();
+    if (isa == NL_ISA_AVX2) {
+        k.prefilter = prefilter_avx2;
+        k.match = match_sse2;
+    } else if (isa == NL_ISA_SSE2) {
+        k.prefilter = prefilter_sse2;
+        k.match = match_sse2;
+    }
+#endif
+    return k;
+}
+
+// ===== Queries =====
+
+void ff_query_init(FileQuery *q) {
+    memset(q, 0, sizeof(*q));
+}
+
+void ff_query_free(FileQuery *q) {
+    free(q->cand);
+    ff_query_init(q);
+}
+
+// Keep the best max paths, best first; equal scores keep their order
+static void keep_best(FileMatch *best, int *count, int max, uint32_t path, int32_t score) {
+    int at = *count;
+    if (at == max) {
+        if (score <= best[max - 1].score) return;
+        at--;
+    } else {
+        (*count)++;
+    }
+    while (at > 0 && best[at - 1].score < score) {
+        best[at] = best[at - 1];
+        at--;
+    }
+    best[at].path = path;
+    best[at].score = score;
+}
+
+// exact: the mask alone says the path matches, as it does for a single
+// character with a bit of its own
+static inline void try_path(const FileList *l, MatchFn match, uint32_t i, const char *q, int qlen, bool exact,
+                            FileMatch *out, int *count, int max, FileQuery *keep) {
+    const char *path = l->pool + l->offs[i];
+    const int len = l->lens[i];
+    if (len < qlen) return;
+    int end = exact ? 0 : match(path, len, q, qlen);
+    if (end < 0) return;
+    if (keep) keep->cand[keep->ncand++] = i;
+    const int base = l->base[i];
+    if (*count == max && best_possible(path, len, base, q, qlen) <= out[max - 1].score) return;
+    if (exact) end = match(path, len, q, qlen);
+    int in_name_end = -1;
+    if (len - base >= qlen) {
+        in_name_end = match(path + base, len - base, q, qlen);
+        if (in_name_end >= 0) in_name_end += base;
+    }
+    const int32_t score = score_match(path, len, base, q, qlen, end, in_name_end);
+    if (*count < max || score > out[max - 1].score) keep_best(out, count, max, i, score);
+}
+
+int ff_query(const FileList *l, FileQuery *state, const char *query, FileMatch *out, int max) {
+    char q[FF_QUERY_MAX];
+    int qlen = 0;
+    for (; *query && qlen < FF_QUERY_MAX - 1; query++) {
+        if (*query == ' ') continue;
+        q[qlen++] = *query == '\\' ? '/' : (char)fold((unsigned char)*query);
+    }
+    q[qlen] = '\0';
+    if (qlen == 0 || max <= 0 || l->count == 0) {
+        if (state) state->valid = false;
+        return 0;
+    }
+
+    // A query extending the last one only matches paths that one matched
+    const FfKernels kernels = pick_kernels();
+    const uint64_t want = ff_char_mask(q, (size_t)qlen);
+    int count = 0;
+    if (state && state->valid && state->generation == l->generation &&
+        strncmp(state->query, q, strlen(state->query)) == 0) {
+        const uint32_t n = state->ncand;
+        state->ncand = 0;               // rewritten in place, never ahead of the reads
+        for (uint32_t c = 0; c < n; c++) {
+            const uint32_t i = state->cand[c];
+            if ((l->masks[i] & want) == want) try_path(l, kernels.match, i, q, qlen, false, out, &count, max, state);
+        }
+        memcpy(state->query, q, (size_t)qlen + 1);
+        return count;
+    }
+
+    FileQuery *keep = NULL;
+    if (state) {
+        state->valid = false;
+        state->ncand = 0;
+        if (state->cap < l->count) {
+            free(state->cand);
+            state->cand = (uint32_t *)malloc((size_t)l->count * sizeof(uint32_t));
+            state->cap = state->cand ? l->count : 0;
+        }
+        if (state->cand) keep = state;
+    }
+
+    const bool exact = qlen == 1 && char_bit((unsigned char)q[0]) != 63;
+    uint32_t pass[FF_BLOCK];
+    for (uint32_t first = 0; first < l->count; first += FF_BLOCK) {
+        const uint32_t n = l->count - first < FF_BLOCK ? l->count - first : FF_BLOCK;
+        const uint32_t k = kernels.prefilter(l->masks, first, n, want, pass);
+        for (uint32_t p = 0; p < k; p++) try_path(l, kernels.match, pass[p], q, qlen, exact, out, &count, max, keep);
+    }
+
+    if (keep) {
+        memcpy(keep->query, q, (size_t)qlen + 1);
+        keep->generation = l->generation;
+        keep->valid = true;
+    }
+    return count;
+}
+
+// ===== Workspace Walk =====
+
+typedef struct {
+    FileIndexer *ix;
+    FileList    *l;
+    char         full[FF_PATH_MAX];
+    size_t       root_len;
+    bool         stop;              // cancelled or out of memory
+} FileWalk;
+
+// Report the files listed so far and check for a cancel, once a directory
+static bool walk_step(FileWalk *w) {
+    FileIndexer *ix = w->ix;
+    wofl_mutex_lock(&ix->lock);
+    ix->files_seen = w->l->count;
+    if (ix->cancel) w->stop = true;
+    wofl_mutex_unlock(&ix->lock);
+    return !w->stop;
+}
+
+static void visit_file(FileWalk *w, size_t len) {
+    if (w->l->count >= FF_FILES_MAX) return;
+    if (!ff_add(w->l, w->full + w->root_len + 1, len - w->root_len - 1)) w->stop = true;
+}
+
+// Hidden entries ('.git', indexes, ...) are skipped, and so are links,
+// which could lead back up the tree
+#ifdef _WIN32
+static void walk_dir(FileWalk *w, size_t len) {
+    wchar_t pattern[FF_PATH_MAX];
+    if (len + 2 >= FF_PATH_MAX || !walk_step(w)) return;
+    memcpy(w->full + len, "/*", 3);
+    const int wide = MultiByteToWideChar(CP_UTF8, 0, w->full, -1, pattern, FF_PATH_MAX);
+    w->full[len] = '\0';
+    if (!wide) return;
+
+    WIN32_FIND_DATAW fd;
+    HANDLE find = FindFirstFileW(pattern, &fd);
+    if (find == INVALID_HANDLE_VALUE) return;
+    do {
+        char name[FF_PATH_MAX];
+        if (fd.cFileName[0] == L'.' || (fd.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT)) continue;
+        const int n = WideCharToMultiByte(CP_UTF8, 0, fd.cFileName, -1, name, (int)sizeof(name), NULL, NULL);
+        if (n <= 1 || len + (size_t)n >= FF_PATH_MAX) continue;
+        w->full[len] = '/';
+        memcpy(w->full + len + 1, name, (size_t)n);
+        if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            walk_dir(w, len + (size_t)n);
+        } else {
+            visit_file(w, len + (size_t)n);
+        }
+    } while (!w->stop && FindNextFileW(find, &fd));
+    FindClose(find);
+    w->full[len] = '\0';
+}
+#else
+// Entry types come from the directory itself where it has them, so most
+// entries are never stat'ed
+static void walk_dir(FileWalk *w, size_t len) {
+    if (!walk_step(w)) return;
+    DIR *dir = opendir(w->full);
+    if (!dir) return;
+#ifdef FF_INOTIFY
+    if (w->ix->watch_fd >= 0) inotify_add_watch(w->ix->watch_fd, w->full, FF_WATCH_EVENTS);
+#endif
+    struct dirent *e;
+    while (!w->stop && (e = readdir(dir)) != NULL) {
+        const char *name = e->d_name;
+        const size_t n = strlen(name);
+        if (name[0] == '.' || len + 1 + n >= FF_PATH_MAX) continue;
+        w->full[len] = '/';
+        memcpy(w->full + len + 1, name, n + 1);
+        bool is_dir = false, is_file = false;
+#ifdef _DIRENT_HAVE_D_TYPE
+        if (e->d_type != DT_UNKNOWN) {
+            is_dir = e->d_type == DT_DIR;
+            is_file = e->d_type == DT_REG;
+        } else
+#endif
+        {
+            struct stat st;
+            if (lstat(w->full, &st) != 0) continue;
+            is_dir = S_ISDIR(st.st_mode);
+            is_file = S_ISREG(st.st_mode);
+        }
+        if (is_dir) {
+            walk_dir(w, len + 1 + n);
+        } else if (is_file) {
+            visit_file(w, len + 1 + n);
+        }
+    }
+    closedir(dir);
+    w->full[len] = '\0';
+}
+#endif
+
+static bool same_list(const FileList *a, const FileList *b) {
+    return a && b && a->count == b->count && a->used == b->used && memcmp(a->pool, b->pool, a->used) == 0;
+}
+
+// A new list of the workspace as it is now, or NULL if nothing changed or
+// the walk was cancelled
+static FileList *walk(FileIndexer *ix, const FileList *old) {
+    FileWalk w;
+    memset(&w, 0, sizeof(w));
+    w.ix = ix;
+    w.l = (FileList *)malloc(sizeof(FileList));
+    if (!w.l) return NULL;
+    ff_init(w.l);
+    w.root_len = strlen(ix->root);
+    memcpy(w.full, ix->root, w.root_len + 1);
+    walk_dir(&w, w.root_len);
+
+    if (w.stop || same_list(w.l, old)) {
+        ff_free(w.l);
+        free(w.l);
+        return NULL;
+    }
+    return w.l;
+}
+
+// ===== Background Walker =====
+
+static void publish(FileIndexer *ix, FileList *l) {
+    wofl_mutex_lock(&ix->lock);
+    FileList *old = ix->list;
+    ix->list = l;
+    l->generation = ++ix->version;
+    wofl_mutex_unlock(&ix->lock);
+    if (old) {
+        ff_free(old);
+        free(old);
+    }
+}
+
+/**
+ * Walk again for every refresh asked for meanwhile. Only this thread
+ * replaces the list, so it reads the published one without the lock.
+ */
+static WOFL_THREAD_FN(ffx_worker) {
+    FileIndexer *ix = (FileIndexer *)arg;
+    for (;;) {
+        wofl_mutex_lock(&ix->lock);
+        ix->again = false;
+        ix->files_seen = 0;
+        const FileList *old = ix->list;
+        wofl_mutex_unlock(&ix->lock);
+
+        FileList *l = walk(ix, old);
+        if (l) publish(ix, l);
+
+        wofl_mutex_lock(&ix->lock);
+        const bool again = ix->again && !ix->cancel;
+        if (!again) ix->running = false;
+        wofl_mutex_unlock(&ix->lock);
+        if (!again) break;
+    }
+    WOFL_THREAD_RETURN;
+}
+
+void ffx_init(FileIndexer *ix) {
+    memset(ix, 0, sizeof(*ix));
+    ix->watch_fd = -1;
+    wofl_mutex_init(&ix->lock);
+}
+
+void ffx_free(FileIndexer *ix) {
+    ffx_stop(ix);
+    if (ix->list) {
+        ff_free(ix->list);
+        free(ix->list);
+    }
+    ff_query_free(&ix->last);
+    wofl_mutex_destroy(&ix->lock);
+}
+
+static void ffx_run(FileIndexer *ix) {
+    if (ix->started) {
+        wofl_thread_join(ix->thread);   // already past its loop
+        ix->started = false;
+    }
+    if (wofl_thread_start(&ix->thread, ffx_worker, ix)) {
+        ix->started = true;
+    } else {
+        ffx_worker(ix);  // no thread available: walk inline
+    }
+}
+
+void ffx_start(FileIndexer *ix, const char *root) {
+    ffx_stop(ix);
+    size_t len = strlen(root);
+    while (len > 1 && (root[len - 1] == '/' || root[len - 1] == '\\')) len--;
+    if (len == 0 || len >= FF_PATH_MAX) return;
+
+#ifdef FF_INOTIFY
+    ix->watch_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+    wofl_mutex_lock(&ix->lock);
+    FileList *old = ix->list;
+    ix->list = NULL;
+    ix->version++;
+    memcpy(ix->root, root, len);
+    ix->root[len] = '\0';
+    ix->cancel = false;
+    ix->running = true;
+    wofl_mutex_unlock(&ix->lock);
+    if (old) {
+        ff_free(old);
+        free(old);
+    }
+    ffx_run(ix);
+}
+
+void ffx_stop(FileIndexer *ix) {
+    wofl_mutex_lock(&ix->lock);
+    ix->cancel = true;
+    wofl_mutex_unlock(&ix->lock);
+
+    if (ix->started) {
+        wofl_thread_join(ix->thread);
+        ix->started = false;
+    }
+#ifdef FF_INOTIFY
+    if (ix->watch_fd >= 0) close(ix->watch_fd);
+#endif
+    ix->watch_fd = -1;
+
+    wofl_mutex_lock(&ix->lock);
+    ix->running = false;
+    wofl_mutex_unlock(&ix->lock);
+}
+
+void ffx_refresh(FileIndexer *ix) {
+    wofl_mutex_lock(&ix->lock);
+    const bool idle = !ix->running && !ix->cancel && ix->root[0];
+    if (ix->running) ix->again = true;
+    if (idle) ix->running = true;
+    wofl_mutex_unlock(&ix->lock);
+    if (idle) ffx_run(ix);
+}
+
+/**
+ * Any entry created, removed or renamed in a watched directory, other than
+ * a hidden one, means another walk; a burst of them while one runs comes
+ * to one more. New directories are watched by that walk. Watches a full
+ * kernel table refuses only mean changes there wait for the next walk.
+ */
+void ffx_poll(FileIndexer *ix) {
+#ifdef FF_INOTIFY
+    if (ix->watch_fd < 0) return;
+    char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    bool changed = false;
+    ssize_t n;
+    while ((n = read(ix->watch_fd, events, sizeof(events))) > 0) {
+        for (char *p = events; p < events + n; ) {
+            const struct inotify_event *ev = (const struct inotify_event *)p;
+            if (ev->mask & IN_Q_OVERFLOW) changed = true;
+            else if (ev->len > 0 && ev->name[0] != '.') changed = true;
+            p += sizeof(struct inotify_event) + ev->len;
+        }
+    }
+    if (changed) ffx_refresh(ix);
+#else
+    (void)ix;
+#endif
+}
+
+int ffx_query(FileIndexer *ix, const char *query, FileHit *out, int max) {
+    FileMatch *found = max > 0 ? (FileMatch *)malloc((size_t)max * sizeof(FileMatch)) : NULL;
+    if (!found) return 0;
+
+    wofl_mutex_lock(&ix->lock);
+    const FileList *l = ix->list;
+    const int count = l ? ff_query(l, &ix->last, query, found, max) : 0;
+    for (int i = 0; i < count; i++) {
+        snprintf(out[i].path, sizeof(out[i].path), "%s", ff_path(l, found[i].path));
+        out[i].score = found[i].score;
+    }
+    wofl_mutex_unlock(&ix->lock);
+    free(found);
+    return count;
+}
+
+uint64_t ffx_status(FileIndexer *ix, bool *running, uint32_t *files) {
+    wofl_mutex_lock(&ix->lock);
+    if (running) *running = ix->running;
+    if (files) *files = ix->running ? ix->files_seen : (ix->list ? ix->list->count : 0);
+    const uint64_t version = ix->version;
+    wofl_mutex_unlock(&ix->lock);
+    return version;
+}
@@ -0,0 +1,120 @@
+// ==================== file_finder.h ====================
+// Quick open: the files of the workspace, matched fuzzily as a name is typed
+//
+// A worker walks the workspace into a list of relative paths, kept in one
+// pool, and publishes it whole; on Linux every directory it walks is
+// watched with inotify, and an entry created, removed or renamed under one
+// sends it walking again. The list in use stays until the new one is in.
+//
+// A query matches a path when its characters appear in the path in order,
+// case ignored. Each path carries a 64-bit mask of the characters it holds,
+// in an array of their own, and the mask test rules out most paths 2 or 4
+// at a time before any path text is read. A path that passes is scored
+// over the shortest stretch holding the query, preferring matches inside
+// the file name, at word starts and in runs. The paths a query matched are
+// kept: the next query, if it extends this one, only tries those again.
+
+#ifndef WOFL_FILE_FINDER_H
+#define WOFL_FILE_FINDER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "wofl_thread.h"
+
+#define FF_PATH_MAX     1024
+#define FF_QUERY_MAX    256
+#define FF_FILES_MAX    (4u << 20)      // paths listed at most
+#define FF_NO_MATCH     INT32_MIN
+
+// ===== List =====
+
+typedef struct {
+    char     *pool;             // relative paths, '/'-separated, NUL-terminated
+    uint32_t  used, pool_cap;
+    uint64_t *masks;            // characters in each path (ff_char_mask())
+    uint32_t *offs;             // where each path starts in pool
+    uint16_t *lens;
+    uint16_t *base;             // where its file name starts in it
+    uint32_t  count, cap;
+    uint64_t  generation;       // set when published, for FileQuery
+} FileList;
+
+typedef struct {
+    uint32_t path;
+    int32_t  score;
+} FileMatch;
+
+// The paths the last query matched, for the next one to narrow down
+typedef struct {
+    char      query[FF_QUERY_MAX];
+    uint64_t  generation;       // of the list they index
+    uint32_t *cand;
+    uint32_t  ncand, cap;
+    bool      valid;
+} FileQuery;
+
+void  ff_init(FileList *l);
+void  ff_free(FileList *l);
+bool  ff_add(FileList *l, const char *path, size_t len);
+const char *ff_path(const FileList *l, uint32_t i);
+
+uint64_t ff_char_mask(const char *s, size_t len);
+
+// How well query matches path, or FF_NO_MATCH. The query is folded to
+// lower case already.
+int32_t ff_score(const char *path, int len, int base, const char *query, int qlen);
+
+void  ff_query_init(FileQuery *q);
+void  ff_query_free(FileQuery *q);
+
+/**
+ * Up to max best paths for query, best first. state, if given, carries
+ * the matches over to the next query. Case and spaces are ignored, and
+ * '\\' stands for '/'.
+ */
+int   ff_query(const FileList *l, FileQuery *state, const char *query, FileMatch *out, int max);
+
+// ===== Background Walker =====
+
+typedef struct {
+    char     path[FF_PATH_MAX];     // relative to the root
+    int32_t  score;
+} FileHit;
+
+typedef struct {
+    char         root[FF_PATH_MAX];
+    wofl_mutex   lock;
+    wofl_thread  thread;
+    bool         started;           // thread handle needs joining
+    int          watch_fd;          // inotify, or -1
+
+    // Everything below is guarded by lock
+    bool         running;           // worker walking the workspace
+    bool         cancel;
+    bool         again;             // walk again when done
+    FileList    *list;              // published, replaced whole
+    uint64_t     version;           // bumped per list published
+    uint32_t     files_seen;        // by the walk under way
+    FileQuery    last;              // what the last ffx_query() matched
+} FileIndexer;
+
+void ffx_init(FileIndexer *ix);
+void ffx_free(FileIndexer *ix);
+
+// List the files under root, watching it for changes where possible
+void ffx_start(FileIndexer *ix, const char *root);
+void ffx_stop(FileIndexer *ix);
+void ffx_refresh(FileIndexer *ix);
+
+// Without the lock: read what the watches saw; a change starts a walk
+void ffx_poll(FileIndexer *ix);
+
+// Without the lock: best matches for query, copied out; returns how many
+int  ffx_query(FileIndexer *ix, const char *query, FileHit *out, int max);
+
+// Without the lock: whether a walk is under way and the files listed (or
+// seen so far). Returns the list version.
+uint64_t ffx_status(FileIndexer *ix, bool *running, uint32_t *files);
+
+#endif // WOFL_FILE_FINDER_H
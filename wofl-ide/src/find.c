@@ -114,11 +114,10 @@ bool find_replace(AppState *app, const wchar_t *needle, const wchar_t *replaceme
     if (match_at_position(&app->buf, start, needle, case_ins)) {
         // Delete matched text
         size_t needle_len = wcslen(needle);
-        gb_delete_range(&app->buf, start, needle_len);
+        editor_buf_delete(app, start, needle_len);
         
         // Insert replacement
-        gb_move_gap(&app->buf, start);
-        gb_insert(&app->buf, replacement, wcslen(replacement));
+        editor_buf_insert(app, start, replacement, wcslen(replacement));
         
         // Update caret position
         editor_index_to_linecol(&app->buf, start + wcslen(replacement), 
@@ -0,0 +1,366 @@
+// ==================== fold_tree.c ====================
+// Treap of collapsed folds with hidden-row counts (see fold_tree.h)
+
+#include "fold_tree.h"
+#include <stdlib.h>
+#include <string.h>
+
+struct FoldNode {
+    FoldNode *left, *right;
+    FoldNode *inner;            // folds collapsed inside, headers relative to ours
+    FoldNode *next;             // next in an inner list
+    size_t start, last;         // header line and last hidden line
+    size_t max_last;            // largest last in this subtree
+    size_t weight;              // rows this fold hides
+    size_t hidden;              // rows hidden by this subtree
+    size_t shift;               // still to add to everything in both children
+    uint32_t prio;
+};
+
+// ===== Nodes =====
+
+static size_t hid(const FoldNode *n) { return n ? n->hidden : 0; }
+
+static void free_node(FoldNode *n) {
+    if (!n) return;
+    free_node(n->left);
+    free_node(n->right);
+    for (FoldNode *in = n->inner, *next; in; in = next) {
+        next = in->next;
+        in->left = in->right = NULL;
+        free_node(in);
+    }
+    free(n);
+}
+
+static void add_shift(FoldNode *n, size_t by) {
+    if (!n) return;
+    n->start += by;
+    n->last += by;
+    n->max_last += by;
+    n->shift += by;
+}
+
+static void push(FoldNode *n) {
+    if (n->shift) {
+        add_shift(n->left, n->shift);
+        add_shift(n->right, n->shift);
+        n->shift = 0;
+    }
+}
+
+// After push(): the children hold their true lines
+static void pull(FoldNode *n) {
+    n->hidden = n->weight + hid(n->left) + hid(n->right);
+    n->max_last = n->last;
+    if (n->left && n->left->max_last > n->max_last) n->max_last = n->left->max_last;
+    if (n->right && n->right->max_last > n->max_last) n->max_last = n->right->max_last;
+}
+
+static size_t rows_before(const FoldTree *ft, size_t line) {
+    return ft->rows ? ft->rows(ft->rows_ctx, line) : line;
+}
+
+static size_t weigh(const FoldTree *ft, size_t start, size_t last) {
+    if (ft->defer) return last - start;
+    return rows_before(ft, last + 1) - rows_before(ft, start + 1);
+}
+
+static uint32_t next_prio(FoldTree *ft) {
+    uint32_t x = ft->seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return ft->seed = x;
+}
+
+// ===== Split and merge =====
+
+// Headers below key go to *lo, the rest to *hi
+static void split(FoldNode *n, size_t key, FoldNode **lo, FoldNode **hi) {
+    if (!n) {
+        *lo = *hi = NULL;
+        return;
+    }
+    push(n);
+    if (n->start < key) {
+        split(n->right, key, &n->right, hi);
+        *lo = n;
+    } else {
+        split(n->left, key, lo, &n->left);
+        *hi = n;
+    }
+    pull(n);
+}
+
+// Every header in a below every header in b
+static FoldNode *merge(FoldNode *a, FoldNode *b) {
+    if (!a) return b;
+    if (!b) return a;
+    if (a->prio > b->prio) {
+        push(a);
+        a->right = merge(a->right, b);
+        pull(a);
+        return a;
+    }
+    push(b);
+    b->left = merge(a, b->left);
+    pull(b);
+    return b;
+}
+
+// Take the fold headed by `header` out of the tree, or NULL
+static FoldNode *take(FoldTree *ft, size_t header) {
+    FoldNode *lo, *mid, *hi;
+    split(ft->root, header, &lo, &hi);
+    split(hi, header + 1, &mid, &hi);
+    ft->root = merge(lo, hi);
+    return mid;
+}
+
+// The fold with the greatest header below `line`, with its true lines
+static const FoldNode *before(const FoldTree *ft, size_t line, size_t *start, size_t *last) {
+    const FoldNode *best = NULL;
+    size_t add = 0;
+    for (const FoldNode *n = ft->root; n;) {
+        if (n->start + add < line) {
+            best = n;
+            *start = n->start + add;
+            *last = n->last + add;
+            add += n->shift;
+            n = n->right;
+        } else {
+            add += n->shift;
+            n = n->left;
+        }
+    }
+    return best;
+}
+
+// ===== Tree =====
+
+void ft_init(FoldTree *ft) {
+    memset(ft, 0, sizeof(*ft));
+    ft->seed = 0x9E3779B9u;
+}
+
+void ft_free(FoldTree *ft) {
+    ft_clear(ft);
+}
+
+void ft_clear(FoldTree *ft) {
+    free_node(ft->root);
+    ft->root = NULL;
+}
+
+void ft_set_rows(FoldTree *ft, FoldRows rows, void *ctx) {
+    ft->rows = rows;
+    ft->rows_ctx = ctx;
+    ft_reweigh(ft);
+}
+
+static void reweigh(const FoldTree *ft, FoldNode *n) {
+    if (!n) return;
+    push(n);
+    reweigh(ft, n->left);
+    reweigh(ft, n->right);
+    n->weight = weigh(ft, n->start, n->last);
+    pull(n);
+}
+
+void ft_reweigh(FoldTree *ft) {
+    reweigh(ft, ft->root);
+}
+
+size_t ft_hidden_rows(const FoldTree *ft) {
+    return hid(ft->root);
+}
+
+// Unlink a subtree into a list in header order, headers relative to `base`
+static FoldNode **flatten(FoldNode *n, size_t base, FoldNode **tail) {
+    if (!n) return tail;
+    push(n);
+    FoldNode *right = n->right;
+    tail = flatten(n->left, base, tail);
+    n->start -= base;
+    n->last -= base;
+    n->left = n->right = n->next = NULL;
+    *tail = n;
+    return flatten(right, base, &n->next);
+}
+
+bool ft_fold(FoldTree *ft, size_t header, size_t last) {
+    if (last <= header || ft_is_hidden(ft, header) || ft_is_header(ft, header, NULL)) return false;
+
+    // Folds inside go along; one reaching past `last` would cross
+    FoldNode *lo, *mid, *hi;
+    split(ft->root, header, &lo, &hi);
+    split(hi, last + 1, &mid, &hi);
+    FoldNode *n = NULL;
+    if (!(mid && mid->max_last > last)) n = (FoldNode *)calloc(1, sizeof(FoldNode));
+    if (!n) {
+        ft->root = merge(lo, merge(mid, hi));
+        return false;
+    }
+    flatten(mid, header, &n->inner);
+    n->start = header;
+    n->last = last;
+    n->weight = weigh(ft, header, last);
+    n->prio = next_prio(ft);
+    pull(n);
+    ft->root = merge(lo, merge(n, hi));
+    return true;
+}
+
+bool ft_unfold(FoldTree *ft, size_t header) {
+    FoldNode *n = take(ft, header);
+    if (!n) return false;
+
+    // Inner folds are disjoint and in order, so they append as they come
+    FoldNode *inner = NULL;
+    for (FoldNode *in = n->inner, *next; in; in = next) {
+        next = in->next;
+        in->next = NULL;
+        in->start += header;
+        in->last += header;
+        in->weight = weigh(ft, in->start, in->last);
+        in->prio = next_prio(ft);
+        pull(in);
+        inner = merge(inner, in);
+    }
+    FoldNode *lo, *hi;
+    split(ft->root, header, &lo, &hi);
+    ft->root = merge(lo, merge(inner, hi));
+    free(n);
+    return true;
+}
+
+void ft_reveal(FoldTree *ft, size_t line) {
+    size_t start, last;
+    while (before(ft, line, &start, &last) && last >= line) {
+        ft_unfold(ft, start);
+    }
+}
+
+bool ft_is_header(const FoldTree *ft, size_t line, size_t *last) {
+    size_t start, end;
+    if (!before(ft, line + 1, &start, &end) || start != line) return false;
+    if (last) *last = end;
+    return true;
+}
+
+bool ft_is_hidden(const FoldTree *ft, size_t line) {
+    size_t start, last;
+    return before(ft, line, &start, &last) && last >= line;
+}
+
+// ===== Rows =====
+
+size_t ft_row_of(const FoldTree *ft, size_t line) {
+    size_t hidden = 0, add = 0;
+    for (const FoldNode *n = ft->root; n;) {
+        size_t start = n->start + add, last = n->last + add;
+        add += n->shift;
+        if (line <= start) {
+            n = n->left;
+            continue;
+        }
+        hidden += hid(n->left);
+        if (line <= last) {
+            // Folds are disjoint: none further right starts before line
+            line = start;
+            break;
+        }
+        hidden += n->weight;
+        n = n->right;
+    }
+    return rows_before(ft, line) - hidden;
+}
+
+/**
+ * Descend to the last header whose rows end after `row` once the rows
+ * hidden before it are taken out; everything hidden before that adds back.
+ */
+size_t ft_unfolded_row(const FoldTree *ft, size_t row) {
+    size_t hidden = 0, add = 0;
+    for (const FoldNode *n = ft->root; n;) {
+        size_t start = n->start + add;
+        add += n->shift;
+        if (row < rows_before(ft, start + 1) - hidden - hid(n->left)) {
+            n = n->left;
+        } else {
+            hidden += hid(n->left) + n->weight;
+            n = n->right;
+        }
+    }
+    return row + hidden;
+}
+
+// ===== Queries =====
+
+static void collect(const FoldNode *n, size_t add, size_t lo, size_t hi,
+                    FoldRange *out, int max, int *count) {
+    // max_last prunes subtrees that end before the range
+    if (!n || *count >= max || n->max_last + add < lo) return;
+    size_t start = n->start + add, last = n->last + add;
+    add += n->shift;
+    collect(n->left, add, lo, hi, out, max, count);
+    if (start + 1 >= hi) return;
+    if (last >= lo && *count < max) {
+        out[*count].first = start + 1;
+        out[*count].last = last;
+        (*count)++;
+    }
+    collect(n->right, add, lo, hi, out, max, count);
+}
+
+int ft_hidden_in(const FoldTree *ft, size_t lo, size_t hi, FoldRange *out, int max) {
+    int count = 0;
+    collect(ft->root, 0, lo, hi, out, max, &count);
+    return count;
+}
+
+// ===== Edits =====
+
+void ft_note_edit(FoldTree *ft, size_t line, long delta) {
+    if (!ft->root) return;
+    if (delta == 0) {
+        // Only a hidden line's rows can change the folds
+        ft_reveal(ft, line);
+        return;
+    }
+    size_t gone = delta < 0 ? (size_t)-delta : 0;
+
+    // Open what the change reaches into; drop what it removes whole. Rows
+    // are counted on the edited text, where folds taken along by the ones
+    // opened are not in place yet, so they are weighed once all is moved.
+    bool opened = false;
+    ft->defer = true;
+    for (;;) {
+        FoldRange hit;
+        size_t start, last;
+        if (ft_hidden_in(ft, line, line + gone + 1, &hit, 1)) {
+            start = hit.first - 1;
+            last = hit.last;
+        } else if (ft_is_header(ft, line, &last)) {
+            start = line;
+        } else if (gone && ft_is_header(ft, line + gone, &last)) {
+            start = line + gone;
+        } else {
+            break;
+        }
+        if (start > line && last <= line + gone) {
+            free_node(take(ft, start));
+        } else {
+            ft_unfold(ft, start);
+            opened = true;
+        }
+    }
+    ft->defer = false;
+
+    FoldNode *lo, *hi;
+    split(ft->root, line + 1, &lo, &hi);
+    add_shift(hi, (size_t)delta);
+    ft->root = merge(lo, hi);
+    if (opened) ft_reweigh(ft);
+}
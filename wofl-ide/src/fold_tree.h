@@ -0,0 +1,78 @@
+// ==================== fold_tree.h ====================
+// Collapsed folds, and the mapping between screen rows and lines they imply
+//
+// A fold keeps its header line on screen and hides the lines after it,
+// through its last line. Folds in the tree never overlap: folding around
+// collapsed folds takes them along, to come back collapsed when the outer
+// one is opened, and a fold may not cross one. The tree is an interval
+// tree on a treap ordered by header line; each node also counts the rows
+// hidden below it and carries a pending shift for its subtrees, so row <->
+// line lookups, range queries and the shift after an edit are O(log n).
+//
+// Rows are lines unless a row function is set: with soft wrap, the rows
+// of the text before a line. Folds are weighed with it when they are made
+// and again on ft_reweigh(), which is due whenever it changes.
+
+#ifndef WOFL_FOLD_TREE_H
+#define WOFL_FOLD_TREE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct FoldNode FoldNode;
+
+// Rows before `line` in the text without folds
+typedef size_t (*FoldRows)(void *ctx, size_t line);
+
+typedef struct {
+    FoldNode *root;
+    uint32_t seed;              // treap priorities
+    FoldRows rows;              // NULL: one row per line
+    void *rows_ctx;
+    bool defer;                 // weighing put off until an edit is done
+} FoldTree;
+
+// Lines hidden by one fold, [first, last]
+typedef struct {
+    size_t first, last;
+} FoldRange;
+
+void   ft_init(FoldTree *ft);
+void   ft_free(FoldTree *ft);
+void   ft_clear(FoldTree *ft);
+void   ft_set_rows(FoldTree *ft, FoldRows rows, void *ctx);
+void   ft_reweigh(FoldTree *ft);
+size_t ft_hidden_rows(const FoldTree *ft);
+
+/**
+ * Collapse lines header + 1 .. last under header. Fails if header is
+ * hidden or already a fold's header, or the fold would cross another.
+ */
+bool   ft_fold(FoldTree *ft, size_t header, size_t last);
+
+// Open the fold headed by header; folds it took along reappear collapsed
+bool   ft_unfold(FoldTree *ft, size_t header);
+
+// Open every fold that hides line
+void   ft_reveal(FoldTree *ft, size_t line);
+
+bool   ft_is_header(const FoldTree *ft, size_t line, size_t *last);
+bool   ft_is_hidden(const FoldTree *ft, size_t line);
+
+// First row of a line; hidden lines map to their header's. Rows
+// unfolded are rows of the text as if nothing were folded.
+size_t ft_row_of(const FoldTree *ft, size_t line);
+size_t ft_unfolded_row(const FoldTree *ft, size_t row);
+
+// Hidden ranges that overlap lines [lo, hi), in order; returns how many
+int    ft_hidden_in(const FoldTree *ft, size_t lo, size_t hi, FoldRange *out, int max);
+
+/**
+ * `line` was edited and `delta` lines added after it (removed, if
+ * negative). Folds the change reaches into are opened, or dropped if
+ * their lines are gone; later folds move with the text.
+ */
+void   ft_note_edit(FoldTree *ft, size_t line, long delta);
+
+#endif // WOFL_FOLD_TREE_H
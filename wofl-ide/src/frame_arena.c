@@ -0,0 +1,80 @@
+// ==================== frame_arena.c ====================
+// Per-frame bump allocator (see frame_arena.h)
+
+#include "frame_arena.h"
+#include <stdlib.h>
+
+#define FA_ALIGN 16
+
+struct FaChunk {
+    FaChunk *prev;
+    size_t   size;              // usable bytes after the header
+};
+
+// Header rounded up so chunk data stays aligned
+#define FA_HEADER ((sizeof(FaChunk) + FA_ALIGN - 1) & ~(size_t)(FA_ALIGN - 1))
+
+static FaChunk *fa_chunk_new(size_t size) {
+    FaChunk *c = (FaChunk *)malloc(FA_HEADER + size);
+    if (!c) return NULL;
+    c->prev = NULL;
+    c->size = size;
+    return c;
+}
+
+void fa_init(FrameArena *fa) {
+    fa->head = NULL;
+    fa->used = 0;
+    fa->total = 0;
+    fa->peak = 0;
+    fa->frame = 0;
+}
+
+void fa_free(FrameArena *fa) {
+    FaChunk *c = fa->head;
+    while (c) {
+        FaChunk *prev = c->prev;
+        free(c);
+        c = prev;
+    }
+    fa_init(fa);
+}
+
+/**
+ * Start a new frame. If the last one spilled into several chunks they are
+ * replaced by one chunk big enough for the largest frame seen.
+ */
+void fa_reset(FrameArena *fa) {
+    if (fa->frame > fa->peak) fa->peak = fa->frame;
+    fa->frame = 0;
+    fa->used = 0;
+    if (!fa->head || !fa->head->prev) return;
+
+    size_t want = fa->peak > FA_MIN_CHUNK ? fa->peak : FA_MIN_CHUNK;
+    fa_free(fa);
+    fa->peak = want;
+    fa->head = fa_chunk_new(want);
+    if (fa->head) fa->total = want;
+}
+
+void *fa_alloc(FrameArena *fa, size_t bytes) {
+    bytes = (bytes + FA_ALIGN - 1) & ~(size_t)(FA_ALIGN - 1);
+    if (bytes == 0) bytes = FA_ALIGN;
+
+    if (!fa->head || fa->head->size - fa->used < bytes) {
+        // Double the arena, and always fit the request
+        size_t size = fa->total > FA_MIN_CHUNK ? fa->total : FA_MIN_CHUNK;
+        if (size < bytes) size = bytes;
+        FaChunk *c = fa_chunk_new(size);
+        if (!c) return NULL;
+        c->prev = fa->head;
+        fa->head = c;
+        fa->used = 0;
+        fa->total += size;
+    }
+
+    void *p = (char *)fa->head + FA_HEADER + fa->used;
+    fa->used += bytes;
+    fa->frame += bytes;
+    return p;
+}
@@ -0,0 +1,40 @@
+// ==================== frame_arena.h ====================
+// Per-frame bump allocator for line text and token arrays
+//
+// Everything allocated while painting one frame is released at once by
+// fa_reset() at the start of the next. The arena grows by chaining chunks;
+// a reset folds them into a single chunk, so after a few frames painting
+// costs no heap traffic at all.
+
+#ifndef WOFL_FRAME_ARENA_H
+#define WOFL_FRAME_ARENA_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#define FA_MIN_CHUNK  (64u * 1024)
+
+typedef struct FaChunk FaChunk;
+
+typedef struct {
+    FaChunk *head;              // chunk being carved, newest first
+    size_t   used;              // bytes taken from head
+    size_t   total;             // capacity of all chunks
+    size_t   peak;              // most bytes used by one frame so far
+    size_t   frame;             // bytes used by this frame
+} FrameArena;
+
+void  fa_init(FrameArena *fa);
+void  fa_free(FrameArena *fa);
+void  fa_reset(FrameArena *fa);
+
+/**
+ * `bytes` of storage, 16-byte aligned, valid until the next fa_reset().
+ * Returns NULL only when the heap is exhausted.
+ */
+void *fa_alloc(FrameArena *fa, size_t bytes);
+
+// Typed helper: fa_new(fa, TokenSpan, n)
+#define fa_new(fa, type, n) ((type *)fa_alloc((fa), sizeof(type) * (size_t)(n)))
+
+#endif // WOFL_FRAME_ARENA_H
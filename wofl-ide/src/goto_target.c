@@ -0,0 +1,112 @@
+// ==================== goto_target.c ====================
+// Go-to prompt parsing and line index lookups
+
+#include "goto_target.h"
+
+// ===== Parsing =====
+
+// Digits at *s, saturating; false if there are none
+static bool parse_number(const char **s, size_t *out) {
+    const char *p = *s;
+    size_t n = 0;
+    if (*p < '0' || *p > '9') return false;
+    for (; *p >= '0' && *p <= '9'; p++) {
+        const size_t d = (size_t)(*p - '0');
+        n = n > ((size_t)-1 - d) / 10 ? (size_t)-1 : n * 10 + d;
+    }
+    *s = p;
+    *out = n;
+    return true;
+}
+
+static const char *skip_spaces(const char *s) {
+    while (*s == ' ' || *s == '\t') s++;
+    return s;
+}
+
+// Up to two decimals of a percentage, as hundredths
+static bool parse_percent(const char *s, const char *end, unsigned *out) {
+    size_t whole;
+    if (!parse_number(&s, &whole)) return false;
+    size_t frac = 0;
+    int places = 0;
+    if (*s == '.') {
+        for (s++; *s >= '0' && *s <= '9'; s++) {
+            if (places < 2) frac = frac * 10 + (size_t)(*s - '0'), places++;
+        }
+    }
+    if (s != end) return false;
+    while (places < 2) frac *= 10, places++;
+    *out = whole >= 100 ? GOTO_PERCENT_MAX : (unsigned)(whole * 100 + frac);
+    return true;
+}
+
+bool goto_parse(const char *text, GotoTarget *t) {
+    const char *s = skip_spaces(text);
+    const char *end = s;
+    while (*end) end++;
+    while (end > s && (end[-1] == ' ' || end[-1] == '\t')) end--;
+    if (s == end) return false;
+
+    t->line = t->offset = 0;
+    t->col = GOTO_KEEP_COL;
+    t->percent = 0;
+
+    if (end[-1] == '%') {
+        t->kind = GOTO_PERCENT;
+        return parse_percent(s, end - 1, &t->percent);
+    }
+    if (*s == '@') {
+        s++;
+        t->kind = GOTO_OFFSET;
+        return parse_number(&s, &t->offset) && s == end;
+    }
+
+    size_t line, col;
+    t->kind = GOTO_LINE;
+    if (!parse_number(&s, &line)) return false;
+    t->line = line ? line - 1 : 0;
+    if (s == end) return true;
+    if (*s++ != ':' || !parse_number(&s, &col) || s != end) return false;
+    t->col = col ? col - 1 : 0;
+    return true;
+}
+
+bool goto_char_ok(int ch) {
+    return (ch >= '0' && ch <= '9') || ch == ':' || ch == '%' || ch == '.' || ch == '@';
+}
+
+size_t goto_percent_line(unsigned percent, size_t count) {
+    if (count == 0) return 0;
+    if (percent > GOTO_PERCENT_MAX) percent = GOTO_PERCENT_MAX;
+    return (size_t)((unsigned long long)(count - 1) * percent / GOTO_PERCENT_MAX);
+}
+
+// ===== Lookup =====
+
+void goto_resolve(const GotoTarget *t, const LineIndex *li, size_t *line, size_t *col) {
+    const size_t count = li_line_count(li);
+    const size_t last = count ? count - 1 : 0;
+    size_t want = *col;
+
+    switch (t->kind) {
+        case GOTO_OFFSET: {
+            const size_t total = li_total_units(li);
+            const size_t pos = t->offset < total ? t->offset : total;
+            *line = li_line_of(li, pos);
+            if (*line > last) *line = last;
+            want = pos - li_line_start(li, *line);
+            break;
+        }
+        case GOTO_PERCENT:
+            *line = goto_percent_line(t->percent, count);
+            break;
+        case GOTO_LINE:
+            *line = t->line < last ? t->line : last;
+            if (t->col != GOTO_KEEP_COL) want = t->col;
+            break;
+    }
+
+    const size_t len = li_line_length(li, *line);
+    *col = want < len ? want : len;
+}
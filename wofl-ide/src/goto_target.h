@@ -0,0 +1,53 @@
+// ==================== goto_target.h ====================
+// Go-to targets: what the go-to prompt accepts, and where it lands
+//
+// The prompt takes a line, a line and column, a share of the file or an
+// offset into it:
+//
+//     120         line 120, the caret keeping its column
+//     120:8       line 120, column 8
+//     40%  12.5%  that far down the file's lines
+//     @65536      the 65536th unit of the text, counted from 0
+//
+// Lines and columns count from 1 as shown. Everything is looked up in the
+// line index, so a jump costs O(log n) however far it goes, and lands in
+// the part of the file indexed so far.
+
+#ifndef WOFL_GOTO_TARGET_H
+#define WOFL_GOTO_TARGET_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "line_index.h"
+
+typedef enum {
+    GOTO_LINE,                  // line, and col unless it is GOTO_KEEP_COL
+    GOTO_PERCENT,               // hundredths of a percent of the lines
+    GOTO_OFFSET                 // units from the start of the text
+} GotoKind;
+
+#define GOTO_KEEP_COL   ((size_t)-1)
+#define GOTO_PERCENT_MAX 10000  // 100%
+
+typedef struct {
+    GotoKind kind;
+    size_t   line, col;         // from 0
+    size_t   offset;
+    unsigned percent;
+} GotoTarget;
+
+// Parse prompt text; false if it is none of the forms above
+bool   goto_parse(const char *text, GotoTarget *t);
+// Characters the prompt lets through
+bool   goto_char_ok(int ch);
+// Line at percent (GOTO_PERCENT_MAX = all) of count lines
+size_t goto_percent_line(unsigned percent, size_t count);
+
+/**
+ * Line and column of t in the index, clamped to the lines counted and the
+ * line's length. Without a column the caret's, col, is kept where the line
+ * is long enough. Expects the index's lock to be held.
+ */
+void   goto_resolve(const GotoTarget *t, const LineIndex *li, size_t *line, size_t *col);
+
+#endif // WOFL_GOTO_TARGET_H
@@ -0,0 +1,247 @@
+// ==================== lang_registry.c ====================
+// Language registry: one open-addressing hash table keyed on lower-case
+// file names (".bashrc"), extensions (".py") and shebang interpreters
+// ("#!python")
+
+#include "lang_registry.h"
+#include "syntax_gen.h"
+#include "lexer.h"
+#include "wofl_thread.h"
+#include <string.h>
+
+#define LANG_TABLE_SIZE   256     // power of two, several times the key count
+#define LANG_KEY_MAX      64
+
+// ===== Scanners =====
+
+// Plain text scanner
+void syntax_scan_plain(const wchar_t *line, int len, TokenSpan *out, int *out_n) {
+    (void)line;
+    out[0] = (TokenSpan){0, (size_t)len, TK_TEXT};
+    *out_n = 1;
+}
+
+static const LangInfo lang_infos[LANG_MAX] = {
+    [LANG_NONE] = { "Plain Text", { syntax_scan_plain, NULL } },
+    [LANG_C]    = { "C",          { syntax_scan_c, &lex_c } },
+    [LANG_CPP]  = { "C++",        { syntax_scan_cpp, &lex_cpp } },
+    [LANG_ASM]  = { "Assembly",   { syntax_scan_asm, &lex_asm } },
+    [LANG_CSV]  = { "CSV",        { syntax_scan_csv, NULL } },
+    [LANG_PY]   = { "Python",     { syntax_scan_py, &lex_py } },
+    [LANG_JS]   = { "JavaScript", { syntax_scan_js, &lex_js } },
+    [LANG_HTML] = { "HTML",       { syntax_scan_html, NULL } },
+    [LANG_CSS]  = { "CSS",        { syntax_scan_css, &lex_css } },
+    [LANG_JSON] = { "JSON",       { syntax_scan_json, &lex_json } },
+    [LANG_MD]   = { "Markdown",   { syntax_scan_md, NULL } },
+    [LANG_GO]   = { "Go",         { syntax_scan_go, &lex_go } },
+    [LANG_RS]   = { "Rust",       { syntax_scan_rs, &lex_rs } },
+    [LANG_SH]   = { "Shell",      { syntax_scan_sh, &lex_sh } },
+    [LANG_LUA]  = { "Lua",        { syntax_scan_lua, &lex_lua } },
+};
+
+// ===== Keys =====
+
+typedef struct {
+    const char *key;
+    Language    lang;
+} LangKey;
+
+static const LangKey lang_keys[] = {
+    // Extensions
+    { ".c", LANG_C }, { ".h", LANG_C },
+    { ".cpp", LANG_CPP }, { ".hpp", LANG_CPP }, { ".cc", LANG_CPP },
+    { ".cxx", LANG_CPP }, { ".hh", LANG_CPP }, { ".hxx", LANG_CPP },
+    { ".asm", LANG_ASM }, { ".s", LANG_ASM }, { ".nasm", LANG_ASM },
+    { ".csv", LANG_CSV }, { ".tsv", LANG_CSV },
+    { ".py", LANG_PY }, { ".pyw", LANG_PY }, { ".pyi", LANG_PY },
+    { ".js", LANG_JS }, { ".mjs", LANG_JS }, { ".cjs", LANG_JS },
+    { ".jsx", LANG_JS }, { ".ts", LANG_JS }, { ".tsx", LANG_JS },
+    { ".html", LANG_HTML }, { ".htm", LANG_HTML }, { ".xhtml", LANG_HTML },
+    { ".xml", LANG_HTML }, { ".svg", LANG_HTML },
+    { ".css", LANG_CSS }, { ".scss", LANG_CSS }, { ".less", LANG_CSS },
+    { ".json", LANG_JSON }, { ".jsonc", LANG_JSON },
+    { ".md", LANG_MD }, { ".markdown", LANG_MD },
+    { ".go", LANG_GO },
+    { ".rs", LANG_RS },
+    { ".sh", LANG_SH }, { ".bash", LANG_SH }, { ".zsh", LANG_SH }, { ".ksh", LANG_SH },
+    { ".lua", LANG_LUA },
+
+    // Whole file names
+    { "makefile", LANG_SH }, { "gnumakefile", LANG_SH },
+    { ".bashrc", LANG_SH }, { ".bash_profile", LANG_SH }, { ".profile", LANG_SH },
+    { ".zshrc", LANG_SH }, { "pkgbuild", LANG_SH },
+    { "sconstruct", LANG_PY }, { "sconscript", LANG_PY }, { "wscript", LANG_PY },
+
+    // Shebang interpreters, version suffix stripped
+    { "#!python", LANG_PY },
+    { "#!sh", LANG_SH }, { "#!bash", LANG_SH }, { "#!zsh", LANG_SH },
+    { "#!dash", LANG_SH }, { "#!ksh", LANG_SH },
+    { "#!node", LANG_JS }, { "#!nodejs", LANG_JS },
+    { "#!lua", LANG_LUA }, { "#!luajit", LANG_LUA },
+};
+
+// ===== Hash table =====
+
+static const LangKey *lang_table[LANG_TABLE_SIZE];
+static wofl_once lang_table_once = WOFL_ONCE_INIT;
+
+static char lower_ascii(char c) {
+    return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+// FNV-1a over the lower-cased key
+static unsigned lang_hash(const char *s, size_t n) {
+    unsigned h = 2166136261u;
+    for (size_t i = 0; i < n; i++) {
+        h ^= (unsigned char)lower_ascii(s[i]);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// Built once, on first use from any thread: the UI and the workspace
+// symbol worker both detect languages
+static void lang_table_build(void) {
+    for (size_t k = 0; k < sizeof(lang_keys) / sizeof(lang_keys[0]); k++) {
+        const char *key = lang_keys[k].key;
+        unsigned slot = lang_hash(key, strlen(key)) & (LANG_TABLE_SIZE - 1);
+        while (lang_table[slot]) slot = (slot + 1) & (LANG_TABLE_SIZE - 1);
+        lang_table[slot] = &lang_keys[k];
+    }
+}
+
+static Language lang_lookup(const char *s, size_t n) {
+    if (n == 0 || n >= LANG_KEY_MAX) return LANG_NONE;
+    wofl_once_run(&lang_table_once, lang_table_build);
+
+    unsigned slot = lang_hash(s, n) & (LANG_TABLE_SIZE - 1);
+    for (const LangKey *e; (e = lang_table[slot]) != NULL; slot = (slot + 1) & (LANG_TABLE_SIZE - 1)) {
+        size_t i = 0;
+        while (i < n && e->key[i] == lower_ascii(s[i])) i++;
+        if (i == n && e->key[n] == '\0') return e->lang;
+    }
+    return LANG_NONE;
+}
+
+// ===== Detection =====
+
+// "#!/usr/bin/env -S python3.11 -u" -> "#!python"
+static Language lang_from_shebang(const char *line, size_t len) {
+    if (len < 3 || line[0] != '#' || line[1] != '!') return LANG_NONE;
+
+    size_t i = 2;
+    char key[LANG_KEY_MAX] = "#!";
+    for (int word = 0; word < 4; word++) {
+        while (i < len && (line[i] == ' ' || line[i] == '\t')) i++;
+        size_t start = i;
+        while (i < len && line[i] != ' ' && line[i] != '\t' && line[i] != '\r' && line[i] != '\n') i++;
+        if (i == start) return LANG_NONE;
+
+        // Interpreter name: basename, minus options and env
+        size_t base = start;
+        for (size_t k = start; k < i; k++) {
+            if (line[k] == '/') base = k + 1;
+        }
+        if (line[base] == '-') continue;
+        size_t n = i - base;
+        if (n == 3 && memcmp(line + base, "env", 3) == 0) continue;
+
+        while (n > 0 && ((line[base + n - 1] >= '0' && line[base + n - 1] <= '9') ||
+                         line[base + n - 1] == '.')) {
+            n--;
+        }
+        if (n == 0 || n + 2 >= LANG_KEY_MAX) return LANG_NONE;
+        memcpy(key + 2, line + base, n);
+        return lang_lookup(key, n + 2);
+    }
+    return LANG_NONE;
+}
+
+Language lang_detect(const char *path, const char *first_line, size_t first_len) {
+    Language lang = LANG_NONE;
+
+    if (path) {
+        const char *name = path;
+        for (const char *p = path; *p; p++) {
+            if (*p == '/' || *p == '\\') name = p + 1;
+        }
+        size_t n = strlen(name);
+        lang = lang_lookup(name, n);
+
+        const char *dot = strrchr(name, '.');
+        if (lang == LANG_NONE && dot && dot != name) {
+            lang = lang_lookup(dot, n - (size_t)(dot - name));
+        }
+    }
+    if (lang == LANG_NONE && first_line) {
+        lang = lang_from_shebang(first_line, first_len);
+    }
+    return lang;
+}
+
+const LangInfo* lang_info(Language lang) {
+    if ((int)lang < 0 || lang >= LANG_MAX) lang = LANG_NONE;
+    return &lang_infos[lang];
+}
+
+const Syntax* syntax_get(Language lang) {
+    return &lang_info(lang)->syntax;
+}
+
+// ===== Windowed scanning =====
+
+int syntax_scan_window(const Syntax *sx, const wchar_t *line, int len, int state,
+                       int from, int to, FrameArena *fa, TokenSpan **out) {
+    *out = NULL;
+    if (from < 0) from = 0;
+    if (to > len) to = len;
+    if (!sx || from >= to) return 0;
+
+    // Every span but the first starts inside the window, plus a remainder
+    if (sx->lexer) {
+        int cap = to - from + 2;
+        TokenSpan *spans = fa_new(fa, TokenSpan, cap);
+        if (!spans) return 0;
+        int n;
+        lex_scan_range(sx->lexer, line, len, state, from, to, spans, cap, &n);
+        *out = spans;
+        return n;
+    }
+
+    // Hand-written scanners stop at WOFL_MAX_TOKENS; a full batch drops its
+    // last span (possibly a catch-all remainder) and resumes after the rest,
+    // until a batch reaches the window's right edge. They always see the rest
+    // of the line, since a span's class can depend on what follows it.
+    int n = 0, cap = 0, at = 0;
+    TokenSpan *spans = NULL;
+    while (at < to) {
+        if (cap - n < WOFL_MAX_TOKENS) {
+            int grow = cap ? cap * 2 : WOFL_MAX_TOKENS;
+            TokenSpan *bigger = fa_new(fa, TokenSpan, grow);
+            if (!bigger) break;
+            if (n) memcpy(bigger, spans, (size_t)n * sizeof(TokenSpan));
+            spans = bigger;
+            cap = grow;
+        }
+        int k = 0;
+        sx->scan_line(line + at, len - at, spans + n, &k);
+        bool full = k >= WOFL_MAX_TOKENS - 1;
+        if (full && k > 1) k--;
+        for (int t = 0; t < k; t++) spans[n + t].start += (size_t)at;
+        n += k;
+        if (!full || k == 0) break;
+        size_t resume = spans[n - 1].start + spans[n - 1].len;
+        if (resume <= (size_t)at || resume >= (size_t)to) break;
+        at = (int)resume;
+    }
+
+    // Keep the spans that overlap the window
+    int kept = 0;
+    for (int t = 0; t < n; t++) {
+        if (spans[t].start < (size_t)to && spans[t].start + spans[t].len > (size_t)from) {
+            spans[kept++] = spans[t];
+        }
+    }
+    *out = spans;
+    return kept;
+}
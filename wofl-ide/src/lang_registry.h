@@ -0,0 +1,40 @@
+// ==================== lang_registry.h ====================
+// Language registry: file names, extensions and shebangs to scanners
+//
+// Detection is a few hash lookups, done once when a buffer is opened;
+// callers keep the returned Syntax and use it every frame.
+
+#ifndef WOFL_LANG_REGISTRY_H
+#define WOFL_LANG_REGISTRY_H
+
+#include "syntax_defs.h"
+#include "frame_arena.h"
+
+typedef struct {
+    const char *name;       // display name, e.g. "Python"
+    Syntax      syntax;
+} LangInfo;
+
+/**
+ * Detect the language of a file. `path` may be a full path or a bare name
+ * (either separator); `first_line` is the start of the file (may be NULL)
+ * and is only consulted for a shebang. Exact file names win over
+ * extensions, which win over the shebang.
+ */
+Language lang_detect(const char *path, const char *first_line, size_t first_len);
+
+const LangInfo* lang_info(Language lang);
+const Syntax* syntax_get(Language lang);
+
+/**
+ * Spans of line[0, len) that overlap columns [from, to), in an array from
+ * the frame arena; returns how many (0 if the arena cannot grow). `state`
+ * is the lexer state at the start of the line, 0 if unknown. Lines of any
+ * length are covered in full: generated lexers skip the output left of the
+ * window and stop at its right edge, and hand-written scanners are resumed
+ * after their last span whenever they fill WOFL_MAX_TOKENS.
+ */
+int syntax_scan_window(const Syntax *sx, const wchar_t *line, int len, int state,
+                       int from, int to, FrameArena *fa, TokenSpan **out);
+
+#endif // WOFL_LANG_REGISTRY_H
@@ -0,0 +1,162 @@
+// ==================== lexer.c ====================
+// Table-driven line lexer (see lexer.h)
+
+#include "lexer.h"
+
+#define LEX_WINDOW 8            // blocks of 64 characters classified at once
+
+// Class masks for a window of the line, filled on first need
+typedef struct {
+    const wchar_t *line;
+    int len;
+    int base, end;              // blocks cover line[base, end)
+    CcBlock blocks[LEX_WINDOW];
+} LexRuns;
+
+// First position >= i whose character is in none of `classes`
+static inline int run_end(LexRuns *r, int i, unsigned classes) {
+    if (classes & CC_ANY) return r->len;
+    while (i < r->len) {
+        if (i < r->base || i >= r->end) {
+            r->base = i;
+            r->end = r->len - i > LEX_WINDOW * 64 ? i + LEX_WINDOW * 64 : r->len;
+            cc_classify(r->line + i, r->end - i, r->blocks);
+        }
+        int off = i - r->base;
+        uint64_t m = ~cc_mask(&r->blocks[off >> 6], classes) >> (off & 63);
+        if (m) return i + (int)cc_ctz64(m);       // clear bits past the line stop it
+        i = r->base + (off | 63) + 1;
+    }
+    return r->len;
+}
+
+// End of region g's body starting at i; *closed tells whether the closing
+// delimiter was found on this line
+static int region_end(const LexRegion *g, LexRuns *r, int i, bool *closed) {
+    const wchar_t *l = r->line;
+    const int n = r->len;
+    const wchar_t *close = g->close;
+    wchar_t first = close[0];
+    int close_len = (int)wcslen(close);
+
+    // Only the delimiter's and the escape's classes need a closer look
+    unsigned skip = (CC_SPACE | CC_IDENT | CC_QUOTE | CC_OP) & ~cc_class_of((unsigned)first);
+    if (g->escape) skip &= ~cc_class_of((unsigned)g->escape);
+
+    while (i < n) {
+        if (skip && (i = run_end(r, i, skip)) >= n) break;
+        wchar_t c = l[i];
+        if (c == g->escape && g->escape) {
+            i += 2;
+        } else if (c == first && i + close_len <= n &&
+                   wmemcmp(l + i, close, (size_t)close_len) == 0) {
+            *closed = true;
+            return i + close_len;
+        } else {
+            i++;
+        }
+    }
+    *closed = false;
+    return n;
+}
+
+// Class of the keyword s[0..n), or -1
+static int keyword_class(const LexTable *lx, const wchar_t *s, int n) {
+    if (n > 255) return -1;
+    unsigned h = lex_keyword_hash((unsigned)s[0], (unsigned)s[n - 1], (unsigned)n, lx->keyword_fold);
+    for (unsigned slot = h & lx->keyword_mask; lx->keywords[slot].word;
+         slot = (slot + 1) & lx->keyword_mask) {
+        const LexKeyword *kw = &lx->keywords[slot];
+        if (kw->len != n) continue;
+        if (kw->nocase) {
+            if (wofl_wcsnicmp(kw->word, s, (size_t)n) == 0) return kw->cls;
+        } else {
+            int j = 0;
+            while (j < n && kw->word[j] == s[j]) j++;
+            if (j == n) return kw->cls;
+        }
+    }
+    return -1;
+}
+
+int lex_scan(const LexTable *lx, const wchar_t *l, int n, int state,
+             TokenSpan *out, int *out_n) {
+    return lex_scan_range(lx, l, n, state, 0, n, out, WOFL_MAX_TOKENS, out_n);
+}
+
+int lex_scan_range(const LexTable *lx, const wchar_t *l, int n, int state,
+                   int from, int to, TokenSpan *out, int cap, int *out_n) {
+    const unsigned char *classes = lx->classes;
+    const unsigned short *next = lx->next;
+    const unsigned char *accept = lx->accept;
+    const unsigned char *loops = lx->loops;
+    const int k = lx->nclasses;
+    const int stop = to < n ? to : n;
+    LexRuns runs;
+    int i = 0, m = 0;
+
+    runs.line = l;
+    runs.len = n;
+    runs.base = runs.end = 0;
+
+    // Finish a region left open by the previous line
+    if (state > 0 && n > 0) {
+        const LexRule *rule = &lx->rules[state - 1];
+        bool closed;
+        i = region_end(&lx->regions[rule->region], &runs, 0, &closed);
+        if (i > from && cap > 0) out[m++] = (TokenSpan){0, (size_t)i, (TokenClass)rule->cls};
+        if (closed) state = 0;
+    }
+
+    while (i < stop) {
+        if (m >= cap - 1) {
+            if (m < cap) out[m++] = (TokenSpan){(size_t)i, (size_t)(stop - i), TK_TEXT};
+            break;
+        }
+
+        // Longest match from i. A state that loops on whole classes jumps
+        // to the end of the run; when the run is the whole token (blanks,
+        // plain identifiers) the DFA is not stepped at all.
+        unsigned c = (unsigned)l[i];
+        unsigned s = next[(unsigned)k + classes[c < 128 ? c : 128]];
+        int acc = 0, end = i;
+        if (loops[s] & LEX_RUN) {
+            acc = accept[s];
+            end = run_end(&runs, i + 1, loops[s]);
+        } else {
+            for (int j = i; s; ) {
+                if (loops[s]) j = run_end(&runs, j + 1, loops[s]) - 1;
+                if (accept[s]) {
+                    acc = accept[s];
+                    end = j + 1;
+                }
+                if (++j >= n) break;
+                c = (unsigned)l[j];
+                s = next[s * (unsigned)k + classes[c < 128 ? c : 128]];
+            }
+        }
+
+        if (!acc) {
+            if (i >= from) out[m++] = (TokenSpan){(size_t)i, 1, (TokenClass)lx->fallback};
+            i++;
+            continue;
+        }
+
+        const LexRule *rule = &lx->rules[acc - 1];
+        TokenClass cls = (TokenClass)rule->cls;
+        if (acc == lx->ident && lx->keywords) {
+            int kw = keyword_class(lx, l + i, end - i);
+            if (kw >= 0) cls = (TokenClass)kw;
+        } else if (rule->region >= 0) {
+            const LexRegion *r = &lx->regions[rule->region];
+            bool closed;
+            end = region_end(r, &runs, end, &closed);
+            if (!closed && r->multiline) state = acc;
+        }
+        if (end > from) out[m++] = (TokenSpan){(size_t)i, (size_t)(end - i), cls};
+        i = end;
+    }
+
+    *out_n = m;
+    return state;
+}
@@ -0,0 +1,90 @@
+// ==================== lexer.h ====================
+// Table-driven line lexer for scanners generated by tools/lexgen.c
+//
+// Each generated language is a DFA over a handful of character classes.
+// Identifiers are checked against a generated keyword hash table.
+// The lexer takes the longest match at each position (earlier spec lines
+// win ties); regions such as block comments are entered through the DFA
+// and then scanned for their closing delimiter, possibly across lines.
+
+#ifndef WOFL_LEXER_H
+#define WOFL_LEXER_H
+
+#include "syntax_defs.h"
+#include "charclass.h"
+
+#define LEX_ALPHABET 129        // ASCII, then one slot for everything else
+
+// LexTable.loops holds, per state, the CC_* classes that keep it in the
+// same state, plus this flag when the state accepts and every character
+// outside those classes leads to the dead state: the token is the run
+#define LEX_RUN 0x40
+
+typedef struct {
+    unsigned char cls;          // TokenClass
+    signed char   region;       // index into LexTable.regions, or -1
+} LexRule;
+
+typedef struct {
+    const wchar_t *close;       // closing delimiter
+    wchar_t        escape;      // skips the next character, 0 for none
+    bool           multiline;   // an unclosed region continues on the next line
+} LexRegion;
+
+typedef struct {
+    const wchar_t *word;        // NULL for an empty slot
+    unsigned char  len;
+    unsigned char  cls;         // TokenClass
+    bool           nocase;
+} LexKeyword;
+
+typedef struct LexTable {
+    const char           *name;
+    const unsigned char  *classes;     // LEX_ALPHABET entries
+    const unsigned short *next;        // [state * nclasses + class]; 0 = dead, 1 = start
+    const unsigned char  *accept;      // per state: 0, or 1 + index into rules
+    const unsigned char  *loops;       // per state: CC_* classes, LEX_RUN
+    const LexRule        *rules;
+    const LexRegion      *regions;
+    const LexKeyword     *keywords;    // open-addressing table, NULL if none
+    unsigned              keyword_mask;
+    bool                  keyword_fold; // hash with A-Z folded to a-z
+    unsigned char         ident;       // accept value whose matches may be keywords
+    int                   nclasses;
+    int                   nstates;
+    unsigned char         fallback;    // TokenClass for characters no rule matches
+} LexTable;
+
+/**
+ * Keyword table hash: first and last character (A-Z folded to a-z when
+ * `fold`) and the length. Shared with tools/lexgen.c.
+ */
+static inline unsigned lex_keyword_hash(unsigned first, unsigned last, unsigned len, bool fold) {
+    if (fold) {
+        if (first - 'A' < 26u) first += 'a' - 'A';
+        if (last - 'A' < 26u) last += 'a' - 'A';
+    }
+    unsigned h = first * 0x9E3779B1u ^ last * 0x85EBCA77u ^ len * 0xC2B2AE3Du;
+    return h ^ (h >> 15);
+}
+
+/**
+ * Scan one line. `state` is 0 at the top of a file, else what the previous
+ * line returned; the return value is the state to carry into the next line
+ * (non-zero while inside a multi-line region). Writes at most
+ * WOFL_MAX_TOKENS spans.
+ */
+int lex_scan(const LexTable *lx, const wchar_t *line, int len, int state,
+             TokenSpan *out, int *out_n);
+
+/**
+ * Horizontal window of a line: only spans overlapping columns [from, to)
+ * are written, at most `cap` (the last one a TK_TEXT remainder if they run
+ * out), and scanning stops at `to`. Text left of the window is still lexed,
+ * as token boundaries depend on it, but costs no output. The return value
+ * is the carry state only when `to` reaches the end of the line.
+ */
+int lex_scan_range(const LexTable *lx, const wchar_t *line, int len, int state,
+                   int from, int to, TokenSpan *out, int cap, int *out_n);
+
+#endif // WOFL_LEXER_H
@@ -0,0 +1,760 @@
+// ==================== line_index.c ====================
+// Blocked line-length index and its background builder
+
+#include "line_index.h"
+#include "newline_scan.h"
+#include <stdlib.h>
+#include <string.h>
+
+// ===== Newline Scanning =====
+
+/**
+ * Index of the first '\n' in text[from, n), or n if there is none
+ */
+static size_t li_next_nl(const void *text, size_t from, size_t n, int unit) {
+    size_t k = 1;
+    return from + nl_find_nth((const char *)text + from * (size_t)unit, n - from, unit, &k);
+}
+
+// ===== Fenwick Trees Over Blocks =====
+
+static inline size_t fw_low(size_t i) { return i & (~i + 1); }
+
+static void fw_add(uint64_t *fw, size_t nb, size_t block, int64_t delta) {
+    for (size_t i = block + 1; i <= nb; i += fw_low(i)) fw[i] += (uint64_t)delta;
+}
+
+// Sum over the first `count` blocks
+static uint64_t fw_prefix(const uint64_t *fw, size_t count) {
+    uint64_t s = 0;
+    for (size_t i = count; i > 0; i -= fw_low(i)) s += fw[i];
+    return s;
+}
+
+// Largest k with prefix(k) <= target; the prefix itself goes to *below
+static size_t fw_search(const uint64_t *fw, size_t nb, uint64_t target, uint64_t *below) {
+    size_t step = 1;
+    while (step * 2 <= nb) step *= 2;
+
+    size_t pos = 0;
+    uint64_t acc = 0;
+    for (; step; step >>= 1) {
+        if (pos + step <= nb && acc + fw[pos + step] <= target) {
+            pos += step;
+            acc += fw[pos];
+        }
+    }
+    *below = acc;
+    return pos;
+}
+
+static void li_rebuild_fw(LineIndex *li) {
+    const size_t nb = li->nblocks;
+    for (size_t i = 1; i <= nb; i++) {
+        li->fw_units[i] = li->blocks[i - 1]->units;
+        li->fw_lines[i] = li->blocks[i - 1]->n;
+        li->fw_rows[i] = li->blocks[i - 1]->rows;
+    }
+    for (size_t i = 1; i <= nb; i++) {
+        size_t j = i + fw_low(i);
+        if (j <= nb) {
+            li->fw_units[j] += li->fw_units[i];
+            li->fw_lines[j] += li->fw_lines[i];
+            li->fw_rows[j] += li->fw_rows[i];
+        }
+    }
+    li->rows = fw_prefix(li->fw_rows, nb);
+}
+
+// ===== Wrapped Rows =====
+
+/**
+ * Rows of a line `len` units long, its '\n' included unless it is the last
+ * line. The caret may sit just past the text, at the end of the last row.
+ */
+static uint32_t li_rows(uint32_t wrap, uint32_t len, bool last) {
+    if (!wrap) return 1;
+    if (!last && len > 0) len--;
+    return len ? (len - 1) / wrap + 1 : 1;
+}
+
+static uint64_t li_block_rows(const LineIndex *li, size_t b, uint32_t wrap) {
+    const LineBlock *bk = li->blocks[b];
+    const bool ends = b + 1 == li->nblocks;
+    uint64_t rows = 0;
+    for (uint32_t k = 0; k < bk->n; k++) rows += li_rows(wrap, bk->len[k], ends && k + 1 == bk->n);
+    return rows;
+}
+
+static void li_add_rows(LineIndex *li, size_t b, int64_t delta) {
+    if (!delta) return;
+    li->blocks[b]->rows += (uint64_t)delta;
+    fw_add(li->fw_rows, li->nblocks, b, delta);
+    li->rows += (uint64_t)delta;
+}
+
+// Switch to `wrap`, with the rows of every block given or counted here
+static void li_wrap_blocks(LineIndex *li, uint32_t wrap, const uint64_t *rows) {
+    for (size_t b = 0; b < li->nblocks; b++) {
+        li->blocks[b]->rows = rows ? rows[b] : li_block_rows(li, b, wrap);
+    }
+    li->wrap = wrap;
+    li_rebuild_fw(li);
+}
+
+// ===== Block Storage =====
+
+static bool li_reserve(LineIndex *li, size_t need) {
+    if (need <= li->cap) return true;
+    size_t cap = li->cap ? li->cap : 16;
+    while (cap < need) cap *= 2;
+
+    LineBlock **nb = (LineBlock **)realloc(li->blocks, cap * sizeof(LineBlock *));
+    if (!nb) return false;
+    li->blocks = nb;
+    uint64_t *fu = (uint64_t *)realloc(li->fw_units, (cap + 1) * sizeof(uint64_t));
+    if (!fu) return false;
+    li->fw_units = fu;
+    uint64_t *fl = (uint64_t *)realloc(li->fw_lines, (cap + 1) * sizeof(uint64_t));
+    if (!fl) return false;
+    li->fw_lines = fl;
+    uint64_t *fr = (uint64_t *)realloc(li->fw_rows, (cap + 1) * sizeof(uint64_t));
+    if (!fr) return false;
+    li->fw_rows = fr;
+    li->cap = cap;
+    return true;
+}
+
+static LineBlock *li_new_block(void) {
+    LineBlock *b = (LineBlock *)malloc(sizeof(LineBlock));
+    if (b) {
+        b->n = 0;
+        b->units = 0;
+        b->rows = 0;
+    }
+    return b;
+}
+
+/**
+ * Append an empty block at the end, extending the Fenwick trees in O(log n)
+ */
+static LineBlock *li_push_block(LineIndex *li) {
+    if (!li_reserve(li, li->nblocks + 1)) return NULL;
+    LineBlock *b = li_new_block();
+    if (!b) return NULL;
+
+    const size_t i = ++li->nblocks;
+    li->blocks[i - 1] = b;
+    const size_t lo = i - fw_low(i);
+    li->fw_units[i] = fw_prefix(li->fw_units, i - 1) - fw_prefix(li->fw_units, lo);
+    li->fw_lines[i] = fw_prefix(li->fw_lines, i - 1) - fw_prefix(li->fw_lines, lo);
+    li->fw_rows[i] = fw_prefix(li->fw_rows, i - 1) - fw_prefix(li->fw_rows, lo);
+    return b;
+}
+
+void li_init(LineIndex *li) {
+    memset(li, 0, sizeof(*li));
+    LineBlock *b = li_push_block(li);
+    if (b) {
+        b->len[b->n++] = 0;
+        fw_add(li->fw_lines, li->nblocks, 0, 1);
+        li_add_rows(li, 0, 1);
+    }
+    li->lines = 1;
+}
+
+void li_free(LineIndex *li) {
+    for (size_t i = 0; i < li->nblocks; i++) free(li->blocks[i]);
+    free(li->blocks);
+    free(li->fw_units);
+    free(li->fw_lines);
+    free(li->fw_rows);
+    memset(li, 0, sizeof(*li));
+}
+
+// Empty again, still wrapping at the same width
+void li_reset(LineIndex *li) {
+    const uint32_t wrap = li->wrap;
+    const uint64_t edits = li->edits;
+    li_free(li);
+    li_init(li);
+    li->wrap = wrap;
+    li->edits = edits + 1;
+}
+
+size_t li_line_count(const LineIndex *li) { return li->lines; }
+size_t li_total_units(const LineIndex *li) { return (size_t)li->units; }
+
+// ===== Lookups =====
+
+/**
+ * Find the block holding `line`; *first gets the block's first line number
+ */
+static size_t li_block_of_line(const LineIndex *li, size_t line, size_t *first) {
+    uint64_t below = 0;
+    size_t b = fw_search(li->fw_lines, li->nblocks, line, &below);
+    if (b >= li->nblocks) {
+        b = li->nblocks - 1;
+        below = fw_prefix(li->fw_lines, b);
+    }
+    *first = (size_t)below;
+    return b;
+}
+
+size_t li_line_start(const LineIndex *li, size_t line) {
+    if (line >= li->lines) line = li->lines - 1;
+    size_t first;
+    const size_t b = li_block_of_line(li, line, &first);
+    uint64_t pos = fw_prefix(li->fw_units, b);
+    const LineBlock *bk = li->blocks[b];
+    for (size_t k = 0; k < line - first; k++) pos += bk->len[k];
+    return (size_t)pos;
+}
+
+size_t li_line_length(const LineIndex *li, size_t line) {
+    if (line >= li->lines) return 0;
+    size_t first;
+    const size_t b = li_block_of_line(li, line, &first);
+    const uint32_t len = li->blocks[b]->len[line - first];
+    return (line + 1 < li->lines && len > 0) ? len - 1 : len;
+}
+
+/**
+ * Locate the line containing pos and that line's start offset
+ */
+static size_t li_locate(const LineIndex *li, size_t pos, size_t *line_start) {
+    if (pos > li->units) pos = (size_t)li->units;
+
+    uint64_t below = 0;
+    size_t b = fw_search(li->fw_units, li->nblocks, pos, &below);
+    if (b >= li->nblocks) {
+        b = li->nblocks - 1;
+        below = fw_prefix(li->fw_units, b);
+    }
+
+    const LineBlock *bk = li->blocks[b];
+    const size_t first = (size_t)fw_prefix(li->fw_lines, b);
+    uint64_t acc = below;
+    for (uint32_t k = 0; k < bk->n; k++) {
+        if (acc + bk->len[k] > pos) {
+            *line_start = (size_t)acc;
+            return first + k;
+        }
+        acc += bk->len[k];
+    }
+    *line_start = (size_t)(acc - bk->len[bk->n - 1]);
+    return first + bk->n - 1;
+}
+
+size_t li_line_of(const LineIndex *li, size_t pos) {
+    size_t start;
+    return li_locate(li, pos, &start);
+}
+
+void li_set_wrap(LineIndex *li, uint32_t wrap) {
+    if (wrap != li->wrap) li_wrap_blocks(li, wrap, NULL);
+}
+
+size_t li_row_count(const LineIndex *li) { return (size_t)li->rows; }
+
+size_t li_line_rows(const LineIndex *li, size_t line) {
+    if (line >= li->lines) return 1;
+    size_t first;
+    const size_t b = li_block_of_line(li, line, &first);
+    return li_rows(li->wrap, li->blocks[b]->len[line - first], line + 1 == li->lines);
+}
+
+size_t li_row_of_line(const LineIndex *li, size_t line) {
+    if (line >= li->lines) return (size_t)li->rows;
+    if (!li->wrap) return line;
+    size_t first;
+    const size_t b = li_block_of_line(li, line, &first);
+    uint64_t row = fw_prefix(li->fw_rows, b);
+    const LineBlock *bk = li->blocks[b];
+    for (size_t k = 0; k < line - first; k++) row += li_rows(li->wrap, bk->len[k], false);
+    return (size_t)row;
+}
+
+/**
+ * The line holding a wrapped row, and which of its rows it is. Rows past
+ * the end land on the last row.
+ */
+size_t li_line_of_row(const LineIndex *li, size_t row, size_t *sub) {
+    if (row >= li->rows) {
+        const size_t last = li->lines - 1;
+        if (sub) *sub = li_line_rows(li, last) - 1;
+        return last;
+    }
+    if (!li->wrap) {
+        if (sub) *sub = 0;
+        return row;
+    }
+
+    uint64_t acc = 0;
+    size_t b = fw_search(li->fw_rows, li->nblocks, row, &acc);
+    if (b >= li->nblocks) b = li->nblocks - 1;
+    const LineBlock *bk = li->blocks[b];
+    const bool ends = b + 1 == li->nblocks;
+    const size_t first = (size_t)fw_prefix(li->fw_lines, b);
+    for (uint32_t k = 0; k < bk->n; k++) {
+        const uint32_t rows = li_rows(li->wrap, bk->len[k], ends && k + 1 == bk->n);
+        if (acc + rows > row) {
+            if (sub) *sub = (size_t)(row - acc);
+            return first + k;
+        }
+        acc += rows;
+    }
+    if (sub) *sub = 0;
+    return first + bk->n - 1;
+}
+
+// ===== Mutation =====
+
+/**
+ * Replace lines [line, line + remove) with `count` (>= 1) new lengths.
+ * Edits that fit their block are patched in place; anything larger is
+ * re-chunked and the Fenwick trees rebuilt.
+ */
+static void li_splice(LineIndex *li, size_t line, size_t remove,
+                      const uint32_t *lens, size_t count) {
+    const size_t end = (line + remove >= li->lines) ? (size_t)li->units
+                                                    : li_line_start(li, line + remove);
+    const size_t old_units = end - li_line_start(li, line);
+    uint64_t new_units = 0;
+    for (size_t i = 0; i < count; i++) new_units += lens[i];
+
+    size_t fb_first, lb_first;
+    const size_t fb = li_block_of_line(li, line, &fb_first);
+    const size_t last = remove ? line + remove - 1 : line;
+    const size_t lb = li_block_of_line(li, last, &lb_first);
+    const size_t pre = line - fb_first;
+    const size_t post_from = remove ? last - lb_first + 1 : pre;
+    const size_t post = li->blocks[lb]->n - post_from;
+    const size_t total = pre + count + post;
+
+    // Only the last line of the index has no '\n' to leave out of its rows
+    const bool ends = line + remove >= li->lines;
+    int64_t old_rows = 0, new_rows = 0;
+    if (li->wrap) {
+        for (size_t i = 0; i < count; i++) new_rows += li_rows(li->wrap, lens[i], ends && i + 1 == count);
+    } else {
+        new_rows = (int64_t)count;
+    }
+
+    if (fb == lb && total <= LI_BLOCK_LINES) {
+        LineBlock *bk = li->blocks[fb];
+        for (size_t k = pre; k < post_from; k++) {
+            old_rows += li_rows(li->wrap, bk->len[k], fb_first + k + 1 == li->lines);
+        }
+        memmove(&bk->len[pre + count], &bk->len[post_from], post * sizeof(uint32_t));
+        memcpy(&bk->len[pre], lens, count * sizeof(uint32_t));
+        bk->n = (uint32_t)total;
+        bk->units += new_units - old_units;
+        fw_add(li->fw_units, li->nblocks, fb, (int64_t)new_units - (int64_t)old_units);
+        fw_add(li->fw_lines, li->nblocks, fb, (int64_t)count - (int64_t)remove);
+        li_add_rows(li, fb, new_rows - old_rows);
+    } else {
+        uint32_t *tmp = (uint32_t *)malloc(total * sizeof(uint32_t));
+        if (!tmp) return;
+        memcpy(tmp, li->blocks[fb]->len, pre * sizeof(uint32_t));
+        memcpy(tmp + pre, lens, count * sizeof(uint32_t));
+        memcpy(tmp + pre + count, &li->blocks[lb]->len[post_from], post * sizeof(uint32_t));
+
+        const size_t nnew = (total + LI_BLOCK_FILL - 1) / LI_BLOCK_FILL;
+        const size_t nold = lb - fb + 1;
+        const bool last_block = lb + 1 == li->nblocks;
+        if (!li_reserve(li, li->nblocks - nold + nnew)) { free(tmp); return; }
+
+        for (size_t i = fb; i <= lb; i++) free(li->blocks[i]);
+        memmove(&li->blocks[fb + nnew], &li->blocks[lb + 1],
+                (li->nblocks - lb - 1) * sizeof(LineBlock *));
+        li->nblocks = li->nblocks - nold + nnew;
+
+        size_t src = 0;
+        for (size_t i = 0; i < nnew; i++) {
+            LineBlock *bk = li_new_block();
+            const size_t take = total / nnew + (i < total % nnew ? 1 : 0);
+            if (bk) {
+                memcpy(bk->len, tmp + src, take * sizeof(uint32_t));
+                bk->n = (uint32_t)take;
+                for (size_t k = 0; k < take; k++) {
+                    bk->units += bk->len[k];
+                    bk->rows += li_rows(li->wrap, bk->len[k],
+                                        last_block && i + 1 == nnew && k + 1 == take);
+                }
+            }
+            li->blocks[fb + i] = bk;
+            src += take;
+        }
+        free(tmp);
+        li_rebuild_fw(li);
+    }
+
+    li->lines = li->lines - remove + count;
+    li->units = li->units - old_units + new_units;
+}
+
+/**
+ * Grow the last (open) line by `delta` units
+ */
+static void li_grow_last(LineIndex *li, size_t delta) {
+    LineBlock *bk = li->blocks[li->nblocks - 1];
+    const uint32_t old = bk->len[bk->n - 1];
+    bk->len[bk->n - 1] += (uint32_t)delta;
+    bk->units += delta;
+    fw_add(li->fw_units, li->nblocks, li->nblocks - 1, (int64_t)delta);
+    li_add_rows(li, li->nblocks - 1, (int64_t)li_rows(li->wrap, bk->len[bk->n - 1], true) -
+                                     (int64_t)li_rows(li->wrap, old, true));
+    li->units += delta;
+}
+
+/**
+ * Start a new empty line at the end of the index
+ */
+static void li_push_line(LineIndex *li) {
+    LineBlock *bk = li->blocks[li->nblocks - 1];
+    const uint32_t len = bk->len[bk->n - 1];   // no longer the last line: its '\n' drops out
+    li_add_rows(li, li->nblocks - 1, (int64_t)li_rows(li->wrap, len, false) -
+                                     (int64_t)li_rows(li->wrap, len, true));
+    if (bk->n == LI_BLOCK_LINES) {
+        bk = li_push_block(li);
+        if (!bk) return;
+    }
+    bk->len[bk->n++] = 0;
+    fw_add(li->fw_lines, li->nblocks, li->nblocks - 1, 1);
+    li_add_rows(li, li->nblocks - 1, 1);
+    li->lines++;
+}
+
+void li_append_text(LineIndex *li, const void *text, size_t n, int unit) {
+    li->edits++;
+    size_t i = 0;
+    while (i < n) {
+        const size_t nl = li_next_nl(text, i, n, unit);
+        if (nl == n) {
+            li_grow_last(li, n - i);
+            break;
+        }
+        li_grow_last(li, nl - i + 1);
+        li_push_line(li);
+        i = nl + 1;
+    }
+}
+
+void li_insert_text(LineIndex *li, size_t pos, const void *text, size_t n, int unit) {
+    if (n == 0) return;
+    li->edits++;
+    if (pos >= li->units) {
+        // Appends (log tails, the indexer itself) never touch existing lines
+        li_append_text(li, text, n, unit);
+        return;
+    }
+
+    size_t start;
+    const size_t line = li_locate(li, pos, &start);
+    size_t nl = li_next_nl(text, 0, n, unit);
+
+    if (nl == n) {
+        // No newline: the line just gets longer
+        size_t first;
+        const size_t b = li_block_of_line(li, line, &first);
+        LineBlock *bk = li->blocks[b];
+        const bool last = line + 1 == li->lines;
+        const uint32_t old = bk->len[line - first];
+        bk->len[line - first] += (uint32_t)n;
+        bk->units += n;
+        fw_add(li->fw_units, li->nblocks, b, (int64_t)n);
+        li_add_rows(li, b, (int64_t)li_rows(li->wrap, bk->len[line - first], last) -
+                           (int64_t)li_rows(li->wrap, old, last));
+        li->units += n;
+        return;
+    }
+
+    const size_t offset = pos - start;
+    size_t old_len;
+    {
+        size_t first;
+        const size_t b = li_block_of_line(li, line, &first);
+        old_len = li->blocks[b]->len[line - first];
+    }
+
+    size_t cap = 64, count = 0;
+    uint32_t *lens = (uint32_t *)malloc(cap * sizeof(uint32_t));
+    if (!lens) return;
+    lens[count++] = (uint32_t)(offset + nl + 1);
+
+    for (;;) {
+        const size_t from = nl + 1;
+        nl = li_next_nl(text, from, n, unit);
+        if (count == cap) {
+            uint32_t *grown = (uint32_t *)realloc(lens, cap * 2 * sizeof(uint32_t));
+            if (!grown) { free(lens); return; }
+            lens = grown;
+            cap *= 2;
+        }
+        if (nl == n) {
+            lens[count++] = (uint32_t)(n - from + old_len - offset);
+            break;
+        }
+        lens[count++] = (uint32_t)(nl - from + 1);
+    }
+
+    li_splice(li, line, 1, lens, count);
+    free(lens);
+}
+
+void li_delete(LineIndex *li, size_t pos, size_t n) {
+    if (pos >= li->units || n == 0) return;
+    if (pos + n > li->units) n = (size_t)li->units - pos;
+    li->edits++;
+
+    size_t sa, sb;
+    const size_t a = li_locate(li, pos, &sa);
+    const size_t b = li_locate(li, pos + n, &sb);
+
+    if (a == b) {
+        size_t first;
+        const size_t blk = li_block_of_line(li, a, &first);
+        LineBlock *bk = li->blocks[blk];
+        const bool last = a + 1 == li->lines;
+        const uint32_t old = bk->len[a - first];
+        bk->len[a - first] -= (uint32_t)n;
+        bk->units -= n;
+        fw_add(li->fw_units, li->nblocks, blk, -(int64_t)n);
+        li_add_rows(li, blk, (int64_t)li_rows(li->wrap, bk->len[a - first], last) -
+                             (int64_t)li_rows(li->wrap, old, last));
+        li->units -= n;
+        return;
+    }
+
+    size_t first;
+    const size_t blk = li_block_of_line(li, b, &first);
+    const size_t len_b = li->blocks[blk]->len[b - first];
+    const uint32_t merged = (uint32_t)((pos - sa) + (sb + len_b - (pos + n)));
+    li_splice(li, a, b - a + 1, &merged, 1);
+}
+
+// ===== Background Builder =====
+
+static bool lix_wrap_pending(const LineIndexer *lx) {
+    return lx->wrap_want != lx->index.wrap && !lx->wrap_ready;
+}
+
+/**
+ * Count the rows of the next few blocks at the wanted width. Any edit in
+ * between starts the count over; a finished count waits for the UI thread
+ * to switch to it.
+ */
+static void lix_wrap_step(LineIndexer *lx) {
+    const LineIndex *li = &lx->index;
+    if (lx->wrap_done && lx->wrap_edits != li->edits) lx->wrap_done = 0;
+    if (lx->wrap_done == 0) {
+        if (lx->wrap_cap < li->nblocks) {
+            uint64_t *rows = (uint64_t *)realloc(lx->wrap_rows, li->nblocks * sizeof(uint64_t));
+            if (!rows) {
+                lx->wrap_want = li->wrap;   // keep the old width; asked again next time
+                return;
+            }
+            lx->wrap_rows = rows;
+            lx->wrap_cap = li->nblocks;
+        }
+        lx->wrap_edits = li->edits;
+    }
+
+    size_t end = lx->wrap_done + LI_WRAP_BLOCKS;
+    if (end > li->nblocks) end = li->nblocks;
+    for (size_t b = lx->wrap_done; b < end; b++) lx->wrap_rows[b] = li_block_rows(li, b, lx->wrap_want);
+    lx->wrap_done = end;
+    lx->wrap_ready = end == li->nblocks;
+}
+
+static WOFL_THREAD_FN(lix_worker) {
+    LineIndexer *lx = (LineIndexer *)arg;
+
+    for (;;) {
+        wofl_mutex_lock(&lx->lock);
+        if (lx->cancel) {
+            lx->running = false;
+            lx->busy = false;
+            wofl_mutex_unlock(&lx->lock);
+            break;
+        }
+
+        // A new width goes first: text folded in meanwhile would restart it
+        if (lix_wrap_pending(lx)) {
+            lix_wrap_step(lx);
+            const bool ready = lx->wrap_ready;
+            wofl_mutex_unlock(&lx->lock);
+            if (ready && lx->notify) lx->notify(lx->notify_user);
+            continue;
+        }
+        if (!lx->running || lx->wrap_ready) {
+            lx->busy = false;
+            wofl_mutex_unlock(&lx->lock);
+            break;
+        }
+
+        const size_t len = lx->src.length(lx->src.ctx);
+        size_t avail = 0;
+        const void *seg = (lx->frontier < len)
+                        ? lx->src.segment(lx->src.ctx, lx->frontier, &avail) : NULL;
+        lx->total = len;
+
+        if (!seg || avail == 0) {
+            lx->running = false;
+            wofl_mutex_unlock(&lx->lock);
+            if (lx->notify) lx->notify(lx->notify_user);
+            continue;
+        }
+
+        size_t n = avail;
+        if (n > LI_CHUNK_UNITS) n = LI_CHUNK_UNITS;
+        if (n > len - lx->frontier) n = len - lx->frontier;
+        li_append_text(&lx->index, seg, n, lx->src.unit);
+        lx->frontier += n;
+        wofl_mutex_unlock(&lx->lock);
+
+        if (lx->notify) lx->notify(lx->notify_user);
+    }
+    WOFL_THREAD_RETURN;
+}
+
+void lix_init(LineIndexer *lx) {
+    memset(lx, 0, sizeof(*lx));
+    li_init(&lx->index);
+    wofl_mutex_init(&lx->lock);
+}
+
+void lix_free(LineIndexer *lx) {
+    lix_stop(lx);
+    li_free(&lx->index);
+    free(lx->wrap_rows);
+    wofl_mutex_destroy(&lx->lock);
+}
+
+/**
+ * Throw away the current index and rebuild it from src on a worker thread.
+ * Lines near the top become available after the first step, so callers can
+ * paint right away and pick up the rest as notify() fires.
+ */
+void lix_start(LineIndexer *lx, LineSource src) {
+    lix_stop(lx);
+
+    wofl_mutex_lock(&lx->lock);
+    li_reset(&lx->index);
+    lx->src = src;
+    lx->frontier = 0;
+    lx->total = src.length(src.ctx);
+    lx->cancel = false;
+    lx->running = true;
+    lx->busy = true;
+    lx->wrap_done = 0;
+    lx->wrap_ready = false;
+    wofl_mutex_unlock(&lx->lock);
+
+    if (wofl_thread_start(&lx->thread, lix_worker, lx)) {
+        lx->started = true;
+    } else {
+        lix_worker(lx);  // no thread available: index inline
+    }
+}
+
+// Start the worker again if it stopped with work left: text to index or a
+// wrap width to count
+static void lix_resume(LineIndexer *lx) {
+    wofl_mutex_lock(&lx->lock);
+    const bool resume = !lx->busy && !lx->cancel && (lx->running || lix_wrap_pending(lx));
+    if (resume) lx->busy = true;
+    wofl_mutex_unlock(&lx->lock);
+    if (!resume) return;
+
+    if (lx->started) {
+        wofl_thread_join(lx->thread);   // already past its loop
+        lx->started = false;
+    }
+    if (wofl_thread_start(&lx->thread, lix_worker, lx)) {
+        lx->started = true;
+    } else {
+        lix_worker(lx);
+    }
+}
+
+/**
+ * Cancel and join the worker. A cancelled index is partial; only call this
+ * before replacing the buffer and restarting with lix_start().
+ */
+void lix_stop(LineIndexer *lx) {
+    wofl_mutex_lock(&lx->lock);
+    lx->cancel = true;
+    wofl_mutex_unlock(&lx->lock);
+
+    if (lx->started) {
+        wofl_thread_join(lx->thread);
+        lx->started = false;
+    }
+
+    wofl_mutex_lock(&lx->lock);
+    lx->running = false;
+    lx->busy = false;
+    wofl_mutex_unlock(&lx->lock);
+}
+
+void lix_lock(LineIndexer *lx)   { wofl_mutex_lock(&lx->lock); }
+void lix_unlock(LineIndexer *lx) { wofl_mutex_unlock(&lx->lock); }
+
+void lix_set_wrap(LineIndexer *lx, uint32_t wrap) {
+    wofl_mutex_lock(&lx->lock);
+    const bool changed = wrap != lx->wrap_want;
+    if (changed) {
+        lx->wrap_want = wrap;
+        lx->wrap_done = 0;
+        lx->wrap_ready = false;
+    }
+    wofl_mutex_unlock(&lx->lock);
+    if (changed) lix_resume(lx);
+}
+
+/**
+ * Switch the index to the rows the worker counted. A count overtaken by
+ * edits is started again instead; indexing, paused while the count waited,
+ * carries on either way.
+ */
+bool lix_apply_wrap(LineIndexer *lx) {
+    wofl_mutex_lock(&lx->lock);
+    bool applied = false;
+    if (lx->wrap_ready) {
+        lx->wrap_ready = false;
+        lx->wrap_done = 0;
+        if (lx->wrap_edits == lx->index.edits && lx->wrap_cap >= lx->index.nblocks) {
+            li_wrap_blocks(&lx->index, lx->wrap_want, lx->wrap_rows);
+            applied = true;
+        }
+    }
+    wofl_mutex_unlock(&lx->lock);
+    lix_resume(lx);
+    return applied;
+}
+
+bool lix_done(const LineIndexer *lx) { return !lx->running; }
+
+int lix_progress_permille(const LineIndexer *lx) {
+    if (!lx->running || lx->total == 0) return 1000;
+    return (int)((double)lx->frontier * 1000.0 / (double)lx->total);
+}
+
+/**
+ * Text inserted below the frontier is folded in now; anything at or past
+ * it will be picked up by the worker when it gets there.
+ */
+void lix_note_insert(LineIndexer *lx, size_t pos, const void *text, size_t n) {
+    if (lx->running && pos >= lx->frontier) return;
+    li_insert_text(&lx->index, pos, text, n, lx->src.unit ? lx->src.unit : 1);
+    lx->frontier += n;
+}
+
+void lix_note_delete(LineIndexer *lx, size_t pos, size_t n) {
+    if (lx->running && pos >= lx->frontier) return;
+    if (lx->running && n > lx->frontier - pos) n = lx->frontier - pos;
+    li_delete(&lx->index, pos, n);
+    lx->frontier -= n;
+}
@@ -0,0 +1,125 @@
+// ==================== line_index.h ====================
+// Line-start index shared by all ports, with a background builder
+//
+// Positions are counted in buffer units: bytes for the Linux ports,
+// wchar_t for the Win32 port. The index never looks at text itself
+// except when it is handed new text to fold in.
+
+#ifndef WOFL_LINE_INDEX_H
+#define WOFL_LINE_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "wofl_thread.h"
+
+#define LI_BLOCK_LINES  512            // max lines per block
+#define LI_BLOCK_FILL   384            // fill level used when re-chunking
+#define LI_CHUNK_UNITS  (1u << 20)     // units folded in per worker step
+#define LI_WRAP_BLOCKS  256            // blocks recounted per worker step on a wrap change
+
+// ===== Line Index =====
+
+// Lines are stored as lengths (the '\n' included) in fixed-size blocks.
+// Fenwick trees over the blocks give O(log n) line <-> offset lookups and
+// O(log n) updates for edits that stay inside one block. With soft wrap,
+// a third one counts the rows lines take at `wrap` units per row.
+typedef struct {
+    uint32_t n;                        // lines held in this block
+    uint64_t units;                    // sum of len[]
+    uint64_t rows;                     // wrapped rows of its lines
+    uint32_t len[LI_BLOCK_LINES];
+} LineBlock;
+
+typedef struct {
+    LineBlock **blocks;
+    size_t      nblocks;
+    size_t      cap;
+    uint64_t   *fw_units;              // 1-based Fenwick tree of block units
+    uint64_t   *fw_lines;              // 1-based Fenwick tree of block lines
+    uint64_t   *fw_rows;               // 1-based Fenwick tree of block rows
+    size_t      lines;                 // always >= 1
+    uint64_t    units;
+    uint64_t    rows;
+    uint32_t    wrap;                  // units per row, 0 for one row per line
+    uint64_t    edits;                 // bumped by every change
+} LineIndex;
+
+void   li_init(LineIndex *li);
+void   li_free(LineIndex *li);
+void   li_reset(LineIndex *li);
+size_t li_line_count(const LineIndex *li);
+size_t li_total_units(const LineIndex *li);
+size_t li_line_start(const LineIndex *li, size_t line);
+size_t li_line_length(const LineIndex *li, size_t line);   // without '\n'
+size_t li_line_of(const LineIndex *li, size_t pos);
+
+// Wrapped rows. A line takes one row per `wrap` units of its text, at
+// least one; rows of lines past the end count as the total.
+void   li_set_wrap(LineIndex *li, uint32_t wrap);
+size_t li_row_count(const LineIndex *li);
+size_t li_line_rows(const LineIndex *li, size_t line);
+size_t li_row_of_line(const LineIndex *li, size_t line);
+size_t li_line_of_row(const LineIndex *li, size_t row, size_t *sub);
+
+// Text is unit-sized: 1 for char buffers, sizeof(wchar_t) for wide ones
+void   li_append_text(LineIndex *li, const void *text, size_t n, int unit);
+void   li_insert_text(LineIndex *li, size_t pos, const void *text, size_t n, int unit);
+void   li_delete(LineIndex *li, size_t pos, size_t n);
+
+// ===== Background Builder =====
+
+// A port describes its buffer through two callbacks. segment() returns a
+// pointer to the contiguous run of units starting at pos (one side of the
+// gap) and stores its length in *avail.
+typedef struct {
+    const void *(*segment)(void *ctx, size_t pos, size_t *avail);
+    size_t      (*length)(void *ctx);
+    void        *ctx;
+    int          unit;
+} LineSource;
+
+typedef struct {
+    LineIndex   index;
+    LineSource  src;
+    wofl_mutex  lock;
+    wofl_thread thread;
+    bool        started;               // thread handle needs joining
+    bool        running;               // worker still folding text in
+    bool        cancel;
+    size_t      frontier;              // source units covered by index
+    size_t      total;                 // source length seen by the worker
+    void      (*notify)(void *user);   // called from the worker per step
+    void       *notify_user;
+    bool        busy;                  // worker thread still looping
+
+    // Rows at a new wrap width are counted by the worker, then switched to
+    // by lix_apply_wrap(), so the index never mixes widths
+    uint32_t    wrap_want;
+    uint64_t   *wrap_rows;             // per block, counted so far
+    size_t      wrap_done;             // blocks counted
+    size_t      wrap_cap;
+    uint64_t    wrap_edits;            // index edits when counting started
+    bool        wrap_ready;
+} LineIndexer;
+
+void   lix_init(LineIndexer *lx);
+void   lix_free(LineIndexer *lx);
+void   lix_start(LineIndexer *lx, LineSource src);
+void   lix_stop(LineIndexer *lx);
+void   lix_lock(LineIndexer *lx);
+void   lix_unlock(LineIndexer *lx);
+
+// Without the lock: ask for rows `wrap` units wide (0: no wrapping), and
+// from the UI thread, switch to them once counted. lix_apply_wrap() returns
+// true if the index changed width.
+void   lix_set_wrap(LineIndexer *lx, uint32_t wrap);
+bool   lix_apply_wrap(LineIndexer *lx);
+
+// Everything below expects the lock to be held, as do reads of lx->index
+bool   lix_done(const LineIndexer *lx);
+int    lix_progress_permille(const LineIndexer *lx);
+void   lix_note_insert(LineIndexer *lx, size_t pos, const void *text, size_t n);
+void   lix_note_delete(LineIndexer *lx, size_t pos, size_t n);
+
+#endif // WOFL_LINE_INDEX_H
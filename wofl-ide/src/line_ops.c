@@ -0,0 +1,573 @@
+// ==================== line_ops.c ====================
+// Line spans, sorted, deduplicated and written out in parallel
+
+#include "line_ops.h"
+#include "newline_scan.h"
+#include "wofl_thread.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LO_MAX_JOBS     16
+#define LO_MIN_LINES    (1u << 15)  // lines a job is worth a thread for
+#define LO_RUN          32          // insertion-sorted before merging
+
+typedef struct {
+    size_t   start;
+    uint32_t len;                   // as the line index, a line fits 32 bits
+    uint32_t key, key_len;          // the field sorted by, within the line
+    bool     has_num;
+    union {
+        double   num;               // the keyed sorts
+        uint64_t hash;              // LO_UNIQUE
+        uint64_t prefix;            // LO_SORT: the first units, to compare at once
+    } k;
+} LoLine;
+
+typedef struct {
+    const LineOpArgs *args;
+    const void *text;
+    size_t      n;
+    int         unit;
+    unsigned    sep;                // field separator, LO_SORT_COLUMN
+    bool        ends_nl;            // the last line has its '\n'
+    LoLine     *lines, *tmp;
+    size_t      count;
+    void       *out;
+} LoCtx;
+
+typedef struct {
+    LoCtx  *c;
+    size_t  from, mid, to;          // lines; mid splits a merge
+    size_t  at;                     // output: where the job's lines go
+} LoJob;
+
+static const char *const op_names[LO_COUNT] = {
+    "Sort Lines", "Sort Lines Numerically", "Sort Lines by Column at Caret", "Unique Lines",
+    "Reverse Lines", "Trim Trailing Whitespace", "Convert Tabs to Spaces", "Convert Indentation to Tabs"
+};
+
+const char *lo_name(LineOp op) {
+    return (unsigned)op < LO_COUNT ? op_names[op] : "";
+}
+
+// ===== Units =====
+
+static inline unsigned unit_at(const void *p, int unit, size_t i) {
+    switch (unit) {
+        case 1:  return ((const unsigned char *)p)[i];
+        case 2:  return ((const uint16_t *)p)[i];
+        default: return ((const uint32_t *)p)[i];
+    }
+}
+
+static inline void unit_put(void *p, int unit, size_t i, unsigned u) {
+    switch (unit) {
+        case 1:  ((unsigned char *)p)[i] = (unsigned char)u; break;
+        case 2:  ((uint16_t *)p)[i] = (uint16_t)u; break;
+        default: ((uint32_t *)p)[i] = (uint32_t)u; break;
+    }
+}
+
+static inline unsigned at(const LoCtx *c, size_t i) {
+    return unit_at(c->text, c->unit, i);
+}
+
+static int cmp_units(const LoCtx *c, size_t a, size_t alen, size_t b, size_t blen) {
+    const size_t n = alen < blen ? alen : blen;
+    if (c->unit == 1) {
+        const int r = memcmp((const char *)c->text + a, (const char *)c->text + b, n);
+        if (r) return r;
+    } else {
+        for (size_t i = 0; i < n; i++) {
+            const unsigned x = at(c, a + i), y = at(c, b + i);
+            if (x != y) return x < y ? -1 : 1;
+        }
+    }
+    return (alen > blen) - (alen < blen);
+}
+
+// ===== Jobs =====
+
+static int job_count(const LoCtx *c, size_t lines) {
+    int jobs = c->args->jobs > 0 ? c->args->jobs : wofl_cpu_count();
+    if (jobs > LO_MAX_JOBS) jobs = LO_MAX_JOBS;
+    if (c->args->jobs <= 0 && (size_t)jobs > lines / LO_MIN_LINES) jobs = (int)(lines / LO_MIN_LINES);
+    return jobs > 0 ? jobs : 1;
+}
+
+// Lines [0, count) cut into n jobs
+static void split_jobs(LoCtx *c, LoJob *jobs, int n) {
+    for (int i = 0; i < n; i++) {
+        jobs[i].c = c;
+        jobs[i].from = c->count * (size_t)i / (size_t)n;
+        jobs[i].to = c->count * (size_t)(i + 1) / (size_t)n;
+        jobs[i].mid = jobs[i].to;
+        jobs[i].at = 0;
+    }
+}
+
+// Run jobs[0..n) on worker threads (the last on this one) and wait
+static void run_jobs(LoJob *jobs, int n, wofl_thread_fn fn) {
+    wofl_thread threads[LO_MAX_JOBS];
+    bool started[LO_MAX_JOBS] = {false};
+    for (int i = 0; i < n - 1; i++) {
+        started[i] = wofl_thread_start(&threads[i], fn, &jobs[i]);
+        if (!started[i]) fn(&jobs[i]);
+    }
+    fn(&jobs[n - 1]);
+    for (int i = 0; i < n - 1; i++) {
+        if (started[i]) wofl_thread_join(threads[i]);
+    }
+}
+
+// ===== Line Spans =====
+
+static bool split_lines(LoCtx *c) {
+    c->ends_nl = c->n > 0 && at(c, c->n - 1) == '\n';
+    c->count = c->n == 0 ? 0 : nl_count(c->text, c->n, c->unit) + (c->ends_nl ? 0 : 1);
+    if (c->count == 0) return true;
+    c->lines = (LoLine *)malloc(c->count * sizeof(LoLine));
+    if (!c->lines) return false;
+
+    size_t pos = 0;
+    for (size_t i = 0; i < c->count; i++) {
+        size_t k = 1;
+        const size_t len = nl_find_nth((const char *)c->text + pos * (size_t)c->unit, c->n - pos, c->unit, &k);
+        if (len > UINT32_MAX) return false;
+        c->lines[i].start = pos;
+        c->lines[i].len = (uint32_t)len;
+        pos += len + 1;
+    }
+    return true;
+}
+
+// A file's fields are split by tabs if its first line has tabs and no commas
+static unsigned detect_separator(const void *text, size_t n, int unit) {
+    bool tab = false;
+    for (size_t i = 0; i < n; i++) {
+        const unsigned u = unit_at(text, unit, i);
+        if (u == '\n' || u == ',') return ',';
+        if (u == '\t') tab = true;
+    }
+    return tab ? '\t' : ',';
+}
+
+// End of the field starting at p; separators inside quotes don't count
+static size_t field_end(const void *text, int unit, unsigned sep, size_t p, size_t end) {
+    bool quoted = false;
+    for (; p < end; p++) {
+        const unsigned u = unit_at(text, unit, p);
+        if (u == '"') quoted = !quoted;
+        else if (u == sep && !quoted) break;
+    }
+    return p;
+}
+
+size_t lo_column_at(const void *text, size_t n, int unit, size_t pos) {
+    if (pos > n) pos = n;
+    const size_t nl = nl_find_last(text, pos, unit);
+    const unsigned sep = detect_separator(text, n, unit);
+    size_t p = nl == NL_NONE ? 0 : nl + 1;
+    for (size_t column = 0;; column++) {
+        p = field_end(text, unit, sep, p, pos);
+        if (p >= pos) return column;
+        p++;
+    }
+}
+
+// The number at the start of text[p, end), after any blanks. With whole,
+// nothing but blanks may follow it.
+static bool parse_number(const LoCtx *c, size_t p, size_t end, bool whole, double *out) {
+    while (p < end && (at(c, p) == ' ' || at(c, p) == '\t')) p++;
+    bool neg = false;
+    if (p < end && (at(c, p) == '-' || at(c, p) == '+')) neg = at(c, p++) == '-';
+    double v = 0, scale = 1;
+    bool digits = false;
+    for (; p < end && at(c, p) >= '0' && at(c, p) <= '9'; p++, digits = true) v = v * 10 + (at(c, p) - '0');
+    if (p < end && at(c, p) == '.') {
+        for (p++; p < end && at(c, p) >= '0' && at(c, p) <= '9'; p++, digits = true) {
+            scale /= 10;
+            v += (at(c, p) - '0') * scale;
+        }
+    }
+    if (!digits) return false;
+    if (whole) {
+        while (p < end && (at(c, p) == ' ' || at(c, p) == '\t')) p++;
+        if (p < end) return false;
+    }
+    *out = neg ? -v : v;
+    return true;
+}
+
+static void find_field(const LoCtx *c, LoLine *l) {
+    size_t p = l->start, end = l->start + l->len;
+    if (end > p && at(c, end - 1) == '\r') end--;
+    for (size_t col = 0; col < c->args->column; col++) {
+        p = field_end(c->text, c->unit, c->sep, p, end);
+        if (p >= end) {
+            // Too few fields: an empty key
+            l->key = l->len;
+            l->key_len = 0;
+            return;
+        }
+        p++;
+    }
+    size_t e = field_end(c->text, c->unit, c->sep, p, end);
+    if (e - p >= 2 && at(c, p) == '"' && at(c, e - 1) == '"') p++, e--;
+    l->key = (uint32_t)(p - l->start);
+    l->key_len = (uint32_t)(e - p);
+}
+
+static uint64_t hash_line(const LoCtx *c, const LoLine *l) {
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = l->start; i < l->start + l->len; i++) {
+        h ^= at(c, i);
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+// The line's first units packed high to low, zeros past its end: prefixes
+// that differ order their lines as the full comparison would
+static uint64_t prefix_of(const LoCtx *c, const LoLine *l) {
+    const int bits = c->unit * 8, fit = 8 / c->unit;
+    uint64_t v = 0;
+    for (int i = 0; i < fit && (uint32_t)i < l->len; i++) {
+        v |= (uint64_t)at(c, l->start + (size_t)i) << (64 - bits * (i + 1));
+    }
+    return v;
+}
+
+static WOFL_THREAD_FN(key_job) {
+    LoJob *job = (LoJob *)arg;
+    const LoCtx *c = job->c;
+    for (size_t i = job->from; i < job->to; i++) {
+        LoLine *l = &c->lines[i];
+        l->key = 0;
+        l->key_len = l->len;
+        l->has_num = false;
+        switch (c->args->op) {
+            case LO_SORT_NUMERIC:
+                l->has_num = parse_number(c, l->start, l->start + l->len, false, &l->k.num);
+                break;
+            case LO_SORT_COLUMN:
+                find_field(c, l);
+                l->has_num = parse_number(c, l->start + l->key, l->start + l->key + l->key_len, true, &l->k.num);
+                break;
+            case LO_UNIQUE:
+                l->k.hash = hash_line(c, l);
+                break;
+            case LO_SORT:
+                l->k.prefix = prefix_of(c, l);
+                break;
+            default:
+                break;
+        }
+    }
+    WOFL_THREAD_RETURN;
+}
+
+// ===== Sorting =====
+
+// Keyed sorts put lines without a number first, which keeps a header row
+// on top; numbers go by value, the rest by their text
+static int cmp_lines(const LoCtx *c, const LoLine *a, const LoLine *b) {
+    if (c->args->op == LO_SORT) {
+        if (a->k.prefix != b->k.prefix) return a->k.prefix < b->k.prefix ? -1 : 1;
+    } else {
+        if (a->has_num != b->has_num) return a->has_num ? 1 : -1;
+        if (a->has_num) return (a->k.num > b->k.num) - (a->k.num < b->k.num);
+    }
+    return cmp_units(c, a->start + a->key, a->key_len, b->start + b->key, b->key_len);
+}
+
+static void insertion_sort(const LoCtx *c, LoLine *a, size_t lo, size_t hi) {
+    for (size_t i = lo + 1; i < hi; i++) {
+        const LoLine x = a[i];
+        size_t j = i;
+        for (; j > lo && cmp_lines(c, &x, &a[j - 1]) < 0; j--) a[j] = a[j - 1];
+        a[j] = x;
+    }
+}
+
+// src[lo, mid) and src[mid, hi), each sorted, into dst[lo, hi); ties
+// take the left one first, so the sort is stable
+static void merge(const LoCtx *c, const LoLine *src, LoLine *dst, size_t lo, size_t mid, size_t hi) {
+    size_t i = lo, j = mid, k = lo;
+    while (i < mid && j < hi) dst[k++] = cmp_lines(c, &src[j], &src[i]) < 0 ? src[j++] : src[i++];
+    while (i < mid) dst[k++] = src[i++];
+    while (j < hi) dst[k++] = src[j++];
+}
+
+// Sort lines[from, to), tmp the same range as scratch
+static WOFL_THREAD_FN(sort_job) {
+    LoJob *job = (LoJob *)arg;
+    const LoCtx *c = job->c;
+    const size_t lo = job->from, hi = job->to;
+    for (size_t s = lo; s < hi; s += LO_RUN) insertion_sort(c, c->lines, s, s + LO_RUN < hi ? s + LO_RUN : hi);
+    LoLine *src = c->lines, *dst = c->tmp;
+    for (size_t w = LO_RUN; w < hi - lo; w *= 2) {
+        for (size_t s = lo; s < hi; s += 2 * w) {
+            const size_t mid = s + w < hi ? s + w : hi;
+            merge(c, src, dst, s, mid, s + 2 * w < hi ? s + 2 * w : hi);
+        }
+        LoLine *t = src;
+        src = dst;
+        dst = t;
+    }
+    if (src != c->lines) memcpy(c->lines + lo, src + lo, (hi - lo) * sizeof(LoLine));
+    WOFL_THREAD_RETURN;
+}
+
+static WOFL_THREAD_FN(merge_job) {
+    LoJob *job = (LoJob *)arg;
+    merge(job->c, job->c->lines, job->c->tmp, job->from, job->mid, job->to);
+    WOFL_THREAD_RETURN;
+}
+
+static bool sort_lines(LoCtx *c) {
+    c->tmp = (LoLine *)malloc(c->count * sizeof(LoLine));
+    if (!c->tmp) return false;
+    LoJob jobs[LO_MAX_JOBS];
+    int n = job_count(c, c->count);
+    split_jobs(c, jobs, n);
+    run_jobs(jobs, n, sort_job);
+
+    // Merge neighbouring chunks in pairs until one is left; an odd one out
+    // is carried over as it is
+    while (n > 1) {
+        LoJob pairs[LO_MAX_JOBS];
+        const int m = (n + 1) / 2;
+        for (int i = 0; i < m; i++) {
+            pairs[i] = jobs[2 * i];
+            if (2 * i + 1 < n) {
+                pairs[i].mid = jobs[2 * i].to;
+                pairs[i].to = jobs[2 * i + 1].to;
+            } else {
+                pairs[i].mid = pairs[i].to;
+            }
+        }
+        run_jobs(pairs, m, merge_job);
+        LoLine *t = c->lines;
+        c->lines = c->tmp;
+        c->tmp = t;
+        memcpy(jobs, pairs, (size_t)m * sizeof(LoJob));
+        n = m;
+    }
+    return true;
+}
+
+// ===== Repeats =====
+
+static bool same_line(const LoCtx *c, const LoLine *a, const LoLine *b) {
+    return a->k.hash == b->k.hash && a->len == b->len && cmp_units(c, a->start, a->len, b->start, b->len) == 0;
+}
+
+// Keep the first of each line, in order, with an open-addressed set of
+// the lines kept so far
+static bool unique_lines(LoCtx *c) {
+    size_t cap = 64;
+    while (cap < c->count * 2) cap *= 2;
+    size_t *set = (size_t *)malloc(cap * sizeof(size_t));
+    if (!set) return false;
+    memset(set, 0xFF, cap * sizeof(size_t));
+
+    size_t kept = 0;
+    for (size_t i = 0; i < c->count; i++) {
+        const LoLine l = c->lines[i];
+        size_t slot = (size_t)l.k.hash & (cap - 1);
+        bool seen = false;
+        for (; set[slot] != SIZE_MAX; slot = (slot + 1) & (cap - 1)) {
+            if (same_line(c, &c->lines[set[slot]], &l)) {
+                seen = true;
+                break;
+            }
+        }
+        if (seen) continue;
+        set[slot] = kept;
+        c->lines[kept++] = l;
+    }
+    free(set);
+    c->count = kept;
+    return true;
+}
+
+// ===== Output =====
+
+static void copy_units(const LoCtx *c, void *out, size_t k, size_t p, size_t n) {
+    if (out) memcpy((char *)out + k * (size_t)c->unit, (const char *)c->text + p * (size_t)c->unit, n * (size_t)c->unit);
+}
+
+// Write line i as the op has it, with its '\n', at out[k]; with no out,
+// only count it. Returns the units it takes.
+static size_t emit(const LoCtx *c, size_t i, void *out, size_t k) {
+    const LoLine *l = &c->lines[i];
+    const int unit = c->unit;
+    const size_t tw = c->args->tab_width > 0 ? (size_t)c->args->tab_width : 4;
+    size_t p = l->start, end = l->start + l->len, n = 0;
+
+    switch (c->args->op) {
+        case LO_TRIM: {
+            const bool cr = end > p && at(c, end - 1) == '\r';
+            size_t e = end - cr;
+            while (e > p && (at(c, e - 1) == ' ' || at(c, e - 1) == '\t')) e--;
+            copy_units(c, out, k, p, e - p);
+            n = e - p;
+            if (cr) {
+                if (out) unit_put(out, unit, k + n, '\r');
+                n++;
+            }
+            break;
+        }
+        case LO_TABS_TO_SPACES:
+            for (size_t col = 0; p < end; p++) {
+                const unsigned u = at(c, p);
+                const size_t w = u == '\t' ? tw - col % tw : 1;
+                for (size_t s = 0; out && s < w; s++) unit_put(out, unit, k + n + s, u == '\t' ? ' ' : u);
+                n += w;
+                col += w;
+            }
+            break;
+        case LO_SPACES_TO_TABS: {
+            size_t width = 0;
+            for (; p < end && (at(c, p) == ' ' || at(c, p) == '\t'); p++) {
+                width = at(c, p) == '\t' ? width + tw - width % tw : width + 1;
+            }
+            const size_t tabs = width / tw, indent = tabs + width % tw;
+            for (; out && n < indent; n++) unit_put(out, unit, k + n, n < tabs ? '\t' : ' ');
+            n = indent;
+            copy_units(c, out, k + n, p, end - p);
+            n += end - p;
+            break;
+        }
+        default:
+            copy_units(c, out, k, p, end - p);
+            n = end - p;
+            break;
+    }
+    if (i + 1 < c->count || c->ends_nl) {
+        if (out) unit_put(out, unit, k + n, '\n');
+        n++;
+    }
+    return n;
+}
+
+static WOFL_THREAD_FN(count_job) {
+    LoJob *job = (LoJob *)arg;
+    size_t n = 0;
+    for (size_t i = job->from; i < job->to; i++) n += emit(job->c, i, NULL, 0);
+    job->at = n;
+    WOFL_THREAD_RETURN;
+}
+
+static WOFL_THREAD_FN(write_job) {
+    LoJob *job = (LoJob *)arg;
+    size_t k = job->at;
+    for (size_t i = job->from; i < job->to; i++) k += emit(job->c, i, job->c->out, k);
+    WOFL_THREAD_RETURN;
+}
+
+static bool write_lines(LoCtx *c, LineOpResult *r) {
+    LoJob jobs[LO_MAX_JOBS];
+    const int n = job_count(c, c->count);
+    split_jobs(c, jobs, n);
+    run_jobs(jobs, n, count_job);
+    size_t total = 0;
+    for (int i = 0; i < n; i++) {
+        const size_t len = jobs[i].at;
+        jobs[i].at = total;
+        total += len;
+    }
+    c->out = malloc(total ? total * (size_t)c->unit : 1);
+    if (!c->out) return false;
+    run_jobs(jobs, n, write_job);
+    r->text = c->out;
+    r->len = total;
+    return true;
+}
+
+// Units the two texts share at the start, or with tail at the end
+static size_t shared_units(const void *a, const void *b, size_t n, int unit, bool tail) {
+    const char *x = (const char *)a, *y = (const char *)b;
+    const size_t bytes = n * (size_t)unit;
+    size_t same = 0;
+    while (same < bytes) {
+        const size_t step = bytes - same < 4096 ? bytes - same : 4096;
+        const size_t off = tail ? bytes - same - step : same;
+        if (memcmp(x + off, y + off, step) == 0) {
+            same += step;
+            continue;
+        }
+        size_t i = 0;
+        if (tail) {
+            while (x[off + step - 1 - i] == y[off + step - 1 - i]) i++;
+        } else {
+            while (x[off + i] == y[off + i]) i++;
+        }
+        same += i;
+        break;
+    }
+    return same / (size_t)unit;
+}
+
+bool lo_run(const LineOpArgs *args, const void *text, size_t n, int unit, LineOpResult *out) {
+    LoCtx c;
+    memset(&c, 0, sizeof(c));
+    memset(out, 0, sizeof(*out));
+    c.args = args;
+    c.text = text;
+    c.n = n;
+    c.unit = unit;
+    c.sep = detect_separator(text, n, unit);
+
+    bool ok = split_lines(&c);
+    out->lines_in = c.count;
+    if (ok && c.count > 0) {
+        LoJob jobs[LO_MAX_JOBS];
+        const int jn = job_count(&c, c.count);
+        split_jobs(&c, jobs, jn);
+        run_jobs(jobs, jn, key_job);
+
+        switch (args->op) {
+            case LO_SORT:
+            case LO_SORT_NUMERIC:
+            case LO_SORT_COLUMN:
+                ok = sort_lines(&c);
+                break;
+            case LO_UNIQUE:
+                ok = unique_lines(&c);
+                break;
+            case LO_REVERSE:
+                for (size_t i = 0, j = c.count - 1; i < j; i++, j--) {
+                    const LoLine t = c.lines[i];
+                    c.lines[i] = c.lines[j];
+                    c.lines[j] = t;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    ok = ok && write_lines(&c, out);
+    free(c.lines);
+    free(c.tmp);
+    if (!ok) {
+        free(c.out);
+        memset(out, 0, sizeof(*out));
+        return false;
+    }
+
+    out->lines_out = c.count;
+    const size_t both = n < out->len ? n : out->len;
+    out->keep_head = shared_units(text, out->text, both, unit, false);
+    const size_t rest = both - out->keep_head;
+    out->keep_tail = shared_units((const char *)text + (n - rest) * (size_t)unit,
+                                  (const char *)out->text + (out->len - rest) * (size_t)unit, rest, unit, true);
+    return true;
+}
+
+void lo_result_free(LineOpResult *r) {
+    free(r->text);
+    memset(r, 0, sizeof(*r));
+}
@@ -0,0 +1,69 @@
+// ==================== line_ops.h ====================
+// Whole-buffer line operations: sort, unique, reverse, trim, tabs
+//
+// The text is split once into line spans, an offset and a length each.
+// Sorting, dropping repeats and reversing move the spans, never the text.
+// The new text is then written in one pass: every line's output length is
+// counted, the counts summed, and each line copied to its place. Both
+// steps run in parallel over chunks of lines. Sorting is a stable merge
+// sort: each chunk is sorted on a thread of its own and the chunks are
+// merged in pairs. Repeats are found with a hash set, the hashes of the
+// lines computed in parallel.
+//
+// The caller hands the text over contiguous. It then replaces only what
+// changed, as one edit: keep_head and keep_tail units are the same in the
+// old text and the new one.
+//
+// Positions are counted in buffer units: bytes for the Linux ports,
+// wchar_t for the Win32 port, as in line_index.h.
+
+#ifndef WOFL_LINE_OPS_H
+#define WOFL_LINE_OPS_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef enum {
+    LO_SORT = 0,                // by the text, unit by unit
+    LO_SORT_NUMERIC,            // by the number each line starts with
+    LO_SORT_COLUMN,             // by one comma- or tab-separated field
+    LO_UNIQUE,                  // drop lines seen before, keeping the first
+    LO_REVERSE,
+    LO_TRIM,                    // trailing spaces and tabs
+    LO_TABS_TO_SPACES,
+    LO_SPACES_TO_TABS,          // indentation only
+    LO_COUNT
+} LineOp;
+
+typedef struct {
+    LineOp op;
+    size_t column;              // LO_SORT_COLUMN: the field, from 0
+    int    tab_width;           // the tab conversions
+    int    jobs;                // threads to use; 0: one per processor
+} LineOpArgs;
+
+typedef struct {
+    void   *text;               // the new text, malloc'd
+    size_t  len;
+    size_t  keep_head;          // units the old and new text share at the start
+    size_t  keep_tail;          // and at the end
+    size_t  lines_in, lines_out;
+} LineOpResult;
+
+// The command's name, as the palettes list it
+const char *lo_name(LineOp op);
+
+/**
+ * Field of the line holding pos, as LO_SORT_COLUMN counts them: the caret's
+ * column picks the one to sort by
+ */
+size_t lo_column_at(const void *text, size_t n, int unit, size_t pos);
+
+/**
+ * Apply args->op to the n units of text. False if memory runs out, in
+ * which case out holds nothing.
+ */
+bool lo_run(const LineOpArgs *args, const void *text, size_t n, int unit, LineOpResult *out);
+void lo_result_free(LineOpResult *r);
+
+#endif // WOFL_LINE_OPS_H
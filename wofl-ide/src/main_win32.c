@@ -2,6 +2,9 @@
 // Main window and application logic
 
 #include "editor.h"
+#include "plugin_system.h"
+#include "goto_target.h"
+#include "line_ops.h"
 #include <commdlg.h>
 #include <shellapi.h>
 #include <wchar.h>
@@ -14,10 +17,12 @@
 
 // Global application state
 static AppState g_app;
+static PluginManager g_plugins;
 
 // ===== Forward Declarations =====
 static void update_window_title(HWND hwnd);
 static void set_current_file(const wchar_t *path);
+static void open_file(const wchar_t *path);
 static void open_file_dialog(void);
 static void save_file_as_dialog(void);
 static void save_file(void);
@@ -35,6 +40,11 @@ static void backspace(void);
 static void delete_forward(void);
 static void insert_newline(void);
 static void insert_tab(void);
+static void carets_clear(void);
+static void carets_add_line(int direction);
+static void carets_add_to_end(void);
+static void carets_edit(const wchar_t *text, size_t len, size_t del, bool back);
+static bool carets_move(WPARAM key);
 static void copy_to_clipboard(void);
 static void paste_from_clipboard(void);
 static void run_current_file(void);
@@ -43,6 +53,9 @@ static void open_goto_dialog(void);
 static void overlay_insert_char(wchar_t ch);
 static void overlay_backspace(void);
 static void overlay_confirm(void);
+static void complete_update(bool requested);
+static void complete_close(void);
+static void complete_accept(void);
 static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
 
 // ===== Helper Functions =====
@@ -78,12 +91,44 @@ static void set_current_file(const wchar_t *path) {
         wcscpy_s(g_app.file_name, WOFL_MAX_PATH, path);
     }
     
-    // Detect language
-    g_app.lang = syntax_detect_language(path);
+    // Detect language once; rendering reuses the scanner
+    g_app.lang = syntax_detect_language(path, &g_app.buf);
+    g_app.syntax = syntax_get(g_app.lang);
     g_app.need_recount = true;
+    palette_file_opened(&g_app, path);
     update_window_title(g_app.hwnd);
 }
 
+/**
+ * Load path into the buffer
+ */
+static void open_file(const wchar_t *path) {
+    EolMode eol;
+    lix_stop(&g_app.lines);
+    gb_free(&g_app.buf);
+    
+    bool loaded = gb_load_from_file(&g_app.buf, path, &eol);
+    editor_index_start(&g_app);
+    complete_close();
+    carets_clear();
+    plugin_manager_file_open(&g_plugins, path);
+    if (loaded) {
+        g_app.buf.eol_mode = eol;
+        g_app.caret.line = 0;
+        g_app.caret.col = 0;
+        g_app.top_line = 0;
+        g_app.left_col = 0;
+        g_app.selecting = false;
+        g_app.overwrite_mode = false;
+        
+        set_current_file(path);
+        config_set_default_run_cmd(&g_app);
+        config_try_load_run_cmd(&g_app);
+        
+        InvalidateRect(g_app.hwnd, NULL, TRUE);
+    }
+}
+
 /**
  * Open file dialog
  */
@@ -103,24 +148,7 @@ static void open_file_dialog(void) {
     ofn.Flags = OFN_EXPLORER | OFN_FILEMUSTEXIST;
     
     if (GetOpenFileNameW(&ofn)) {
-        EolMode eol;
-        gb_free(&g_app.buf);
-        
-        if (gb_load_from_file(&g_app.buf, path, &eol)) {
-            g_app.buf.eol_mode = eol;
-            g_app.caret.line = 0;
-            g_app.caret.col = 0;
-            g_app.top_line = 0;
-            g_app.left_col = 0;
-            g_app.selecting = false;
-            g_app.overwrite_mode = false;
-            
-            set_current_file(path);
-            config_set_default_run_cmd(&g_app);
-            config_try_load_run_cmd(&g_app);
-            
-            InvalidateRect(g_app.hwnd, NULL, TRUE);
-        }
+        open_file(path);
     }
 }
 
@@ -163,6 +191,18 @@ static void save_file(void) {
     }
 }
 
+/**
+ * Lines the text area shows; expects the metrics to be set
+ */
+static int visible_lines(void) {
+    int usable_height = g_app.client_rc.bottom - (g_app.theme.line_h + 2);
+    if (g_app.out.visible) {
+        usable_height -= g_app.out.height_px;
+    }
+    
+    return max_int(usable_height / g_app.theme.line_h, 1);
+}
+
 /**
  * Ensure caret is visible in viewport
  */
@@ -177,12 +217,7 @@ static void ensure_caret_visible(void) {
         g_app.top_line = g_app.caret.line;
     }
     
-    int usable_height = g_app.client_rc.bottom - (g_app.theme.line_h + 2);
-    if (g_app.out.visible) {
-        usable_height -= g_app.out.height_px;
-    }
-    
-    int lines_fit = max_int(usable_height / g_app.theme.line_h, 1);
+    int lines_fit = visible_lines();
     
     if (g_app.caret.line >= g_app.top_line + lines_fit) {
         g_app.top_line = g_app.caret.line - lines_fit + 1;
@@ -204,16 +239,35 @@ static void ensure_caret_visible(void) {
  * Get line length
  */
 static int get_line_length(int line) {
-    size_t start = editor_line_start_index(&g_app.buf, line);
-    size_t end = editor_line_start_index(&g_app.buf, line + 1);
-    int length = 0;
-    
-    for (size_t i = start; i < end; i++) {
-        if (gb_char_at(&g_app.buf, i) == L'\n') break;
-        length++;
+    lix_lock(&g_app.lines);
+    size_t length = li_line_length(&g_app.lines.index, (size_t)line);
+    lix_unlock(&g_app.lines);
+    return (int)length;
+}
+
+// Line starts come from the index, which carets never pass: they are put
+// on lines it has counted
+static size_t caret_index(Caret c) {
+    lix_lock(&g_app.lines);
+    size_t idx = li_line_start(&g_app.lines.index, (size_t)c.line);
+    lix_unlock(&g_app.lines);
+    const size_t len = gb_length(&g_app.buf);
+    for (int col = 0; idx < len && col < c.col; col++, idx++) {
+        if (gb_char_at(&g_app.buf, idx) == L'\n') break;
     }
-    
-    return length;
+    return idx;
+}
+
+static Caret caret_at_index(size_t idx) {
+    Caret c;
+    lix_lock(&g_app.lines);
+    const size_t line = li_line_of(&g_app.lines.index, idx);
+    const size_t start = li_line_start(&g_app.lines.index, line);
+    lix_unlock(&g_app.lines);
+    c.line = (int)line;
+    c.col = (int)(idx - start);
+    c.index = idx;
+    return c;
 }
 
 // ===== Selection Management =====
@@ -224,10 +278,8 @@ static int get_line_length(int line) {
 static bool get_selection(size_t *start, size_t *end) {
     if (!g_app.selecting) return false;
     
-    size_t caret_idx = editor_linecol_to_index(&g_app.buf,
-                                                g_app.caret.line, g_app.caret.col);
-    size_t anchor_idx = editor_linecol_to_index(&g_app.buf,
-                                                 g_app.sel_anchor.line, g_app.sel_anchor.col);
+    size_t caret_idx = caret_index(g_app.caret);
+    size_t anchor_idx = an_pos(&g_app.anchors, g_app.sel_anchor);
     
     if (caret_idx == anchor_idx) return false;
     
@@ -236,12 +288,19 @@ static bool get_selection(size_t *start, size_t *end) {
     return true;
 }
 
+/**
+ * Start the selection at the caret
+ */
+static void mark_selection(void) {
+    an_set(&g_app.anchors, g_app.sel_anchor, caret_index(g_app.caret));
+}
+
 /**
  * Clear selection
  */
 static void clear_selection(void) {
     g_app.selecting = false;
-    g_app.sel_anchor = g_app.caret;
+    mark_selection();
 }
 
 // ===== Movement Functions =====
@@ -255,7 +314,7 @@ static void move_left(bool select) {
     }
     
     if (!select) {
-        g_app.sel_anchor = g_app.caret;
+        mark_selection();
         g_app.selecting = false;
     } else {
         g_app.selecting = true;
@@ -273,7 +332,7 @@ static void move_right(bool select) {
     }
     
     if (!select) {
-        g_app.sel_anchor = g_app.caret;
+        mark_selection();
         g_app.selecting = false;
     } else {
         g_app.selecting = true;
@@ -290,7 +349,7 @@ static void move_up(bool select) {
     }
     
     if (!select) {
-        g_app.sel_anchor = g_app.caret;
+        mark_selection();
         g_app.selecting = false;
     } else {
         g_app.selecting = true;
@@ -307,7 +366,7 @@ static void move_down(bool select) {
     }
     
     if (!select) {
-        g_app.sel_anchor = g_app.caret;
+        mark_selection();
         g_app.selecting = false;
     } else {
         g_app.selecting = true;
@@ -323,8 +382,7 @@ static void insert_text(const wchar_t *text, int len) {
     if (len <= 0) return;
     
     size_t pos = editor_linecol_to_index(&g_app.buf, g_app.caret.line, g_app.caret.col);
-    gb_move_gap(&g_app.buf, pos);
-    gb_insert(&g_app.buf, text, len);
+    editor_buf_insert(&g_app, pos, text, (size_t)len);
     
     g_app.buf.dirty = true;
     g_app.need_recount = true;
@@ -346,7 +404,7 @@ static void insert_text(const wchar_t *text, int len) {
 static void delete_range(size_t start, size_t end) {
     if (end <= start) return;
     
-    gb_delete_range(&g_app.buf, start, end - start);
+    editor_buf_delete(&g_app, start, end - start);
     g_app.buf.dirty = true;
     g_app.need_recount = true;
     
@@ -435,6 +493,201 @@ static void insert_tab(void) {
     insert_text(spaces, tab_width);
 }
 
+// ===== Carets =====
+
+// Carets besides the main one are anchors of ANCHOR_CARET (anchors.h):
+// edits anywhere move them along, and a batch at all of them moves them
+// past their own edits. Gathered here for a batch, with its edits.
+static AnchorId *caret_ids;
+static size_t *caret_at;
+static EditOp *caret_ops;
+static size_t caret_cap;
+
+static void *heap_grow(void *p, size_t bytes) {
+    return p ? HeapReAlloc(GetProcessHeap(), 0, p, bytes) : HeapAlloc(GetProcessHeap(), 0, bytes);
+}
+
+static void heap_free(void *p) {
+    if (p) HeapFree(GetProcessHeap(), 0, p);
+}
+
+/**
+ * Drop every caret but the main one
+ */
+static void carets_clear(void) {
+    an_remove_owner(&g_app.anchors, ANCHOR_CARET);
+    g_app.carets = 0;
+    heap_free(caret_ids);
+    heap_free(caret_at);
+    heap_free(caret_ops);
+    caret_ids = NULL;
+    caret_at = NULL;
+    caret_ops = NULL;
+    caret_cap = 0;
+}
+
+static bool carets_reserve(size_t n) {
+    if (n <= caret_cap) return true;
+    size_t cap = caret_cap ? caret_cap : 64;
+    while (cap < n) cap *= 2;
+    AnchorId *ids = (AnchorId*)heap_grow(caret_ids, cap * sizeof(AnchorId));
+    if (ids) caret_ids = ids;
+    size_t *at = (size_t*)heap_grow(caret_at, cap * sizeof(size_t));
+    if (at) caret_at = at;
+    EditOp *ops = (EditOp*)heap_grow(caret_ops, cap * sizeof(EditOp));
+    if (ops) caret_ops = ops;
+    if (!ids || !at || !ops) return false;
+    caret_cap = cap;
+    return true;
+}
+
+// Every caret but the main one, in order, into caret_ids and caret_at
+static size_t carets_gather(void) {
+    if (!carets_reserve((size_t)g_app.carets + 1)) return 0;
+    return an_collect(&g_app.anchors, 0, SIZE_MAX, ANCHOR_CARET, caret_ids, caret_at, (size_t)g_app.carets);
+}
+
+// A caret at idx, unless one is there already
+static bool carets_add(size_t idx) {
+    if (idx == caret_index(g_app.caret) ||
+        an_collect(&g_app.anchors, idx, idx, ANCHOR_CARET, NULL, NULL, 1)) return false;
+    if (an_add(&g_app.anchors, idx, AN_RIGHT, ANCHOR_CARET) == AN_NONE) return false;
+    g_app.carets++;
+    return true;
+}
+
+static size_t caret_on_line(int line) {
+    Caret c = { line, min_int(g_app.caret.col, get_line_length(line)), 0 };
+    return caret_index(c);
+}
+
+/**
+ * Add a caret on the line past the outermost one that way, at the main
+ * caret's column
+ */
+static void carets_add_line(int direction) {
+    int line = g_app.caret.line;
+    size_t first, last;
+    if (an_bounds(&g_app.anchors, ANCHOR_CARET, &first, &last)) {
+        const int outer = caret_at_index(direction < 0 ? first : last).line;
+        line = direction < 0 ? min_int(line, outer) : max_int(line, outer);
+    }
+    line += direction;
+    if (line < 0 || line >= editor_total_lines(&g_app)) return;
+    carets_add(caret_on_line(line));
+}
+
+/**
+ * Add a caret on every line below the main one, for editing a column
+ */
+static void carets_add_to_end(void) {
+    const int total = editor_total_lines(&g_app);
+    for (int line = g_app.caret.line + 1; line < total; line++) carets_add(caret_on_line(line));
+}
+
+// Carets that met are one caret
+static void carets_merge(void) {
+    const size_t main_idx = caret_index(g_app.caret);
+    const size_t n = carets_gather();
+    int kept = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (caret_at[i] == main_idx || (i > 0 && caret_at[i] == caret_at[i - 1])) an_remove(&g_app.anchors, caret_ids[i]);
+        else kept++;
+    }
+    g_app.carets = kept;
+}
+
+/**
+ * One edit at every caret, as one batch: del characters before (back) or
+ * after each caret are replaced with text. The carets' anchors follow the
+ * batch; the main caret lands after its edit. Any selection is dropped first.
+ */
+static void carets_edit(const wchar_t *text, size_t len, size_t del, bool back) {
+    const size_t n = carets_gather() + 1;
+    if (n == 1) return;
+    clear_selection();
+    const size_t total = gb_length(&g_app.buf);
+    for (size_t i = 0; i < n; i++) {
+        size_t pos = i == 0 ? caret_index(g_app.caret) : caret_at[i - 1];
+        size_t d = del;
+        if (back) {
+            d = min_size(d, pos);
+            pos -= d;
+        } else {
+            d = min_size(d, total - pos);
+        }
+        caret_ops[i] = (EditOp){ pos, d, text, len, (uint32_t)i, 0 };
+    }
+    editor_buf_apply(&g_app, caret_ops, n);
+    g_app.need_recount = true;
+
+    for (size_t i = 0; i < n; i++) {
+        if (caret_ops[i].tag == 0) g_app.caret = caret_at_index(caret_ops[i].at);
+    }
+    carets_merge();
+    mark_selection();
+}
+
+/**
+ * The arrow keys move every caret alike; returns false for other keys or
+ * with no carets besides the main one
+ */
+static bool carets_move(WPARAM key) {
+    if (g_app.carets == 0) return false;
+    if (key != VK_LEFT && key != VK_RIGHT && key != VK_UP && key != VK_DOWN) return false;
+    const size_t n = carets_gather();
+    Caret main_caret = g_app.caret;
+    // Moved as if selecting, which leaves the selection anchor where it is
+    for (size_t i = 0; i <= n; i++) {
+        g_app.caret = i == 0 ? main_caret : caret_at_index(caret_at[i - 1]);
+        switch (key) {
+            case VK_LEFT:  move_left(true);  break;
+            case VK_RIGHT: move_right(true); break;
+            case VK_UP:    move_up(true);    break;
+            case VK_DOWN:  move_down(true);  break;
+        }
+        if (i == 0) main_caret = g_app.caret;
+        else an_set(&g_app.anchors, caret_ids[i - 1], caret_index(g_app.caret));
+    }
+    g_app.caret = main_caret;
+    clear_selection();
+    carets_merge();
+    return true;
+}
+
+// ===== Line Operations =====
+
+/**
+ * Sort, dedupe, reverse, trim or retab every line (line_ops.h). The text
+ * is rewritten in one pass and goes back as a single edit over the part
+ * that changed; the caret stays on its line number.
+ */
+static void run_line_op(LineOp op) {
+    lix_lock(&g_app.lines);
+    const size_t len = gb_length(&g_app.buf);
+    gb_move_gap(&g_app.buf, len);
+    const wchar_t *text = g_app.buf.data;
+    lix_unlock(&g_app.lines);
+    
+    LineOpArgs args = { op, 0, g_app.tab_width > 0 ? g_app.tab_width : WOFL_DEFAULT_TAB, 0 };
+    if (op == LO_SORT_COLUMN) args.column = lo_column_at(text, len, (int)sizeof(wchar_t), caret_index(g_app.caret));
+    LineOpResult r;
+    if (!lo_run(&args, text, len, (int)sizeof(wchar_t), &r)) return;
+    
+    EditOp edit = { r.keep_head, len - r.keep_head - r.keep_tail, (const wchar_t*)r.text + r.keep_head,
+                    r.len - r.keep_head - r.keep_tail, 0, 0 };
+    if (edit.del > 0 || edit.len > 0) {
+        carets_clear();
+        editor_buf_apply(&g_app, &edit, 1);
+        g_app.need_recount = true;
+        g_app.caret.line = max_int(min_int(g_app.caret.line, editor_total_lines(&g_app) - 1), 0);
+        g_app.caret.col = min_int(g_app.caret.col, get_line_length(g_app.caret.line));
+        clear_selection();
+        ensure_caret_visible();
+    }
+    lo_result_free(&r);
+}
+
 // ===== Clipboard Operations =====
 
 /**
@@ -560,12 +813,32 @@ static void open_find_dialog(void) {
 static void open_goto_dialog(void) {
     g_app.mode = MODE_GOTO;
     g_app.overlay_active = true;
-    wcscpy_s(g_app.overlay_prompt, 128, L"Line:");
+    wcscpy_s(g_app.overlay_prompt, 128, L"Go to line[:col], n% or @offset:");
     g_app.overlay_text[0] = L'\0';
     g_app.overlay_len = 0;
     g_app.overlay_cursor = 0;
 }
 
+/**
+ * Move the caret to a go-to target and scroll it to the middle of the
+ * view. Looked up in the line index, so as quick at the end of a huge
+ * file as at its start.
+ */
+static void goto_jump(const GotoTarget *target) {
+    size_t line, col = (size_t)g_app.caret.col;
+    lix_lock(&g_app.lines);
+    goto_resolve(target, &g_app.lines.index, &line, &col);
+    lix_unlock(&g_app.lines);
+    
+    g_app.caret.line = (int)line;
+    g_app.caret.col = (int)col;
+    clear_selection();
+    if (g_app.theme.line_h > 0) {
+        g_app.top_line = max_int(g_app.caret.line - visible_lines() / 2, 0);
+    }
+    ensure_caret_visible();
+}
+
 /**
  * Handle overlay input
  */
@@ -616,24 +889,15 @@ static void overlay_confirm(void) {
             break;
             
         case MODE_GOTO: {
-            int line_num = _wtoi(g_app.overlay_text);
-            if (line_num > 0) {
-                g_app.caret.line = line_num - 1;
-                int total = editor_total_lines(&g_app);
-                if (g_app.caret.line >= total) {
-                    g_app.caret.line = total - 1;
-                }
-                if (g_app.caret.line < 0) {
-                    g_app.caret.line = 0;
-                }
-                
-                int line_len = get_line_length(g_app.caret.line);
-                if (g_app.caret.col > line_len) {
-                    g_app.caret.col = line_len;
-                }
-                
-                ensure_caret_visible();
+            // The prompt only takes ASCII
+            char text[WOFL_CMD_MAX];
+            int n = 0;
+            for (; n < g_app.overlay_len && n < WOFL_CMD_MAX - 1; n++) {
+                text[n] = g_app.overlay_text[n] < 128 ? (char)g_app.overlay_text[n] : '?';
             }
+            text[n] = '\0';
+            GotoTarget target;
+            if (goto_parse(text, &target)) goto_jump(&target);
             break;
         }
             
@@ -647,6 +911,40 @@ static void overlay_confirm(void) {
     InvalidateRect(g_app.hwnd, NULL, FALSE);
 }
 
+// ===== Word Completion =====
+
+/**
+ * Completions of the word before the caret. Unless requested, the popup
+ * waits for WOFL_COMPLETE_MIN characters of it.
+ */
+static void complete_update(bool requested) {
+    CompletionPopup *cp = &g_app.complete;
+    size_t pos = editor_linecol_to_index(&g_app.buf, g_app.caret.line, g_app.caret.col);
+
+    cp->prefix_len = 0;
+    cp->count = plugin_manager_complete(&g_plugins, pos, cp->items, WOFL_COMPLETE_MAX, &cp->prefix_len);
+    cp->selected = 0;
+    cp->visible = cp->count > 0 && (requested || cp->prefix_len >= WOFL_COMPLETE_MIN);
+}
+
+static void complete_close(void) {
+    g_app.complete.visible = false;
+}
+
+/**
+ * Finish the word with the selected completion
+ */
+static void complete_accept(void) {
+    CompletionPopup *cp = &g_app.complete;
+    const wchar_t *item = cp->items[cp->selected];
+    int len = (int)wcslen(item);
+
+    cp->visible = false;
+    if (cp->prefix_len < len) {
+        insert_text(item + cp->prefix_len, len - cp->prefix_len);
+    }
+}
+
 // ===== Window Procedure =====
 
 static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
@@ -680,8 +978,13 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
                 g_app.theme.hFont = CreateFontIndirectW(&lf);
             }
 
-            // Initialize buffer
+            // Initialize buffer and its line index
             gb_init(&g_app.buf);
+            lix_init(&g_app.lines);
+            fa_init(&g_app.frame);
+            an_init(&g_app.anchors);
+            g_app.sel_anchor = an_add(&g_app.anchors, 0, AN_LEFT, ANCHOR_SELECTION);
+            editor_index_start(&g_app);
 
             // Initialize output buffer
             gb_init(&g_app.out.buf);
@@ -695,7 +998,7 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
             g_app.left_col = 0;
             g_app.caret.line = 0;
             g_app.caret.col = 0;
-            g_app.sel_anchor = g_app.caret;
+            mark_selection();
             g_app.selecting = false;
             g_app.overlay_active = false;
             g_app.overwrite_mode = false;
@@ -715,6 +1018,13 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
 
             // Default language
             g_app.lang = LANG_PLAIN;
+            g_app.syntax = syntax_get(g_app.lang);
+
+            // Built-in plugins; from here on they see every edit
+            plugin_manager_init(&g_plugins, &g_app);
+            g_app.plugins = &g_plugins;
+            palette_init(&g_app);
+            pal_register(&g_app.palette, plugin_manager_commands(&g_plugins));
 
             update_window_title(hwnd);
             return 0;
@@ -775,6 +1085,7 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
             if (g_app.theme.ch_w == 0) g_app.theme.ch_w = 8;
             
             SetCapture(hwnd);
+            complete_close();
             
             int x = GET_X_LPARAM(lParam);
             int y = GET_Y_LPARAM(lParam);
@@ -788,12 +1099,13 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
             
             g_app.caret.line = line;
             g_app.caret.col = col;
+            carets_clear();
             
             if (GetKeyState(VK_SHIFT) & 0x8000) {
                 g_app.selecting = true;
             } else {
                 g_app.selecting = false;
-                g_app.sel_anchor = g_app.caret;
+                mark_selection();
             }
             
             InvalidateRect(hwnd, NULL, FALSE);
@@ -865,14 +1177,52 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
                 return 0;
             }
             
+            // Completion popup: Tab or Enter takes the selected word
+            if (g_app.complete.visible) {
+                if (ch == L'\t' || ch == L'\r' || ch == L'\n') {
+                    complete_accept();
+                    ensure_caret_visible();
+                    InvalidateRect(hwnd, NULL, FALSE);
+                    return 0;
+                } else if (ch == 27) {  // ESC
+                    complete_close();
+                    InvalidateRect(hwnd, NULL, FALSE);
+                    return 0;
+                }
+            }
+            if (ch == L' ' && (GetKeyState(VK_CONTROL) & 0x8000)) {  // Ctrl+Space
+                complete_update(true);
+                InvalidateRect(hwnd, NULL, FALSE);
+                return 0;
+            }
+            
+            // Every caret types the same; there is no completing at many
+            if (g_app.carets && (ch == L'\r' || ch == L'\n' || ch == L'\t' || ch >= 32)) {
+                if (ch == L'\t') {
+                    wchar_t spaces[32];
+                    const int tab_width = min_int(g_app.tab_width > 0 ? g_app.tab_width : WOFL_DEFAULT_TAB, 31);
+                    for (int i = 0; i < tab_width; i++) spaces[i] = L' ';
+                    carets_edit(spaces, (size_t)tab_width, 0, false);
+                } else {
+                    const wchar_t text = ch == L'\r' ? L'\n' : ch;
+                    carets_edit(&text, 1, 0, false);
+                }
+                complete_close();
+                ensure_caret_visible();
+                InvalidateRect(hwnd, NULL, FALSE);
+                return 0;
+            }
+            
             // Normal editing
             if (ch == 27) {  // ESC
-                if (g_app.selecting) {
+                if (g_app.selecting || g_app.carets) {
                     clear_selection();
+                    carets_clear();
                     InvalidateRect(hwnd, NULL, FALSE);
                 }
             } else if (ch == L'\r' || ch == L'\n') {
                 insert_newline();
+                complete_close();
                 ensure_caret_visible();
                 InvalidateRect(hwnd, NULL, FALSE);
             } else if (ch == L'\t') {
@@ -889,6 +1239,11 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
                 
                 wchar_t text[2] = {ch, L'\0'};
                 insert_text(text, 1);
+                if (iswalnum(ch) || ch == L'_') {
+                    complete_update(false);
+                } else {
+                    complete_close();
+                }
                 ensure_caret_visible();
                 InvalidateRect(hwnd, NULL, FALSE);
             }
@@ -927,10 +1282,61 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
                         InvalidateRect(hwnd, NULL, FALSE);
                         return 0;
                 }
+                // Palette: Up and Down pick a hit, Page Up and Down a list's worth
+                if (g_app.mode == MODE_PALETTE) {
+                    int delta = wParam == VK_UP ? -1 : wParam == VK_DOWN ? 1 :
+                                wParam == VK_PRIOR ? -WOFL_PALETTE_ROWS : wParam == VK_NEXT ? WOFL_PALETTE_ROWS : 0;
+                    if (delta) {
+                        palette_move(&g_app, delta);
+                        InvalidateRect(hwnd, NULL, FALSE);
+                        return 0;
+                    }
+                }
+            }
+            
+            // Completion popup: Up and Down pick a word, moving the caret closes it
+            if (g_app.complete.visible) {
+                CompletionPopup *cp = &g_app.complete;
+                switch (wParam) {
+                    case VK_UP:
+                        cp->selected = (cp->selected + cp->count - 1) % cp->count;
+                        InvalidateRect(hwnd, NULL, FALSE);
+                        return 0;
+                    case VK_DOWN:
+                        cp->selected = (cp->selected + 1) % cp->count;
+                        InvalidateRect(hwnd, NULL, FALSE);
+                        return 0;
+                    case VK_LEFT:
+                    case VK_RIGHT:
+                    case VK_HOME:
+                    case VK_END:
+                    case VK_PRIOR:
+                    case VK_NEXT:
+                    case VK_DELETE:
+                        complete_close();
+                        break;
+                }
+            }
+            
+            // Ctrl+Alt+Up and Down add a caret a line further that way,
+            // Ctrl+Alt+End one on every line below
+            if (ctrl && (GetKeyState(VK_MENU) & 0x8000) &&
+                (wParam == VK_UP || wParam == VK_DOWN || wParam == VK_END)) {
+                complete_close();
+                if (wParam == VK_END) carets_add_to_end();
+                else carets_add_line(wParam == VK_UP ? -1 : 1);
+                InvalidateRect(hwnd, NULL, FALSE);
+                return 0;
+            }
+            if (!shift && !ctrl && carets_move(wParam)) {
+                ensure_caret_visible();
+                InvalidateRect(hwnd, NULL, FALSE);
+                return 0;
             }
             
             // Global shortcuts
             if (ctrl) {
+                if (wParam != VK_CONTROL) complete_close();
                 switch (wParam) {
                     case 'O':
                         open_file_dialog();
@@ -948,8 +1354,7 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
                         open_goto_dialog();
                         return 0;
                     case 'A':  // Select all
-                        g_app.sel_anchor.line = 0;
-                        g_app.sel_anchor.col = 0;
+                        an_set(&g_app.anchors, g_app.sel_anchor, 0);
                         g_app.caret.line = editor_total_lines(&g_app) - 1;
                         g_app.caret.col = get_line_length(g_app.caret.line);
                         g_app.selecting = true;
@@ -1026,7 +1431,7 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
                         g_app.caret.col = 0;
                     }
                     if (!shift) {
-                        g_app.sel_anchor = g_app.caret;
+                        mark_selection();
                         g_app.selecting = false;
                     } else {
                         g_app.selecting = true;
@@ -1041,7 +1446,7 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
                     }
                     g_app.caret.col = get_line_length(g_app.caret.line);
                     if (!shift) {
-                        g_app.sel_anchor = g_app.caret;
+                        mark_selection();
                         g_app.selecting = false;
                     } else {
                         g_app.selecting = true;
@@ -1060,7 +1465,7 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
                         g_app.caret.line = 0;
                     }
                     if (!shift) {
-                        g_app.sel_anchor = g_app.caret;
+                        mark_selection();
                         g_app.selecting = false;
                     } else {
                         g_app.selecting = true;
@@ -1082,7 +1487,7 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
                         }
                     }
                     if (!shift) {
-                        g_app.sel_anchor = g_app.caret;
+                        mark_selection();
                         g_app.selecting = false;
                     } else {
                         g_app.selecting = true;
@@ -1092,13 +1497,18 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
                     return 0;
                     
                 case VK_BACK:
-                    backspace();
+                    if (g_app.carets) carets_edit(NULL, 0, 1, true);
+                    else backspace();
+                    if (g_app.complete.visible) {
+                        complete_update(false);
+                    }
                     ensure_caret_visible();
                     InvalidateRect(hwnd, NULL, FALSE);
                     return 0;
                     
                 case VK_DELETE:
-                    delete_forward();
+                    if (g_app.carets) carets_edit(NULL, 0, 1, false);
+                    else delete_forward();
                     ensure_caret_visible();
                     InvalidateRect(hwnd, NULL, FALSE);
                     return 0;
@@ -1121,6 +1531,18 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
                         InvalidateRect(hwnd, NULL, TRUE); break;
                 case 6: open_find_dialog(); break;
                 case 7: open_goto_dialog(); break;
+                case 8: {  // recent file lParam, from the palette
+                    wchar_t path[WOFL_MAX_PATH];
+                    if (lParam >= 0 && lParam < g_app.recent.count &&
+                        MultiByteToWideChar(CP_UTF8, 0, g_app.recent.paths[lParam], -1, path, WOFL_MAX_PATH) > 0) {
+                        open_file(path);
+                    }
+                    break;
+                }
+                case 9:  // line operation lParam, from the palette
+                    if (lParam >= 0 && lParam < LO_COUNT) run_line_op((LineOp)lParam);
+                    InvalidateRect(hwnd, NULL, FALSE);
+                    break;
             }
             return 0;
         }
@@ -1146,6 +1568,13 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPara
         }
         
         case WM_DESTROY: {
+            g_app.plugins = NULL;
+            plugin_manager_shutdown(&g_plugins);
+            palette_free(&g_app);
+            carets_clear();
+            an_free(&g_app.anchors);
+            lix_free(&g_app.lines);
+            fa_free(&g_app.frame);
             gb_free(&g_app.buf);
             if (g_app.out.buf.data) {
                 gb_free(&g_app.out.buf);
@@ -1199,7 +1628,11 @@ int APIENTRY wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance,
     LPWSTR *argv = CommandLineToArgvW(GetCommandLineW(), &argc);
     if (argv && argc > 1) {
         EolMode eol;
-        if (gb_load_from_file(&g_app.buf, argv[1], &eol)) {
+        lix_stop(&g_app.lines);
+        bool loaded = gb_load_from_file(&g_app.buf, argv[1], &eol);
+        editor_index_start(&g_app);
+        plugin_manager_file_open(&g_plugins, argv[1]);
+        if (loaded) {
             g_app.buf.eol_mode = eol;
             set_current_file(argv[1]);
             config_set_default_run_cmd(&g_app);
@@ -0,0 +1,377 @@
+// ==================== newline_scan.c ====================
+// SSE2 / AVX2 / scalar newline kernels with CPUID dispatch
+
+#include "newline_scan.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define NL_X86 1
+#include <emmintrin.h>
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define NL_TARGET(isa) __attribute__((target(isa)))
+#else
+#define NL_TARGET(isa)
+#endif
+
+// ===== Bit Helpers =====
+
+static inline unsigned nl_ctz32(uint32_t m) {
+#ifdef _MSC_VER
+    unsigned long i;
+    _BitScanForward(&i, m);
+    return (unsigned)i;
+#else
+    return (unsigned)__builtin_ctz(m);
+#endif
+}
+
+static inline unsigned nl_msb32(uint32_t m) {
+#ifdef _MSC_VER
+    unsigned long i;
+    _BitScanReverse(&i, m);
+    return (unsigned)i;
+#else
+    return 31u - (unsigned)__builtin_clz(m);
+#endif
+}
+
+// No POPCNT instruction: it is not implied by SSE2
+static inline unsigned nl_popcount32(uint32_t m) {
+    m = m - ((m >> 1) & 0x55555555u);
+    m = (m & 0x33333333u) + ((m >> 2) & 0x33333333u);
+    m = (m + (m >> 4)) & 0x0F0F0F0Fu;
+    return (m * 0x01010101u) >> 24;
+}
+
+// ===== Kernel Template =====
+// Every kernel works on STEP units at a time. MATCH(p) yields a byte vector
+// with 0xFF for each unit that is '\n' (16-bit compares are packed down to
+// bytes first), so one template serves both unit sizes and both ISAs.
+//
+//   count(p, n)        newlines in p[0, n)
+//   find_nth(p, n, k)  index of the *k-th newline (*k >= 1); on a miss
+//                      returns n and leaves the newlines still owed in *k
+//   find_last(p, n)    index of the last newline, or NL_NONE
+
+#define NL_DEFINE_KERNEL(name, T, ATTR, VEC, STEP, MATCH, MASK, ZERO, SUB, SAD, STORE, LANES) \
+ATTR static size_t name##_count(const void *src, size_t n) {                      \
+    const T *p = (const T *)src;                                                  \
+    size_t i = 0, total = 0;                                                      \
+    while (i + STEP <= n) {                                                       \
+        VEC acc = ZERO;                                                           \
+        for (int r = 0; r < 255 && i + STEP <= n; r++, i += STEP) {               \
+            acc = SUB(acc, MATCH(p + i));                                         \
+        }                                                                         \
+        uint64_t lanes[LANES];                                                    \
+        STORE(lanes, SAD(acc, ZERO));                                             \
+        for (int l = 0; l < LANES; l++) total += (size_t)lanes[l];                \
+    }                                                                             \
+    for (; i < n; i++) total += (p[i] == '\n');                                   \
+    return total;                                                                 \
+}                                                                                 \
+ATTR static size_t name##_find_nth(const void *src, size_t n, size_t *k) {        \
+    const T *p = (const T *)src;                                                  \
+    size_t i = 0, left = *k;                                                      \
+    for (; i + STEP <= n; i += STEP) {                                            \
+        uint32_t m = MASK(MATCH(p + i));                                          \
+        if (!m) continue;                                                         \
+        unsigned c = nl_popcount32(m);                                            \
+        if (c < left) { left -= c; continue; }                                    \
+        while (--left) m &= m - 1;                                                \
+        *k = 0;                                                                   \
+        return i + nl_ctz32(m);                                                   \
+    }                                                                             \
+    for (; i < n; i++) {                                                          \
+        if (p[i] == '\n' && --left == 0) { *k = 0; return i; }                    \
+    }                                                                             \
+    *k = left;                                                                    \
+    return n;                                                                     \
+}                                                                                 \
+ATTR static size_t name##_find_last(const void *src, size_t n) {                  \
+    const T *p = (const T *)src;                                                  \
+    size_t i = n;                                                                 \
+    while (i >= STEP) {                                                           \
+        i -= STEP;                                                                \
+        uint32_t m = MASK(MATCH(p + i));                                          \
+        if (m) return i + nl_msb32(m);                                            \
+    }                                                                             \
+    while (i > 0) {                                                               \
+        if (p[--i] == '\n') return i;                                             \
+    }                                                                             \
+    return NL_NONE;                                                               \
+}
+
+// ===== Scalar =====
+
+#define NL_DEFINE_SCALAR(name, T)                                                 \
+static size_t name##_count(const void *src, size_t n) {                           \
+    const T *p = (const T *)src;                                                  \
+    size_t total = 0;                                                             \
+    for (size_t i = 0; i < n; i++) total += (p[i] == '\n');                       \
+    return total;                                                                 \
+}                                                                                 \
+static size_t name##_find_nth(const void *src, size_t n, size_t *k) {             \
+    const T *p = (const T *)src;                                                  \
+    size_t left = *k;                                                             \
+    for (size_t i = 0; i < n; i++) {                                              \
+        if (p[i] == '\n' && --left == 0) { *k = 0; return i; }                    \
+    }                                                                             \
+    *k = left;                                                                    \
+    return n;                                                                     \
+}                                                                                 \
+static size_t name##_find_last(const void *src, size_t n) {                       \
+    const T *p = (const T *)src;                                                  \
+    for (size_t i = n; i > 0; i--) {                                              \
+        if (p[i - 1] == '\n') return i - 1;                                       \
+    }                                                                             \
+    return NL_NONE;                                                               \
+}
+
+NL_DEFINE_SCALAR(scalar_u8, uint8_t)
+NL_DEFINE_SCALAR(scalar_u16, uint16_t)
+NL_DEFINE_SCALAR(scalar_u32, uint32_t)
+
+// ===== SSE2 / AVX2 =====
+
+#ifdef NL_X86
+
+NL_TARGET("sse2") static inline __m128i sse2_match_u8(const uint8_t *p) {
+    return _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)p), _mm_set1_epi8('\n'));
+}
+
+NL_TARGET("sse2") static inline __m128i sse2_match_u16(const uint16_t *p) {
+    const __m128i nl = _mm_set1_epi16('\n');
+    __m128i a = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i *)p), nl);
+    __m128i b = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i *)(p + 8)), nl);
+    return _mm_packs_epi16(a, b);
+}
+
+NL_TARGET("avx2") static inline __m256i avx2_match_u8(const uint8_t *p) {
+    return _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)p), _mm256_set1_epi8('\n'));
+}
+
+// packs works per 128-bit lane; the permute puts the units back in order
+NL_TARGET("avx2") static inline __m256i avx2_match_u16(const uint16_t *p) {
+    const __m256i nl = _mm256_set1_epi16('\n');
+    __m256i a = _mm256_cmpeq_epi16(_mm256_loadu_si256((const __m256i *)p), nl);
+    __m256i b = _mm256_cmpeq_epi16(_mm256_loadu_si256((const __m256i *)(p + 16)), nl);
+    return _mm256_permute4x64_epi64(_mm256_packs_epi16(a, b), 0xD8);
+}
+
+#define SSE2_MASK(v)        ((uint32_t)_mm_movemask_epi8(v))
+#define SSE2_ZERO           _mm_setzero_si128()
+#define SSE2_STORE(dst, v)  _mm_storeu_si128((__m128i *)(dst), (v))
+#define AVX2_MASK(v)        ((uint32_t)_mm256_movemask_epi8(v))
+#define AVX2_ZERO           _mm256_setzero_si256()
+#define AVX2_STORE(dst, v)  _mm256_storeu_si256((__m256i *)(dst), (v))
+
+NL_DEFINE_KERNEL(sse2_u8,  uint8_t,  NL_TARGET("sse2"), __m128i, 16, sse2_match_u8,
+                 SSE2_MASK, SSE2_ZERO, _mm_sub_epi8, _mm_sad_epu8, SSE2_STORE, 2)
+NL_DEFINE_KERNEL(sse2_u16, uint16_t, NL_TARGET("sse2"), __m128i, 16, sse2_match_u16,
+                 SSE2_MASK, SSE2_ZERO, _mm_sub_epi8, _mm_sad_epu8, SSE2_STORE, 2)
+NL_DEFINE_KERNEL(avx2_u8,  uint8_t,  NL_TARGET("avx2"), __m256i, 32, avx2_match_u8,
+                 AVX2_MASK, AVX2_ZERO, _mm256_sub_epi8, _mm256_sad_epu8, AVX2_STORE, 4)
+NL_DEFINE_KERNEL(avx2_u16, uint16_t, NL_TARGET("avx2"), __m256i, 32, avx2_match_u16,
+                 AVX2_MASK, AVX2_ZERO, _mm256_sub_epi8, _mm256_sad_epu8, AVX2_STORE, 4)
+
+static void nl_cpuid(unsigned leaf, unsigned sub, unsigned r[4]) {
+#ifdef _MSC_VER
+    int v[4];
+    __cpuidex(v, (int)leaf, (int)sub);
+    for (int i = 0; i < 4; i++) r[i] = (unsigned)v[i];
+#else
+    if (!__get_cpuid_count(leaf, sub, &r[0], &r[1], &r[2], &r[3])) {
+        r[0] = r[1] = r[2] = r[3] = 0;
+    }
+#endif
+}
+
+static uint64_t nl_xgetbv(void) {
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    unsigned lo, hi;
+    __asm__ volatile ("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((uint64_t)hi << 32) | lo;
+#endif
+}
+
+static NlIsa nl_detect(void) {
+    unsigned r[4];
+    nl_cpuid(0, 0, r);
+    const unsigned max_leaf = r[0];
+    if (max_leaf < 1) return NL_ISA_SCALAR;
+
+    nl_cpuid(1, 0, r);
+    if (!(r[3] & (1u << 26))) return NL_ISA_SCALAR;          // SSE2
+
+    // AVX2 needs the OS to save YMM state (OSXSAVE + XCR0 bits 1 and 2)
+    const bool osxsave = (r[2] & (1u << 27)) != 0;
+    const bool avx     = (r[2] & (1u << 28)) != 0;
+    if (osxsave && avx && (nl_xgetbv() & 6) == 6 && max_leaf >= 7) {
+        nl_cpuid(7, 0, r);
+        if (r[1] & (1u << 5)) return NL_ISA_AVX2;
+    }
+    return NL_ISA_SSE2;
+}
+
+#else
+
+static NlIsa nl_detect(void) { return NL_ISA_SCALAR; }
+
+#endif // NL_X86
+
+// ===== Dispatch =====
+
+typedef struct {
+    size_t (*count)(const void *p, size_t n);
+    size_t (*find_nth)(const void *p, size_t n, size_t *k);
+    size_t (*find_last)(const void *p, size_t n);
+} NlOps;
+
+#define NL_OPS(name) { name##_count, name##_find_nth, name##_find_last }
+
+static NlOps nl_ops_u8  = NL_OPS(scalar_u8);
+static NlOps nl_ops_u16 = NL_OPS(scalar_u16);
+static const NlOps nl_ops_u32 = NL_OPS(scalar_u32);
+static NlIsa nl_current = NL_ISA_SCALAR;
+static NlIsa nl_best = NL_ISA_SCALAR;
+static volatile bool nl_ready = false;
+
+static void nl_apply(NlIsa isa) {
+#ifdef NL_X86
+    static const NlOps avx2_u8 = NL_OPS(avx2_u8), avx2_u16 = NL_OPS(avx2_u16);
+    static const NlOps sse2_u8 = NL_OPS(sse2_u8), sse2_u16 = NL_OPS(sse2_u16);
+    if (isa == NL_ISA_AVX2) {
+        nl_ops_u8 = avx2_u8;
+        nl_ops_u16 = avx2_u16;
+    } else if (isa == NL_ISA_SSE2) {
+        nl_ops_u8 = sse2_u8;
+        nl_ops_u16 = sse2_u16;
+    } else
+#endif
+    {
+        static const NlOps scalar_u8 = NL_OPS(scalar_u8), scalar_u16 = NL_OPS(scalar_u16);
+        nl_ops_u8 = scalar_u8;
+        nl_ops_u16 = scalar_u16;
+        isa = NL_ISA_SCALAR;
+    }
+    nl_current = isa;
+}
+
+/**
+ * Detection is idempotent, so a race between two first callers is harmless
+ */
+static inline void nl_init(void) {
+    if (nl_ready) return;
+    nl_best = nl_detect();
+    nl_apply(nl_best);
+    nl_ready = true;
+}
+
+static inline const NlOps *nl_ops(int unit) {
+    nl_init();
+    if (unit == 1) return &nl_ops_u8;
+    if (unit == 2) return &nl_ops_u16;
+    return &nl_ops_u32;
+}
+
+NlIsa nl_isa(void)     { nl_init(); return nl_current; }
+NlIsa nl_isa_max(void) { nl_init(); return nl_best; }
+
+void nl_set_isa(NlIsa isa) {
+    nl_init();
+    nl_apply(isa > nl_best ? nl_best : isa);
+}
+
+const char *nl_isa_name(NlIsa isa) {
+    switch (isa) {
+        case NL_ISA_AVX2: return "avx2";
+        case NL_ISA_SSE2: return "sse2";
+        default:          return "scalar";
+    }
+}
+
+// ===== Contiguous Text =====
+
+size_t nl_count(const void *p, size_t n, int unit) {
+    return n ? nl_ops(unit)->count(p, n) : 0;
+}
+
+size_t nl_find_nth(const void *p, size_t n, int unit, size_t *k) {
+    if (n == 0 || *k == 0) return n;
+    return nl_ops(unit)->find_nth(p, n, k);
+}
+
+size_t nl_find_last(const void *p, size_t n, int unit) {
+    return n ? nl_ops(unit)->find_last(p, n) : NL_NONE;
+}
+
+// ===== Gap Buffer Segments =====
+
+static inline const void *nl_at(const void *base, size_t pos, int unit) {
+    return (const char *)base + pos * (size_t)unit;
+}
+
+size_t nl_text_count(const NlText *t, size_t from, size_t to) {
+    const size_t len = t->pre_len + t->post_len;
+    if (to > len) to = len;
+    if (from >= to) return 0;
+
+    size_t total = 0;
+    if (from < t->pre_len) {
+        const size_t end = to < t->pre_len ? to : t->pre_len;
+        total += nl_count(nl_at(t->pre, from, t->unit), end - from, t->unit);
+        from = end;
+    }
+    if (from < to) {
+        total += nl_count(nl_at(t->post, from - t->pre_len, t->unit), to - from, t->unit);
+    }
+    return total;
+}
+
+/**
+ * Position of the nth newline at or after `from`, or NL_NONE if the text
+ * runs out first
+ */
+size_t nl_text_find_nth(const NlText *t, size_t from, size_t nth) {
+    if (nth == 0) return from;
+    size_t k = nth;
+
+    if (from < t->pre_len) {
+        const size_t n = t->pre_len - from;
+        const size_t hit = nl_find_nth(nl_at(t->pre, from, t->unit), n, t->unit, &k);
+        if (k == 0) return from + hit;
+        from = t->pre_len;
+    }
+
+    const size_t len = t->pre_len + t->post_len;
+    if (from < len) {
+        const size_t off = from - t->pre_len;
+        const size_t hit = nl_find_nth(nl_at(t->post, off, t->unit), t->post_len - off, t->unit, &k);
+        if (k == 0) return from + hit;
+    }
+    return NL_NONE;
+}
+
+/**
+ * Position of the last newline strictly before `before`, or NL_NONE
+ */
+size_t nl_text_find_prev(const NlText *t, size_t before) {
+    const size_t len = t->pre_len + t->post_len;
+    if (before > len) before = len;
+
+    if (before > t->pre_len) {
+        const size_t hit = nl_find_last(t->post, before - t->pre_len, t->unit);
+        if (hit != NL_NONE) return t->pre_len + hit;
+        before = t->pre_len;
+    }
+    return nl_find_last(t->pre, before, t->unit);
+}
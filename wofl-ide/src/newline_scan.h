@@ -0,0 +1,47 @@
+// ==================== newline_scan.h ====================
+// Vectorized newline kernels shared by all ports
+//
+// Text is counted in units: 1 for char buffers, sizeof(wchar_t) for the
+// Win32 port (2), or 4 for wide builds elsewhere. The SSE2 and AVX2 paths
+// cover 1- and 2-unit text; 4-unit text always takes the scalar path.
+
+#ifndef WOFL_NEWLINE_SCAN_H
+#define WOFL_NEWLINE_SCAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define NL_NONE ((size_t)-1)
+
+typedef enum {
+    NL_ISA_SCALAR = 0,
+    NL_ISA_SSE2,
+    NL_ISA_AVX2
+} NlIsa;
+
+// Kernel selection; picked by CPUID on first use
+NlIsa       nl_isa(void);
+NlIsa       nl_isa_max(void);
+void        nl_set_isa(NlIsa isa);              // clamped to nl_isa_max()
+const char *nl_isa_name(NlIsa isa);
+
+// Contiguous text
+size_t nl_count(const void *p, size_t n, int unit);
+size_t nl_find_nth(const void *p, size_t n, int unit, size_t *k);   // see newline_scan.c
+size_t nl_find_last(const void *p, size_t n, int unit);
+
+// A gap buffer seen as its two segments: pre[0, pre_len) then post[0, post_len)
+typedef struct {
+    const void *pre;
+    size_t      pre_len;
+    const void *post;
+    size_t      post_len;
+    int         unit;
+} NlText;
+
+size_t nl_text_count(const NlText *t, size_t from, size_t to);
+size_t nl_text_find_nth(const NlText *t, size_t from, size_t nth);   // nth >= 1
+size_t nl_text_find_prev(const NlText *t, size_t before);
+
+#endif // WOFL_NEWLINE_SCAN_H
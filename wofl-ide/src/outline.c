@@ -0,0 +1,729 @@
+// ==================== outline.c ====================
+// Definitions picked out of scanned lines, kept per block (see outline.h)
+
+#include "outline.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define OL_TAB  8               // Python's tab stops
+
+// ===== Scanning =====
+
+OutlineLang ol_lang_of(Language lang) {
+    switch (lang) {
+        case LANG_C:
+        case LANG_CPP: return OL_LANG_C;
+        case LANG_PY:  return OL_LANG_PY;
+        default:       return OL_LANG_NONE;
+    }
+}
+
+// Open brackets and a trailing '\\' for Python, a preprocessor line that
+// goes on for C
+static int32_t ol_carry(const OutlineScan *s) {
+    if (s->lang == OL_LANG_PY) return s->paren * 2 + (s->continued ? 1 : 0);
+    return s->in_macro ? 1 : 0;
+}
+
+void ol_scan_begin(OutlineScan *s, OutlineLang lang, size_t first, int32_t carry) {
+    s->lang = lang;
+    memset(&s->out, 0, sizeof(s->out));
+    s->out.first = first;
+    s->out.defs = s->def_buf;
+    s->out.drops = s->drop_buf;
+    s->depth = s->low = 0;
+    s->dropped = false;
+    s->paren = lang == OL_LANG_PY ? carry / 2 : 0;
+    s->continued = lang == OL_LANG_PY && (carry & 1);
+    s->in_macro = lang == OL_LANG_C && carry;
+    s->nstack = 0;
+    s->lead_open = 0;
+    s->head = 0;
+    s->type_kw = 0;
+    s->assigned = false;
+    s->word_len = 0;
+    s->word_tail = 0;
+}
+
+static inline bool ol_quoted(TokenClass cls) {
+    return cls == TK_STR || cls == TK_CHAR || cls == TK_COMMENT;
+}
+
+// Where code from column x runs to: the start of the next string, char or
+// comment span, or len. *t is a cursor into the sorted spans, left on it.
+static int ol_code_end(const TokenSpan *spans, int n, int *t, int x, int len) {
+    while (*t < n && (!ol_quoted(spans[*t].cls) || (int)(spans[*t].start + spans[*t].len) <= x)) {
+        (*t)++;
+    }
+    if (*t >= n) return len;
+    return (int)spans[*t].start > x ? (int)spans[*t].start : x;
+}
+
+static int ol_word_end(const wchar_t *line, int len, int x) {
+    while (x < len && is_word(line[x])) x++;
+    return x;
+}
+
+static int ol_skip_blanks(const wchar_t *line, int len, int x) {
+    while (x < len && (line[x] == L' ' || line[x] == L'\t')) x++;
+    return x;
+}
+
+static bool ol_word_is(const wchar_t *w, int len, const char *kw) {
+    int i = 0;
+    for (; i < len && kw[i]; i++) {
+        if (w[i] != (wchar_t)(unsigned char)kw[i]) return false;
+    }
+    return i == len && kw[i] == '\0';
+}
+
+// Words that can stand before '(' without naming a function
+static bool ol_not_a_name(const char *w) {
+    static const char *const words[] = {
+        "if", "for", "while", "switch", "return", "sizeof", "catch", "do", "else",
+        "case", "new", "delete", "throw", "alignof", "alignas", "decltype", "typeof",
+        "__attribute__", "__declspec", "defined", "static_assert", "_Static_assert",
+        "operator", "void", "int", "char", "short", "long", "float", "double",
+        "signed", "unsigned", "bool", "auto", "const", "volatile", "static",
+        "extern", "inline", "register", "restrict", "typedef", "goto", "co_await",
+        "co_return", "co_yield", "noexcept", "requires", "and", "or", "not",
+    };
+    for (size_t i = 0; i < sizeof(words) / sizeof(words[0]); i++) {
+        if (strcmp(w, words[i]) == 0) return true;
+    }
+    return false;
+}
+
+static void ol_copy_name(char *out, int *out_len, const wchar_t *w, int len, bool append) {
+    int at = append ? *out_len : 0;
+    for (int i = 0; i < len && at < OL_NAME_MAX - 1; i++) {
+        out[at++] = w[i] < 0x80 ? (char)w[i] : '?';
+    }
+    out[at] = '\0';
+    *out_len = at;
+}
+
+static OutlineDef *ol_new_def(OutlineScan *s, OutlineKind kind, int32_t line,
+                              const char *name, int32_t level) {
+    if (s->out.ndefs >= OL_SCAN_LINES) return NULL;
+    OutlineDef *d = &s->out.defs[s->out.ndefs];
+    d->line = line;
+    d->end = OL_OPEN;
+    d->level = level;
+    d->parent = s->nstack ? s->stack[s->nstack - 1] : -1;
+    d->kind = kind;
+    memcpy(d->name, name, OL_NAME_MAX);
+    d->name[OL_NAME_MAX - 1] = '\0';
+    s->stack[s->nstack++] = s->out.ndefs++;
+    return d;
+}
+
+// Scopes at or above level end at end; the first time the block goes
+// below every level so far, so may scopes opened before it
+static void ol_close(OutlineScan *s, int32_t line, int32_t end, int32_t level) {
+    while (s->nstack && s->out.defs[s->stack[s->nstack - 1]].level >= level) {
+        s->out.defs[s->stack[--s->nstack]].end = end;
+    }
+    if (s->dropped && level >= s->low) return;
+    s->low = level;
+    s->dropped = true;
+    OutlineDrop *last = s->out.ndrops ? &s->out.drops[s->out.ndrops - 1] : NULL;
+    if (last && last->line == line) {
+        last->level = level;
+    } else if (s->out.ndrops < OL_SCAN_LINES) {
+        s->out.drops[s->out.ndrops++] = (OutlineDrop){ line, end, level };
+    }
+}
+
+static void ol_reset_statement(OutlineScan *s) {
+    s->head = 0;
+    s->type_kw = 0;
+    s->assigned = false;
+    s->word_len = 0;
+    s->word_tail = 0;
+}
+
+// A name in C code, with `qualify` set after '::' and `tilde` after '~'
+static void ol_c_word(OutlineScan *s, const wchar_t *w, int len, int32_t row,
+                      bool qualify, bool tilde) {
+    if (s->paren > 0 || s->head == 2 || s->head == 4) return;
+    // A type keyword starts a new head, but "enum class" is one
+    int type_kw = 0;
+    if (len >= 4 && len <= 9 && (w[0] == L's' || w[0] == L'u' || w[0] == L'e' ||
+                                 w[0] == L'c' || w[0] == L'n')) {
+        if (ol_word_is(w, len, "struct") || ol_word_is(w, len, "union") || ol_word_is(w, len, "enum")) {
+            type_kw = OL_STRUCT + 1;
+        } else if (ol_word_is(w, len, "class")) {
+            type_kw = OL_CLASS + 1;
+        } else if (ol_word_is(w, len, "namespace")) {
+            s->type_kw = OL_NAMESPACE + 1;
+            return;
+        }
+    }
+    if (type_kw) {
+        if (!s->type_kw) {
+            s->type_kw = type_kw;
+            s->head = 0;
+        }
+        return;
+    }
+    if (s->type_kw && s->head == 0 && !s->assigned) {
+        // The type's name; a later name and '(' still make it a function
+        s->pending.kind = (OutlineKind)(s->type_kw - 1);
+        s->pending.line = row;
+        ol_copy_name(s->pending.name, &s->word_len, w, len, false);
+        s->type_kw = 0;
+        s->head = 1;
+        s->word_len = 0;
+        return;
+    }
+    if (qualify && s->word_len > 0) {
+        ol_copy_name(s->word, &s->word_len, L"::", 2, true);
+    } else {
+        s->word_len = 0;
+    }
+    s->word_tail = s->word_len;
+    if (tilde) ol_copy_name(s->word, &s->word_len, L"~", 1, true);
+    ol_copy_name(s->word, &s->word_len, w, len, true);
+}
+
+static void ol_c_open(OutlineScan *s, int32_t row) {
+    if (s->paren == 0 && (s->head == 1 || s->head >= 3)) {
+        ol_new_def(s, s->pending.kind, s->pending.line, s->pending.name, s->depth);
+        if (!s->out.has_lead) {
+            s->out.has_lead = true;     // decides nothing: this block has its own head
+            s->out.lead_body = false;
+        }
+    } else if (!s->out.has_lead) {
+        s->out.has_lead = true;
+        s->out.lead_body = true;
+        s->out.lead_line = row;
+        s->out.lead_level = s->depth;
+        s->out.lead_end = OL_OPEN;
+        s->lead_open = 1;
+    }
+    s->depth++;
+    ol_reset_statement(s);
+}
+
+static void ol_c_line(OutlineScan *s, const wchar_t *line, int len,
+                      const TokenSpan *spans, int n) {
+    const int32_t row = (int32_t)s->out.lines;
+
+    // Preprocessor lines, and the lines they continue, are left out
+    const int x0 = ol_skip_blanks(line, len, 0);
+    if (s->in_macro || (x0 < len && line[x0] == L'#')) {
+        s->in_macro = len > 0 && line[len - 1] == L'\\';
+        return;
+    }
+
+    int t = 0;
+    bool qualify = false, tilde = false;
+    for (int x = x0; x < len;) {
+        const int end = ol_code_end(spans, n, &t, x, len);
+        if (end == x) {
+            // Strings and comments in one step
+            x = (int)(spans[t].start + spans[t].len);
+            qualify = tilde = false;
+            continue;
+        }
+        for (; x < end; x++) {
+            const wchar_t c = line[x];
+            if (is_word(c)) {
+                // Nothing inside a function body is kept, so its names are skipped
+                const int e = ol_word_end(line, end, x);
+                const bool in_fn = s->nstack && s->out.defs[s->stack[s->nstack - 1]].kind == OL_FUNCTION;
+                if (!in_fn && !(c >= L'0' && c <= L'9')) ol_c_word(s, line + x, e - x, row, qualify, tilde);
+                qualify = tilde = false;
+                x = e - 1;
+                continue;
+            }
+            switch (c) {
+                case L':':
+                    if (x + 1 < end && line[x + 1] == L':') {
+                        qualify = true;
+                        x++;
+                        continue;
+                    }
+                    if (s->paren == 0 && s->head == 3) s->head = 4;     // initializer list
+                    break;
+                case L'~':
+                    tilde = true;
+                    continue;
+                case L'(':
+                    // A name and '(' after a whole head is a new head: the one
+                    // before was a macro call
+                    if (s->paren == 0 && s->head != 2 && s->head != 4 && s->word_len > 0 &&
+                        !s->assigned && !ol_not_a_name(s->word + s->word_tail)) {
+                        s->pending.kind = OL_FUNCTION;
+                        s->pending.line = row;
+                        memcpy(s->pending.name, s->word, (size_t)s->word_len + 1);
+                        s->head = 2;
+                    }
+                    s->paren++;
+                    break;
+                case L')':
+                    if (s->paren > 0 && --s->paren == 0 && s->head == 2) {
+                        s->head = 3;
+                        s->word_len = 0;
+                    }
+                    break;
+                case L'{':
+                    if (s->paren == 0) ol_c_open(s, row);
+                    else s->depth++;
+                    break;
+                case L'}':
+                    s->depth--;
+                    if (s->lead_open && s->depth <= s->out.lead_level) {
+                        s->out.lead_end = row;
+                        s->lead_open = 0;
+                    }
+                    ol_close(s, row, row, s->depth);
+                    if (s->paren == 0) ol_reset_statement(s);
+                    break;
+                case L';':
+                    if (s->paren > 0) break;
+                    if (!s->out.has_lead) {
+                        s->out.has_lead = true;
+                        s->out.lead_body = false;
+                    }
+                    ol_reset_statement(s);
+                    break;
+                case L'=':
+                    if (s->paren == 0 && s->head != 3) {
+                        if (s->head == 1) s->head = 0;
+                        s->assigned = true;
+                    }
+                    break;
+                case L',':
+                    if (s->paren == 0 && s->head == 1) s->head = 0;
+                    break;
+                default:
+                    break;
+            }
+            qualify = tilde = false;
+        }
+    }
+}
+
+static void ol_py_line(OutlineScan *s, const wchar_t *line, int len,
+                       const TokenSpan *spans, int n, bool in_region) {
+    const int32_t row = (int32_t)s->out.lines;
+    const bool continued = s->continued || in_region || s->paren > 0;
+
+    int indent = 0, x0 = 0;
+    for (; x0 < len && (line[x0] == L' ' || line[x0] == L'\t'); x0++) {
+        indent = line[x0] == L'\t' ? (indent / OL_TAB + 1) * OL_TAB : indent + 1;
+    }
+
+    // Brackets and a trailing '\' carry the statement on; comments are blank
+    int t = 0;
+    bool code = false;
+    wchar_t last = 0;
+    for (int x = x0; x < len;) {
+        const int end = ol_code_end(spans, n, &t, x, len);
+        if (end == x) {
+            if (spans[t].cls != TK_COMMENT) code = true;
+            x = (int)(spans[t].start + spans[t].len);
+            continue;
+        }
+        for (; x < end; x++) {
+            const wchar_t c = line[x];
+            if (c == L' ' || c == L'\t') continue;
+            code = true;
+            last = c;
+            if (c == L'(' || c == L'[' || c == L'{') s->paren++;
+            else if ((c == L')' || c == L']' || c == L'}') && s->paren > 0) s->paren--;
+        }
+    }
+    s->continued = last == L'\\';
+    if (!code || continued) return;
+
+    ol_close(s, row, row - 1, indent);
+
+    // def NAME, class NAME, async def NAME
+    int x = x0, e = ol_word_end(line, len, x);
+    if (ol_word_is(line + x, e - x, "async")) {
+        x = ol_skip_blanks(line, len, e);
+        e = ol_word_end(line, len, x);
+    }
+    const bool is_def = ol_word_is(line + x, e - x, "def");
+    if (!is_def && !ol_word_is(line + x, e - x, "class")) return;
+    x = ol_skip_blanks(line, len, e);
+    e = ol_word_end(line, len, x);
+    if (e == x) return;
+    char name[OL_NAME_MAX];
+    int name_len;
+    ol_copy_name(name, &name_len, line + x, e - x, false);
+    ol_new_def(s, is_def ? OL_FUNCTION : OL_CLASS, row, name, indent);
+}
+
+void ol_scan_line(OutlineScan *s, const wchar_t *line, int len,
+                  const TokenSpan *spans, int n, bool in_region) {
+    if (!line) len = n = 0;
+    if (s->lang == OL_LANG_C) ol_c_line(s, line, len, spans, n);
+    else if (s->lang == OL_LANG_PY) ol_py_line(s, line, len, spans, n, in_region);
+    s->out.lines++;
+}
+
+// ===== Index =====
+
+static void ol_drop_records(OutlineBlock *b) {
+    free(b->defs);
+    b->defs = NULL;
+    b->drops = NULL;
+    b->ndefs = b->ndrops = 0;
+    b->has_tail = b->has_lead = false;
+    b->delta = 0;
+}
+
+void ol_init(OutlineIndex *ol) {
+    memset(ol, 0, sizeof(*ol));
+}
+
+void ol_free(OutlineIndex *ol) {
+    ol_clear(ol);
+    free(ol->blocks);
+    ol->blocks = NULL;
+    ol->cap = 0;
+}
+
+void ol_clear(OutlineIndex *ol) {
+    for (size_t i = 0; i < ol->nblocks; i++) ol_drop_records(&ol->blocks[i]);
+    ol->nblocks = 0;
+    ol->version++;
+}
+
+size_t ol_lines(const OutlineIndex *ol) {
+    if (ol->nblocks == 0) return 0;
+    const OutlineBlock *last = &ol->blocks[ol->nblocks - 1];
+    return last->first + last->lines;
+}
+
+// First block ending after line
+static size_t ol_block_after(const OutlineIndex *ol, size_t line) {
+    size_t lo = 0, hi = ol->nblocks;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (ol->blocks[mid].first + ol->blocks[mid].lines <= line) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static bool ol_reserve(OutlineIndex *ol, size_t count) {
+    if (count <= ol->cap) return true;
+    size_t cap = ol->cap ? ol->cap * 2 : 64;
+    while (cap < count) cap *= 2;
+    OutlineBlock *grown = (OutlineBlock *)realloc(ol->blocks, cap * sizeof(OutlineBlock));
+    if (!grown) return false;
+    ol->blocks = grown;
+    ol->cap = cap;
+    return true;
+}
+
+/**
+ * Blocks the scan overlaps are replaced. Parts of them outside it stay
+ * behind as empty stale blocks; the sweep that made the scan gets to them
+ * next.
+ */
+bool ol_set_block(OutlineIndex *ol, const OutlineScan *s) {
+    const size_t lo = s->out.first, hi = lo + s->out.lines;
+    if (s->out.lines == 0 || !ol_reserve(ol, ol->nblocks + 3)) return false;
+
+    OutlineBlock b = s->out;
+    b.stale = false;
+    b.carry = ol_carry(s);
+    if (s->lang == OL_LANG_C) {
+        b.delta = s->depth;
+        b.has_tail = s->head != 0;
+        b.tail = s->pending;
+    }
+    b.defs = NULL;
+    b.drops = NULL;
+    if (b.ndefs || b.ndrops) {
+        // One allocation: drops follow the definitions
+        const size_t def_bytes = (size_t)b.ndefs * sizeof(OutlineDef);
+        b.defs = (OutlineDef *)malloc(def_bytes + (size_t)b.ndrops * sizeof(OutlineDrop));
+        if (!b.defs) return false;
+        b.drops = (OutlineDrop *)(b.defs + b.ndefs);
+        memcpy(b.defs, s->out.defs, def_bytes);
+        memcpy(b.drops, s->out.drops, (size_t)b.ndrops * sizeof(OutlineDrop));
+    }
+
+    size_t i = ol_block_after(ol, lo), j = i;
+    while (j < ol->nblocks && ol->blocks[j].first < hi) j++;
+    OutlineBlock put[3];
+    int nput = 0;
+    if (lo > ol_lines(ol)) {
+        // Past the end: a stale gap keeps the blocks contiguous
+        memset(&put[0], 0, sizeof(put[0]));
+        put[0].first = ol_lines(ol);
+        put[0].lines = lo - put[0].first;
+        put[nput++].stale = true;
+    }
+    if (i < j && ol->blocks[i].first < lo) {
+        put[nput] = ol->blocks[i];
+        put[nput].lines = lo - put[nput].first;
+        put[nput].stale = true;
+        put[nput].defs = NULL;
+        put[nput].drops = NULL;
+        ol_drop_records(&put[nput++]);
+    }
+    put[nput++] = b;
+    if (i < j && ol->blocks[j - 1].first + ol->blocks[j - 1].lines > hi) {
+        const OutlineBlock *tail = &ol->blocks[j - 1];
+        put[nput] = *tail;
+        put[nput].lines = tail->first + tail->lines - hi;
+        put[nput].first = hi;
+        put[nput].stale = true;
+        put[nput].defs = NULL;
+        put[nput].drops = NULL;
+        ol_drop_records(&put[nput++]);
+    }
+    for (size_t k = i; k < j; k++) ol_drop_records(&ol->blocks[k]);
+
+    memmove(ol->blocks + i + nput, ol->blocks + j, (ol->nblocks - j) * sizeof(OutlineBlock));
+    memcpy(ol->blocks + i, put, (size_t)nput * sizeof(OutlineBlock));
+    ol->nblocks = ol->nblocks - (j - i) + (size_t)nput;
+    ol->lang = s->lang;
+    ol->version++;
+    return true;
+}
+
+int32_t ol_carry_before(const OutlineIndex *ol, size_t line) {
+    if (line == 0) return 0;
+    size_t b = ol_block_after(ol, line - 1);
+    if (b >= ol->nblocks) return 0;
+    const OutlineBlock *bk = &ol->blocks[b];
+    return bk->first + bk->lines == line ? bk->carry : 0;
+}
+
+void ol_truncate(OutlineIndex *ol, size_t line) {
+    size_t b = ol_block_after(ol, line);
+    if (b >= ol->nblocks) return;
+    if (ol->blocks[b].first < line) {
+        OutlineBlock *bk = &ol->blocks[b++];
+        ol_drop_records(bk);
+        bk->lines = line - bk->first;
+        bk->stale = true;
+    }
+    for (size_t k = b; k < ol->nblocks; k++) ol_drop_records(&ol->blocks[k]);
+    ol->nblocks = b;
+    ol->version++;
+}
+
+// An end after line `at` of a block moves with an edit there
+static int32_t ol_moved(int32_t end, int32_t at, long delta) {
+    if (end == OL_OPEN || end <= at) return end;
+    long moved = (long)end + delta;
+    return moved < at ? at : (int32_t)moved;
+}
+
+void ol_note_edit(OutlineIndex *ol, size_t line, long delta) {
+    ol->version++;
+    size_t b = ol_block_after(ol, line);
+    if (b >= ol->nblocks) return;
+    OutlineBlock *bk = &ol->blocks[b];
+    bk->stale = true;
+    if (delta == 0) return;
+
+    // A deletion reaching into later blocks merges them into this one
+    const size_t gone = delta < 0 ? (size_t)-delta : 0;
+    size_t e = b;
+    while (e + 1 < ol->nblocks && ol->blocks[e + 1].first <= line + gone) e++;
+    size_t end = ol->blocks[e].first + ol->blocks[e].lines;
+    bk->carry = ol->blocks[e].carry;
+    for (size_t k = b + 1; k <= e; k++) ol_drop_records(&ol->blocks[k]);
+    memmove(ol->blocks + b + 1, ol->blocks + e + 1, (ol->nblocks - e - 1) * sizeof(OutlineBlock));
+    ol->nblocks -= e - b;
+    bk->lines = (size_t)((long)(end - bk->first) + delta);
+
+    // What it found up to the edited line holds until it is scanned again
+    const int32_t at = (int32_t)(line - bk->first);
+    int keep = 0;
+    while (keep < bk->ndefs && bk->defs[keep].line <= at) {
+        bk->defs[keep].end = ol_moved(bk->defs[keep].end, at, delta);
+        keep++;
+    }
+    bk->ndefs = keep;
+    keep = 0;
+    while (keep < bk->ndrops && bk->drops[keep].line <= at) keep++;
+    bk->ndrops = keep;
+    if (bk->has_tail && bk->tail.line > at) bk->has_tail = false;
+    if (bk->has_lead && bk->lead_body) {
+        if (bk->lead_line > at) bk->has_lead = false;
+        else bk->lead_end = ol_moved(bk->lead_end, at, delta);
+    }
+
+    for (size_t k = b + 1; k < ol->nblocks; k++) {
+        ol->blocks[k].first = (size_t)((long)ol->blocks[k].first + delta);
+    }
+}
+
+// ===== List =====
+
+void ol_list_init(OutlineList *list) {
+    memset(list, 0, sizeof(*list));
+    list->version = UINT64_MAX;
+}
+
+void ol_list_free(OutlineList *list) {
+    free(list->symbols);
+    ol_list_init(list);
+}
+
+static OutlineSymbol *ol_push(OutlineList *list) {
+    if (list->count == list->cap) {
+        int cap = list->cap ? list->cap * 2 : 256;
+        OutlineSymbol *grown = (OutlineSymbol *)realloc(list->symbols, (size_t)cap * sizeof(OutlineSymbol));
+        if (!grown) return NULL;
+        list->symbols = grown;
+        list->cap = cap;
+    }
+    return &list->symbols[list->count++];
+}
+
+// Scopes still open across blocks, innermost last, with absolute levels
+typedef struct {
+    int *sym;
+    int32_t *level;
+    int n, cap;
+} OlStack;
+
+static bool ol_stack_push(OlStack *st, int sym, int32_t level) {
+    if (st->n == st->cap) {
+        int cap = st->cap ? st->cap * 2 : 64;
+        int *sym_grown = (int *)realloc(st->sym, (size_t)cap * sizeof(int));
+        if (sym_grown) st->sym = sym_grown;
+        int32_t *level_grown = (int32_t *)realloc(st->level, (size_t)cap * sizeof(int32_t));
+        if (level_grown) st->level = level_grown;
+        if (!sym_grown || !level_grown) return false;
+        st->cap = cap;
+    }
+    st->sym[st->n] = sym;
+    st->level[st->n++] = level;
+    return true;
+}
+
+static int ol_add(OutlineList *list, OlStack *st, const OutlineDef *d, size_t line,
+                  int parent, int32_t end, size_t first, int32_t level) {
+    OutlineSymbol *sym = ol_push(list);
+    if (!sym) return -1;
+    const int index = (int)(sym - list->symbols);
+    if (parent < 0 && st->n) parent = st->sym[st->n - 1];
+    sym->line = line;
+    sym->end = end == OL_OPEN ? line : first + (size_t)end;
+    sym->parent = parent;
+    sym->depth = parent >= 0 ? list->symbols[parent].depth + 1 : 0;
+    sym->kind = d->kind;
+    memcpy(sym->name, d->name, OL_NAME_MAX);
+    if (end == OL_OPEN) ol_stack_push(st, index, level);
+    return index;
+}
+
+// Definitions inside C functions are macro blocks and local types: take
+// them out. Whatever is kept keeps all its ancestors.
+static void ol_prune(OutlineList *list) {
+    int *map = (int *)malloc((size_t)list->count * sizeof(int));     // new index, or -1
+    if (!map) return;
+    int kept = 0;
+    for (int i = 0; i < list->count; i++) {
+        OutlineSymbol sym = list->symbols[i];
+        const int p = sym.parent;
+        if (p >= 0 && (map[p] < 0 || list->symbols[map[p]].kind == OL_FUNCTION)) {
+            map[i] = -1;
+            continue;
+        }
+        sym.parent = p >= 0 ? map[p] : -1;
+        map[i] = kept;
+        list->symbols[kept++] = sym;
+    }
+    list->count = kept;
+    free(map);
+}
+
+/**
+ * One pass over the blocks in order. Definitions open at a block's end go
+ * on a stack with their absolute level; later blocks' drops close them.
+ */
+bool ol_build(const OutlineIndex *ol, OutlineList *list) {
+    if (list->version == ol->version) return false;
+    list->count = 0;
+    list->version = ol->version;
+    list->lines = ol_lines(ol);
+
+    OlStack st = { 0 };
+    int32_t base = 0;                   // brace depth at the block start
+    bool waiting = false;
+    OutlineDef head = { 0 };
+    size_t head_line = 0;
+    int *local = NULL;
+    int local_cap = 0;
+
+    for (size_t i = 0; i < ol->nblocks; i++) {
+        const OutlineBlock *b = &ol->blocks[i];
+
+        // A head the block before left waiting: its body or a ';'
+        if (waiting && b->has_lead) {
+            if (b->lead_body) {
+                ol_add(list, &st, &head, head_line, -1, b->lead_end, b->first, base + b->lead_level);
+            }
+            waiting = false;
+        }
+
+        if (b->ndefs > local_cap) {
+            int *grown = (int *)realloc(local, (size_t)b->ndefs * sizeof(int));
+            if (!grown) break;
+            local = grown;
+            local_cap = b->ndefs;
+        }
+
+        // Drops and definitions in line order, drops first on a line
+        int d = 0, k = 0;
+        while (d < b->ndefs || k < b->ndrops) {
+            if (k < b->ndrops && (d >= b->ndefs || b->drops[k].line <= b->defs[d].line)) {
+                // A Python drop on a block's first line ends scopes on the line before
+                const OutlineDrop *dr = &b->drops[k++];
+                const long end = (long)b->first + dr->end;
+                while (st.n && st.level[st.n - 1] >= base + dr->level) {
+                    list->symbols[st.sym[--st.n]].end = end > 0 ? (size_t)end : 0;
+                }
+                continue;
+            }
+            const OutlineDef *def = &b->defs[d];
+            int parent = def->parent >= 0 ? local[def->parent] : -1;
+            local[d++] = ol_add(list, &st, def, b->first + (size_t)def->line, parent,
+                                def->end, b->first, base + def->level);
+        }
+
+        base += b->delta;
+        if (b->has_tail) {
+            waiting = true;
+            head = b->tail;
+            head_line = b->first + (size_t)b->tail.line;
+        }
+    }
+
+    // Whatever is still open runs to the end
+    const size_t last = list->lines ? list->lines - 1 : 0;
+    while (st.n) list->symbols[st.sym[--st.n]].end = last;
+    free(st.sym);
+    free(st.level);
+    free(local);
+    if (ol->lang == OL_LANG_C) ol_prune(list);
+    return true;
+}
+
+int ol_enclosing(const OutlineList *list, size_t line) {
+    int lo = 0, hi = list->count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (list->symbols[mid].line <= line) lo = mid + 1;
+        else hi = mid;
+    }
+    for (int i = lo - 1; i >= 0; i = list->symbols[i].parent) {
+        if (list->symbols[i].end >= line) return i;
+    }
+    return -1;
+}
@@ -0,0 +1,181 @@
+// ==================== outline.h ====================
+// Function, class and struct definitions of C, C++ and Python files
+//
+// Definitions are picked out of scanner output a line at a time, so they
+// come for free wherever lines are lexed anyway. Lines are scanned in
+// blocks; each block keeps the definitions found in it, with their ends if
+// they close inside it, and the points where it leaves scopes opened
+// before it: braces closing below its start for C, lines indented less
+// than any before them for Python. Like the lexer state, a small carry
+// (an open preprocessor line, open Python brackets) passes from each block
+// to the next. An edit only has its own blocks scanned again, and putting
+// the outline back together takes one pass over the blocks, not the text.
+//
+// C and C++ definitions are a name followed by a parameter list and a
+// body, or struct/class/union/enum/namespace followed by a name and a
+// body; the body may start on a later line. Definitions inside functions
+// (macro blocks, mostly) are left out. Python definitions are def and
+// class lines; their scope runs up to the next line indented no deeper.
+
+#ifndef WOFL_OUTLINE_H
+#define WOFL_OUTLINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "syntax_defs.h"
+
+#define OL_NAME_MAX     64          // name bytes kept, with the terminator
+#define OL_SCAN_LINES   512         // lines one scan may cover
+#define OL_OPEN         INT32_MIN   // end not found in the block
+
+typedef enum {
+    OL_LANG_NONE = 0,
+    OL_LANG_C,                  // C and C++
+    OL_LANG_PY
+} OutlineLang;
+
+typedef enum {
+    OL_FUNCTION = 0,
+    OL_CLASS,
+    OL_STRUCT,                  // struct, union and enum
+    OL_NAMESPACE
+} OutlineKind;
+
+// A definition within a block. Lines are relative to the block's first.
+typedef struct {
+    int32_t line;               // line of the name
+    int32_t end;                // last line of its scope, or OL_OPEN
+    int32_t level;              // brace depth before its body, or its indent
+    int32_t parent;             // enclosing definition in the block, or -1
+    OutlineKind kind;
+    char name[OL_NAME_MAX];
+} OutlineDef;
+
+// The block leaves every scope opened before it at level >= level here:
+// the scope's last line is end
+typedef struct {
+    int32_t line;
+    int32_t end;
+    int32_t level;
+} OutlineDrop;
+
+// What one block found; also what a scan builds
+typedef struct {
+    size_t first, lines;
+    bool stale;                 // edited since it was scanned
+    int32_t delta;              // brace depth change across the block
+    int32_t carry;              // scanner state the next block starts in
+    OutlineDef *defs;
+    int ndefs;
+    OutlineDrop *drops;         // in the same allocation as defs
+    int ndrops;
+
+    // C only: a name and parameter list still waiting for its body at the
+    // end of the block, and the first body or ';' in the block, which
+    // decides a head left waiting by the block before
+    bool has_tail;
+    OutlineDef tail;
+    bool has_lead;
+    bool lead_body;             // '{' rather than ';'
+    int32_t lead_line, lead_end, lead_level;
+} OutlineBlock;
+
+// ===== Scanning =====
+
+typedef struct {
+    OutlineLang lang;
+    OutlineBlock out;           // defs and drops point into the arrays below
+    int32_t depth;              // braces, from the block start
+    int32_t low;                // lowest depth or indent a drop recorded
+    int32_t paren;              // open parentheses, for heads split over lines
+    bool dropped;               // a drop was recorded (Python: low is set)
+    bool continued;             // Python: the line ended in '\\'
+    bool in_macro;              // C: the line continued a preprocessor line
+    int32_t stack[OL_SCAN_LINES];   // defs still open, innermost last
+    int nstack;
+    int32_t lead_open;          // the lead's body is still open
+
+    // C statement state: the head being read
+    int head;                   // 0 none, 1 type name read, 2 in parameters, 3 after
+                                // them, 4 in a constructor's initializer list
+    OutlineDef pending;
+    int type_kw;                // kind + 1 after struct/class/..., else 0
+    bool assigned;              // '=' seen in the statement
+    char word[OL_NAME_MAX];     // last name read, qualified
+    int word_len;
+    int word_tail;              // where its last part starts
+
+    OutlineDef def_buf[OL_SCAN_LINES];
+    OutlineDrop drop_buf[OL_SCAN_LINES];
+} OutlineScan;
+
+OutlineLang ol_lang_of(Language lang);
+
+// Start a block at line first, from the carry left by the block before
+// (ol_carry_before()); then add its lines in order. in_region is set for
+// lines that start inside a multi-line string or comment.
+void ol_scan_begin(OutlineScan *s, OutlineLang lang, size_t first, int32_t carry);
+void ol_scan_line(OutlineScan *s, const wchar_t *line, int len,
+                  const TokenSpan *spans, int n, bool in_region);
+
+// ===== Index =====
+
+typedef struct {
+    OutlineBlock *blocks;       // in line order, covering what was scanned
+    size_t nblocks, cap;
+    OutlineLang lang;           // of the last scan kept
+    uint64_t version;           // bumped by every change
+} OutlineIndex;
+
+// A definition of the whole file, in line order
+typedef struct {
+    size_t line;
+    size_t end;                 // last line of its scope
+    int parent;                 // index in the list, or -1
+    int depth;                  // definitions around it
+    OutlineKind kind;
+    char name[OL_NAME_MAX];
+} OutlineSymbol;
+
+typedef struct {
+    OutlineSymbol *symbols;
+    int count, cap;
+    uint64_t version;           // index version it was built from
+    size_t lines;               // lines scanned when built
+} OutlineList;
+
+void ol_init(OutlineIndex *ol);
+void ol_free(OutlineIndex *ol);
+void ol_clear(OutlineIndex *ol);
+
+// Keep what a scan found for its lines, replacing what was there
+bool ol_set_block(OutlineIndex *ol, const OutlineScan *s);
+
+/**
+ * `line` was edited and `delta` lines added after it (removed, if
+ * negative). Its block goes stale until it is scanned again; definitions
+ * after the edit in it are dropped, later blocks move with the text.
+ */
+void ol_note_edit(OutlineIndex *ol, size_t line, long delta);
+
+// What a block scanned from line should start from: the carry of the
+// block ending just before it, 0 if there is none
+int32_t ol_carry_before(const OutlineIndex *ol, size_t line);
+
+// Lines from the start that blocks cover
+size_t ol_lines(const OutlineIndex *ol);
+
+// Forget everything from line on
+void ol_truncate(OutlineIndex *ol, size_t line);
+
+// Put the blocks together into list, unless it is already up to date
+bool ol_build(const OutlineIndex *ol, OutlineList *list);
+
+void ol_list_init(OutlineList *list);
+void ol_list_free(OutlineList *list);
+
+// Innermost definition whose scope holds line, or -1
+int  ol_enclosing(const OutlineList *list, size_t line);
+
+#endif // WOFL_OUTLINE_H
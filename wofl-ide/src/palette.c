@@ -0,0 +1,231 @@
+// ==================== palette.c ====================
+// Command palette: source registry, collection and ranking
+
+#include "palette.h"
+#include "file_finder.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Added to the score by kind, enough to break ties and no more
+static const int32_t g_kind_bias[PAL_KINDS] = { 12, 8, 4, 0 };
+
+void pal_init(Palette *p) {
+    memset(p, 0, sizeof(*p));
+    p->collecting = -1;
+}
+
+void pal_free(Palette *p) {
+    free(p->entries);
+    free(p->pool);
+    free(p->matched);
+    pal_init(p);
+}
+
+bool pal_register(Palette *p, PaletteSource *src) {
+    if (!src || !src->collect || p->nsources >= PAL_SOURCES_MAX) return false;
+    p->sources[p->nsources++] = src;
+    return true;
+}
+
+// ===== Entries =====
+
+static uint32_t pool_add(Palette *p, const char *s, size_t len) {
+    if (p->used + len + 1 > p->pool_cap) {
+        uint32_t cap = p->pool_cap ? p->pool_cap : 16384;
+        while (p->used + len + 1 > cap) cap *= 2;
+        char *pool = (char *)realloc(p->pool, cap);
+        if (!pool) return UINT32_MAX;
+        p->pool = pool;
+        p->pool_cap = cap;
+    }
+    const uint32_t at = p->used;
+    memcpy(p->pool + at, s, len);
+    p->pool[at + len] = '\0';
+    p->used += (uint32_t)len + 1;
+    return at;
+}
+
+static bool add_entry(Palette *p, const char *label, size_t base, const char *detail, int32_t id) {
+    if (p->collecting < 0 || !label) return false;
+    size_t len = strlen(label);
+    if (len == 0) return true;
+    if (len >= PAL_LABEL_MAX) len = PAL_LABEL_MAX - 1;
+    if (base >= len) base = 0;
+    if (p->count >= PAL_ENTRIES_MAX) return false;
+    if (p->count == p->cap) {
+        const uint32_t cap = p->cap ? p->cap * 2 : 256;
+        PaletteEntry *e = (PaletteEntry *)realloc(p->entries, cap * sizeof(PaletteEntry));
+        if (!e) return false;
+        p->entries = e;
+        p->cap = cap;
+    }
+
+    const PaletteSource *src = p->sources[p->collecting];
+    PaletteEntry *e = &p->entries[p->count];
+    e->label = pool_add(p, label, len);
+    e->detail = pool_add(p, detail ? detail : "", detail ? strlen(detail) : 0);
+    if (e->label == UINT32_MAX || e->detail == UINT32_MAX) return false;
+    e->mask = ff_char_mask(label, len);
+    e->len = (uint16_t)len;
+    e->base = (uint16_t)base;
+    e->kind = (uint8_t)src->kind;
+    e->source = (uint8_t)p->collecting;
+    e->id = id;
+    p->count++;
+    return true;
+}
+
+bool pal_add(Palette *p, const char *label, const char *detail, int32_t id) {
+    return add_entry(p, label, 0, detail, id);
+}
+
+bool pal_add_path(Palette *p, const char *path, const char *detail, int32_t id) {
+    if (!path) return false;
+    const char *name = path;
+    for (const char *s = path; *s; s++) {
+        if (*s == '/' || *s == '\\') name = s + 1;
+    }
+    return add_entry(p, path, (size_t)(name - path), detail, id);
+}
+
+static void collect(Palette *p, bool per_query, const char *query) {
+    for (int i = 0; i < p->nsources; i++) {
+        PaletteSource *src = p->sources[i];
+        if (src->per_query != per_query) continue;
+        p->collecting = i;
+        src->collect(src, p, query);
+    }
+    p->collecting = -1;
+}
+
+void pal_open(Palette *p) {
+    p->count = 0;
+    p->used = 0;
+    collect(p, false, NULL);
+    p->fixed = p->count;
+    p->fixed_used = p->used;
+    p->matched_valid = false;
+    if (p->matched_cap < p->fixed) {
+        uint32_t *m = (uint32_t *)realloc(p->matched, p->fixed * sizeof(uint32_t));
+        if (m) {
+            p->matched = m;
+            p->matched_cap = p->fixed;
+        }
+    }
+    pal_filter(p, "");
+}
+
+const char *pal_label(const Palette *p, const PaletteEntry *e) {
+    return p->pool + e->label;
+}
+
+const char *pal_detail(const Palette *p, const PaletteEntry *e) {
+    return p->pool + e->detail;
+}
+
+// ===== Ranking =====
+
+// Keep the best PAL_HITS, best first; equal scores keep their order
+static void keep_best(Palette *p, uint32_t entry, int32_t score) {
+    int at = p->nhits;
+    if (at == PAL_HITS) {
+        if (score <= p->hits[PAL_HITS - 1].score) return;
+        at--;
+    } else {
+        p->nhits++;
+    }
+    while (at > 0 && p->hits[at - 1].score < score) {
+        p->hits[at] = p->hits[at - 1];
+        at--;
+    }
+    p->hits[at].entry = entry;
+    p->hits[at].score = score;
+}
+
+static inline int32_t try_entry(const Palette *p, uint32_t i, uint64_t want, const char *q, int qlen) {
+    const PaletteEntry *e = &p->entries[i];
+    if ((e->mask & want) != want || e->len < qlen) return FF_NO_MATCH;
+    const int32_t score = ff_score(p->pool + e->label, e->len, e->base, q, qlen);
+    return score == FF_NO_MATCH ? score : score + g_kind_bias[e->kind];
+}
+
+int pal_filter(Palette *p, const char *query) {
+    char q[PAL_QUERY_MAX];
+    int qlen = 0;
+    for (const char *s = query; *s && qlen < PAL_QUERY_MAX - 1; s++) {
+        if (*s == ' ') continue;
+        const char c = *s == '\\' ? '/' : *s;
+        q[qlen++] = (char)(c >= 'A' && c <= 'Z' ? c + 32 : c);
+    }
+    q[qlen] = '\0';
+    if (query != p->query) snprintf(p->query, sizeof(p->query), "%s", query);
+
+    // Per-query sources answer afresh, after the entries of the opening
+    p->count = p->fixed;
+    p->used = p->fixed_used;
+    collect(p, true, p->query);
+
+    p->nhits = 0;
+    if (qlen == 0) {
+        for (uint32_t i = 0; i < p->count && p->nhits < PAL_HITS; i++) {
+            p->hits[p->nhits].entry = i;
+            p->hits[p->nhits++].score = 0;
+        }
+        return p->nhits;
+    }
+
+    // A query extending the last one only matches what that one matched
+    const uint64_t want = ff_char_mask(q, (size_t)qlen);
+    const bool narrow = p->matched_valid && strncmp(q, p->matched_query, strlen(p->matched_query)) == 0;
+    const bool keep = p->matched_cap >= p->fixed;
+    const uint32_t n = narrow ? p->nmatched : p->fixed;
+    uint32_t kept = 0;
+    for (uint32_t k = 0; k < n; k++) {
+        const uint32_t i = narrow ? p->matched[k] : k;
+        const int32_t score = try_entry(p, i, want, q, qlen);
+        if (score == FF_NO_MATCH) continue;
+        if (keep) p->matched[kept++] = i;
+        keep_best(p, i, score);
+    }
+    if (keep) {
+        memcpy(p->matched_query, q, (size_t)qlen + 1);
+        p->nmatched = kept;
+        p->matched_valid = true;
+    }
+
+    // Per-query entries are few, and new each time
+    for (uint32_t i = p->fixed; i < p->count; i++) {
+        const int32_t score = try_entry(p, i, want, q, qlen);
+        if (score != FF_NO_MATCH) keep_best(p, i, score);
+    }
+    return p->nhits;
+}
+
+bool pal_run(Palette *p, int hit) {
+    if (hit < 0 || hit >= p->nhits) return false;
+    const PaletteEntry e = p->entries[p->hits[hit].entry];
+    PaletteSource *src = p->sources[e.source];
+    if (!src->run) return false;
+
+    // Copied out: running may well open the palette again
+    char label[PAL_LABEL_MAX], detail[PAL_PATH_MAX];
+    snprintf(label, sizeof(label), "%s", pal_label(p, &e));
+    snprintf(detail, sizeof(detail), "%s", pal_detail(p, &e));
+    src->run(src, &e, label, detail);
+    return true;
+}
+
+// ===== Recent Files =====
+
+void pal_recent_push(PaletteRecent *r, const char *path) {
+    if (!path || !*path || strlen(path) >= PAL_PATH_MAX) return;
+    int at = 0;
+    while (at < r->count && strcmp(r->paths[at], path) != 0) at++;
+    if (at == r->count) {
+        if (r->count < PAL_RECENT_MAX) r->count++;
+        at = r->count - 1;
+    }
+    for (; at > 0; at--) memcpy(r->paths[at], r->paths[at - 1], PAL_PATH_MAX);
+    snprintf(r->paths[0], PAL_PATH_MAX, "%s", path);
+}
@@ -0,0 +1,125 @@
+// ==================== palette.h ====================
+// Command palette: commands, open buffers, recent files and symbols in one
+// ranked list
+//
+// Everything the palette offers comes from sources registered with it: the
+// editor's own commands, plugin commands, the open buffer, recent files,
+// workspace symbols. Most sources list all they have once, when the palette
+// opens; a large one (the symbol index) is asked again for every query and
+// adds only its best few. An entry keeps the source that added it, which
+// runs it when it is picked.
+//
+// Entries are scored with the quick open scorer (ff_score()), after a test
+// of their 64-bit character masks, plus a small bias by kind so a command
+// wins a tie with a file. The entries of the opening a query matched are
+// kept: the next query, if it extends this one, only tries those again.
+// Labels and details are UTF-8, in one pool.
+
+#ifndef WOFL_PALETTE_H
+#define WOFL_PALETTE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PAL_QUERY_MAX       128
+#define PAL_LABEL_MAX       256     // longer labels are cut
+#define PAL_HITS            64      // ranked per query
+#define PAL_SOURCES_MAX     16
+#define PAL_ENTRIES_MAX     65536
+#define PAL_RECENT_MAX      16
+#define PAL_PATH_MAX        1024
+
+typedef enum {
+    PAL_COMMAND = 0,
+    PAL_BUFFER,
+    PAL_RECENT,
+    PAL_SYMBOL,
+    PAL_KINDS
+} PaletteKind;
+
+typedef struct {
+    uint32_t label, detail;     // in the pool
+    uint64_t mask;              // characters in label (ff_char_mask())
+    uint16_t len;               // of label
+    uint16_t base;              // where its last path component starts
+    uint8_t  kind;              // PaletteKind
+    uint8_t  source;            // index of the source that added it
+    int32_t  id;                // the source's own
+} PaletteEntry;
+
+typedef struct {
+    uint32_t entry;
+    int32_t  score;
+} PaletteHit;
+
+typedef struct Palette Palette;
+
+typedef struct PaletteSource {
+    const char  *name;
+    PaletteKind  kind;
+    bool         per_query;     // collected for every query, not once per opening
+
+    // Add entries with pal_add(); query is NULL when collected on opening
+    void (*collect)(struct PaletteSource *self, Palette *p, const char *query);
+    // The entry was picked
+    void (*run)(struct PaletteSource *self, const PaletteEntry *e, const char *label, const char *detail);
+    void *ctx;
+} PaletteSource;
+
+struct Palette {
+    PaletteSource *sources[PAL_SOURCES_MAX];
+    int            nsources;
+
+    PaletteEntry  *entries;
+    uint32_t       count, cap;
+    uint32_t       fixed;       // entries collected on opening; per-query ones follow
+    char          *pool;
+    uint32_t       used, pool_cap;
+    uint32_t       fixed_used;
+    int            collecting;  // source adding entries
+
+    char           query[PAL_QUERY_MAX];
+    PaletteHit     hits[PAL_HITS];
+    int            nhits;
+
+    // Entries of the opening matched by the last query, as folded
+    char           matched_query[PAL_QUERY_MAX];
+    uint32_t      *matched;
+    uint32_t       nmatched, matched_cap;
+    bool           matched_valid;
+};
+
+// Files opened, most recent first, for the recent files source
+typedef struct {
+    char paths[PAL_RECENT_MAX][PAL_PATH_MAX];
+    int  count;
+} PaletteRecent;
+
+void pal_init(Palette *p);
+void pal_free(Palette *p);
+
+// The registry: sources stay registered until pal_free()
+bool pal_register(Palette *p, PaletteSource *src);
+
+// From a source's collect(): one entry. For files, label is the path and
+// base where its name starts, so a query matching the name ranks first.
+bool pal_add(Palette *p, const char *label, const char *detail, int32_t id);
+bool pal_add_path(Palette *p, const char *path, const char *detail, int32_t id);
+
+// Collect every source afresh and rank for an empty query
+void pal_open(Palette *p);
+
+// Rank the entries for query; returns how many hits
+int  pal_filter(Palette *p, const char *query);
+
+const char *pal_label(const Palette *p, const PaletteEntry *e);
+const char *pal_detail(const Palette *p, const PaletteEntry *e);
+
+// Run the entry of a hit; false if there is no such hit
+bool pal_run(Palette *p, int hit);
+
+// Move path to the front of the recent files
+void pal_recent_push(PaletteRecent *r, const char *path);
+
+#endif // WOFL_PALETTE_H
@@ -7,6 +7,7 @@
 #include <windows.h>
 #include <shlobj.h>
 #include "plugin_git.h"
+#include "word_complete.h"
 
 static PluginManager g_plugin_manager = {0};
 
@@ -17,7 +18,7 @@ extern void syntax_scan_csv(const wchar_t *line, int len, TokenSpan *out, int *o
 /**
  * Initialize plugin manager
  */
-void plugin_manager_init(PluginManager *pm) {
+void plugin_manager_init(PluginManager *pm, AppState *app) {
     pm->plugins = NULL;
     pm->plugin_count = 0;
 
@@ -30,32 +31,39 @@ void plugin_manager_init(PluginManager *pm) {
     
     // Load built-in plugins
     Plugin *cpp_plugin = plugin_create_cpp();
-    if (cpp_plugin && cpp_plugin->init(cpp_plugin, NULL)) {
+    if (cpp_plugin && cpp_plugin->init(cpp_plugin, app)) {
         cpp_plugin->next = pm->plugins;
         pm->plugins = cpp_plugin;
         pm->plugin_count++;
     }
     
     Plugin *asm_plugin = plugin_create_asm();
-    if (asm_plugin && asm_plugin->init(asm_plugin, NULL)) {
+    if (asm_plugin && asm_plugin->init(asm_plugin, app)) {
         asm_plugin->next = pm->plugins;
         pm->plugins = asm_plugin;
         pm->plugin_count++;
     }
     
     Plugin *csv_plugin = plugin_create_csv();
-    if (csv_plugin && csv_plugin->init(csv_plugin, NULL)) {
+    if (csv_plugin && csv_plugin->init(csv_plugin, app)) {
         csv_plugin->next = pm->plugins;
         pm->plugins = csv_plugin;
         pm->plugin_count++;
     }
     
     Plugin *git_plugin = plugin_create_git();
-    if (git_plugin && git_plugin->init(git_plugin, NULL)) {
+    if (git_plugin && git_plugin->init(git_plugin, app)) {
         git_plugin->next = pm->plugins;
         pm->plugins = git_plugin;
         pm->plugin_count++;
     }
+    
+    Plugin *complete_plugin = plugin_create_complete();
+    if (complete_plugin && complete_plugin->init(complete_plugin, app)) {
+        complete_plugin->next = pm->plugins;
+        pm->plugins = complete_plugin;
+        pm->plugin_count++;
+    }
 }
 
 /**
@@ -89,6 +97,95 @@ Plugin* plugin_manager_find(PluginManager *pm, const wchar_t *name) {
     return NULL;
 }
 
+/**
+ * Tell every plugin a file was opened
+ */
+void plugin_manager_file_open(PluginManager *pm, const wchar_t *path) {
+    for (Plugin *p = pm->plugins; p; p = p->next) {
+        if (p->on_file_open) {
+            p->on_file_open(p, path);
+        }
+    }
+}
+
+/**
+ * Tell every plugin about an edit (see on_text_change)
+ */
+void plugin_manager_text_change(PluginManager *pm, size_t pos, const wchar_t *text, size_t len) {
+    for (Plugin *p = pm->plugins; p; p = p->next) {
+        if (p->on_text_change) {
+            p->on_text_change(p, pos, text, len);
+        }
+    }
+}
+
+/**
+ * Tell every plugin about a batch of edits (see on_text_batch)
+ */
+void plugin_manager_text_batch(PluginManager *pm, const EditOp *ops, size_t n, bool after) {
+    for (Plugin *p = pm->plugins; p; p = p->next) {
+        if (p->on_text_batch) {
+            p->on_text_batch(p, ops, n, after);
+        } else if (p->on_text_change) {
+            // Deletions from the right so each position still holds,
+            // insertions from the left at their final positions
+            for (size_t k = 0; k < n; k++) {
+                const size_t i = after ? k : n - 1 - k;
+                if (after && ops[i].len) p->on_text_change(p, ops[i].at - ops[i].len, (const wchar_t *)ops[i].text, ops[i].len);
+                if (!after && ops[i].del) p->on_text_change(p, ops[i].pos, NULL, ops[i].del);
+            }
+        }
+    }
+}
+
+/**
+ * Completions of the word ending at pos
+ */
+int plugin_manager_complete(PluginManager *pm, size_t pos, wchar_t items[][64], int max, int *prefix_len) {
+    for (Plugin *p = pm->plugins; p; p = p->next) {
+        if ((p->capabilities & PLUGIN_CAP_AUTOCOMPLETE) && p->get_completions) {
+            int n = p->get_completions(p, pos, items, max, prefix_len);
+            if (n > 0) return n;
+        }
+    }
+    return 0;
+}
+
+#define PLUGIN_COMMANDS_MAX 64    // per plugin
+
+static void plugin_commands_collect(PaletteSource *self, Palette *p, const char *query) {
+    PluginManager *pm = (PluginManager*)self->ctx;
+    (void)query;
+    int index = 0;
+    for (Plugin *pl = pm->plugins; pl; pl = pl->next, index++) {
+        if (!(pl->capabilities & PLUGIN_CAP_COMMAND) || !pl->get_commands) continue;
+        wchar_t names[PLUGIN_COMMANDS_MAX][64];
+        char label[PAL_LABEL_MAX], detail[PAL_LABEL_MAX];
+        if (WideCharToMultiByte(CP_UTF8, 0, pl->name, -1, detail, (int)sizeof(detail), NULL, NULL) <= 0) detail[0] = '\0';
+        int n = pl->get_commands(pl, names, PLUGIN_COMMANDS_MAX);
+        for (int i = 0; i < n && i < PLUGIN_COMMANDS_MAX; i++) {
+            if (WideCharToMultiByte(CP_UTF8, 0, names[i], -1, label, (int)sizeof(label), NULL, NULL) <= 0) continue;
+            pal_add(p, label, detail, index * PLUGIN_COMMANDS_MAX + i);
+        }
+    }
+}
+
+static void plugin_commands_run(PaletteSource *self, const PaletteEntry *e, const char *label, const char *detail) {
+    PluginManager *pm = (PluginManager*)self->ctx;
+    (void)label;
+    (void)detail;
+    int index = e->id / PLUGIN_COMMANDS_MAX;
+    Plugin *pl = pm->plugins;
+    while (pl && index-- > 0) pl = pl->next;
+    if (pl && pl->execute_command) pl->execute_command(pl, e->id % PLUGIN_COMMANDS_MAX);
+}
+
+PaletteSource* plugin_manager_commands(PluginManager *pm) {
+    static PaletteSource source = { "plugins", PAL_COMMAND, false, plugin_commands_collect, plugin_commands_run, NULL };
+    source.ctx = pm;
+    return &source;
+}
+
 // ==================== Built-in Plugin Implementations ====================
 
 /**
@@ -249,4 +346,108 @@ Plugin* plugin_create_git(void) {
         plugin->execute_command = git_plugin_execute_command;
     }
     return plugin;
-}
\ No newline at end of file
+}
+/**
+ * Word Completion Plugin Implementation
+ *
+ * Keeps the words of the buffer, and of the files open before it, in
+ * tries (word_complete.h) that each edit updates in place
+ */
+typedef struct {
+    AppState *app;
+    WordComplete words;
+} CompletePluginData;
+
+static unsigned complete_char_at(void *ctx, size_t pos) {
+    return (unsigned)gb_char_at(&((AppState*)ctx)->buf, pos);
+}
+
+static size_t complete_length(void *ctx) {
+    return gb_length(&((AppState*)ctx)->buf);
+}
+
+static WcSource complete_source(CompletePluginData *data) {
+    WcSource src = { complete_char_at, complete_length, data->app };
+    return src;
+}
+
+static bool complete_plugin_init(Plugin *self, AppState *app) {
+    wcscpy_s(self->name, 64, L"Word Completion");
+    wcscpy_s(self->author, 64, L"WOFL");
+    wcscpy_s(self->version, 16, L"1.0");
+    wcscpy_s(self->description, 256, L"Completes words from the open buffer and recently opened files");
+    self->capabilities = PLUGIN_CAP_AUTOCOMPLETE;
+    if (!app) return false;
+    
+    CompletePluginData *data = (CompletePluginData*)HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY,
+                                                              sizeof(CompletePluginData));
+    if (!data) return false;
+    data->app = app;
+    wc_init(&data->words);
+    wc_open(&data->words, complete_source(data),
+            app->file_path[0] ? wc_name_id(app->file_path, wcslen(app->file_path) * sizeof(wchar_t)) : 0);
+    self->data = data;
+    return true;
+}
+
+static void complete_plugin_shutdown(Plugin *self) {
+    CompletePluginData *data = (CompletePluginData*)self->data;
+    if (data) {
+        wc_free(&data->words);
+        HeapFree(GetProcessHeap(), 0, data);
+        self->data = NULL;
+    }
+}
+
+static void complete_plugin_on_file_open(Plugin *self, const wchar_t *path) {
+    CompletePluginData *data = (CompletePluginData*)self->data;
+    if (data) {
+        wc_open(&data->words, complete_source(data), wc_name_id(path, wcslen(path) * sizeof(wchar_t)));
+    }
+}
+
+static void complete_plugin_on_text_change(Plugin *self, size_t pos, const wchar_t *text, size_t len) {
+    CompletePluginData *data = (CompletePluginData*)self->data;
+    if (!data) return;
+    if (text) {
+        wc_note_insert(&data->words, complete_source(data), pos, len);
+    } else {
+        wc_note_delete(&data->words, complete_source(data), pos, len);
+    }
+}
+
+static void complete_plugin_on_text_batch(Plugin *self, const EditOp *ops, size_t n, bool after) {
+    CompletePluginData *data = (CompletePluginData*)self->data;
+    if (data) wc_note_batch(&data->words, complete_source(data), ops, n, after);
+}
+
+static int complete_plugin_get_completions(Plugin *self, size_t pos, wchar_t items[][64], int max, int *prefix_len) {
+    CompletePluginData *data = (CompletePluginData*)self->data;
+    WcCandidate found[WOFL_COMPLETE_MAX];
+    char prefix[WC_WORD_MAX];
+    if (!data) return 0;
+    if (max > WOFL_COMPLETE_MAX) max = WOFL_COMPLETE_MAX;
+    
+    int n = wc_complete(&data->words, complete_source(data), pos, found, max);
+    *prefix_len = wc_prefix_at(complete_source(data), pos, prefix);
+    for (int i = 0; i < n; i++) {
+        // Words are ASCII
+        int k = 0;
+        for (; k < found[i].len && k < 63; k++) items[i][k] = (wchar_t)found[i].word[k];
+        items[i][k] = L'\0';
+    }
+    return n;
+}
+
+Plugin* plugin_create_complete(void) {
+    Plugin *plugin = (Plugin*)HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(Plugin));
+    if (plugin) {
+        plugin->init = complete_plugin_init;
+        plugin->shutdown = complete_plugin_shutdown;
+        plugin->on_file_open = complete_plugin_on_file_open;
+        plugin->on_text_change = complete_plugin_on_text_change;
+        plugin->on_text_batch = complete_plugin_on_text_batch;
+        plugin->get_completions = complete_plugin_get_completions;
+    }
+    return plugin;
+}
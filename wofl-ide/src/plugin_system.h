@@ -34,11 +34,20 @@ typedef struct Plugin {
     bool (*init)(struct Plugin *self, AppState *app);
     void (*shutdown)(struct Plugin *self);
     
-    // Event handlers
+    // Event handlers. on_file_open comes once the file is in the buffer.
+    // on_text_change comes for every edit: an insert of len characters at
+    // pos once they are in the buffer, with text pointing at them; a delete
+    // of len characters at pos just before they go, with text NULL.
+    // on_text_batch, if set, comes instead for a batch of edits
+    // (edit_batch.h), prepared: once before it is applied and once after,
+    // with after set. Without it a batch comes as on_text_change, every
+    // delete first and every insert after, which keeps positions right but
+    // not the text around them.
     void (*on_file_open)(struct Plugin *self, const wchar_t *path);
     void (*on_file_save)(struct Plugin *self, const wchar_t *path);
     void (*on_file_close)(struct Plugin *self);
     void (*on_text_change)(struct Plugin *self, size_t pos, const wchar_t *text, size_t len);
+    void (*on_text_batch)(struct Plugin *self, const EditOp *ops, size_t n, bool after);
     bool (*on_key_press)(struct Plugin *self, UINT key, bool ctrl, bool shift, bool alt);
     
     // Syntax provider
@@ -48,6 +57,10 @@ typedef struct Plugin {
     int (*get_commands)(struct Plugin *self, wchar_t commands[][64], int max);
     void (*execute_command)(struct Plugin *self, int command_id);
     
+    // Completion provider: words completing the one ending at pos, best
+    // first, and how many characters of it are typed already
+    int (*get_completions)(struct Plugin *self, size_t pos, wchar_t items[][64], int max, int *prefix_len);
+    
     // Private data
     void *data;
     
@@ -56,24 +69,37 @@ typedef struct Plugin {
 } Plugin;
 
 // Plugin manager
-typedef struct {
+typedef struct PluginManager {
     Plugin *plugins;
     int plugin_count;
     wchar_t plugin_dir[WOFL_MAX_PATH];
 } PluginManager;
 
 // Plugin management functions
-void plugin_manager_init(PluginManager *pm);
+void plugin_manager_init(PluginManager *pm, AppState *app);
 void plugin_manager_shutdown(PluginManager *pm);
 bool plugin_manager_load(PluginManager *pm, const wchar_t *path);
 void plugin_manager_unload(PluginManager *pm, const wchar_t *name);
 Plugin* plugin_manager_find(PluginManager *pm, const wchar_t *name);
 
+// Events passed on to every plugin handling them
+void plugin_manager_file_open(PluginManager *pm, const wchar_t *path);
+void plugin_manager_text_change(PluginManager *pm, size_t pos, const wchar_t *text, size_t len);
+void plugin_manager_text_batch(PluginManager *pm, const EditOp *ops, size_t n, bool after);
+
+// Completions from the first autocomplete plugin with any
+int  plugin_manager_complete(PluginManager *pm, size_t pos, wchar_t items[][64], int max, int *prefix_len);
+
+// The commands of every command plugin, as a palette source: asked for
+// with get_commands each time the palette opens, run with execute_command
+PaletteSource* plugin_manager_commands(PluginManager *pm);
+
 // Built-in plugins
 Plugin* plugin_create_cpp(void);
 Plugin* plugin_create_asm(void);
 Plugin* plugin_create_csv(void);
 Plugin* plugin_create_git(void);
+Plugin* plugin_create_complete(void);
 
 // Future plugin placeholders for file utils
 Plugin* plugin_create_resonant_search(void);  // For your resonant search
@@ -0,0 +1,922 @@
+// ==================== symbol_index.c ====================
+// Workspace definitions: string tables, scanning, queries, the saved index
+// and the background walk (see symbol_index.h)
+
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+#include "symbol_index.h"
+#include "lang_registry.h"
+#include "lexer.h"
+#include "frame_arena.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+#define SI_FORMAT       1
+#define SI_EXACT        (3 << 20)       // scores: exact names, prefixes, then fuzzy
+#define SI_PREFIX       (2 << 20)
+
+// ===== Strings =====
+
+static uint32_t si_hash(const char *s, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (uint8_t)s[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static void strings_free(SymbolStrings *s) {
+    free(s->pool);
+    free(s->offs);
+    free(s->slots);
+    memset(s, 0, sizeof(*s));
+}
+
+static bool strings_rehash(SymbolStrings *s, uint32_t nslots) {
+    uint32_t *slots = (uint32_t *)calloc(nslots, sizeof(uint32_t));
+    if (!slots) return false;
+    for (uint32_t id = 0; id < s->count; id++) {
+        const char *str = s->pool + s->offs[id];
+        uint32_t i = si_hash(str, strlen(str)) & (nslots - 1);
+        while (slots[i]) i = (i + 1) & (nslots - 1);
+        slots[i] = id + 1;
+    }
+    free(s->slots);
+    s->slots = slots;
+    s->nslots = nslots;
+    return true;
+}
+
+// The slot holding str, or the empty one where it would go
+static uint32_t strings_slot(const SymbolStrings *s, const char *str, size_t len) {
+    const uint32_t mask = s->nslots - 1;
+    uint32_t i = si_hash(str, len) & mask;
+    while (s->slots[i] && strcmp(s->pool + s->offs[s->slots[i] - 1], str) != 0) i = (i + 1) & mask;
+    return i;
+}
+
+static uint32_t strings_find(const SymbolStrings *s, const char *str) {
+    if (!s->nslots) return UINT32_MAX;
+    const uint32_t slot = s->slots[strings_slot(s, str, strlen(str))];
+    return slot ? slot - 1 : UINT32_MAX;
+}
+
+uint32_t si_intern(SymbolStrings *s, const char *str) {
+    const size_t len = strlen(str);
+    if (((size_t)s->count + 1) * 2 > s->nslots &&
+        !strings_rehash(s, s->nslots ? s->nslots * 2 : 1024)) {
+        return UINT32_MAX;
+    }
+    const uint32_t i = strings_slot(s, str, len);
+    if (s->slots[i]) return s->slots[i] - 1;
+
+    if (len + 1 > (size_t)(s->cap - s->used)) {
+        size_t cap = s->cap ? s->cap : 4096;
+        while (cap - s->used < len + 1) cap *= 2;
+        if (cap > UINT32_MAX) return UINT32_MAX;
+        char *grown = (char *)realloc(s->pool, cap);
+        if (!grown) return UINT32_MAX;
+        s->pool = grown;
+        s->cap = (uint32_t)cap;
+    }
+    if (s->count == s->offs_cap) {
+        const uint32_t cap = s->offs_cap ? s->offs_cap * 2 : 256;
+        uint32_t *grown = (uint32_t *)realloc(s->offs, (size_t)cap * sizeof(uint32_t));
+        if (!grown) return UINT32_MAX;
+        s->offs = grown;
+        s->offs_cap = cap;
+    }
+    memcpy(s->pool + s->used, str, len + 1);
+    s->offs[s->count] = s->used;
+    s->used += (uint32_t)len + 1;
+    s->slots[i] = ++s->count;
+    return s->count - 1;
+}
+
+const char *si_string(const SymbolStrings *s, uint32_t id) {
+    return id < s->count ? s->pool + s->offs[id] : "";
+}
+
+static int char_bit(unsigned char c) {
+    if (c >= 'a' && c <= 'z') return c - 'a';
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= '0' && c <= '9') return 26 + (c - '0');
+    if (c == '_') return 36;
+    if (c == ':' || c == '.') return 37;
+    return 63;
+}
+
+uint64_t si_char_mask(const char *str, size_t len) {
+    uint64_t mask = 0;
+    for (size_t i = 0; i < len; i++) mask |= (uint64_t)1 << char_bit((unsigned char)str[i]);
+    return mask;
+}
+
+// ===== Table =====
+
+void si_init(SymbolTable *t) {
+    memset(t, 0, sizeof(*t));
+}
+
+void si_free(SymbolTable *t) {
+    strings_free(&t->names);
+    strings_free(&t->paths);
+    free(t->files);
+    free(t->defs);
+    free(t->sorted);
+    free(t->by_name);
+    memset(t, 0, sizeof(*t));
+}
+
+static bool reserve_defs(SymbolTable *t, size_t n) {
+    if (n <= t->defs_cap) return true;
+    if (n > UINT32_MAX) return false;
+    size_t cap = t->defs_cap ? t->defs_cap : 1024;
+    while (cap < n) cap *= 2;
+    if (cap > UINT32_MAX) cap = UINT32_MAX;
+    SymbolDef *grown = (SymbolDef *)realloc(t->defs, cap * sizeof(SymbolDef));
+    if (!grown) return false;
+    t->defs = grown;
+    t->defs_cap = (uint32_t)cap;
+    return true;
+}
+
+uint32_t si_add_file(SymbolTable *t, const char *path, int64_t mtime, uint64_t size) {
+    if (t->nfiles == t->files_cap) {
+        const uint32_t cap = t->files_cap ? t->files_cap * 2 : 256;
+        SymbolFile *grown = (SymbolFile *)realloc(t->files, (size_t)cap * sizeof(SymbolFile));
+        if (!grown) return UINT32_MAX;
+        t->files = grown;
+        t->files_cap = cap;
+    }
+    const uint32_t id = si_intern(&t->paths, path);
+    if (id == UINT32_MAX) return UINT32_MAX;
+    SymbolFile *f = &t->files[t->nfiles];
+    memset(f, 0, sizeof(*f));
+    f->mtime = mtime;
+    f->size = size;
+    f->path = id;
+    f->first = t->ndefs;
+    t->finished = false;
+    return t->nfiles++;
+}
+
+// Definitions of a file go in right after it, so they stay contiguous
+static bool add_def(SymbolTable *t, uint32_t file, const char *name, uint32_t line,
+                    uint32_t parent, int kind, int depth) {
+    const uint32_t id = si_intern(&t->names, name);
+    if (id == UINT32_MAX || !reserve_defs(t, (size_t)t->ndefs + 1)) return false;
+    SymbolDef *d = &t->defs[t->ndefs++];
+    memset(d, 0, sizeof(*d));
+    d->name = id;
+    d->file = file;
+    d->line = line;
+    d->parent = parent;
+    d->kind = (uint8_t)kind;
+    d->depth = (uint8_t)(depth > 255 ? 255 : depth);
+    t->files[file].count++;
+    return true;
+}
+
+bool si_copy_file(SymbolTable *t, const SymbolTable *from, uint32_t file) {
+    const SymbolFile *src = &from->files[file];
+    const uint32_t to = si_add_file(t, si_string(&from->paths, src->path), src->mtime, src->size);
+    if (to == UINT32_MAX || !reserve_defs(t, (size_t)t->ndefs + src->count)) return false;
+
+    const uint32_t base = t->ndefs;
+    for (uint32_t i = 0; i < src->count; i++) {
+        const SymbolDef *d = &from->defs[src->first + i];
+        const uint32_t parent = d->parent == SI_NO_PARENT ? SI_NO_PARENT : base + (d->parent - src->first);
+        if (!add_def(t, to, si_string(&from->names, d->name), d->line, parent, d->kind, d->depth)) return false;
+    }
+    return true;
+}
+
+// ===== Scanning =====
+
+typedef struct {
+    OutlineScan  scan;
+    OutlineIndex ol;
+    OutlineList  list;
+    FrameArena   fa;
+} ScanScratch;
+
+// Lex one line from state, feed it to the outline scanner and return the
+// state it ends in. The SDL port's highlighter lexes lines the same way.
+static uint16_t scan_line(ScanScratch *s, const Syntax *sx, const char *text, size_t len, uint16_t state) {
+    const uint16_t in_state = state;
+    fa_reset(&s->fa);
+    wchar_t *wide = len <= SI_LINE_MAX ? fa_new(&s->fa, wchar_t, len + 1) : NULL;
+    if (!wide) {
+        ol_scan_line(&s->scan, NULL, 0, NULL, 0, in_state != 0);
+        return state;
+    }
+    for (size_t k = 0; k < len; k++) wide[k] = (wchar_t)(unsigned char)text[k];
+
+    TokenSpan *spans = NULL;
+    int n = 0;
+    if (sx->lexer) {
+        const int cap = (int)len + 2;
+        spans = fa_new(&s->fa, TokenSpan, cap);
+        if (spans) {
+            state = (uint16_t)lex_scan_range(sx->lexer, wide, (int)len, state, 0, (int)len, spans, cap, &n);
+        }
+    } else {
+        n = syntax_scan_window(sx, wide, (int)len, 0, 0, (int)len, &s->fa, &spans);
+    }
+    ol_scan_line(&s->scan, wide, (int)len, spans, n, in_state != 0);
+    return state;
+}
+
+/**
+ * Lines go through the outline scanner a block at a time, as the
+ * highlighter's sweep feeds them, and the blocks are put together once at
+ * the end. Only the last file added can take definitions.
+ */
+bool si_scan_text(SymbolTable *t, uint32_t file, Language lang, const char *text, size_t len) {
+    const OutlineLang olang = ol_lang_of(lang);
+    const Syntax *sx = syntax_get(lang);
+    if (file + 1 != t->nfiles) return false;
+    if (olang == OL_LANG_NONE || !sx) return true;
+
+    ScanScratch *s = (ScanScratch *)malloc(sizeof(ScanScratch));
+    if (!s) return false;
+    ol_init(&s->ol);
+    ol_list_init(&s->list);
+    fa_init(&s->fa);
+
+    bool ok = true;
+    uint16_t state = 0;
+    size_t line = 0;
+    ol_scan_begin(&s->scan, olang, 0, 0);
+    for (size_t pos = 0; ok && pos < len; line++) {
+        const char *nl = (const char *)memchr(text + pos, '\n', len - pos);
+        const size_t end = nl ? (size_t)(nl - text) : len;
+        size_t n = end - pos;
+        if (n && text[end - 1] == '\r') n--;
+        state = scan_line(s, sx, text + pos, n, state);
+        pos = end + 1;
+        if ((line + 1) % OL_SCAN_LINES == 0) {
+            ok = ol_set_block(&s->ol, &s->scan);
+            ol_scan_begin(&s->scan, olang, line + 1, ol_carry_before(&s->ol, line + 1));
+        }
+    }
+    if (ok && line % OL_SCAN_LINES) ok = ol_set_block(&s->ol, &s->scan);
+
+    if (ok) {
+        ol_build(&s->ol, &s->list);
+        const uint32_t base = t->ndefs;
+        for (int i = 0; ok && i < s->list.count; i++) {
+            const OutlineSymbol *sym = &s->list.symbols[i];
+            const uint32_t parent = sym->parent < 0 ? SI_NO_PARENT : base + (uint32_t)sym->parent;
+            ok = add_def(t, file, sym->name, (uint32_t)sym->line, parent, sym->kind, sym->depth);
+        }
+    }
+    ol_free(&s->ol);
+    ol_list_free(&s->list);
+    fa_free(&s->fa);
+    free(s);
+    return ok;
+}
+
+// ===== Queries =====
+
+static inline int fold(int c) {
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+// Case-insensitive order, ties broken by case so the order is total. The
+// folded first bytes decide most comparisons.
+static int compare_names(const void *a, const void *b) {
+    const SymbolName *na = (const SymbolName *)a, *nb = (const SymbolName *)b;
+    if (na->key != nb->key) return na->key < nb->key ? -1 : 1;
+    const unsigned char *x = (const unsigned char *)na->str;
+    const unsigned char *y = (const unsigned char *)nb->str;
+    for (size_t i = na->len < 8 ? na->len : 8;; i++) {
+        const int d = fold(x[i]) - fold(y[i]);
+        if (d) return d;
+        if (!x[i]) break;
+    }
+    return strcmp((const char *)x, (const char *)y);
+}
+
+/**
+ * Group the definitions by name (a counting sort on name ids) and sort the
+ * distinct names; each keeps where its group starts.
+ */
+bool si_finish(SymbolTable *t) {
+    const uint32_t n = t->names.count;
+    free(t->sorted);
+    free(t->by_name);
+    t->sorted = (SymbolName *)malloc((n ? n : 1) * sizeof(SymbolName));
+    t->by_name = (uint32_t *)malloc((t->ndefs ? t->ndefs : 1) * sizeof(uint32_t));
+    t->finished = false;
+    if (!t->sorted || !t->by_name) return false;
+
+    for (uint32_t id = 0; id < n; id++) {
+        SymbolName *nm = &t->sorted[id];
+        nm->str = si_string(&t->names, id);
+        nm->id = id;
+        nm->count = 0;
+    }
+    for (uint32_t d = 0; d < t->ndefs; d++) t->sorted[t->defs[d].name].count++;
+    uint32_t at = 0;
+    for (uint32_t id = 0; id < n; id++) {
+        t->sorted[id].first = at;
+        at += t->sorted[id].count;
+        t->sorted[id].len = 0;          // fill count until the loop below is done
+    }
+    for (uint32_t d = 0; d < t->ndefs; d++) {
+        SymbolName *nm = &t->sorted[t->defs[d].name];
+        t->by_name[nm->first + nm->len++] = d;
+    }
+    for (uint32_t id = 0; id < n; id++) {
+        SymbolName *nm = &t->sorted[id];
+        nm->len = (uint32_t)strlen(nm->str);
+        nm->mask = si_char_mask(nm->str, nm->len);
+        nm->key = 0;
+        for (uint32_t i = 0; i < 8; i++) {
+            nm->key = (nm->key << 8) | (uint64_t)(i < nm->len ? fold((unsigned char)nm->str[i]) : 0);
+        }
+    }
+    qsort(t->sorted, n, sizeof(SymbolName), compare_names);
+    t->finished = true;
+    return true;
+}
+
+// Compare the first qlen characters of name, folded, to query
+static int compare_prefix(const char *name, const char *query, int qlen) {
+    for (int i = 0; i < qlen; i++) {
+        const int d = fold((unsigned char)name[i]) - (unsigned char)query[i];
+        if (d || !name[i]) return d ? d : -1;
+    }
+    return 0;
+}
+
+/**
+ * Greedy subsequence match of the folded query in name. Characters at the
+ * start of a word (after '_', a separator or a lower-to-upper case change)
+ * and runs of consecutive characters score more; shorter names win ties.
+ */
+static int32_t fuzzy_score(const char *name, uint32_t len, const char *query, int qlen) {
+    int32_t score = 0;
+    int q = 0;
+    int64_t prev = -2;
+    for (uint32_t i = 0; i < len && q < qlen; i++) {
+        const unsigned char c = (unsigned char)name[i];
+        if (fold(c) != (unsigned char)query[q]) continue;
+        int32_t s = 1;
+        if ((int64_t)i == prev + 1) s += 4;
+        if (i == 0) {
+            s += 8;
+        } else {
+            const unsigned char p = (unsigned char)name[i - 1];
+            const bool sep = p == '_' || p == ':' || p == '.';
+            const bool hump = p >= 'a' && p <= 'z' && c >= 'A' && c <= 'Z';
+            if (sep || hump) s += 8;
+        }
+        score += s;
+        prev = i;
+        q++;
+    }
+    return q == qlen ? score * 64 - (int32_t)(len > 63 ? 63 : len) : -1;
+}
+
+typedef struct {
+    uint32_t name;              // index in sorted
+    int32_t score;
+} NameHit;
+
+// Keep the best max names, best first; equal scores keep their order
+static void keep_best(NameHit *best, int *count, int max, uint32_t name, int32_t score) {
+    int at = *count;
+    if (at == max) {
+        if (score <= best[max - 1].score) return;
+        at--;
+    } else {
+        (*count)++;
+    }
+    while (at > 0 && best[at - 1].score < score) {
+        best[at] = best[at - 1];
+        at--;
+    }
+    best[at].name = name;
+    best[at].score = score;
+}
+
+int si_query(const SymbolTable *t, const char *query, SymbolMatch *out, int max) {
+    char q[SI_QUERY_MAX];
+    int qlen = 0;
+    for (; query[qlen] && qlen < SI_QUERY_MAX; qlen++) q[qlen] = (char)fold((unsigned char)query[qlen]);
+    const uint32_t n = t->names.count;
+    if (!t->finished || qlen == 0 || max <= 0 || n == 0) return 0;
+
+    NameHit *best = (NameHit *)malloc((size_t)max * sizeof(NameHit));
+    if (!best) return 0;
+    int nbest = 0;
+
+    // Names starting with the query sit together: find where they begin
+    uint32_t lo = 0, hi = n;
+    while (lo < hi) {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        if (compare_prefix(t->sorted[mid].str, q, qlen) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    uint32_t end = lo, defs = 0;
+    for (; end < n && compare_prefix(t->sorted[end].str, q, qlen) == 0; end++) {
+        const SymbolName *nm = &t->sorted[end];
+        const int32_t score = nm->len == (uint32_t)qlen ? SI_EXACT : SI_PREFIX - (int32_t)(nm->len > 1023 ? 1023 : nm->len);
+        keep_best(best, &nbest, max, end, score);
+        defs += nm->count;
+    }
+
+    // Fuzzy matches only rank below them, so they are needed only when the
+    // prefixes leave room
+    if (defs < (uint32_t)max) {
+        const uint64_t mask = si_char_mask(q, (size_t)qlen);
+        for (uint32_t i = 0; i < n; i++) {
+            if (i == lo && end > lo) {
+                i = end - 1;            // already taken as prefixes
+                continue;
+            }
+            const SymbolName *nm = &t->sorted[i];
+            if ((nm->mask & mask) != mask || nm->len < (uint32_t)qlen) continue;
+            const int32_t score = fuzzy_score(nm->str, nm->len, q, qlen);
+            if (score >= 0 && (nbest < max || score > best[nbest - 1].score)) keep_best(best, &nbest, max, i, score);
+        }
+    }
+
+    int count = 0;
+    for (int b = 0; b < nbest && count < max; b++) {
+        const SymbolName *nm = &t->sorted[best[b].name];
+        for (uint32_t k = 0; k < nm->count && count < max; k++) {
+            out[count].def = t->by_name[nm->first + k];
+            out[count].score = best[b].score;
+            count++;
+        }
+    }
+    free(best);
+    return count;
+}
+
+// ===== Saved Index =====
+
+// Native byte order: the file is a cache, rebuilt whenever it does not fit
+typedef struct {
+    char     magic[4];
+    uint32_t format;
+    uint32_t nfiles, ndefs;
+    uint32_t nnames, name_bytes;
+    uint32_t npaths, path_bytes;
+} SymbolHeader;
+
+static FILE *open_file(const char *path, bool write) {
+#ifdef _WIN32
+    wchar_t wide[SI_PATH_MAX];
+    FILE *f = NULL;
+    if (!MultiByteToWideChar(CP_UTF8, 0, path, -1, wide, SI_PATH_MAX)) return NULL;
+    return _wfopen_s(&f, wide, write ? L"wb" : L"rb") == 0 ? f : NULL;
+#else
+    return fopen(path, write ? "wb" : "rb");
+#endif
+}
+
+// The whole file into *buf, grown as needed; false past max bytes
+static bool read_file(const char *path, size_t max, char **buf, size_t *cap, size_t *len) {
+    FILE *f = open_file(path, false);
+    if (!f) return false;
+    size_t n = 0;
+    bool ok = true;
+    for (;;) {
+        if (n == *cap) {
+            const size_t grow = *cap ? *cap * 2 : 65536;
+            char *grown = (char *)realloc(*buf, grow);
+            if (!grown) {
+                ok = false;
+                break;
+            }
+            *buf = grown;
+            *cap = grow;
+        }
+        const size_t got = fread(*buf + n, 1, *cap - n, f);
+        n += got;
+        if (n > max) ok = false;
+        if (!ok || got == 0) break;
+    }
+    if (ferror(f)) ok = false;
+    fclose(f);
+    *len = n;
+    return ok;
+}
+
+bool si_save(const SymbolTable *t, const char *path) {
+    FILE *f = open_file(path, true);
+    if (!f) return false;
+    SymbolHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, "WSYM", 4);
+    h.format = SI_FORMAT;
+    h.nfiles = t->nfiles;
+    h.ndefs = t->ndefs;
+    h.nnames = t->names.count;
+    h.name_bytes = t->names.used;
+    h.npaths = t->paths.count;
+    h.path_bytes = t->paths.used;
+
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1;
+    ok = ok && fwrite(t->names.pool, 1, t->names.used, f) == t->names.used;
+    ok = ok && fwrite(t->paths.pool, 1, t->paths.used, f) == t->paths.used;
+    ok = ok && fwrite(t->files, sizeof(SymbolFile), t->nfiles, f) == t->nfiles;
+    ok = ok && fwrite(t->defs, sizeof(SymbolDef), t->ndefs, f) == t->ndefs;
+    if (fclose(f) != 0) ok = false;
+    return ok;
+}
+
+// Intern count NUL-terminated strings in order; each must be new
+static bool load_strings(SymbolStrings *s, const char *pool, uint32_t bytes, uint32_t count) {
+    if (bytes && pool[bytes - 1] != '\0') return false;
+    uint32_t nslots = 1024;
+    while (nslots / 2 < count + 1 && nslots < (1u << 31)) nslots *= 2;
+    if (!strings_rehash(s, nslots)) return false;
+    uint32_t at = 0;
+    for (uint32_t id = 0; id < count; id++) {
+        if (at >= bytes || si_intern(s, pool + at) != id) return false;
+        at += (uint32_t)strlen(pool + at) + 1;
+    }
+    return at == bytes;
+}
+
+/**
+ * Read a saved index into an empty table. Everything is checked against
+ * the counts in the header, so a short or foreign file is refused rather
+ * than trusted; the caller then indexes from scratch.
+ */
+bool si_load(SymbolTable *t, const char *path) {
+    char *buf = NULL;
+    size_t cap = 0, len = 0;
+    if (!read_file(path, (size_t)UINT32_MAX, &buf, &cap, &len) || len < sizeof(SymbolHeader)) {
+        free(buf);
+        return false;
+    }
+    SymbolHeader h;
+    memcpy(&h, buf, sizeof(h));
+    const uint64_t want = sizeof(h) + (uint64_t)h.name_bytes + h.path_bytes +
+                          (uint64_t)h.nfiles * sizeof(SymbolFile) + (uint64_t)h.ndefs * sizeof(SymbolDef);
+    bool ok = memcmp(h.magic, "WSYM", 4) == 0 && h.format == SI_FORMAT && want == len;
+
+    const char *names = buf + sizeof(h);
+    const char *paths = names + (ok ? h.name_bytes : 0);
+    ok = ok && load_strings(&t->names, names, h.name_bytes, h.nnames);
+    ok = ok && load_strings(&t->paths, paths, h.path_bytes, h.npaths);
+    ok = ok && reserve_defs(t, h.ndefs);
+    if (ok && h.nfiles) {
+        t->files = (SymbolFile *)malloc((size_t)h.nfiles * sizeof(SymbolFile));
+        ok = t->files != NULL;
+    }
+    if (ok) {
+        t->files_cap = t->nfiles = h.nfiles;
+        t->ndefs = h.ndefs;
+        memcpy(t->files, paths + h.path_bytes, (size_t)h.nfiles * sizeof(SymbolFile));
+        memcpy(t->defs, paths + h.path_bytes + (size_t)h.nfiles * sizeof(SymbolFile),
+               (size_t)h.ndefs * sizeof(SymbolDef));
+    }
+    for (uint32_t i = 0; ok && i < t->nfiles; i++) {
+        const SymbolFile *f = &t->files[i];
+        ok = f->path < h.npaths && f->first <= h.ndefs && f->count <= h.ndefs - f->first;
+        for (uint32_t k = 0; ok && k < f->count; k++) {
+            const SymbolDef *d = &t->defs[f->first + k];
+            ok = d->name < h.nnames && d->file == i &&
+                 (d->parent == SI_NO_PARENT || (d->parent >= f->first && d->parent < f->first + k));
+        }
+    }
+    free(buf);
+    if (!ok) {
+        si_free(t);
+        si_init(t);
+    }
+    return ok;
+}
+
+// ===== Workspace Walk =====
+
+typedef struct {
+    SymbolIndexer     *ix;
+    const SymbolTable *old;         // last table, whose unchanged files are copied
+    uint32_t          *old_file;    // old file by path id
+    SymbolTable       *t;
+    char               full[SI_PATH_MAX];
+    size_t             root_len;
+    char              *text;
+    size_t             text_cap;
+    uint32_t           scanned;
+    bool               stop;        // cancelled or out of memory
+} SymbolWalk;
+
+// Count the file towards the progress and check for a cancel
+static bool walk_step(SymbolWalk *w, bool file) {
+    SymbolIndexer *ix = w->ix;
+    wofl_mutex_lock(&ix->lock);
+    if (file) ix->files_seen++;
+    if (ix->cancel) w->stop = true;
+    wofl_mutex_unlock(&ix->lock);
+    return !w->stop;
+}
+
+static bool indexed_name(const char *name) {
+    return ol_lang_of(lang_detect(name, NULL, 0)) != OL_LANG_NONE;
+}
+
+static void visit_file(SymbolWalk *w, int64_t mtime, uint64_t size) {
+    const char *rel = w->full + w->root_len + 1;
+    if (size > SI_FILE_MAX || !indexed_name(rel) || !walk_step(w, true)) return;
+
+    const uint32_t id = w->old_file ? strings_find(&w->old->paths, rel) : UINT32_MAX;
+    if (id != UINT32_MAX && w->old_file[id] != UINT32_MAX) {
+        const SymbolFile *f = &w->old->files[w->old_file[id]];
+        if (f->mtime == mtime && f->size == size) {
+            if (!si_copy_file(w->t, w->old, w->old_file[id])) w->stop = true;
+            return;
+        }
+    }
+
+    // Unreadable files are kept without definitions until they change
+    const uint32_t file = si_add_file(w->t, rel, mtime, size);
+    size_t len = 0;
+    if (file == UINT32_MAX) {
+        w->stop = true;
+    } else if (read_file(w->full, SI_FILE_MAX, &w->text, &w->text_cap, &len) &&
+               !si_scan_text(w->t, file, lang_detect(rel, w->text, len), w->text, len)) {
+        w->stop = true;
+    }
+    w->scanned++;
+    wofl_mutex_lock(&w->ix->lock);
+    w->ix->files_scanned++;
+    wofl_mutex_unlock(&w->ix->lock);
+}
+
+// Hidden entries ('.git', the saved index, ...) are skipped, and so are
+// links, which could lead back up the tree
+#ifdef _WIN32
+static void walk_dir(SymbolWalk *w, size_t len) {
+    wchar_t pattern[SI_PATH_MAX];
+    if (len + 2 >= SI_PATH_MAX || !walk_step(w, false)) return;
+    memcpy(w->full + len, "/*", 3);
+    const int wide = MultiByteToWideChar(CP_UTF8, 0, w->full, -1, pattern, SI_PATH_MAX);
+    w->full[len] = '\0';
+    if (!wide) return;
+
+    WIN32_FIND_DATAW fd;
+    HANDLE find = FindFirstFileW(pattern, &fd);
+    if (find == INVALID_HANDLE_VALUE) return;
+    do {
+        char name[SI_PATH_MAX];
+        if (fd.cFileName[0] == L'.' || (fd.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT)) continue;
+        const int n = WideCharToMultiByte(CP_UTF8, 0, fd.cFileName, -1, name, (int)sizeof(name), NULL, NULL);
+        if (n <= 1 || len + (size_t)n >= SI_PATH_MAX) continue;
+        w->full[len] = '/';
+        memcpy(w->full + len + 1, name, (size_t)n);
+        if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            walk_dir(w, len + (size_t)n);
+        } else {
+            const int64_t mtime = ((int64_t)fd.ftLastWriteTime.dwHighDateTime << 32) | fd.ftLastWriteTime.dwLowDateTime;
+            visit_file(w, mtime, ((uint64_t)fd.nFileSizeHigh << 32) | fd.nFileSizeLow);
+        }
+    } while (!w->stop && FindNextFileW(find, &fd));
+    FindClose(find);
+    w->full[len] = '\0';
+}
+#else
+static void walk_dir(SymbolWalk *w, size_t len) {
+    if (!walk_step(w, false)) return;
+    DIR *dir = opendir(w->full);
+    if (!dir) return;
+    struct dirent *e;
+    while (!w->stop && (e = readdir(dir)) != NULL) {
+        const char *name = e->d_name;
+        const size_t n = strlen(name);
+        if (name[0] == '.' || len + 1 + n >= SI_PATH_MAX) continue;
+#ifdef _DIRENT_HAVE_D_TYPE
+        if (e->d_type == DT_REG && !indexed_name(name)) continue;
+#endif
+        w->full[len] = '/';
+        memcpy(w->full + len + 1, name, n + 1);
+        struct stat st;
+        if (lstat(w->full, &st) != 0) continue;
+        if (S_ISDIR(st.st_mode)) {
+            walk_dir(w, len + 1 + n);
+        } else if (S_ISREG(st.st_mode)) {
+            visit_file(w, (int64_t)st.st_mtime, (uint64_t)st.st_size);
+        }
+    }
+    closedir(dir);
+    w->full[len] = '\0';
+}
+#endif
+
+// A new table for the workspace as it is now, or NULL if nothing changed
+// or the walk was cancelled
+static SymbolTable *walk(SymbolIndexer *ix, const SymbolTable *old) {
+    SymbolWalk w;
+    memset(&w, 0, sizeof(w));
+    w.ix = ix;
+    w.old = old;
+    w.t = (SymbolTable *)malloc(sizeof(SymbolTable));
+    if (!w.t) return NULL;
+    si_init(w.t);
+    if (old && old->paths.count) {
+        w.old_file = (uint32_t *)malloc((size_t)old->paths.count * sizeof(uint32_t));
+        if (w.old_file) {
+            memset(w.old_file, 0xFF, (size_t)old->paths.count * sizeof(uint32_t));
+            for (uint32_t f = 0; f < old->nfiles; f++) w.old_file[old->files[f].path] = f;
+        }
+    }
+    w.root_len = strlen(ix->root);
+    memcpy(w.full, ix->root, w.root_len + 1);
+    walk_dir(&w, w.root_len);
+    free(w.text);
+    free(w.old_file);
+
+    // Nothing new: keep the old table rather than sort the same names again
+    const bool changed = w.scanned > 0 || !old || old->nfiles != w.t->nfiles;
+    if (w.stop || !changed || !si_finish(w.t)) {
+        si_free(w.t);
+        free(w.t);
+        return NULL;
+    }
+    return w.t;
+}
+
+// ===== Background Indexer =====
+
+static void publish(SymbolIndexer *ix, SymbolTable *t) {
+    wofl_mutex_lock(&ix->lock);
+    SymbolTable *old = ix->table;
+    ix->table = t;
+    ix->version++;
+    wofl_mutex_unlock(&ix->lock);
+    if (old) {
+        si_free(old);
+        free(old);
+    }
+}
+
+/**
+ * Answer from the saved index while the first walk runs, then walk again
+ * for every refresh asked for meanwhile. Only this thread replaces the
+ * table, so it reads the published one without the lock.
+ */
+static WOFL_THREAD_FN(six_worker) {
+    SymbolIndexer *ix = (SymbolIndexer *)arg;
+    char saved[SI_PATH_MAX + sizeof(SI_INDEX_NAME) + 1];
+    snprintf(saved, sizeof(saved), "%s/%s", ix->root, SI_INDEX_NAME);
+
+    wofl_mutex_lock(&ix->lock);
+    const bool have = ix->table != NULL;
+    wofl_mutex_unlock(&ix->lock);
+    if (!have) {
+        SymbolTable *t = (SymbolTable *)malloc(sizeof(SymbolTable));
+        if (t) {
+            si_init(t);
+            if (si_load(t, saved) && si_finish(t)) {
+                publish(ix, t);
+            } else {
+                si_free(t);
+                free(t);
+            }
+        }
+    }
+
+    for (;;) {
+        wofl_mutex_lock(&ix->lock);
+        ix->again = false;
+        ix->files_seen = 0;
+        ix->files_scanned = 0;
+        const SymbolTable *old = ix->table;
+        wofl_mutex_unlock(&ix->lock);
+
+        SymbolTable *t = walk(ix, old);
+        if (t) {
+            if (t->nfiles) si_save(t, saved);
+            publish(ix, t);
+        }
+
+        wofl_mutex_lock(&ix->lock);
+        const bool again = ix->again && !ix->cancel;
+        if (!again) ix->running = false;
+        wofl_mutex_unlock(&ix->lock);
+        if (!again) break;
+    }
+    WOFL_THREAD_RETURN;
+}
+
+void six_init(SymbolIndexer *ix) {
+    memset(ix, 0, sizeof(*ix));
+    wofl_mutex_init(&ix->lock);
+}
+
+void six_free(SymbolIndexer *ix) {
+    six_stop(ix);
+    if (ix->table) {
+        si_free(ix->table);
+        free(ix->table);
+    }
+    wofl_mutex_destroy(&ix->lock);
+}
+
+static void six_run(SymbolIndexer *ix) {
+    if (ix->started) {
+        wofl_thread_join(ix->thread);   // already past its loop
+        ix->started = false;
+    }
+    if (wofl_thread_start(&ix->thread, six_worker, ix)) {
+        ix->started = true;
+    } else {
+        six_worker(ix);  // no thread available: index inline
+    }
+}
+
+void six_start(SymbolIndexer *ix, const char *root) {
+    six_stop(ix);
+    size_t len = strlen(root);
+    while (len > 1 && (root[len - 1] == '/' || root[len - 1] == '\\')) len--;
+    if (len == 0 || len >= SI_PATH_MAX) return;
+
+    wofl_mutex_lock(&ix->lock);
+    SymbolTable *old = ix->table;
+    ix->table = NULL;
+    ix->version++;
+    memcpy(ix->root, root, len);
+    ix->root[len] = '\0';
+    ix->cancel = false;
+    ix->running = true;
+    wofl_mutex_unlock(&ix->lock);
+    if (old) {
+        si_free(old);
+        free(old);
+    }
+    six_run(ix);
+}
+
+void six_stop(SymbolIndexer *ix) {
+    wofl_mutex_lock(&ix->lock);
+    ix->cancel = true;
+    wofl_mutex_unlock(&ix->lock);
+
+    if (ix->started) {
+        wofl_thread_join(ix->thread);
+        ix->started = false;
+    }
+
+    wofl_mutex_lock(&ix->lock);
+    ix->running = false;
+    wofl_mutex_unlock(&ix->lock);
+}
+
+void six_refresh(SymbolIndexer *ix) {
+    wofl_mutex_lock(&ix->lock);
+    const bool idle = !ix->running && !ix->cancel && ix->root[0];
+    if (ix->running) ix->again = true;
+    if (idle) ix->running = true;
+    wofl_mutex_unlock(&ix->lock);
+    if (idle) six_run(ix);
+}
+
+int six_query(SymbolIndexer *ix, const char *query, SymbolHit *out, int max) {
+    SymbolMatch *found = max > 0 ? (SymbolMatch *)malloc((size_t)max * sizeof(SymbolMatch)) : NULL;
+    if (!found) return 0;
+
+    wofl_mutex_lock(&ix->lock);
+    const SymbolTable *t = ix->table;
+    const int count = t ? si_query(t, query, found, max) : 0;
+    for (int i = 0; i < count; i++) {
+        const SymbolDef *d = &t->defs[found[i].def];
+        SymbolHit *hit = &out[i];
+        snprintf(hit->name, sizeof(hit->name), "%s", si_string(&t->names, d->name));
+        snprintf(hit->parent, sizeof(hit->parent), "%s",
+                 d->parent == SI_NO_PARENT ? "" : si_string(&t->names, t->defs[d->parent].name));
+        snprintf(hit->path, sizeof(hit->path), "%s", si_string(&t->paths, t->files[d->file].path));
+        hit->line = d->line;
+        hit->kind = (OutlineKind)d->kind;
+    }
+    wofl_mutex_unlock(&ix->lock);
+    free(found);
+    return count;
+}
+
+uint64_t six_status(SymbolIndexer *ix, bool *running, uint32_t *files, uint32_t *symbols) {
+    wofl_mutex_lock(&ix->lock);
+    if (running) *running = ix->running;
+    if (files) *files = ix->running ? ix->files_seen : (ix->table ? ix->table->nfiles : 0);
+    if (symbols) *symbols = ix->table ? ix->table->ndefs : 0;
+    const uint64_t version = ix->version;
+    wofl_mutex_unlock(&ix->lock);
+    return version;
+}
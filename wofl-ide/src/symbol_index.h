@@ -0,0 +1,165 @@
+// ==================== symbol_index.h ====================
+// Definitions across the whole workspace, for go-to-symbol
+//
+// A worker walks the workspace and runs each C, C++ and Python file through
+// its scanner and the outline (outline.h), so a definition is whatever the
+// outline of that file would list. Names and paths are interned into string
+// tables; a definition is 20 bytes of ids and numbers. The index is saved to
+// SI_INDEX_NAME in the workspace root with each file's mtime and size, and
+// the next start reuses the definitions of files that still match, so only
+// changed files are read again.
+//
+// Queries are answered from a copy of the names sorted case-insensitively:
+// names starting with the query are one binary search away and rank first;
+// when they are not enough, every name is tried as a fuzzy match (the query
+// a subsequence of it), after a 64-bit mask of the characters it contains
+// rules most names out without touching their text.
+
+#ifndef WOFL_SYMBOL_INDEX_H
+#define WOFL_SYMBOL_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "wofl_thread.h"
+#include "outline.h"
+
+#define SI_INDEX_NAME   ".wofl-symbols"     // saved index, in the workspace root
+#define SI_PATH_MAX     1024
+#define SI_FILE_MAX     (8u << 20)          // larger files are not indexed
+#define SI_LINE_MAX     (1u << 16)          // longer lines are not scanned
+#define SI_QUERY_MAX    64                  // query bytes looked at
+#define SI_NO_PARENT    UINT32_MAX
+
+// ===== Table =====
+
+// Strings by id, each stored once
+typedef struct {
+    char     *pool;                 // NUL-terminated strings, in id order
+    uint32_t  used, cap;
+    uint32_t *offs;                 // where each id starts in pool
+    uint32_t  count, offs_cap;
+    uint32_t *slots;                // open addressing: id + 1, 0 when empty
+    uint32_t  nslots;
+} SymbolStrings;
+
+typedef struct {
+    uint32_t name;                  // id in names
+    uint32_t file;
+    uint32_t line;
+    uint32_t parent;                // enclosing definition, or SI_NO_PARENT
+    uint8_t  kind;                  // OutlineKind
+    uint8_t  depth;                 // definitions around it
+    uint16_t reserved;
+} SymbolDef;
+
+typedef struct {
+    int64_t  mtime;
+    uint64_t size;
+    uint32_t path;                  // id in paths, relative to the root, '/'-separated
+    uint32_t first, count;          // its definitions
+    uint32_t reserved;
+} SymbolFile;
+
+// A distinct name, for queries
+typedef struct {
+    uint64_t    key;                // first 8 bytes, case folded, for sorting
+    uint64_t    mask;               // characters it contains (si_char_mask())
+    const char *str;                // in the names pool
+    uint32_t    id;
+    uint32_t    first, count;       // its definitions in by_name
+    uint32_t    len;
+} SymbolName;
+
+typedef struct {
+    SymbolStrings names;
+    SymbolStrings paths;
+    SymbolFile   *files;
+    uint32_t      nfiles, files_cap;
+    SymbolDef    *defs;
+    uint32_t      ndefs, defs_cap;
+
+    // Built by si_finish()
+    SymbolName   *sorted;           // names in case-insensitive order
+    uint32_t     *by_name;          // definitions grouped as in sorted
+    bool          finished;
+} SymbolTable;
+
+// A query result: a definition and how well its name matched
+typedef struct {
+    uint32_t def;
+    int32_t  score;
+} SymbolMatch;
+
+void  si_init(SymbolTable *t);
+void  si_free(SymbolTable *t);
+
+uint32_t    si_intern(SymbolStrings *s, const char *str);
+const char *si_string(const SymbolStrings *s, uint32_t id);
+uint64_t    si_char_mask(const char *str, size_t len);
+
+// Add a file and the definitions in its text, as the outline finds them.
+// Returns the file's index, or UINT32_MAX if out of memory.
+uint32_t si_add_file(SymbolTable *t, const char *path, int64_t mtime, uint64_t size);
+bool     si_scan_text(SymbolTable *t, uint32_t file, Language lang, const char *text, size_t len);
+
+// Copy a file and its definitions over from another table
+bool     si_copy_file(SymbolTable *t, const SymbolTable *from, uint32_t file);
+
+// Build the query side; the table is read-only afterwards
+bool  si_finish(SymbolTable *t);
+
+/**
+ * Up to max definitions for query, best first: exact names, then names
+ * starting with it, then fuzzy matches. Case is ignored. Needs si_finish().
+ */
+int   si_query(const SymbolTable *t, const char *query, SymbolMatch *out, int max);
+
+bool  si_save(const SymbolTable *t, const char *path);
+bool  si_load(SymbolTable *t, const char *path);
+
+// ===== Background Indexer =====
+
+// A query result copied out of the index
+typedef struct {
+    char        name[OL_NAME_MAX];
+    char        parent[OL_NAME_MAX];    // enclosing definition, or empty
+    char        path[SI_PATH_MAX];      // relative to the root
+    size_t      line;
+    OutlineKind kind;
+} SymbolHit;
+
+typedef struct {
+    char         root[SI_PATH_MAX];
+    wofl_mutex   lock;
+    wofl_thread  thread;
+    bool         started;               // thread handle needs joining
+
+    // Everything below is guarded by lock
+    bool         running;               // worker walking the workspace
+    bool         cancel;
+    bool         again;                 // walk again when done
+    SymbolTable *table;                 // published, replaced whole
+    uint64_t     version;               // bumped per table published
+    uint32_t     files_seen;            // by the walk under way
+    uint32_t     files_scanned;
+} SymbolIndexer;
+
+void six_init(SymbolIndexer *ix);
+void six_free(SymbolIndexer *ix);
+
+// Index the workspace under root, starting from its saved index
+void six_start(SymbolIndexer *ix, const char *root);
+void six_stop(SymbolIndexer *ix);
+
+// Walk the workspace again for files changed since, e.g. after a save
+void six_refresh(SymbolIndexer *ix);
+
+// Without the lock: best matches for query, copied out; returns how many
+int  six_query(SymbolIndexer *ix, const char *query, SymbolHit *out, int max);
+
+// Without the lock: whether a walk is under way, the files it has seen and
+// the definitions indexed. Returns the table version.
+uint64_t six_status(SymbolIndexer *ix, bool *running, uint32_t *files, uint32_t *symbols);
+
+#endif // WOFL_SYMBOL_INDEX_H
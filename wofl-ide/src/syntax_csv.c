@@ -1,7 +1,7 @@
 // ==================== syntax_csv.c ====================
 // CSV file syntax highlighting
 
-#include "editor.h"
+#include "syntax_defs.h"
 #include <wctype.h>
 
 void syntax_scan_csv(const wchar_t *line, int len, TokenSpan *out, int *out_n) {
@@ -0,0 +1,97 @@
+// ==================== syntax_defs.h ====================
+// Languages, token spans and line scanners, shared by all ports
+//
+// Scanners work on wchar_t text. The Win32 port hands them its buffer
+// directly; the Linux ports widen each visible line first.
+
+#ifndef WOFL_SYNTAX_DEFS_H
+#define WOFL_SYNTAX_DEFS_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <wchar.h>
+#include <wctype.h>
+
+#define WOFL_MAX_TOKENS   256
+
+static inline bool is_word(wchar_t c) {
+    return (c == L'_' || (c >= L'0' && c <= L'9') ||
+            (c >= L'a' && c <= L'z') || (c >= L'A' && c <= L'Z'));
+}
+
+// Portable _wcsnicmp
+static inline int wofl_wcsnicmp(const wchar_t *a, const wchar_t *b, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        wint_t ca = towlower((wint_t)a[i]);
+        wint_t cb = towlower((wint_t)b[i]);
+        if (ca != cb) return ca < cb ? -1 : 1;
+        if (ca == 0) break;
+    }
+    return 0;
+}
+
+typedef enum {
+    LANG_NONE = 0,
+    LANG_C,
+    LANG_CPP,
+    LANG_ASM,
+    LANG_CSV,
+    LANG_PY,
+    LANG_JS,
+    LANG_HTML,
+    LANG_CSS,
+    LANG_JSON,
+    LANG_MD,
+    LANG_GO,
+    LANG_RS,
+    LANG_SH,
+    LANG_LUA,
+    LANG_MAX
+} Language;
+
+typedef enum {
+    TK_TEXT = 0,
+    TK_KW,
+    TK_IDENT,
+    TK_NUM,
+    TK_STR,
+    TK_CHAR,
+    TK_COMMENT,
+    TK_PUNCT,
+    TK_MAX
+} TokenClass;
+
+typedef struct {
+    size_t     start;
+    size_t     len;
+    TokenClass cls;
+} TokenSpan;
+
+// Scanners write at most WOFL_MAX_TOKENS spans
+typedef void (*SyntaxScanFn)(const wchar_t *line, int len, TokenSpan *out, int *out_n);
+
+struct LexTable;
+
+typedef struct {
+    SyntaxScanFn scan_line;
+    const struct LexTable *lexer;   // generated scanners (lexer.h), else NULL
+} Syntax;
+
+// Syntax scanners (syntax_gen.c, generated from lang/*.lang, and syntax_*.c)
+void syntax_scan_plain(const wchar_t *line, int len, TokenSpan *out, int *out_n);
+void syntax_scan_c(const wchar_t *line, int len, TokenSpan *out, int *out_n);
+void syntax_scan_cpp(const wchar_t *line, int len, TokenSpan *out, int *out_n);
+void syntax_scan_asm(const wchar_t *line, int len, TokenSpan *out, int *out_n);
+void syntax_scan_csv(const wchar_t *line, int len, TokenSpan *out, int *out_n);
+void syntax_scan_py(const wchar_t *line, int len, TokenSpan *out, int *out_n);
+void syntax_scan_js(const wchar_t *line, int len, TokenSpan *out, int *out_n);
+void syntax_scan_html(const wchar_t *line, int len, TokenSpan *out, int *out_n);
+void syntax_scan_css(const wchar_t *line, int len, TokenSpan *out, int *out_n);
+void syntax_scan_json(const wchar_t *line, int len, TokenSpan *out, int *out_n);
+void syntax_scan_md(const wchar_t *line, int len, TokenSpan *out, int *out_n);
+void syntax_scan_go(const wchar_t *line, int len, TokenSpan *out, int *out_n);
+void syntax_scan_rs(const wchar_t *line, int len, TokenSpan *out, int *out_n);
+void syntax_scan_sh(const wchar_t *line, int len, TokenSpan *out, int *out_n);
+void syntax_scan_lua(const wchar_t *line, int len, TokenSpan *out, int *out_n);
+
+#endif // WOFL_SYNTAX_DEFS_H
@@ -0,0 +1,1633 @@
+// ==================== syntax_gen.c ====================
+// Generated by tools/lexgen.c from lang/*.lang -- do not edit
+
+#include "syntax_gen.h"
+
+// ===== asm: 18 states, 20 classes =====
+
+static const unsigned char asm_classes[LEX_ALPHABET] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 1, 1, 1, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    1, 0, 3, 0, 0, 0, 0, 4, 0, 0, 0, 0, 0, 0, 5, 0,
+    6, 7, 8, 8, 8, 8, 8, 8, 8, 8, 9, 10, 0, 0, 0, 0,
+    0, 11, 12, 11, 11, 11, 11, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+    13, 13, 13, 13, 13, 13, 13, 13, 14, 13, 13, 0, 15, 0, 0, 16,
+    0, 11, 17, 11, 18, 11, 11, 13, 19, 13, 13, 13, 13, 13, 13, 13,
+    13, 19, 13, 13, 13, 13, 13, 19, 14, 13, 13, 0, 0, 0, 0, 0,
+    0,
+};
+
+static const unsigned short asm_next[18 * 20] = {
+    /*   0 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0,
+    /*   1 */ 0, 2, 2, 3, 4, 5, 6, 7, 7, 0, 8, 9, 9, 9, 9, 0,
+              9, 9, 9, 9,
+    /*   2 */ 0, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0,
+    /*   3 */ 3, 3, 0, 10, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 11,
+              3, 3, 3, 3,
+    /*   4 */ 4, 4, 0, 4, 12, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 13,
+              4, 4, 4, 4,
+    /*   5 */ 0, 0, 0, 0, 0, 5, 5, 5, 5, 14, 0, 5, 5, 5, 5, 0,
+              5, 5, 5, 5,
+    /*   6 */ 0, 0, 0, 0, 0, 0, 7, 7, 7, 0, 0, 0, 15, 0, 16, 0,
+              7, 15, 17, 17,
+    /*   7 */ 0, 0, 0, 0, 0, 0, 7, 7, 7, 0, 0, 0, 0, 0, 0, 0,
+              7, 17, 17, 17,
+    /*   8 */ 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8,
+              8, 8, 8, 8,
+    /*   9 */ 0, 0, 0, 0, 0, 9, 9, 9, 9, 14, 0, 9, 9, 9, 9, 0,
+              9, 9, 9, 9,
+    /*  10 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0,
+    /*  11 */ 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+              3, 3, 3, 3,
+    /*  12 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0,
+    /*  13 */ 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+              4, 4, 4, 4,
+    /*  14 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0,
+    /*  15 */ 0, 0, 0, 0, 0, 0, 15, 15, 0, 0, 0, 0, 0, 0, 0, 0,
+              15, 0, 0, 0,
+    /*  16 */ 0, 0, 0, 0, 0, 0, 16, 16, 16, 0, 0, 16, 16, 0, 0, 0,
+              16, 16, 16, 0,
+    /*  17 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0,
+};
+
+static const unsigned char asm_accept[18] = {
+    0, 0, 2, 6, 7, 1, 4, 4, 5, 3, 6, 6, 7, 7, 3, 4,
+    4, 4,
+};
+
+static const unsigned char asm_loops[18] = {
+    0x00, 0x00, 0x41, 0x12, 0x12, 0x12, 0x00, 0x10, 0x9f, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x10, 0x00,
+};
+
+static const LexRule asm_rules[7] = {
+    { TK_COMMENT, -1 },
+    { TK_TEXT, -1 },
+    { TK_IDENT, -1 },
+    { TK_NUM, -1 },
+    { TK_COMMENT, -1 },
+    { TK_STR, -1 },
+    { TK_STR, -1 },
+};
+
+static const LexKeyword asm_keywords[512] = {
+    [0] = { L"jz", 2, TK_KW, true },
+    [1] = { L"xmm6", 4, TK_KW, true },
+    [2] = { L"ymm3", 4, TK_KW, true },
+    [5] = { L"dl", 2, TK_KW, true },
+    [6] = { L"dx", 2, TK_KW, true },
+    [9] = { L"mulps", 5, TK_KW, true },
+    [19] = { L"endm", 4, TK_COMMENT, true },
+    [20] = { L"popf", 4, TK_KW, true },
+    [21] = { L"xmm12", 5, TK_KW, true },
+    [22] = { L"rflags", 6, TK_KW, true },
+    [23] = { L"undef", 5, TK_COMMENT, true },
+    [24] = { L"r12", 3, TK_KW, true },
+    [36] = { L"movapd", 6, TK_KW, true },
+    [37] = { L"repe", 4, TK_KW, true },
+    [38] = { L"enter", 5, TK_KW, true },
+    [39] = { L"movupd", 6, TK_KW, true },
+    [42] = { L"r8", 2, TK_KW, true },
+    [49] = { L"bswap", 5, TK_KW, true },
+    [50] = { L"dil", 3, TK_KW, true },
+    [51] = { L"xmm15", 5, TK_KW, true },
+    [52] = { L"r8b", 3, TK_KW, true },
+    [53] = { L"r9b", 3, TK_KW, true },
+    [54] = { L"endp", 4, TK_COMMENT, true },
+    [55] = { L"jnz", 3, TK_KW, true },
+    [56] = { L"esi", 3, TK_KW, true },
+    [57] = { L"edi", 3, TK_KW, true },
+    [60] = { L"call", 4, TK_KW, true },
+    [61] = { L"subps", 5, TK_KW, true },
+    [62] = { L"hlt", 3, TK_KW, true },
+    [63] = { L"r15", 3, TK_KW, true },
+    [71] = { L"si", 2, TK_KW, true },
+    [81] = { L"jc", 2, TK_KW, true },
+    [83] = { L"align", 5, TK_COMMENT, true },
+    [87] = { L"jg", 2, TK_KW, true },
+    [88] = { L"cmps", 4, TK_KW, true },
+    [89] = { L"endif", 5, TK_COMMENT, true },
+    [95] = { L"ymm4", 4, TK_KW, true },
+    [97] = { L"ds", 2, TK_KW, true },
+    [99] = { L"mov", 3, TK_KW, true },
+    [102] = { L"movw", 4, TK_KW, true },
+    [103] = { L"jnc", 3, TK_KW, true },
+    [104] = { L"orps", 4, TK_KW, true },
+    [108] = { L"dq", 2, TK_COMMENT, true },
+    [109] = { L"al", 2, TK_KW, true },
+    [110] = { L"movsx", 5, TK_KW, true },
+    [111] = { L"movzx", 5, TK_KW, true },
+    [112] = { L"sti", 3, TK_KW, true },
+    [113] = { L"ax", 2, TK_KW, true },
+    [114] = { L"equ", 3, TK_COMMENT, true },
+    [116] = { L"resq", 4, TK_COMMENT, true },
+    [117] = { L"r9", 2, TK_KW, true },
+    [120] = { L"bits", 4, TK_COMMENT, true },
+    [124] = { L"jmp", 3, TK_KW, true },
+    [125] = { L"xmm4", 4, TK_KW, true },
+    [127] = { L"shld", 4, TK_KW, true },
+    [128] = { L"shrd", 4, TK_KW, true },
+    [129] = { L"dt", 2, TK_COMMENT, true },
+    [131] = { L"xor", 3, TK_KW, true },
+    [134] = { L"gs", 2, TK_KW, true },
+    [136] = { L"include", 7, TK_COMMENT, true },
+    [137] = { L"dd", 2, TK_COMMENT, true },
+    [143] = { L"repne", 5, TK_KW, true },
+    [145] = { L"r10d", 4, TK_KW, true },
+    [146] = { L"r11d", 4, TK_KW, true },
+    [147] = { L"r12d", 4, TK_KW, true },
+    [148] = { L"r13d", 4, TK_KW, true },
+    [149] = { L"r14d", 4, TK_KW, true },
+    [150] = { L"r15d", 4, TK_KW, true },
+    [151] = { L"scas", 4, TK_KW, true },
+    [152] = { L"stos", 4, TK_KW, true },
+    [153] = { L"xmm5", 4, TK_KW, true },
+    [154] = { L"resd", 4, TK_COMMENT, true },
+    [155] = { L"rest", 4, TK_COMMENT, true },
+    [156] = { L"ymm2", 4, TK_KW, true },
+    [157] = { L"incbin", 6, TK_COMMENT, true },
+    [158] = { L"rsi", 3, TK_KW, true },
+    [159] = { L"jns", 3, TK_KW, true },
+    [160] = { L"rdi", 3, TK_KW, true },
+    [161] = { L"fs", 2, TK_KW, true },
+    [163] = { L"movs", 4, TK_KW, true },
+    [164] = { L"dw", 2, TK_COMMENT, true },
+    [168] = { L"js", 2, TK_KW, true },
+    [174] = { L"movq", 4, TK_KW, true },
+    [175] = { L"dec", 3, TK_KW, true },
+    [185] = { L"section", 7, TK_COMMENT, true },
+    [187] = { L"xmm8", 4, TK_KW, true },
+    [188] = { L"r10w", 4, TK_KW, true },
+    [189] = { L"r11w", 4, TK_KW, true },
+    [190] = { L"pushf", 5, TK_KW, true },
+    [191] = { L"cli", 3, TK_KW, true },
+    [192] = { L"r12w", 4, TK_KW, true },
+    [193] = { L"r13w", 4, TK_KW, true },
+    [194] = { L"r14w", 4, TK_KW, true },
+    [195] = { L"jne", 3, TK_KW, true },
+    [196] = { L"inc", 3, TK_KW, true },
+    [197] = { L"jae", 3, TK_KW, true },
+    [198] = { L"jbe", 3, TK_KW, true },
+    [199] = { L"movl", 4, TK_KW, true },
+    [200] = { L"adc", 3, TK_KW, true },
+    [201] = { L"jge", 3, TK_KW, true },
+    [202] = { L"jle", 3, TK_KW, true },
+    [203] = { L"r15w", 4, TK_KW, true },
+    [204] = { L"jl", 2, TK_KW, true },
+    [205] = { L"movaps", 6, TK_KW, true },
+    [206] = { L"movups", 6, TK_KW, true },
+    [207] = { L"bh", 2, TK_KW, true },
+    [208] = { L"eflags", 6, TK_KW, true },
+    [209] = { L"xmm2", 4, TK_KW, true },
+    [210] = { L"ymm5", 4, TK_KW, true },
+    [211] = { L"resw", 4, TK_COMMENT, true },
+    [212] = { L"ends", 4, TK_COMMENT, true },
+    [213] = { L"proc", 4, TK_COMMENT, true },
+    [214] = { L"add", 3, TK_KW, true },
+    [215] = { L"and", 3, TK_KW, true },
+    [216] = { L"xmm14", 5, TK_KW, true },
+    [218] = { L"sub", 3, TK_KW, true },
+    [219] = { L"sbb", 3, TK_KW, true },
+    [220] = { L"int", 3, TK_KW, true },
+    [221] = { L"r14", 3, TK_KW, true },
+    [228] = { L"xmm9", 4, TK_KW, true },
+    [231] = { L"ch", 2, TK_KW, true },
+    [233] = { L"ip", 2, TK_KW, true },
+    [244] = { L"je", 2, TK_KW, true },
+    [248] = { L"use16", 5, TK_COMMENT, true },
+    [253] = { L"idiv", 4, TK_KW, true },
+    [257] = { L"es", 2, TK_KW, true },
+    [259] = { L"jb", 2, TK_KW, true },
+    [262] = { L"r10", 3, TK_KW, true },
+    [264] = { L"movb", 4, TK_KW, true },
+    [266] = { L"xmm10", 5, TK_KW, true },
+    [271] = { L"dh", 2, TK_KW, true },
+    [277] = { L"shl", 3, TK_KW, true },
+    [278] = { L"sal", 3, TK_KW, true },
+    [279] = { L"sil", 3, TK_KW, true },
+    [280] = { L"spl", 3, TK_KW, true },
+    [282] = { L"divps", 5, TK_KW, true },
+    [283] = { L"times", 5, TK_COMMENT, true },
+    [287] = { L"xmm1", 4, TK_KW, true },
+    [289] = { L"mul", 3, TK_KW, true },
+    [291] = { L"popa", 4, TK_KW, true },
+    [301] = { L"shr", 3, TK_KW, true },
+    [302] = { L"sar", 3, TK_KW, true },
+    [314] = { L"iret", 4, TK_KW, true },
+    [316] = { L"pop", 3, TK_KW, true },
+    [317] = { L"ymm1", 4, TK_KW, true },
+    [322] = { L"loop", 4, TK_KW, true },
+    [326] = { L"ss", 2, TK_KW, true },
+    [330] = { L"bp", 2, TK_KW, true },
+    [331] = { L"macro", 5, TK_COMMENT, true },
+    [336] = { L"test", 4, TK_KW, true },
+    [337] = { L"eax", 3, TK_KW, true },
+    [338] = { L"ebx", 3, TK_KW, true },
+    [339] = { L"ecx", 3, TK_KW, true },
+    [340] = { L"edx", 3, TK_KW, true },
+    [343] = { L"push", 4, TK_KW, true },
+    [344] = { L"loope", 5, TK_KW, true },
+    [345] = { L"leave", 5, TK_KW, true },
+    [346] = { L"r8w", 3, TK_KW, true },
+    [347] = { L"r9w", 3, TK_KW, true },
+    [348] = { L"xmm7", 4, TK_KW, true },
+    [349] = { L"lea", 3, TK_KW, true },
+    [350] = { L"cmp", 3, TK_KW, true },
+    [351] = { L"global", 6, TK_COMMENT, true },
+    [352] = { L"di", 2, TK_KW, true },
+    [353] = { L"ifdef", 5, TK_COMMENT, true },
+    [356] = { L"nop", 3, TK_KW, true },
+    [358] = { L"not", 3, TK_KW, true },
+    [359] = { L"ah", 2, TK_KW, true },
+    [360] = { L"sysenter", 8, TK_KW, true },
+    [368] = { L"div", 3, TK_KW, true },
+    [370] = { L"addps", 5, TK_KW, true },
+    [371] = { L"andps", 5, TK_KW, true },
+    [374] = { L"xmm13", 5, TK_KW, true },
+    [375] = { L"r8d", 3, TK_KW, true },
+    [376] = { L"neg", 3, TK_KW, true },
+    [377] = { L"sysexit", 7, TK_KW, true },
+    [378] = { L"r13", 3, TK_KW, true },
+    [379] = { L"r9d", 3, TK_KW, true },
+    [380] = { L"rep", 3, TK_KW, true },
+    [381] = { L"rbp", 3, TK_KW, true },
+    [382] = { L"ret", 3, TK_KW, true },
+    [383] = { L"rsp", 3, TK_KW, true },
+    [384] = { L"rip", 3, TK_KW, true },
+    [385] = { L"ymm7", 4, TK_KW, true },
+    [386] = { L"ymm0", 4, TK_KW, true },
+    [387] = { L"org", 3, TK_COMMENT, true },
+    [388] = { L"use64", 5, TK_COMMENT, true },
+    [389] = { L"segment", 7, TK_COMMENT, true },
+    [390] = { L"define", 6, TK_COMMENT, true },
+    [393] = { L"pusha", 5, TK_KW, true },
+    [394] = { L"cs", 2, TK_KW, true },
+    [402] = { L"loopne", 6, TK_KW, true },
+    [403] = { L"xorps", 5, TK_KW, true },
+    [409] = { L"ifndef", 6, TK_COMMENT, true },
+    [414] = { L"extern", 6, TK_COMMENT, true },
+    [416] = { L"xmm0", 4, TK_KW, true },
+    [417] = { L"lods", 4, TK_KW, true },
+    [421] = { L"sp", 2, TK_KW, true },
+    [424] = { L"cmpxchg", 7, TK_KW, true },
+    [434] = { L"ja", 2, TK_KW, true },
+    [437] = { L"xmm11", 5, TK_KW, true },
+    [441] = { L"r11", 3, TK_KW, true },
+    [446] = { L"use32", 5, TK_COMMENT, true },
+    [447] = { L"imul", 4, TK_KW, true },
+    [451] = { L"ror", 3, TK_KW, true },
+    [452] = { L"rcr", 3, TK_KW, true },
+    [454] = { L"xchg", 4, TK_KW, true },
+    [458] = { L"db", 2, TK_COMMENT, true },
+    [461] = { L"bl", 2, TK_KW, true },
+    [462] = { L"bx", 2, TK_KW, true },
+    [465] = { L"xadd", 4, TK_KW, true },
+    [466] = { L"r10b", 4, TK_KW, true },
+    [467] = { L"r11b", 4, TK_KW, true },
+    [468] = { L"r12b", 4, TK_KW, true },
+    [469] = { L"ebp", 3, TK_KW, true },
+    [470] = { L"esp", 3, TK_KW, true },
+    [471] = { L"r13b", 4, TK_KW, true },
+    [472] = { L"r14b", 4, TK_KW, true },
+    [473] = { L"r15b", 4, TK_KW, true },
+    [474] = { L"eip", 3, TK_KW, true },
+    [475] = { L"flags", 5, TK_KW, true },
+    [476] = { L"xmm3", 4, TK_KW, true },
+    [477] = { L"jno", 3, TK_KW, true },
+    [478] = { L"ymm6", 4, TK_KW, true },
+    [479] = { L"resb", 4, TK_COMMENT, true },
+    [490] = { L"or", 2, TK_KW, true },
+    [491] = { L"jo", 2, TK_KW, true },
+    [493] = { L"cl", 2, TK_KW, true },
+    [494] = { L"cx", 2, TK_KW, true },
+    [504] = { L"rax", 3, TK_KW, true },
+    [505] = { L"rbx", 3, TK_KW, true },
+    [506] = { L"rcx", 3, TK_KW, true },
+    [507] = { L"rol", 3, TK_KW, true },
+    [508] = { L"rcl", 3, TK_KW, true },
+    [509] = { L"syscall", 7, TK_KW, true },
+    [510] = { L"rdx", 3, TK_KW, true },
+    [511] = { L"bpl", 3, TK_KW, true },
+};
+
+const LexTable lex_asm = {
+    "asm", asm_classes, asm_next, asm_accept, asm_loops, asm_rules, NULL,
+    asm_keywords, 511, true,
+    3, 20, 18, TK_PUNCT
+};
+
+void syntax_scan_asm(const wchar_t *line, int len, TokenSpan *out, int *out_n) {
+    lex_scan(&lex_asm, line, len, 0, out, out_n);
+}
+
+// ===== c: 16 states, 12 classes =====
+
+static const unsigned char c_classes[LEX_ALPHABET] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 1, 1, 1, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    1, 0, 3, 4, 0, 0, 0, 5, 0, 0, 6, 0, 0, 0, 7, 8,
+    9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 0, 0, 0, 0, 0, 0,
+    0, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 0, 11, 0, 0, 10,
+    0, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 0, 0, 0, 0, 0,
+    0,
+};
+
+static const unsigned short c_next[16 * 12] = {
+    /*   0 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*   1 */ 0, 2, 2, 3, 4, 5, 0, 0, 6, 7, 8, 0,
+    /*   2 */ 0, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*   3 */ 3, 3, 0, 9, 3, 3, 3, 3, 3, 3, 3, 10,
+    /*   4 */ 0, 4, 4, 0, 0, 0, 0, 0, 0, 11, 11, 0,
+    /*   5 */ 5, 5, 0, 5, 5, 12, 5, 5, 5, 5, 5, 13,
+    /*   6 */ 0, 0, 0, 0, 0, 0, 14, 0, 15, 0, 0, 0,
+    /*   7 */ 0, 0, 0, 0, 0, 0, 0, 7, 0, 7, 7, 0,
+    /*   8 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 8, 8, 0,
+    /*   9 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*  10 */ 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    /*  11 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 11, 11, 0,
+    /*  12 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*  13 */ 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+    /*  14 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*  15 */ 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+};
+
+static const unsigned char c_accept[16] = {
+    0, 0, 1, 6, 4, 7, 0, 3, 2, 6, 6, 4, 7, 7, 8, 5,
+};
+
+static const unsigned char c_loops[16] = {
+    0x00, 0x00, 0x41, 0x12, 0x01, 0x12, 0x00, 0x12, 0x52, 0x00, 0x00, 0x52, 0x00, 0x00, 0x00, 0x9f,
+};
+
+static const LexRule c_rules[8] = {
+    { TK_TEXT, -1 },
+    { TK_IDENT, -1 },
+    { TK_NUM, -1 },
+    { TK_KW, -1 },
+    { TK_COMMENT, -1 },
+    { TK_STR, -1 },
+    { TK_CHAR, -1 },
+    { TK_COMMENT, 0 },
+};
+
+static const LexKeyword c_keywords[128] = {
+    [1] = { L"static", 6, TK_KW, false },
+    [3] = { L"double", 6, TK_KW, false },
+    [4] = { L"case", 4, TK_KW, false },
+    [5] = { L"char", 4, TK_KW, false },
+    [6] = { L"register", 8, TK_KW, false },
+    [7] = { L"false", 5, TK_KW, false },
+    [12] = { L"else", 4, TK_KW, false },
+    [14] = { L"volatile", 8, TK_KW, false },
+    [15] = { L"_Bool", 5, TK_KW, false },
+    [16] = { L"signed", 6, TK_KW, false },
+    [19] = { L"const", 5, TK_KW, false },
+    [20] = { L"enum", 4, TK_KW, false },
+    [21] = { L"goto", 4, TK_KW, false },
+    [22] = { L"switch", 6, TK_KW, false },
+    [23] = { L"typedef", 7, TK_KW, false },
+    [24] = { L"union", 5, TK_KW, false },
+    [25] = { L"struct", 6, TK_KW, false },
+    [26] = { L"auto", 4, TK_KW, false },
+    [27] = { L"void", 4, TK_KW, false },
+    [28] = { L"bool", 4, TK_KW, false },
+    [29] = { L"_Static_assert", 14, TK_KW, false },
+    [30] = { L"extern", 6, TK_KW, false },
+    [31] = { L"NULL", 4, TK_KW, false },
+    [35] = { L"do", 2, TK_KW, false },
+    [39] = { L"continue", 8, TK_KW, false },
+    [40] = { L"if", 2, TK_KW, false },
+    [55] = { L"return", 6, TK_KW, false },
+    [58] = { L"float", 5, TK_KW, false },
+    [59] = { L"restrict", 8, TK_KW, false },
+    [75] = { L"for", 3, TK_KW, false },
+    [78] = { L"_Alignof", 8, TK_KW, false },
+    [85] = { L"sizeof", 6, TK_KW, false },
+    [86] = { L"break", 5, TK_KW, false },
+    [88] = { L"unsigned", 8, TK_KW, false },
+    [92] = { L"int", 3, TK_KW, false },
+    [93] = { L"short", 5, TK_KW, false },
+    [94] = { L"default", 7, TK_KW, false },
+    [95] = { L"long", 4, TK_KW, false },
+    [97] = { L"while", 5, TK_KW, false },
+    [99] = { L"_Alignas", 8, TK_KW, false },
+    [104] = { L"inline", 6, TK_KW, false },
+    [109] = { L"true", 4, TK_KW, false },
+};
+
+static const LexRegion c_regions[1] = {
+    { L"*/", 0, true },
+};
+
+const LexTable lex_c = {
+    "c", c_classes, c_next, c_accept, c_loops, c_rules, c_regions,
+    c_keywords, 127, false,
+    2, 12, 16, TK_PUNCT
+};
+
+void syntax_scan_c(const wchar_t *line, int len, TokenSpan *out, int *out_n) {
+    lex_scan(&lex_c, line, len, 0, out, out_n);
+}
+
+// ===== cpp: 32 states, 27 classes =====
+
+static const unsigned char cpp_classes[LEX_ALPHABET] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 1, 1, 1, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    1, 3, 4, 5, 0, 0, 6, 7, 8, 9, 10, 11, 0, 12, 13, 14,
+    15, 15, 15, 15, 15, 15, 15, 15, 16, 15, 17, 0, 18, 19, 20, 0,
+    0, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 22, 21, 21, 21,
+    21, 21, 23, 21, 21, 22, 21, 21, 21, 21, 21, 0, 24, 0, 0, 21,
+    0, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 25, 21, 21, 21, 21, 21, 0, 26, 0, 0, 0,
+    0,
+};
+
+static const unsigned short cpp_next[32 * 27] = {
+    /*   0 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*   1 */ 0, 2, 2, 3, 4, 5, 6, 7, 0, 0, 3, 8, 9, 0, 10, 11,
+              11, 12, 13, 3, 14, 15, 16, 17, 0, 18, 19,
+    /*   2 */ 0, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*   3 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 20, 0, 0, 0, 0, 0, 0, 0,
+    /*   4 */ 4, 4, 0, 4, 21, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+              4, 4, 4, 4, 4, 4, 4, 4, 22, 4, 4,
+    /*   5 */ 0, 5, 5, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 23,
+              23, 0, 0, 0, 0, 23, 23, 23, 0, 23, 0,
+    /*   6 */ 0, 0, 0, 0, 0, 0, 20, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*   7 */ 7, 7, 0, 7, 7, 7, 7, 24, 7, 7, 7, 7, 7, 7, 7, 7,
+              7, 7, 7, 7, 7, 7, 7, 7, 25, 7, 7,
+    /*   8 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 20, 0, 0, 0, 0,
+              0, 0, 0, 20, 0, 0, 0, 0, 0, 0, 0,
+    /*   9 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 20, 0, 0, 0,
+              0, 0, 0, 20, 20, 0, 0, 0, 0, 0, 0,
+    /*  10 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 26, 0, 0, 0, 27, 0,
+              0, 0, 0, 20, 0, 0, 0, 0, 0, 0, 0,
+    /*  11 */ 0, 0, 0, 0, 0, 0, 0, 11, 0, 0, 0, 0, 0, 11, 0, 11,
+              11, 0, 0, 0, 0, 11, 11, 11, 0, 11, 0,
+    /*  12 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 20, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*  13 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 20, 20, 0, 0, 0, 0, 0, 0, 0,
+    /*  14 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 20, 20, 0, 0, 0, 0, 0, 0,
+    /*  15 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 15,
+              15, 0, 0, 0, 0, 15, 15, 15, 0, 15, 0,
+    /*  16 */ 0, 0, 0, 0, 4, 0, 0, 7, 0, 0, 0, 0, 0, 0, 0, 15,
+              15, 0, 0, 0, 0, 15, 15, 17, 0, 15, 0,
+    /*  17 */ 0, 0, 0, 0, 28, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 15,
+              15, 0, 0, 0, 0, 15, 15, 15, 0, 15, 0,
+    /*  18 */ 0, 0, 0, 0, 4, 0, 0, 7, 0, 0, 0, 0, 0, 0, 0, 15,
+              16, 0, 0, 0, 0, 15, 15, 17, 0, 15, 0,
+    /*  19 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 20,
+    /*  20 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*  21 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*  22 */ 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+              4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    /*  23 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 23,
+              23, 0, 0, 0, 0, 23, 23, 23, 0, 23, 0,
+    /*  24 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*  25 */ 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+              7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    /*  26 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*  27 */ 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27,
+              27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27,
+    /*  28 */ 0, 0, 0, 0, 0, 0, 0, 0, 29, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*  29 */ 29, 29, 0, 29, 29, 29, 29, 29, 29, 30, 29, 29, 29, 29, 29, 29,
+              29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29,
+    /*  30 */ 29, 29, 0, 29, 31, 29, 29, 29, 29, 30, 29, 29, 29, 29, 29, 29,
+              29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29,
+    /*  31 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+static const unsigned char cpp_accept[32] = {
+    0, 0, 1, 0, 6, 4, 0, 8, 0, 0, 0, 3, 0, 0, 0, 2,
+    2, 2, 2, 0, 9, 6, 6, 4, 8, 8, 10, 5, 0, 7, 7, 7,
+};
+
+static const unsigned char cpp_loops[32] = {
+    0x00, 0x00, 0x41, 0x00, 0x12, 0x01, 0x00, 0x12, 0x00, 0x00, 0x00, 0x12, 0x00, 0x00, 0x00, 0x52,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x52, 0x00, 0x00, 0x00, 0x9f, 0x00, 0x16, 0x00, 0x00,
+};
+
+static const LexRule cpp_rules[10] = {
+    { TK_TEXT, -1 },
+    { TK_IDENT, -1 },
+    { TK_NUM, -1 },
+    { TK_KW, -1 },
+    { TK_COMMENT, -1 },
+    { TK_STR, -1 },
+    { TK_STR, -1 },
+    { TK_CHAR, -1 },
+    { TK_PUNCT, -1 },
+    { TK_COMMENT, 0 },
+};
+
+static const LexKeyword cpp_keywords[256] = {
+    [1] = { L"static", 6, TK_KW, false },
+    [3] = { L"not_eq", 6, TK_KW, false },
+    [4] = { L"case", 4, TK_KW, false },
+    [5] = { L"char", 4, TK_KW, false },
+    [6] = { L"protected", 9, TK_KW, false },
+    [7] = { L"string", 6, TK_KW, false },
+    [10] = { L"array", 5, TK_KW, false },
+    [12] = { L"ptrdiff_t", 9, TK_KW, false },
+    [16] = { L"signed", 6, TK_KW, false },
+    [19] = { L"const", 5, TK_KW, false },
+    [20] = { L"enum", 4, TK_KW, false },
+    [21] = { L"goto", 4, TK_KW, false },
+    [22] = { L"co_yield", 8, TK_KW, false },
+    [24] = { L"union", 5, TK_KW, false },
+    [25] = { L"struct", 6, TK_KW, false },
+    [26] = { L"char16_t", 8, TK_KW, false },
+    [27] = { L"char32_t", 8, TK_KW, false },
+    [28] = { L"bool", 4, TK_KW, false },
+    [29] = { L"co_await", 8, TK_KW, false },
+    [30] = { L"virtual", 7, TK_KW, false },
+    [31] = { L"size_t", 6, TK_KW, false },
+    [35] = { L"do", 2, TK_KW, false },
+    [36] = { L"noexcept", 8, TK_KW, false },
+    [37] = { L"byte", 4, TK_KW, false },
+    [39] = { L"if", 2, TK_KW, false },
+    [43] = { L"static_assert", 13, TK_KW, false },
+    [44] = { L"dynamic_cast", 12, TK_KW, false },
+    [47] = { L"try", 3, TK_KW, false },
+    [50] = { L"nullptr", 7, TK_KW, false },
+    [53] = { L"int16_t", 7, TK_KW, false },
+    [54] = { L"typeid", 6, TK_KW, false },
+    [55] = { L"return", 6, TK_KW, false },
+    [56] = { L"int32_t", 7, TK_KW, false },
+    [57] = { L"stack", 5, TK_KW, false },
+    [58] = { L"float", 5, TK_KW, false },
+    [59] = { L"restrict", 8, TK_KW, false },
+    [60] = { L"unique_ptr", 10, TK_KW, false },
+    [61] = { L"shared_ptr", 10, TK_KW, false },
+    [62] = { L"int64_t", 7, TK_KW, false },
+    [64] = { L"list", 4, TK_KW, false },
+    [66] = { L"new", 3, TK_KW, false },
+    [67] = { L"vector", 6, TK_KW, false },
+    [70] = { L"deque", 5, TK_KW, false },
+    [71] = { L"tuple", 5, TK_KW, false },
+    [72] = { L"any", 3, TK_KW, false },
+    [78] = { L"template", 8, TK_KW, false },
+    [79] = { L"const_cast", 10, TK_KW, false },
+    [80] = { L"decltype", 8, TK_KW, false },
+    [81] = { L"typename", 8, TK_KW, false },
+    [84] = { L"nullptr_t", 9, TK_KW, false },
+    [85] = { L"int8_t", 6, TK_KW, false },
+    [91] = { L"xor_eq", 6, TK_KW, false },
+    [94] = { L"default", 7, TK_KW, false },
+    [95] = { L"long", 4, TK_KW, false },
+    [96] = { L"export", 6, TK_KW, false },
+    [101] = { L"pair", 4, TK_KW, false },
+    [102] = { L"not", 3, TK_KW, false },
+    [106] = { L"private", 7, TK_KW, false },
+    [109] = { L"constinit", 9, TK_KW, false },
+    [124] = { L"reinterpret_cast", 16, TK_KW, false },
+    [125] = { L"uint8_t", 7, TK_KW, false },
+    [131] = { L"double", 6, TK_KW, false },
+    [132] = { L"delete", 6, TK_KW, false },
+    [133] = { L"xor", 3, TK_KW, false },
+    [134] = { L"register", 8, TK_KW, false },
+    [135] = { L"false", 5, TK_KW, false },
+    [140] = { L"else", 4, TK_KW, false },
+    [142] = { L"volatile", 8, TK_KW, false },
+    [143] = { L"bitor", 5, TK_KW, false },
+    [144] = { L"set", 3, TK_KW, false },
+    [146] = { L"explicit", 8, TK_KW, false },
+    [147] = { L"typedef", 7, TK_KW, false },
+    [150] = { L"switch", 6, TK_KW, false },
+    [151] = { L"compl", 5, TK_KW, false },
+    [152] = { L"operator", 8, TK_KW, false },
+    [153] = { L"void", 4, TK_KW, false },
+    [154] = { L"auto", 4, TK_KW, false },
+    [155] = { L"override", 8, TK_KW, false },
+    [156] = { L"catch", 5, TK_KW, false },
+    [157] = { L"std", 3, TK_KW, false },
+    [158] = { L"extern", 6, TK_KW, false },
+    [159] = { L"variant", 7, TK_KW, false },
+    [160] = { L"optional", 8, TK_KW, false },
+    [166] = { L"map", 3, TK_KW, false },
+    [167] = { L"continue", 8, TK_KW, false },
+    [168] = { L"thread_local", 12, TK_KW, false },
+    [173] = { L"co_return", 9, TK_KW, false },
+    [175] = { L"public", 6, TK_KW, false },
+    [177] = { L"this", 4, TK_KW, false },
+    [182] = { L"char8_t", 7, TK_KW, false },
+    [183] = { L"concept", 7, TK_KW, false },
+    [186] = { L"and_eq", 6, TK_KW, false },
+    [191] = { L"final", 5, TK_KW, false },
+    [192] = { L"or_eq", 5, TK_KW, false },
+    [198] = { L"using", 5, TK_KW, false },
+    [203] = { L"for", 3, TK_KW, false },
+    [208] = { L"constexpr", 9, TK_KW, false },
+    [209] = { L"uint16_t", 8, TK_KW, false },
+    [210] = { L"static_cast", 11, TK_KW, false },
+    [211] = { L"uint32_t", 8, TK_KW, false },
+    [212] = { L"uint64_t", 8, TK_KW, false },
+    [213] = { L"sizeof", 6, TK_KW, false },
+    [214] = { L"break", 5, TK_KW, false },
+    [215] = { L"alignas", 7, TK_KW, false },
+    [216] = { L"unsigned", 8, TK_KW, false },
+    [217] = { L"and", 3, TK_KW, false },
+    [218] = { L"requires", 8, TK_KW, false },
+    [220] = { L"int", 3, TK_KW, false },
+    [221] = { L"short", 5, TK_KW, false },
+    [222] = { L"throw", 5, TK_KW, false },
+    [225] = { L"while", 5, TK_KW, false },
+    [232] = { L"inline", 6, TK_KW, false },
+    [233] = { L"consteval", 9, TK_KW, false },
+    [234] = { L"namespace", 9, TK_KW, false },
+    [235] = { L"or", 2, TK_KW, false },
+    [236] = { L"weak_ptr", 8, TK_KW, false },
+    [237] = { L"true", 4, TK_KW, false },
+    [238] = { L"queue", 5, TK_KW, false },
+    [240] = { L"mutable", 7, TK_KW, false },
+    [242] = { L"class", 5, TK_KW, false },
+    [243] = { L"function", 8, TK_KW, false },
+    [246] = { L"friend", 6, TK_KW, false },
+    [249] = { L"wchar_t", 7, TK_KW, false },
+    [250] = { L"alignof", 7, TK_KW, false },
+    [253] = { L"asm", 3, TK_KW, false },
+    [255] = { L"bitand", 6, TK_KW, false },
+};
+
+static const LexRegion cpp_regions[1] = {
+    { L"*/", 0, true },
+};
+
+const LexTable lex_cpp = {
+    "cpp", cpp_classes, cpp_next, cpp_accept, cpp_loops, cpp_rules, cpp_regions,
+    cpp_keywords, 255, false,
+    2, 27, 32, TK_PUNCT
+};
+
+void syntax_scan_cpp(const wchar_t *line, int len, TokenSpan *out, int *out_n) {
+    lex_scan(&lex_cpp, line, len, 0, out, out_n);
+}
+
+// ===== css: 29 states, 25 classes =====
+
+static const unsigned char css_classes[LEX_ALPHABET] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 1, 1, 1, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    1, 3, 4, 5, 0, 6, 0, 7, 0, 0, 8, 0, 0, 9, 10, 11,
+    12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 0, 0, 0, 0, 0, 0,
+    13, 14, 14, 14, 14, 14, 14, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 0, 16, 0, 0, 15,
+    0, 17, 14, 14, 14, 14, 14, 15, 15, 18, 15, 15, 15, 19, 20, 21,
+    22, 15, 23, 15, 24, 15, 15, 15, 15, 15, 15, 0, 0, 0, 0, 0,
+    0,
+};
+
+static const unsigned short css_next[29 * 25] = {
+    /*   0 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*   1 */ 0, 2, 2, 3, 4, 5, 0, 6, 0, 7, 8, 9, 10, 11, 7, 7,
+              0, 7, 7, 7, 7, 7, 7, 7, 7,
+    /*   2 */ 0, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*   3 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 12, 0, 0, 0, 0, 0, 0,
+    /*   4 */ 4, 4, 0, 4, 13, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+              14, 4, 4, 4, 4, 4, 4, 4, 4,
+    /*   5 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 15, 0, 15, 0,
+              0, 15, 0, 0, 0, 0, 0, 0, 0,
+    /*   6 */ 6, 6, 0, 6, 6, 6, 6, 16, 6, 6, 6, 6, 6, 6, 6, 6,
+              17, 6, 6, 6, 6, 6, 6, 6, 6,
+    /*   7 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 7, 0, 0, 7, 0, 7, 7,
+              0, 7, 7, 7, 7, 7, 7, 7, 7,
+    /*   8 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 10, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*   9 */ 0, 0, 0, 0, 0, 0, 0, 0, 18, 0, 0, 19, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*  10 */ 0, 0, 0, 0, 0, 0, 10, 0, 0, 0, 10, 0, 10, 0, 10, 10,
+              0, 10, 10, 10, 10, 10, 10, 10, 10,
+    /*  11 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 20, 0, 0, 0, 0, 20, 20,
+              0, 20, 20, 20, 20, 20, 20, 20, 20,
+    /*  12 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 21, 0, 0, 0, 0, 0,
+    /*  13 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*  14 */ 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+              4, 4, 4, 4, 4, 4, 4, 4, 4,
+    /*  15 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 15, 0, 15, 0,
+              0, 15, 0, 0, 0, 0, 0, 0, 0,
+    /*  16 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*  17 */ 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+              6, 6, 6, 6, 6, 6, 6, 6, 6,
+    /*  18 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*  19 */ 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19,
+              19, 19, 19, 19, 19, 19, 19, 19, 19,
+    /*  20 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 20, 0, 0, 20, 0, 20, 20,
+              0, 20, 20, 20, 20, 20, 20, 20, 20,
+    /*  21 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 22, 0, 0,
+    /*  22 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 23, 0, 0, 0,
+    /*  23 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 0, 24, 0,
+    /*  24 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 0, 0, 25,
+    /*  25 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 26, 0, 0, 0, 0, 0, 0, 0,
+    /*  26 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 27, 0, 0, 0, 0,
+    /*  27 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 0, 0, 28,
+    /*  28 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+static const unsigned char css_accept[29] = {
+    0, 0, 1, 0, 5, 0, 6, 2, 0, 0, 4, 0, 0, 5, 5, 4,
+    6, 6, 8, 7, 3, 0, 0, 0, 0, 0, 0, 0, 3,
+};
+
+static const unsigned char css_loops[29] = {
+    0x00, 0x00, 0x41, 0x00, 0x12, 0x00, 0x12, 0x12, 0x00, 0x00, 0x12, 0x00, 0x00, 0x00, 0x00, 0x10,
+    0x00, 0x00, 0x00, 0x9f, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+static const LexRule css_rules[8] = {
+    { TK_TEXT, -1 },
+    { TK_TEXT, -1 },
+    { TK_KW, -1 },
+    { TK_NUM, -1 },
+    { TK_STR, -1 },
+    { TK_STR, -1 },
+    { TK_COMMENT, -1 },
+    { TK_COMMENT, 0 },
+};
+
+static const LexRegion css_regions[1] = {
+    { L"*/", 0, true },
+};
+
+const LexTable lex_css = {
+    "css", css_classes, css_next, css_accept, css_loops, css_rules, css_regions,
+    NULL, 0, false,
+    0, 25, 29, TK_TEXT
+};
+
+void syntax_scan_css(const wchar_t *line, int len, TokenSpan *out, int *out_n) {
+    lex_scan(&lex_css, line, len, 0, out, out_n);
+}
+
+// ===== go: 22 states, 19 classes =====
+
+static const unsigned char go_classes[LEX_ALPHABET] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 1, 1, 1, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    1, 3, 4, 0, 0, 0, 5, 6, 0, 0, 7, 8, 0, 9, 10, 11,
+    12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 3, 0, 13, 14, 3, 0,
+    0, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 0, 16, 0, 0, 15,
+    17, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 0, 18, 0, 0, 0,
+    0,
+};
+
+static const unsigned short go_next[22 * 19] = {
+    /*   0 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0,
+    /*   1 */ 0, 2, 2, 3, 4, 5, 6, 0, 7, 8, 0, 9, 10, 11, 3, 12,
+              0, 13, 14,
+    /*   2 */ 0, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0,
+    /*   3 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 15, 0,
+              0, 0, 0,
+    /*   4 */ 4, 4, 0, 4, 16, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+              17, 4, 4,
+    /*   5 */ 0, 0, 0, 0, 0, 15, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0,
+    /*   6 */ 6, 6, 0, 6, 6, 6, 18, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+              19, 6, 6,
+    /*   7 */ 0, 0, 0, 0, 0, 0, 0, 0, 15, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0,
+    /*   8 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 15, 0, 0, 0, 0, 0, 0,
+              0, 0, 0,
+    /*   9 */ 0, 0, 0, 0, 0, 0, 0, 20, 0, 0, 0, 21, 0, 0, 0, 0,
+              0, 0, 0,
+    /*  10 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 10, 0, 10, 0, 0, 10,
+              0, 0, 0,
+    /*  11 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 15, 0, 0, 0, 0, 15, 0,
+              0, 0, 0,
+    /*  12 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 12, 0, 0, 12,
+              0, 0, 0,
+    /*  13 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0,
+    /*  14 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 15,
+    /*  15 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0,
+    /*  16 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0,
+    /*  17 */ 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+              4, 4, 4,
+    /*  18 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0,
+    /*  19 */ 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+              6, 6, 6,
+    /*  20 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0,
+    /*  21 */ 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+              21, 21, 21,
+};
+
+static const unsigned char go_accept[22] = {
+    0, 0, 1, 0, 5, 0, 6, 0, 0, 0, 3, 0, 2, 8, 0, 7,
+    5, 5, 6, 6, 9, 4,
+};
+
+static const unsigned char go_loops[22] = {
+    0x00, 0x00, 0x41, 0x00, 0x12, 0x00, 0x12, 0x00, 0x00, 0x00, 0x12, 0x00, 0x52, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x9f,
+};
+
+static const LexRule go_rules[9] = {
+    { TK_TEXT, -1 },
+    { TK_IDENT, -1 },
+    { TK_NUM, -1 },
+    { TK_COMMENT, -1 },
+    { TK_STR, -1 },
+    { TK_CHAR, -1 },
+    { TK_PUNCT, -1 },
+    { TK_STR, 0 },
+    { TK_COMMENT, 1 },
+};
+
+static const LexKeyword go_keywords[128] = {
+    [4] = { L"case", 4, TK_KW, false },
+    [7] = { L"false", 5, TK_KW, false },
+    [8] = { L"func", 4, TK_KW, false },
+    [9] = { L"string", 6, TK_KW, false },
+    [12] = { L"else", 4, TK_KW, false },
+    [15] = { L"range", 5, TK_KW, false },
+    [19] = { L"const", 5, TK_KW, false },
+    [21] = { L"goto", 4, TK_KW, false },
+    [22] = { L"switch", 6, TK_KW, false },
+    [25] = { L"select", 6, TK_KW, false },
+    [26] = { L"struct", 6, TK_KW, false },
+    [28] = { L"bool", 4, TK_KW, false },
+    [36] = { L"byte", 4, TK_KW, false },
+    [37] = { L"rune", 4, TK_KW, false },
+    [38] = { L"map", 3, TK_KW, false },
+    [39] = { L"continue", 8, TK_KW, false },
+    [40] = { L"if", 2, TK_KW, false },
+    [41] = { L"error", 5, TK_KW, false },
+    [44] = { L"complex128", 10, TK_KW, false },
+    [48] = { L"int16", 5, TK_KW, false },
+    [53] = { L"int64", 5, TK_KW, false },
+    [55] = { L"return", 6, TK_KW, false },
+    [56] = { L"uint64", 6, TK_KW, false },
+    [58] = { L"float64", 7, TK_KW, false },
+    [59] = { L"fallthrough", 11, TK_KW, false },
+    [60] = { L"uint8", 5, TK_KW, false },
+    [61] = { L"uint16", 6, TK_KW, false },
+    [64] = { L"uintptr", 7, TK_KW, false },
+    [65] = { L"iota", 4, TK_KW, false },
+    [68] = { L"go", 2, TK_KW, false },
+    [70] = { L"defer", 5, TK_KW, false },
+    [71] = { L"any", 3, TK_KW, false },
+    [72] = { L"complex64", 9, TK_KW, false },
+    [75] = { L"for", 3, TK_KW, false },
+    [76] = { L"var", 3, TK_KW, false },
+    [83] = { L"interface", 9, TK_KW, false },
+    [85] = { L"import", 6, TK_KW, false },
+    [86] = { L"break", 5, TK_KW, false },
+    [89] = { L"int8", 4, TK_KW, false },
+    [92] = { L"int", 3, TK_KW, false },
+    [94] = { L"default", 7, TK_KW, false },
+    [99] = { L"nil", 3, TK_KW, false },
+    [106] = { L"package", 7, TK_KW, false },
+    [109] = { L"type", 4, TK_KW, false },
+    [110] = { L"true", 4, TK_KW, false },
+    [114] = { L"uint", 4, TK_KW, false },
+    [118] = { L"int32", 5, TK_KW, false },
+    [121] = { L"chan", 4, TK_KW, false },
+    [122] = { L"float32", 7, TK_KW, false },
+    [123] = { L"uint32", 6, TK_KW, false },
+};
+
+static const LexRegion go_regions[2] = {
+    { L"`", 0, true },
+    { L"*/", 0, true },
+};
+
+const LexTable lex_go = {
+    "go", go_classes, go_next, go_accept, go_loops, go_rules, go_regions,
+    go_keywords, 127, false,
+    2, 19, 22, TK_PUNCT
+};
+
+void syntax_scan_go(const wchar_t *line, int len, TokenSpan *out, int *out_n) {
+    lex_scan(&lex_go, line, len, 0, out, out_n);
+}
+
+// ===== js: 15 states, 13 classes =====
+
+static const unsigned char js_classes[LEX_ALPHABET] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 1, 1, 1, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    1, 0, 3, 0, 4, 0, 0, 5, 0, 0, 6, 0, 0, 0, 7, 8,
+    9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 0, 0, 0, 0, 0, 0,
+    0, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 0, 11, 0, 0, 10,
+    12, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 0, 0, 0, 0, 0,
+    0,
+};
+
+static const unsigned short js_next[15 * 13] = {
+    /*   0 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*   1 */ 0, 2, 2, 3, 4, 5, 0, 0, 6, 7, 4, 0, 8,
+    /*   2 */ 0, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*   3 */ 3, 3, 0, 9, 3, 3, 3, 3, 3, 3, 3, 10, 3,
+    /*   4 */ 0, 0, 0, 0, 4, 0, 0, 0, 0, 4, 4, 0, 0,
+    /*   5 */ 5, 5, 0, 5, 5, 11, 5, 5, 5, 5, 5, 12, 5,
+    /*   6 */ 0, 0, 0, 0, 0, 0, 13, 0, 14, 0, 0, 0, 0,
+    /*   7 */ 0, 0, 0, 0, 0, 0, 0, 7, 0, 7, 7, 0, 0,
+    /*   8 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*   9 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*  10 */ 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    /*  11 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*  12 */ 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+    /*  13 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*  14 */ 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+};
+
+static const unsigned char js_accept[15] = {
+    0, 0, 1, 5, 2, 6, 0, 3, 7, 5, 5, 6, 6, 8, 4,
+};
+
+static const unsigned char js_loops[15] = {
+    0x00, 0x00, 0x41, 0x12, 0x12, 0x12, 0x00, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x9f,
+};
+
+static const LexRule js_rules[8] = {
+    { TK_TEXT, -1 },
+    { TK_IDENT, -1 },
+    { TK_NUM, -1 },
+    { TK_COMMENT, -1 },
+    { TK_STR, -1 },
+    { TK_STR, -1 },
+    { TK_STR, 0 },
+    { TK_COMMENT, 1 },
+};
+
+static const LexKeyword js_keywords[128] = {
+    [0] = { L"instanceof", 10, TK_KW, false },
+    [1] = { L"static", 6, TK_KW, false },
+    [3] = { L"delete", 6, TK_KW, false },
+    [4] = { L"case", 4, TK_KW, false },
+    [5] = { L"null", 4, TK_KW, false },
+    [6] = { L"finally", 7, TK_KW, false },
+    [7] = { L"false", 5, TK_KW, false },
+    [8] = { L"protected", 9, TK_KW, false },
+    [11] = { L"async", 5, TK_KW, false },
+    [12] = { L"else", 4, TK_KW, false },
+    [16] = { L"set", 3, TK_KW, false },
+    [19] = { L"const", 5, TK_KW, false },
+    [20] = { L"await", 5, TK_KW, false },
+    [21] = { L"enum", 4, TK_KW, false },
+    [22] = { L"switch", 6, TK_KW, false },
+    [25] = { L"void", 4, TK_KW, false },
+    [27] = { L"of", 2, TK_KW, false },
+    [28] = { L"catch", 5, TK_KW, false },
+    [34] = { L"readonly", 8, TK_KW, false },
+    [35] = { L"do", 2, TK_KW, false },
+    [38] = { L"let", 3, TK_KW, false },
+    [39] = { L"continue", 8, TK_KW, false },
+    [40] = { L"if", 2, TK_KW, false },
+    [43] = { L"in", 2, TK_KW, false },
+    [45] = { L"implements", 10, TK_KW, false },
+    [47] = { L"try", 3, TK_KW, false },
+    [48] = { L"undefined", 9, TK_KW, false },
+    [49] = { L"this", 4, TK_KW, false },
+    [50] = { L"public", 6, TK_KW, false },
+    [55] = { L"return", 6, TK_KW, false },
+    [66] = { L"new", 3, TK_KW, false },
+    [75] = { L"for", 3, TK_KW, false },
+    [76] = { L"var", 3, TK_KW, false },
+    [79] = { L"debugger", 8, TK_KW, false },
+    [80] = { L"get", 3, TK_KW, false },
+    [83] = { L"interface", 9, TK_KW, false },
+    [85] = { L"import", 6, TK_KW, false },
+    [86] = { L"break", 5, TK_KW, false },
+    [89] = { L"yield", 5, TK_KW, false },
+    [94] = { L"default", 7, TK_KW, false },
+    [95] = { L"export", 6, TK_KW, false },
+    [96] = { L"extends", 7, TK_KW, false },
+    [97] = { L"super", 5, TK_KW, false },
+    [98] = { L"throw", 5, TK_KW, false },
+    [99] = { L"while", 5, TK_KW, false },
+    [106] = { L"private", 7, TK_KW, false },
+    [109] = { L"true", 4, TK_KW, false },
+    [110] = { L"type", 4, TK_KW, false },
+    [114] = { L"class", 5, TK_KW, false },
+    [115] = { L"function", 8, TK_KW, false },
+    [116] = { L"typeof", 6, TK_KW, false },
+    [121] = { L"with", 4, TK_KW, false },
+};
+
+static const LexRegion js_regions[2] = {
+    { L"`", L'\\', true },
+    { L"*/", 0, true },
+};
+
+const LexTable lex_js = {
+    "js", js_classes, js_next, js_accept, js_loops, js_rules, js_regions,
+    js_keywords, 127, false,
+    2, 13, 15, TK_PUNCT
+};
+
+void syntax_scan_js(const wchar_t *line, int len, TokenSpan *out, int *out_n) {
+    lex_scan(&lex_js, line, len, 0, out, out_n);
+}
+
+// ===== json: 12 states, 12 classes =====
+
+static const unsigned char json_classes[LEX_ALPHABET] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 1, 1, 1, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    1, 0, 3, 0, 0, 0, 0, 0, 0, 0, 4, 5, 0, 6, 5, 7,
+    8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 0, 0, 0, 0, 0, 0,
+    0, 9, 9, 9, 9, 10, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9,
+    9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 0, 11, 0, 0, 9,
+    0, 9, 9, 9, 9, 10, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9,
+    9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 0, 0, 0, 0, 0,
+    0,
+};
+
+static const unsigned short json_next[12 * 12] = {
+    /*   0 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*   1 */ 0, 2, 2, 3, 0, 0, 4, 5, 6, 7, 7, 0,
+    /*   2 */ 0, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*   3 */ 3, 3, 0, 8, 3, 3, 3, 3, 3, 3, 3, 9,
+    /*   4 */ 0, 0, 0, 0, 0, 0, 0, 0, 6, 0, 0, 0,
+    /*   5 */ 0, 0, 0, 0, 10, 0, 0, 11, 0, 0, 0, 0,
+    /*   6 */ 0, 0, 0, 0, 0, 6, 6, 0, 6, 0, 6, 0,
+    /*   7 */ 0, 0, 0, 0, 0, 0, 0, 0, 7, 7, 7, 0,
+    /*   8 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*   9 */ 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    /*  10 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*  11 */ 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+};
+
+static const unsigned char json_accept[12] = {
+    0, 0, 1, 4, 0, 0, 3, 2, 4, 4, 6, 5,
+};
+
+static const unsigned char json_loops[12] = {
+    0x00, 0x00, 0x41, 0x12, 0x00, 0x00, 0x10, 0x52, 0x00, 0x00, 0x00, 0x9f,
+};
+
+static const LexRule json_rules[6] = {
+    { TK_TEXT, -1 },
+    { TK_IDENT, -1 },
+    { TK_NUM, -1 },
+    { TK_STR, -1 },
+    { TK_COMMENT, -1 },
+    { TK_COMMENT, 0 },
+};
+
+static const LexKeyword json_keywords[16] = {
+    [5] = { L"null", 4, TK_KW, false },
+    [7] = { L"false", 5, TK_KW, false },
+    [13] = { L"true", 4, TK_KW, false },
+};
+
+static const LexRegion json_regions[1] = {
+    { L"*/", 0, true },
+};
+
+const LexTable lex_json = {
+    "json", json_classes, json_next, json_accept, json_loops, json_rules, json_regions,
+    json_keywords, 15, false,
+    2, 12, 12, TK_PUNCT
+};
+
+void syntax_scan_json(const wchar_t *line, int len, TokenSpan *out, int *out_n) {
+    lex_scan(&lex_json, line, len, 0, out, out_n);
+}
+
+// ===== lua: 18 states, 11 classes =====
+
+static const unsigned char lua_classes[LEX_ALPHABET] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 1, 1, 1, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    1, 0, 3, 0, 0, 0, 0, 4, 0, 0, 0, 0, 0, 5, 6, 0,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 0, 0, 0, 0, 0, 0,
+    0, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8,
+    8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 9, 10, 0, 0, 8,
+    0, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8,
+    8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 0, 0, 0, 0, 0,
+    0,
+};
+
+static const unsigned short lua_next[18 * 11] = {
+    /*   0 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*   1 */ 0, 2, 2, 3, 4, 5, 0, 6, 7, 8, 0,
+    /*   2 */ 0, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*   3 */ 3, 3, 0, 9, 3, 3, 3, 3, 3, 3, 10,
+    /*   4 */ 4, 4, 0, 4, 11, 4, 4, 4, 4, 4, 12,
+    /*   5 */ 0, 0, 0, 0, 0, 13, 0, 0, 0, 0, 0,
+    /*   6 */ 0, 0, 0, 0, 0, 0, 6, 6, 6, 0, 0,
+    /*   7 */ 0, 0, 0, 0, 0, 0, 0, 7, 7, 0, 0,
+    /*   8 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 14, 0,
+    /*   9 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*  10 */ 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    /*  11 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*  12 */ 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    /*  13 */ 15, 15, 0, 15, 15, 15, 15, 15, 15, 16, 15,
+    /*  14 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*  15 */ 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+    /*  16 */ 15, 15, 0, 15, 15, 15, 15, 15, 15, 17, 15,
+    /*  17 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+static const unsigned char lua_accept[18] = {
+    0, 0, 1, 5, 6, 0, 3, 2, 0, 5, 5, 6, 6, 4, 8, 4,
+    4, 7,
+};
+
+static const unsigned char lua_loops[18] = {
+    0x00, 0x00, 0x41, 0x12, 0x12, 0x00, 0x12, 0x52, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x9f,
+    0x00, 0x00,
+};
+
+static const LexRule lua_rules[8] = {
+    { TK_TEXT, -1 },
+    { TK_IDENT, -1 },
+    { TK_NUM, -1 },
+    { TK_COMMENT, -1 },
+    { TK_STR, -1 },
+    { TK_STR, -1 },
+    { TK_COMMENT, 0 },
+    { TK_STR, 1 },
+};
+
+static const LexKeyword lua_keywords[64] = {
+    [7] = { L"false", 5, TK_KW, false },
+    [11] = { L"for", 3, TK_KW, false },
+    [12] = { L"else", 4, TK_KW, false },
+    [16] = { L"then", 4, TK_KW, false },
+    [18] = { L"elseif", 6, TK_KW, false },
+    [21] = { L"goto", 4, TK_KW, false },
+    [22] = { L"and", 3, TK_KW, false },
+    [23] = { L"break", 5, TK_KW, false },
+    [29] = { L"until", 5, TK_KW, false },
+    [30] = { L"end", 3, TK_KW, false },
+    [33] = { L"while", 5, TK_KW, false },
+    [35] = { L"do", 2, TK_KW, false },
+    [36] = { L"nil", 3, TK_KW, false },
+    [38] = { L"not", 3, TK_KW, false },
+    [39] = { L"if", 2, TK_KW, false },
+    [42] = { L"or", 2, TK_KW, false },
+    [43] = { L"in", 2, TK_KW, false },
+    [45] = { L"true", 4, TK_KW, false },
+    [47] = { L"local", 5, TK_KW, false },
+    [51] = { L"function", 8, TK_KW, false },
+    [55] = { L"repeat", 6, TK_KW, false },
+    [56] = { L"return", 6, TK_KW, false },
+};
+
+static const LexRegion lua_regions[2] = {
+    { L"]]", 0, true },
+    { L"]]", 0, true },
+};
+
+const LexTable lex_lua = {
+    "lua", lua_classes, lua_next, lua_accept, lua_loops, lua_rules, lua_regions,
+    lua_keywords, 63, false,
+    2, 11, 18, TK_PUNCT
+};
+
+void syntax_scan_lua(const wchar_t *line, int len, TokenSpan *out, int *out_n) {
+    lex_scan(&lex_lua, line, len, 0, out, out_n);
+}
+
+// ===== py: 20 states, 12 classes =====
+
+static const unsigned char py_classes[LEX_ALPHABET] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 1, 1, 1, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    1, 0, 3, 4, 0, 0, 0, 5, 0, 0, 0, 0, 0, 0, 6, 0,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 0, 0, 0, 0, 0, 0,
+    0, 8, 9, 8, 8, 8, 9, 8, 8, 8, 8, 8, 8, 8, 8, 8,
+    8, 8, 9, 8, 8, 10, 8, 8, 8, 8, 8, 0, 11, 0, 0, 8,
+    0, 8, 9, 8, 8, 8, 9, 8, 8, 8, 8, 8, 8, 8, 8, 8,
+    8, 8, 9, 8, 8, 10, 8, 8, 8, 8, 8, 0, 0, 0, 0, 0,
+    0,
+};
+
+static const unsigned short py_next[20 * 12] = {
+    /*   0 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*   1 */ 0, 2, 2, 3, 4, 5, 0, 6, 7, 8, 8, 0,
+    /*   2 */ 0, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*   3 */ 9, 9, 0, 10, 9, 9, 9, 9, 9, 9, 9, 11,
+    /*   4 */ 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    /*   5 */ 12, 12, 0, 12, 12, 13, 12, 12, 12, 12, 12, 14,
+    /*   6 */ 0, 0, 0, 0, 0, 0, 6, 6, 6, 6, 6, 0,
+    /*   7 */ 0, 0, 0, 0, 0, 0, 0, 7, 7, 7, 7, 0,
+    /*   8 */ 0, 0, 0, 9, 0, 12, 0, 7, 7, 15, 7, 0,
+    /*   9 */ 9, 9, 0, 16, 9, 9, 9, 9, 9, 9, 9, 11,
+    /*  10 */ 0, 0, 0, 17, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*  11 */ 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9,
+    /*  12 */ 12, 12, 0, 12, 12, 18, 12, 12, 12, 12, 12, 14,
+    /*  13 */ 0, 0, 0, 0, 0, 19, 0, 0, 0, 0, 0, 0,
+    /*  14 */ 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+    /*  15 */ 0, 0, 0, 9, 0, 12, 0, 7, 7, 7, 7, 0,
+    /*  16 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*  17 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*  18 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*  19 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+static const unsigned char py_accept[20] = {
+    0, 0, 1, 5, 4, 6, 3, 2, 2, 5, 5, 5, 6, 6, 6, 2,
+    5, 7, 6, 8,
+};
+
+static const unsigned char py_loops[20] = {
+    0x00, 0x00, 0x41, 0x00, 0x9f, 0x00, 0x12, 0x52, 0x00, 0x12, 0x00, 0x00, 0x12, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+};
+
+static const LexRule py_rules[8] = {
+    { TK_TEXT, -1 },
+    { TK_IDENT, -1 },
+    { TK_NUM, -1 },
+    { TK_COMMENT, -1 },
+    { TK_STR, -1 },
+    { TK_STR, -1 },
+    { TK_STR, 0 },
+    { TK_STR, 1 },
+};
+
+static const LexKeyword py_keywords[128] = {
+    [5] = { L"False", 5, TK_KW, false },
+    [6] = { L"finally", 7, TK_KW, false },
+    [9] = { L"as", 2, TK_KW, false },
+    [10] = { L"is", 2, TK_KW, false },
+    [11] = { L"async", 5, TK_KW, false },
+    [12] = { L"else", 4, TK_KW, false },
+    [15] = { L"raise", 5, TK_KW, false },
+    [19] = { L"await", 5, TK_KW, false },
+    [38] = { L"nonlocal", 8, TK_KW, false },
+    [39] = { L"continue", 8, TK_KW, false },
+    [40] = { L"if", 2, TK_KW, false },
+    [43] = { L"in", 2, TK_KW, false },
+    [47] = { L"try", 3, TK_KW, false },
+    [50] = { L"del", 3, TK_KW, false },
+    [51] = { L"from", 4, TK_KW, false },
+    [55] = { L"return", 6, TK_KW, false },
+    [57] = { L"pass", 4, TK_KW, false },
+    [63] = { L"None", 4, TK_KW, false },
+    [75] = { L"for", 3, TK_KW, false },
+    [84] = { L"lambda", 6, TK_KW, false },
+    [85] = { L"import", 6, TK_KW, false },
+    [86] = { L"and", 3, TK_KW, false },
+    [87] = { L"assert", 6, TK_KW, false },
+    [88] = { L"break", 5, TK_KW, false },
+    [89] = { L"yield", 5, TK_KW, false },
+    [92] = { L"global", 6, TK_KW, false },
+    [94] = { L"except", 6, TK_KW, false },
+    [97] = { L"while", 5, TK_KW, false },
+    [102] = { L"not", 3, TK_KW, false },
+    [103] = { L"match", 5, TK_KW, false },
+    [106] = { L"or", 2, TK_KW, false },
+    [108] = { L"True", 4, TK_KW, false },
+    [114] = { L"class", 5, TK_KW, false },
+    [121] = { L"with", 4, TK_KW, false },
+    [123] = { L"def", 3, TK_KW, false },
+    [125] = { L"elif", 4, TK_KW, false },
+};
+
+static const LexRegion py_regions[2] = {
+    { L"\"\"\"", L'\\', true },
+    { L"'''", L'\\', true },
+};
+
+const LexTable lex_py = {
+    "py", py_classes, py_next, py_accept, py_loops, py_rules, py_regions,
+    py_keywords, 127, false,
+    2, 12, 20, TK_PUNCT
+};
+
+void syntax_scan_py(const wchar_t *line, int len, TokenSpan *out, int *out_n) {
+    lex_scan(&lex_py, line, len, 0, out, out_n);
+}
+
+// ===== rs: 32 states, 23 classes =====
+
+static const unsigned char rs_classes[LEX_ALPHABET] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 1, 1, 1, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    1, 3, 4, 5, 0, 0, 6, 7, 0, 0, 8, 0, 0, 9, 10, 11,
+    12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 13, 0, 14, 15, 16, 0,
+    0, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17,
+    17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 18, 19, 20, 0, 17,
+    0, 17, 21, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17,
+    17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 0, 22, 0, 0, 0,
+    0,
+};
+
+static const unsigned short rs_next[32 * 23] = {
+    /*   0 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 0,
+    /*   1 */ 0, 2, 2, 3, 4, 5, 6, 7, 0, 8, 0, 9, 10, 11, 3, 12,
+              3, 13, 0, 0, 0, 14, 15,
+    /*   2 */ 0, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 0,
+    /*   3 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 16,
+              0, 0, 0, 0, 0, 0, 0,
+    /*   4 */ 4, 4, 0, 4, 17, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+              4, 4, 4, 18, 4, 4, 4,
+    /*   5 */ 0, 0, 0, 19, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 20, 0, 0, 0, 0,
+    /*   6 */ 0, 0, 0, 0, 0, 0, 16, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 0,
+    /*   7 */ 21, 21, 0, 21, 21, 21, 21, 0, 21, 21, 21, 21, 21, 21, 21, 21,
+              21, 22, 21, 23, 21, 22, 21,
+    /*   8 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              16, 0, 0, 0, 0, 0, 0,
+    /*   9 */ 0, 0, 0, 0, 0, 0, 0, 0, 24, 0, 0, 25, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 0,
+    /*  10 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 10, 0, 10, 0, 0, 0,
+              0, 10, 0, 0, 0, 10, 0,
+    /*  11 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 16, 0, 0,
+              0, 0, 0, 0, 0, 0, 0,
+    /*  12 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 16,
+              16, 0, 0, 0, 0, 0, 0,
+    /*  13 */ 0, 0, 0, 26, 0, 0, 0, 0, 0, 0, 0, 0, 13, 0, 0, 0,
+              0, 13, 0, 0, 0, 13, 0,
+    /*  14 */ 0, 0, 0, 26, 4, 0, 0, 27, 0, 0, 0, 0, 13, 0, 0, 0,
+              0, 13, 0, 0, 0, 13, 0,
+    /*  15 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 16,
+    /*  16 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 0,
+    /*  17 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 0,
+    /*  18 */ 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+              4, 4, 4, 4, 4, 4, 4,
+    /*  19 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 20, 0, 0, 0, 0,
+    /*  20 */ 20, 20, 0, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20,
+              20, 20, 20, 20, 28, 20, 20,
+    /*  21 */ 0, 0, 0, 0, 0, 0, 0, 29, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 0,
+    /*  22 */ 0, 0, 0, 0, 0, 0, 0, 29, 0, 0, 0, 0, 30, 0, 0, 0,
+              0, 30, 0, 0, 0, 30, 0,
+    /*  23 */ 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31,
+              31, 31, 31, 31, 31, 31, 31,
+    /*  24 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 0,
+    /*  25 */ 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25,
+              25, 25, 25, 25, 25, 25, 25,
+    /*  26 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 0,
+    /*  27 */ 21, 21, 0, 21, 21, 21, 21, 0, 21, 21, 21, 21, 21, 21, 21, 21,
+              21, 21, 21, 23, 21, 21, 21,
+    /*  28 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 0,
+    /*  29 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+              0, 0, 0, 0, 0, 0, 0,
+    /*  30 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 30, 0, 0, 0,
+              0, 30, 0, 0, 0, 30, 0,
+    /*  31 */ 31, 31, 0, 31, 31, 31, 31, 29, 31, 31, 31, 31, 31, 31, 31, 31,
+              31, 31, 31, 31, 31, 31, 31,
+};
+
+static const unsigned char rs_accept[32] = {
+    0, 0, 1, 0, 7, 0, 0, 0, 0, 0, 4, 0, 0, 2, 2, 0,
+    9, 7, 7, 0, 6, 0, 3, 0, 10, 5, 2, 0, 6, 8, 3, 0,
+};
+
+static const unsigned char rs_loops[32] = {
+    0x00, 0x00, 0x41, 0x00, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x12, 0x00, 0x00, 0x12, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x16, 0x00, 0x00, 0x00, 0x00, 0x9f, 0x00, 0x00, 0x00, 0x00, 0x52, 0x1a,
+};
+
+static const LexRule rs_rules[10] = {
+    { TK_TEXT, -1 },
+    { TK_IDENT, -1 },
+    { TK_IDENT, -1 },
+    { TK_NUM, -1 },
+    { TK_COMMENT, -1 },
+    { TK_COMMENT, -1 },
+    { TK_STR, -1 },
+    { TK_CHAR, -1 },
+    { TK_PUNCT, -1 },
+    { TK_COMMENT, 0 },
+};
+
+static const LexKeyword rs_keywords[128] = {
+    [1] = { L"fn", 2, TK_KW, false },
+    [2] = { L"static", 6, TK_KW, false },
+    [4] = { L"char", 4, TK_KW, false },
+    [5] = { L"Some", 4, TK_KW, false },
+    [7] = { L"false", 5, TK_KW, false },
+    [8] = { L"i8", 2, TK_KW, false },
+    [9] = { L"as", 2, TK_KW, false },
+    [11] = { L"async", 5, TK_KW, false },
+    [12] = { L"else", 4, TK_KW, false },
+    [16] = { L"f32", 3, TK_KW, false },
+    [17] = { L"u128", 4, TK_KW, false },
+    [19] = { L"await", 5, TK_KW, false },
+    [20] = { L"const", 5, TK_KW, false },
+    [21] = { L"enum", 4, TK_KW, false },
+    [25] = { L"struct", 6, TK_KW, false },
+    [28] = { L"bool", 4, TK_KW, false },
+    [30] = { L"extern", 6, TK_KW, false },
+    [32] = { L"unsafe", 6, TK_KW, false },
+    [36] = { L"mut", 3, TK_KW, false },
+    [38] = { L"let", 3, TK_KW, false },
+    [39] = { L"continue", 8, TK_KW, false },
+    [40] = { L"if", 2, TK_KW, false },
+    [41] = { L"use", 3, TK_KW, false },
+    [43] = { L"in", 2, TK_KW, false },
+    [44] = { L"Err", 3, TK_KW, false },
+    [45] = { L"mod", 3, TK_KW, false },
+    [46] = { L"crate", 5, TK_KW, false },
+    [47] = { L"str", 3, TK_KW, false },
+    [48] = { L"isize", 5, TK_KW, false },
+    [49] = { L"u64", 3, TK_KW, false },
+    [50] = { L"ref", 3, TK_KW, false },
+    [51] = { L"Option", 6, TK_KW, false },
+    [52] = { L"u16", 3, TK_KW, false },
+    [53] = { L"Ok", 2, TK_KW, false },
+    [55] = { L"return", 6, TK_KW, false },
+    [58] = { L"self", 4, TK_KW, false },
+    [59] = { L"i32", 3, TK_KW, false },
+    [63] = { L"impl", 4, TK_KW, false },
+    [64] = { L"u8", 2, TK_KW, false },
+    [65] = { L"None", 4, TK_KW, false },
+    [66] = { L"loop", 4, TK_KW, false },
+    [72] = { L"String", 6, TK_KW, false },
+    [75] = { L"for", 3, TK_KW, false },
+    [83] = { L"f64", 3, TK_KW, false },
+    [86] = { L"break", 5, TK_KW, false },
+    [89] = { L"i128", 4, TK_KW, false },
+    [97] = { L"super", 5, TK_KW, false },
+    [98] = { L"where", 5, TK_KW, false },
+    [99] = { L"while", 5, TK_KW, false },
+    [101] = { L"usize", 5, TK_KW, false },
+    [103] = { L"match", 5, TK_KW, false },
+    [109] = { L"true", 4, TK_KW, false },
+    [110] = { L"type", 4, TK_KW, false },
+    [111] = { L"Vec", 3, TK_KW, false },
+    [114] = { L"u32", 3, TK_KW, false },
+    [116] = { L"pub", 3, TK_KW, false },
+    [117] = { L"Self", 4, TK_KW, false },
+    [118] = { L"Result", 6, TK_KW, false },
+    [119] = { L"dyn", 3, TK_KW, false },
+    [121] = { L"i64", 3, TK_KW, false },
+    [122] = { L"trait", 5, TK_KW, false },
+    [123] = { L"Box", 3, TK_KW, false },
+    [124] = { L"i16", 3, TK_KW, false },
+    [127] = { L"move", 4, TK_KW, false },
+};
+
+static const LexRegion rs_regions[1] = {
+    { L"*/", 0, true },
+};
+
+const LexTable lex_rs = {
+    "rs", rs_classes, rs_next, rs_accept, rs_loops, rs_rules, rs_regions,
+    rs_keywords, 127, false,
+    2, 23, 32, TK_PUNCT
+};
+
+void syntax_scan_rs(const wchar_t *line, int len, TokenSpan *out, int *out_n) {
+    lex_scan(&lex_rs, line, len, 0, out, out_n);
+}
+
+// ===== sh: 18 states, 16 classes =====
+
+static const unsigned char sh_classes[LEX_ALPHABET] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 1, 1, 1, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    1, 3, 4, 5, 6, 0, 0, 7, 3, 0, 3, 0, 0, 8, 9, 0,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 0, 0, 0, 0, 0, 3,
+    3, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+    11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 0, 12, 0, 0, 11,
+    13, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+    11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 14, 0, 15, 0, 0,
+    0,
+};
+
+static const unsigned short sh_next[18 * 16] = {
+    /*   0 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*   1 */ 0, 2, 2, 0, 3, 4, 5, 6, 0, 0, 7, 8, 0, 9, 0, 0,
+    /*   2 */ 0, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*   3 */ 3, 3, 0, 3, 10, 3, 3, 3, 3, 3, 3, 3, 11, 3, 3, 3,
+    /*   4 */ 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    /*   5 */ 0, 0, 0, 12, 0, 12, 12, 0, 12, 0, 12, 13, 0, 0, 14, 0,
+    /*   6 */ 6, 6, 0, 6, 6, 6, 6, 15, 6, 6, 6, 6, 6, 6, 6, 6,
+    /*   7 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 7, 7, 0, 0, 0, 0, 0,
+    /*   8 */ 0, 0, 0, 0, 0, 0, 0, 0, 8, 0, 8, 8, 0, 0, 0, 0,
+    /*   9 */ 9, 9, 0, 9, 9, 9, 9, 9, 9, 9, 9, 9, 16, 17, 9, 9,
+    /*  10 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*  11 */ 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    /*  12 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*  13 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 13, 13, 0, 0, 0, 0,
+    /*  14 */ 14, 14, 0, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 12,
+    /*  15 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    /*  16 */ 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9,
+    /*  17 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+static const unsigned char sh_accept[18] = {
+    0, 0, 1, 7, 5, 3, 6, 4, 2, 8, 7, 7, 3, 3, 3, 6,
+    8, 8,
+};
+
+static const unsigned char sh_loops[18] = {
+    0x00, 0x00, 0x41, 0x12, 0x9f, 0x00, 0x1a, 0x10, 0x12, 0x12, 0x00, 0x00, 0x00, 0x52, 0x16, 0x00,
+    0x00, 0x00,
+};
+
+static const LexRule sh_rules[8] = {
+    { TK_TEXT, -1 },
+    { TK_IDENT, -1 },
+    { TK_IDENT, -1 },
+    { TK_NUM, -1 },
+    { TK_COMMENT, -1 },
+    { TK_STR, -1 },
+    { TK_STR, -1 },
+    { TK_STR, -1 },
+};
+
+static const LexKeyword sh_keywords[128] = {
+    [4] = { L"case", 4, TK_KW, false },
+    [7] = { L"false", 5, TK_KW, false },
+    [12] = { L"else", 4, TK_KW, false },
+    [16] = { L"then", 4, TK_KW, false },
+    [17] = { L"read", 4, TK_KW, false },
+    [18] = { L"echo", 4, TK_KW, false },
+    [19] = { L"set", 3, TK_KW, false },
+    [33] = { L"fi", 2, TK_KW, false },
+    [34] = { L"readonly", 8, TK_KW, false },
+    [35] = { L"do", 2, TK_KW, false },
+    [36] = { L"source", 6, TK_KW, false },
+    [39] = { L"if", 2, TK_KW, false },
+    [40] = { L"continue", 8, TK_KW, false },
+    [41] = { L"esac", 4, TK_KW, false },
+    [42] = { L"exec", 4, TK_KW, false },
+    [43] = { L"in", 2, TK_KW, false },
+    [49] = { L"exit", 4, TK_KW, false },
+    [52] = { L"eval", 4, TK_KW, false },
+    [55] = { L"return", 6, TK_KW, false },
+    [56] = { L"pwd", 3, TK_KW, false },
+    [75] = { L"for", 3, TK_KW, false },
+    [80] = { L"test", 4, TK_KW, false },
+    [82] = { L"trap", 4, TK_KW, false },
+    [86] = { L"break", 5, TK_KW, false },
+    [88] = { L"unset", 5, TK_KW, false },
+    [92] = { L"shift", 5, TK_KW, false },
+    [93] = { L"until", 5, TK_KW, false },
+    [94] = { L"export", 6, TK_KW, false },
+    [97] = { L"while", 5, TK_KW, false },
+    [98] = { L"cd", 2, TK_KW, false },
+    [99] = { L"declare", 7, TK_KW, false },
+    [108] = { L"done", 4, TK_KW, false },
+    [109] = { L"true", 4, TK_KW, false },
+    [111] = { L"local", 5, TK_KW, false },
+    [115] = { L"function", 8, TK_KW, false },
+    [123] = { L"printf", 6, TK_KW, false },
+    [125] = { L"elif", 4, TK_KW, false },
+};
+
+const LexTable lex_sh = {
+    "sh", sh_classes, sh_next, sh_accept, sh_loops, sh_rules, NULL,
+    sh_keywords, 127, false,
+    2, 16, 18, TK_PUNCT
+};
+
+void syntax_scan_sh(const wchar_t *line, int len, TokenSpan *out, int *out_n) {
+    lex_scan(&lex_sh, line, len, 0, out, out_n);
+}
+
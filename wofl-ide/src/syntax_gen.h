@@ -0,0 +1,21 @@
+// ==================== syntax_gen.h ====================
+// Generated by tools/lexgen.c from lang/*.lang -- do not edit
+
+#ifndef WOFL_SYNTAX_GEN_H
+#define WOFL_SYNTAX_GEN_H
+
+#include "lexer.h"
+
+extern const LexTable lex_asm;
+extern const LexTable lex_c;
+extern const LexTable lex_cpp;
+extern const LexTable lex_css;
+extern const LexTable lex_go;
+extern const LexTable lex_js;
+extern const LexTable lex_json;
+extern const LexTable lex_lua;
+extern const LexTable lex_py;
+extern const LexTable lex_rs;
+extern const LexTable lex_sh;
+
+#endif // WOFL_SYNTAX_GEN_H
@@ -1,4 +1,4 @@
-#include "editor.h"
+#include "syntax_defs.h"
 void syntax_scan_html(const wchar_t* l,int n,TokenSpan*out,int*on){
     // very light: tags/punct vs text
     int i=0,m=0;
@@ -0,0 +1,91 @@
+// ==================== wofl_thread.h ====================
+// Tiny threading shim shared by the Win32 and Linux ports
+
+#ifndef WOFL_THREAD_H
+#define WOFL_THREAD_H
+
+#include <stdbool.h>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+
+typedef CRITICAL_SECTION wofl_mutex;
+typedef HANDLE           wofl_thread;
+typedef DWORD (WINAPI   *wofl_thread_fn)(void *arg);
+#define WOFL_THREAD_FN(name) DWORD WINAPI name(void *arg)
+#define WOFL_THREAD_RETURN   return 0
+
+static inline void wofl_mutex_init(wofl_mutex *m)    { InitializeCriticalSection(m); }
+static inline void wofl_mutex_destroy(wofl_mutex *m) { DeleteCriticalSection(m); }
+static inline void wofl_mutex_lock(wofl_mutex *m)    { EnterCriticalSection(m); }
+static inline void wofl_mutex_unlock(wofl_mutex *m)  { LeaveCriticalSection(m); }
+
+// fn runs exactly once over all threads; the others wait until it is done
+typedef INIT_ONCE wofl_once;
+#define WOFL_ONCE_INIT INIT_ONCE_STATIC_INIT
+
+static inline BOOL CALLBACK wofl_once_call(PINIT_ONCE once, PVOID fn, PVOID *ctx) {
+    (void)once;
+    (void)ctx;
+    ((void (*)(void))fn)();
+    return TRUE;
+}
+
+static inline void wofl_once_run(wofl_once *o, void (*fn)(void)) {
+    InitOnceExecuteOnce(o, wofl_once_call, (PVOID)fn, NULL);
+}
+
+static inline bool wofl_thread_start(wofl_thread *t, wofl_thread_fn fn, void *arg) {
+    *t = CreateThread(NULL, 0, (LPTHREAD_START_ROUTINE)fn, arg, 0, NULL);
+    return *t != NULL;
+}
+
+static inline void wofl_thread_join(wofl_thread t) {
+    WaitForSingleObject(t, INFINITE);
+    CloseHandle(t);
+}
+
+static inline int wofl_cpu_count(void) {
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return si.dwNumberOfProcessors > 0 ? (int)si.dwNumberOfProcessors : 1;
+}
+
+#else
+#include <pthread.h>
+#include <unistd.h>
+
+typedef pthread_mutex_t wofl_mutex;
+typedef pthread_t       wofl_thread;
+typedef void *(*wofl_thread_fn)(void *arg);
+#define WOFL_THREAD_FN(name) void *name(void *arg)
+#define WOFL_THREAD_RETURN   return NULL
+
+static inline void wofl_mutex_init(wofl_mutex *m)    { pthread_mutex_init(m, NULL); }
+static inline void wofl_mutex_destroy(wofl_mutex *m) { pthread_mutex_destroy(m); }
+static inline void wofl_mutex_lock(wofl_mutex *m)    { pthread_mutex_lock(m); }
+static inline void wofl_mutex_unlock(wofl_mutex *m)  { pthread_mutex_unlock(m); }
+
+typedef pthread_once_t wofl_once;
+#define WOFL_ONCE_INIT PTHREAD_ONCE_INIT
+
+static inline void wofl_once_run(wofl_once *o, void (*fn)(void)) { pthread_once(o, fn); }
+
+static inline bool wofl_thread_start(wofl_thread *t, wofl_thread_fn fn, void *arg) {
+    return pthread_create(t, NULL, fn, arg) == 0;
+}
+
+static inline void wofl_thread_join(wofl_thread t) {
+    pthread_join(t, NULL);
+}
+
+static inline int wofl_cpu_count(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+#endif
+
+#endif // WOFL_THREAD_H
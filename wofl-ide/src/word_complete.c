@@ -0,0 +1,511 @@
+// ==================== word_complete.c ====================
+// Radix tries of buffer words, kept in step with edits (see word_complete.h)
+
+#include "word_complete.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define WC_SLOTS        (WC_GATHER * 2)
+
+// A candidate while a query is answered
+typedef struct {
+    char     word[WC_WORD_MAX];
+    uint32_t cur, other;        // occurrences in the current buffer and the rest
+    uint32_t near;              // distance of the nearest one from the caret, or WC_NONE
+    uint8_t  len;
+} WcEntry;
+
+struct WcScratch {
+    WcEntry  entries[WC_GATHER];
+    int      count;
+    uint32_t slots[WC_SLOTS];   // open addressing by word hash: entry + 1, 0 when empty
+    char     prefix[WC_WORD_MAX];
+    int      plen;
+    size_t   caret;
+};
+
+static bool is_word(unsigned c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+static uint64_t hash_word(const char *w, int len) {
+    uint64_t h = 1469598103934665603ull;
+    for (int i = 0; i < len; i++) {
+        h ^= (unsigned char)w[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+uint64_t wc_name_id(const void *name, size_t bytes) {
+    const unsigned char *p = (const unsigned char *)name;
+    uint64_t h = 1469598103934665603ull;
+    for (size_t i = 0; i < bytes; i++) {
+        h ^= p[i];
+        h *= 1099511628211ull;
+    }
+    return h ? h : 1;
+}
+
+// ===== Trie =====
+
+static void trie_free(WcTrie *t) {
+    free(t->nodes);
+    free(t->pool);
+    memset(t, 0, sizeof(*t));
+}
+
+// free_list holds a node + 1, 0 when empty, so a zeroed trie is empty
+static uint32_t new_node(WcTrie *t) {
+    if (t->free_list) {
+        const uint32_t n = t->free_list - 1;
+        t->free_list = t->nodes[n].next;
+        return n;
+    }
+    if (t->nnodes == t->cap) {
+        const uint32_t cap = t->cap ? t->cap * 2 : 256;
+        WcNode *nodes = (WcNode *)realloc(t->nodes, (size_t)cap * sizeof(WcNode));
+        if (!nodes) return WC_NONE;
+        t->nodes = nodes;
+        t->cap = cap;
+    }
+    return t->nnodes++;
+}
+
+static void free_node(WcTrie *t, uint32_t n) {
+    t->nodes[n].next = t->free_list;
+    t->free_list = n + 1;
+}
+
+static uint32_t add_label(WcTrie *t, const char *s, int len) {
+    if (t->used + (uint32_t)len > t->pool_cap) {
+        uint32_t cap = t->pool_cap ? t->pool_cap : 4096;
+        while (cap < t->used + (uint32_t)len) cap *= 2;
+        char *pool = (char *)realloc(t->pool, cap);
+        if (!pool) return WC_NONE;
+        t->pool = pool;
+        t->pool_cap = cap;
+    }
+    memcpy(t->pool + t->used, s, (size_t)len);
+    t->used += (uint32_t)len;
+    return t->used - (uint32_t)len;
+}
+
+// The child of n whose label starts with c, and the link pointing at it
+static uint32_t find_child(const WcTrie *t, uint32_t n, char c, uint32_t *prev) {
+    uint32_t p = WC_NONE;
+    for (uint32_t k = t->nodes[n].child; k != WC_NONE; p = k, k = t->nodes[k].next) {
+        if (t->pool[t->nodes[k].label] == c) {
+            if (prev) *prev = p;
+            return k;
+        }
+    }
+    return WC_NONE;
+}
+
+static void copy_labels(WcTrie *t, uint32_t n, char *pool, uint32_t *used) {
+    for (uint32_t k = t->nodes[n].child; k != WC_NONE; k = t->nodes[k].next) {
+        memcpy(pool + *used, t->pool + t->nodes[k].label, t->nodes[k].len);
+        t->nodes[k].label = *used;
+        *used += t->nodes[k].len;
+        copy_labels(t, k, pool, used);
+    }
+}
+
+// Labels of removed words are left in the pool; once they are most of it,
+// the live ones are copied into a pool of their own
+static void compact(WcTrie *t) {
+    if (t->dead < 4096 || t->dead < t->used / 2 || !t->nnodes) return;
+    const uint32_t cap = t->used - t->dead + 1;
+    char *pool = (char *)malloc(cap);
+    if (!pool) return;
+    uint32_t used = 0;
+    copy_labels(t, 0, pool, &used);
+    free(t->pool);
+    t->pool = pool;
+    t->pool_cap = cap;
+    t->used = used;
+    t->dead = 0;
+}
+
+static bool trie_add(WcTrie *t, const char *w, int len) {
+    if (!t->nnodes) {
+        if (new_node(t) == WC_NONE) return false;
+        t->nodes[0] = (WcNode){ 0, 0, WC_NONE, WC_NONE, 0, { 0 } };
+    }
+    uint32_t n = 0;
+    int i = 0;
+    while (i < len) {
+        const uint32_t c = find_child(t, n, w[i], NULL);
+        if (c == WC_NONE) {
+            // A leaf for the rest of the word
+            const uint32_t leaf = new_node(t);
+            if (leaf == WC_NONE) return false;
+            const uint32_t label = add_label(t, w + i, len - i);
+            if (label == WC_NONE) {
+                free_node(t, leaf);
+                return false;
+            }
+            t->nodes[leaf] = (WcNode){ label, 0, WC_NONE, t->nodes[n].child, (uint8_t)(len - i), { 0 } };
+            t->nodes[n].child = leaf;
+            n = leaf;
+            break;
+        }
+        int k = 1;
+        while (k < t->nodes[c].len && i + k < len && t->pool[t->nodes[c].label + k] == w[i + k]) k++;
+        if (k < t->nodes[c].len) {
+            // The word leaves the label part way: split it there, the tail
+            // keeping the count and the children
+            const uint32_t tail = new_node(t);
+            if (tail == WC_NONE) return false;
+            WcNode *cn = &t->nodes[c];
+            t->nodes[tail] = (WcNode){ cn->label + (uint32_t)k, cn->count, cn->child, WC_NONE,
+                                       (uint8_t)(cn->len - k), { 0 } };
+            cn->len = (uint8_t)k;
+            cn->count = 0;
+            cn->child = tail;
+        }
+        n = c;
+        i += k;
+    }
+    if (t->nodes[n].count++ == 0) t->words++;
+    return true;
+}
+
+// A node with no word of its own and a single child takes the child's place
+static void merge_child(WcTrie *t, uint32_t n) {
+    WcNode *cn = &t->nodes[n];
+    const uint32_t c = cn->child;
+    if (n == 0 || cn->count || c == WC_NONE || t->nodes[c].next != WC_NONE) return;
+    const WcNode child = t->nodes[c];
+    if (cn->label + cn->len != child.label) {
+        char label[WC_WORD_MAX];
+        memcpy(label, t->pool + cn->label, cn->len);
+        memcpy(label + cn->len, t->pool + child.label, child.len);
+        const uint32_t at = add_label(t, label, cn->len + child.len);
+        if (at == WC_NONE) return;
+        cn = &t->nodes[n];
+        t->dead += (uint32_t)(cn->len + child.len);
+        cn->label = at;
+    }
+    cn->len = (uint8_t)(cn->len + child.len);
+    cn->count = child.count;
+    cn->child = child.child;
+    free_node(t, c);
+}
+
+static void trie_remove(WcTrie *t, const char *w, int len) {
+    uint32_t path[WC_WORD_MAX + 1];
+    int depth = 0;
+    uint32_t n = 0;
+    int i = 0;
+    if (!t->nnodes) return;
+    path[0] = 0;
+    while (i < len) {
+        const uint32_t c = find_child(t, n, w[i], NULL);
+        if (c == WC_NONE || t->nodes[c].len > len - i ||
+            memcmp(t->pool + t->nodes[c].label, w + i, t->nodes[c].len) != 0) return;
+        i += t->nodes[c].len;
+        n = c;
+        path[++depth] = c;
+    }
+    if (n == 0 || t->nodes[n].count == 0) return;
+    if (--t->nodes[n].count) return;
+    t->words--;
+
+    // Take out the nodes left with no word below them, then merge what remains
+    while (depth > 0) {
+        const uint32_t c = path[depth];
+        if (t->nodes[c].count || t->nodes[c].child != WC_NONE) break;
+        const uint32_t parent = path[depth - 1];
+        uint32_t prev = WC_NONE;
+        find_child(t, parent, t->pool[t->nodes[c].label], &prev);
+        if (prev == WC_NONE) t->nodes[parent].child = t->nodes[c].next;
+        else t->nodes[prev].next = t->nodes[c].next;
+        t->dead += t->nodes[c].len;
+        free_node(t, c);
+        depth--;
+    }
+    merge_child(t, path[depth]);
+    compact(t);
+}
+
+uint32_t wc_count(const WcTrie *t, const char *word, int len) {
+    uint32_t n = 0;
+    int i = 0;
+    if (!t->nnodes || len <= 0) return 0;
+    while (i < len) {
+        const uint32_t c = find_child(t, n, word[i], NULL);
+        if (c == WC_NONE || t->nodes[c].len > len - i ||
+            memcmp(t->pool + t->nodes[c].label, word + i, t->nodes[c].len) != 0) return 0;
+        i += t->nodes[c].len;
+        n = c;
+    }
+    return t->nodes[n].count;
+}
+
+// ===== Scanning =====
+
+typedef void (*WordFn)(void *ctx, const char *w, int len, size_t start);
+
+/**
+ * Every word of [from, to) with [skip, skip_end) left out, as though the
+ * text on either side of it were joined. Words too long to count are
+ * passed over, and so are words starting with a digit.
+ */
+static void scan_words(WcSource src, size_t from, size_t to, size_t skip, size_t skip_end,
+                       WordFn fn, void *ctx) {
+    char word[WC_WORD_MAX];
+    int len = 0;
+    bool too_long = false;
+    size_t start = from;
+    for (size_t p = from;; p++) {
+        if (p == skip && skip_end > skip) p = skip_end;
+        const unsigned c = p < to ? src.char_at(src.ctx, p) : 0;
+        if (p < to && is_word(c)) {
+            if (len == 0 && !too_long) start = p;
+            if (len < WC_WORD_MAX - 1) word[len++] = (char)c;
+            else too_long = true;
+            continue;
+        }
+        if (len >= WC_WORD_MIN && !too_long && !(word[0] >= '0' && word[0] <= '9')) fn(ctx, word, len, start);
+        len = 0;
+        too_long = false;
+        if (p >= to) break;
+    }
+}
+
+static void add_word(void *ctx, const char *w, int len, size_t start) {
+    (void)start;
+    trie_add((WcTrie *)ctx, w, len);
+}
+
+static void remove_word(void *ctx, const char *w, int len, size_t start) {
+    (void)start;
+    trie_remove((WcTrie *)ctx, w, len);
+}
+
+// The words touching [pos, end) run from *from to *to. Past WC_WORD_MAX
+// characters a word is too long to count, so neither needs to go further.
+static void word_bounds(WcSource src, size_t pos, size_t end, size_t *from, size_t *to) {
+    const size_t total = src.length(src.ctx);
+    size_t a = pos, b = end;
+    while (a > 0 && pos - a < WC_WORD_MAX && is_word(src.char_at(src.ctx, a - 1))) a--;
+    while (b < total && b - end < WC_WORD_MAX && is_word(src.char_at(src.ctx, b))) b++;
+    *from = a;
+    *to = b;
+}
+
+// ===== Buffers =====
+
+void wc_init(WordComplete *wc) {
+    memset(wc, 0, sizeof(*wc));
+}
+
+void wc_free(WordComplete *wc) {
+    trie_free(&wc->current);
+    for (int i = 0; i < wc->nrecent; i++) trie_free(&wc->recent[i]);
+    free(wc->scratch);
+    memset(wc, 0, sizeof(*wc));
+}
+
+void wc_open(WordComplete *wc, WcSource src, uint64_t id) {
+    // The current document joins the recent ones; neither it nor the one
+    // being opened may be there twice
+    for (int i = 0; i < wc->nrecent; i++) {
+        if (wc->recent[i].id != id && wc->recent[i].id != wc->current.id) continue;
+        trie_free(&wc->recent[i]);
+        memmove(&wc->recent[i], &wc->recent[i + 1], (size_t)(wc->nrecent - i - 1) * sizeof(WcTrie));
+        wc->nrecent--;
+        i--;
+    }
+    if (wc->current.words && wc->current.id && wc->current.id != id) {
+        if (wc->nrecent == WC_BUFFERS) trie_free(&wc->recent[--wc->nrecent]);
+        memmove(&wc->recent[1], &wc->recent[0], (size_t)wc->nrecent * sizeof(WcTrie));
+        wc->recent[0] = wc->current;
+        wc->nrecent++;
+    } else {
+        trie_free(&wc->current);
+    }
+    memset(&wc->current, 0, sizeof(wc->current));
+    wc->current.id = id;
+
+    const size_t len = src.length(src.ctx);
+    if (len <= WC_OPEN_MAX) scan_words(src, 0, len, 0, 0, add_word, &wc->current);
+}
+
+void wc_note_insert(WordComplete *wc, WcSource src, size_t pos, size_t n) {
+    size_t from, to;
+    if (n == 0) return;
+    word_bounds(src, pos, pos + n, &from, &to);
+    scan_words(src, from, to, pos, pos + n, remove_word, &wc->current);
+    scan_words(src, from, to, 0, 0, add_word, &wc->current);
+}
+
+void wc_note_delete(WordComplete *wc, WcSource src, size_t pos, size_t n) {
+    size_t from, to;
+    const size_t total = src.length(src.ctx);
+    if (n == 0 || pos >= total) return;
+    if (n > total - pos) n = total - pos;
+    word_bounds(src, pos, pos + n, &from, &to);
+    scan_words(src, from, to, 0, 0, remove_word, &wc->current);
+    scan_words(src, from, to, pos, pos + n, add_word, &wc->current);
+}
+
+void wc_note_batch(WordComplete *wc, WcSource src, const EditOp *ops, size_t n, bool after) {
+    size_t from = 0, to = 0;
+    bool open = false;
+    for (size_t i = 0; i < n; i++) {
+        size_t a, b;
+        if (after) word_bounds(src, ops[i].at - ops[i].len, ops[i].at, &a, &b);
+        else word_bounds(src, ops[i].pos, ops[i].pos + ops[i].del, &a, &b);
+        // Overlapping bounds are counted together, once
+        if (open && a < to) {
+            if (b > to) to = b;
+            continue;
+        }
+        if (open) scan_words(src, from, to, 0, 0, after ? add_word : remove_word, &wc->current);
+        from = a;
+        to = b;
+        open = true;
+    }
+    if (open) scan_words(src, from, to, 0, 0, after ? add_word : remove_word, &wc->current);
+}
+
+// ===== Queries =====
+
+int wc_prefix_at(WcSource src, size_t pos, char prefix[WC_WORD_MAX]) {
+    const size_t total = src.length(src.ctx);
+    if (pos > total || (pos < total && is_word(src.char_at(src.ctx, pos)))) return 0;
+    size_t a = pos;
+    while (a > 0 && is_word(src.char_at(src.ctx, a - 1))) {
+        if (pos - a == WC_WORD_MAX - 1) return 0;
+        a--;
+    }
+    const int len = (int)(pos - a);
+    for (int i = 0; i < len; i++) prefix[i] = (char)src.char_at(src.ctx, a + (size_t)i);
+    if (len && prefix[0] >= '0' && prefix[0] <= '9') return 0;
+    return len;
+}
+
+static WcEntry *find_entry(WcScratch *s, const char *w, int len, bool add) {
+    uint32_t i = (uint32_t)hash_word(w, len) & (WC_SLOTS - 1);
+    for (;; i = (i + 1) & (WC_SLOTS - 1)) {
+        const uint32_t e = s->slots[i];
+        if (!e) break;
+        WcEntry *en = &s->entries[e - 1];
+        if (en->len == len && memcmp(en->word, w, (size_t)len) == 0) return en;
+    }
+    if (!add || s->count == WC_GATHER) return NULL;
+    WcEntry *en = &s->entries[s->count++];
+    memcpy(en->word, w, (size_t)len);
+    en->len = (uint8_t)len;
+    en->cur = en->other = 0;
+    en->near = WC_NONE;
+    s->slots[i] = (uint32_t)s->count;
+    return en;
+}
+
+// Words below node n, whose text so far is word[0, len)
+static void gather(WcScratch *s, const WcTrie *t, uint32_t n, char *word, int len, bool current) {
+    const uint32_t count = t->nodes[n].count;
+    if (count && len > s->plen) {
+        WcEntry *en = find_entry(s, word, len, true);
+        if (!en) return;
+        if (current) en->cur += count;
+        else en->other += count;
+    }
+    for (uint32_t k = t->nodes[n].child; k != WC_NONE && s->count < WC_GATHER; k = t->nodes[k].next) {
+        memcpy(word + len, t->pool + t->nodes[k].label, t->nodes[k].len);
+        gather(s, t, k, word, len + t->nodes[k].len, current);
+    }
+}
+
+static void gather_trie(WcScratch *s, const WcTrie *t, bool current) {
+    char word[WC_WORD_MAX];
+    uint32_t n = 0;
+    int i = 0;
+    if (!t->nnodes) return;
+    while (i < s->plen) {
+        const uint32_t c = find_child(t, n, s->prefix[i], NULL);
+        if (c == WC_NONE) return;
+        const int len = t->nodes[c].len;
+        const int k = len < s->plen - i ? len : s->plen - i;
+        if (memcmp(t->pool + t->nodes[c].label, s->prefix + i, (size_t)k) != 0) return;
+        memcpy(word + i, t->pool + t->nodes[c].label, (size_t)len);
+        i += len;
+        n = c;
+    }
+    gather(s, t, n, word, i, current);
+}
+
+// Distance from the caret, for the candidates seen near it
+static void note_near(void *ctx, const char *w, int len, size_t start) {
+    WcScratch *s = (WcScratch *)ctx;
+    if (len <= s->plen || memcmp(w, s->prefix, (size_t)s->plen) != 0) return;
+    WcEntry *en = find_entry(s, w, len, false);
+    if (!en) return;
+    const size_t d = start > s->caret ? start - s->caret : s->caret - start;
+    if (d < en->near) en->near = (uint32_t)d;
+}
+
+static int bits(uint32_t x) {
+    int n = 0;
+    while (x) {
+        n++;
+        x >>= 1;
+    }
+    return n;
+}
+
+static bool ranks_before(const WcCandidate *a, const WcCandidate *b) {
+    if (a->score != b->score) return a->score > b->score;
+    if (a->len != b->len) return a->len < b->len;
+    return strcmp(a->word, b->word) < 0;
+}
+
+int wc_complete(WordComplete *wc, WcSource src, size_t pos, WcCandidate *out, int max) {
+    char prefix[WC_WORD_MAX];
+    const int plen = wc_prefix_at(src, pos, prefix);
+    if (plen == 0 || max <= 0) return 0;
+    if (!wc->scratch) {
+        wc->scratch = (WcScratch *)malloc(sizeof(WcScratch));
+        if (!wc->scratch) return 0;
+    }
+    WcScratch *s = wc->scratch;
+    memset(s->slots, 0, sizeof(s->slots));
+    s->count = 0;
+    memcpy(s->prefix, prefix, (size_t)plen);
+    s->plen = plen;
+
+    gather_trie(s, &wc->current, true);
+    for (int i = 0; i < wc->nrecent; i++) gather_trie(s, &wc->recent[i], false);
+    if (!s->count) return 0;
+
+    // The text around the caret, leaving out the word being typed
+    const size_t total = src.length(src.ctx);
+    const size_t from = pos > WC_NEAR_CHARS ? pos - WC_NEAR_CHARS : 0;
+    const size_t to = total - pos > WC_NEAR_CHARS ? pos + WC_NEAR_CHARS : total;
+    s->caret = pos;
+    scan_words(src, from, to, pos - (size_t)plen, pos, note_near, s);
+
+    int n = 0;
+    for (int i = 0; i < s->count; i++) {
+        const WcEntry *en = &s->entries[i];
+        WcCandidate c;
+        c.len = en->len;
+        c.count = en->cur + en->other;
+        c.score = 16 * bits(en->cur) + 8 * bits(en->other);
+        if (en->near < WC_NEAR_CHARS) c.score += (int)(48 * (WC_NEAR_CHARS - en->near) / WC_NEAR_CHARS);
+        memcpy(c.word, en->word, en->len);
+        c.word[en->len] = '\0';
+        if (n == max && !ranks_before(&c, &out[n - 1])) continue;
+        int at = n < max ? n++ : n - 1;
+        while (at > 0 && ranks_before(&c, &out[at - 1])) {
+            out[at] = out[at - 1];
+            at--;
+        }
+        out[at] = c;
+    }
+    return n;
+}
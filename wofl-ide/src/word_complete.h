@@ -0,0 +1,120 @@
+// ==================== word_complete.h ====================
+// Word completion from the identifiers of the open buffer and recent files
+//
+// Every identifier of a buffer is counted in a radix trie: a node holds a
+// run of characters, stored once in a shared pool, and how many times the
+// word ending there occurs. Edits are reported as they happen and only the
+// words around them are taken out and put back, so the trie always matches
+// the text without the buffer ever being read again. The trie of a file
+// closed for another is kept, up to WC_BUFFERS of them, and their words are
+// offered too.
+//
+// Candidates for the word before the caret are the words below it in each
+// trie. They rank by how often they occur, more so in the buffer being
+// edited, and by how close to the caret they occur: the text a few
+// screens around it is scanned for every query.
+
+#ifndef WOFL_WORD_COMPLETE_H
+#define WOFL_WORD_COMPLETE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "edit_batch.h"
+
+#define WC_WORD_MAX     64          // longer words are not counted
+#define WC_WORD_MIN     3           // nor shorter ones
+#define WC_PREFIX_MIN   2           // typed before candidates show up by themselves
+#define WC_BUFFERS      8           // closed files whose words are kept
+#define WC_NEAR_CHARS   8192        // scanned each side of the caret per query
+#define WC_GATHER       4096        // candidates looked at per query
+#define WC_OPEN_MAX     (32u << 20) // larger files are not counted
+#define WC_NONE         UINT32_MAX
+
+// A node: its label is len characters at label in the pool
+typedef struct {
+    uint32_t label;
+    uint32_t count;             // occurrences of the word ending here
+    uint32_t child;             // first child, or WC_NONE
+    uint32_t next;              // next sibling, or WC_NONE; free list link
+    uint8_t  len;
+    uint8_t  reserved[3];
+} WcNode;
+
+typedef struct {
+    WcNode   *nodes;            // [0] is the root, with an empty label
+    uint32_t  nnodes, cap;
+    uint32_t  free_list;
+    char     *pool;
+    uint32_t  used, pool_cap;
+    uint32_t  dead;             // pool bytes no node points at any more
+    uint32_t  words;            // distinct words
+    uint64_t  id;               // file it counts (wc_name_id()), 0 if none
+} WcTrie;
+
+// Text to count, a character at a time; characters above 127 end words
+typedef struct {
+    unsigned (*char_at)(void *ctx, size_t pos);
+    size_t   (*length)(void *ctx);
+    void     *ctx;
+} WcSource;
+
+typedef struct {
+    char     word[WC_WORD_MAX];
+    int      len;
+    int      score;
+    uint32_t count;             // occurrences, in all buffers
+} WcCandidate;
+
+typedef struct WcScratch WcScratch;
+
+typedef struct {
+    WcTrie     current;         // the buffer being edited
+    WcTrie     recent[WC_BUFFERS];  // closed files, most recent first
+    int        nrecent;
+    WcScratch *scratch;         // query workspace, allocated on first use
+} WordComplete;
+
+void     wc_init(WordComplete *wc);
+void     wc_free(WordComplete *wc);
+
+// A file's id for wc_open(): a hash of its name, never 0
+uint64_t wc_name_id(const void *name, size_t bytes);
+
+/**
+ * A new document replaces the current one, whose words are kept with the
+ * recent files unless it had none. Its text is counted once here; id 0
+ * is an unnamed document, which is never kept.
+ */
+void     wc_open(WordComplete *wc, WcSource src, uint64_t id);
+
+// n characters were inserted at pos; src already holds them
+void     wc_note_insert(WordComplete *wc, WcSource src, size_t pos, size_t n);
+
+// n characters at pos are about to be deleted; src still holds them
+void     wc_note_delete(WordComplete *wc, WcSource src, size_t pos, size_t n);
+
+/**
+ * A batch of edits (edit_batch.h), prepared: called before it is applied,
+ * the words each op touches go; called after, with after set, the words
+ * touching what each op left in their place come back. A word two ops
+ * touch counts once.
+ */
+void     wc_note_batch(WordComplete *wc, WcSource src, const EditOp *ops, size_t n, bool after);
+
+/**
+ * The word ending at pos, to be completed: its length, copied to prefix,
+ * or 0 when pos is inside a word or after something that cannot start one.
+ */
+int      wc_prefix_at(WcSource src, size_t pos, char prefix[WC_WORD_MAX]);
+
+/**
+ * Up to max completions of the word ending at pos, best first. The word
+ * itself is never one of them.
+ */
+int      wc_complete(WordComplete *wc, WcSource src, size_t pos, WcCandidate *out, int max);
+
+// Occurrences of word in a trie, for checks
+uint32_t wc_count(const WcTrie *t, const char *word, int len);
+
+#endif // WOFL_WORD_COMPLETE_H
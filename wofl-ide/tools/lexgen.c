@@ -0,0 +1,861 @@
+// ==================== lexgen.c ====================
+// Build-time generator: declarative language specs (lang/*.lang) to
+// table-driven DFA lexers for src/lexer.c
+//
+//   lexgen <out-base> spec.lang...   writes <out-base>.c and <out-base>.h
+//
+// Spec lines (# starts a comment line):
+//   language <id>                    names lex_<id> and syntax_scan_<id>
+//   fallback <TK_CLASS>              class of characters nothing matches
+//   rule <TK_CLASS> <regex>          regex is the rest of the line
+//   ident <TK_CLASS> <regex>         a rule whose matches are looked up
+//                                    in the keyword table
+//   keywords <TK_CLASS> word...      exact words, several lines allowed
+//   keywords_nocase <TK_CLASS> word...
+//   region <TK_CLASS> <open> <close> [escape <c>] [multiline]
+//
+// Regexes support literals, . [set] [^set] ( ) | * + ? and the escapes
+// \s (space/tab/CR/LF/VT/FF), \d, \w, \t and \<char>; . is any character,
+// as lines never hold '\n'. At each position the longest match wins, then
+// the earliest spec line.
+//
+// Keywords are kept out of the DFA, which stays a few dozen states; each
+// ident match costs one probe of a generated open-addressing hash table.
+// States that loop on whole character classes (see src/charclass.h) are
+// flagged so the lexer can skip such runs with bitmasks.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+
+#include "../src/lexer.h"
+
+#define ALPHA        129        // ASCII plus one "anything else" symbol
+#define MAX_GROUPS   250        // accept[] entries are bytes
+#define MAX_REGIONS  100
+#define MAX_KEYWORDS 2048
+#define LINE_MAX_LEN 4096
+
+static const char *token_classes[] = {
+    "TK_TEXT", "TK_KW", "TK_IDENT", "TK_NUM", "TK_STR", "TK_CHAR", "TK_COMMENT", "TK_PUNCT"
+};
+
+// ===== Errors and memory =====
+
+static const char *g_file = "";
+static int g_line;
+
+static void die(const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    fprintf(stderr, "%s:%d: ", g_file, g_line);
+    vfprintf(stderr, fmt, ap);
+    fputc('\n', stderr);
+    va_end(ap);
+    exit(1);
+}
+
+static void *xrealloc(void *p, size_t n) {
+    p = realloc(p, n ? n : 1);
+    if (!p) {
+        fprintf(stderr, "lexgen: out of memory\n");
+        exit(1);
+    }
+    return p;
+}
+
+// ===== NFA =====
+
+enum { N_EPS, N_SET, N_ACCEPT };
+
+typedef struct {
+    int kind;
+    int out, out2;              // -1 when unused
+    int group;                  // N_ACCEPT: spec line that matched
+    bool set[ALPHA];            // N_SET
+} NState;
+
+typedef struct {
+    int start, end;             // end is an N_EPS whose out is still unset
+} Frag;
+
+static NState *nfa;
+static int nfa_count, nfa_cap;
+
+static int nfa_new(int kind) {
+    if (nfa_count == nfa_cap) {
+        nfa_cap = nfa_cap ? nfa_cap * 2 : 1024;
+        nfa = xrealloc(nfa, (size_t)nfa_cap * sizeof(*nfa));
+    }
+    NState *s = &nfa[nfa_count];
+    memset(s, 0, sizeof(*s));
+    s->kind = kind;
+    s->out = s->out2 = -1;
+    return nfa_count++;
+}
+
+static Frag frag_set(const bool *set) {
+    Frag f;
+    f.start = nfa_new(N_SET);
+    f.end = nfa_new(N_EPS);
+    memcpy(nfa[f.start].set, set, sizeof(nfa[f.start].set));
+    nfa[f.start].out = f.end;
+    return f;
+}
+
+static Frag frag_empty(void) {
+    int s = nfa_new(N_EPS);
+    return (Frag){s, s};
+}
+
+static Frag frag_cat(Frag a, Frag b) {
+    nfa[a.end].out = b.start;
+    return (Frag){a.start, b.end};
+}
+
+static Frag frag_alt(Frag a, Frag b) {
+    int s = nfa_new(N_EPS), e = nfa_new(N_EPS);
+    nfa[s].out = a.start;
+    nfa[s].out2 = b.start;
+    nfa[a.end].out = e;
+    nfa[b.end].out = e;
+    return (Frag){s, e};
+}
+
+static Frag frag_star(Frag a) {
+    int s = nfa_new(N_EPS), e = nfa_new(N_EPS);
+    nfa[s].out = a.start;
+    nfa[s].out2 = e;
+    nfa[a.end].out = a.start;
+    nfa[a.end].out2 = e;
+    return (Frag){s, e};
+}
+
+static Frag frag_plus(Frag a) {
+    int e = nfa_new(N_EPS);
+    nfa[a.end].out = a.start;
+    nfa[a.end].out2 = e;
+    return (Frag){a.start, e};
+}
+
+static Frag frag_opt(Frag a) {
+    int s = nfa_new(N_EPS), e = nfa_new(N_EPS);
+    nfa[s].out = a.start;
+    nfa[s].out2 = e;
+    nfa[a.end].out = e;
+    return (Frag){s, e};
+}
+
+static Frag frag_literal(const char *s) {
+    Frag f = frag_empty();
+    for (; *s; s++) {
+        bool set[ALPHA] = {false};
+        set[(unsigned char)*s & 0x7f] = true;
+        f = frag_cat(f, frag_set(set));
+    }
+    return f;
+}
+
+// ===== Regex parser =====
+
+static const char *rx;
+
+static Frag parse_alt(void);
+
+static void escape_set(bool *set, char c) {
+    switch (c) {
+        case 's':
+            set[' '] = set['\t'] = set['\r'] = set['\n'] = set['\v'] = set['\f'] = true;
+            break;
+        case 'd':
+            for (int k = '0'; k <= '9'; k++) set[k] = true;
+            break;
+        case 'w':
+            for (int k = 0; k < 128; k++) {
+                if ((k >= '0' && k <= '9') || (k >= 'a' && k <= 'z') ||
+                    (k >= 'A' && k <= 'Z') || k == '_') set[k] = true;
+            }
+            break;
+        case 't':
+            set['\t'] = true;
+            break;
+        case '\0':
+            die("dangling backslash");
+            break;
+        default:
+            set[(unsigned char)c & 0x7f] = true;
+            break;
+    }
+}
+
+static Frag parse_bracket(void) {
+    bool set[ALPHA] = {false};
+    bool negate = false;
+    if (*rx == '^') {
+        negate = true;
+        rx++;
+    }
+    bool first = true;
+    while (*rx && (*rx != ']' || first)) {
+        first = false;
+        if (*rx == '\\') {
+            escape_set(set, rx[1]);
+            rx += 2;
+            continue;
+        }
+        int lo = (unsigned char)*rx++ & 0x7f;
+        int hi = lo;
+        if (rx[0] == '-' && rx[1] && rx[1] != ']') {
+            hi = (unsigned char)rx[1] & 0x7f;
+            rx += 2;
+        }
+        if (hi < lo) die("bad range in [...]");
+        for (int k = lo; k <= hi; k++) set[k] = true;
+    }
+    if (*rx != ']') die("unterminated [...]");
+    rx++;
+    if (negate) {
+        for (int k = 0; k < ALPHA; k++) set[k] = !set[k];
+        set['\n'] = false;
+    }
+    return frag_set(set);
+}
+
+static Frag parse_atom(void) {
+    bool set[ALPHA] = {false};
+    char c = *rx++;
+    switch (c) {
+        case '(': {
+            Frag f = parse_alt();
+            if (*rx != ')') die("missing )");
+            rx++;
+            return f;
+        }
+        case '[':
+            return parse_bracket();
+        case '.':
+            for (int k = 0; k < ALPHA; k++) set[k] = true;     // lines hold no '\n'
+            return frag_set(set);
+        case '\\':
+            escape_set(set, *rx++);
+            return frag_set(set);
+        default:
+            set[(unsigned char)c & 0x7f] = true;
+            return frag_set(set);
+    }
+}
+
+static Frag parse_repeat(void) {
+    Frag f = parse_atom();
+    for (;;) {
+        if (*rx == '*') f = frag_star(f);
+        else if (*rx == '+') f = frag_plus(f);
+        else if (*rx == '?') f = frag_opt(f);
+        else break;
+        rx++;
+    }
+    return f;
+}
+
+static Frag parse_cat(void) {
+    Frag f = frag_empty();
+    while (*rx && *rx != '|' && *rx != ')') {
+        if (*rx == '*' || *rx == '+' || *rx == '?') die("nothing to repeat");
+        f = frag_cat(f, parse_repeat());
+    }
+    return f;
+}
+
+static Frag parse_alt(void) {
+    Frag f = parse_cat();
+    while (*rx == '|') {
+        rx++;
+        f = frag_alt(f, parse_cat());
+    }
+    return f;
+}
+
+static Frag parse_regex(const char *text) {
+    rx = text;
+    Frag f = parse_alt();
+    if (*rx) die("unexpected '%c' in regex", *rx);
+    return f;
+}
+
+// ===== Language spec =====
+
+typedef struct {
+    int cls;
+    int region;                 // -1 if none
+} Group;
+
+typedef struct {
+    char close[64];
+    char escape;
+    bool multiline;
+} Region;
+
+typedef struct {
+    char word[64];
+    int cls;
+    bool nocase;
+} Keyword;
+
+typedef struct {
+    char id[64];
+    int fallback;
+    int ident;                  // group whose matches may be keywords, or -1
+    Keyword keywords[MAX_KEYWORDS];
+    int keyword_count;
+    bool keyword_fold;          // some keywords ignore case: hash folded text
+    Group groups[MAX_GROUPS];
+    int group_count;
+    Region regions[MAX_REGIONS];
+    int region_count;
+    int start;                  // NFA start state
+} Lang;
+
+static int parse_class(const char *name) {
+    for (int k = 0; k < (int)(sizeof(token_classes) / sizeof(token_classes[0])); k++) {
+        if (strcmp(name, token_classes[k]) == 0) return k;
+    }
+    die("unknown token class '%s'", name);
+    return 0;
+}
+
+static int add_group(Lang *lang, int cls, int region) {
+    if (lang->group_count == MAX_GROUPS) die("too many rules");
+    lang->groups[lang->group_count].cls = cls;
+    lang->groups[lang->group_count].region = region;
+    return lang->group_count++;
+}
+
+// Join frag into the language's start state, accepting as group
+static void add_pattern(Lang *lang, Frag f, int group) {
+    int acc = nfa_new(N_ACCEPT);
+    nfa[acc].group = group;
+    nfa[f.end].out = acc;
+    int s = nfa_new(N_EPS);
+    nfa[s].out = lang->start;
+    nfa[s].out2 = f.start;
+    lang->start = s;
+}
+
+static char *next_word(char **p) {
+    char *s = *p;
+    while (*s == ' ' || *s == '\t') s++;
+    if (!*s) return NULL;
+    char *w = s;
+    while (*s && *s != ' ' && *s != '\t') s++;
+    if (*s) *s++ = '\0';
+    *p = s;
+    return w;
+}
+
+static void read_spec(const char *path, Lang *lang) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "lexgen: cannot open %s\n", path);
+        exit(1);
+    }
+    g_file = path;
+    g_line = 0;
+    memset(lang, 0, sizeof(*lang));
+    lang->fallback = parse_class("TK_PUNCT");
+    lang->ident = -1;
+    lang->start = nfa_new(N_EPS);
+
+    char buf[LINE_MAX_LEN];
+    while (fgets(buf, sizeof(buf), f)) {
+        g_line++;
+        size_t len = strlen(buf);
+        while (len > 0 && (buf[len - 1] == '\n' || buf[len - 1] == '\r' ||
+                           buf[len - 1] == ' ' || buf[len - 1] == '\t')) {
+            buf[--len] = '\0';
+        }
+        char *p = buf;
+        char *cmd = next_word(&p);
+        if (!cmd || cmd[0] == '#') continue;
+
+        if (strcmp(cmd, "language") == 0) {
+            char *id = next_word(&p);
+            if (!id || strlen(id) >= sizeof(lang->id)) die("language needs a short id");
+            strcpy(lang->id, id);
+        } else if (strcmp(cmd, "fallback") == 0) {
+            char *cls = next_word(&p);
+            if (!cls) die("fallback needs a class");
+            lang->fallback = parse_class(cls);
+        } else if (strcmp(cmd, "rule") == 0 || strcmp(cmd, "ident") == 0) {
+            char *cls = next_word(&p);
+            while (*p == ' ' || *p == '\t') p++;
+            if (!cls || !*p) die("%s needs a class and a regex", cmd);
+            int group = add_group(lang, parse_class(cls), -1);
+            add_pattern(lang, parse_regex(p), group);
+            if (cmd[0] == 'i') {
+                if (lang->ident >= 0) die("only one ident rule");
+                lang->ident = group;
+            }
+        } else if (strcmp(cmd, "keywords") == 0 || strcmp(cmd, "keywords_nocase") == 0) {
+            bool nocase = strcmp(cmd, "keywords_nocase") == 0;
+            char *cls = next_word(&p);
+            if (!cls) die("keywords needs a class");
+            int k = parse_class(cls);
+            for (char *w; (w = next_word(&p)) != NULL; ) {
+                if (lang->keyword_count == MAX_KEYWORDS) die("too many keywords");
+                if (strlen(w) >= sizeof(lang->keywords[0].word)) die("keyword too long");
+                if (strpbrk(w, "\"\\")) die("keywords can't contain quotes or backslashes");
+                Keyword *kw = &lang->keywords[lang->keyword_count++];
+                strcpy(kw->word, w);
+                kw->cls = k;
+                kw->nocase = nocase;
+                lang->keyword_fold |= nocase;
+            }
+        } else if (strcmp(cmd, "region") == 0) {
+            char *cls = next_word(&p);
+            char *open = next_word(&p);
+            char *close = next_word(&p);
+            if (!cls || !open || !close) die("region needs a class, open and close");
+            if (lang->region_count == MAX_REGIONS) die("too many regions");
+            if (strlen(close) >= sizeof(lang->regions[0].close)) die("close delimiter too long");
+            Region *r = &lang->regions[lang->region_count];
+            strcpy(r->close, close);
+            for (char *w; (w = next_word(&p)) != NULL; ) {
+                if (strcmp(w, "multiline") == 0) {
+                    r->multiline = true;
+                } else if (strcmp(w, "escape") == 0) {
+                    char *e = next_word(&p);
+                    if (!e || strlen(e) != 1) die("escape needs one character");
+                    r->escape = e[0];
+                } else {
+                    die("unknown region option '%s'", w);
+                }
+            }
+            int group = add_group(lang, parse_class(cls), lang->region_count++);
+            add_pattern(lang, frag_literal(open), group);
+        } else {
+            die("unknown directive '%s'", cmd);
+        }
+    }
+    fclose(f);
+    if (!lang->id[0]) die("missing 'language'");
+    if (lang->keyword_count && lang->ident < 0) die("keywords need an ident rule");
+}
+
+// ===== Subset construction =====
+
+typedef struct {
+    int *next;                  // [state * ALPHA + c]
+    int *accept;                // group + 1, or 0
+    int count, cap;
+} Dfa;
+
+static void dfa_grow(Dfa *d) {
+    if (d->count < d->cap) return;
+    d->cap = d->cap ? d->cap * 2 : 256;
+    d->next = xrealloc(d->next, (size_t)d->cap * ALPHA * sizeof(int));
+    d->accept = xrealloc(d->accept, (size_t)d->cap * sizeof(int));
+}
+
+static int words;               // 64-bit words per NFA state set
+static uint64_t *sets;          // DFA state -> NFA state set
+static int sets_cap;
+static int *stack;
+
+#define HASH_SIZE 65536
+static int hash_head[HASH_SIZE];
+static int *hash_chain;
+
+static void closure(uint64_t *set) {
+    int top = 0;
+    for (int s = 0; s < nfa_count; s++) {
+        if (set[s >> 6] >> (s & 63) & 1) stack[top++] = s;
+    }
+    while (top > 0) {
+        int s = stack[--top];
+        if (nfa[s].kind != N_EPS) continue;
+        int outs[2] = {nfa[s].out, nfa[s].out2};
+        for (int k = 0; k < 2; k++) {
+            int t = outs[k];
+            if (t >= 0 && !(set[t >> 6] >> (t & 63) & 1)) {
+                set[t >> 6] |= 1ull << (t & 63);
+                stack[top++] = t;
+            }
+        }
+    }
+}
+
+static unsigned set_hash(const uint64_t *set) {
+    uint64_t h = 1469598103934665603ull;
+    for (int w = 0; w < words; w++) {
+        h ^= set[w];
+        h *= 1099511628211ull;
+    }
+    return (unsigned)(h ^ (h >> 32)) & (HASH_SIZE - 1);
+}
+
+static bool set_empty(const uint64_t *set) {
+    for (int w = 0; w < words; w++) {
+        if (set[w]) return false;
+    }
+    return true;
+}
+
+// DFA state for set, adding it if new; *added reports which
+static int dfa_state(Dfa *d, const uint64_t *set, bool *added) {
+    unsigned h = set_hash(set);
+    for (int s = hash_head[h]; s >= 0; s = hash_chain[s]) {
+        if (memcmp(sets + (size_t)s * words, set, (size_t)words * sizeof(uint64_t)) == 0) {
+            *added = false;
+            return s;
+        }
+    }
+    dfa_grow(d);
+    if (d->count == sets_cap) {
+        sets_cap = d->cap;
+        sets = xrealloc(sets, (size_t)sets_cap * words * sizeof(uint64_t));
+        hash_chain = xrealloc(hash_chain, (size_t)sets_cap * sizeof(int));
+    }
+    int s = d->count++;
+    memcpy(sets + (size_t)s * words, set, (size_t)words * sizeof(uint64_t));
+    hash_chain[s] = hash_head[h];
+    hash_head[h] = s;
+
+    int best = 0;
+    for (int n = 0; n < nfa_count; n++) {
+        if ((set[n >> 6] >> (n & 63) & 1) && nfa[n].kind == N_ACCEPT) {
+            if (!best || nfa[n].group + 1 < best) best = nfa[n].group + 1;
+        }
+    }
+    d->accept[s] = best;
+    *added = true;
+    return s;
+}
+
+static void build_dfa(const Lang *lang, Dfa *d) {
+    words = (nfa_count + 63) / 64;
+    stack = xrealloc(stack, (size_t)nfa_count * 2 * sizeof(int));
+    for (int h = 0; h < HASH_SIZE; h++) hash_head[h] = -1;
+    memset(d, 0, sizeof(*d));
+    sets_cap = 0;
+
+    uint64_t *set = xrealloc(NULL, (size_t)words * sizeof(uint64_t));
+    bool added;
+
+    // State 0 is dead (the empty set), state 1 the start
+    memset(set, 0, (size_t)words * sizeof(uint64_t));
+    dfa_state(d, set, &added);
+    set[lang->start >> 6] |= 1ull << (lang->start & 63);
+    closure(set);
+    dfa_state(d, set, &added);
+
+    int *members = xrealloc(NULL, (size_t)nfa_count * sizeof(int));
+    for (int s = 0; s < d->count; s++) {
+        // Only character-consuming NFA states matter for transitions
+        int count = 0;
+        const uint64_t *from = sets + (size_t)s * words;
+        for (int n = 0; n < nfa_count; n++) {
+            if ((from[n >> 6] >> (n & 63) & 1) && nfa[n].kind == N_SET) members[count++] = n;
+        }
+        for (int c = 0; c < ALPHA; c++) {
+            memset(set, 0, (size_t)words * sizeof(uint64_t));
+            for (int k = 0; k < count; k++) {
+                const NState *ns = &nfa[members[k]];
+                if (ns->set[c]) set[ns->out >> 6] |= 1ull << (ns->out & 63);
+            }
+            if (set_empty(set)) {
+                d->next[(size_t)s * ALPHA + c] = 0;
+                continue;
+            }
+            closure(set);
+            int t = dfa_state(d, set, &added);      // may grow d->next
+            d->next[(size_t)s * ALPHA + c] = t;
+        }
+    }
+    free(members);
+    free(set);
+}
+
+// ===== Minimization (Moore partition refinement) =====
+
+static void minimize(Dfa *d) {
+    int n = d->count;
+    int *block = xrealloc(NULL, (size_t)n * sizeof(int));
+    int *fresh = xrealloc(NULL, (size_t)n * sizeof(int));
+    int *sig = xrealloc(NULL, (size_t)n * (ALPHA + 1) * sizeof(int));
+    int blocks = 0;
+
+    // Start from "same accept group"
+    for (int s = 0; s < n; s++) block[s] = d->accept[s];
+    for (;;) {
+        for (int s = 0; s < n; s++) {
+            int *g = sig + (size_t)s * (ALPHA + 1);
+            g[0] = block[s];
+            for (int c = 0; c < ALPHA; c++) g[c + 1] = block[d->next[(size_t)s * ALPHA + c]];
+        }
+        int count = 0;
+        for (int s = 0; s < n; s++) {
+            fresh[s] = -1;
+            for (int t = 0; t < s; t++) {
+                if (fresh[t] == t &&
+                    memcmp(sig + (size_t)s * (ALPHA + 1), sig + (size_t)t * (ALPHA + 1),
+                           (ALPHA + 1) * sizeof(int)) == 0) {
+                    fresh[s] = t;
+                    break;
+                }
+            }
+            if (fresh[s] < 0) {
+                fresh[s] = s;
+                count++;
+            }
+        }
+        memcpy(block, fresh, (size_t)n * sizeof(int));
+        if (count == blocks) break;
+        blocks = count;
+    }
+
+    // Renumber so the dead block stays 0 and the start block 1
+    int *id = xrealloc(NULL, (size_t)n * sizeof(int));
+    for (int s = 0; s < n; s++) id[s] = -1;
+    int next_id = 0;
+    id[block[0]] = next_id++;
+    if (id[block[1]] < 0) id[block[1]] = next_id++;
+    for (int s = 0; s < n; s++) {
+        if (id[block[s]] < 0) id[block[s]] = next_id++;
+    }
+
+    int *next = xrealloc(NULL, (size_t)next_id * ALPHA * sizeof(int));
+    int *accept = xrealloc(NULL, (size_t)next_id * sizeof(int));
+    for (int s = 0; s < n; s++) {
+        int b = id[block[s]];
+        accept[b] = d->accept[s];
+        for (int c = 0; c < ALPHA; c++) {
+            next[(size_t)b * ALPHA + c] = id[block[d->next[(size_t)s * ALPHA + c]]];
+        }
+    }
+    free(d->next);
+    free(d->accept);
+    d->next = next;
+    d->accept = accept;
+    d->count = d->cap = next_id;
+    free(block);
+    free(fresh);
+    free(sig);
+    free(id);
+}
+
+// ===== Character classes =====
+
+// Characters whose columns match in every state share a class
+static int char_classes(const Dfa *d, int *cls) {
+    int count = 0;
+    for (int c = 0; c < ALPHA; c++) {
+        cls[c] = -1;
+        for (int p = 0; p < c && cls[c] < 0; p++) {
+            bool same = true;
+            for (int s = 0; s < d->count && same; s++) {
+                same = d->next[(size_t)s * ALPHA + c] == d->next[(size_t)s * ALPHA + p];
+            }
+            if (same) cls[c] = cls[p];
+        }
+        if (cls[c] < 0) cls[c] = count++;
+    }
+    return count;
+}
+
+// CC_* classes every character of which keeps state s in s (CC_ANY when
+// all characters do), plus LEX_RUN for accepting states that nothing else
+// leads out of
+static int state_loops(const Dfa *d, int s) {
+    static const unsigned kinds[] = { CC_SPACE, CC_IDENT, CC_QUOTE, CC_OP, CC_DIGIT };
+    const int *row = &d->next[(size_t)s * ALPHA];
+    int loops = 0;
+
+    for (size_t k = 0; k < sizeof(kinds) / sizeof(kinds[0]); k++) {
+        bool all = true;
+        for (unsigned c = 0; c < 128 && all; c++) {
+            if (cc_class_of(c) & kinds[k]) all = row[c] == s;
+        }
+        if (all) loops |= (int)kinds[k];
+    }
+    bool any = true;
+    for (int c = 0; c < ALPHA && any; c++) any = row[c] == s;
+    if (any) loops |= CC_ANY;
+
+    bool run = loops && d->accept[s];
+    for (int c = 0; c < ALPHA && run; c++) {
+        run = row[c] == s || row[c] == 0;
+        if (row[c] == s) run = c < 128 && (cc_class_of((unsigned)c) & (unsigned)loops);
+    }
+    if (run) loops |= LEX_RUN;
+    return s ? loops : 0;
+}
+
+// ===== Output =====
+
+static void emit_c_char(FILE *out, char c) {
+    if (c == '\\' || c == '\'') fprintf(out, "L'\\%c'", c);
+    else fprintf(out, "L'%c'", c);
+}
+
+static unsigned keyword_hash(const char *s, bool fold) {
+    size_t n = strlen(s);
+    return lex_keyword_hash((unsigned char)s[0], (unsigned char)s[n - 1], (unsigned)n, fold);
+}
+
+// Keyword hash table, at most half full; returns its mask
+static unsigned emit_keywords(FILE *out, const Lang *lang) {
+    if (!lang->keyword_count) return 0;
+
+    unsigned size = 16;
+    while (size < (unsigned)lang->keyword_count * 2) size *= 2;
+    int *slots = xrealloc(NULL, size * sizeof(int));
+    for (unsigned i = 0; i < size; i++) slots[i] = -1;
+    for (int k = 0; k < lang->keyword_count; k++) {
+        const Keyword *kw = &lang->keywords[k];
+        unsigned slot = keyword_hash(kw->word, lang->keyword_fold) & (size - 1);
+        bool dup = false;
+        for (; slots[slot] >= 0; slot = (slot + 1) & (size - 1)) {
+            dup |= strcmp(lang->keywords[slots[slot]].word, kw->word) == 0;
+        }
+        if (!dup) slots[slot] = k;      // first spelling wins
+    }
+
+    fprintf(out, "static const LexKeyword %s_keywords[%u] = {\n", lang->id, size);
+    for (unsigned i = 0; i < size; i++) {
+        if (slots[i] < 0) continue;
+        const Keyword *kw = &lang->keywords[slots[i]];
+        fprintf(out, "    [%u] = { L\"%s\", %d, %s, %s },\n", i, kw->word, (int)strlen(kw->word),
+                token_classes[kw->cls], kw->nocase ? "true" : "false");
+    }
+    fprintf(out, "};\n\n");
+    free(slots);
+    return size - 1;
+}
+
+static void emit_lang(FILE *out, const Lang *lang, const Dfa *d) {
+    int cls[ALPHA];
+    int nclasses = char_classes(d, cls);
+    const char *id = lang->id;
+
+    fprintf(out, "// ===== %s: %d states, %d classes =====\n\n", id, d->count, nclasses);
+
+    fprintf(out, "static const unsigned char %s_classes[LEX_ALPHABET] = {", id);
+    for (int c = 0; c < ALPHA; c++) {
+        fprintf(out, "%s%d,", c % 16 ? " " : "\n    ", cls[c]);
+    }
+    fprintf(out, "\n};\n\n");
+
+    // Compressed transitions: one column per class
+    int *rep = xrealloc(NULL, (size_t)nclasses * sizeof(int));
+    for (int c = ALPHA - 1; c >= 0; c--) rep[cls[c]] = c;
+    fprintf(out, "static const unsigned short %s_next[%d * %d] = {", id, d->count, nclasses);
+    for (int s = 0; s < d->count; s++) {
+        fprintf(out, "\n    /* %3d */", s);
+        for (int k = 0; k < nclasses; k++) {
+            if (k && k % 16 == 0) fprintf(out, "\n             ");
+            fprintf(out, " %d,", d->next[(size_t)s * ALPHA + rep[k]]);
+        }
+    }
+    fprintf(out, "\n};\n\n");
+    free(rep);
+
+    fprintf(out, "static const unsigned char %s_accept[%d] = {", id, d->count);
+    for (int s = 0; s < d->count; s++) {
+        fprintf(out, "%s%d,", s % 16 ? " " : "\n    ", d->accept[s]);
+    }
+    fprintf(out, "\n};\n\n");
+
+    fprintf(out, "static const unsigned char %s_loops[%d] = {", id, d->count);
+    for (int s = 0; s < d->count; s++) {
+        fprintf(out, "%s0x%02x,", s % 16 ? " " : "\n    ", state_loops(d, s));
+    }
+    fprintf(out, "\n};\n\n");
+
+    fprintf(out, "static const LexRule %s_rules[%d] = {\n", id, lang->group_count);
+    for (int g = 0; g < lang->group_count; g++) {
+        fprintf(out, "    { %s, %d },\n", token_classes[lang->groups[g].cls], lang->groups[g].region);
+    }
+    fprintf(out, "};\n\n");
+
+    unsigned mask = emit_keywords(out, lang);
+
+    if (lang->region_count) {
+        fprintf(out, "static const LexRegion %s_regions[%d] = {\n", id, lang->region_count);
+        for (int r = 0; r < lang->region_count; r++) {
+            const Region *reg = &lang->regions[r];
+            fprintf(out, "    { L\"");
+            for (const char *c = reg->close; *c; c++) {
+                if (*c == '"' || *c == '\\') fputc('\\', out);
+                fputc(*c, out);
+            }
+            fprintf(out, "\", ");
+            if (reg->escape) emit_c_char(out, reg->escape);
+            else fprintf(out, "0");
+            fprintf(out, ", %s },\n", reg->multiline ? "true" : "false");
+        }
+        fprintf(out, "};\n\n");
+    }
+
+    fprintf(out, "const LexTable lex_%s = {\n", id);
+    fprintf(out, "    \"%s\", %s_classes, %s_next, %s_accept, %s_loops, %s_rules, %s%s,\n",
+            id, id, id, id, id, id, lang->region_count ? id : "NULL",
+            lang->region_count ? "_regions" : "");
+    if (lang->keyword_count) {
+        fprintf(out, "    %s_keywords, %u, %s,\n", id, mask, lang->keyword_fold ? "true" : "false");
+    } else {
+        fprintf(out, "    NULL, 0, false,\n");
+    }
+    fprintf(out, "    %d, %d, %d, %s\n};\n\n", lang->ident + 1, nclasses, d->count,
+            token_classes[lang->fallback]);
+
+    fprintf(out, "void syntax_scan_%s(const wchar_t *line, int len, TokenSpan *out, int *out_n) {\n", id);
+    fprintf(out, "    lex_scan(&lex_%s, line, len, 0, out, out_n);\n}\n\n", id);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: lexgen <out-base> spec.lang...\n");
+        return 2;
+    }
+
+    char path[1024];
+    snprintf(path, sizeof(path), "%s.c", argv[1]);
+    FILE *out = fopen(path, "w");
+    snprintf(path, sizeof(path), "%s.h", argv[1]);
+    FILE *hdr = fopen(path, "w");
+    if (!out || !hdr) {
+        fprintf(stderr, "lexgen: cannot write %s.c/.h\n", argv[1]);
+        return 1;
+    }
+
+    const char *base = strrchr(argv[1], '/');
+    base = base ? base + 1 : argv[1];
+    fprintf(out, "// ==================== %s.c ====================\n", base);
+    fprintf(out, "// Generated by tools/lexgen.c from lang/*.lang -- do not edit\n\n");
+    fprintf(out, "#include \"%s.h\"\n\n", base);
+    fprintf(hdr, "// ==================== %s.h ====================\n", base);
+    fprintf(hdr, "// Generated by tools/lexgen.c from lang/*.lang -- do not edit\n\n");
+    fprintf(hdr, "#ifndef WOFL_SYNTAX_GEN_H\n#define WOFL_SYNTAX_GEN_H\n\n#include \"lexer.h\"\n\n");
+
+    static Lang lang;
+    for (int i = 2; i < argc; i++) {
+        nfa_count = 0;
+        read_spec(argv[i], &lang);
+        Dfa d;
+        build_dfa(&lang, &d);
+        minimize(&d);
+        if (d.count > 65535) die("DFA too large");
+        emit_lang(out, &lang, &d);
+        fprintf(hdr, "extern const LexTable lex_%s;\n", lang.id);
+        free(d.next);
+        free(d.accept);
+    }
+
+    fprintf(hdr, "\n#endif // WOFL_SYNTAX_GEN_H\n");
+    fclose(out);
+    fclose(hdr);
+    return 0;
+}